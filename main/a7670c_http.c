@@ -9,6 +9,7 @@
 #include "a7670c_http.h"
 #include "a7670c_ppp.h"
 #include "web_config.h"
+#include "iot_configs.h"
 
 #include <stdio.h>
 #include <string.h>
@@ -392,71 +393,78 @@ static esp_err_t shhttp_read(uint8_t* buffer, size_t buffer_size, size_t offset,
     char read_cmd[64];
     snprintf(read_cmd, sizeof(read_cmd), "AT+SHREAD=%zu,%zu", offset, to_read);
 
-    ESP_LOGI(TAG, ">>> %s", read_cmd);
+    ESP_LOGD(TAG, ">>> %s", read_cmd);
     char cmd_with_crlf[128];
     snprintf(cmd_with_crlf, sizeof(cmd_with_crlf), "%s\r\n", read_cmd);
     uart_write_bytes(modem_uart_num, cmd_with_crlf, strlen(cmd_with_crlf));
 
-    // Wait for +SHREAD header
-    char header_buf[128] = {0};
-    int header_len = 0;
+    // Read the echo, OK and +SHREAD lines in blocks rather than a byte at a
+    // time. The block that completes the +SHREAD line usually carries the
+    // start of the data as well.
+    char header_buf[128];
+    size_t header_len = 0;
+    size_t data_read = 0;
+    int actual_length = -1;
     int64_t start_time = esp_timer_get_time() / 1000;
-    int actual_length = 0;
-    bool found_header = false;
 
-    // First, read until we get +SHREAD: <length>
-    while ((esp_timer_get_time() / 1000 - start_time) < 30000) {
-        int len = uart_read_bytes(modem_uart_num, at_rx_buffer, 1, pdMS_TO_TICKS(100));
-        if (len > 0) {
-            if (header_len < (int)sizeof(header_buf) - 1) {
-                header_buf[header_len++] = at_rx_buffer[0];
-                header_buf[header_len] = '\0';
-
-                // Check if we have the complete header line
-                char* shread = strstr(header_buf, "+SHREAD:");
-                if (shread) {
-                    char* newline = strchr(shread, '\n');
-                    if (newline) {
-                        // Parse length
-                        if (sscanf(shread, "+SHREAD: %d", &actual_length) == 1 ||
-                            sscanf(shread, "+SHREAD:%d", &actual_length) == 1) {
-                            ESP_LOGI(TAG, "Reading %d bytes of data...", actual_length);
-                            found_header = true;
-                            break;
-                        }
-                    }
+    while (actual_length < 0 && (esp_timer_get_time() / 1000 - start_time) < 30000) {
+        int len = uart_read_bytes(modem_uart_num, header_buf + header_len,
+                                  sizeof(header_buf) - 1 - header_len, pdMS_TO_TICKS(20));
+        if (len <= 0) {
+            continue;
+        }
+        header_len += len;
+
+        char *line = header_buf;
+        char *end = header_buf + header_len;
+        char *newline;
+        while ((newline = memchr(line, '\n', end - line)) != NULL) {
+            *newline = '\0';
+            if (sscanf(line, "+SHREAD: %d", &actual_length) == 1) {
+                // Whatever came after the header line is data
+                data_read = end - (newline + 1);
+                if (actual_length >= 0 && data_read > (size_t)actual_length) {
+                    data_read = actual_length;
                 }
-
-                // Check for error
-                if (strstr(header_buf, "ERROR")) {
-                    ESP_LOGE(TAG, "SHREAD error: %s", header_buf);
-                    return ESP_FAIL;
+                if (actual_length >= 0 && (size_t)actual_length <= to_read) {
+                    memcpy(buffer, newline + 1, data_read);
                 }
+                break;
+            }
+            if (strstr(line, "ERROR")) {
+                ESP_LOGE(TAG, "SHREAD error: %s", line);
+                return ESP_FAIL;
+            }
+            line = newline + 1;
+        }
+
+        // Keep only the incomplete line
+        if (actual_length < 0) {
+            header_len = end - line;
+            memmove(header_buf, line, header_len);
+            if (header_len == sizeof(header_buf) - 1) {
+                header_len = 0;     // No line ending in sight: not a header
             }
         }
     }
 
-    if (!found_header || actual_length == 0) {
+    if (actual_length <= 0) {
         ESP_LOGW(TAG, "No data to read");
         return ESP_OK;
     }
+    if ((size_t)actual_length > to_read) {
+        ESP_LOGE(TAG, "SHREAD returned %d bytes, asked for %zu", actual_length, to_read);
+        return ESP_FAIL;
+    }
+    ESP_LOGD(TAG, "Reading %d bytes of data...", actual_length);
 
-    // Now read the binary data
-    size_t data_read = 0;
+    // The rest of the binary data goes straight into the caller's buffer
     start_time = esp_timer_get_time() / 1000;
 
     while (data_read < (size_t)actual_length && (esp_timer_get_time() / 1000 - start_time) < 60000) {
-        size_t remaining = actual_length - data_read;
-        size_t chunk = remaining > sizeof(at_rx_buffer) ? sizeof(at_rx_buffer) : remaining;
-
-        int len = uart_read_bytes(modem_uart_num, at_rx_buffer, chunk, pdMS_TO_TICKS(1000));
+        int len = uart_read_bytes(modem_uart_num, buffer + data_read, actual_length - data_read,
+                                  pdMS_TO_TICKS(1000));
         if (len > 0) {
-            // Copy to output buffer
-            size_t copy_len = len;
-            if (data_read + copy_len > buffer_size) {
-                copy_len = buffer_size - data_read;
-            }
-            memcpy(buffer + data_read, at_rx_buffer, copy_len);
             data_read += len;
         }
     }
@@ -466,7 +474,7 @@ static esp_err_t shhttp_read(uint8_t* buffer, size_t buffer_size, size_t offset,
     uart_flush(modem_uart_num);
 
     *bytes_read = data_read;
-    ESP_LOGI(TAG, "Read %zu bytes", data_read);
+    ESP_LOGD(TAG, "Read %zu bytes", data_read);
 
     return ESP_OK;
 }
@@ -598,7 +606,7 @@ esp_err_t a7670c_http_download_ota(const char* url, modem_http_progress_cb_t pro
     esp_ota_handle_t ota_handle = 0;
     const esp_partition_t *ota_partition = NULL;
     uint8_t *download_buffer = NULL;
-    const size_t CHUNK_SIZE = 2048;  // Download in 2KB chunks
+    const size_t CHUNK_SIZE = OTA_MODEM_SHREAD_WINDOW;  // One AT+SHREAD per chunk
     bool ota_started = false;
     int last_progress = -10;
 
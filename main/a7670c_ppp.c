@@ -14,6 +14,7 @@
 #include "lwip/sockets.h"
 #include "netif/ppp/pppapi.h"
 #include "a7670c_ppp.h"
+#include "cmux.h"
 
 static const char *TAG = "A7670C_PPP";
 
@@ -29,14 +30,47 @@ static const int PPP_CONNECTED_BIT = BIT0;
 // UART RX task control
 static TaskHandle_t uart_rx_task_handle = NULL;
 static volatile bool uart_rx_task_running = false;
+static QueueHandle_t uart_event_queue = NULL;
+static uint8_t uart_rx_chunk[MODEM_UART_RX_CHUNK];
+static uint32_t uart_rx_overflows = 0;
+
+// Link rate: starts at baud_rate, ppp_baud_rate once the modem accepted AT+IPR
+static int current_baud = 0;
+static bool flow_ctrl = false;
 
 // Modem mutex to prevent race conditions during init/deinit
 static SemaphoreHandle_t modem_mutex = NULL;
 static volatile bool uart_initialized = false;
 
-// Signal strength storage (checked before entering PPP mode)
+// Signal strength storage (checked before entering PPP mode, refreshed over CMUX)
 static signal_strength_t current_signal = {0};
 static bool signal_checked = false;
+static int64_t signal_read_at_ms = 0;
+
+// CMUX (MODEM_CMUX_ENABLED): PPP on DLC 1, AT commands on DLC 2, DLC 0 is control
+#define DLC_CONTROL 0
+#define DLC_PPP     1
+#define DLC_AT      2
+#define DLC_NONE    0xFF
+#define CMUX_UA_BIT(dlci)   (BIT1 << (dlci))    // BIT1..BIT3 in ppp_event_group
+#define CMUX_DM_BIT         BIT4
+#define CMUX_AT_DONE_BIT    BIT5                // Expected text seen on at_dlci
+#define CMUX_AT_ERROR_BIT   BIT6                // "ERROR" seen on at_dlci
+
+static volatile bool cmux_active = false;       // UART carries frames, not raw AT/PPP
+static volatile bool dlc_ppp_data = false;      // DLC 1 dialed, its data goes to PPP
+static uint8_t cmux_n1 = CMUX_N1;
+static cmux_decoder_t cmux_decoder;
+static SemaphoreHandle_t cmux_tx_mutex = NULL;
+static SemaphoreHandle_t cmux_at_mutex = NULL;
+static uint8_t cmux_tx_frame[CMUX_N1 + CMUX_FRAME_OVERHEAD];
+
+// Response of the AT command in flight on a DLC, filled by the RX task
+static char at_resp[512];
+static size_t at_resp_len = 0;
+static volatile uint8_t at_dlci = DLC_NONE;
+static const char *at_expected = NULL;
+static portMUX_TYPE at_resp_lock = portMUX_INITIALIZER_UNLOCKED;
 
 // Modem initialization failure tracking
 static uint8_t modem_init_failures = 0;
@@ -62,8 +96,9 @@ static uint32_t get_retry_delay_ms(void) {
 // UART buffers
 static uint8_t uart_rx_buffer[2048];
 
-// Send AT command and wait for response
-static esp_err_t send_at_command(const char* cmd, const char* expected, int timeout_ms) {
+// Send AT command on the raw UART and wait for response (copied to resp if given)
+static esp_err_t send_at_command_resp(const char* cmd, const char* expected,
+                                      char* resp, size_t resp_size, int timeout_ms) {
     // Check if UART is still initialized (prevents crash during deinit race condition)
     if (!uart_initialized) {
         ESP_LOGW(TAG, "UART not initialized, cannot send AT command");
@@ -100,6 +135,10 @@ static esp_err_t send_at_command(const char* cmd, const char* expected, int time
 
                 if (expected && strstr(response, expected)) {
                     ESP_LOGI(TAG, "<<< %s", response);
+                    if (resp != NULL && resp_size > 0) {
+                        strncpy(resp, response, resp_size - 1);
+                        resp[resp_size - 1] = '\0';
+                    }
                     return ESP_OK;
                 }
 
@@ -121,6 +160,10 @@ static esp_err_t send_at_command(const char* cmd, const char* expected, int time
     return ESP_ERR_TIMEOUT;
 }
 
+static esp_err_t send_at_command(const char* cmd, const char* expected, int timeout_ms) {
+    return send_at_command_resp(cmd, expected, NULL, 0, timeout_ms);
+}
+
 // Hardware reset modem using combined power cycle + RESET pin (for SIM re-detection)
 static esp_err_t hardware_reset_modem(void) {
     ESP_LOGI(TAG, "🔄 Performing complete modem reset (power + hardware reset)...");
@@ -168,7 +211,9 @@ static esp_err_t power_on_modem(void) {
     ESP_LOGI(TAG, "   PWR Pin: GPIO %d", modem_config.pwr_pin);
     ESP_LOGI(TAG, "   UART TX: GPIO %d", modem_config.tx_pin);
     ESP_LOGI(TAG, "   UART RX: GPIO %d", modem_config.rx_pin);
-    ESP_LOGI(TAG, "   Baud Rate: %d", modem_config.baud_rate);
+    ESP_LOGI(TAG, "   Baud Rate: %d (PPP: %d, RTS/CTS: %s)", modem_config.baud_rate,
+             modem_config.ppp_baud_rate > 0 ? modem_config.ppp_baud_rate : modem_config.baud_rate,
+             flow_ctrl ? "on" : "off");
 
     // Power key pulse: LOW for 1.5s, then HIGH
     ESP_LOGI(TAG, "   Sending power-on pulse (LOW for 1.5s)...");
@@ -188,46 +233,326 @@ static esp_err_t power_on_modem(void) {
     return ESP_OK;
 }
 
-// PPP transmit callback - sends data from PPP stack to modem via UART
+// Send one CMUX frame (UIH data or a SABM/DISC command from us as initiator)
+static esp_err_t cmux_send(uint8_t dlci, uint8_t control, const uint8_t *data, size_t len) {
+    if (cmux_tx_mutex == NULL || xSemaphoreTake(cmux_tx_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    size_t n = cmux_encode(dlci, control, true, data, len, cmux_tx_frame, sizeof(cmux_tx_frame));
+    if (n > 0) {
+        uart_write_bytes(modem_config.uart_num, (const char*)cmux_tx_frame, n);
+    }
+    xSemaphoreGive(cmux_tx_mutex);
+    return n > 0 ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+// Text on the DLC an AT command is waiting on; completes it on the expected reply or ERROR
+static void cmux_at_append(const uint8_t *data, size_t len) {
+    EventBits_t done = 0;
+    portENTER_CRITICAL(&at_resp_lock);
+    if (at_dlci != DLC_NONE) {
+        size_t n = len < sizeof(at_resp) - 1 - at_resp_len ? len : sizeof(at_resp) - 1 - at_resp_len;
+        memcpy(at_resp + at_resp_len, data, n);
+        at_resp_len += n;
+        at_resp[at_resp_len] = '\0';
+        if (at_expected != NULL && strstr(at_resp, at_expected)) {
+            done = CMUX_AT_DONE_BIT;
+        } else if (strstr(at_resp, "ERROR") || strstr(at_resp, "NO CARRIER")) {
+            done = CMUX_AT_ERROR_BIT;
+        }
+        if (done) {
+            at_dlci = DLC_NONE;
+        }
+    }
+    portEXIT_CRITICAL(&at_resp_lock);
+    if (done) {
+        xEventGroupSetBits(ppp_event_group, done);
+    }
+}
+
+// Decoder callback, runs in uart_rx_task
+static void cmux_on_frame(void *ctx, uint8_t dlci, uint8_t control, const uint8_t *data, size_t len) {
+    if (control == CMUX_UA && dlci <= DLC_AT) {
+        xEventGroupSetBits(ppp_event_group, CMUX_UA_BIT(dlci));
+        return;
+    }
+    if (control == CMUX_DM) {
+        xEventGroupSetBits(ppp_event_group, CMUX_DM_BIT);
+        return;
+    }
+    if (control == CMUX_DISC) {
+        ESP_LOGW(TAG, "[CMUX] Modem closed DLC %d", dlci);
+        return;
+    }
+    if (control != CMUX_UIH) {
+        return;
+    }
+
+    if (dlci == DLC_CONTROL) {
+        // Answer the modem's MSC commands with the same values as a response
+        if (len >= 2 && data[0] == (CMUX_MSG_MSC | CMUX_CR) && len <= 8) {
+            uint8_t reply[8];
+            memcpy(reply, data, len);
+            reply[0] = CMUX_MSG_MSC;
+            cmux_send(DLC_CONTROL, CMUX_UIH, reply, len);
+        }
+        return;
+    }
+    if (dlci == DLC_PPP && dlc_ppp_data) {
+        esp_netif_t *netif_local = ppp_netif;
+        if (netif_local != NULL && uart_rx_task_running) {
+            esp_netif_receive(netif_local, (void*)data, len, NULL);
+        }
+        return;
+    }
+    if (dlci == at_dlci) {
+        cmux_at_append(data, len);
+    }
+}
+
+// PPP transmit callback - sends data from PPP stack to modem via UART (DLC 1 frames when multiplexed).
+// uart_write_bytes only blocks once MODEM_UART_TX_BUF is full (or the modem holds CTS).
 static esp_err_t ppp_output_callback(void *ctx, void *data, size_t len) {
-    uart_write_bytes(modem_config.uart_num, (const char*)data, len);
+    if (!cmux_active) {
+        uart_write_bytes(modem_config.uart_num, (const char*)data, len);
+        return ESP_OK;
+    }
+    const uint8_t *p = (const uint8_t*)data;
+    while (len > 0) {
+        size_t chunk = len < cmux_n1 ? len : cmux_n1;
+        esp_err_t ret = cmux_send(DLC_PPP, CMUX_UIH, p, chunk);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        p += chunk;
+        len -= chunk;
+    }
     return ESP_OK;
 }
 
-// UART receive task - feeds data from modem to PPP stack
-static void uart_rx_task(void *pvParameters) {
-    uint8_t *data = (uint8_t*)malloc(2048);
-    if (data == NULL) {
-        ESP_LOGE(TAG, "[PPP] Failed to allocate UART RX buffer - task cannot start");
-        uart_rx_task_handle = NULL;
-        vTaskDelete(NULL);
+// Hand received bytes to the CMUX decoder or straight to PPP
+static void uart_rx_deliver(uint8_t *data, size_t len) {
+    if (cmux_active) {
+        cmux_decode(&cmux_decoder, data, len, cmux_on_frame, NULL);
         return;
     }
+    // Take local copy of netif pointer to avoid race condition
+    // (netif could be destroyed between check and use)
+    esp_netif_t *netif_local = ppp_netif;
+    if (netif_local != NULL && uart_rx_task_running) {
+        // Feed received data to PPP stack
+        esp_netif_receive(netif_local, data, len, NULL);
+    }
+}
+
+// UART receive task - woken by the driver's RX-full / RX-timeout events instead of
+// polling, drains whatever is buffered and feeds it to the PPP stack
+static void uart_rx_task(void *pvParameters) {
     uart_rx_task_running = true;
+    xQueueReset(uart_event_queue);   // Events from AT traffic while the task was stopped
 
-    ESP_LOGI(TAG, "UART RX task started");
+    ESP_LOGI(TAG, "UART RX task started (%d baud, flow control %s)", current_baud, flow_ctrl ? "on" : "off");
 
     while (uart_rx_task_running) {
-        int len = uart_read_bytes(modem_config.uart_num, data, 2048, pdMS_TO_TICKS(100));
-        if (len > 0) {
-            // Take local copy of netif pointer to avoid race condition
-            // (netif could be destroyed between check and use)
-            esp_netif_t *netif_local = ppp_netif;
-            if (netif_local != NULL && uart_rx_task_running) {
-                // Feed received data to PPP stack
-                esp_netif_receive(netif_local, data, len, NULL);
+        uart_event_t event;
+        if (xQueueReceive(uart_event_queue, &event, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+        if (event.type == UART_FIFO_OVF || event.type == UART_BUFFER_FULL) {
+            // Bytes were lost; PPP drops the damaged frame on its FCS and retransmits
+            uart_rx_overflows++;
+            ESP_LOGW(TAG, "[PPP] UART RX overflow #%lu (%s)", (unsigned long)uart_rx_overflows,
+                     flow_ctrl ? "flow control on" : "consider wiring RTS/CTS");
+        } else if (event.type != UART_DATA) {
+            continue;
+        }
+
+        size_t buffered = 0;
+        uart_get_buffered_data_len(modem_config.uart_num, &buffered);
+        while (buffered > 0 && uart_rx_task_running) {
+            size_t want = buffered < sizeof(uart_rx_chunk) ? buffered : sizeof(uart_rx_chunk);
+            int len = uart_read_bytes(modem_config.uart_num, uart_rx_chunk, want, 0);
+            if (len <= 0) {
+                break;
             }
+            uart_rx_deliver(uart_rx_chunk, len);
+            buffered -= len;
         }
     }
 
-    // Ensure buffer is freed even if task is being force-deleted
-    free(data);
-    data = NULL;
     ESP_LOGI(TAG, "UART RX task stopped cleanly");
     uart_rx_task_handle = NULL;
     vTaskDelete(NULL);
 }
 
+static void start_uart_rx_task(void) {
+    if (uart_rx_task_handle == NULL) {
+        xTaskCreate(uart_rx_task, "uart_rx", 3072, NULL, 12, &uart_rx_task_handle);  // Reduced from 4096 to save 1KB
+    }
+}
+
+static void stop_uart_rx_task(void) {
+    if (uart_rx_task_handle == NULL) {
+        return;
+    }
+    uart_rx_task_running = false;
+
+    // Wait for task to stop (up to 1 second)
+    int wait_count = 0;
+    while (uart_rx_task_handle != NULL && wait_count < 10) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        wait_count++;
+    }
+
+    if (uart_rx_task_handle != NULL) {
+        ESP_LOGW(TAG, "UART RX task did not stop gracefully, forcing delete");
+        vTaskDelete(uart_rx_task_handle);
+        uart_rx_task_handle = NULL;
+    }
+}
+
+// Send an AT command on a DLC and wait until the RX task has seen the expected reply
+static esp_err_t cmux_at_command(uint8_t dlci, const char* cmd, const char* expected,
+                                 char* resp, size_t resp_size, int timeout_ms) {
+    if (xSemaphoreTake(cmux_at_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    char line[128];
+    int n = snprintf(line, sizeof(line), "%s\r", cmd);
+    if (n >= (int)sizeof(line) || n > cmux_n1) {
+        xSemaphoreGive(cmux_at_mutex);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ESP_LOGI(TAG, ">>> [DLC%d] %s", dlci, cmd);
+    xEventGroupClearBits(ppp_event_group, CMUX_AT_DONE_BIT | CMUX_AT_ERROR_BIT);
+    portENTER_CRITICAL(&at_resp_lock);
+    at_resp_len = 0;
+    at_resp[0] = '\0';
+    at_expected = expected;
+    at_dlci = dlci;
+    portEXIT_CRITICAL(&at_resp_lock);
+
+    esp_err_t ret = cmux_send(dlci, CMUX_UIH, (const uint8_t*)line, n);
+    if (ret == ESP_OK) {
+        EventBits_t bits = xEventGroupWaitBits(ppp_event_group, CMUX_AT_DONE_BIT | CMUX_AT_ERROR_BIT,
+                                               pdTRUE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+        ret = (bits & CMUX_AT_DONE_BIT) ? ESP_OK : (bits & CMUX_AT_ERROR_BIT) ? ESP_FAIL : ESP_ERR_TIMEOUT;
+    }
+
+    portENTER_CRITICAL(&at_resp_lock);
+    at_dlci = DLC_NONE;
+    portEXIT_CRITICAL(&at_resp_lock);
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "<<< [DLC%d] %s", dlci, at_resp);
+        if (resp != NULL && resp_size > 0) {
+            strncpy(resp, at_resp, resp_size - 1);
+            resp[resp_size - 1] = '\0';
+        }
+    } else {
+        ESP_LOGW(TAG, "[DLC%d] %s failed (%s): %s", dlci, cmd, esp_err_to_name(ret), at_resp);
+    }
+    xSemaphoreGive(cmux_at_mutex);
+    return ret;
+}
+
+// AT command wherever the modem can take one: DLC 2 while multiplexed, the raw
+// UART while PPP is not running. Raw PPP leaves no AT channel.
+static esp_err_t modem_at(const char* cmd, const char* expected, char* resp, size_t resp_size, int timeout_ms) {
+    if (cmux_active) {
+        return cmux_at_command(DLC_AT, cmd, expected, resp, resp_size, timeout_ms);
+    }
+    if (uart_rx_task_handle == NULL) {
+        return send_at_command_resp(cmd, expected, resp, resp_size, timeout_ms);
+    }
+    return ESP_ERR_INVALID_STATE;
+}
+
+// AT+CMUX <port_speed> for the configured baud rate
+static int cmux_port_speed(int baud_rate) {
+    static const int rates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+    for (int i = 0; i < (int)(sizeof(rates) / sizeof(rates[0])); i++) {
+        if (rates[i] == baud_rate) {
+            return i + 1;
+        }
+    }
+    return 5;
+}
+
+// Close down the multiplexer; the modem returns to plain AT mode on the UART
+static void cmux_close_down(void) {
+    static const uint8_t cld[] = {CMUX_MSG_CLD | CMUX_CR, CMUX_EA};
+    cmux_send(DLC_CONTROL, CMUX_UIH, cld, sizeof(cld));
+}
+
+static void cmux_stop(void) {
+    if (!cmux_active) {
+        return;
+    }
+    ESP_LOGI(TAG, "[CMUX] Closing multiplexer");
+    dlc_ppp_data = false;
+    cmux_close_down();
+    vTaskDelay(pdMS_TO_TICKS(300));
+    stop_uart_rx_task();
+    cmux_active = false;
+    uart_flush(modem_config.uart_num);
+}
+
+// Enter CMUX from AT mode and open the control, PPP and AT channels
+static esp_err_t cmux_start(void) {
+    char cmd[40];
+    snprintf(cmd, sizeof(cmd), "AT+CMUX=0,0,%d,%d", cmux_port_speed(current_baud), CMUX_N1);
+    cmux_n1 = CMUX_N1;
+    if (send_at_command(cmd, "OK", 2000) != ESP_OK) {
+        // Defaults of 27.010: N1 = 31
+        ESP_LOGW(TAG, "[CMUX] Modem refused N1=%d, trying defaults", CMUX_N1);
+        if (send_at_command("AT+CMUX=0", "OK", 2000) != ESP_OK) {
+            ESP_LOGW(TAG, "[CMUX] Not supported, using PPP on the raw UART");
+            return ESP_FAIL;
+        }
+        cmux_n1 = 31;
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    uart_flush(modem_config.uart_num);
+
+    cmux_decoder_init(&cmux_decoder);
+    dlc_ppp_data = false;
+    cmux_active = true;
+    start_uart_rx_task();
+
+    for (uint8_t dlci = DLC_CONTROL; dlci <= DLC_AT; dlci++) {
+        xEventGroupClearBits(ppp_event_group, CMUX_UA_BIT(dlci) | CMUX_DM_BIT);
+        cmux_send(dlci, CMUX_SABM | CMUX_PF, NULL, 0);
+        EventBits_t bits = xEventGroupWaitBits(ppp_event_group, CMUX_UA_BIT(dlci) | CMUX_DM_BIT,
+                                               pdTRUE, pdFALSE, pdMS_TO_TICKS(CMUX_OPEN_TIMEOUT_MS));
+        if (!(bits & CMUX_UA_BIT(dlci))) {
+            ESP_LOGE(TAG, "[CMUX] DLC %d not opened (%s)", dlci, (bits & CMUX_DM_BIT) ? "DM" : "timeout");
+            cmux_stop();
+            return ESP_FAIL;
+        }
+    }
+
+    // Raise DTR/RTS on the data channels (DV, RTR, RTC, EA)
+    for (uint8_t dlci = DLC_PPP; dlci <= DLC_AT; dlci++) {
+        uint8_t msc[] = {CMUX_MSG_MSC | CMUX_CR, 2 << 1 | CMUX_EA, dlci << 2 | CMUX_CR | CMUX_EA, 0x8D};
+        cmux_send(DLC_CONTROL, CMUX_UIH, msc, sizeof(msc));
+    }
+
+    ESP_LOGI(TAG, "[CMUX] Active: PPP on DLC %d, AT on DLC %d, N1=%d", DLC_PPP, DLC_AT, cmux_n1);
+    return ESP_OK;
+}
+
+// Dial the data call on DLC 1; its traffic goes to PPP from then on
+static esp_err_t cmux_dial(void) {
+    esp_err_t ret = cmux_at_command(DLC_PPP, "ATD*99#", "CONNECT", NULL, 0, CMUX_DIAL_TIMEOUT_MS);
+    if (ret == ESP_OK) {
+        dlc_ppp_data = true;
+    }
+    return ret;
+}
+
 // Helper function to exit PPP data mode
 static void exit_ppp_data_mode(void) {
     ESP_LOGI(TAG, "🔄 Attempting to exit PPP data mode...");
@@ -291,6 +616,80 @@ static void exit_ppp_data_mode(void) {
     ESP_LOGI(TAG, "   PPP exit sequence complete");
 }
 
+// Quick AT check at the current UART rate. A modem left in CMUX by an ESP32
+// reset ignores plain AT, so it is closed down and asked again.
+static esp_err_t probe_modem(void) {
+    uart_flush(modem_config.uart_num);
+    esp_err_t ret = send_at_command("AT", "OK", 500);  // Quick check with short timeout
+    if (ret != ESP_OK && MODEM_CMUX_ENABLED) {
+        ESP_LOGW(TAG, "⚠️ Modem not responding to AT command, sending CMUX close down");
+        cmux_close_down();
+        vTaskDelay(pdMS_TO_TICKS(500));
+        uart_flush(modem_config.uart_num);
+        ret = send_at_command("AT", "OK", 500);
+    }
+    return ret;
+}
+
+// Hardware flow control on the modem side and the PPP baud rate (AT+IPR).
+// Stays at the current rate if the modem refuses or stops answering at the new
+// one. Fails only if the modem answers at neither rate afterwards.
+static esp_err_t negotiate_link(void) {
+    if (flow_ctrl && send_at_command("AT+IFC=2,2", "OK", 1000) != ESP_OK) {
+        ESP_LOGW(TAG, "Modem refused RTS/CTS (AT+IFC=2,2)");
+    }
+
+    int target = modem_config.ppp_baud_rate;
+    if (target <= 0 || target == current_baud) {
+        return ESP_OK;
+    }
+    if (target > 115200 && !flow_ctrl) {
+        ESP_LOGW(TAG, "PPP at %d baud without RTS/CTS - RX overruns are possible", target);
+    }
+
+    char cmd[24];
+    snprintf(cmd, sizeof(cmd), "AT+IPR=%d", target);
+    if (send_at_command(cmd, "OK", 1000) != ESP_OK) {
+        ESP_LOGW(TAG, "Modem refused %d baud, staying at %d", target, current_baud);
+        return ESP_OK;
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    uart_set_baudrate(modem_config.uart_num, target);
+    uart_flush(modem_config.uart_num);
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        if (send_at_command("AT", "OK", 500) == ESP_OK) {
+            ESP_LOGI(TAG, "✓ Link at %d baud (was %d)", target, current_baud);
+            current_baud = target;
+            return ESP_OK;
+        }
+    }
+
+    // The modem acknowledged AT+IPR, so it most likely runs at the target rate
+    // but the line does not carry it. Ask it back to the old rate at the new
+    // one, then check where it actually answers - the old rate first.
+    ESP_LOGW(TAG, "No AT response at %d baud, reverting to %d", target, current_baud);
+    snprintf(cmd, sizeof(cmd), "AT+IPR=%d", current_baud);
+    send_at_command(cmd, "OK", 1000);
+    vTaskDelay(pdMS_TO_TICKS(100));
+
+    const int rates[2] = { current_baud, target };
+    for (int i = 0; i < 2; i++) {
+        uart_set_baudrate(modem_config.uart_num, rates[i]);
+        if (probe_modem() == ESP_OK) {
+            if (rates[i] == target) {
+                ESP_LOGW(TAG, "Modem still at %d baud - keeping it", target);
+            }
+            current_baud = rates[i];
+            return ESP_OK;
+        }
+    }
+
+    ESP_LOGE(TAG, "Modem answers at neither %d nor %d baud after AT+IPR", rates[0], target);
+    uart_set_baudrate(modem_config.uart_num, rates[0]);
+    return ESP_FAIL;
+}
+
 // Initialize modem for PPP
 static esp_err_t init_modem_for_ppp(void) {
     // Test communication with retry logic (modem might be in unknown state after reboot)
@@ -303,8 +702,20 @@ static esp_err_t init_modem_for_ppp(void) {
 
     // IMPORTANT: On ESP32 reboot, modem may still be in PPP data mode from previous session
     // Try a quick AT command first, if it fails, immediately try to exit PPP mode
-    uart_flush(modem_config.uart_num);
-    ret = send_at_command("AT", "OK", 500);  // Quick check with short timeout
+    ret = probe_modem();
+
+    if (ret != ESP_OK && modem_config.ppp_baud_rate > 0 && modem_config.ppp_baud_rate != modem_config.baud_rate) {
+        // The modem keeps AT+IPR, so after an ESP32 reset it may still run at the PPP rate
+        int other = (current_baud == modem_config.baud_rate) ? modem_config.ppp_baud_rate : modem_config.baud_rate;
+        ESP_LOGW(TAG, "⚠️ No AT response at %d baud, trying %d", current_baud, other);
+        uart_set_baudrate(modem_config.uart_num, other);
+        ret = probe_modem();
+        if (ret == ESP_OK) {
+            current_baud = other;
+        } else {
+            uart_set_baudrate(modem_config.uart_num, current_baud);
+        }
+    }
 
     if (ret != ESP_OK) {
         // Modem not responding - likely still in PPP data mode
@@ -355,6 +766,10 @@ static esp_err_t init_modem_for_ppp(void) {
     // Disable echo
     send_at_command("ATE0", "OK", 1000);
 
+    if (negotiate_link() != ESP_OK) {
+        return ESP_FAIL;          // The next init probes both rates again
+    }
+
     // Configure modem for automatic mode selection (2G/3G/4G)
     ESP_LOGI(TAG, "📡 Configuring modem for automatic network selection...");
     send_at_command("AT+CNMP=2", "OK", 2000);   // Set to automatic mode (2 = Auto)
@@ -440,6 +855,7 @@ static esp_err_t init_modem_for_ppp(void) {
     ESP_LOGI(TAG, "📶 Checking signal strength...");
     if (a7670c_get_signal_strength(&current_signal) == ESP_OK) {
         signal_checked = true;
+        signal_read_at_ms = esp_timer_get_time() / 1000;
     } else {
         ESP_LOGW(TAG, "Failed to get signal strength, continuing anyway...");
         signal_checked = false;
@@ -456,6 +872,17 @@ static esp_err_t init_modem_for_ppp(void) {
     }
     vTaskDelay(pdMS_TO_TICKS(1000));
 
+    // Multiplex the UART so AT commands keep working while PPP runs
+    if (MODEM_CMUX_ENABLED && cmux_start() == ESP_OK) {
+        ESP_LOGI(TAG, "🔗 Entering PPP mode on DLC %d...", DLC_PPP);
+        if (cmux_dial() == ESP_OK) {
+            ESP_LOGI(TAG, "✓ PPP mode active (CMUX)!");
+            return ESP_OK;
+        }
+        ESP_LOGW(TAG, "Dial over CMUX failed, falling back to raw PPP");
+        cmux_stop();
+    }
+
     // Enter PPP mode
     ESP_LOGI(TAG, "🔗 Entering PPP mode...");
     uart_flush(modem_config.uart_num);
@@ -545,20 +972,38 @@ esp_err_t a7670c_ppp_init(const ppp_config_t* config) {
         return ESP_FAIL;
     }
 
-    // Configure UART
+    if (cmux_tx_mutex == NULL) {
+        cmux_tx_mutex = xSemaphoreCreateMutex();
+    }
+    if (cmux_at_mutex == NULL) {
+        cmux_at_mutex = xSemaphoreCreateMutex();
+    }
+    if (cmux_tx_mutex == NULL || cmux_at_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create CMUX mutexes");
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Configure UART (RTS/CTS only when both pins are wired)
+    flow_ctrl = modem_config.rts_pin > 0 && modem_config.cts_pin > 0;
+    current_baud = modem_config.baud_rate;
     uart_config_t uart_config = {
         .baud_rate = modem_config.baud_rate,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
-        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .flow_ctrl = flow_ctrl ? UART_HW_FLOWCTRL_CTS_RTS : UART_HW_FLOWCTRL_DISABLE,
+        .rx_flow_ctrl_thresh = MODEM_UART_FLOW_THRESH,
         .source_clk = UART_SCLK_APB,
     };
 
     ESP_ERROR_CHECK(uart_param_config(modem_config.uart_num, &uart_config));
-    ESP_ERROR_CHECK(uart_set_pin(modem_config.uart_num, modem_config.tx_pin,
-                                 modem_config.rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
-    ESP_ERROR_CHECK(uart_driver_install(modem_config.uart_num, 2048, 2048, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_set_pin(modem_config.uart_num, modem_config.tx_pin, modem_config.rx_pin,
+                                 flow_ctrl ? modem_config.rts_pin : UART_PIN_NO_CHANGE,
+                                 flow_ctrl ? modem_config.cts_pin : UART_PIN_NO_CHANGE));
+    ESP_ERROR_CHECK(uart_driver_install(modem_config.uart_num, MODEM_UART_RX_BUF, MODEM_UART_TX_BUF,
+                                        MODEM_UART_EVENT_QUEUE, &uart_event_queue, 0));
+    uart_set_rx_full_threshold(modem_config.uart_num, MODEM_UART_RX_FULL_THRESH);
+    uart_set_rx_timeout(modem_config.uart_num, MODEM_UART_RX_TOUT_SYMBOLS);
     uart_initialized = true;  // Mark UART as ready for use
 
     // Configure power pin
@@ -618,6 +1063,24 @@ esp_err_t a7670c_ppp_connect(void) {
     ESP_LOGI(TAG, "📡 Initializing A7670C Modem...");
     ESP_LOGI(TAG, "===========================================");
 
+    // Clean up any existing PPP resources from previous session/attempt.
+    // Done before talking to the modem so the old RX task cannot eat AT replies.
+    stop_uart_rx_task();
+    cmux_active = false;
+    dlc_ppp_data = false;
+    if (ppp_netif != NULL) {
+        ESP_LOGW(TAG, "🧹 Cleaning up existing PPP netif from previous session...");
+
+        // Stop and destroy old netif
+        esp_netif_action_stop(ppp_netif, NULL, 0, NULL);
+        vTaskDelay(pdMS_TO_TICKS(500));
+        esp_netif_destroy(ppp_netif);
+        ppp_netif = NULL;
+        ppp_connected = false;
+        xEventGroupClearBits(ppp_event_group, PPP_CONNECTED_BIT);
+        ESP_LOGI(TAG, "   Old PPP resources cleaned up");
+    }
+
     // Check if we need to reset modem due to repeated failures
     if (modem_init_failures >= MAX_MODEM_INIT_FAILURES) {
         modem_power_cycle_count++;
@@ -660,27 +1123,6 @@ esp_err_t a7670c_ppp_connect(void) {
     }
     modem_init_failures = 0;
 
-    // Clean up any existing PPP resources from previous session/attempt
-    if (ppp_netif != NULL) {
-        ESP_LOGW(TAG, "🧹 Cleaning up existing PPP netif from previous session...");
-
-        // Stop UART RX task first
-        if (uart_rx_task_handle != NULL) {
-            uart_rx_task_running = false;
-            vTaskDelay(pdMS_TO_TICKS(200));  // Give task time to exit
-            uart_rx_task_handle = NULL;
-        }
-
-        // Stop and destroy old netif
-        esp_netif_action_stop(ppp_netif, NULL, 0, NULL);
-        vTaskDelay(pdMS_TO_TICKS(500));
-        esp_netif_destroy(ppp_netif);
-        ppp_netif = NULL;
-        ppp_connected = false;
-        xEventGroupClearBits(ppp_event_group, PPP_CONNECTED_BIT);
-        ESP_LOGI(TAG, "   Old PPP resources cleaned up");
-    }
-
     ESP_LOGI(TAG, "🔧 Creating PPP network interface...");
 
     // Create PPP network interface using default configuration
@@ -719,8 +1161,8 @@ esp_err_t a7670c_ppp_connect(void) {
     esp_netif_action_connected(ppp_netif, 0, 0, NULL);
     esp_netif_action_start(ppp_netif, 0, 0, NULL);
 
-    // Start UART receive task to feed data to PPP
-    xTaskCreate(uart_rx_task, "uart_rx", 3072, NULL, 12, &uart_rx_task_handle);  // Reduced from 4096 to save 1KB
+    // Start UART receive task to feed data to PPP (already running when multiplexed)
+    start_uart_rx_task();
 
     // Wait for IP
     ESP_LOGI(TAG, "⏳ Waiting for PPP IP address...");
@@ -773,7 +1215,8 @@ esp_err_t a7670c_ppp_disconnect(void) {
         vTaskDelay(pdMS_TO_TICKS(3000));
     }
 
-    // Step 2: Stop UART RX task to stop feeding data to PPP
+    // Step 2: Stop UART RX task to stop feeding data to PPP (leaving CMUX first if active)
+    cmux_stop();
     if (uart_rx_task_handle != NULL) {
         ESP_LOGI(TAG, "Stopping UART RX task...");
         uart_rx_task_running = false;
@@ -874,6 +1317,11 @@ esp_err_t a7670c_ppp_deinit(void) {
     if (modem_config.reset_pin >= 0) {
         gpio_reset_pin(modem_config.reset_pin);
     }
+    if (flow_ctrl) {
+        gpio_reset_pin(modem_config.rts_pin);
+        gpio_reset_pin(modem_config.cts_pin);
+    }
+    uart_event_queue = NULL;  // Deleted with the driver
 
     // Clear state variables
     ppp_connected = false;
@@ -921,7 +1369,7 @@ esp_err_t a7670c_ppp_get_ip_info(char* ip_str, size_t ip_str_size) {
     return ESP_FAIL;
 }
 
-// Get signal strength
+// Get signal strength (raw UART before PPP, DLC 2 while multiplexed)
 esp_err_t a7670c_get_signal_strength(signal_strength_t* signal) {
     if (signal == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -937,117 +1385,117 @@ esp_err_t a7670c_get_signal_strength(signal_strength_t* signal) {
 
     char response[256] = {0};
 
-    // Send AT+CSQ command
-    ESP_LOGI(TAG, ">>> AT+CSQ");
-    const char* cmd = "AT+CSQ\r\n";
-    uart_write_bytes(modem_config.uart_num, cmd, strlen(cmd));
+    if (modem_at("AT+CSQ", "OK", response, sizeof(response), 2000) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get signal strength");
+        return ESP_ERR_TIMEOUT;
+    }
 
-    // Wait for response
-    int len = 0;
-    int total_len = 0;
-    int64_t start_time = esp_timer_get_time() / 1000;
+    // Parse response: +CSQ: <rssi>,<ber>
+    char* csq_start = strstr(response, "+CSQ:");
+    int rssi, ber;
+    if (csq_start == NULL || sscanf(csq_start, "+CSQ: %d,%d", &rssi, &ber) != 2) {
+        ESP_LOGE(TAG, "Failed to parse signal strength: %s", response);
+        return ESP_FAIL;
+    }
+    signal->rssi = rssi;
+    signal->ber = ber;
+
+    // Convert RSSI to dBm
+    if (rssi == 99) {
+        signal->rssi_dbm = -999;  // Unknown
+        signal->quality = "Unknown";
+    } else if (rssi >= 0 && rssi <= 31) {
+        signal->rssi_dbm = -113 + (rssi * 2);
+
+        // Determine quality
+        if (rssi >= 20) {
+            signal->quality = "Excellent";
+        } else if (rssi >= 15) {
+            signal->quality = "Good";
+        } else if (rssi >= 10) {
+            signal->quality = "Fair";
+        } else if (rssi >= 5) {
+            signal->quality = "Poor";
+        } else {
+            signal->quality = "Very Poor";
+        }
+    } else {
+        signal->rssi_dbm = -999;
+        signal->quality = "Invalid";
+    }
 
-    while ((esp_timer_get_time() / 1000 - start_time) < 2000) {
-        len = uart_read_bytes(modem_config.uart_num, uart_rx_buffer, sizeof(uart_rx_buffer),
-                             pdMS_TO_TICKS(100));
-        if (len > 0) {
-            if (total_len + len < sizeof(response)) {
-                memcpy(response + total_len, uart_rx_buffer, len);
-                total_len += len;
-                response[total_len] = '\0';
+    // Get operator name with AT+COPS? - parse: +COPS: 0,0,"Operator",<mode>
+    if (modem_at("AT+COPS?", "OK", response, sizeof(response), 2000) == ESP_OK) {
+        char* cops_start = strstr(response, "+COPS:");
+        char* op_start = cops_start ? strchr(cops_start, '"') : NULL;
+        if (op_start) {
+            op_start++;  // Skip opening quote
+            char* op_end = strchr(op_start, '"');
+            if (op_end) {
+                size_t op_len = op_end - op_start;
+                if (op_len < sizeof(signal->operator_name)) {
+                    strncpy(signal->operator_name, op_start, op_len);
+                    signal->operator_name[op_len] = '\0';
+                }
+            }
+        }
+    }
 
-                if (strstr(response, "+CSQ:")) {
-                    ESP_LOGI(TAG, "<<< %s", response);
+    ESP_LOGI(TAG, "📶 Signal: RSSI=%d (%d dBm), BER=%d, Quality=%s, Operator=%s",
+            signal->rssi, signal->rssi_dbm, signal->ber, signal->quality, signal->operator_name);
+    return ESP_OK;
+}
 
-                    // Parse response: +CSQ: <rssi>,<ber>
-                    char* csq_start = strstr(response, "+CSQ:");
-                    if (csq_start) {
-                        int rssi, ber;
-                        if (sscanf(csq_start, "+CSQ: %d,%d", &rssi, &ber) == 2) {
-                            signal->rssi = rssi;
-                            signal->ber = ber;
-
-                            // Convert RSSI to dBm
-                            if (rssi == 99) {
-                                signal->rssi_dbm = -999;  // Unknown
-                                signal->quality = "Unknown";
-                            } else if (rssi >= 0 && rssi <= 31) {
-                                signal->rssi_dbm = -113 + (rssi * 2);
-
-                                // Determine quality
-                                if (rssi >= 20) {
-                                    signal->quality = "Excellent";
-                                } else if (rssi >= 15) {
-                                    signal->quality = "Good";
-                                } else if (rssi >= 10) {
-                                    signal->quality = "Fair";
-                                } else if (rssi >= 5) {
-                                    signal->quality = "Poor";
-                                } else {
-                                    signal->quality = "Very Poor";
-                                }
-                            } else {
-                                signal->rssi_dbm = -999;
-                                signal->quality = "Invalid";
-                            }
-
-                            // Get operator name with AT+COPS?
-                            char cops_response[256] = {0};
-                            memset(uart_rx_buffer, 0, sizeof(uart_rx_buffer));
-                            vTaskDelay(pdMS_TO_TICKS(100));
-
-                            ESP_LOGI(TAG, ">>> AT+COPS?");
-                            const char* cops_cmd = "AT+COPS?\r\n";
-                            uart_write_bytes(modem_config.uart_num, cops_cmd, strlen(cops_cmd));
-
-                            int cops_len = 0;
-                            int cops_total = 0;
-                            int64_t cops_start = esp_timer_get_time() / 1000;
-
-                            while ((esp_timer_get_time() / 1000 - cops_start) < 2000) {
-                                cops_len = uart_read_bytes(modem_config.uart_num, uart_rx_buffer,
-                                                          sizeof(uart_rx_buffer), pdMS_TO_TICKS(100));
-                                if (cops_len > 0) {
-                                    if (cops_total + cops_len < sizeof(cops_response)) {
-                                        memcpy(cops_response + cops_total, uart_rx_buffer, cops_len);
-                                        cops_total += cops_len;
-                                        cops_response[cops_total] = '\0';
-
-                                        if (strstr(cops_response, "+COPS:")) {
-                                            // Parse: +COPS: 0,0,"Operator",<mode>
-                                            char* cops_start = strstr(cops_response, "+COPS:");
-                                            char* op_start = strchr(cops_start, '"');
-                                            if (op_start) {
-                                                op_start++;  // Skip opening quote
-                                                char* op_end = strchr(op_start, '"');
-                                                if (op_end) {
-                                                    size_t op_len = op_end - op_start;
-                                                    if (op_len < sizeof(signal->operator_name)) {
-                                                        strncpy(signal->operator_name, op_start, op_len);
-                                                        signal->operator_name[op_len] = '\0';
-                                                    }
-                                                }
-                                            }
-                                            break;
-                                        }
-                                    }
-                                }
-                                vTaskDelay(pdMS_TO_TICKS(10));
-                            }
-
-                            ESP_LOGI(TAG, "📶 Signal: RSSI=%d (%d dBm), BER=%d, Quality=%s, Operator=%s",
-                                    signal->rssi, signal->rssi_dbm, signal->ber, signal->quality, signal->operator_name);
-                            return ESP_OK;
-                        }
-                    }
+// Registration and serving cell, live over CMUX
+esp_err_t a7670c_get_network_info(modem_net_info_t* info) {
+    if (info == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(info, 0, sizeof(*info));
+    info->creg_stat = -1;
+
+    char response[256];
+    esp_err_t ret = modem_at("AT+CREG?", "OK", response, sizeof(response), 2000);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // +CREG: <n>,<stat>
+    char* creg = strstr(response, "+CREG:");
+    int n, stat;
+    if (creg && sscanf(creg, "+CREG: %d,%d", &n, &stat) == 2) {
+        info->creg_stat = stat;
+    }
+
+    // +CPSI: <system mode>,<operation mode>,<MCC>-<MNC>,<TAC/LAC>,<cell id>,...
+    if (modem_at("AT+CPSI?", "OK", response, sizeof(response), 2000) == ESP_OK) {
+        char* cpsi = strstr(response, "+CPSI: ");
+        if (cpsi) {
+            cpsi += 7;
+            size_t mode_len = strcspn(cpsi, ",\r\n");
+            if (mode_len < sizeof(info->system_mode)) {
+                memcpy(info->system_mode, cpsi, mode_len);
+                info->system_mode[mode_len] = '\0';
+            }
+            if (cpsi[mode_len] == ',') {
+                char* rest = cpsi + mode_len + 1;
+                size_t rest_len = strcspn(rest, "\r\n");
+                if (rest_len >= sizeof(info->cell_info)) {
+                    rest_len = sizeof(info->cell_info) - 1;
                 }
+                memcpy(info->cell_info, rest, rest_len);
+                info->cell_info[rest_len] = '\0';
             }
         }
-        vTaskDelay(pdMS_TO_TICKS(10));
     }
+    return ESP_OK;
+}
 
-    ESP_LOGE(TAG, "Failed to get signal strength");
-    return ESP_ERR_TIMEOUT;
+// Send an AT command while PPP is up (CMUX) or down (raw UART)
+esp_err_t a7670c_at_command(const char* cmd, const char* expected, char* resp, size_t resp_size, int timeout_ms) {
+    if (cmd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return modem_at(cmd, expected, resp, resp_size, timeout_ms);
 }
 
 // Restart modem (power cycle)
@@ -1091,6 +1539,17 @@ esp_err_t a7670c_get_stored_signal_strength(signal_strength_t* signal) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    // Over CMUX the stored value is re-read live once it is older than MODEM_SIGNAL_REFRESH_MS
+    int64_t now_ms = esp_timer_get_time() / 1000;
+    if (cmux_active && (!signal_checked || now_ms - signal_read_at_ms >= MODEM_SIGNAL_REFRESH_MS)) {
+        signal_strength_t fresh;
+        if (a7670c_get_signal_strength(&fresh) == ESP_OK) {
+            memcpy(&current_signal, &fresh, sizeof(signal_strength_t));
+            signal_checked = true;
+        }
+        signal_read_at_ms = now_ms;   // Also after a failure, so a dead DLC is not retried per call
+    }
+
     if (!signal_checked) {
         ESP_LOGW(TAG, "Signal strength not yet checked");
         return ESP_ERR_INVALID_STATE;
@@ -1114,6 +1573,25 @@ int a7670c_get_uart_num(void) {
 esp_err_t a7670c_ppp_pause_for_at(void) {
     ESP_LOGI(TAG, "🔄 Pausing PPP for AT command operations...");
 
+    if (cmux_active) {
+        // Multiplexed: close the mux and the modem is back in AT mode, no power cycle
+        if (ppp_netif != NULL) {
+            ESP_LOGI(TAG, "   Stopping PPP netif...");
+            esp_netif_action_disconnected(ppp_netif, NULL, 0, NULL);
+            esp_netif_action_stop(ppp_netif, NULL, 0, NULL);
+        }
+        cmux_stop();
+        for (int attempt = 1; attempt <= 3; attempt++) {
+            if (send_at_command("AT", "OK", 1000) == ESP_OK) {
+                send_at_command("ATE0", "OK", 1000);
+                ESP_LOGI(TAG, "✅ Modem ready for AT commands (left CMUX)");
+                return ESP_OK;
+            }
+            vTaskDelay(pdMS_TO_TICKS(500));
+        }
+        ESP_LOGW(TAG, "   No AT response after leaving CMUX, power cycling...");
+    }
+
     // Step 1: Stop UART RX task FIRST (critical - must stop before any modem operations)
     if (uart_rx_task_handle != NULL) {
         ESP_LOGI(TAG, "   Stopping UART RX task...");
@@ -1204,6 +1682,23 @@ esp_err_t a7670c_ppp_pause_for_at(void) {
 esp_err_t a7670c_ppp_resume(void) {
     ESP_LOGI(TAG, "🔄 Resuming PPP connection...");
 
+    if (MODEM_CMUX_ENABLED && ppp_netif != NULL && cmux_start() == ESP_OK) {
+        if (cmux_dial() == ESP_OK) {
+            xEventGroupClearBits(ppp_event_group, PPP_CONNECTED_BIT);
+            esp_netif_action_connected(ppp_netif, 0, 0, NULL);
+            esp_netif_action_start(ppp_netif, 0, 0, NULL);
+            EventBits_t bits = xEventGroupWaitBits(ppp_event_group, PPP_CONNECTED_BIT,
+                                                   pdFALSE, pdFALSE, pdMS_TO_TICKS(30000));
+            if (bits & PPP_CONNECTED_BIT) {
+                ESP_LOGI(TAG, "✅ PPP resumed over CMUX!");
+                return ESP_OK;
+            }
+            ESP_LOGW(TAG, "⚠️ PPP resume timeout - may need full reconnect");
+            return ESP_ERR_TIMEOUT;
+        }
+        cmux_stop();
+    }
+
     // Re-activate PDP context
     ESP_LOGI(TAG, "   Reactivating PDP context...");
     uart_write_bytes(modem_config.uart_num, "AT+CGACT=1,1\r\n", 14);
@@ -1226,7 +1721,7 @@ esp_err_t a7670c_ppp_resume(void) {
     // Restart UART RX task
     if (uart_rx_task_handle == NULL && ppp_netif != NULL) {
         ESP_LOGI(TAG, "   Restarting UART RX task...");
-        xTaskCreate(uart_rx_task, "uart_rx", 3072, NULL, 12, &uart_rx_task_handle);  // Reduced from 4096 to save 1KB
+        start_uart_rx_task();
     }
 
     // Wait for PPP to reconnect
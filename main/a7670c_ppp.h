@@ -26,6 +26,9 @@ typedef struct {
     int pwr_pin;
     int reset_pin;  // Hardware reset pin
     int baud_rate;
+    int rts_pin;        // ESP32 RTS -> modem CTS, <= 0 = not wired (no hardware flow control)
+    int cts_pin;        // ESP32 CTS <- modem RTS, <= 0 = not wired
+    int ppp_baud_rate;  // Switched to with AT+IPR before PPP, 0 = stay at baud_rate
 } ppp_config_t;
 
 // Signal strength structure
@@ -37,6 +40,13 @@ typedef struct {
     char operator_name[64];  // Network operator name
 } signal_strength_t;
 
+// Registration and serving cell (AT+CREG?, AT+CPSI?)
+typedef struct {
+    int creg_stat;           // 0 not registered, 1 home, 2 searching, 3 denied, 5 roaming, 6 SMS only, -1 unknown
+    char system_mode[16];    // "LTE", "WCDMA", "GSM", "NO SERVICE"
+    char cell_info[96];      // Rest of the +CPSI line: operation mode, MCC-MNC, TAC, cell id, ...
+} modem_net_info_t;
+
 // Function prototypes
 esp_err_t a7670c_ppp_init(const ppp_config_t* config);
 esp_err_t a7670c_ppp_deinit(void);
@@ -52,13 +62,20 @@ esp_err_t a7670c_get_signal_strength(signal_strength_t* signal);
 esp_err_t a7670c_get_stored_signal_strength(signal_strength_t* signal);
 esp_err_t a7670c_restart_modem(void);
 
+// Live modem queries. They work before PPP is up and, when MODEM_CMUX_ENABLED and
+// the modem accepted AT+CMUX, alongside PPP on a separate channel. With PPP on the
+// raw UART they return ESP_ERR_INVALID_STATE.
+esp_err_t a7670c_get_network_info(modem_net_info_t* info);
+esp_err_t a7670c_at_command(const char* cmd, const char* expected, char* resp, size_t resp_size, int timeout_ms);
+
 // Get recommended retry delay based on connection failure history (in milliseconds)
 uint32_t a7670c_get_retry_delay_ms(void);
 
 // Get UART number used by modem (for HTTP module access)
 int a7670c_get_uart_num(void);
 
-// Pause PPP for AT command operations (stops UART RX task, exits data mode)
+// Pause PPP for AT command operations (stops UART RX task, exits data mode;
+// leaves CMUX instead of power-cycling when multiplexed)
 // Returns ESP_OK if successful, original PPP state is preserved for resume
 esp_err_t a7670c_ppp_pause_for_at(void);
 
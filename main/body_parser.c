@@ -0,0 +1,458 @@
+// body_parser.c - Streaming form / JSON body parser
+
+#include <stdlib.h>
+#include <string.h>
+#include "body_parser.h"
+
+// JSON states
+enum {
+    J_ROOT = 0,       // Before the root '{'
+    J_OBJ_OPEN,       // After '{': member name or '}'
+    J_OBJ_MEMBER,     // After ',' in an object: member name
+    J_KEY,            // Inside a member name
+    J_COLON,
+    J_ARR_OPEN,       // After '[': value or ']'
+    J_VALUE,
+    J_STRING,         // Inside a string value
+    J_LITERAL,        // Number, true, false, null
+    J_AFTER_VALUE,    // ',' or the closing bracket
+    J_DONE,
+    J_ERROR
+};
+
+static int hex_nibble(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void append_key(body_parser_t *p, char c)
+{
+    if (p->key_len < BODY_KEY_MAX - 1) {
+        p->key[p->key_len++] = c;
+    } else {
+        p->overflow = true;
+    }
+}
+
+static void append_value(body_parser_t *p, char c)
+{
+    if (p->value_len < BODY_VALUE_MAX - 1) {
+        p->value[p->value_len++] = c;
+    } else {
+        p->overflow = true;
+    }
+}
+
+static void append_char(body_parser_t *p, bool to_value, char c)
+{
+    if (to_value) {
+        append_value(p, c);
+    } else {
+        append_key(p, c);
+    }
+}
+
+// Exact match; '#' consumes 1-4 digits into idx
+static bool key_matches(const char *pattern, const char *key, int *idx, int *n_idx)
+{
+    *n_idx = 0;
+    while (*pattern) {
+        if (*pattern == '#') {
+            if (*key < '0' || *key > '9' || *n_idx == BODY_MAX_INDICES) {
+                return false;
+            }
+            int value = 0, digits = 0;
+            while (*key >= '0' && *key <= '9' && digits < 4) {
+                value = value * 10 + (*key++ - '0');
+                digits++;
+            }
+            idx[(*n_idx)++] = value;
+            pattern++;
+        } else if (*pattern++ != *key++) {
+            return false;
+        }
+    }
+    return *key == '\0';
+}
+
+static void store(const body_field_t *field, void *record, const char *value)
+{
+    char *target = (char *)record + field->offset;
+
+    switch (field->type) {
+    case BODY_STR:
+        strncpy(target, value, field->size - 1);
+        target[field->size - 1] = '\0';
+        break;
+    case BODY_INT: {
+        long v = strtol(value, NULL, 10);
+        if (field->size == sizeof(int8_t)) {
+            *(int8_t *)target = (int8_t)v;
+        } else if (field->size == sizeof(int16_t)) {
+            *(int16_t *)target = (int16_t)v;
+        } else {
+            *(int32_t *)target = (int32_t)v;
+        }
+        break;
+    }
+    case BODY_FLOAT:
+        *(float *)target = strtof(value, NULL);
+        break;
+    case BODY_BOOL:
+        *(bool *)target = strcmp(value, "1") == 0 || strcmp(value, "true") == 0 || strcmp(value, "on") == 0;
+        break;
+    case BODY_CUSTOM:
+        break;
+    }
+}
+
+static void dispatch(body_parser_t *p)
+{
+    p->key[p->key_len] = '\0';
+    p->value[p->value_len] = '\0';
+
+    if (p->overflow) {
+        p->stats.truncated++;
+        return;
+    }
+
+    const body_table_t *table = p->table;
+    for (size_t i = 0; i < table->count; i++) {
+        const body_field_t *field = &table->fields[i];
+        int idx[BODY_MAX_INDICES] = {0};
+        int n_idx;
+        if (!key_matches(field->key, p->key, idx, &n_idx)) {
+            continue;
+        }
+        void *record = table->resolve ? table->resolve(p->ctx, idx, n_idx) : p->ctx;
+        if (!record) {
+            break;
+        }
+        store(field, record, p->value);
+        if (field->set) {
+            field->set(record, idx, p->value, p->ctx);
+        }
+        p->stats.fields++;
+        return;
+    }
+    p->stats.unknown++;
+}
+
+static void reset_field(body_parser_t *p)
+{
+    p->key_len = 0;
+    p->value_len = 0;
+    p->overflow = false;
+    p->in_value = false;
+    p->escape = false;
+    p->hex_digits = 0;
+}
+
+void body_parser_init(body_parser_t *parser, body_format_t format, const body_table_t *table, void *ctx)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->format = format;
+    parser->table = table;
+    parser->ctx = ctx;
+    parser->state = J_ROOT;
+}
+
+// ---------------------------------------------------------------------------
+// application/x-www-form-urlencoded
+// ---------------------------------------------------------------------------
+
+static void form_byte(body_parser_t *p, char c)
+{
+    if (p->hex_digits) {
+        int nibble = hex_nibble(c);
+        if (nibble >= 0) {
+            p->hex_value = (p->hex_value << 4) | nibble;
+            if (--p->hex_digits == 0) {
+                append_char(p, p->in_value, (char)p->hex_value);
+            }
+            return;
+        }
+        // Malformed escape: keep it literally, like url_decode() does
+        append_char(p, p->in_value, '%');
+        if (p->hex_digits == 1) {
+            append_char(p, p->in_value, "0123456789ABCDEF"[p->hex_value & 0xF]);
+        }
+        p->hex_digits = 0;
+    }
+
+    if (c == '&') {
+        if (p->key_len > 0 || p->overflow) {
+            dispatch(p);
+        }
+        reset_field(p);
+    } else if (c == '=' && !p->in_value) {
+        p->in_value = true;
+    } else if (c == '%') {
+        p->hex_digits = 2;
+        p->hex_value = 0;
+    } else if (c == '+') {
+        append_char(p, p->in_value, ' ');
+    } else if (c != '\r' && c != '\n') {
+        append_char(p, p->in_value, c);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// JSON
+// ---------------------------------------------------------------------------
+
+static bool json_push(body_parser_t *p, bool is_array)
+{
+    if (p->depth == BODY_JSON_MAX_DEPTH || p->overflow) {
+        return false;
+    }
+    // Members of the root object have no prefix; nested ones get "<key>_"
+    uint16_t base = 0;
+    if (p->depth > 0) {
+        append_key(p, '_');
+        base = p->key_len;
+    }
+    p->is_array[p->depth] = is_array;
+    p->base_len[p->depth] = base;
+    p->array_index[p->depth] = 0;
+    p->depth++;
+    return true;
+}
+
+// A value is starting; inside an array its key is "<prefix><index>"
+static void json_begin_value(body_parser_t *p)
+{
+    p->value_len = 0;
+    if (p->depth > 0 && p->is_array[p->depth - 1]) {
+        uint8_t d = p->depth - 1;
+        char digits[8];
+        int n = 0;
+        uint16_t index = p->array_index[d];
+        do {
+            digits[n++] = '0' + index % 10;
+            index /= 10;
+        } while (index && n < (int)sizeof(digits));
+        p->key_len = p->base_len[d];
+        p->overflow = false;
+        while (n > 0) {
+            append_key(p, digits[--n]);
+        }
+    }
+}
+
+static void json_close(body_parser_t *p)
+{
+    p->depth--;
+    p->state = p->depth == 0 ? J_DONE : J_AFTER_VALUE;
+}
+
+// Handles one string character (after the opening quote) for keys and values
+static void json_string_byte(body_parser_t *p, char c, bool to_value)
+{
+    if (p->hex_digits) {
+        int nibble = hex_nibble(c);
+        if (nibble < 0) {
+            p->state = J_ERROR;
+            return;
+        }
+        p->hex_value = (p->hex_value << 4) | nibble;
+        if (--p->hex_digits == 0) {
+            uint16_t u = p->hex_value;
+            if (u < 0x80) {
+                append_char(p, to_value, (char)u);
+            } else if (u < 0x800) {
+                append_char(p, to_value, (char)(0xC0 | (u >> 6)));
+                append_char(p, to_value, (char)(0x80 | (u & 0x3F)));
+            } else if (u >= 0xD800 && u <= 0xDFFF) {
+                append_char(p, to_value, '?');   // Surrogate pairs are not needed for config values
+            } else {
+                append_char(p, to_value, (char)(0xE0 | (u >> 12)));
+                append_char(p, to_value, (char)(0x80 | ((u >> 6) & 0x3F)));
+                append_char(p, to_value, (char)(0x80 | (u & 0x3F)));
+            }
+        }
+        return;
+    }
+
+    if (p->escape) {
+        p->escape = false;
+        switch (c) {
+        case 'n': c = '\n'; break;
+        case 't': c = '\t'; break;
+        case 'r': c = '\r'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'u':
+            p->hex_digits = 4;
+            p->hex_value = 0;
+            return;
+        case '"': case '\\': case '/':
+            break;
+        default:
+            p->state = J_ERROR;
+            return;
+        }
+        append_char(p, to_value, c);
+        return;
+    }
+
+    if (c == '\\') {
+        p->escape = true;
+    } else if (c == '"') {
+        if (to_value) {
+            dispatch(p);
+            p->state = J_AFTER_VALUE;
+        } else {
+            p->state = J_COLON;
+        }
+    } else {
+        append_char(p, to_value, c);
+    }
+}
+
+static bool is_json_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static void json_byte(body_parser_t *p, char c)
+{
+    switch (p->state) {
+    case J_KEY:
+        json_string_byte(p, c, false);
+        return;
+    case J_STRING:
+        json_string_byte(p, c, true);
+        return;
+    case J_LITERAL:
+        if (c != ',' && c != '}' && c != ']' && !is_json_space(c)) {
+            append_value(p, c);
+            return;
+        }
+        p->value[p->value_len] = '\0';
+        if (strcmp(p->value, "null") != 0) {
+            dispatch(p);
+        }
+        p->state = J_AFTER_VALUE;
+        break;   // Re-examine the delimiter below
+    case J_DONE:
+    case J_ERROR:
+        if (!is_json_space(c)) {
+            p->state = J_ERROR;
+        }
+        return;
+    default:
+        break;
+    }
+
+    if (is_json_space(c)) {
+        return;
+    }
+
+    switch (p->state) {
+    case J_ROOT:
+        if (c == '{' && json_push(p, false)) {
+            p->state = J_OBJ_OPEN;
+        } else {
+            p->state = J_ERROR;
+        }
+        break;
+
+    case J_OBJ_OPEN:
+    case J_OBJ_MEMBER:
+        if (c == '"') {
+            p->key_len = p->base_len[p->depth - 1];
+            p->overflow = false;
+            p->escape = false;
+            p->state = J_KEY;
+        } else if (c == '}' && p->state == J_OBJ_OPEN) {
+            json_close(p);
+        } else {
+            p->state = J_ERROR;
+        }
+        break;
+
+    case J_COLON:
+        p->state = c == ':' ? J_VALUE : J_ERROR;
+        break;
+
+    case J_ARR_OPEN:
+        if (c == ']') {
+            json_close(p);
+            break;
+        }
+        // fall through
+    case J_VALUE:
+        json_begin_value(p);
+        if (c == '{' || c == '[') {
+            bool is_array = c == '[';
+            p->state = json_push(p, is_array) ? (is_array ? J_ARR_OPEN : J_OBJ_OPEN) : J_ERROR;
+        } else if (c == '"') {
+            p->escape = false;
+            p->state = J_STRING;
+        } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+            append_value(p, c);
+            p->state = J_LITERAL;
+        } else {
+            p->state = J_ERROR;
+        }
+        break;
+
+    case J_AFTER_VALUE: {
+        uint8_t d = p->depth - 1;
+        if (c == ',') {
+            if (p->is_array[d]) {
+                p->array_index[d]++;
+                p->state = J_VALUE;
+            } else {
+                p->state = J_OBJ_MEMBER;
+            }
+        } else if (c == (p->is_array[d] ? ']' : '}')) {
+            json_close(p);
+        } else {
+            p->state = J_ERROR;
+        }
+        break;
+    }
+
+    default:
+        p->state = J_ERROR;
+        break;
+    }
+}
+
+void body_parser_feed(body_parser_t *parser, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (parser->format == BODY_FORMAT_FORM) {
+            form_byte(parser, data[i]);
+        } else if (parser->state != J_ERROR) {
+            json_byte(parser, data[i]);
+        }
+    }
+}
+
+bool body_parser_finish(body_parser_t *parser)
+{
+    if (parser->format == BODY_FORMAT_FORM) {
+        if (parser->hex_digits) {
+            append_char(parser, parser->in_value, '%');
+            if (parser->hex_digits == 1) {
+                append_char(parser, parser->in_value, "0123456789ABCDEF"[parser->hex_value & 0xF]);
+            }
+        }
+        if (parser->key_len > 0 || parser->overflow) {
+            dispatch(parser);
+        }
+        reset_field(parser);
+        return true;
+    }
+    if (parser->state != J_DONE) {
+        parser->stats.malformed = true;
+        return false;
+    }
+    return true;
+}
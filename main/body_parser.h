@@ -0,0 +1,103 @@
+// body_parser.h - Streaming request-body parser with a key -> setter table
+//
+// Consumes an application/x-www-form-urlencoded or JSON body in whatever
+// chunks httpd_req_recv() returns, without buffering the whole body. Each
+// completed field is looked up once in a body_table_t and stored straight
+// into the target struct, so a form costs one pass and BODY_VALUE_MAX bytes
+// of state no matter how many fields it has.
+//
+// Keys match exactly - "sensor_1_name" never matches "sensor_1_name_x". A '#'
+// in a table key matches a decimal index, so "sensor_#_sub_#_slave_id" covers
+// every sensor and sub-sensor; the indices are handed to the table's
+// resolve() to pick the record the field's offset applies to.
+//
+// JSON objects and arrays are flattened into the same key space with '_':
+// {"sensor":[{"name":"A"}]} dispatches sensor_0_name. null values are skipped.
+//
+// Pure C with no ESP-IDF calls; tests/body_parser_test.py runs it on the host.
+
+#ifndef BODY_PARSER_H
+#define BODY_PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "iot_configs.h"
+
+#define BODY_MAX_INDICES 2        // '#' placeholders per key
+
+typedef enum {
+    BODY_FORMAT_FORM = 0,         // application/x-www-form-urlencoded
+    BODY_FORMAT_JSON
+} body_format_t;
+
+typedef enum {
+    BODY_STR = 0,                 // char[size], truncated and NUL-terminated
+    BODY_INT,                     // Signed integer of size 1, 2 or 4 (int, enums)
+    BODY_FLOAT,                   // float
+    BODY_BOOL,                    // bool - "1", "true" or "on" is true
+    BODY_CUSTOM                   // Only the setter runs
+} body_type_t;
+
+// record is what resolve() returned; idx holds the '#' indices of the key
+typedef void (*body_setter_t)(void *record, const int *idx, const char *value, void *ctx);
+
+typedef struct {
+    const char *key;
+    body_type_t type;
+    size_t offset;                // offsetof() into the record
+    size_t size;                  // sizeof() the member
+    body_setter_t set;            // BODY_CUSTOM, or runs after the typed store
+} body_field_t;
+
+// Record for a key with n_idx indices, NULL to drop the field (index out of range)
+typedef void *(*body_resolve_t)(void *ctx, const int *idx, int n_idx);
+
+typedef struct {
+    const body_field_t *fields;
+    size_t count;
+    body_resolve_t resolve;
+} body_table_t;
+
+#define BODY_FIELD(k, t, rec_type, member, setter) \
+    { k, t, offsetof(rec_type, member), sizeof(((rec_type *)0)->member), setter }
+#define BODY_FIELD_CUSTOM(k, setter) { k, BODY_CUSTOM, 0, 0, setter }
+
+typedef struct {
+    uint16_t fields;              // Matched and stored
+    uint16_t unknown;             // No table entry, or resolve() said no
+    uint16_t truncated;           // Key or value longer than BODY_KEY_MAX / BODY_VALUE_MAX, dropped
+    bool malformed;               // JSON syntax error; parsing stopped there
+} body_stats_t;
+
+typedef struct {
+    const body_table_t *table;
+    void *ctx;
+    body_format_t format;
+    uint8_t state;
+    bool in_value;                // Form: past the '='
+    bool overflow;                // Current key or value did not fit
+    bool escape;                  // JSON: previous string char was a backslash
+    uint8_t hex_digits;           // Form %XX / JSON \uXXXX digits still expected
+    uint16_t hex_value;
+    uint8_t depth;                // JSON nesting, 0 = outside the root object
+    bool is_array[BODY_JSON_MAX_DEPTH];
+    uint16_t base_len[BODY_JSON_MAX_DEPTH];   // Key prefix length at each depth
+    uint16_t array_index[BODY_JSON_MAX_DEPTH];
+    uint16_t key_len;
+    uint16_t value_len;
+    char key[BODY_KEY_MAX];
+    char value[BODY_VALUE_MAX];
+    body_stats_t stats;
+} body_parser_t;
+
+void body_parser_init(body_parser_t *parser, body_format_t format, const body_table_t *table, void *ctx);
+
+// Feed the next chunk; fields are dispatched as soon as they are complete
+void body_parser_feed(body_parser_t *parser, const char *data, size_t len);
+
+// End of body - dispatches a trailing form field; false if the JSON was incomplete or malformed
+bool body_parser_finish(body_parser_t *parser);
+
+#endif // BODY_PARSER_H
@@ -0,0 +1,155 @@
+// cmux.c - 3GPP TS 27.010 basic-option framing (see cmux.h)
+
+#include "cmux.h"
+
+#include <string.h>
+
+enum {
+    CMUX_HUNT,                    // Waiting for a flag
+    CMUX_ADDRESS,                 // After a flag; more flags are skipped
+    CMUX_CONTROL,
+    CMUX_LENGTH1,
+    CMUX_LENGTH2,
+    CMUX_DATA,
+    CMUX_FCS,
+    CMUX_CLOSE,                   // Expecting the closing flag
+};
+
+static uint8_t crc_update(uint8_t crc, uint8_t byte)
+{
+    crc ^= byte;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 1) ? (crc >> 1) ^ 0xE0 : crc >> 1;
+    }
+    return crc;
+}
+
+// UI frames (FCS over the information too) are never negotiated, so they are dropped here
+static bool control_valid(uint8_t control)
+{
+    return control == CMUX_SABM || control == CMUX_UA || control == CMUX_DM ||
+           control == CMUX_DISC || control == CMUX_UIH;
+}
+
+uint8_t cmux_fcs(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = crc_update(crc, data[i]);
+    }
+    return 0xFF - crc;
+}
+
+size_t cmux_encode(uint8_t dlci, uint8_t control, bool command, const uint8_t *data, size_t len,
+                   uint8_t *out, size_t out_size)
+{
+    size_t header_len = len > 127 ? 4 : 3;
+    if (len > 0x7FFF || out_size < len + header_len + 3) {
+        return 0;
+    }
+    size_t n = 0;
+    out[n++] = CMUX_FLAG;
+    out[n++] = (uint8_t)(dlci << 2 | (command ? CMUX_CR : 0) | CMUX_EA);
+    out[n++] = control;
+    if (len > 127) {
+        out[n++] = (uint8_t)((len & 0x7F) << 1);
+        out[n++] = (uint8_t)(len >> 7);
+    } else {
+        out[n++] = (uint8_t)(len << 1 | CMUX_EA);
+    }
+    uint8_t fcs = cmux_fcs(out + 1, header_len);
+    if (len > 0) {
+        memcpy(out + n, data, len);
+        n += len;
+    }
+    out[n++] = fcs;
+    out[n++] = CMUX_FLAG;
+    return n;
+}
+
+void cmux_decoder_init(cmux_decoder_t *dec)
+{
+    memset(dec, 0, offsetof(cmux_decoder_t, data));
+    dec->state = CMUX_HUNT;
+}
+
+void cmux_decode(cmux_decoder_t *dec, const uint8_t *data, size_t len, cmux_frame_cb_t cb, void *ctx)
+{
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = data[i];
+        switch (dec->state) {
+        case CMUX_HUNT:
+            if (b == CMUX_FLAG) {
+                dec->state = CMUX_ADDRESS;
+            }
+            break;
+        case CMUX_ADDRESS:
+            if (b == CMUX_FLAG) {
+                break;            // Idle fill, or the closing flag doubling as an opening one
+            }
+            if (!(b & CMUX_EA)) {
+                dec->state = CMUX_HUNT;
+                break;
+            }
+            dec->address = b;
+            dec->fcs = crc_update(0xFF, b);
+            dec->state = CMUX_CONTROL;
+            break;
+        case CMUX_CONTROL:
+            if (!control_valid(b & ~CMUX_PF)) {
+                // Line noise after a flag passed as an address
+                dec->state = b == CMUX_FLAG ? CMUX_ADDRESS : CMUX_HUNT;
+                break;
+            }
+            dec->control = b;
+            dec->fcs = crc_update(dec->fcs, b);
+            dec->state = CMUX_LENGTH1;
+            break;
+        case CMUX_LENGTH1:
+            dec->fcs = crc_update(dec->fcs, b);
+            dec->length = b >> 1;
+            dec->state = (b & CMUX_EA) ? CMUX_DATA : CMUX_LENGTH2;
+            break;
+        case CMUX_LENGTH2:
+            dec->fcs = crc_update(dec->fcs, b);
+            dec->length |= (uint16_t)b << 7;
+            dec->state = CMUX_DATA;
+            break;
+        case CMUX_DATA:
+            if (dec->pos < sizeof(dec->data)) {
+                dec->data[dec->pos] = b;
+            }
+            dec->pos++;
+            break;
+        case CMUX_FCS: {
+            uint8_t expected = 0xFF - dec->fcs;
+            if (b == expected) {
+                dec->state = CMUX_CLOSE;
+            } else {
+                dec->fcs_errors++;
+                dec->state = b == CMUX_FLAG ? CMUX_ADDRESS : CMUX_HUNT;
+            }
+            break;
+        }
+        case CMUX_CLOSE:
+            if (b == CMUX_FLAG) {
+                if (dec->length > sizeof(dec->data)) {
+                    dec->oversize++;
+                } else {
+                    dec->frames++;
+                    cb(ctx, dec->address >> 2, dec->control & ~CMUX_PF, dec->data, dec->length);
+                }
+                dec->state = CMUX_ADDRESS;
+            } else {
+                dec->state = CMUX_HUNT;
+            }
+            break;
+        }
+        // Entering or finishing the information field is decided here so a
+        // zero-length frame goes straight to its FCS
+        if (dec->state == CMUX_DATA && (dec->pos == dec->length)) {
+            dec->pos = 0;
+            dec->state = CMUX_FCS;
+        }
+    }
+}
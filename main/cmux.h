@@ -0,0 +1,72 @@
+// cmux.h - 3GPP TS 27.010 basic-option multiplexer framing
+//
+// After AT+CMUX=0 the modem's single UART carries several logical channels
+// (DLCs), each frame being
+//
+//   F9 | address | control | length (1-2 octets) | information | FCS | F9
+//
+// address = DLCI << 2 | C/R << 1 | EA, length = n << 1 | EA (a second octet
+// holds n >> 7 when n > 127), FCS = reflected CRC-8 (poly 0x07) over address,
+// control and length. a7670c_ppp.c runs PPP on DLC 1 and AT commands on DLC 2
+// so signal and registration can be queried while data keeps flowing.
+//
+// This file only encodes and decodes frames. Pure C with no ESP-IDF calls;
+// tests/cmux_test.py runs it on the host.
+
+#ifndef CMUX_H
+#define CMUX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "iot_configs.h"
+
+#define CMUX_FLAG       0xF9
+#define CMUX_EA         0x01
+#define CMUX_CR         0x02
+#define CMUX_PF         0x10
+
+// Control field without the P/F bit
+#define CMUX_SABM       0x2F    // Open DLC
+#define CMUX_UA         0x63    // Acknowledge SABM/DISC
+#define CMUX_DM         0x0F    // DLC refused / not open
+#define CMUX_DISC       0x43    // Close DLC
+#define CMUX_UIH        0xEF    // Data
+
+// Control channel (DLC 0) message types, EA set, C/R clear (OR in CMUX_CR for a command)
+#define CMUX_MSG_CLD    0xC1    // Multiplexer close down
+#define CMUX_MSG_MSC    0xE1    // Modem status (V.24 signals) of a DLC
+
+// Header + FCS + 2 flags around n information bytes
+#define CMUX_FRAME_OVERHEAD 7
+
+typedef void (*cmux_frame_cb_t)(void *ctx, uint8_t dlci, uint8_t control,
+                                const uint8_t *data, size_t len);
+
+typedef struct {
+    uint8_t state;
+    uint8_t address;
+    uint8_t control;
+    uint8_t fcs;                  // Running CRC over the header
+    uint16_t length;
+    uint16_t pos;
+    uint32_t frames;
+    uint32_t fcs_errors;
+    uint32_t oversize;            // Frames longer than CMUX_RX_FRAME_MAX, dropped
+    uint8_t data[CMUX_RX_FRAME_MAX];
+} cmux_decoder_t;
+
+// FCS over address, control and length octets
+uint8_t cmux_fcs(const uint8_t *data, size_t len);
+
+// Build one frame into out; returns its length, 0 if out_size is too small
+size_t cmux_encode(uint8_t dlci, uint8_t control, bool command, const uint8_t *data, size_t len,
+                   uint8_t *out, size_t out_size);
+
+void cmux_decoder_init(cmux_decoder_t *dec);
+
+// Feed received bytes; cb runs once per complete frame with a valid FCS (P/F cleared in control)
+void cmux_decode(cmux_decoder_t *dec, const uint8_t *data, size_t len, cmux_frame_cb_t cb, void *ctx);
+
+#endif // CMUX_H
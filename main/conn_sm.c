@@ -0,0 +1,240 @@
+// conn_sm.c - Connectivity state machine with jittered exponential backoff
+
+#include <stddef.h>
+#include "conn_sm.h"
+#include "iot_configs.h"
+
+// Wrap-safe "now is at or after t" for millisecond tick counters
+#define TIME_REACHED(now, t) ((int32_t)((now) - (t)) >= 0)
+
+static uint32_t next_random(conn_sm_t* sm) {
+    // xorshift32 - deterministic for a given seed so simulations are reproducible
+    uint32_t x = sm->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sm->rng = x;
+    return x;
+}
+
+void conn_sm_default_policy(conn_sm_policy_t* policy) {
+    policy->mqtt.base_ms = CONN_MQTT_BACKOFF_BASE_MS;
+    policy->mqtt.max_ms = CONN_MQTT_BACKOFF_MAX_MS;
+    policy->mqtt.escalate_attempts = CONN_MQTT_ESCALATE_ATTEMPTS;
+    policy->mqtt.escalate_ms = CONN_MQTT_ESCALATE_MS;
+    policy->link.base_ms = CONN_LINK_BACKOFF_BASE_MS;
+    policy->link.max_ms = CONN_LINK_BACKOFF_MAX_MS;
+    policy->link.escalate_attempts = CONN_LINK_ESCALATE_ATTEMPTS;
+    policy->link.escalate_ms = CONN_LINK_ESCALATE_MS;
+    policy->jitter_pct = CONN_BACKOFF_JITTER_PCT;
+    policy->stable_ms = CONN_STABLE_MS;
+    policy->modem_reset_cooldown_ms = CONN_MODEM_RESET_COOLDOWN_MS;
+    policy->max_modem_resets = CONN_MAX_MODEM_RESETS;
+    policy->reboot_after_ms = TELEMETRY_TIMEOUT_SEC * 1000UL;
+}
+
+uint32_t conn_sm_backoff_ms(conn_sm_t* sm, const conn_backoff_t* layer, uint8_t attempt) {
+    uint32_t delay = layer->base_ms;
+    for (uint8_t i = 0; i < attempt && delay < layer->max_ms; i++) {
+        delay *= 2;
+    }
+    if (delay > layer->max_ms) {
+        delay = layer->max_ms;
+    }
+
+    // Spread retries so a fleet behind the same tower/AP does not reconnect in lockstep
+    uint32_t spread = (uint32_t)(((uint64_t)delay * sm->policy.jitter_pct) / 100);
+    if (spread > 0) {
+        delay = delay - spread + next_random(sm) % (2 * spread + 1);
+    }
+    return delay;
+}
+
+static void enter_state(conn_sm_t* sm, conn_state_t state, uint32_t now_ms) {
+    sm->state = state;
+    sm->layer_entered_ms = now_ms;
+}
+
+static void enter_mqtt_recovery(conn_sm_t* sm, uint32_t now_ms) {
+    enter_state(sm, CONN_STATE_MQTT_RECOVERY, now_ms);
+    sm->next_attempt_ms = now_ms + conn_sm_backoff_ms(sm, &sm->policy.mqtt, sm->mqtt_attempts);
+}
+
+static void enter_link_recovery(conn_sm_t* sm, bool forced, uint32_t now_ms) {
+    enter_state(sm, CONN_STATE_LINK_RECOVERY, now_ms);
+    sm->link_forced = forced;
+    // A link that is up but cannot reach the broker is cycled straight away
+    sm->next_attempt_ms = forced ? now_ms
+                                 : now_ms + conn_sm_backoff_ms(sm, &sm->policy.link, sm->link_attempts);
+}
+
+void conn_sm_init(conn_sm_t* sm, const conn_sm_policy_t* policy, uint32_t seed, uint32_t now_ms) {
+    *sm = (conn_sm_t){0};
+    sm->policy = *policy;
+    sm->rng = seed ? seed : 0x9E3779B9u;
+    // Boot counts as an outage in progress (not in the statistics)
+    sm->outage_start_ms = now_ms;
+    enter_link_recovery(sm, false, now_ms);
+}
+
+static conn_action_t step_mqtt_recovery(conn_sm_t* sm, uint32_t now_ms) {
+    const conn_backoff_t* p = &sm->policy.mqtt;
+
+    if (sm->mqtt_attempts >= p->escalate_attempts &&
+        TIME_REACHED(now_ms, sm->layer_entered_ms + p->escalate_ms)) {
+        // Link claims to be up but the broker stays unreachable - cycle the link
+        enter_link_recovery(sm, true, now_ms);
+        return CONN_ACTION_NONE;
+    }
+
+    if (!TIME_REACHED(now_ms, sm->next_attempt_ms)) {
+        return CONN_ACTION_NONE;
+    }
+    if (sm->mqtt_attempts < UINT8_MAX) {
+        sm->mqtt_attempts++;
+    }
+    sm->next_attempt_ms = now_ms + conn_sm_backoff_ms(sm, p, sm->mqtt_attempts);
+    sm->stats.mqtt_reconnects++;
+    return CONN_ACTION_MQTT_RECONNECT;
+}
+
+static conn_action_t step_link_recovery(conn_sm_t* sm, const conn_inputs_t* in, uint32_t now_ms) {
+    const conn_backoff_t* p = &sm->policy.link;
+
+    // Timed from the outage start: forced cycles re-enter this layer on every
+    // attempt, so layer entry time would never get old enough to escalate
+    if (sm->link_attempts >= p->escalate_attempts &&
+        TIME_REACHED(now_ms, sm->outage_start_ms + p->escalate_ms)) {
+        bool resets_exhausted = !in->modem_reset_available ||
+                                sm->modem_resets >= sm->policy.max_modem_resets;
+
+        if (resets_exhausted && in->reboot_allowed &&
+            TIME_REACHED(now_ms, sm->outage_start_ms + sm->policy.reboot_after_ms)) {
+            enter_state(sm, CONN_STATE_REBOOT, now_ms);
+            sm->stats.reboots++;
+            return CONN_ACTION_REBOOT;
+        }
+
+        // Past the per-outage budget resets continue, but four times less often
+        uint32_t cooldown = sm->policy.modem_reset_cooldown_ms;
+        if (sm->modem_resets >= sm->policy.max_modem_resets) {
+            cooldown *= 4;
+        }
+        if (in->modem_reset_available &&
+            (!sm->modem_reset_done || TIME_REACHED(now_ms, sm->last_modem_reset_ms + cooldown))) {
+            enter_state(sm, CONN_STATE_MODEM_RESET, now_ms);
+            if (sm->modem_resets < UINT8_MAX) {
+                sm->modem_resets++;
+            }
+            sm->modem_reset_done = true;
+            sm->last_modem_reset_ms = now_ms;
+            sm->stats.modem_resets++;
+            return CONN_ACTION_MODEM_RESET;
+        }
+        // Otherwise keep retrying the link at the capped backoff
+    }
+
+    if (!TIME_REACHED(now_ms, sm->next_attempt_ms)) {
+        return CONN_ACTION_NONE;
+    }
+    if (sm->link_attempts < UINT8_MAX) {
+        sm->link_attempts++;
+    }
+    sm->link_forced = false;
+    sm->next_attempt_ms = now_ms + conn_sm_backoff_ms(sm, p, sm->link_attempts);
+    sm->stats.link_reconnects++;
+    return CONN_ACTION_LINK_RECONNECT;
+}
+
+conn_action_t conn_sm_step(conn_sm_t* sm, const conn_inputs_t* in, uint32_t now_ms) {
+    if (sm->state == CONN_STATE_REBOOT || sm->state == CONN_STATE_MODEM_RESET) {
+        return CONN_ACTION_NONE;  // Waiting for the executor
+    }
+
+    if (in->link_up && in->mqtt_up) {
+        if (sm->state != CONN_STATE_ONLINE) {
+            if (sm->stats.outages > sm->stats.recoveries) {
+                uint32_t took = now_ms - sm->outage_start_ms;
+                sm->stats.recoveries++;
+                sm->stats.last_recovery_ms = took;
+                if (took > sm->stats.max_recovery_ms) {
+                    sm->stats.max_recovery_ms = took;
+                }
+            }
+            enter_state(sm, CONN_STATE_ONLINE, now_ms);
+            sm->online_since_ms = now_ms;
+            sm->stable = false;
+            sm->link_forced = false;
+        } else if (!sm->stable && TIME_REACHED(now_ms, sm->online_since_ms + sm->policy.stable_ms)) {
+            // Only a connection that stays up earns a fresh escalation ladder
+            sm->stable = true;
+            sm->mqtt_attempts = 0;
+            sm->link_attempts = 0;
+            sm->modem_resets = 0;
+        }
+        return CONN_ACTION_NONE;
+    }
+
+    switch (sm->state) {
+        case CONN_STATE_ONLINE:
+            sm->stats.outages++;
+            sm->outage_start_ms = now_ms;
+            if (in->link_up) {
+                enter_mqtt_recovery(sm, now_ms);
+            } else {
+                enter_link_recovery(sm, false, now_ms);
+            }
+            return CONN_ACTION_NONE;
+
+        case CONN_STATE_MQTT_RECOVERY:
+            if (!in->link_up) {
+                enter_link_recovery(sm, false, now_ms);
+                return CONN_ACTION_NONE;
+            }
+            return step_mqtt_recovery(sm, now_ms);
+
+        case CONN_STATE_LINK_RECOVERY:
+            if (in->link_up && !sm->link_forced) {
+                // Fresh link - MQTT gets a new set of attempts on it
+                sm->mqtt_attempts = 0;
+                enter_mqtt_recovery(sm, now_ms);
+                return CONN_ACTION_NONE;
+            }
+            return step_link_recovery(sm, in, now_ms);
+
+        default:
+            return CONN_ACTION_NONE;
+    }
+}
+
+void conn_sm_action_done(conn_sm_t* sm, conn_action_t action, uint32_t now_ms) {
+    if (action == CONN_ACTION_MODEM_RESET && sm->state == CONN_STATE_MODEM_RESET) {
+        // The reset reconnects the link itself; give it one base delay before retrying
+        sm->link_attempts = 0;
+        enter_state(sm, CONN_STATE_LINK_RECOVERY, now_ms);
+        sm->link_forced = false;
+        sm->next_attempt_ms = now_ms + sm->policy.link.base_ms;
+    }
+}
+
+const char* conn_sm_state_name(conn_state_t state) {
+    switch (state) {
+        case CONN_STATE_ONLINE:        return "ONLINE";
+        case CONN_STATE_MQTT_RECOVERY: return "MQTT_RECOVERY";
+        case CONN_STATE_LINK_RECOVERY: return "LINK_RECOVERY";
+        case CONN_STATE_MODEM_RESET:   return "MODEM_RESET";
+        case CONN_STATE_REBOOT:        return "REBOOT";
+        default:                       return "UNKNOWN";
+    }
+}
+
+const char* conn_sm_action_name(conn_action_t action) {
+    switch (action) {
+        case CONN_ACTION_NONE:           return "NONE";
+        case CONN_ACTION_MQTT_RECONNECT: return "MQTT_RECONNECT";
+        case CONN_ACTION_LINK_RECONNECT: return "LINK_RECONNECT";
+        case CONN_ACTION_MODEM_RESET:    return "MODEM_RESET";
+        case CONN_ACTION_REBOOT:         return "REBOOT";
+        default:                         return "UNKNOWN";
+    }
+}
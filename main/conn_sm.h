@@ -0,0 +1,108 @@
+// conn_sm.h - Connectivity state machine (MQTT -> link -> modem reset -> reboot)
+//
+// Pure policy: no ESP-IDF calls, so the same code runs on the device and in the
+// host simulation (tests/connectivity_sim.py). The caller samples link/MQTT
+// state, calls conn_sm_step() and executes the returned action; blocking
+// actions report completion with conn_sm_action_done(). All recovery goes
+// through one instance, so a modem reset can never race a PPP reconnect.
+//
+// Each layer retries with jittered exponential backoff. A layer escalates only
+// after it has used its attempts AND its time budget, and counters only reset
+// after the connection has stayed up for a while - a flapping link keeps
+// backing off instead of restarting the ladder on every short reconnect. The
+// link budget runs from the start of the outage, so a link that is up but
+// cannot reach the broker still escalates to a modem reset and a reboot.
+
+#ifndef CONN_SM_H
+#define CONN_SM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    CONN_STATE_ONLINE = 0,        // Link and MQTT up
+    CONN_STATE_MQTT_RECOVERY,     // Link up, MQTT down
+    CONN_STATE_LINK_RECOVERY,     // Link (WiFi / PPP) down, or up but unusable
+    CONN_STATE_MODEM_RESET,       // Modem reset in progress
+    CONN_STATE_REBOOT             // Reboot requested (terminal)
+} conn_state_t;
+
+typedef enum {
+    CONN_ACTION_NONE = 0,
+    CONN_ACTION_MQTT_RECONNECT,
+    CONN_ACTION_LINK_RECONNECT,
+    CONN_ACTION_MODEM_RESET,
+    CONN_ACTION_REBOOT
+} conn_action_t;
+
+typedef struct {
+    uint32_t base_ms;             // First retry delay
+    uint32_t max_ms;              // Backoff cap
+    uint8_t escalate_attempts;    // Failed attempts before escalating...
+    uint32_t escalate_ms;         // ...and minimum time spent in this layer
+} conn_backoff_t;
+
+typedef struct {
+    conn_backoff_t mqtt;
+    conn_backoff_t link;
+    uint8_t jitter_pct;           // +/- jitter applied to every delay
+    uint32_t stable_ms;           // Online this long before counters reset
+    uint32_t modem_reset_cooldown_ms;
+    uint8_t max_modem_resets;     // Per outage, before reboot is considered
+    uint32_t reboot_after_ms;     // Minimum outage length before a reboot
+} conn_sm_policy_t;
+
+typedef struct {
+    bool link_up;                 // WiFi associated with IP / PPP up
+    bool mqtt_up;
+    bool modem_reset_available;   // SIM mode, or WiFi with reset GPIO enabled
+    bool reboot_allowed;          // False while SD caching keeps the data safe
+} conn_inputs_t;
+
+typedef struct {
+    uint32_t outages;
+    uint32_t recoveries;
+    uint32_t last_recovery_ms;    // Time-to-recover of the last outage
+    uint32_t max_recovery_ms;
+    uint32_t mqtt_reconnects;
+    uint32_t link_reconnects;
+    uint32_t modem_resets;
+    uint32_t reboots;
+} conn_sm_stats_t;
+
+typedef struct {
+    conn_sm_policy_t policy;
+    conn_state_t state;
+    uint32_t rng;
+    uint32_t outage_start_ms;
+    uint32_t online_since_ms;
+    bool stable;                  // Online for policy.stable_ms
+    uint32_t layer_entered_ms;
+    uint32_t next_attempt_ms;
+    uint8_t mqtt_attempts;
+    uint8_t link_attempts;
+    bool link_forced;             // Link up but broker unreachable - cycle it
+    uint8_t modem_resets;        // Since last stable connection
+    bool modem_reset_done;        // At least one reset since boot
+    uint32_t last_modem_reset_ms;
+    conn_sm_stats_t stats;
+} conn_sm_t;
+
+// Defaults from iot_configs.h (CONN_*)
+void conn_sm_default_policy(conn_sm_policy_t* policy);
+
+void conn_sm_init(conn_sm_t* sm, const conn_sm_policy_t* policy, uint32_t seed, uint32_t now_ms);
+
+// Advance the machine with the current observations; returns what to do now
+conn_action_t conn_sm_step(conn_sm_t* sm, const conn_inputs_t* in, uint32_t now_ms);
+
+// A blocking action (modem reset) has finished
+void conn_sm_action_done(conn_sm_t* sm, conn_action_t action, uint32_t now_ms);
+
+// Jittered exponential delay for the given attempt number (exposed for tests)
+uint32_t conn_sm_backoff_ms(conn_sm_t* sm, const conn_backoff_t* layer, uint8_t attempt);
+
+const char* conn_sm_state_name(conn_state_t state);
+const char* conn_sm_action_name(conn_action_t action);
+
+#endif // CONN_SM_H
@@ -0,0 +1,214 @@
+// delta_patch.c - Streaming application of delta OTA patches (see delta_patch.h)
+
+#include "delta_patch.h"
+
+#include <string.h>
+
+enum {
+    DELTA_ST_OP,
+    DELTA_ST_LEN,
+    DELTA_ST_SRC_DELTA,
+    DELTA_ST_DATA,                // DIFF or INSERT bytes
+    DELTA_ST_DONE,
+};
+
+static uint32_t get_le32(const uint8_t *b)
+{
+    return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+bool delta_is_patch(const uint8_t *buf, size_t len)
+{
+    return len >= 4 && memcmp(buf, DELTA_MAGIC, 4) == 0;
+}
+
+int delta_parse_header(const uint8_t *buf, size_t len, delta_header_t *hdr)
+{
+    if (len < DELTA_HEADER_SIZE || !delta_is_patch(buf, len) || buf[4] != DELTA_VERSION) {
+        return DELTA_ERR_FORMAT;
+    }
+    hdr->source_size = get_le32(buf + 8);
+    hdr->target_size = get_le32(buf + 12);
+    memcpy(hdr->source_sha256, buf + 16, 32);
+    memcpy(hdr->target_sha256, buf + 48, 32);
+    return DELTA_OK;
+}
+
+void delta_patch_init(delta_patch_t *p, const delta_header_t *hdr,
+                      delta_read_fn read_src, delta_write_fn write_out, void *ctx)
+{
+    memset(p, 0, offsetof(delta_patch_t, src));
+    p->read_src = read_src;
+    p->write_out = write_out;
+    p->ctx = ctx;
+    p->source_size = hdr->source_size;
+    p->target_size = hdr->target_size;
+    p->state = DELTA_ST_OP;
+}
+
+static int flush_out(delta_patch_t *p)
+{
+    if (p->out_fill > 0) {
+        if (p->write_out(p->ctx, p->out, p->out_fill) != 0) {
+            return DELTA_ERR_WRITE;
+        }
+        p->out_fill = 0;
+    }
+    return DELTA_OK;
+}
+
+// Make src[] hold the byte at src_pos; returns how many source bytes from there are buffered
+static int load_source(delta_patch_t *p, size_t *avail)
+{
+    if (p->src_fill == 0 || p->src_pos < p->src_block_pos || p->src_pos >= p->src_block_pos + p->src_fill) {
+        uint32_t n = p->source_size - p->src_pos;
+        if (n > DELTA_SRC_BLOCK) {
+            n = DELTA_SRC_BLOCK;
+        }
+        if (p->read_src(p->ctx, p->src_pos, p->src, n) != 0) {
+            p->src_fill = 0;
+            return DELTA_ERR_READ;
+        }
+        p->src_block_pos = p->src_pos;
+        p->src_fill = (uint16_t)n;
+    }
+    *avail = p->src_block_pos + p->src_fill - p->src_pos;
+    return DELTA_OK;
+}
+
+// Run a COPY to completion; bounds were checked when the command was parsed
+static int run_copy(delta_patch_t *p)
+{
+    while (p->len > 0) {
+        size_t n;
+        int err = load_source(p, &n);
+        if (err != DELTA_OK) {
+            return err;
+        }
+        if (n > p->len) {
+            n = p->len;
+        }
+        if (n > (size_t)(DELTA_OUT_BLOCK - p->out_fill)) {
+            n = DELTA_OUT_BLOCK - p->out_fill;
+        }
+        memcpy(p->out + p->out_fill, p->src + (p->src_pos - p->src_block_pos), n);
+        p->out_fill += n;
+        p->src_pos += n;
+        p->written += n;
+        p->len -= n;
+        if (p->out_fill == DELTA_OUT_BLOCK && (err = flush_out(p)) != DELTA_OK) {
+            return err;
+        }
+    }
+    return DELTA_OK;
+}
+
+// Fields of the current command are complete: check it and start it
+static int start_command(delta_patch_t *p, int32_t src_delta)
+{
+    if (p->len > p->target_size - p->written) {
+        return DELTA_ERR_SIZE;
+    }
+    if (p->op == DELTA_OP_INSERT) {
+        p->state = p->len > 0 ? DELTA_ST_DATA : DELTA_ST_OP;
+        return DELTA_OK;
+    }
+    int64_t src = (int64_t)p->src_pos + src_delta;
+    if (src < 0 || src + p->len > p->source_size) {
+        return DELTA_ERR_SOURCE;
+    }
+    p->src_pos = (uint32_t)src;
+    if (p->op == DELTA_OP_COPY) {
+        p->state = DELTA_ST_OP;
+        return run_copy(p);
+    }
+    p->state = p->len > 0 ? DELTA_ST_DATA : DELTA_ST_OP;
+    return DELTA_OK;
+}
+
+// One DIFF/INSERT payload byte
+static int data_byte(delta_patch_t *p, uint8_t b)
+{
+    if (p->op == DELTA_OP_DIFF) {
+        size_t avail;
+        int err = load_source(p, &avail);
+        if (err != DELTA_OK) {
+            return err;
+        }
+        b = (uint8_t)(b + p->src[p->src_pos - p->src_block_pos]);
+        p->src_pos++;
+    }
+    p->out[p->out_fill++] = b;
+    p->written++;
+    if (--p->len == 0) {
+        p->state = DELTA_ST_OP;
+    }
+    return p->out_fill == DELTA_OUT_BLOCK ? flush_out(p) : DELTA_OK;
+}
+
+int delta_patch_feed(delta_patch_t *p, const uint8_t *data, size_t len)
+{
+    if (p->error) {
+        return p->error;
+    }
+    int err = DELTA_OK;
+    for (size_t i = 0; i < len && err == DELTA_OK; i++) {
+        uint8_t b = data[i];
+        switch (p->state) {
+        case DELTA_ST_OP:
+            if (b == DELTA_OP_END) {
+                err = flush_out(p);
+                if (err == DELTA_OK && p->written != p->target_size) {
+                    err = DELTA_ERR_SIZE;
+                }
+                if (err == DELTA_OK) {
+                    p->state = DELTA_ST_DONE;
+                }
+            } else if (b == DELTA_OP_COPY || b == DELTA_OP_DIFF || b == DELTA_OP_INSERT) {
+                p->op = b;
+                p->field = 0;
+                p->shift = 0;
+                p->state = DELTA_ST_LEN;
+            } else {
+                err = DELTA_ERR_FORMAT;
+            }
+            break;
+        case DELTA_ST_LEN:
+        case DELTA_ST_SRC_DELTA:
+            if (p->shift > 28) {
+                err = DELTA_ERR_FORMAT;
+                break;
+            }
+            p->field |= (uint32_t)(b & 0x7F) << p->shift;
+            p->shift += 7;
+            if (b & 0x80) {
+                break;
+            }
+            if (p->state == DELTA_ST_LEN) {
+                p->len = p->field;
+                p->field = 0;
+                p->shift = 0;
+                if (p->op == DELTA_OP_INSERT) {
+                    err = start_command(p, 0);
+                } else {
+                    p->state = DELTA_ST_SRC_DELTA;
+                }
+            } else {
+                // Zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+                int32_t delta = (int32_t)(p->field >> 1) ^ -(int32_t)(p->field & 1);
+                err = start_command(p, delta);
+            }
+            break;
+        case DELTA_ST_DATA:
+            err = data_byte(p, b);
+            break;
+        case DELTA_ST_DONE:
+            return DELTA_DONE;    // Anything after END is ignored
+        }
+    }
+    if (err != DELTA_OK) {
+        p->error = (int8_t)err;
+        return err;
+    }
+    return p->state == DELTA_ST_DONE ? DELTA_DONE : DELTA_OK;
+}
@@ -0,0 +1,101 @@
+// delta_patch.h - Streaming application of delta OTA patches
+//
+// A patch rebuilds a new application image from the running one, so a release
+// that changes a few functions ships as tens of KB instead of the whole image.
+// tools/ota_delta.py builds patches between two .bin files. Layout:
+//
+//   "GWDP" | version | 3 reserved | source size | target size (u32 LE)
+//   | SHA-256 of source | SHA-256 of target | raw deflate of the commands
+//
+// The deflate window is limited to 1 << DELTA_WINDOW_BITS bytes so the device
+// can inflate into a buffer of that size instead of 32 KB.
+//
+// Inflated, the commands are a byte opcode followed by LEB128 fields:
+//
+//   COPY   len, src_delta          len bytes of source
+//   DIFF   len, src_delta, bytes   source bytes plus the given bytes (mod 256)
+//   INSERT len, bytes              literal bytes
+//   END
+//
+// src_delta (zigzag-encoded) moves the source cursor, which otherwise follows
+// the last COPY/DIFF. DIFF carries code that moved: the bytes are mostly zero
+// except where addresses changed, and deflate compresses them well.
+//
+// This file only parses the header and applies the inflated command stream.
+// Pure C with no ESP-IDF calls; tests/delta_patch_test.py runs it on the host.
+// ota_update.c inflates, reads the running partition and writes the result.
+
+#ifndef DELTA_PATCH_H
+#define DELTA_PATCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DELTA_MAGIC         "GWDP"
+#define DELTA_VERSION       1
+#define DELTA_HEADER_SIZE   80
+#define DELTA_WINDOW_BITS   13
+
+#define DELTA_OP_END        0x00
+#define DELTA_OP_COPY       0x01
+#define DELTA_OP_DIFF       0x02
+#define DELTA_OP_INSERT     0x03
+
+#define DELTA_SRC_BLOCK     256     // Source bytes read at a time for DIFF
+#define DELTA_OUT_BLOCK     1024    // Output is handed to the writer in blocks of this size
+
+// delta_patch_feed() results
+#define DELTA_OK            0       // Consumed, more commands expected
+#define DELTA_DONE          1       // END reached and all output written
+#define DELTA_ERR_FORMAT    -1      // Bad opcode or field
+#define DELTA_ERR_SOURCE    -2      // Command reaches outside the source image
+#define DELTA_ERR_SIZE      -3      // Output would exceed the target size
+#define DELTA_ERR_READ      -4      // read_src failed
+#define DELTA_ERR_WRITE     -5      // write_out failed
+
+typedef struct {
+    uint32_t source_size;
+    uint32_t target_size;
+    uint8_t source_sha256[32];
+    uint8_t target_sha256[32];
+} delta_header_t;
+
+// Return 0 on success
+typedef int (*delta_read_fn)(void *ctx, uint32_t offset, uint8_t *buf, size_t len);
+typedef int (*delta_write_fn)(void *ctx, const uint8_t *data, size_t len);
+
+typedef struct {
+    delta_read_fn read_src;
+    delta_write_fn write_out;
+    void *ctx;
+    uint32_t source_size;
+    uint32_t target_size;
+    uint32_t written;             // Output bytes produced, including those still in out[]
+    uint32_t src_pos;             // Source cursor
+    uint32_t len;                 // Bytes left in the current command
+    uint32_t field;               // LEB128 value being assembled
+    uint8_t shift;
+    uint8_t state;
+    uint8_t op;
+    int8_t error;                 // Sticky once set
+    uint32_t src_block_pos;       // Source offset held in src[]
+    uint16_t src_fill;
+    uint16_t out_fill;
+    uint8_t src[DELTA_SRC_BLOCK];
+    uint8_t out[DELTA_OUT_BLOCK];
+} delta_patch_t;
+
+// True if buf starts like a patch (enough to tell it from an image, which starts with 0xE9)
+bool delta_is_patch(const uint8_t *buf, size_t len);
+
+// Parse the first DELTA_HEADER_SIZE bytes; DELTA_OK or DELTA_ERR_FORMAT
+int delta_parse_header(const uint8_t *buf, size_t len, delta_header_t *hdr);
+
+void delta_patch_init(delta_patch_t *p, const delta_header_t *hdr,
+                      delta_read_fn read_src, delta_write_fn write_out, void *ctx);
+
+// Feed inflated command bytes in any chunking
+int delta_patch_feed(delta_patch_t *p, const uint8_t *data, size_t len);
+
+#endif // DELTA_PATCH_H
@@ -0,0 +1,490 @@
+// dlog.c - Deferred binary logging for the hot paths (see dlog.h)
+
+#include "dlog.h"
+#include "iot_configs.h"
+#include "sd_card_logger.h"
+
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *TAG = "DLOG";
+
+typedef struct {
+    uint32_t time_ms;
+    const dlog_site_t *site;
+    uint16_t suppressed;        // Events the site dropped before this one
+    uint16_t len;               // Payload bytes used
+    uint8_t payload[DLOG_PAYLOAD_BYTES];
+} dlog_record_t;
+
+// Argument types, as the length modifier and conversion make printf read them
+typedef enum {
+    ARG_INT, ARG_LONG, ARG_LLONG, ARG_SIZE, ARG_PTRDIFF, ARG_DOUBLE, ARG_PTR, ARG_STR
+} arg_kind_t;
+
+// Ring of the last DLOG_RING_RECORDS events. Sequence numbers only grow;
+// event seq lives in slot seq % DLOG_RING_RECORDS until it is overwritten.
+static dlog_record_t s_ring[DLOG_RING_RECORDS];
+static uint32_t s_head = 0;                // Next sequence number to record
+static uint32_t s_console = 0;             // Next sequence number to print
+static uint32_t s_lost = 0;                // Overwritten before they were printed
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Console and SD output (formatter task, or esp_restart())
+static SemaphoreHandle_t s_drain_mutex = NULL;
+static char s_line[192];
+static char s_sd_buf[DLOG_SD_BUF_SIZE];
+static size_t s_sd_len = 0;
+static TickType_t s_sd_last_write = 0;
+
+static const char s_level_char[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+
+// ---- Binary encoding -------------------------------------------------------
+
+// Parse one conversion after its '%'. Returns the character after it, or
+// NULL for a conversion the encoding does not support.
+static const char *parse_spec(const char *p, arg_kind_t *kind)
+{
+    while (*p && strchr("-+ #0", *p)) p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '*') {
+        return NULL;
+    }
+
+    arg_kind_t int_kind = ARG_INT;
+    if (p[0] == 'h') {
+        p += (p[1] == 'h') ? 2 : 1;
+    } else if (p[0] == 'l') {
+        int_kind = (p[1] == 'l') ? ARG_LLONG : ARG_LONG;
+        p += (p[1] == 'l') ? 2 : 1;
+    } else if (p[0] == 'j') {
+        int_kind = ARG_LLONG;
+        p++;
+    } else if (p[0] == 'z') {
+        int_kind = ARG_SIZE;
+        p++;
+    } else if (p[0] == 't') {
+        int_kind = ARG_PTRDIFF;
+        p++;
+    } else if (p[0] == 'L') {
+        return NULL;
+    }
+
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+            *kind = int_kind;
+            break;
+        case 'c':
+            *kind = ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            *kind = ARG_DOUBLE;
+            break;
+        case 'p':
+            *kind = ARG_PTR;
+            break;
+        case 's':
+            *kind = ARG_STR;
+            break;
+        default:
+            return NULL;
+    }
+    return p + 1;
+}
+
+static size_t arg_size(arg_kind_t kind)
+{
+    switch (kind) {
+        case ARG_LONG:    return sizeof(long);
+        case ARG_LLONG:   return sizeof(long long);
+        case ARG_SIZE:    return sizeof(size_t);
+        case ARG_PTRDIFF: return sizeof(ptrdiff_t);
+        case ARG_DOUBLE:  return sizeof(double);
+        case ARG_PTR:     return sizeof(void *);
+        default:          return sizeof(int);
+    }
+}
+
+// Copy the arguments fmt names into out. Stops at the first one that does
+// not fit; the formatter prints "?" from there on.
+static size_t pack_args(const char *fmt, va_list ap, uint8_t *out, size_t size)
+{
+    size_t len = 0;
+    for (const char *p = fmt; *p; p++) {
+        if (*p != '%') continue;
+        if (p[1] == '%') {
+            p++;
+            continue;
+        }
+        arg_kind_t kind;
+        const char *end = parse_spec(p + 1, &kind);
+        if (!end) break;
+        p = end - 1;
+
+        if (kind == ARG_STR) {
+            const char *s = va_arg(ap, const char *);
+            if (!s) s = "(null)";
+            size_t n = strnlen(s, DLOG_MAX_STR);
+            if (len + n + 1 > size) break;
+            memcpy(out + len, s, n);
+            out[len + n] = '\0';
+            len += n + 1;
+            continue;
+        }
+
+        size_t n = arg_size(kind);
+        if (len + n > size) break;
+        switch (kind) {
+            case ARG_LONG:    { long v = va_arg(ap, long); memcpy(out + len, &v, n); break; }
+            case ARG_LLONG:   { long long v = va_arg(ap, long long); memcpy(out + len, &v, n); break; }
+            case ARG_SIZE:    { size_t v = va_arg(ap, size_t); memcpy(out + len, &v, n); break; }
+            case ARG_PTRDIFF: { ptrdiff_t v = va_arg(ap, ptrdiff_t); memcpy(out + len, &v, n); break; }
+            case ARG_DOUBLE:  { double v = va_arg(ap, double); memcpy(out + len, &v, n); break; }
+            case ARG_PTR:     { void *v = va_arg(ap, void *); memcpy(out + len, &v, n); break; }
+            default:          { int v = va_arg(ap, int); memcpy(out + len, &v, n); break; }
+        }
+        len += n;
+    }
+    return len;
+}
+
+// Expand fmt with the packed arguments, one conversion per snprintf
+static size_t format_args(const char *fmt, const uint8_t *in, size_t in_len, char *out, size_t size)
+{
+    size_t n = 0;
+    size_t pos = 0;
+    bool exhausted = false;
+
+#define DLOG_PUT(...) do {                                              \
+        if (n < size) {                                                 \
+            int w_ = snprintf(out + n, size - n, __VA_ARGS__);          \
+            if (w_ > 0) n += ((size_t)w_ < size - n) ? (size_t)w_ : size - n - 1; \
+        }                                                               \
+    } while (0)
+
+    for (const char *p = fmt; *p && n + 1 < size; ) {
+        if (*p != '%') {
+            out[n++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[n++] = '%';
+            p += 2;
+            continue;
+        }
+
+        arg_kind_t kind = ARG_INT;
+        const char *end = parse_spec(p + 1, &kind);
+        if (!end) {
+            exhausted = true;
+            end = p + 1;
+            while (*end && !strchr("diuxXocfFeEgGaApsn", *end)) end++;
+            if (*end) end++;
+        }
+        char spec[16];
+        size_t spec_len = (size_t)(end - p);
+        if (spec_len >= sizeof(spec)) {
+            exhausted = true;
+        }
+
+        size_t need = (kind == ARG_STR) ? 1 : arg_size(kind);
+        if (!exhausted && pos + need > in_len) {
+            exhausted = true;
+        }
+        if (exhausted) {
+            DLOG_PUT("?");
+            p = end;
+            continue;
+        }
+
+        memcpy(spec, p, spec_len);
+        spec[spec_len] = '\0';
+        switch (kind) {
+            case ARG_STR: {
+                const char *s = (const char *)in + pos;
+                size_t len = strnlen(s, in_len - pos);
+                if (pos + len >= in_len) {      // Not terminated - cannot happen for pack_args() output
+                    exhausted = true;
+                    DLOG_PUT("?");
+                    break;
+                }
+                DLOG_PUT(spec, s);
+                pos += len + 1;
+                break;
+            }
+            case ARG_LONG:    { long v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+            case ARG_LLONG:   { long long v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+            case ARG_SIZE:    { size_t v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+            case ARG_PTRDIFF: { ptrdiff_t v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+            case ARG_DOUBLE:  { double v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+            case ARG_PTR:     { void *v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+            default:          { int v; memcpy(&v, in + pos, sizeof(v)); DLOG_PUT(spec, v); pos += sizeof(v); break; }
+        }
+        p = end;
+    }
+#undef DLOG_PUT
+
+    out[n < size ? n : size - 1] = '\0';
+    return n;
+}
+
+// ---- Recording -------------------------------------------------------------
+
+void dlog_write(dlog_site_t *site, const char *tag, ...)
+{
+    uint32_t now = esp_log_timestamp();
+    uint16_t suppressed;
+
+    taskENTER_CRITICAL(&s_lock);
+    site->tag = tag;
+    if (site->window_ms == 0 || now - site->window_ms >= DLOG_SITE_WINDOW_MS) {
+        site->window_ms = now ? now : 1;
+        site->burst = DLOG_SITE_BURST;
+    }
+    if (site->burst == 0) {
+        if (site->suppressed < UINT16_MAX) site->suppressed++;
+        taskEXIT_CRITICAL(&s_lock);
+        return;
+    }
+    site->burst--;
+    suppressed = site->suppressed;
+    site->suppressed = 0;
+    taskEXIT_CRITICAL(&s_lock);
+
+    dlog_record_t rec;
+    rec.time_ms = now;
+    rec.site = site;
+    rec.suppressed = suppressed;
+    va_list ap;
+    va_start(ap, tag);
+    rec.len = (uint16_t)pack_args(site->fmt, ap, rec.payload, sizeof(rec.payload));
+    va_end(ap);
+
+    taskENTER_CRITICAL(&s_lock);
+    memcpy(&s_ring[s_head % DLOG_RING_RECORDS], &rec, offsetof(dlog_record_t, payload) + rec.len);
+    s_head++;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// Copy event seq out of the ring. Returns false once it has been overwritten
+// (or not recorded yet).
+static bool read_record(uint32_t seq, dlog_record_t *rec)
+{
+    bool ok = false;
+    taskENTER_CRITICAL(&s_lock);
+    if (seq < s_head && s_head - seq <= DLOG_RING_RECORDS) {
+        const dlog_record_t *src = &s_ring[seq % DLOG_RING_RECORDS];
+        memcpy(rec, src, offsetof(dlog_record_t, payload) + src->len);
+        ok = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ok;
+}
+
+// "I (ms) TAG: text (+N suppressed)\n", as ESP_LOGx prints it
+static size_t format_record(const dlog_record_t *rec, char *out, size_t size)
+{
+    const dlog_site_t *site = rec->site;
+    uint8_t level = site->level < sizeof(s_level_char) ? site->level : ESP_LOG_INFO;
+    int n = snprintf(out, size, "%c (%lu) %s: ", s_level_char[level],
+                     (unsigned long)rec->time_ms, site->tag ? site->tag : "?");
+    if (n < 0 || (size_t)n >= size) {
+        return size - 1;
+    }
+    n += format_args(site->fmt, rec->payload, rec->len, out + n, size - n);
+    if (rec->suppressed && (size_t)n < size) {
+        n += snprintf(out + n, size - n, " (+%u suppressed)", rec->suppressed);
+    }
+    if ((size_t)n + 1 >= size) {
+        n = size - 2;
+    }
+    out[n++] = '\n';
+    out[n] = '\0';
+    return n;
+}
+
+// ---- Draining --------------------------------------------------------------
+
+static void sd_write_batch(void)
+{
+    if (s_sd_len == 0) return;
+    if (sd_card_acquire_mutex() != ESP_OK) {
+        return;                 // Keep the batch, try again next pass
+    }
+    FILE *f = fopen(DLOG_SD_PATH, "a");
+    long size = -1;
+    if (f) {
+        fwrite(s_sd_buf, 1, s_sd_len, f);
+        size = ftell(f);
+        fclose(f);
+    }
+    if (size >= DLOG_SD_MAX_BYTES) {
+        remove(DLOG_SD_OLD_PATH);
+        rename(DLOG_SD_PATH, DLOG_SD_OLD_PATH);
+    }
+    sd_card_release_mutex();
+    s_sd_len = 0;
+    s_sd_last_write = xTaskGetTickCount();
+}
+
+static void sd_append(const char *line, size_t len)
+{
+    if (!sd_card_is_available()) {
+        s_sd_len = 0;
+        return;
+    }
+    if (s_sd_len + len > sizeof(s_sd_buf)) {
+        sd_write_batch();
+        if (s_sd_len + len > sizeof(s_sd_buf)) {
+            return;             // SD busy and batch full - drop rather than block
+        }
+    }
+    memcpy(s_sd_buf + s_sd_len, line, len);
+    s_sd_len += len;
+}
+
+// Print everything recorded since the last pass
+static void drain(bool to_sd)
+{
+    dlog_record_t rec;
+    for (;;) {
+        uint32_t seq;
+        uint32_t lost = 0;
+        taskENTER_CRITICAL(&s_lock);
+        if (s_head - s_console > DLOG_RING_RECORDS) {
+            lost = s_head - s_console - DLOG_RING_RECORDS;
+            s_console = s_head - DLOG_RING_RECORDS;
+            s_lost += lost;
+        }
+        seq = s_console;
+        taskEXIT_CRITICAL(&s_lock);
+
+        if (lost) {
+            int n = snprintf(s_line, sizeof(s_line), "W (%lu) %s: %lu events overwritten before printing\n",
+                             (unsigned long)esp_log_timestamp(), TAG, (unsigned long)lost);
+            esp_log_write(ESP_LOG_WARN, TAG, "%s", s_line);
+            if (to_sd) sd_append(s_line, n);
+        }
+        if (!read_record(seq, &rec)) {
+            break;
+        }
+        taskENTER_CRITICAL(&s_lock);
+        if (s_console == seq) s_console++;
+        taskEXIT_CRITICAL(&s_lock);
+
+        size_t n = format_record(&rec, s_line, sizeof(s_line));
+        esp_log_write((esp_log_level_t)rec.site->level, rec.site->tag, "%s", s_line);
+        if (to_sd) sd_append(s_line, n);
+    }
+
+    if (to_sd && s_sd_len > 0 &&
+        xTaskGetTickCount() - s_sd_last_write >= pdMS_TO_TICKS(DLOG_SD_FLUSH_MS)) {
+        sd_write_batch();
+    }
+}
+
+static void dlog_task(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(DLOG_FLUSH_MS));
+        xSemaphoreTake(s_drain_mutex, portMAX_DELAY);
+        drain(true);
+        xSemaphoreGive(s_drain_mutex);
+    }
+}
+
+// esp_restart(): print what is still pending. Console only - the SD mutex
+// may be held by the task that is restarting.
+static void dlog_shutdown(void)
+{
+    if (xSemaphoreTake(s_drain_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
+        drain(false);
+        xSemaphoreGive(s_drain_mutex);
+    }
+}
+
+esp_err_t dlog_init(void)
+{
+    if (s_drain_mutex) {
+        return ESP_OK;
+    }
+    s_drain_mutex = xSemaphoreCreateMutex();
+    if (!s_drain_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_sd_last_write = xTaskGetTickCount();
+    if (xTaskCreate(dlog_task, "dlog", DLOG_TASK_STACK, NULL, DLOG_TASK_PRIORITY, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create formatter task");
+        return ESP_ERR_NO_MEM;
+    }
+    esp_register_shutdown_handler(dlog_shutdown);
+    ESP_LOGI(TAG, "Deferred logging: %d events in RAM (%u bytes), SD drain to %s",
+             DLOG_RING_RECORDS, (unsigned)sizeof(s_ring), DLOG_SD_PATH);
+    return ESP_OK;
+}
+
+// ---- Portal ----------------------------------------------------------------
+
+// GET /api/log?since=<seq>: retained events from seq on, as text lines
+esp_err_t dlog_http_handler(httpd_req_t *req)
+{
+    uint32_t since = 0;
+    char query[32], param[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", param, sizeof(param)) == ESP_OK) {
+        since = strtoul(param, NULL, 10);
+    }
+
+    uint32_t head, lost;
+    taskENTER_CRITICAL(&s_lock);
+    head = s_head;
+    lost = s_lost;
+    taskEXIT_CRITICAL(&s_lock);
+
+    uint32_t oldest = head > DLOG_RING_RECORDS ? head - DLOG_RING_RECORDS : 0;
+    if (since > head) {
+        since = oldest;         // Cursor from before a reboot
+    }
+
+    char next[12], lost_str[12];
+    snprintf(next, sizeof(next), "%lu", (unsigned long)head);
+    snprintf(lost_str, sizeof(lost_str), "%lu", (unsigned long)lost);
+    httpd_resp_set_type(req, "text/plain; charset=utf-8");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_hdr(req, "X-Log-Next", next);
+    httpd_resp_set_hdr(req, "X-Log-Lost", lost_str);
+
+    // Lines are formatted on the httpd task; the record and line stay on its stack
+    dlog_record_t rec;
+    char line[192];
+    if (since < oldest) {
+        int n = snprintf(line, sizeof(line), "... %lu older events overwritten\n",
+                         (unsigned long)(oldest - since));
+        if (httpd_resp_send_chunk(req, line, n) != ESP_OK) return ESP_FAIL;
+        since = oldest;
+    }
+    for (uint32_t seq = since; seq < head; seq++) {
+        if (!read_record(seq, &rec)) {
+            continue;           // Overwritten while sending
+        }
+        size_t n = format_record(&rec, line, sizeof(line));
+        if (httpd_resp_send_chunk(req, line, n) != ESP_OK) {
+            return ESP_FAIL;
+        }
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
@@ -0,0 +1,87 @@
+/**
+ * dlog.h - Deferred binary logging for the hot paths
+ *
+ * ESP_LOGI formats on the calling task and blocks it on the 115200-baud
+ * console, so each Modbus round trip or telemetry cycle waited on its own
+ * log lines. DLOGI/DLOGW/DLOGD only record a compact binary event into a RAM
+ * ring:
+ *
+ *   record   Timestamp, call site (which names the tag, level and format
+ *            string) and the raw argument bytes. Numbers are copied as they
+ *            are; %s strings are copied, truncated to DLOG_MAX_STR.
+ *   format   A low-priority task turns records into the usual
+ *            "I (ms) TAG: text" lines on the console (the runtime log level
+ *            still applies there) and appends them to DLOG_SD_PATH when the
+ *            SD card is available. Lines carry the time of the event, so
+ *            they can print after ESP_LOGx lines logged later.
+ *   read     The ring keeps the last DLOG_RING_RECORDS events.
+ *            GET /api/log?since=<seq> returns them as text, and
+ *            X-Log-Next gives the cursor for the next request.
+ *
+ * Each call site allows DLOG_SITE_BURST events per DLOG_SITE_WINDOW_MS. The
+ * events it drops are counted and shown on its next line as "(+N suppressed)".
+ *
+ * Arguments must fit in DLOG_PAYLOAD_BYTES. Anything beyond that prints as
+ * "?". '*' widths and %n are not supported. Errors stay on ESP_LOGE, so they
+ * still reach the console synchronously before a crash.
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Call site: one static instance per DLOG*() use
+typedef struct {
+    const char *fmt;
+    const char *tag;            // Set on each call (TAG is not a constant expression)
+    uint8_t level;              // esp_log_level_t
+    uint8_t burst;              // Events left in the current window
+    uint16_t suppressed;        // Events dropped since the last recorded one
+    uint32_t window_ms;
+} dlog_site_t;
+
+/**
+ * Record an event for the site. Use the DLOG*() macros rather than calling
+ * this directly.
+ */
+void dlog_write(dlog_site_t *site, const char *tag, ...);
+
+// Never called - keeps the compiler's printf format checks on DLOG*() arguments
+static inline __attribute__((format(printf, 1, 2))) void dlog_check_format(const char *fmt, ...) { (void)fmt; }
+
+#define DLOG_AT(lvl, tag, format, ...) do {                                     \
+        if (LOG_LOCAL_LEVEL >= (lvl)) {                                         \
+            static dlog_site_t dlog_site_ = { .fmt = (format), .level = (lvl) };\
+            if (0) dlog_check_format(format, ##__VA_ARGS__);                    \
+            dlog_write(&dlog_site_, (tag), ##__VA_ARGS__);                      \
+        }                                                                       \
+    } while (0)
+
+#define DLOGW(tag, format, ...) DLOG_AT(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) DLOG_AT(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) DLOG_AT(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+
+/**
+ * Start the formatter task. Events recorded before this are kept and
+ * printed once it runs. Pending events are also printed by esp_restart().
+ */
+esp_err_t dlog_init(void);
+
+// Portal handler (registered by web_config.c)
+esp_err_t dlog_http_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DLOG_H
@@ -0,0 +1,22 @@
+/**
+ * freertos_trace_hooks.h - Project FreeRTOS trace hooks.
+ *
+ * Force-included into the freertos component's own build (see
+ * main/CMakeLists.txt), ahead of FreeRTOS.h, which only defines the
+ * trace macros that are still undefined. The port's assembly files get
+ * it too, hence the guard.
+ */
+
+#ifndef FREERTOS_TRACE_HOOKS_H
+#define FREERTOS_TRACE_HOOKS_H
+
+#ifndef __ASSEMBLER__
+
+// Task switches for the event trace (perf_trace.c). Runs in the scheduler with
+// interrupts masked, from IRAM.
+void perf_trace_task_switched_in(void);
+#define traceTASK_SWITCHED_IN() perf_trace_task_switched_in()
+
+#endif // __ASSEMBLER__
+
+#endif // FREERTOS_TRACE_HOOKS_H
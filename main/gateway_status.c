@@ -0,0 +1,464 @@
+// gateway_status.c - Pre-aggregated gateway status (see gateway_status.h)
+
+#include "gateway_status.h"
+#include "iot_configs.h"
+#include "web_config.h"
+#include "a7670c_ppp.h"
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_wifi.h"
+#include "esp_mac.h"
+#include "esp_flash.h"
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "GW_STATUS";
+
+// Owned by main.c
+extern volatile bool mqtt_connected;
+extern uint32_t total_telemetry_sent;
+extern uint32_t mqtt_reconnect_count;
+extern int64_t mqtt_connect_time;
+extern int64_t last_telemetry_time;
+
+static gateway_status_t s_status;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const s_group_names[] = {
+    "system", "memory", "partitions", "wifi", "sim", "modbus", "azure", "sensors", "tasks", "web",
+};
+#define GS_GROUP_COUNT (sizeof(s_group_names) / sizeof(s_group_names[0]))
+
+static uint32_t uptime_s(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// Updates sample into locals first and only copy them in under the lock;
+// call with s_lock held
+static void publish_locked(uint32_t now)
+{
+    s_status.version++;
+    s_status.updated_at = now;
+}
+
+void gateway_status_init(void)
+{
+    uint8_t mac[6];
+    char mac_str[18];
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    snprintf(mac_str, sizeof(mac_str), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+    uint32_t flash_total = 0;
+    esp_flash_get_size(NULL, &flash_total);
+    const esp_partition_t *app = esp_ota_get_running_partition();
+    const esp_partition_t *nvs = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                          ESP_PARTITION_SUBTYPE_DATA_NVS, NULL);
+
+    uint32_t now = uptime_s();
+    portENTER_CRITICAL(&s_lock);
+    memcpy(s_status.mac, mac_str, sizeof(mac_str));
+    s_status.flash_total = flash_total;
+    s_status.app_partition_size = app ? app->size : 0;
+    s_status.nvs_partition_size = nvs ? nvs->size : 0;
+    publish_locked(now);
+    portEXIT_CRITICAL(&s_lock);
+
+    gateway_status_update_health();
+    gateway_status_update_modbus(-1);
+    gateway_status_update_azure();
+    ESP_LOGI(TAG, "Status snapshot ready (%u bytes)", (unsigned)sizeof(s_status));
+}
+
+void gateway_status_update_health(void)
+{
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, MALLOC_CAP_DEFAULT);
+    uint32_t free_heap = esp_get_free_heap_size();
+    uint32_t min_free_heap = esp_get_minimum_free_heap_size();
+    uint32_t total_heap = heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+    uint32_t internal_heap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    uint32_t spiram_heap = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    uint16_t task_count = (uint16_t)uxTaskGetNumberOfTasks();
+
+    wifi_ap_record_t ap_info;
+    bool wifi_up = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+
+    bool sim_up = a7670c_ppp_is_connected();
+    char sim_ip[16] = "";
+    if (sim_up) {
+        a7670c_ppp_get_ip_info(sim_ip, sizeof(sim_ip));
+    }
+
+    web_admission_stats_t web;
+    web_admission_get_stats(&web);
+
+    uint32_t now = uptime_s();
+    portENTER_CRITICAL(&s_lock);
+    s_status.free_heap = free_heap;
+    s_status.min_free_heap = min_free_heap;
+    s_status.total_heap = total_heap;
+    s_status.internal_heap = internal_heap;
+    s_status.spiram_heap = spiram_heap;
+    s_status.largest_free_block = info.largest_free_block;
+    s_status.total_allocated = info.total_allocated_bytes;
+    s_status.task_count = task_count;
+    s_status.wifi_connected = wifi_up;
+    s_status.rssi = wifi_up ? ap_info.rssi : 0;
+    strncpy(s_status.ssid, wifi_up ? (const char *)ap_info.ssid : "", sizeof(s_status.ssid) - 1);
+    s_status.sim_connected = sim_up;
+    memcpy(s_status.sim_ip, sim_ip, sizeof(sim_ip));
+    s_status.web = web;
+    publish_locked(now);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void gateway_status_update_modbus(int sensors_read)
+{
+    modbus_stats_t stats;
+    modbus_get_statistics(&stats);
+
+    const system_config_t *config = get_system_config();
+    uint8_t configured = config ? (uint8_t)config->sensor_count : 0;
+    uint8_t enabled = 0;
+    for (int i = 0; i < configured; i++) {
+        if (config->sensors[i].enabled) {
+            enabled++;
+        }
+    }
+
+    uint32_t now = uptime_s();
+    portENTER_CRITICAL(&s_lock);
+    s_status.modbus = stats;
+    s_status.sensors_configured = configured;
+    s_status.sensors_enabled = enabled;
+    if (sensors_read >= 0) {
+        s_status.sensors_read = (uint8_t)sensors_read;
+        s_status.sensors_read_at = now;
+    }
+    publish_locked(now);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void gateway_status_update_azure(void)
+{
+    bool connected = mqtt_connected;
+    const system_config_t *config = get_system_config();
+    uint32_t now = uptime_s();
+    portENTER_CRITICAL(&s_lock);
+    s_status.mqtt_connected = connected;
+    s_status.mqtt_connected_at = connected ? (uint32_t)mqtt_connect_time : 0;
+    s_status.last_telemetry_at = (uint32_t)last_telemetry_time;
+    s_status.messages_sent = total_telemetry_sent;
+    s_status.reconnects = mqtt_reconnect_count;
+    strncpy(s_status.device_id, config ? config->azure_device_id : "", sizeof(s_status.device_id) - 1);
+    publish_locked(now);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void gateway_status_set_sim_signal(int dbm, const char *quality, const char *operator_name)
+{
+    uint32_t now = uptime_s();
+    portENTER_CRITICAL(&s_lock);
+    s_status.sim_signal = (int16_t)dbm;
+    strncpy(s_status.sim_signal_quality, quality ? quality : "", sizeof(s_status.sim_signal_quality) - 1);
+    strncpy(s_status.sim_operator, operator_name ? operator_name : "", sizeof(s_status.sim_operator) - 1);
+    publish_locked(now);
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void gateway_status_get(gateway_status_t *out)
+{
+    portENTER_CRITICAL(&s_lock);
+    memcpy(out, &s_status, sizeof(*out));
+    portEXIT_CRITICAL(&s_lock);
+}
+
+uint32_t gateway_status_parse_fields(const char *list)
+{
+    if (list == NULL || *list == '\0') {
+        return GS_ALL;
+    }
+    uint32_t fields = 0;
+    while (*list) {
+        size_t len = strcspn(list, ",");
+        for (size_t g = 0; g < GS_GROUP_COUNT; g++) {
+            if (strlen(s_group_names[g]) == len && strncmp(s_group_names[g], list, len) == 0) {
+                fields |= 1u << g;
+            }
+        }
+        list += len;
+        if (*list == ',') {
+            list++;
+        }
+    }
+    return fields;
+}
+
+// ---------------------------------------------------------------------------
+// Serialization
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} status_writer_t;
+
+static void put(status_writer_t *w, const char *fmt, ...)
+{
+    if (w->overflow) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(w->buf + w->len, w->size - w->len, fmt, args);
+    va_end(args);
+    if (n < 0 || (size_t)n >= w->size - w->len) {
+        w->overflow = true;
+        return;
+    }
+    w->len += n;
+}
+
+// Decodes one UTF-8 sequence at p; returns its length, 0 if it is not valid UTF-8
+static int utf8_decode(const unsigned char *p, uint32_t *cp)
+{
+    int len = p[0] >= 0xF0 ? 4 : p[0] >= 0xE0 ? 3 : p[0] >= 0xC2 ? 2 : 0;
+    if (len == 0 || p[0] > 0xF4) {
+        return 0;
+    }
+    uint32_t c = p[0] & (0x7F >> len);
+    for (int i = 1; i < len; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+        c = (c << 6) | (p[i] & 0x3F);
+    }
+    static const uint32_t min_cp[] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (c < min_cp[len] || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        return 0;
+    }
+    *cp = c;
+    return len;
+}
+
+// JSON string escaped to printable ASCII - SSIDs and operator names come from
+// the air and may hold quotes, control bytes, UTF-8 or bytes that are neither.
+// Valid UTF-8 becomes \uXXXX (surrogate pairs above the BMP), anything else U+FFFD
+static void put_string(status_writer_t *w, const char *s)
+{
+    put(w, "\"");
+    for (const unsigned char *p = (const unsigned char *)s; *p && !w->overflow; p++) {
+        uint32_t cp;
+        int len;
+        if (*p == '"' || *p == '\\') {
+            put(w, "\\%c", *p);
+        } else if (*p >= 0x20 && *p < 0x7F) {
+            put(w, "%c", *p);
+        } else if (*p < 0x80) {
+            put(w, "\\u%04x", *p);
+        } else if ((len = utf8_decode(p, &cp)) == 0) {
+            put(w, "\\ufffd");
+        } else {
+            if (cp >= 0x10000) {
+                cp -= 0x10000;
+                put(w, "\\u%04lx\\u%04lx", (unsigned long)(0xD800 + (cp >> 10)), (unsigned long)(0xDC00 + (cp & 0x3FF)));
+            } else {
+                put(w, "\\u%04lx", (unsigned long)cp);
+            }
+            p += len - 1;
+        }
+    }
+    put(w, "\"");
+}
+
+// Opens a group: "name":{ (full) or "name":[ (compact)
+static void open_group(status_writer_t *w, uint32_t group, bool compact)
+{
+    for (size_t g = 0; g < GS_GROUP_COUNT; g++) {
+        if (group == 1u << g) {
+            put(w, ",\"%s\":%c", s_group_names[g], compact ? '[' : '{');
+            return;
+        }
+    }
+}
+
+static void put_full(status_writer_t *w, const gateway_status_t *st, uint32_t fields)
+{
+    uint32_t t = st->updated_at;
+    put(w, "{\"version\":%lu,\"t\":%lu", (unsigned long)st->version, (unsigned long)t);
+
+    if (fields & GS_SYSTEM) {
+        open_group(w, GS_SYSTEM, false);
+        put(w, "\"uptime_seconds\":%lu,\"uptime_formatted\":\"%02lu:%02lu:%02lu\",\"mac_address\":\"%s\","
+               "\"flash_total\":%lu,\"firmware_version\":\"%s\"}",
+            (unsigned long)t, (unsigned long)(t / 3600), (unsigned long)(t % 3600 / 60), (unsigned long)(t % 60),
+            st->mac, (unsigned long)st->flash_total, FW_VERSION_STRING);
+    }
+    if (fields & GS_MEMORY) {
+        float usage = st->total_heap ? (float)(st->total_heap - st->free_heap) * 100.0f / st->total_heap : 0.0f;
+        open_group(w, GS_MEMORY, false);
+        put(w, "\"free_heap\":%lu,\"min_free_heap\":%lu,\"total_heap\":%lu,\"heap_usage_percent\":%.1f,"
+               "\"internal_heap\":%lu,\"spiram_heap\":%lu,\"largest_free_block\":%lu,\"total_allocated\":%lu}",
+            (unsigned long)st->free_heap, (unsigned long)st->min_free_heap, (unsigned long)st->total_heap, usage,
+            (unsigned long)st->internal_heap, (unsigned long)st->spiram_heap,
+            (unsigned long)st->largest_free_block, (unsigned long)st->total_allocated);
+    }
+    if (fields & GS_PARTITIONS) {
+        open_group(w, GS_PARTITIONS, false);
+        put(w, "\"app_partition_size\":%lu,\"nvs_partition_size\":%lu}",
+            (unsigned long)st->app_partition_size, (unsigned long)st->nvs_partition_size);
+    }
+    if (fields & GS_WIFI) {
+        open_group(w, GS_WIFI, false);
+        put(w, "\"status\":\"%s\",\"rssi\":%d,\"ssid\":",
+            st->wifi_connected ? "connected" : "disconnected", st->rssi);
+        put_string(w, st->wifi_connected ? st->ssid : "N/A");
+        put(w, "}");
+    }
+    if (fields & GS_SIM) {
+        open_group(w, GS_SIM, false);
+        put(w, "\"status\":\"%s\",\"ip\":\"%s\",\"signal\":%d,\"signal_quality\":",
+            st->sim_connected ? "connected" : "disconnected",
+            st->sim_connected && st->sim_ip[0] ? st->sim_ip : "N/A", st->sim_signal);
+        put_string(w, st->sim_signal_quality[0] ? st->sim_signal_quality : "Unknown");
+        put(w, ",\"operator\":");
+        put_string(w, st->sim_operator[0] ? st->sim_operator : "Unknown");
+        put(w, "}");
+    }
+    if (fields & GS_MODBUS) {
+        const modbus_stats_t *mb = &st->modbus;
+        float rate = mb->total_requests ? (float)mb->successful_requests * 100.0f / mb->total_requests : 0.0f;
+        open_group(w, GS_MODBUS, false);
+        put(w, "\"total_reads\":%lu,\"successful_reads\":%lu,\"failed_reads\":%lu,\"success_rate\":%.2f,"
+               "\"crc_errors\":%lu,\"timeout_errors\":%lu,\"last_error_code\":%lu}",
+            (unsigned long)mb->total_requests, (unsigned long)mb->successful_requests,
+            (unsigned long)mb->failed_requests, rate, (unsigned long)mb->crc_errors,
+            (unsigned long)mb->timeout_errors, (unsigned long)mb->last_error_code);
+    }
+    if (fields & GS_AZURE) {
+        open_group(w, GS_AZURE, false);
+        put(w, "\"connection_state\":\"%s\",\"connection_uptime\":%lu,\"messages_sent\":%lu,"
+               "\"reconnect_attempts\":%lu,\"last_telemetry_ago\":%lu,\"device_id\":",
+            st->mqtt_connected ? "connected" : "disconnected",
+            (unsigned long)(st->mqtt_connected && t > st->mqtt_connected_at ? t - st->mqtt_connected_at : 0),
+            (unsigned long)st->messages_sent, (unsigned long)st->reconnects,
+            (unsigned long)(st->last_telemetry_at && t > st->last_telemetry_at ? t - st->last_telemetry_at : 0));
+        put_string(w, st->device_id);
+        put(w, "}");
+    }
+    if (fields & GS_SENSORS) {
+        open_group(w, GS_SENSORS, false);
+        put(w, "\"count\":%u,\"configured\":%s,\"enabled\":%u,\"read_ok\":%u,\"read_ago\":%ld}",
+            st->sensors_configured, st->sensors_configured > 0 ? "true" : "false", st->sensors_enabled,
+            st->sensors_read, st->sensors_read_at ? (long)(t - st->sensors_read_at) : -1L);
+    }
+    if (fields & GS_TASKS) {
+        open_group(w, GS_TASKS, false);
+        put(w, "\"count\":%u}", st->task_count);
+    }
+    if (fields & GS_WEB) {
+        open_group(w, GS_WEB, false);
+        put(w, "\"served\":%lu,\"degraded\":%lu,\"queued\":%lu,\"rejected\":%lu,\"stack_free_min\":%lu}",
+            (unsigned long)st->web.served, (unsigned long)st->web.degraded, (unsigned long)st->web.queued,
+            (unsigned long)st->web.rejected,
+            (unsigned long)(st->web.stack_free_min == UINT32_MAX ? 0 : st->web.stack_free_min));
+    }
+    put(w, "}");
+}
+
+static void put_compact(status_writer_t *w, const gateway_status_t *st, uint32_t fields)
+{
+    put(w, "{\"v\":%lu,\"t\":%lu", (unsigned long)st->version, (unsigned long)st->updated_at);
+
+    if (fields & GS_SYSTEM) {
+        open_group(w, GS_SYSTEM, true);
+        put(w, "%lu,%lu,\"%s\",", (unsigned long)st->updated_at, (unsigned long)st->flash_total, st->mac);
+        put_string(w, FW_VERSION_STRING);
+        put(w, "]");
+    }
+    if (fields & GS_MEMORY) {
+        open_group(w, GS_MEMORY, true);
+        put(w, "%lu,%lu,%lu,%lu,%lu,%lu,%lu]",
+            (unsigned long)st->free_heap, (unsigned long)st->min_free_heap, (unsigned long)st->total_heap,
+            (unsigned long)st->internal_heap, (unsigned long)st->spiram_heap,
+            (unsigned long)st->largest_free_block, (unsigned long)st->total_allocated);
+    }
+    if (fields & GS_PARTITIONS) {
+        open_group(w, GS_PARTITIONS, true);
+        put(w, "%lu,%lu]", (unsigned long)st->app_partition_size, (unsigned long)st->nvs_partition_size);
+    }
+    if (fields & GS_WIFI) {
+        open_group(w, GS_WIFI, true);
+        put(w, "%d,%d,", st->wifi_connected, st->rssi);
+        put_string(w, st->ssid);
+        put(w, "]");
+    }
+    if (fields & GS_SIM) {
+        open_group(w, GS_SIM, true);
+        put(w, "%d,%d,\"%s\",", st->sim_connected, st->sim_signal, st->sim_ip);
+        put_string(w, st->sim_operator);
+        put(w, "]");
+    }
+    if (fields & GS_MODBUS) {
+        const modbus_stats_t *mb = &st->modbus;
+        open_group(w, GS_MODBUS, true);
+        put(w, "%lu,%lu,%lu,%lu,%lu,%lu]",
+            (unsigned long)mb->total_requests, (unsigned long)mb->successful_requests,
+            (unsigned long)mb->failed_requests, (unsigned long)mb->crc_errors,
+            (unsigned long)mb->timeout_errors, (unsigned long)mb->last_error_code);
+    }
+    if (fields & GS_AZURE) {
+        open_group(w, GS_AZURE, true);
+        put(w, "%d,%lu,%lu,%lu,%lu,", st->mqtt_connected, (unsigned long)st->mqtt_connected_at,
+            (unsigned long)st->last_telemetry_at, (unsigned long)st->messages_sent,
+            (unsigned long)st->reconnects);
+        put_string(w, st->device_id);
+        put(w, "]");
+    }
+    if (fields & GS_SENSORS) {
+        open_group(w, GS_SENSORS, true);
+        put(w, "%u,%u,%u,%lu]", st->sensors_configured, st->sensors_enabled, st->sensors_read,
+            (unsigned long)st->sensors_read_at);
+    }
+    if (fields & GS_TASKS) {
+        open_group(w, GS_TASKS, true);
+        put(w, "%u]", st->task_count);
+    }
+    if (fields & GS_WEB) {
+        open_group(w, GS_WEB, true);
+        put(w, "%lu,%lu,%lu,%lu,%lu]",
+            (unsigned long)st->web.served, (unsigned long)st->web.degraded, (unsigned long)st->web.queued,
+            (unsigned long)st->web.rejected,
+            (unsigned long)(st->web.stack_free_min == UINT32_MAX ? 0 : st->web.stack_free_min));
+    }
+    put(w, "}");
+}
+
+size_t gateway_status_format(const gateway_status_t *st, uint32_t fields, bool compact,
+                             char *out, size_t out_size)
+{
+    status_writer_t w = { out, out_size, 0, false };
+    if (compact) {
+        put_compact(&w, st, fields);
+    } else {
+        put_full(&w, st, fields);
+    }
+    if (w.overflow) {
+        ESP_LOGW(TAG, "Status response truncated - raise STATUS_RESPONSE_SIZE");
+        return 0;
+    }
+    return w.len;
+}
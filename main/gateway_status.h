@@ -0,0 +1,144 @@
+/**
+ * gateway_status.h - Pre-aggregated gateway status behind /api/status.
+ *
+ * The portal and the fleet scripts used to poll /api/system_status,
+ * /api/modbus/status and /api/azure/status, each of which sampled the heap,
+ * WiFi driver, partitions and counters and formatted its own JSON per request.
+ * Here the owning tasks publish their part when it changes:
+ *
+ *   system, partitions   gateway_status_init()      once at boot (static facts)
+ *   memory, tasks, wifi,
+ *   sim, web             gateway_status_update_health()   memory monitor, every cycle
+ *   modbus, sensors      gateway_status_update_modbus()   after each sensor read cycle
+ *   azure                gateway_status_update_azure()    MQTT events, telemetry sent
+ *
+ * and a request costs one copy of the snapshot plus serialization of the
+ * groups it asked for. Every update bumps version, which the handler uses as
+ * the ETag, so a poll between updates is answered with 304.
+ *
+ * Two encodings share the same groups:
+ *
+ *   full     {"version":..,"t":..,"memory":{"free_heap":..,..},..} - the key
+ *            names of the old endpoints, so the portal maps over 1:1
+ *   compact  {"v":..,"t":..,"memory":[..],..} - each group a positional array
+ *            (order below), integers only, times as uptime seconds, so
+ *            scripts can poll it over the VPN cheaply
+ *
+ * Strings are escaped to printable ASCII in both, so an SSID or operator name
+ * with quotes, control bytes or UTF-8 cannot break the document.
+ */
+
+#ifndef GATEWAY_STATUS_H
+#define GATEWAY_STATUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "modbus.h"
+#include "web_admission.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// fields= groups (names as in the response)
+#define GS_SYSTEM       (1u << 0)   // compact: [uptime_s, flash_total, "mac", "firmware"]
+#define GS_MEMORY       (1u << 1)   // compact: [free, min_free, total, internal, spiram, largest_block, allocated]
+#define GS_PARTITIONS   (1u << 2)   // compact: [app_size, nvs_size]
+#define GS_WIFI         (1u << 3)   // compact: [connected, rssi, "ssid"]
+#define GS_SIM          (1u << 4)   // compact: [connected, signal_dbm, "ip", "operator"]
+#define GS_MODBUS       (1u << 5)   // compact: [total, ok, failed, crc, timeout, last_error]
+#define GS_AZURE        (1u << 6)   // compact: [connected, connected_at, last_telemetry_at, sent, reconnects, "device_id"]
+#define GS_SENSORS      (1u << 7)   // compact: [configured, enabled, read_ok_last_cycle, read_at]
+#define GS_TASKS        (1u << 8)   // compact: [count]
+#define GS_WEB          (1u << 9)   // compact: [served, degraded, queued, rejected, stack_free_min]
+#define GS_ALL          0x3FFu
+
+typedef struct {
+    uint32_t version;               // Bumped by every update
+    uint32_t updated_at;            // Uptime (s) of the last update
+
+    // system / partitions (static)
+    char mac[18];
+    uint32_t flash_total;
+    uint32_t app_partition_size;
+    uint32_t nvs_partition_size;
+
+    // memory / tasks
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint32_t total_heap;
+    uint32_t internal_heap;
+    uint32_t spiram_heap;
+    uint32_t largest_free_block;
+    uint32_t total_allocated;
+    uint16_t task_count;
+
+    // wifi / sim
+    bool wifi_connected;
+    int8_t rssi;
+    char ssid[33];
+    bool sim_connected;
+    int16_t sim_signal;             // dBm from the last SIM test, 0 = unknown
+    char sim_ip[16];
+    char sim_signal_quality[16];
+    char sim_operator[32];
+
+    // modbus / sensors
+    modbus_stats_t modbus;
+    uint8_t sensors_configured;
+    uint8_t sensors_enabled;
+    uint8_t sensors_read;           // Successful reads in the last cycle
+    uint32_t sensors_read_at;       // Uptime (s), 0 = no cycle yet
+
+    // azure
+    bool mqtt_connected;
+    uint32_t mqtt_connected_at;     // Uptime (s)
+    uint32_t last_telemetry_at;     // Uptime (s), 0 = never
+    uint32_t messages_sent;
+    uint32_t reconnects;
+    char device_id[32];
+
+    // web
+    web_admission_stats_t web;
+} gateway_status_t;
+
+/**
+ * Fill the static groups and take a first sample of everything else.
+ * Call once from app_main() after the configuration is loaded.
+ */
+void gateway_status_init(void);
+
+void gateway_status_update_health(void);
+// sensors_read: successful reads of the cycle just finished, -1 = counters only
+void gateway_status_update_modbus(int sensors_read);
+void gateway_status_update_azure(void);
+
+/**
+ * Record the modem's signal and operator from the portal's SIM test.
+ */
+void gateway_status_set_sim_signal(int dbm, const char *quality, const char *operator_name);
+
+/**
+ * Copy of the current snapshot.
+ */
+void gateway_status_get(gateway_status_t *out);
+
+/**
+ * "memory,modbus" -> GS_MEMORY | GS_MODBUS. NULL or empty selects GS_ALL;
+ * unknown names are ignored, so 0 means nothing recognised.
+ */
+uint32_t gateway_status_parse_fields(const char *list);
+
+/**
+ * Serialize the selected groups of a snapshot. Returns the length, or 0 if
+ * out_size is too small.
+ */
+size_t gateway_status_format(const gateway_status_t *st, uint32_t fields, bool compact,
+                             char *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GATEWAY_STATUS_H
@@ -18,9 +18,10 @@
 
 // Telemetry Configuration
 #define TELEMETRY_FREQUENCY_MILLISECS 300000  // 5 minutes (300 seconds)
+#define TELEMETRY_DEFAULT_MAX_BATCH 10        // Sensors per batch message (web portal / Device Twin: 1-10)
+#define TELEMETRY_MAX_MESSAGE_BYTES 512       // Batch parts are split at this size = SD cache payload limit
 
 // Production Configuration
-#define MAX_MQTT_RECONNECT_ATTEMPTS 20       // Increased - don't give up quickly on network issues
 #define MAX_MODBUS_READ_FAILURES 10
 #define SYSTEM_RESTART_ON_CRITICAL_ERROR false  // Disabled - cache to SD card instead of restarting
 
@@ -29,6 +30,20 @@
 #define TELEMETRY_TIMEOUT_SEC 1800        // 30 minutes - force restart if no successful telemetry
 #define HEARTBEAT_LOG_INTERVAL_SEC 300    // 5 minutes - log heartbeat to SD card
 
+// Connectivity Recovery Configuration (see conn_sm.h)
+#define CONN_MQTT_BACKOFF_BASE_MS 2000            // First MQTT reconnect delay
+#define CONN_MQTT_BACKOFF_MAX_MS 60000            // MQTT backoff cap
+#define CONN_MQTT_ESCALATE_ATTEMPTS 4             // MQTT attempts before cycling the link...
+#define CONN_MQTT_ESCALATE_MS 180000              // ...and at least 3 minutes of MQTT retries
+#define CONN_LINK_BACKOFF_BASE_MS 5000            // First WiFi/PPP reconnect delay
+#define CONN_LINK_BACKOFF_MAX_MS 120000           // Link backoff cap
+#define CONN_LINK_ESCALATE_ATTEMPTS 4             // Link attempts before a modem reset...
+#define CONN_LINK_ESCALATE_MS 120000              // ...and at least 2 minutes of link retries
+#define CONN_BACKOFF_JITTER_PCT 20                // +/- jitter on every retry delay
+#define CONN_STABLE_MS 60000                      // Online this long before retry counters reset
+#define CONN_MODEM_RESET_COOLDOWN_MS 300000       // 5 minutes between modem resets
+#define CONN_MAX_MODEM_RESETS 3                   // Per outage, before a reboot is considered
+
 // Device Twin Configuration
 #define DEVICE_TWIN_UPDATE_INTERVAL_SEC 300  // 5 minutes - report device status to Azure
 
@@ -36,12 +51,113 @@
 #define SD_REPLAY_DELAY_BETWEEN_MESSAGES_MS 500   // Delay between each cached message (500ms minimum for Azure)
 #define SD_REPLAY_DELAY_BETWEEN_BATCHES_MS 2000   // Delay between replay batches (2 seconds)
 #define SD_REPLAY_MAX_MESSAGES_PER_BATCH 10       // Max messages per batch (reduced from 20)
-#define SD_REPLAY_WAIT_FOR_ACK_MS 1000            // Wait time for MQTT ACK before continuing
+#define SD_REPLAY_WAIT_FOR_ACK_MS 5000            // Max wait for PUBACK before keeping a replayed message on SD
+
+// MQTT Outbox Configuration (QoS 1 telemetry, see mqtt_outbox.h)
+#define MQTT_OUTBOX_MAX_IN_FLIGHT 8               // Unacknowledged publishes before new ones go to SD
+#define MQTT_OUTBOX_BUDGET_BYTES 8192             // Payload bytes held for in-flight publishes
+#define MQTT_OUTBOX_ACK_TIMEOUT_MS 30000          // Matches esp-mqtt outbox expiry - spill after this
+
+// Web Portal Live Status (WebSocket /ws, see web_push.h)
+#define WS_PUSH_INTERVAL_MS 1000                  // Change check / delta push period
+#define WS_PUSH_MAX_CLIENTS 3                     // Leaves 4 of the 7 httpd sockets for page/API requests
+#define WS_PUSH_MSG_SIZE 2048                     // Full-state message buffer (worst case ~1.9KB with 10 sensors)
+#define LIVE_DATA_STALE_INTERVALS 2               // /live_data marks a value stale after this many telemetry intervals
+
+// Request Body Parsing (see body_parser.h)
+#define BODY_KEY_MAX 48                   // Longest form/JSON key incl. NUL (sensor_9_sub_7_register_type = 29)
+#define BODY_VALUE_MAX 512                // Longest value incl. NUL (OTA URLs) - longer values are dropped, not truncated
+#define BODY_JSON_MAX_DEPTH 6             // Nested objects/arrays ({"sensor":[{"sub":[{..}]}]} is 5)
+#define BODY_CHUNK_SIZE 256               // httpd_req_recv() chunk, on the handler stack
+#define BODY_MAX_LEN 16384                // Reject larger bodies (a 10-sensor form is ~6KB)
+
+// Web Portal Admission Control (see web_admission.h)
+#define WEB_ADMIT_HEAP_RESERVE 20000      // Heap a request may never take from MQTT/TLS (bytes)
+#define WEB_ADMIT_DEFAULT_COST 4096       // Routes without an entry in the cost table
+#define WEB_ADMIT_QUEUE_MS 600            // Wait this long for heap before answering 503
+#define WEB_ADMIT_POLL_MS 50
+#define WEB_ADMIT_RETRY_AFTER_S 5         // Retry-After on 503
+#define WEB_ADMIT_STACK_MARGIN 1024       // Warn when the httpd stack high water mark drops below this
+#define WEB_HTTPD_MAX_URI_HANDLERS 72     // httpd max_uri_handlers - ~64 registered today incl. /ws and /vpn-status
+#define WEB_ADMIT_MAX_ROUTES WEB_HTTPD_MAX_URI_HANDLERS
+
+// Consolidated Status (/api/status, see gateway_status.h)
+#define STATUS_CACHE_MAX_AGE_S 5          // Cache-Control max-age - the health sample is refreshed every 10s
+#define STATUS_RESPONSE_SIZE 1536         // All groups in full form are ~1.2KB
+
+// Modem CMUX (3GPP 27.010, see cmux.h) - PPP on DLC 1, AT commands on DLC 2
+#define MODEM_CMUX_ENABLED 1              // 0 = PPP on the raw UART, AT only by pausing PPP
+#define CMUX_N1 127                       // Max information bytes per frame (AT+CMUX N1; 31 if the modem refuses)
+#define CMUX_RX_FRAME_MAX 512             // Largest frame accepted from the modem
+#define CMUX_OPEN_TIMEOUT_MS 1000         // Wait for UA after each SABM
+#define CMUX_DIAL_TIMEOUT_MS 10000        // Wait for CONNECT on the PPP channel
+#define MODEM_SIGNAL_REFRESH_MS 30000     // Stored signal older than this is re-read over CMUX
+
+// Modem UART (a7670c_ppp.c) - sized for PPP at up to 921600 baud
+#define MODEM_UART_RX_BUF 8192            // Driver RX ring: ~90ms at 921600, covers flash-write stalls without RTS/CTS
+#define MODEM_UART_TX_BUF 4096            // Driver TX ring: PPP output returns once queued here
+#define MODEM_UART_EVENT_QUEUE 32         // RX-full / RX-timeout events waking uart_rx_task
+#define MODEM_UART_RX_CHUNK 1024          // Bytes handed to PPP (or the CMUX decoder) per read
+#define MODEM_UART_RX_FULL_THRESH 64      // FIFO bytes that raise an RX-full event
+#define MODEM_UART_RX_TOUT_SYMBOLS 2      // Idle byte times that raise an RX-timeout event
+#define MODEM_UART_FLOW_THRESH 100        // FIFO level that deasserts RTS (FIFO is 128 bytes)
+
+// Modbus Register Dump (/api/modbus_dump, see modbus_dump.h)
+#define MODBUS_DUMP_MAX_BLOCK 125         // Registers per read (Modbus limit for FC 0x03/0x04)
+#define MODBUS_DUMP_MAX_COUNT 10000       // Registers per request - the httpd task is busy for the whole dump
+#define MODBUS_DUMP_MAX_ERRORS 3          // Consecutive timeouts/CRC errors before the dump stops
+
+// Telegram bot (telegram_bot.c)
+#define TELEGRAM_LONG_POLL_S 25           // getUpdates timeout= - Telegram holds the request this long
+#define TELEGRAM_UPDATE_LIMIT 3           // Updates per getUpdates, keeps the response within the buffer
+#define TELEGRAM_RESPONSE_SIZE 4096
+#define TELEGRAM_MAX_RETRY_S 300          // Longest retry delay after failed polls
+#define TELEGRAM_ALERT_QUEUE 8            // Distinct alerts held for one batch (more are counted)
+#define TELEGRAM_ALERT_COALESCE_MS 10000  // First alert waits this long for others
+#define TELEGRAM_ALERT_MIN_GAP_MS 60000   // At most one alert batch per minute
+
+// DNS cache and connection pool (net_cache.h)
+#define NET_DNS_CACHE_SIZE 8              // Host names kept (answers and failures)
+#define NET_DNS_TTL_S 300                 // Resolved address reused this long
+#define NET_DNS_NEG_TTL_S 15              // Failed lookup answered from cache this long - fail fast during outages
+#define NET_POOL_IDLE_MS 60000            // Keep-alive connection closed after this long unused
+#define NET_POOL_SESSION_MS (45 * 60 * 1000)  // Client and its TLS session freed after this long unused
+
+// Deferred logging (dlog.h)
+#define DLOG_RING_RECORDS 64              // Events kept in RAM (DLOG_PAYLOAD_BYTES + 12 each)
+#define DLOG_PAYLOAD_BYTES 60             // Argument bytes per event - 8 per double, 4 per int
+#define DLOG_MAX_STR 24                   // %s arguments are copied up to this many characters
+#define DLOG_SITE_BURST 20                // Events per call site per window, the rest are counted
+#define DLOG_SITE_WINDOW_MS 10000
+#define DLOG_FLUSH_MS 100                 // Formatter task period
+#define DLOG_TASK_STACK 4096              // Formatter task (snprintf with doubles)
+#define DLOG_TASK_PRIORITY 1              // Below every task that records
+#define DLOG_SD_PATH "/sdcard/log.txt"
+#define DLOG_SD_OLD_PATH "/sdcard/log.old"
+#define DLOG_SD_MAX_BYTES (256 * 1024)    // log.txt is moved to log.old at this size
+#define DLOG_SD_BUF_SIZE 2048             // Lines batched per SD write
+#define DLOG_SD_FLUSH_MS 5000             // Partial batch written after this long
+
+// Latency histograms and event trace (perf_trace.h)
+#define PERF_MODBUS_SLAVES 8              // Slaves with their own Modbus histogram
+#define PERF_TRACE_EVENTS 512             // Trace ring, 16 bytes each - allocated only during a capture
+#define PERF_TRACE_TASKS 24               // Task names kept for a capture
+#define PERF_TRACE_MIN_HEAP 40000         // Free heap left after the ring, or the capture is refused
 
 // OTA Configuration
 #define OTA_RECV_TIMEOUT_MS 30000         // HTTP receive timeout (30s for slow CDN)
 #define OTA_BUF_SIZE 4096                 // Download buffer size
-#define OTA_MAX_RETRY 3                   // Max download retries
+#define OTA_PIPE_BUFFERS 4                // Buffers between the receive and flash writer tasks (OTA_BUF_SIZE each)
+#define OTA_PREERASE_AHEAD (32 * 1024)    // Flash erased ahead of the write pointer while waiting for data
+#define OTA_WRITER_STACK 4096             // Flash writer task; also runs delta patch inflate
+#define OTA_MODEM_SHREAD_WINDOW 16384     // AT+SHREAD length on the modem HTTPS path (was 2KB)
+#define OTA_MAX_RETRY 3                   // Reconnects in a row without progress before giving up (download resumes with Range)
+#define OTA_RESUME_CHECKPOINT_BYTES (64 * 1024)  // Progress saved to NVS this often - most a reboot can lose
+#define OTA_PEER_HTTP_TIMEOUT_MS 4000     // Manifest request to a site peer (see ota_peer.h)
+#define OTA_PEER_WAKE_WAIT_MS 3000        // Wait after a peer answers with its wake page before asking again
+#define OTA_PEER_STAGE_CHUNK 4096         // Bytes copied to SD per SD mutex hold when staging
+#define OTA_PEER_STAGE_STACK 4096
+#define OTA_PEER_SERVE_STACK 3072         // Image transfer task - one peer at a time, off the httpd task
 #define OTA_CONFIRM_TIMEOUT_SEC 300       // 5 minutes to confirm new firmware before rollback
 
 #endif // IOT_CONFIGS_H
\ No newline at end of file
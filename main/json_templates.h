@@ -32,7 +32,7 @@ typedef struct {
     int slave_id;
     // Network telemetry fields (NEW)
     int signal_strength;          // Signal strength in dBm (WiFi RSSI or SIM RSSI)
-    char network_type[16];        // "WiFi" or "4G"
+    char network_type[16];        // "WiFi", "4G" or the modem system mode ("LTE", "GSM", ...)
     char network_quality[16];     // "Excellent", "Good", "Fair", "Poor", "Unknown"
     // Additional parameters for specific types
     struct {
@@ -0,0 +1,28 @@
+/**
+ * lwip_hooks.h - Project lwIP hooks.
+ *
+ * Included into lwIP's own build through ESP_IDF_LWIP_HOOK_FILENAME (see
+ * main/CMakeLists.txt), from lwipopts.h before any lwIP type is defined,
+ * so only forward declarations here.
+ */
+
+#ifndef LWIP_HOOKS_H
+#define LWIP_HOOKS_H
+
+struct pbuf;
+struct netif;
+
+// Wake-on-traffic (web_wake.c). Returns 1 if it consumed (freed) the packet.
+int web_wake_ip4_input_hook(struct pbuf *p, struct netif *inp);
+#define LWIP_HOOK_IP4_INPUT web_wake_ip4_input_hook
+
+#endif // LWIP_HOOKS_H
+
+// DNS cache (net_cache.c), CONFIG_LWIP_HOOK_DNS_EXT_RESOLVE_CUSTOM. Needs
+// lwIP's DNS types, so it is only declared for files that included
+// lwip/dns.h first; a mismatch with lwIP's own prototype fails to compile.
+#if defined(LWIP_HDR_DNS_H) && !defined(LWIP_HOOKS_DNS_H)
+#define LWIP_HOOKS_DNS_H
+int lwip_hook_dns_external_resolve(const char *name, ip_addr_t *addr, dns_found_callback found,
+                                   void *callback_arg, u8_t addrtype, err_t *err);
+#endif
@@ -13,6 +13,7 @@
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_random.h"
 #include "nvs_flash.h"
 #include "esp_netif.h"
 #include "esp_sntp.h"
@@ -31,15 +32,25 @@
 #include "sensor_manager.h"
 #include "network_stats.h"
 #include "json_templates.h"
+#include "telemetry_codec.h"
+#include "mqtt_outbox.h"
+#include "mqtt_tls_transport.h"
+#include "conn_sm.h"
 #include "sd_card_logger.h"
 #include "ds3231_rtc.h"
 #include "a7670c_ppp.h"
-// #include "telegram_bot.h"  // Disabled to save memory
+#ifdef CONFIG_GATEWAY_TELEGRAM_BOT
+#include "telegram_bot.h"
+#endif
 #include "ota_update.h"
 #include "cJSON.h"
 #include "esp_crt_bundle.h"
 #include "wireguard_client.h"
 #include "web_wake.h"
+#include "gateway_status.h"
+#include "net_cache.h"
+#include "dlog.h"
+#include "perf_trace.h"
 
 static const char *TAG = "AZURE_IOT";
 
@@ -102,9 +113,15 @@ int64_t mqtt_connect_time = 0;  // Timestamp when MQTT connected
 int64_t last_telemetry_time = 0;  // Timestamp of last telemetry sent
 
 // SAS Token management for auto-refresh
-static int64_t sas_token_generated_time = 0;  // When token was created (epoch seconds)
-static uint32_t sas_token_expiry_seconds = 3600;  // Token validity (1 hour)
+#define SAS_TOKEN_VALIDITY_SEC 3600  // Token validity (1 hour)
 #define SAS_TOKEN_REFRESH_MARGIN_SEC 300  // Refresh 5 minutes before expiry
+static int64_t sas_token_generated_time = 0;  // When token was created (epoch seconds)
+static uint32_t sas_token_expiry_seconds = SAS_TOKEN_VALIDITY_SEC;
+static char sas_token_device_id[32];  // Device the current token was signed for
+
+// Fast reconnect: token swap on the running client, not a link failure
+static volatile bool mqtt_planned_reconnect = false;
+static esp_transport_handle_t mqtt_transport = NULL;  // Owned by mqtt_client
 
 // NTP periodic sync management
 static int64_t last_ntp_sync_time = 0;  // Last successful NTP sync (epoch seconds)
@@ -124,8 +141,8 @@ static volatile uint32_t sd_replay_last_msg_id = 0;    // Track last message ID
 // Static buffers to avoid stack overflow (sizes reduced to save heap)
 static char mqtt_broker_uri[128];   // Reduced from 256 - Azure URIs ~50-80 bytes
 static char mqtt_username[128];     // Reduced from 256 - Username ~80-100 bytes
-static char telemetry_topic[128];   // Reduced from 256 - Topic ~50-70 bytes
-static char telemetry_payload[2560];  // Reduced from 4096 to save 1.5KB (supports 10 sensors at ~200 bytes each)
+static char telemetry_topic[TELEMETRY_TOPIC_MAX];  // Topic + routing properties, must fit the SD cache line
+static char telemetry_payload[MAX_JSON_PAYLOAD_SIZE];  // One message - large sites are split into parts of TELEMETRY_MAX_MESSAGE_BYTES
 static char c2d_topic[128];  // Reduced from 256 - C2D topic ~50-70 bytes
 
 // Device Twin topic patterns for Azure IoT Hub
@@ -140,6 +157,10 @@ static int device_twin_request_id = 0;
 static sensor_reading_t telemetry_readings[10];  // Reduced from 15 to 10 sensors to save ~1.1KB heap
 static char telemetry_temp_json[MAX_JSON_PAYLOAD_SIZE];  // Pre-allocated JSON buffer
 static int sensors_already_published = 0;  // Track sensors published in create_telemetry_payload
+static int sensors_cached_to_sd = 0;       // Sensors create_telemetry_payload cached instead of publishing
+static uint32_t telemetry_cycle_seq = 0;   // "seq" routing property, one per telemetry cycle (resets at boot)
+static uint8_t telemetry_cbor[TELEMETRY_CBOR_MAX_SIZE];  // CBOR form of telemetry_payload (CBOR encoding only)
+static size_t telemetry_cbor_len = 0;                    // 0 = current payload is JSON only
 
 // GPIO interrupt flag for web server toggle
 static volatile bool web_server_toggle_requested = false;
@@ -155,9 +176,10 @@ static char ota_url[256] = "";                    // Remote OTA firmware URL
 // Modem control variables
 static bool modem_reset_enabled = false;
 static int modem_reset_gpio_pin = 2; // Default GPIO pin, configurable via web interface
-static TaskHandle_t modem_reset_task_handle = NULL;
-static int64_t last_modem_reset_time = 0;  // Track last reset to prevent rapid cycling
-#define MODEM_RESET_COOLDOWN_SEC 300  // 5 minutes between reset attempts
+
+// Connectivity recovery (MQTT -> link -> modem reset -> reboot), see conn_sm.h
+static conn_sm_t conn_sm;
+static TaskHandle_t connectivity_task_handle = NULL;
 
 // LED status variables
 static volatile bool sensors_responding = false;
@@ -185,7 +207,7 @@ static SemaphoreHandle_t telemetry_history_mutex = NULL;
 static bool send_telemetry(void);
 static void init_modem_reset_gpio(void);
 static void perform_modem_reset(void);
-static void modem_reset_task(void *pvParameters);
+static void connectivity_task(void *pvParameters);
 static void mqtt_task(void *pvParameters);
 static void telemetry_task(void *pvParameters);
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
@@ -265,7 +287,7 @@ int get_telemetry_history_json(char *buffer, size_t buffer_size) {
     return written;
 }
 static esp_err_t reinit_modem_reset_gpio(int new_gpio_pin);
-// Non-static — called from web_wake.c (wake-on-ICMP + idle-shutdown)
+// Non-static — called from web_wake.c (wake-on-traffic + idle-shutdown)
 void start_web_server(void);
 void stop_web_server(void);
 static void handle_web_server_toggle(void);
@@ -704,6 +726,8 @@ static int generate_sas_token(char* token, size_t token_size, uint32_t expiry_se
     // Track token generation time for auto-refresh
     sas_token_generated_time = now;
     sas_token_expiry_seconds = expiry_seconds;
+    strncpy(sas_token_device_id, config->azure_device_id, sizeof(sas_token_device_id) - 1);
+    sas_token_device_id[sizeof(sas_token_device_id) - 1] = '\0';
 
     ESP_LOGI(TAG, "Generated SAS token: %.100s...", token);
     ESP_LOGI(TAG, "[SAS] Token valid for %lu seconds (expires at %lu)", expiry_seconds, expiry);
@@ -729,59 +753,149 @@ static bool sas_token_needs_refresh(void) {
     return false;
 }
 
-// Refresh SAS token and reconnect MQTT client
+// Check if the current SAS token can be reused for a new connection.
+// Client re-creation (OTA restart, network recovery) keeps the token instead of
+// signing a new one - it is only regenerated when close to expiry.
+static bool sas_token_is_reusable(void) {
+    if (sas_token_generated_time == 0 || sas_token[0] == '\0') {
+        return false;
+    }
+
+    system_config_t* config = get_system_config();
+    if (strcmp(sas_token_device_id, config->azure_device_id) != 0) {
+        return false;  // Device identity changed since the token was signed
+    }
+
+    int64_t token_age = time(NULL) - sas_token_generated_time;
+    return token_age >= 0 && (sas_token_expiry_seconds - token_age) > SAS_TOKEN_REFRESH_MARGIN_SEC;
+}
+
+// MQTT client configuration shared by initial connect, full rebuild and fast reconnect
+static void build_mqtt_client_config(esp_mqtt_client_config_t* mqtt_config, system_config_t* config) {
+    snprintf(mqtt_broker_uri, sizeof(mqtt_broker_uri), "mqtts://%s", IOT_CONFIG_IOTHUB_FQDN);
+    snprintf(mqtt_username, sizeof(mqtt_username), "%s/%s/?api-version=2018-06-30",
+             IOT_CONFIG_IOTHUB_FQDN, config->azure_device_id);
+
+    memset(mqtt_config, 0, sizeof(*mqtt_config));
+    mqtt_config->broker.address.uri = mqtt_broker_uri;
+    mqtt_config->broker.address.port = 8883;
+    mqtt_config->credentials.client_id = config->azure_device_id;
+    mqtt_config->credentials.username = mqtt_username;
+    mqtt_config->credentials.authentication.password = sas_token;
+    mqtt_config->session.keepalive = 30;
+    mqtt_config->session.disable_clean_session = 0;
+    mqtt_config->session.protocol_ver = MQTT_PROTOCOL_V_3_1_1;  // Force MQTT 3.1.1 like Arduino 1.0.6
+    mqtt_config->network.disable_auto_reconnect = false;
+    // connectivity_task paces reconnects; esp-mqtt's own timer is only a safety net
+    mqtt_config->network.reconnect_timeout_ms = CONN_MQTT_BACKOFF_MAX_MS * 5;
+    // Use ESP-IDF certificate bundle for better compatibility with PPP mode
+    // The bundle includes all major root CAs and handles certificate chains properly
+    mqtt_config->broker.verification.crt_bundle_attach = esp_crt_bundle_attach;
+    // esp-tls transport that resumes the previous TLS session on reconnect
+    // (NULL falls back to the built-in SSL transport)
+    mqtt_config->network.transport = mqtt_transport;
+}
+
+static esp_err_t create_and_start_mqtt_client(system_config_t* config) {
+    mqtt_transport = mqtt_tls_transport_create();
+    if (mqtt_transport == NULL) {
+        ESP_LOGW(TAG, "[MQTT] TLS resumption transport unavailable - using default SSL transport");
+    }
+
+    esp_mqtt_client_config_t mqtt_config;
+    build_mqtt_client_config(&mqtt_config, config);
+
+    mqtt_client = esp_mqtt_client_init(&mqtt_config);
+    if (mqtt_client == NULL) {
+        ESP_LOGE(TAG, "Failed to initialize MQTT client");
+        if (mqtt_transport != NULL) {
+            esp_transport_destroy(mqtt_transport);
+            mqtt_transport = NULL;
+        }
+        return ESP_FAIL;
+    }
+
+    ESP_ERROR_CHECK(esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL));
+
+    return esp_mqtt_client_start(mqtt_client);
+}
+
+static void destroy_mqtt_client(void) {
+    if (mqtt_client == NULL) {
+        return;
+    }
+    esp_mqtt_client_stop(mqtt_client);
+    mqtt_outbox_spill_all();  // Unacknowledged telemetry goes to SD, not lost
+    esp_mqtt_client_destroy(mqtt_client);  // Also destroys mqtt_transport
+    mqtt_client = NULL;
+    mqtt_transport = NULL;
+    mqtt_connected = false;
+    gateway_status_update_azure();
+}
+
+// Refresh SAS token and reconnect MQTT client.
+// Fast path keeps the running client: only the password is swapped and the
+// connection re-established, so the esp-mqtt outbox survives and the TLS
+// transport resumes its cached session instead of a full handshake. The client
+// is only rebuilt if it does not exist or cannot take the new configuration.
 static esp_err_t refresh_sas_token_and_reconnect(void) {
     ESP_LOGI(TAG, "[SAS] 🔄 Refreshing SAS token...");
 
-    // Generate new SAS token (valid for 1 hour)
-    if (generate_sas_token(sas_token, sizeof(sas_token), 3600) != 0) {
+    if (generate_sas_token(sas_token, sizeof(sas_token), SAS_TOKEN_VALIDITY_SEC) != 0) {
         ESP_LOGE(TAG, "[SAS] ❌ Failed to generate new SAS token");
         return ESP_FAIL;
     }
 
     ESP_LOGI(TAG, "[SAS] ✅ New SAS token generated");
 
-    // Stop existing MQTT client
-    if (mqtt_client != NULL) {
-        ESP_LOGI(TAG, "[SAS] Stopping existing MQTT client...");
-        esp_mqtt_client_stop(mqtt_client);
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        esp_mqtt_client_destroy(mqtt_client);
-        mqtt_client = NULL;
-        mqtt_connected = false;
-    }
+    system_config_t* config = get_system_config();
 
-    // Reinitialize MQTT client with new token
-    ESP_LOGI(TAG, "[SAS] Reinitializing MQTT client with new token...");
+    if (mqtt_client != NULL) {
+        ESP_LOGI(TAG, "[SAS] Fast reconnect - reusing MQTT client and TLS session...");
+        mqtt_planned_reconnect = true;
 
-    system_config_t* config = get_system_config();
+        if (mqtt_connected) {
+            esp_mqtt_client_disconnect(mqtt_client);
+            for (int i = 0; i < 30 && mqtt_connected; i++) {
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+        }
 
-    // Recreate MQTT username (same format as initialize_mqtt_client)
-    snprintf(mqtt_username, sizeof(mqtt_username), "%s/%s/?api-version=2018-06-30",
-             IOT_CONFIG_IOTHUB_FQDN, config->azure_device_id);
+        esp_mqtt_client_config_t mqtt_config;
+        build_mqtt_client_config(&mqtt_config, config);
+        esp_err_t set_result = esp_mqtt_set_config(mqtt_client, &mqtt_config);
+        if (set_result == ESP_OK) {
+            // Skip the reconnect back-off; if the client is not waiting to reconnect
+            // it picks up the new token on its next automatic attempt
+            esp_mqtt_client_reconnect(mqtt_client);
 
-    esp_mqtt_client_config_t mqtt_config = {
-        .broker.address.uri = mqtt_broker_uri,
-        .broker.address.port = 8883,
-        .credentials.client_id = config->azure_device_id,
-        .credentials.username = mqtt_username,
-        .credentials.authentication.password = sas_token,
-        .session.keepalive = 30,
-        .session.disable_clean_session = 0,
-        .session.protocol_ver = MQTT_PROTOCOL_V_3_1_1,
-        .network.disable_auto_reconnect = false,
-        .broker.verification.crt_bundle_attach = esp_crt_bundle_attach,
-    };
+            for (int i = 0; i < 15; i++) {
+                vTaskDelay(pdMS_TO_TICKS(1000));
+                if (mqtt_connected) {
+                    mqtt_tls_stats_t tls_stats;
+                    mqtt_tls_transport_get_stats(&tls_stats);
+                    ESP_LOGI(TAG, "[SAS] ✅ Reconnected with new token on same client (TLS %lu ms)",
+                             tls_stats.last_handshake_ms);
+                    mqtt_planned_reconnect = false;
+                    return ESP_OK;
+                }
+            }
+            mqtt_planned_reconnect = false;
+            ESP_LOGW(TAG, "[SAS] ⚠️ MQTT not reconnected yet - will continue trying in background");
+            return ESP_OK;  // MQTT client will auto-reconnect
+        }
 
-    mqtt_client = esp_mqtt_client_init(&mqtt_config);
-    if (mqtt_client == NULL) {
-        ESP_LOGE(TAG, "[SAS] ❌ Failed to reinitialize MQTT client");
-        return ESP_FAIL;
+        mqtt_planned_reconnect = false;
+        ESP_LOGW(TAG, "[SAS] Fast reconnect not possible (%s) - rebuilding MQTT client",
+                 esp_err_to_name(set_result));
+        destroy_mqtt_client();
+        vTaskDelay(pdMS_TO_TICKS(1000));
     }
 
-    ESP_ERROR_CHECK(esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL));
+    // Reinitialize MQTT client with new token
+    ESP_LOGI(TAG, "[SAS] Reinitializing MQTT client with new token...");
 
-    esp_err_t start_result = esp_mqtt_client_start(mqtt_client);
+    esp_err_t start_result = create_and_start_mqtt_client(config);
     if (start_result != ESP_OK) {
         ESP_LOGE(TAG, "[SAS] ❌ Failed to start MQTT client: %s", esp_err_to_name(start_result));
         return ESP_FAIL;
@@ -812,10 +926,7 @@ void mqtt_stop_for_ota(void) {
     ESP_LOGI(TAG, "[OTA] Stopping MQTT to free PPP for OTA download...");
 
     if (mqtt_client != NULL) {
-        esp_mqtt_client_stop(mqtt_client);
-        esp_mqtt_client_destroy(mqtt_client);
-        mqtt_client = NULL;
-        mqtt_connected = false;
+        destroy_mqtt_client();
         ESP_LOGI(TAG, "[OTA] MQTT stopped and destroyed - PPP now available for OTA");
     } else {
         ESP_LOGW(TAG, "[OTA] MQTT client was not running");
@@ -883,32 +994,42 @@ static void replay_message_callback(const pending_message_t* msg) {
     // Track this message in case we need to stop mid-send
     sd_replay_last_msg_id = msg->message_id;
 
-    // Publish with QoS 0 for replay - faster and we still have the message on SD if it fails
-    // QoS 1 was causing Azure IoT Hub to close connection due to unacknowledged messages
-    int msg_id = esp_mqtt_client_publish(mqtt_client, msg->topic, msg->payload, 0, 0, 0);
+    // Publish with QoS 1 through the outbox - the message stays on SD until its PUBACK.
+    // One replayed message in flight at a time keeps Azure IoT Hub from throttling us.
+    int msg_id;
+    if (telemetry_topic_is_cbor(msg->topic)) {
+        // CBOR batches are cached base64 encoded - publish the original binary
+        uint8_t cbor[sizeof(msg->payload)];
+        size_t cbor_len = 0;
+        if (telemetry_cache_decode(msg->payload, cbor, sizeof(cbor), &cbor_len) != ESP_OK) {
+            ESP_LOGW(TAG, "[SD] Cached CBOR message %lu is not valid base64 - removing", msg->message_id);
+            sd_card_remove_message(msg->message_id);
+            return;
+        }
+        msg_id = mqtt_outbox_publish(mqtt_client, msg->topic, cbor, cbor_len, msg->message_id);
+    } else {
+        msg_id = mqtt_outbox_publish(mqtt_client, msg->topic, msg->payload, strlen(msg->payload),
+                                     msg->message_id);
+    }
     if (msg_id == -1) {
         ESP_LOGE(TAG, "[SD] ❌ Failed to publish replayed message %lu - stopping replay", msg->message_id);
         sd_replay_should_stop = true;  // Stop on publish failure
         return;
     }
 
-    ESP_LOGI(TAG, "[SD] ✅ Successfully published replayed message %lu (MQTT msg_id: %d)",
-             msg->message_id, msg_id);
-    sd_replay_messages_sent++;
-
-    // Wait for MQTT to process the message before removing from SD
-    // This prevents losing messages if connection drops immediately after publish
-    vTaskDelay(pdMS_TO_TICKS(SD_REPLAY_WAIT_FOR_ACK_MS));
-
-    // Double-check connection is still alive after the wait
-    if (!mqtt_connected) {
-        ESP_LOGW(TAG, "[SD] MQTT disconnected after publish - NOT removing message %lu from SD",
-                 msg->message_id);
+    // Only remove from SD once IoT Hub has acknowledged the message
+    if (!mqtt_outbox_wait_acked(msg_id, SD_REPLAY_WAIT_FOR_ACK_MS)) {
+        ESP_LOGW(TAG, "[SD] No PUBACK for replayed message %lu (msg_id: %d) - keeping it on SD",
+                 msg->message_id, msg_id);
         sd_replay_should_stop = true;
         return;  // Keep message on SD for retry
     }
 
-    // Remove the message from SD card after successful publish and connection confirmed
+    ESP_LOGI(TAG, "[SD] ✅ Replayed message %lu acknowledged (MQTT msg_id: %d)",
+             msg->message_id, msg_id);
+    sd_replay_messages_sent++;
+
+    // Remove the message from SD card after its PUBACK
     esp_err_t ret = sd_card_remove_message(msg->message_id);
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "[SD] Failed to remove replayed message %lu from SD card", msg->message_id);
@@ -1051,6 +1172,24 @@ static void report_device_twin(void) {
     }
 }
 
+// Log, count the restart in NVS and reboot
+static void restart_for_recovery(void) {
+    // Log to SD before restart
+    log_heartbeat_to_sd();
+
+    // Increment restart count in NVS
+    nvs_handle_t nvs;
+    if (nvs_open("recovery", NVS_READWRITE, &nvs) == ESP_OK) {
+        system_restart_count++;
+        nvs_set_u32(nvs, "restart_cnt", system_restart_count);
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    esp_restart();
+}
+
 // Check for telemetry timeout and force restart if needed
 static void check_telemetry_timeout_recovery(void) {
     int64_t current_time = esp_timer_get_time() / 1000000;
@@ -1060,6 +1199,8 @@ static void check_telemetry_timeout_recovery(void) {
         return;
     }
 
+    // Last resort behind connectivity_task's ladder: also fires if that ladder
+    // stalls, or if the device is connected but stops publishing
     // If we've never had a successful telemetry, use system start time
     if (last_successful_telemetry_time == 0) {
         last_successful_telemetry_time = system_uptime_start;
@@ -1083,21 +1224,7 @@ static void check_telemetry_timeout_recovery(void) {
         ESP_LOGE(TAG, "[RECOVERY] No successful telemetry for %lld seconds (limit: %d)",
                  (long long)time_since_last_success, TELEMETRY_TIMEOUT_SEC);
         ESP_LOGE(TAG, "[RECOVERY] SD card not available - forcing system restart to recover...");
-
-        // Log to SD before restart
-        log_heartbeat_to_sd();
-
-        // Increment restart count in NVS
-        nvs_handle_t nvs;
-        if (nvs_open("recovery", NVS_READWRITE, &nvs) == ESP_OK) {
-            system_restart_count++;
-            nvs_set_u32(nvs, "restart_cnt", system_restart_count);
-            nvs_commit(nvs);
-            nvs_close(nvs);
-        }
-
-        vTaskDelay(pdMS_TO_TICKS(1000));
-        esp_restart();
+        restart_for_recovery();
     }
 }
 
@@ -1121,6 +1248,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             mqtt_connected = true;
             mqtt_connect_time = esp_timer_get_time() / 1000000;  // Record connection time in seconds
             mqtt_reconnect_count = 0; // Reset reconnect counter on successful connection
+            gateway_status_update_azure();
 
             // Subscribe to cloud-to-device messages after connection
             system_config_t* config = get_system_config();
@@ -1149,65 +1277,21 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         case MQTT_EVENT_DISCONNECTED:
             ESP_LOGW(TAG, "[WARN] MQTT_EVENT_DISCONNECTED");
             mqtt_connected = false;
-            mqtt_reconnect_count++;
-
-            // Check if network recovery is needed
-            {
-                system_config_t* disconnect_config = get_system_config();
-                bool need_network_recovery = false;
 
-                if (disconnect_config->network_mode == NETWORK_MODE_SIM) {
-                    // SIM mode: Check if PPP connection is down
-                    if (!a7670c_ppp_is_connected()) {
-                        ESP_LOGW(TAG, "[SIM] 📱 PPP connection lost - will trigger recovery");
-                        need_network_recovery = true;
-                    }
-                } else if (modem_reset_enabled) {
-                    // WiFi mode: Use modem reset setting
-                    need_network_recovery = true;
-                }
+            if (mqtt_planned_reconnect) {
+                // SAS token swap on the same client - the link is fine and esp-mqtt
+                // resends unacknowledged QoS 1 messages after reconnecting
+                ESP_LOGI(TAG, "[MQTT] Disconnect for token refresh - reconnecting on same client");
+                break;
+            }
 
-                // Trigger network recovery if needed and not already running
-                if (need_network_recovery && modem_reset_task_handle == NULL) {
-                    // Check cooldown to prevent rapid reset cycling
-                    time_t now = time(NULL);
-                    int64_t time_since_last_reset = now - last_modem_reset_time;
-
-                    if (last_modem_reset_time == 0 || time_since_last_reset >= MODEM_RESET_COOLDOWN_SEC) {
-                        ESP_LOGI(TAG, "[NET] Network disconnected, triggering recovery...");
-
-                        // Create modem reset task (handles both WiFi and SIM modes)
-                        BaseType_t result = xTaskCreate(
-                            modem_reset_task,
-                            "modem_reset",
-                            3072,  // Reduced from 4096 to save 1KB heap
-                            NULL,
-                            2,  // Low priority
-                            &modem_reset_task_handle
-                        );
+            mqtt_reconnect_count++;
+            gateway_status_update_azure();
 
-                        if (result != pdPASS) {
-                            ESP_LOGE(TAG, "[NET] Failed to create network recovery task");
-                            modem_reset_task_handle = NULL;
-                        } else {
-                            last_modem_reset_time = now;  // Update last reset time
-                        }
-                    } else {
-                        int64_t remaining = MODEM_RESET_COOLDOWN_SEC - time_since_last_reset;
-                        ESP_LOGW(TAG, "[NET] Modem reset cooldown active - %lld seconds remaining", (long long)remaining);
-                        ESP_LOGI(TAG, "[NET] System will cache to SD card and retry later");
-                    }
-                }
-            }
+            // Unacknowledged telemetry is spilled to SD by the telemetry task
+            mqtt_outbox_on_disconnected();
 
-            // Check if we've exceeded maximum reconnection attempts
-            if (mqtt_reconnect_count >= MAX_MQTT_RECONNECT_ATTEMPTS) {
-                ESP_LOGE(TAG, "[ERROR] Exceeded maximum MQTT reconnection attempts (%d)", MAX_MQTT_RECONNECT_ATTEMPTS);
-                if (SYSTEM_RESTART_ON_CRITICAL_ERROR) {
-                    ESP_LOGE(TAG, "[PROC] Restarting system due to persistent MQTT connection issues...");
-                    esp_restart();
-                }
-            }
+            // Reconnect, link cycling and modem reset are paced by connectivity_task
             break;
             
         case MQTT_EVENT_SUBSCRIBED:
@@ -1220,8 +1304,14 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             
         case MQTT_EVENT_PUBLISHED:
             // Note: Don't increment total_telemetry_sent here - it's done in send_telemetry()
-            // This event fires for ALL publishes including Device Twin reports
-            ESP_LOGI(TAG, "[OK] TELEMETRY PUBLISHED SUCCESSFULLY! msg_id=%d", event->msg_id);
+            // This event fires for ALL QoS 1 publishes including Device Twin reports
+            ESP_LOGI(TAG, "[OK] PUBACK received, msg_id=%d", event->msg_id);
+            mqtt_outbox_on_published(event->msg_id);
+            break;
+
+        case MQTT_EVENT_DELETED:
+            ESP_LOGW(TAG, "[WARN] MQTT outbox expired msg_id=%d", event->msg_id);
+            mqtt_outbox_on_deleted(event->msg_id);
             break;
             
         case MQTT_EVENT_DATA:
@@ -1480,10 +1570,13 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
                             else if (strcmp(cmd, "ota_update") == 0) {
                                 cJSON *url = cJSON_GetObjectItem(root, "url");
                                 cJSON *version = cJSON_GetObjectItem(root, "version");
+                                cJSON *sha256 = cJSON_GetObjectItem(root, "sha256");
 
                                 if (url && cJSON_IsString(url)) {
                                     const char *fw_url = url->valuestring;
                                     const char *fw_version = (version && cJSON_IsString(version)) ? version->valuestring : "unknown";
+                                    // Optional; lets a gateway on the same site supply the image
+                                    const char *fw_sha256 = (sha256 && cJSON_IsString(sha256)) ? sha256->valuestring : NULL;
 
                                     ESP_LOGI(TAG, "[C2D] OTA update requested: %s (v%s)", fw_url, fw_version);
 
@@ -1502,7 +1595,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
                                     }
                                     vTaskDelay(pdMS_TO_TICKS(500));
 
-                                    esp_err_t ret = ota_start_update(fw_url, fw_version);
+                                    esp_err_t ret = ota_start_update_verified(fw_url, fw_version, fw_sha256);
                                     if (ret == ESP_OK) {
                                         ESP_LOGI(TAG, "[C2D] OTA update started successfully");
                                     } else {
@@ -1560,6 +1653,9 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
                                 ESP_LOGI(TAG, "[C2D] Telemetry interval: %d sec", cfg->telemetry_interval);
                                 ESP_LOGI(TAG, "[C2D] Modbus retries: %d (delay: %d ms)", cfg->modbus_retry_count, cfg->modbus_retry_delay);
                                 ESP_LOGI(TAG, "[C2D] Batch telemetry: %s", cfg->batch_telemetry ? "enabled" : "disabled");
+                                ESP_LOGI(TAG, "[C2D] Telemetry encoding: %s", telemetry_encoding_name(cfg->telemetry_encoding));
+                                ESP_LOGI(TAG, "[C2D] Max sensors per message: %d", cfg->telemetry_max_batch);
+                                ESP_LOGI(TAG, "[C2D] Batch per sensor type: %s", cfg->telemetry_route_by_type ? "enabled" : "disabled");
                                 ESP_LOGI(TAG, "[C2D] Sensor count: %d", cfg->sensor_count);
                                 ESP_LOGI(TAG, "[C2D] Network mode: %s", cfg->network_mode == NETWORK_MODE_SIM ? "SIM" : "WiFi");
                                 // Report via Device Twin
@@ -1733,6 +1829,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         case MQTT_EVENT_ERROR:
             ESP_LOGE(TAG, "[ERROR] MQTT_EVENT_ERROR");
             mqtt_connected = false;
+            gateway_status_update_azure();
             if (event->error_handle->error_type == MQTT_ERROR_TYPE_TCP_TRANSPORT) {
                 ESP_LOGE(TAG, "TCP transport error: %d", event->error_handle->esp_transport_sock_errno);
                 ESP_LOGE(TAG, "Possible causes: Network connectivity, firewall, DNS");
@@ -1753,32 +1850,18 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
     }
 }
 
-// Function to test DNS resolution
+// Function to test DNS resolution (through the shared cache, see net_cache.h)
 static esp_err_t test_dns_resolution(const char* hostname) {
     ESP_LOGI(TAG, "[FIND] Testing DNS resolution for: %s", hostname);
-    
-    struct addrinfo hints = {0};
-    struct addrinfo *result = NULL;
-    
-    hints.ai_family = AF_INET; // IPv4
-    hints.ai_socktype = SOCK_STREAM;
-    
-    int ret = getaddrinfo(hostname, "443", &hints, &result);
-    if (ret != 0) {
-        ESP_LOGE(TAG, "[ERROR] DNS resolution failed for %s: getaddrinfo() returned %d", hostname, ret);
-        ESP_LOGE(TAG, "   Error details: %d", ret);
+
+    ip4_addr_t addr;
+    if (net_dns_resolve(hostname, &addr) != ESP_OK) {
+        ESP_LOGE(TAG, "[ERROR] DNS resolution failed for %s", hostname);
         return ESP_FAIL;
     }
-    
-    if (result) {
-        struct sockaddr_in* addr_in = (struct sockaddr_in*)result->ai_addr;
-        ESP_LOGI(TAG, "[OK] DNS resolved %s to: %s", hostname, inet_ntoa(addr_in->sin_addr));
-        freeaddrinfo(result);
-        return ESP_OK;
-    }
-    
-    ESP_LOGE(TAG, "[ERROR] DNS resolution returned no results for %s", hostname);
-    return ESP_FAIL;
+
+    ESP_LOGI(TAG, "[OK] DNS resolved %s to: " IPSTR, hostname, IP2STR(&addr));
+    return ESP_OK;
 }
 
 // Function to test basic internet connectivity via TCP socket connect
@@ -1969,8 +2052,11 @@ static int initialize_mqtt_client(void) {
     
     ESP_LOGI(TAG, "[OK] Azure IoT Hub DNS resolution successful");
     
-    // Generate SAS token (valid for 1 hour)
-    if (generate_sas_token(sas_token, sizeof(sas_token), 3600) != 0) {
+    // Reuse the current SAS token if it is not close to expiry, otherwise sign a new one
+    if (sas_token_is_reusable()) {
+        ESP_LOGI(TAG, "[SAS] Reusing current SAS token (%lld s left)",
+                 (long long)(sas_token_expiry_seconds - (time(NULL) - sas_token_generated_time)));
+    } else if (generate_sas_token(sas_token, sizeof(sas_token), SAS_TOKEN_VALIDITY_SEC) != 0) {
         ESP_LOGE(TAG, "Failed to generate SAS token");
         return -1;
     }
@@ -1980,42 +2066,18 @@ static int initialize_mqtt_client(void) {
     ESP_LOGI(TAG, "[DYNAMIC CONFIG] Device ID: %s", config->azure_device_id);
     ESP_LOGI(TAG, "[DYNAMIC CONFIG] Device Key Length: %d", strlen(config->azure_device_key));
     
-    // Create Azure IoT Hub MQTT broker URI
-    snprintf(mqtt_broker_uri, sizeof(mqtt_broker_uri), "mqtts://%s", IOT_CONFIG_IOTHUB_FQDN);
-    
-    // Create MQTT username exactly like Arduino CCL (older API version)
-    snprintf(mqtt_username, sizeof(mqtt_username), "%s/%s/?api-version=2018-06-30", 
-             IOT_CONFIG_IOTHUB_FQDN, config->azure_device_id);
-    
+    // Broker URI and username (exactly like Arduino CCL, older API version)
+    // are filled by build_mqtt_client_config()
+    esp_err_t start_result = create_and_start_mqtt_client(config);
+
     ESP_LOGI(TAG, "MQTT Broker: %s", mqtt_broker_uri);
     ESP_LOGI(TAG, "MQTT Username: %s", mqtt_username);
     ESP_LOGI(TAG, "MQTT Client ID: %s", config->azure_device_id);
     ESP_LOGI(TAG, "SAS Token: %.100s...", sas_token);
 
-    esp_mqtt_client_config_t mqtt_config = {
-        .broker.address.uri = mqtt_broker_uri,
-        .broker.address.port = 8883,
-        .credentials.client_id = config->azure_device_id,
-        .credentials.username = mqtt_username,
-        .credentials.authentication.password = sas_token,
-        .session.keepalive = 30,
-        .session.disable_clean_session = 0,
-        .session.protocol_ver = MQTT_PROTOCOL_V_3_1_1,  // Force MQTT 3.1.1 like Arduino 1.0.6
-        .network.disable_auto_reconnect = false,
-        // Use ESP-IDF certificate bundle for better compatibility with PPP mode
-        // The bundle includes all major root CAs and handles certificate chains properly
-        .broker.verification.crt_bundle_attach = esp_crt_bundle_attach,
-    };
-
-    mqtt_client = esp_mqtt_client_init(&mqtt_config);
     if (mqtt_client == NULL) {
-        ESP_LOGE(TAG, "Failed to initialize MQTT client");
         return -1;
     }
-
-    ESP_ERROR_CHECK(esp_mqtt_client_register_event(mqtt_client, ESP_EVENT_ANY_ID, mqtt_event_handler, NULL));
-
-    esp_err_t start_result = esp_mqtt_client_start(mqtt_client);
     if (start_result != ESP_OK) {
         ESP_LOGE(TAG, "Could not start MQTT client: %s", esp_err_to_name(start_result));
         ESP_LOGE(TAG, "[TOOLS] MQTT CLIENT START TROUBLESHOOTING:");
@@ -2041,7 +2103,180 @@ static int initialize_mqtt_client(void) {
     return 0;
 }
 
+// Publish a telemetry payload in its wire form: the CBOR batch when one was built
+// for this message (telemetry_cbor_len > 0), otherwise the JSON text. The topic
+// carries matching $.ct/$.ce system properties plus the routing properties.
+// Goes through the QoS 1 outbox: returns -1 when the in-flight window or memory
+// budget is full, in which case the caller caches the payload to SD.
+static int publish_telemetry_payload(const char* json_payload, const telemetry_msg_props_t* props) {
+    system_config_t* config = get_system_config();
+
+    if (telemetry_cbor_len > 0) {
+        telemetry_build_topic(telemetry_topic, sizeof(telemetry_topic), config->azure_device_id,
+                              TELEMETRY_ENCODING_CBOR, props);
+        return mqtt_outbox_publish(mqtt_client, telemetry_topic, telemetry_cbor, telemetry_cbor_len,
+                                   MQTT_OUTBOX_ORIGIN_LIVE);
+    }
+
+    telemetry_build_topic(telemetry_topic, sizeof(telemetry_topic), config->azure_device_id,
+                          TELEMETRY_ENCODING_JSON, props);
+    return mqtt_outbox_publish(mqtt_client, telemetry_topic, json_payload, strlen(json_payload),
+                               MQTT_OUTBOX_ORIGIN_LIVE);
+}
+
+// Cache a payload to SD in its wire form, under the same topic (and routing
+// properties) it would have been published with. Cache lines are text, so CBOR
+// batches are stored base64 encoded and decoded again by replay_message_callback().
+static esp_err_t cache_telemetry_to_sd(const char* json_payload, const char* timestamp,
+                                       const telemetry_msg_props_t* props) {
+    system_config_t* config = get_system_config();
+
+    if (telemetry_cbor_len > 0) {
+        static char cbor_b64[SD_CARD_PAYLOAD_MAX];
+        if (telemetry_cache_encode(telemetry_cbor, telemetry_cbor_len, cbor_b64, sizeof(cbor_b64)) == ESP_OK) {
+            telemetry_build_topic(telemetry_topic, sizeof(telemetry_topic), config->azure_device_id,
+                                  TELEMETRY_ENCODING_CBOR, props);
+            return sd_card_save_message(telemetry_topic, cbor_b64, timestamp);
+        }
+        ESP_LOGW(TAG, "[SD] CBOR batch of %d bytes exceeds the %d-byte cache line limit - caching JSON (%d bytes) instead",
+                 (int)telemetry_cbor_len, TELEMETRY_CACHE_CBOR_MAX, (int)strlen(json_payload));
+    }
+
+    telemetry_build_topic(telemetry_topic, sizeof(telemetry_topic), config->azure_device_id,
+                          TELEMETRY_ENCODING_JSON, props);
+    return sd_card_save_message(telemetry_topic, json_payload, timestamp);
+}
+
+// Publish one telemetry message, or cache it to SD when MQTT is down or the
+// outbox stays full. Updates sensors_already_published / sensors_cached_to_sd.
+static void publish_or_cache_telemetry(const char* json_payload, const telemetry_msg_props_t* props,
+                                       int sensor_count) {
+    system_config_t* config = get_system_config();
+
+    if (mqtt_connected && mqtt_client != NULL) {
+        // Give in-flight PUBACKs a moment to free the outbox window
+        size_t wire_len = telemetry_cbor_len > 0 ? telemetry_cbor_len : strlen(json_payload);
+        for (int w = 0; w < 20 && !mqtt_outbox_has_space(wire_len); w++) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+
+        int msg_id = publish_telemetry_payload(json_payload, props);
+        if (msg_id >= 0) {
+            DLOGI(TAG, "[MQTT] Sent %s part %u/%u: %d sensor(s), %d bytes (msg_id=%d)",
+                 props->type ? props->type : "mixed", props->part, props->parts, sensor_count,
+                 telemetry_cbor_len > 0 ? (int)telemetry_cbor_len : (int)strlen(json_payload), msg_id);
+            sensors_already_published += sensor_count;
+            return;
+        }
+        ESP_LOGW(TAG, "[WARN] Failed to publish %s part %u/%u (outbox full or client error)",
+                 props->type ? props->type : "mixed", props->part, props->parts);
+    }
+
+    if (config->sd_config.enabled && config->sd_config.cache_on_failure) {
+        time_t now = time(NULL);
+        struct tm timeinfo;
+        gmtime_r(&now, &timeinfo);
+        char timestamp[32];
+        strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
+
+        if (cache_telemetry_to_sd(json_payload, timestamp, props) == ESP_OK) {
+            sensors_cached_to_sd += sensor_count;
+        } else {
+            ESP_LOGE(TAG, "[SD] Failed to cache %s part %u/%u - data lost!",
+                     props->type ? props->type : "mixed", props->part, props->parts);
+        }
+    }
+}
+
+static sensor_config_t* find_sensor_config(system_config_t* config, const char* unit_id) {
+    for (int j = 0; j < config->sensor_count; j++) {
+        if (strcmp(config->sensors[j].unit_id, unit_id) == 0) {
+            return &config->sensors[j];
+        }
+    }
+    return NULL;
+}
+
+// Keep valid readings of enabled sensors, compacted to the front in read order.
+// With by_type they are also grouped by sensor type, in order of first
+// appearance, so every batch message can carry a single "type" property.
+// Reorders readings in place (CBOR batches are encoded from contiguous slices).
+static int select_batch_readings(system_config_t* config, sensor_reading_t* readings, int count,
+                                 bool by_type) {
+    json_template_type_t kept_type[10];
+    sensor_reading_t held;
+    int kept = 0;
+
+    for (int i = 0; i < count && kept < 10; i++) {
+        if (!readings[i].valid) {
+            continue;
+        }
+        sensor_config_t* sensor = find_sensor_config(config, readings[i].unit_id);
+        if (!sensor || !sensor->enabled) {
+            ESP_LOGW(TAG, "[WARN] Sensor %s not found or disabled", readings[i].unit_id);
+            continue;
+        }
+        telemetry_sensor_class_t sensor_class;
+        telemetry_classify_sensor(sensor->sensor_type, &sensor_class);
+
+        // Insert after the last kept reading of the same type (stable)
+        int pos = kept;
+        for (int k = kept - 1; by_type && k >= 0; k--) {
+            if (kept_type[k] == sensor_class.type) {
+                pos = k + 1;
+                break;
+            }
+        }
+        held = readings[i];
+        memmove(&readings[pos + 1], &readings[pos], (kept - pos) * sizeof(sensor_reading_t));
+        memmove(&kept_type[pos + 1], &kept_type[pos], (kept - pos) * sizeof(kept_type[0]));
+        readings[pos] = held;
+        kept_type[pos] = sensor_class.type;
+        kept++;
+    }
+    return kept;
+}
+
+// One sensor object of a batch message; returns the snprintf length
+static int format_batch_sensor_json(char* out, size_t out_size, const sensor_config_t* sensor,
+                                    const sensor_reading_t* reading, const char* timestamp) {
+    telemetry_sensor_class_t sensor_class;
+    telemetry_classify_sensor(sensor->sensor_type, &sensor_class);
+
+    if (sensor_class.type != JSON_TYPE_QUALITY) {
+        // Regular sensor with value field
+        return snprintf(out, out_size,
+            "{\"%s\":%.3f,\"type\":\"%s\",\"created_on\":\"%s\",\"unit_id\":\"%s\"}",
+            sensor_class.value_key, reading->value, sensor_class.type_name, timestamp, sensor->unit_id);
+    }
+
+    // QUALITY sensor with params_data object
+    const quality_params_t* q = &reading->quality_params;
+    char params_data[256] = "";
+    struct { bool valid; const char* name; double value; } params[] = {
+        { q->ph_valid, "pH", q->ph_value },
+        { q->tds_valid, "TDS", q->tds_value },
+        { q->temp_valid, "Temp", q->temp_value },
+        { q->humidity_valid, "HUMIDITY", q->humidity_value },
+        { q->tss_valid, "TSS", q->tss_value },
+        { q->bod_valid, "BOD", q->bod_value },
+        { q->cod_valid, "COD", q->cod_value },
+        { q->hardness_valid, "Hardness", q->hardness_value },
+    };
+    for (size_t p = 0; p < sizeof(params) / sizeof(params[0]); p++) {
+        if (params[p].valid) {
+            size_t used = strlen(params_data);
+            snprintf(params_data + used, sizeof(params_data) - used, "%s\"%s\":\"%.2f\"",
+                     used > 0 ? "," : "", params[p].name, params[p].value);
+        }
+    }
+
+    return snprintf(out, out_size, "{\"unit_id\":\"%s\",\"params_data\":{%s},\"created_on\":\"%s\"}",
+                    sensor->unit_id, params_data, timestamp);
+}
+
 static void create_telemetry_payload(char* payload, size_t payload_size) {
+    int64_t cycle_start = perf_start();
     system_config_t *config = get_system_config();
 
     // Get network statistics for telemetry
@@ -2066,12 +2301,19 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
                 }
             }
         } else {
-            // SIM mode - use stored signal strength (cannot use AT commands in PPP mode)
+            // SIM mode - stored signal strength, re-read live over CMUX when it gets old
             signal_strength_t signal;
             if (a7670c_get_stored_signal_strength(&signal) == ESP_OK) {
                 net_stats.signal_strength = signal.rssi_dbm;
                 strncpy(net_stats.network_type, "4G", sizeof(net_stats.network_type));
 
+                // Serving system from AT+CPSI? (only answered while multiplexed)
+                modem_net_info_t net_info;
+                if (a7670c_get_network_info(&net_info) == ESP_OK && net_info.system_mode[0] != '\0') {
+                    strncpy(net_stats.network_type, net_info.system_mode, sizeof(net_stats.network_type) - 1);
+                    net_stats.network_type[sizeof(net_stats.network_type) - 1] = '\0';
+                }
+
                 // Use quality from stored signal data
                 if (signal.quality != NULL) {
                     strncpy(net_stats.network_quality, signal.quality, sizeof(net_stats.network_quality) - 1);
@@ -2089,7 +2331,7 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
                 }
             }
         }
-        ESP_LOGI(TAG, "[NET] Signal: %d dBm, Type: %s", net_stats.signal_strength, net_stats.network_type);
+        DLOGI(TAG, "[NET] Signal: %d dBm, Type: %s", net_stats.signal_strength, net_stats.network_type);
     } else {
         // Default values when offline
         net_stats.signal_strength = 0;
@@ -2098,8 +2340,10 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
 
     // Use pre-allocated static buffers to prevent heap fragmentation
     // (malloc/free pattern was causing memory exhaustion when web server is active)
-    // Reset the published sensors counter
+    // Reset the published / cached sensor counters
     sensors_already_published = 0;
+    sensors_cached_to_sd = 0;
+    telemetry_cbor_len = 0;
 
     sensor_reading_t* readings = telemetry_readings;
     char* temp_json = telemetry_temp_json;
@@ -2110,7 +2354,7 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
     esp_err_t ret = sensor_read_all_configured(readings, 10, &actual_count);  // Max 10 sensors
     
     if (ret == ESP_OK && actual_count > 0) {
-        ESP_LOGI(TAG, "[FLOW] Creating merged JSON for %d sensors", actual_count);
+        DLOGI(TAG, "[FLOW] Creating merged JSON for %d sensors", actual_count);
         
         // Log sensor data for debugging
         for (int i = 0; i < actual_count; i++) {
@@ -2121,12 +2365,16 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
         int payload_pos = 0;
         int valid_sensors = 0;
 
-        // Check if batch mode is enabled (send all sensors in single JSON)
-        // Single sensor: send without body array
-        // Multiple sensors: send with body array
-        if (config->batch_telemetry) {
-            ESP_LOGI(TAG, "[BATCH] Building single MQTT message for %d sensors", actual_count);
+        // Every message of this cycle shares one "seq" routing property
+        telemetry_cycle_seq++;
+        if (telemetry_cycle_seq == 0) {
+            telemetry_cycle_seq = 1;  // 0 means "no seq" to telemetry_build_topic()
+        }
 
+        // Check if batch mode is enabled (sensors grouped into as few messages as possible)
+        // Single sensor in a message: send without body array
+        // Multiple sensors in a message: send with body array
+        if (config->batch_telemetry) {
             // Get current timestamp for all sensors
             time_t now;
             struct tm timeinfo;
@@ -2135,208 +2383,126 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
             gmtime_r(&now, &timeinfo);
             strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
 
-            // Use static buffer to avoid heap fragmentation (was malloc(4096))
-            char *batch_payload = telemetry_payload;  // Reuse static buffer (2560 bytes for 10 sensors)
-
-            // Count valid sensors first to determine format
-            int valid_count = 0;
-            for (int i = 0; i < actual_count; i++) {
-                if (readings[i].valid) {
-                    valid_count++;
+            char *batch_payload = telemetry_payload;  // Reuse static buffer (one part at a time)
+
+            // At most telemetry_max_batch sensors and TELEMETRY_MAX_MESSAGE_BYTES of
+            // JSON per message (so every part also fits an SD cache line); sensor
+            // types are only kept apart when per-type routing is configured
+            bool by_type = config->telemetry_route_by_type;
+            int batch_count = select_batch_readings(config, readings, actual_count, by_type);
+            int max_batch = (config->telemetry_max_batch >= 1 && config->telemetry_max_batch <= 10)
+                            ? config->telemetry_max_batch : TELEMETRY_DEFAULT_MAX_BATCH;
+
+            // Pass 1: part boundaries
+            uint8_t part_start[10];
+            int part_count = 0;
+            int part_bytes = 0;
+            int part_sensors = 0;
+            json_template_type_t part_type = JSON_TYPE_UNKNOWN;
+            for (int i = 0; i < batch_count; i++) {
+                sensor_config_t* sensor = find_sensor_config(config, readings[i].unit_id);
+                telemetry_sensor_class_t sensor_class;
+                telemetry_classify_sensor(sensor->sensor_type, &sensor_class);
+                int obj_len = format_batch_sensor_json(temp_json, MAX_JSON_PAYLOAD_SIZE, sensor,
+                                                       &readings[i], timestamp);
+
+                bool new_part = (part_sensors == 0) || (by_type && sensor_class.type != part_type) ||
+                                part_sensors >= max_batch ||
+                                part_bytes + 1 + obj_len > TELEMETRY_MAX_MESSAGE_BYTES;
+                if (new_part) {
+                    part_start[part_count++] = i;
+                    part_bytes = 2;  // "[" + "]"
+                    part_sensors = 0;
+                    part_type = sensor_class.type;
                 }
+                part_bytes += obj_len + (part_sensors > 0 ? 1 : 0);
+                part_sensors++;
             }
 
-            // Start the JSON - use body array only for multiple sensors
-            int batch_pos = 0;
-            bool use_body_array = (valid_count > 1);
-            if (use_body_array) {
-                batch_pos = snprintf(batch_payload, sizeof(telemetry_payload), "[");
-                ESP_LOGI(TAG, "[BATCH] Multiple sensors (%d) - using body array format", valid_count);
-            } else {
-                ESP_LOGI(TAG, "[BATCH] Single sensor - using flat format (no body array)");
-            }
-
-            // Build array of sensor objects
-            for (int i = 0; i < actual_count; i++) {
-                if (readings[i].valid) {
-                    // Find the matching sensor config by unit_id
-                    sensor_config_t* matching_sensor = NULL;
-                    for (int j = 0; j < config->sensor_count; j++) {
-                        if (strcmp(config->sensors[j].unit_id, readings[i].unit_id) == 0) {
-                            matching_sensor = &config->sensors[j];
-                            break;
-                        }
-                    }
+            DLOGI(TAG, "[BATCH] %d sensors -> %d message(s) (max %d sensors / %d bytes each), seq=%lu",
+                 batch_count, part_count, max_batch, TELEMETRY_MAX_MESSAGE_BYTES, telemetry_cycle_seq);
 
-                    if (!matching_sensor || !matching_sensor->enabled) {
-                        ESP_LOGW(TAG, "[WARN] Sensor %s not found or disabled", readings[i].unit_id);
-                        continue;
-                    }
+            // Pass 2: build, then publish or cache each part
+            for (int p = 0; p < part_count; p++) {
+                int start = part_start[p];
+                int end = (p + 1 < part_count) ? part_start[p + 1] : batch_count;
+                int count = end - start;
+                bool use_body_array = (count > 1);
 
-                    // Add comma separator if not first sensor (only for body array)
-                    if (valid_sensors > 0 && use_body_array) {
+                int64_t build_start = perf_start();
+                int batch_pos = 0;
+                if (use_body_array) {
+                    batch_pos = snprintf(batch_payload, sizeof(telemetry_payload), "[");
+                }
+                for (int i = start; i < end; i++) {
+                    sensor_config_t* sensor = find_sensor_config(config, readings[i].unit_id);
+                    if (i > start) {
                         batch_pos += snprintf(batch_payload + batch_pos, sizeof(telemetry_payload) - batch_pos, ",");
                     }
+                    batch_pos += format_batch_sensor_json(batch_payload + batch_pos,
+                                                          sizeof(telemetry_payload) - batch_pos,
+                                                          sensor, &readings[i], timestamp);
+                }
+                if (use_body_array) {
+                    batch_pos += snprintf(batch_payload + batch_pos, sizeof(telemetry_payload) - batch_pos, "]");
+                }
 
-                    // Determine value key and type based on sensor type
-                    const char* value_key = "value";
-                    const char* type_value = "SENSOR";
-                    if (strcasecmp(matching_sensor->sensor_type, "Level") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Radar Level") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Panda_Level") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Hydrostatic_Level") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Piezometer") == 0) {
-                        value_key = "level_filled";
-                        type_value = "LEVEL";
-                    } else if (strcasecmp(matching_sensor->sensor_type, "Flow-Meter") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "ZEST") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Panda_EMF") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Panda_USM") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Dailian") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Dailian_EMF") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Clampon") == 0) {
-                        value_key = "consumption";
-                        type_value = "FLOW";
-                    } else if (strcasecmp(matching_sensor->sensor_type, "RAINGAUGE") == 0) {
-                        value_key = "raingauge";
-                        type_value = "RAINGAUGE";
-                    } else if (strcasecmp(matching_sensor->sensor_type, "BOREWELL") == 0) {
-                        value_key = "borewell";
-                        type_value = "BOREWELL";
-                    } else if (strcasecmp(matching_sensor->sensor_type, "ENERGY") == 0) {
-                        value_key = "ene_con_hex";
-                        type_value = "ENERGY";
-                    } else if (strcasecmp(matching_sensor->sensor_type, "QUALITY") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Aquadax_Quality") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Opruss_Ace") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Aster") == 0 ||
-                               strcasecmp(matching_sensor->sensor_type, "Hardness_Sensor") == 0) {
-                        value_key = "value";
-                        type_value = "QUALITY";
-                    }
-
-                    // Build sensor JSON object
-                    if (strcasecmp(matching_sensor->sensor_type, "QUALITY") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Aquadax_Quality") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Opruss_Ace") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Aster") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Hardness_Sensor") == 0) {
-                        // QUALITY sensor with params_data object
-                        char params_data[256] = "";
-
-                        if (readings[i].quality_params.ph_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"pH\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.ph_value);
-                        }
-                        if (readings[i].quality_params.tds_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"TDS\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.tds_value);
-                        }
-                        if (readings[i].quality_params.temp_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"Temp\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.temp_value);
-                        }
-                        if (readings[i].quality_params.humidity_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"HUMIDITY\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.humidity_value);
-                        }
-                        if (readings[i].quality_params.tss_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"TSS\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.tss_value);
-                        }
-                        if (readings[i].quality_params.bod_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"BOD\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.bod_value);
-                        }
-                        if (readings[i].quality_params.cod_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"COD\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.cod_value);
-                        }
-                        if (readings[i].quality_params.hardness_valid) {
-                            snprintf(params_data + strlen(params_data),
-                                sizeof(params_data) - strlen(params_data),
-                                "%s\"Hardness\":\"%.2f\"", strlen(params_data) > 0 ? "," : "", readings[i].quality_params.hardness_value);
-                        }
-
-                        batch_pos += snprintf(batch_payload + batch_pos, sizeof(telemetry_payload) - batch_pos,
-                            "{\"unit_id\":\"%s\",\"params_data\":{%s},\"created_on\":\"%s\"}",
-                            matching_sensor->unit_id, params_data, timestamp);
-                    } else {
-                        // Regular sensor with value field
-                        batch_pos += snprintf(batch_payload + batch_pos, sizeof(telemetry_payload) - batch_pos,
-                            "{\"%s\":%.3f,\"type\":\"%s\",\"created_on\":\"%s\",\"unit_id\":\"%s\"}",
-                            value_key, readings[i].value, type_value, timestamp, matching_sensor->unit_id);
-                    }
-
-                    valid_sensors++;
-                    ESP_LOGI(TAG, "[BATCH] Added sensor %s to batch", matching_sensor->unit_id);
+                // Compact form of the same part for cellular links (also what gets cached to SD)
+                telemetry_cbor_len = 0;
+                if (config->telemetry_encoding == TELEMETRY_ENCODING_CBOR &&
+                    telemetry_cbor_encode_batch(config, &readings[start], count, now,
+                                                telemetry_cbor, sizeof(telemetry_cbor),
+                                                &telemetry_cbor_len) != ESP_OK) {
+                    ESP_LOGW(TAG, "[CBOR] Encoding failed - falling back to JSON for this part");
+                    telemetry_cbor_len = 0;
                 }
-            }
 
-            // Close the JSON array for multiple sensors
-            if (use_body_array) {
-                batch_pos += snprintf(batch_payload + batch_pos, sizeof(telemetry_payload) - batch_pos, "]");
+                // "type" only when every reading in the part has it (mixed parts omit it)
+                sensor_config_t* first = find_sensor_config(config, readings[start].unit_id);
+                telemetry_sensor_class_t part_class;
+                telemetry_classify_sensor(first->sensor_type, &part_class);
+                bool single_type = true;
+                for (int i = start + 1; i < end && single_type; i++) {
+                    telemetry_sensor_class_t other;
+                    telemetry_classify_sensor(find_sensor_config(config, readings[i].unit_id)->sensor_type, &other);
+                    single_type = (strcmp(other.type_name, part_class.type_name) == 0);
+                }
+                telemetry_msg_props_t props = {
+                    .type = single_type ? part_class.type_name : NULL,
+                    .unit_id = (count == 1) ? first->unit_id : NULL,
+                    .seq = telemetry_cycle_seq,
+                    .part = p + 1,
+                    .parts = part_count,
+                };
+                perf_end(PERF_PAYLOAD_BUILD, build_start);
+                publish_or_cache_telemetry(batch_payload, &props, count);
+                valid_sensors += count;
             }
 
-            // ALWAYS copy payload to output buffer (critical for SD card caching when offline)
-            // This fixes bug where stale payload was cached due to copy being inside mqtt_connected block
-            // Note: Only copy if buffers are different (batch_payload now points to telemetry_payload)
+            // payload (== telemetry_payload) now holds the last part for history / logs
             if (valid_sensors > 0 && payload != batch_payload) {
                 strncpy(payload, batch_payload, payload_size - 1);
                 payload[payload_size - 1] = '\0';
             }
 
-            // Send single MQTT message with all sensors (only if connected)
-            if (mqtt_connected && mqtt_client != NULL && valid_sensors > 0) {
-                char sensor_topic[256];
-                snprintf(sensor_topic, sizeof(sensor_topic),
-                         "devices/%s/messages/events/", config->azure_device_id);
-
-                int msg_id = esp_mqtt_client_publish(
-                    mqtt_client,
-                    sensor_topic,
-                    batch_payload,
-                    strlen(batch_payload),
-                    0,  // QoS 0
-                    0   // No retain
-                );
-
-                if (msg_id >= 0) {
-                    ESP_LOGI(TAG, "[MQTT] Sent batch message with %d sensors (msg_id=%d, size=%d bytes)",
-                             valid_sensors, msg_id, strlen(batch_payload));
-                    ESP_LOGI(TAG, "[MQTT] Payload: %s", batch_payload);
-                } else {
-                    ESP_LOGW(TAG, "[WARN] Failed to publish batch message");
-                }
-            }
-
-            // Note: No free() needed - using static telemetry_payload buffer
-            if (use_body_array) {
-                ESP_LOGI(TAG, "[OK] Sent %d sensors in single batch message with body array", valid_sensors);
-            } else {
-                ESP_LOGI(TAG, "[OK] Sent single sensor message (no body array)", valid_sensors);
-            }
+            DLOGI(TAG, "[OK] Batch cycle: %d sensors in %d message(s) - %d published, %d cached to SD",
+                 valid_sensors, part_count, sensors_already_published, sensors_cached_to_sd);
         } else {
             // Individual mode: send each sensor as separate MQTT message (original behavior)
-            ESP_LOGI(TAG, "[INDIVIDUAL] Sending sensors as separate messages");
+            DLOGI(TAG, "[INDIVIDUAL] Sending sensors as separate messages");
+
+            int message_count = 0;
+            for (int i = 0; i < actual_count; i++) {
+                sensor_config_t* sensor = readings[i].valid ? find_sensor_config(config, readings[i].unit_id) : NULL;
+                if (sensor && sensor->enabled) {
+                    message_count++;
+                }
+            }
 
             for (int i = 0; i < actual_count; i++) {
                 if (readings[i].valid) {
                     // Find the matching sensor config by unit_id
-                    sensor_config_t* matching_sensor = NULL;
-                    for (int j = 0; j < config->sensor_count; j++) {
-                        if (strcmp(config->sensors[j].unit_id, readings[i].unit_id) == 0) {
-                            matching_sensor = &config->sensors[j];
-                            break;
-                        }
-                    }
+                    sensor_config_t* matching_sensor = find_sensor_config(config, readings[i].unit_id);
 
                     if (!matching_sensor || !matching_sensor->enabled) {
                         ESP_LOGW(TAG, "[WARN] Sensor %s not found or disabled", readings[i].unit_id);
@@ -2348,14 +2514,13 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
                              matching_sensor->sensor_type, readings[i].value);
 
                     // Generate JSON for this specific sensor using template system
+                    int64_t build_start = perf_start();
                     esp_err_t json_result;
 
                     // Check if sensor is QUALITY type - use special JSON format
-                    if (strcasecmp(matching_sensor->sensor_type, "QUALITY") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Aquadax_Quality") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Opruss_Ace") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Aster") == 0 ||
-                        strcasecmp(matching_sensor->sensor_type, "Hardness_Sensor") == 0) {
+                    telemetry_sensor_class_t sensor_class;
+                    telemetry_classify_sensor(matching_sensor->sensor_type, &sensor_class);
+                    if (sensor_class.type == JSON_TYPE_QUALITY) {
                         json_result = generate_quality_sensor_json(
                             &readings[i],
                             temp_json,
@@ -2386,28 +2551,28 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
                     }
 
                     if (json_result == ESP_OK) {
-                        if (mqtt_connected && mqtt_client != NULL) {
-                            char sensor_topic[256];
-                            snprintf(sensor_topic, sizeof(sensor_topic),
-                                     "devices/%s/messages/events/", config->azure_device_id);
-
-                            int msg_id = esp_mqtt_client_publish(
-                                mqtt_client,
-                                sensor_topic,
-                                temp_json,
-                                strlen(temp_json),
-                                0,  // QoS 0
-                                0   // No retain
-                            );
-
-                            if (msg_id >= 0) {
-                                ESP_LOGI(TAG, "[MQTT] Sent sensor %d/%d: %s (msg_id=%d)",
-                                         valid_sensors + 1, actual_count, matching_sensor->unit_id, msg_id);
-                                valid_sensors++;
-                                vTaskDelay(pdMS_TO_TICKS(100));
-                            } else {
-                                ESP_LOGW(TAG, "[WARN] Failed to publish sensor %s", matching_sensor->unit_id);
-                            }
+                        // CBOR mode: one single-sensor batch per message
+                        telemetry_cbor_len = 0;
+                        if (config->telemetry_encoding == TELEMETRY_ENCODING_CBOR &&
+                            telemetry_cbor_encode_batch(config, &readings[i], 1, time(NULL),
+                                                        telemetry_cbor, sizeof(telemetry_cbor),
+                                                        &telemetry_cbor_len) != ESP_OK) {
+                            ESP_LOGW(TAG, "[CBOR] Encoding failed for %s - sending JSON", matching_sensor->unit_id);
+                            telemetry_cbor_len = 0;
+                        }
+
+                        perf_end(PERF_PAYLOAD_BUILD, build_start);
+                        valid_sensors++;
+                        telemetry_msg_props_t props = {
+                            .type = sensor_class.type_name,
+                            .unit_id = matching_sensor->unit_id,
+                            .seq = telemetry_cycle_seq,
+                            .part = valid_sensors,
+                            .parts = message_count,
+                        };
+                        publish_or_cache_telemetry(temp_json, &props, 1);
+                        if (mqtt_connected) {
+                            vTaskDelay(pdMS_TO_TICKS(100));
                         }
 
                         // Store last sensor's JSON in payload
@@ -2421,15 +2586,19 @@ static void create_telemetry_payload(char* payload, size_t payload_size) {
                 }
             }
 
-            ESP_LOGI(TAG, "[OK] Sent individual telemetry for %d/%d sensors", valid_sensors, actual_count);
+            DLOGI(TAG, "[OK] Individual telemetry for %d/%d sensors - %d published, %d cached to SD",
+                 valid_sensors, actual_count, sensors_already_published, sensors_cached_to_sd);
         }
 
-        sensors_already_published = valid_sensors;  // Track how many were already sent via MQTT
+        if (valid_sensors == 0) {
+            payload[0] = '\0';  // Nothing valid to send
+        }
     } else {
         ESP_LOGW(TAG, "[WARN] No valid sensor data available, skipping telemetry");
         payload[0] = '\0'; // Empty payload to indicate no data
     }
     // No free() needed - using static buffers
+    perf_end(PERF_TELEMETRY_CYCLE, cycle_start);
 }
 
 __attribute__((unused)) static esp_err_t read_configured_sensors_data(void) {
@@ -2683,6 +2852,9 @@ static void perform_modem_reset(void)
             .pwr_pin = config->sim_config.pwr_pin,
             .reset_pin = config->sim_config.reset_pin,
             .baud_rate = config->sim_config.uart_baud_rate,
+            .rts_pin = config->modem_rts_pin,
+            .cts_pin = config->modem_cts_pin,
+            .ppp_baud_rate = config->modem_ppp_baud,
             .apn = config->sim_config.apn,
             .user = config->sim_config.apn_user,
             .pass = config->sim_config.apn_pass,
@@ -2750,16 +2922,101 @@ esp_err_t update_modem_gpio_pin(int new_gpio_pin)
     return reinit_modem_reset_gpio(new_gpio_pin);
 }
 
-// Modem reset task
-static void modem_reset_task(void *pvParameters)
+// Connectivity recovery task - the only place that reconnects MQTT, cycles
+// WiFi/PPP, resets the modem or reboots because of lost connectivity
+static void connectivity_task(void *pvParameters)
 {
-    ESP_LOGI(TAG, "[MODEM] Modem reset task started");
-    
-    // Perform the reset
-    perform_modem_reset();
-    
-    // Task cleanup
-    modem_reset_task_handle = NULL;
+    vTaskDelay(pdMS_TO_TICKS(400));
+
+    // Nothing to recover in setup mode - MQTT and telemetry are not running
+    if (get_config_state() == CONFIG_STATE_SETUP) {
+        ESP_LOGW(TAG, "[CONN] Setup mode active - skipping connectivity task");
+        connectivity_task_handle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+
+    conn_sm_policy_t policy;
+    conn_sm_default_policy(&policy);
+    conn_sm_init(&conn_sm, &policy, esp_random(), (uint32_t)(esp_timer_get_time() / 1000));
+    conn_state_t last_state = conn_sm.state;
+    ESP_LOGI(TAG, "[CONN] Connectivity task started (MQTT %lu-%lus, link %lu-%lus, %u%% jitter)",
+             policy.mqtt.base_ms / 1000, policy.mqtt.max_ms / 1000,
+             policy.link.base_ms / 1000, policy.link.max_ms / 1000, policy.jitter_pct);
+
+    while (!system_shutdown_requested) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+
+        // OTA owns the connection while it runs
+        if (ota_is_in_progress()) {
+            continue;
+        }
+
+        system_config_t* config = get_system_config();
+        bool sim_mode = (config->network_mode == NETWORK_MODE_SIM);
+        conn_inputs_t inputs = {
+            .link_up = is_network_connected(),
+            .mqtt_up = mqtt_connected || mqtt_planned_reconnect,
+            .modem_reset_available = sim_mode || modem_reset_enabled,
+            .reboot_allowed = !sd_card_is_available(),  // SD keeps caching - no need to reboot
+        };
+        uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        conn_action_t action = conn_sm_step(&conn_sm, &inputs, now_ms);
+
+        if (conn_sm.state != last_state) {
+            if (conn_sm.state == CONN_STATE_ONLINE && conn_sm.stats.recoveries > 0) {
+                ESP_LOGI(TAG, "[CONN] ✅ Back online after %lu s (outage #%lu)",
+                         conn_sm.stats.last_recovery_ms / 1000, conn_sm.stats.outages);
+            } else {
+                ESP_LOGW(TAG, "[CONN] %s -> %s", conn_sm_state_name(last_state),
+                         conn_sm_state_name(conn_sm.state));
+            }
+            last_state = conn_sm.state;
+        }
+
+        switch (action) {
+            case CONN_ACTION_MQTT_RECONNECT:
+                if (mqtt_client != NULL) {
+                    ESP_LOGI(TAG, "[CONN] MQTT reconnect attempt %u", conn_sm.mqtt_attempts);
+                    esp_mqtt_client_reconnect(mqtt_client);
+                }
+                break;
+
+            case CONN_ACTION_LINK_RECONNECT:
+                ESP_LOGI(TAG, "[CONN] %s reconnect attempt %u%s", sim_mode ? "PPP" : "WiFi",
+                         conn_sm.link_attempts, inputs.link_up ? " (link up but broker unreachable)" : "");
+                if (sim_mode) {
+                    if (inputs.link_up) {
+                        a7670c_ppp_disconnect();
+                    }
+                    a7670c_ppp_connect();
+                } else {
+                    if (inputs.link_up) {
+                        esp_wifi_disconnect();
+                        vTaskDelay(pdMS_TO_TICKS(1000));
+                    }
+                    wifi_trigger_reconnect();
+                }
+                break;
+
+            case CONN_ACTION_MODEM_RESET:
+                ESP_LOGW(TAG, "[CONN] 🔄 Link recovery exhausted - modem reset #%u", conn_sm.modem_resets);
+                perform_modem_reset();
+                conn_sm_action_done(&conn_sm, action, (uint32_t)(esp_timer_get_time() / 1000));
+                break;
+
+            case CONN_ACTION_REBOOT:
+                ESP_LOGE(TAG, "[CONN] Offline for %lu s after %u modem resets and no SD card - restarting",
+                         (now_ms - conn_sm.outage_start_ms) / 1000, conn_sm.modem_resets);
+                restart_for_recovery();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    connectivity_task_handle = NULL;
     vTaskDelete(NULL);
 }
 
@@ -2954,6 +3211,12 @@ static void memory_monitor_task(void *pvParameters)
         size_t free_heap = esp_get_free_heap_size();
         size_t min_free_heap = esp_get_minimum_free_heap_size();
 
+        // Publish heap, task and link health for /api/status
+        gateway_status_update_health();
+
+        // Close idle pooled connections; free them all when heap runs low
+        net_pool_sweep(free_heap < HEAP_WARNING_THRESHOLD);
+
         // Calculate heap change since last check
         int heap_change = (int)free_heap - (int)last_free_heap;
         last_free_heap = free_heap;
@@ -2982,17 +3245,10 @@ static void memory_monitor_task(void *pvParameters)
             consecutive_low_memory++;
             ESP_LOGW(TAG, "[MEMORY] 🔴 CRITICAL HEAP: %u bytes - taking action!", free_heap);
 
-            // Stop web server if running (frees ~15-20KB)
-            if (web_server_running && !web_server_stopped_for_memory) {
-                ESP_LOGW(TAG, "[MEMORY] Stopping web server to free memory...");
-                web_config_stop();
-                web_server_running = false;
-                web_server_stopped_for_memory = true;
-                vTaskDelay(pdMS_TO_TICKS(500));  // Wait for cleanup
-
-                size_t after_stop = esp_get_free_heap_size();
-                ESP_LOGI(TAG, "[MEMORY] After stopping web server: %u bytes (freed %u bytes)",
-                         after_stop, after_stop - free_heap);
+            // The portal is not stopped here: web_admission sheds or degrades
+            // requests that would not fit, so the device stays reachable
+            if (web_server_running && consecutive_low_memory == 1) {
+                ESP_LOGW(TAG, "[MEMORY] Web server kept running - admission control sheds heavy requests");
             }
         }
 
@@ -3272,6 +3528,47 @@ static void handle_device_twin_desired_properties(const char *data, int data_len
         }
     }
 
+    // Process telemetry_encoding ("json" or "cbor")
+    cJSON *encoding = cJSON_GetObjectItem(root, "telemetry_encoding");
+    if (encoding && cJSON_IsString(encoding)) {
+        telemetry_encoding_t new_encoding;
+        if (telemetry_encoding_from_name(encoding->valuestring, &new_encoding)) {
+            if (config->telemetry_encoding != new_encoding) {
+                config->telemetry_encoding = new_encoding;
+                config_changed = true;
+                ESP_LOGI(TAG, "[TWIN] telemetry_encoding updated to %s", telemetry_encoding_name(new_encoding));
+            }
+        } else {
+            ESP_LOGW(TAG, "[TWIN] Invalid telemetry_encoding: %s (must be json or cbor)", encoding->valuestring);
+        }
+    }
+
+    // Process telemetry_max_batch (sensors per batch message, 1-10)
+    cJSON *max_batch = cJSON_GetObjectItem(root, "telemetry_max_batch");
+    if (max_batch && cJSON_IsNumber(max_batch)) {
+        int new_max = max_batch->valueint;
+        if (new_max >= 1 && new_max <= 10) {
+            if (config->telemetry_max_batch != new_max) {
+                config->telemetry_max_batch = new_max;
+                config_changed = true;
+                ESP_LOGI(TAG, "[TWIN] telemetry_max_batch updated to %d", new_max);
+            }
+        } else {
+            ESP_LOGW(TAG, "[TWIN] Invalid telemetry_max_batch: %d (must be 1-10)", new_max);
+        }
+    }
+
+    // Process telemetry_route_by_type (one sensor type per batch message)
+    cJSON *route_by_type = cJSON_GetObjectItem(root, "telemetry_route_by_type");
+    if (route_by_type && cJSON_IsBool(route_by_type)) {
+        bool new_route = cJSON_IsTrue(route_by_type);
+        if (config->telemetry_route_by_type != new_route) {
+            config->telemetry_route_by_type = new_route;
+            config_changed = true;
+            ESP_LOGI(TAG, "[TWIN] telemetry_route_by_type updated to %s", new_route ? "true" : "false");
+        }
+    }
+
     // Process web_server_enabled - toggle web server remotely
     // But don't start if OTA update will be triggered (need memory for OTA)
     cJSON *web_server = cJSON_GetObjectItem(root, "web_server_enabled");
@@ -3438,7 +3735,9 @@ static void handle_device_twin_desired_properties(const char *data, int data_len
                     }
 
                     // Start OTA update (runs in background, reboots on success)
-                    esp_err_t ota_result = ota_start_update(ota_url, "remote");
+                    cJSON *ota_sha_json = cJSON_GetObjectItem(root, "ota_sha256");
+                    const char *ota_sha = cJSON_IsString(ota_sha_json) ? ota_sha_json->valuestring : NULL;
+                    esp_err_t ota_result = ota_start_update_verified(ota_url, "remote", ota_sha);
                     if (ota_result != ESP_OK) {
                         ESP_LOGE(TAG, "[TWIN] OTA update failed to start: %s", esp_err_to_name(ota_result));
                         // Report OTA failure
@@ -3793,6 +4092,9 @@ static void report_device_twin_properties(void) {
     cJSON_AddNumberToObject(reported, "modbus_retry_count", config->modbus_retry_count);
     cJSON_AddNumberToObject(reported, "modbus_retry_delay", config->modbus_retry_delay);
     cJSON_AddBoolToObject(reported, "batch_telemetry", config->batch_telemetry);
+    cJSON_AddStringToObject(reported, "telemetry_encoding", telemetry_encoding_name(config->telemetry_encoding));
+    cJSON_AddNumberToObject(reported, "telemetry_max_batch", config->telemetry_max_batch);
+    cJSON_AddBoolToObject(reported, "telemetry_route_by_type", config->telemetry_route_by_type);
     cJSON_AddNumberToObject(reported, "sensor_count", config->sensor_count);
 
     // Add firmware version and device info
@@ -4123,70 +4425,8 @@ static void telemetry_task(void *pvParameters)
 
         if (should_send_telemetry) {
             first_telemetry = false;  // Clear flag after first send
-            // Check network connection before sending telemetry
-            // If disconnected, try to reconnect before sending
-            if (!is_network_connected()) {
-                if (config->network_mode == NETWORK_MODE_WIFI) {
-                    // WiFi mode: trigger WiFi reconnection
-                    ESP_LOGI(TAG, "[WIFI] Network disconnected - attempting reconnection before telemetry...");
-                    wifi_trigger_reconnect();
-
-                    // Wait for connection to establish (max 15 seconds)
-                    for (int i = 0; i < 15; i++) {
-                        vTaskDelay(pdMS_TO_TICKS(1000));
-                        if (is_network_connected()) {
-                            ESP_LOGI(TAG, "[WIFI] ✅ WiFi reconnected successfully!");
-                            break;
-                        }
-                    }
-
-                    if (!is_network_connected()) {
-                        ESP_LOGW(TAG, "[WIFI] ⚠️ WiFi reconnection failed - will cache to SD card");
-                    }
-                } else if (config->network_mode == NETWORK_MODE_SIM) {
-                    // SIM mode: trigger PPP reconnection
-                    ESP_LOGI(TAG, "[SIM] PPP disconnected - attempting reconnection before telemetry...");
-
-                    // Try to reconnect PPP
-                    esp_err_t ppp_ret = a7670c_ppp_connect();
-                    if (ppp_ret == ESP_OK) {
-                        // Wait for PPP connection to establish (max 30 seconds)
-                        for (int i = 0; i < 30; i++) {
-                            vTaskDelay(pdMS_TO_TICKS(1000));
-                            if (is_network_connected()) {
-                                ESP_LOGI(TAG, "[SIM] ✅ PPP reconnected successfully!");
-                                break;
-                            }
-                            if (i % 10 == 9) {
-                                ESP_LOGI(TAG, "[SIM] Still waiting for PPP... (%d/30)", i + 1);
-                            }
-                        }
-                    }
-
-                    if (!is_network_connected()) {
-                        ESP_LOGW(TAG, "[SIM] ⚠️ PPP reconnection failed - will cache to SD card");
-                    }
-                }
-            }
-
-            // If network is connected, verify internet connectivity (WiFi connected but no internet scenario)
-            // Only check occasionally to avoid overhead (every 10th telemetry or when MQTT is disconnected)
-            static uint8_t internet_check_counter = 0;
-            internet_check_counter++;
-            if (is_network_connected() && !mqtt_connected && (internet_check_counter % 5 == 0)) {
-                ESP_LOGI(TAG, "[NET] Verifying internet connectivity...");
-                if (test_internet_connectivity() != ESP_OK) {
-                    ESP_LOGW(TAG, "[NET] ⚠️ WiFi connected but no internet - triggering reconnection");
-                    if (config->network_mode == NETWORK_MODE_WIFI) {
-                        // WiFi connected but no internet - disconnect and reconnect
-                        esp_wifi_disconnect();
-                        vTaskDelay(pdMS_TO_TICKS(2000));
-                        wifi_trigger_reconnect();
-                        vTaskDelay(pdMS_TO_TICKS(10000));  // Wait for reconnection
-                    }
-                }
-            }
-
+            // No inline reconnects here - connectivity_task owns recovery and
+            // send_telemetry() caches to SD while offline
             // Always call send_telemetry() - it will handle SD caching if MQTT is disconnected
             bool telemetry_success = send_telemetry();
 
@@ -4205,11 +4445,19 @@ static void telemetry_task(void *pvParameters)
                     ota_mark_valid();
                     ESP_LOGI(TAG, "[OTA] Firmware marked as valid after successful telemetry");
                     ota_marked_valid = true;
+
+                    // Continue a firmware download that a reboot cut short
+                    if (ota_resume_pending() == ESP_OK) {
+                        ESP_LOGI(TAG, "[OTA] Resuming interrupted firmware download");
+                    }
                 }
             } else {
                 ESP_LOGW(TAG, "[WARN] Telemetry not sent to MQTT (cached to SD or skipped) - next attempt in %d seconds", config->telemetry_interval);
             }
         }
+
+        // Spill telemetry that lost its connection (or never got a PUBACK) to SD
+        mqtt_outbox_service();
         
         vTaskDelay(pdMS_TO_TICKS(5000)); // Increased to 5 seconds to prevent timing edge cases
     }
@@ -4227,8 +4475,8 @@ static bool send_telemetry(void) {
     system_config_t* config = get_system_config();
 
     call_counter++;
-    ESP_LOGI(TAG, "[TRACK] send_telemetry() called #%lu, mqtt_connected=%d",
-             call_counter, mqtt_connected);
+    DLOGI(TAG, "[TRACK] send_telemetry() called #%lu, mqtt_connected=%d",
+         call_counter, mqtt_connected);
 
     // Check if a send is already in progress
     if (send_in_progress) {
@@ -4247,31 +4495,20 @@ static bool send_telemetry(void) {
 
         // If SD card is enabled and caching is enabled, cache the telemetry
         if (config->sd_config.enabled && config->sd_config.cache_on_failure) {
-            ESP_LOGI(TAG, "[SD] 💾 Caching telemetry to SD card (network unavailable)...");
+            DLOGI(TAG, "[SD] 💾 Caching telemetry to SD card (network unavailable)...");
 
-            // Generate the telemetry payload first
-            snprintf(telemetry_topic, sizeof(telemetry_topic),
-                     "devices/%s/messages/events/", config->azure_device_id);
+            // MQTT is down, so every message of the cycle goes to SD with its routing properties
             create_telemetry_payload(telemetry_payload, sizeof(telemetry_payload));
 
-            if (strlen(telemetry_payload) > 0) {
-                // Generate timestamp for SD card message
-                time_t now = time(NULL);
-                struct tm timeinfo;
-                gmtime_r(&now, &timeinfo);
-                char timestamp[32];
-                strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-
-                esp_err_t ret = sd_card_save_message(telemetry_topic, telemetry_payload, timestamp);
-                if (ret == ESP_OK) {
-                    ESP_LOGI(TAG, "[SD] ✅ Telemetry cached to SD card - will replay when network reconnects");
-                    send_in_progress = false;
-                    // Return FALSE to indicate not sent to cloud (only cached locally)
-                    // Telemetry task will retry when network comes back online
-                    return false;
-                } else {
-                    ESP_LOGE(TAG, "[SD] ❌ Failed to cache telemetry: %s", esp_err_to_name(ret));
-                }
+            if (sensors_cached_to_sd > 0) {
+                DLOGI(TAG, "[SD] ✅ %d sensor readings cached to SD card - will replay when network reconnects",
+                     sensors_cached_to_sd);
+                send_in_progress = false;
+                // Return FALSE to indicate not sent to cloud (only cached locally)
+                // Telemetry task will retry when network comes back online
+                return false;
+            } else if (strlen(telemetry_payload) > 0) {
+                ESP_LOGE(TAG, "[SD] ❌ Failed to cache telemetry");
             }
         }
 
@@ -4290,34 +4527,22 @@ static bool send_telemetry(void) {
         ESP_LOGW(TAG, "[WARN]  MQTT not connected");
 
         // Debug: Log SD configuration status
-        ESP_LOGI(TAG, "[SD] DEBUG: SD enabled=%d, cache_on_failure=%d",
-                 config->sd_config.enabled, config->sd_config.cache_on_failure);
+        DLOGI(TAG, "[SD] DEBUG: SD enabled=%d, cache_on_failure=%d",
+             config->sd_config.enabled, config->sd_config.cache_on_failure);
 
         // If SD card caching is enabled, cache the telemetry
         if (config->sd_config.enabled && config->sd_config.cache_on_failure) {
-            ESP_LOGI(TAG, "[SD] 💾 Caching telemetry to SD card (MQTT disconnected)...");
+            DLOGI(TAG, "[SD] 💾 Caching telemetry to SD card (MQTT disconnected)...");
 
-            // Generate the telemetry payload first
-            snprintf(telemetry_topic, sizeof(telemetry_topic),
-                     "devices/%s/messages/events/", config->azure_device_id);
             create_telemetry_payload(telemetry_payload, sizeof(telemetry_payload));
 
-            if (strlen(telemetry_payload) > 0) {
-                // Generate timestamp for SD card message
-                time_t now = time(NULL);
-                struct tm timeinfo;
-                gmtime_r(&now, &timeinfo);
-                char timestamp[32];
-                strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-
-                esp_err_t ret = sd_card_save_message(telemetry_topic, telemetry_payload, timestamp);
-                if (ret == ESP_OK) {
-                    ESP_LOGI(TAG, "[SD] ✅ Telemetry cached to SD card - will replay when MQTT reconnects");
-                    send_in_progress = false;
-                    return false;
-                } else {
-                    ESP_LOGE(TAG, "[SD] ❌ Failed to cache telemetry: %s", esp_err_to_name(ret));
-                }
+            if (sensors_cached_to_sd > 0) {
+                DLOGI(TAG, "[SD] ✅ %d sensor readings cached to SD card - will replay when MQTT reconnects",
+                     sensors_cached_to_sd);
+                send_in_progress = false;
+                return false;
+            } else if (strlen(telemetry_payload) > 0) {
+                ESP_LOGE(TAG, "[SD] ❌ Failed to cache telemetry");
             }
         } else {
             if (!config->sd_config.enabled) {
@@ -4332,7 +4557,7 @@ static bool send_telemetry(void) {
         return false;
     }
     
-    ESP_LOGI(TAG, "[SEND] Sending telemetry message #%lu...", telemetry_send_count);
+    DLOGI(TAG, "[SEND] Sending telemetry message #%lu...", telemetry_send_count);
 
     // IMPORTANT: Replay ALL cached offline messages FIRST before sending live data
     // This ensures chronological order - older cached data must be sent before newer live data
@@ -4344,10 +4569,10 @@ static bool send_telemetry(void) {
 
         if (pending_count > 0) {
             uint32_t total_cached = pending_count;
-            ESP_LOGI(TAG, "[SD] 📤 Found %lu cached messages - sending ALL before live data", total_cached);
-            ESP_LOGI(TAG, "[SD] 📊 Rate limiting: %dms between messages, %d per batch, %dms between batches",
-                     SD_REPLAY_DELAY_BETWEEN_MESSAGES_MS, SD_REPLAY_MAX_MESSAGES_PER_BATCH,
-                     SD_REPLAY_DELAY_BETWEEN_BATCHES_MS);
+            DLOGI(TAG, "[SD] 📤 Found %lu cached messages - sending ALL before live data", total_cached);
+            DLOGI(TAG, "[SD] 📊 Rate limiting: %dms between messages, %d per batch, %dms between batches",
+                 SD_REPLAY_DELAY_BETWEEN_MESSAGES_MS, SD_REPLAY_MAX_MESSAGES_PER_BATCH,
+                 SD_REPLAY_DELAY_BETWEEN_BATCHES_MS);
 
             // Keep replaying until ALL cached messages are sent
             // NEW: Track time to read sensors every telemetry_interval during replay
@@ -4356,12 +4581,12 @@ static bool send_telemetry(void) {
             uint32_t sensor_interval_ticks = pdMS_TO_TICKS(config->telemetry_interval * 1000);
             uint32_t live_readings_cached = 0;  // Count of live readings cached during replay
 
-            ESP_LOGI(TAG, "[SD] 📊 Will read sensors every %d seconds during replay to prevent data loss",
-                     config->telemetry_interval);
+            DLOGI(TAG, "[SD] 📊 Will read sensors every %d seconds during replay to prevent data loss",
+                 config->telemetry_interval);
 
             while (pending_count > 0 && mqtt_connected) {
                 batches_sent++;
-                ESP_LOGI(TAG, "[SD] 📤 Sending batch %lu... (%lu messages remaining)", batches_sent, pending_count);
+                DLOGI(TAG, "[SD] 📤 Sending batch %lu... (%lu messages remaining)", batches_sent, pending_count);
 
                 // Reset replay control variables for this batch
                 sd_replay_should_stop = false;
@@ -4391,14 +4616,14 @@ static bool send_telemetry(void) {
                     break;
                 }
 
-                ESP_LOGI(TAG, "[SD] ✅ Batch %lu complete: sent %lu messages, %lu remaining",
-                         batches_sent, sd_replay_messages_sent, pending_count);
+                DLOGI(TAG, "[SD] ✅ Batch %lu complete: sent %lu messages, %lu remaining",
+                     batches_sent, sd_replay_messages_sent, pending_count);
 
                 // NEW: Check if telemetry interval has passed - read sensors and cache to SD
                 // This prevents data loss during long replay periods
                 uint32_t current_tick = xTaskGetTickCount();
                 if ((current_tick - last_sensor_read_tick) >= sensor_interval_ticks) {
-                    ESP_LOGI(TAG, "[SD] ⏸️ PAUSE replay - reading sensors (interval: %ds)", config->telemetry_interval);
+                    DLOGI(TAG, "[SD] ⏸️ PAUSE replay - reading sensors (interval: %ds)", config->telemetry_interval);
 
                     // Read sensors and create payload
                     char live_payload[512];
@@ -4419,51 +4644,53 @@ static bool send_telemetry(void) {
                         // Cache each sensor reading to SD (like offline data)
                         for (int i = 0; i < live_count; i++) {
                             if (live_readings[i].valid) {
-                                // Find matching sensor config
-                                sensor_config_t* sensor = NULL;
-                                for (int j = 0; j < config->sensor_count; j++) {
-                                    if (strcmp(config->sensors[j].unit_id, live_readings[i].unit_id) == 0) {
-                                        sensor = &config->sensors[j];
-                                        break;
-                                    }
-                                }
+                                sensor_config_t* sensor = find_sensor_config(config, live_readings[i].unit_id);
 
                                 if (sensor && sensor->enabled) {
-                                    // Determine value key based on sensor type
-                                    const char* value_key = "value";
-                                    const char* type_value = "SENSOR";
-                                    if (strcasecmp(sensor->sensor_type, "Flow-Meter") == 0 ||
-                                        strcasecmp(sensor->sensor_type, "ZEST") == 0) {
-                                        value_key = "consumption";
-                                        type_value = "FLOW";
-                                    } else if (strcasecmp(sensor->sensor_type, "Level") == 0) {
-                                        value_key = "level_filled";
-                                        type_value = "LEVEL";
-                                    }
-
-                                    // Create JSON payload
-                                    snprintf(live_payload, sizeof(live_payload),
-                                        "{\"unit_id\":\"%s\",\"type\":\"%s\",\"%s\":\"%.3f\",\"created_on\":\"%s\"}",
-                                        sensor->unit_id, type_value, value_key, live_readings[i].value, timestamp);
+                                    // Same value key / type (and routing property) as the live builders
+                                    telemetry_sensor_class_t sensor_class;
+                                    telemetry_classify_sensor(sensor->sensor_type, &sensor_class);
+                                    const char* value_key = sensor_class.value_key;
+                                    const char* type_value = sensor_class.type_name;
+                                    telemetry_msg_props_t props = {
+                                        .type = type_value,
+                                        .unit_id = sensor->unit_id,
+                                    };
 
                                     // Cache to SD card (same format as offline caching)
-                                    char cache_topic[256];
-                                    snprintf(cache_topic, sizeof(cache_topic),
-                                             "devices/%s/messages/events/", config->azure_device_id);
+                                    char cache_topic[TELEMETRY_TOPIC_MAX];
+                                    uint8_t live_cbor[160];
+                                    size_t live_cbor_len = 0;
+                                    if (config->telemetry_encoding == TELEMETRY_ENCODING_CBOR &&
+                                        telemetry_cbor_encode_batch(config, &live_readings[i], 1, now,
+                                                                    live_cbor, sizeof(live_cbor),
+                                                                    &live_cbor_len) == ESP_OK &&
+                                        telemetry_cache_encode(live_cbor, live_cbor_len,
+                                                               live_payload, sizeof(live_payload)) == ESP_OK) {
+                                        telemetry_build_topic(cache_topic, sizeof(cache_topic),
+                                                              config->azure_device_id, TELEMETRY_ENCODING_CBOR, &props);
+                                    } else {
+                                        // Create JSON payload
+                                        snprintf(live_payload, sizeof(live_payload),
+                                            "{\"unit_id\":\"%s\",\"type\":\"%s\",\"%s\":\"%.3f\",\"created_on\":\"%s\"}",
+                                            sensor->unit_id, type_value, value_key, live_readings[i].value, timestamp);
+                                        telemetry_build_topic(cache_topic, sizeof(cache_topic),
+                                                              config->azure_device_id, TELEMETRY_ENCODING_JSON, &props);
+                                    }
                                     esp_err_t cache_ret = sd_card_save_message(cache_topic, live_payload, timestamp);
                                     if (cache_ret == ESP_OK) {
                                         live_readings_cached++;
-                                        ESP_LOGI(TAG, "[SD] 💾 Cached live reading: %s = %.3f",
-                                                 sensor->unit_id, live_readings[i].value);
+                                        DLOGI(TAG, "[SD] 💾 Cached live reading: %s = %.3f",
+                                             sensor->unit_id, live_readings[i].value);
                                     }
                                 }
                             }
                         }
-                        ESP_LOGI(TAG, "[SD] ✅ Cached %d live readings during replay pause", live_count);
+                        DLOGI(TAG, "[SD] ✅ Cached %d live readings during replay pause", live_count);
                     }
 
                     last_sensor_read_tick = xTaskGetTickCount();
-                    ESP_LOGI(TAG, "[SD] ▶️ RESUME replay...");
+                    DLOGI(TAG, "[SD] ▶️ RESUME replay...");
 
                     // Update pending count (now includes newly cached messages)
                     sd_card_get_pending_count(&pending_count);
@@ -4471,7 +4698,7 @@ static bool send_telemetry(void) {
 
                 // Delay between batches to let Azure IoT Hub recover (uses config value)
                 if (pending_count > 0 && mqtt_connected) {
-                    ESP_LOGI(TAG, "[SD] ⏳ Waiting %dms before next batch...", SD_REPLAY_DELAY_BETWEEN_BATCHES_MS);
+                    DLOGI(TAG, "[SD] ⏳ Waiting %dms before next batch...", SD_REPLAY_DELAY_BETWEEN_BATCHES_MS);
                     vTaskDelay(pdMS_TO_TICKS(SD_REPLAY_DELAY_BETWEEN_BATCHES_MS));
 
                     // Check connection again after delay
@@ -4483,11 +4710,11 @@ static bool send_telemetry(void) {
             }
 
             if (pending_count == 0) {
-                ESP_LOGI(TAG, "[SD] ✅ ALL %lu cached messages sent in %lu batches", total_cached, batches_sent);
+                DLOGI(TAG, "[SD] ✅ ALL %lu cached messages sent in %lu batches", total_cached, batches_sent);
                 if (live_readings_cached > 0) {
-                    ESP_LOGI(TAG, "[SD] 📊 Also cached %lu live readings during replay (zero data loss!)", live_readings_cached);
+                    DLOGI(TAG, "[SD] 📊 Also cached %lu live readings during replay (zero data loss!)", live_readings_cached);
                 }
-                ESP_LOGI(TAG, "[SD] ▶️ Now sending live data...");
+                DLOGI(TAG, "[SD] ▶️ Now sending live data...");
             } else if (!mqtt_connected) {
                 ESP_LOGW(TAG, "[SD] ⚠️ %lu messages still pending (MQTT disconnected) - will continue when connected", pending_count);
             } else {
@@ -4503,17 +4730,8 @@ static bool send_telemetry(void) {
 
     // Data is now provided by the modbus task via queue
 
-    // Use Azure IoT Hub D2C telemetry topic format
-    snprintf(telemetry_topic, sizeof(telemetry_topic),
-             "devices/%s/messages/events/", config->azure_device_id);
-    
-    // Validate topic format
-    if (strlen(telemetry_topic) == 0 || !strstr(telemetry_topic, "devices/")) {
-        ESP_LOGE(TAG, "[ERROR] Invalid telemetry topic format: %s", telemetry_topic);
-        send_in_progress = false;
-        return false;
-    }
-
+    // Builds, splits and publishes this cycle's messages (parts that cannot be
+    // published are cached to SD)
     create_telemetry_payload(telemetry_payload, sizeof(telemetry_payload));
 
     // Check if payload is empty (no valid sensor data)
@@ -4523,104 +4741,36 @@ static bool send_telemetry(void) {
         return false;
     }
 
-    // Check if sensors were already published in create_telemetry_payload
-    if (sensors_already_published > 0) {
-        ESP_LOGI(TAG, "[OK] %d sensors already sent via MQTT in create_telemetry_payload", sensors_already_published);
-        ESP_LOGI(TAG, "[SEND] Published to Azure IoT Hub:");
-        ESP_LOGI(TAG, "   Topic: %s", telemetry_topic);
-        ESP_LOGI(TAG, "   Sensors sent: %d", sensors_already_published);
-        ESP_LOGI(TAG, "   Last payload: %s", telemetry_payload);
-
-        telemetry_send_count++;
-        total_telemetry_sent += sensors_already_published;
-        last_telemetry_time = esp_timer_get_time() / 1000000;
-        last_successful_telemetry_time = esp_timer_get_time() / 1000000;
-        telemetry_failure_count = 0;
-
-        ESP_LOGI(TAG, "[OK] Telemetry sent to MQTT successfully");
-        send_in_progress = false;
-        return true;
-    }
-
-    // If no sensors were published yet (e.g., MQTT was not connected during create_telemetry_payload)
-    // Fall back to publishing the single payload
-    ESP_LOGI(TAG, "[LOC] Topic: %s", telemetry_topic);
-    ESP_LOGI(TAG, "[PKG] Payload: %s", telemetry_payload);
-    ESP_LOGI(TAG, "[PKG] Payload Length: %d bytes", strlen(telemetry_payload));
-    ESP_LOGI(TAG, "[KEY] Using SAS Token: %.50s...", sas_token);
-    ESP_LOGI(TAG, "[NET] Device ID: %s", config->azure_device_id);
-    ESP_LOGI(TAG, "[HUB] IoT Hub: %s", IOT_CONFIG_IOTHUB_FQDN);
-    ESP_LOGI(TAG, "[LINK] MQTT Connected: %s", mqtt_connected ? "YES" : "NO");
-
-    // Check payload size limit (Azure IoT Hub has 256KB limit)
-    if (strlen(telemetry_payload) > 262144) {
-        ESP_LOGE(TAG, "[ERROR] Payload too large: %d bytes (max 256KB)", strlen(telemetry_payload));
-        send_in_progress = false;
+    if (sensors_already_published == 0) {
+        if (sensors_cached_to_sd > 0) {
+            ESP_LOGW(TAG, "[SD] Publish failed - %d sensor readings cached to SD card for retry", sensors_cached_to_sd);
+        } else {
+            ESP_LOGE(TAG, "[ERROR] FAILED to publish telemetry and nothing was cached - data lost!");
+            ESP_LOGE(TAG, "   MQTT connected: %s", mqtt_connected ? "YES" : "NO");
+        }
+        send_in_progress = false; // Reset flag on failure
+        telemetry_failure_count++;  // Track failures for recovery monitoring
         return false;
     }
 
-    // Try QoS 0 for compatibility with Arduino 1.0.6
-    int msg_id = esp_mqtt_client_publish(
-        mqtt_client,
-        telemetry_topic,
-        telemetry_payload,
-        strlen(telemetry_payload),
-        0,  // QoS 0 for Arduino 1.0.6 compatibility
-        0   // DO_NOT_RETAIN_MSG
-    );
-
-    if (msg_id == -1) {
-        ESP_LOGE(TAG, "[ERROR] FAILED to publish telemetry - MQTT client error");
-        ESP_LOGE(TAG, "   Check: MQTT connection, topic format, payload size");
-        ESP_LOGE(TAG, "   Topic: %s", telemetry_topic);
-        ESP_LOGE(TAG, "   Payload size: %d bytes", strlen(telemetry_payload));
-        ESP_LOGE(TAG, "   MQTT connected: %s", mqtt_connected ? "YES" : "NO");
+    DLOGI(TAG, "[OK] Telemetry queued for publish - PUBACKs tracked by outbox, spilled to SD if the link drops first");
+    ESP_LOGI(TAG, "[SEND] Published to Azure IoT Hub:");
+    ESP_LOGI(TAG, "   Last topic: %s", telemetry_topic);
+    ESP_LOGI(TAG, "   Sensors sent: %d (cached: %d)", sensors_already_published, sensors_cached_to_sd);
+    ESP_LOGI(TAG, "   Last payload: %.200s%s", telemetry_payload, strlen(telemetry_payload) > 200 ? "..." : "");
 
-        // H-3 HARDENING: Cache payload to SD card instead of losing it
-        if (config->sd_config.enabled && config->sd_config.cache_on_failure) {
-            time_t now = time(NULL);
-            struct tm timeinfo;
-            gmtime_r(&now, &timeinfo);
-            char timestamp[32];
-            strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
+    telemetry_send_count++;
+    total_telemetry_sent += sensors_already_published;
+    last_telemetry_time = esp_timer_get_time() / 1000000;
+    last_successful_telemetry_time = esp_timer_get_time() / 1000000;  // For recovery timeout
+    telemetry_failure_count = 0;  // Reset failure count on success
+    gateway_status_update_azure();
 
-            esp_err_t cache_ret = sd_card_save_message(telemetry_topic, telemetry_payload, timestamp);
-            if (cache_ret == ESP_OK) {
-                ESP_LOGW(TAG, "[SD] Publish failed - telemetry cached to SD card for retry");
-            } else {
-                ESP_LOGE(TAG, "[SD] Publish failed AND SD cache failed - data lost!");
-            }
-        }
+    // Store in telemetry history for web interface
+    add_telemetry_to_history(telemetry_payload, true);
 
-        // Try to reconnect MQTT if disconnected (but not during OTA)
-        if (!mqtt_connected && mqtt_client != NULL && !ota_is_in_progress()) {
-            ESP_LOGW(TAG, "[WARN] Attempting MQTT reconnection...");
-            esp_mqtt_client_reconnect(mqtt_client);
-        }
-        send_in_progress = false; // Reset flag on failure
-        telemetry_failure_count++;  // Track failures for recovery monitoring
-        return false;
-    } else {
-        ESP_LOGI(TAG, "[OK] Telemetry queued for publish, msg_id=%d", msg_id);
-        ESP_LOGI(TAG, "   Waiting for MQTT_EVENT_PUBLISHED confirmation...");
-        telemetry_send_count++;
-        total_telemetry_sent++; // Increment counter for web interface (Azure IoT doesn't send PUBACK)
-        last_telemetry_time = esp_timer_get_time() / 1000000; // Update last telemetry timestamp
-        last_successful_telemetry_time = esp_timer_get_time() / 1000000;  // For recovery timeout
-        telemetry_failure_count = 0;  // Reset failure count on success
-
-        // Log detailed publish info
-        ESP_LOGI(TAG, "[SEND] Published to Azure IoT Hub:");
-        ESP_LOGI(TAG, "   Topic: %s", telemetry_topic);
-        ESP_LOGI(TAG, "   Message ID: %d", msg_id);
-        ESP_LOGI(TAG, "   Payload: %.200s%s", telemetry_payload, strlen(telemetry_payload) > 200 ? "..." : "");
-
-        // Store in telemetry history for web interface
-        add_telemetry_to_history(telemetry_payload, true);
-
-        send_in_progress = false; // Reset flag on success
-        return true;
-    }
+    send_in_progress = false; // Reset flag on success
+    return true;
 }
 
 void app_main(void) {
@@ -4634,6 +4784,10 @@ void app_main(void) {
     // Initialize system uptime tracking
     system_uptime_start = esp_timer_get_time() / 1000000;
 
+    // Hot-path logging (Modbus, sensor conversion, telemetry) is formatted by a
+    // low-priority task so it no longer blocks the caller on the console
+    dlog_init();
+
     // Initialize Hardware Watchdog Timer (prevents system hang)
     ESP_LOGI(TAG, "[WDT] Initializing hardware watchdog timer (%d seconds)...", WATCHDOG_TIMEOUT_SEC);
     esp_task_wdt_config_t wdt_config = {
@@ -4697,6 +4851,9 @@ void app_main(void) {
     // Get system configuration
     system_config_t* config = get_system_config();
 
+    // /api/status is served from this snapshot; the owning tasks keep it current
+    gateway_status_init();
+
     // Initialize status LEDs early so they can be used in both SETUP and OPERATION modes
     ESP_LOGI(TAG, "╔══════════════════════════════════════════════════════════╗");
     ESP_LOGI(TAG, "║           💡 STATUS LED INITIALIZATION 💡                ║");
@@ -4800,6 +4957,11 @@ void app_main(void) {
     } else {
         ESP_LOGI(TAG, "[SD] SD card logging disabled in configuration");
     }
+
+    // QoS 1 telemetry outbox (spills unacknowledged messages to SD)
+    if (mqtt_outbox_init() != ESP_OK) {
+        ESP_LOGE(TAG, "[MQTT] Failed to initialize telemetry outbox");
+    }
     
     // Load modem reset settings from configuration
     modem_reset_enabled = config->modem_reset_enabled;
@@ -4923,6 +5085,9 @@ void app_main(void) {
             .pwr_pin = config->sim_config.pwr_pin,
             .reset_pin = config->sim_config.reset_pin,
             .baud_rate = config->sim_config.uart_baud_rate,
+            .rts_pin = config->modem_rts_pin,
+            .cts_pin = config->modem_cts_pin,
+            .ppp_baud_rate = config->modem_ppp_baud,
             .apn = config->sim_config.apn,
             .user = config->sim_config.apn_user,
             .pass = config->sim_config.apn_pass,
@@ -5022,12 +5187,13 @@ void app_main(void) {
         // Background keepalive: 10s tunnel check, 20s server verify, peer-deletion self-heal
         wireguard_start_keepalive_task();
 
-        // Wake-on-ICMP + 30-min idle shutdown for the web server.
-        // Lets VPN peers `ping 10.100.0.X` to summon the config UI without
-        // leaving httpd running 24/7 and burning ~15 KB heap.
+        // Wake-on-traffic + 30-min idle shutdown for the web server.
+        // Lets VPN peers `ping 10.100.0.X` or just open http://10.100.0.X/
+        // to summon the config UI without leaving httpd running 24/7 and
+        // burning ~15 KB heap. The main loop below starts it (web_wake_wait).
         esp_err_t ww_ret = web_wake_init();
         if (ww_ret == ESP_OK) {
-            ESP_LOGI(TAG, "[WAKE] Web wake-on-ping armed — server will start on VPN ICMP");
+            ESP_LOGI(TAG, "[WAKE] Web wake armed — server will start on VPN ICMP / HTTP / WoL");
         } else {
             ESP_LOGW(TAG, "[WAKE] web_wake_init failed: %s", esp_err_to_name(ww_ret));
         }
@@ -5106,7 +5272,7 @@ void app_main(void) {
     BaseType_t memory_result = xTaskCreatePinnedToCore(
         memory_monitor_task,
         "mem_monitor",
-        2048,  // Small stack - only does heap monitoring
+        3072,  // Small stack - heap monitoring plus the /api/status health sample
         NULL,
         1,     // Lowest priority - runs when others idle
         &memory_monitor_handle,
@@ -5118,11 +5284,27 @@ void app_main(void) {
         // Don't return - system can run without memory monitor
     }
 
+    // Create Connectivity task (blocks during PPP dial / modem reset, so it gets its own task)
+    BaseType_t conn_result = xTaskCreatePinnedToCore(
+        connectivity_task,
+        "conn_task",
+        4096,
+        NULL,
+        2,     // Below telemetry - recovery is paced in seconds
+        &connectivity_task_handle,
+        1      // Core 1
+    );
+
+    if (conn_result != pdPASS) {
+        ESP_LOGW(TAG, "[WARN] Failed to create Connectivity task - relying on esp-mqtt auto-reconnect");
+    }
+
     ESP_LOGI(TAG, "[OK] All tasks created successfully");
     ESP_LOGI(TAG, "[CORE] Modbus reading: Core 0 (priority 5)");
     ESP_LOGI(TAG, "[NET] MQTT handling: Core 1 (priority 4)");
     ESP_LOGI(TAG, "[DATA] Telemetry sending: Core 1 (priority 3)");
     ESP_LOGI(TAG, "[HEALTH] Memory monitor: Core 1 (priority 1)");
+    ESP_LOGI(TAG, "[CONN] Connectivity recovery: Core 1 (priority 2)");
     ESP_LOGI(TAG, "[WEB] GPIO %d: Pull LOW to toggle web server ON/OFF", trigger_gpio);
 
     // Wait for all tasks to display their startup messages
@@ -5141,14 +5323,15 @@ void app_main(void) {
     }
     ESP_LOGI(TAG, "╚══════════════════════════════════════════════════════════╝");
 
-    // DISABLED: Telegram bot feature (not compiled)
-    // telegram_bot_init();
-    // if (telegram_is_enabled()) {
-    //     ESP_LOGI(TAG, "[TELEGRAM] Starting Telegram bot...");
-    //     telegram_bot_start();
-    // } else {
-    //     ESP_LOGI(TAG, "[TELEGRAM] Telegram bot disabled in configuration");
-    // }
+#ifdef CONFIG_GATEWAY_TELEGRAM_BOT
+    telegram_bot_init();
+    if (telegram_is_enabled()) {
+        ESP_LOGI(TAG, "[TELEGRAM] Starting Telegram bot...");
+        telegram_bot_start();
+    } else {
+        ESP_LOGI(TAG, "[TELEGRAM] Telegram bot disabled in configuration");
+    }
+#endif
 
     // Main monitoring loop with web server toggle support
     while (1) {
@@ -5247,6 +5430,8 @@ void app_main(void) {
             last_twin_report = current_time_sec;
         }
 
-        vTaskDelay(pdMS_TO_TICKS(5000)); // Check every 5 seconds
+        // Check every 5 seconds; a wake event ends the wait early and
+        // starts the web server from here
+        web_wake_wait(pdMS_TO_TICKS(5000));
     }
 }
\ No newline at end of file
@@ -6,9 +6,13 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "dlog.h"
+#include "perf_trace.h"
 #include <string.h>
+#include <inttypes.h>
 #include <time.h>
 #include <math.h>
 
@@ -27,11 +31,44 @@ static int current_baud_rate = 9600;
 // Flag to track if Modbus is already initialized
 static bool modbus_initialized = false;
 
+// RS485 bus owner (recursive). Held from the baud rate change and request until
+// the reply is in response_buffer - callers that read response_buffer afterwards
+// hold it too (modbus_bus_lock()), so the telemetry task and portal handlers
+// never interleave frames or overwrite each other's registers.
+static SemaphoreHandle_t bus_mutex = NULL;
+
+// Per-frame INFO logging is deferred (dlog.h) so the console does not stretch
+// each round trip. Bulk register dumps pass quiet (hundreds of frames per dump).
+#define MODBUS_LOGI(quiet, ...) do { if (!(quiet)) DLOGI(TAG, __VA_ARGS__); } while (0)
+
+bool modbus_bus_lock(uint32_t timeout_ms)
+{
+    if (bus_mutex == NULL) {
+        return true;              // Not initialized - nothing to share yet
+    }
+    if (xSemaphoreTakeRecursive(bus_mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
+        ESP_LOGW(TAG, "[BUS] RS485 bus busy for %lu ms", (unsigned long)timeout_ms);
+        return false;
+    }
+    return true;
+}
+
+void modbus_bus_unlock(void)
+{
+    if (bus_mutex != NULL) {
+        xSemaphoreGiveRecursive(bus_mutex);
+    }
+}
+
 // Function to set baud rate dynamically
 esp_err_t modbus_set_baud_rate(int baud_rate)
 {
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        return ESP_ERR_TIMEOUT;
+    }
     if (baud_rate == current_baud_rate) {
         // Baud rate already set, no need to change
+        modbus_bus_unlock();
         return ESP_OK;
     }
     
@@ -41,6 +78,7 @@ esp_err_t modbus_set_baud_rate(int baud_rate)
     esp_err_t ret = uart_set_baudrate(RS485_UART_PORT, baud_rate);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "[ERROR] Failed to set baud rate: %s", esp_err_to_name(ret));
+        modbus_bus_unlock();
         return ret;
     }
     
@@ -53,6 +91,7 @@ esp_err_t modbus_set_baud_rate(int baud_rate)
     uart_flush(RS485_UART_PORT);
     
     ESP_LOGI(TAG, "[BAUD] Successfully changed baud rate to %d bps", baud_rate);
+    modbus_bus_unlock();
     return ESP_OK;
 }
 
@@ -75,6 +114,14 @@ esp_err_t modbus_init(void)
     ESP_LOGI(TAG, "   * Buffer Size: %d bytes", RS485_BUF_SIZE);
 
     current_baud_rate = RS485_BAUD_RATE;
+
+    if (bus_mutex == NULL) {
+        bus_mutex = xSemaphoreCreateRecursiveMutex();
+        if (bus_mutex == NULL) {
+            ESP_LOGE(TAG, "[ERROR] Failed to create RS485 bus mutex");
+            return ESP_ERR_NO_MEM;
+        }
+    }
     
     uart_config_t uart_config = {
         .baud_rate = RS485_BAUD_RATE,
@@ -181,10 +228,23 @@ bool modbus_verify_crc(const uint8_t* data, size_t length)
     return calculated_crc == received_crc;
 }
 
-// Generic Modbus request function
-static modbus_result_t modbus_send_request(uint8_t slave_id, uint8_t function_code, 
-                                         uint16_t start_addr, uint16_t data, 
-                                         uint8_t* response_data, size_t max_response_length)
+// Length of a normal (non-exception) reply to a request built by modbus_send_request()
+static int modbus_frame_length(uint8_t function_code, uint16_t data)
+{
+    switch (function_code) {
+        case MODBUS_READ_HOLDING_REGISTERS:
+        case MODBUS_READ_INPUT_REGISTERS:
+            return 5 + 2 * data;          // slave, func, byte count, data, CRC
+        default:
+            return 8;                     // Write single: echo of the request
+    }
+}
+
+// One request/response exchange
+static modbus_result_t modbus_exchange(uint8_t slave_id, uint8_t function_code,
+                                       uint16_t start_addr, uint16_t data,
+                                       uint8_t* response_data, size_t max_response_length,
+                                       bool quiet)
 {
     uint8_t request[8];
     uint8_t response[MODBUS_MAX_BUFFER_SIZE];
@@ -206,7 +266,7 @@ static modbus_result_t modbus_send_request(uint8_t slave_id, uint8_t function_co
     // Clear receive buffer and log request details
     uart_flush_input(RS485_UART_PORT);
     
-    ESP_LOGI(TAG, "[SEND] Sending Modbus request to Slave %d: [%02X %02X %02X %02X %02X %02X %02X %02X]",
+    MODBUS_LOGI(quiet, "[SEND] Sending Modbus request to Slave %d: [%02X %02X %02X %02X %02X %02X %02X %02X]",
              slave_id, request[0], request[1], request[2], request[3], 
              request[4], request[5], request[6], request[7]);
     
@@ -219,40 +279,55 @@ static modbus_result_t modbus_send_request(uint8_t slave_id, uint8_t function_co
         return MODBUS_INVALID_RESPONSE;
     }
     
-    ESP_LOGI(TAG, "[OK] Modbus request sent successfully (%d bytes)", bytes_written);
+    MODBUS_LOGI(quiet, "[OK] Modbus request sent successfully (%d bytes)", bytes_written);
     
     // Wait for transmission complete
     uart_wait_tx_done(RS485_UART_PORT, pdMS_TO_TICKS(100));
     
-    ESP_LOGI(TAG, "[WAIT] Waiting for response (timeout: %d ms)...", MODBUS_RESPONSE_TIMEOUT_MS);
+    MODBUS_LOGI(quiet, "[WAIT] Waiting for response (timeout: %d ms)...", MODBUS_RESPONSE_TIMEOUT_MS);
     
     // Clear response buffer for safety
     memset(response, 0, sizeof(response));
     
-    // Read response with bounds checking
-    int response_length = uart_read_bytes(RS485_UART_PORT, response, sizeof(response), 
+    // Read the 3-byte header, then exactly the rest of the frame it announces, so a
+    // complete reply returns at once instead of waiting out the response timeout
+    int response_length = uart_read_bytes(RS485_UART_PORT, response, 3,
                                         pdMS_TO_TICKS(MODBUS_RESPONSE_TIMEOUT_MS));
+    if (response_length == 3) {
+        int frame_length = (response[1] & 0x80) ? 5 : modbus_frame_length(function_code, data);
+        if (frame_length > (int)sizeof(response)) {
+            frame_length = sizeof(response);
+        }
+        // Rest of the frame at the current baud rate (11 bits per byte) plus margin
+        int rest_ms = (frame_length - 3) * 11 * 1000 / current_baud_rate + MODBUS_FRAME_MARGIN_MS;
+        int rest = uart_read_bytes(RS485_UART_PORT, response + 3, frame_length - 3, pdMS_TO_TICKS(rest_ms));
+        if (rest > 0) {
+            response_length += rest;
+        }
+    }
     
-    ESP_LOGI(TAG, "[RECV] Received %d bytes from RS485", response_length);
+    MODBUS_LOGI(quiet, "[RECV] Received %d bytes from RS485", response_length);
     
-    if (response_length > 0) {
-        // Log received bytes for debugging
-        ESP_LOGI(TAG, "[INFO] Raw response data:");
-        for (int i = 0; i < response_length && i < 16; i++) {
-            printf("%02X ", response[i]);
+    if (response_length > 0 && !quiet) {
+        // First 16 received bytes for debugging, 4 per word (the rest of the buffer is zeroed)
+        uint32_t raw[4];
+        for (int w = 0; w < 4; w++) {
+            raw[w] = ((uint32_t)response[w * 4] << 24) | ((uint32_t)response[w * 4 + 1] << 16) |
+                     ((uint32_t)response[w * 4 + 2] << 8) | response[w * 4 + 3];
         }
-        printf("\n");
+        MODBUS_LOGI(quiet, "[INFO] Raw response data (%d bytes): %08" PRIX32 " %08" PRIX32 " %08" PRIX32 " %08" PRIX32,
+                    response_length, raw[0], raw[1], raw[2], raw[3]);
     }
     
     if (response_length < 5) {
-        if (response_length == 0) {
+        if (response_length == 0 && !quiet) {
             ESP_LOGE(TAG, "[ERROR] No response from Modbus device (timeout)");
             ESP_LOGE(TAG, "[CONFIG] Troubleshooting:");
             ESP_LOGE(TAG, "   * Check RS485 wiring (A+, B-, GND)");
             ESP_LOGE(TAG, "   * Verify slave ID (%d) is correct", slave_id);
             ESP_LOGE(TAG, "   * Check baud rate (%d bps)", RS485_BAUD_RATE);
             ESP_LOGE(TAG, "   * Ensure device is powered and connected");
-        } else {
+        } else if (response_length > 0) {
             ESP_LOGE(TAG, "[ERROR] Invalid response length: %d bytes (minimum 5 required)", response_length);
         }
         stats.failed_requests++;
@@ -273,7 +348,9 @@ static modbus_result_t modbus_send_request(uint8_t slave_id, uint8_t function_co
     // Check for exception response
     if (response[1] & 0x80) {
         uint8_t exception_code = response[2];
-        ESP_LOGE(TAG, "[ERROR] Modbus exception: 0x%02X", exception_code);
+        if (!quiet) {
+            ESP_LOGE(TAG, "[ERROR] Modbus exception: 0x%02X", exception_code);
+        }
         stats.failed_requests++;
         stats.last_error_code = exception_code;
         return (modbus_result_t)exception_code;
@@ -298,20 +375,48 @@ static modbus_result_t modbus_send_request(uint8_t slave_id, uint8_t function_co
     }
 
     stats.successful_requests++;
-    ESP_LOGI(TAG, "[OK] Modbus request successful");
+    MODBUS_LOGI(quiet, "[OK] Modbus request successful");
     return MODBUS_SUCCESS;
 }
 
-// Read Holding Registers
-modbus_result_t modbus_read_holding_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs)
+// Generic Modbus request function - timed per slave, timeouts included (perf_trace.h).
+// Holds the bus for the exchange; callers that need the reply afterwards hold it longer.
+static modbus_result_t modbus_send_request(uint8_t slave_id, uint8_t function_code,
+                                         uint16_t start_addr, uint16_t data,
+                                         uint8_t* response_data, size_t max_response_length,
+                                         bool quiet)
+{
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        stats.failed_requests++;
+        stats.timeout_errors++;
+        stats.last_error_code = MODBUS_TIMEOUT;
+        return MODBUS_TIMEOUT;
+    }
+    int64_t start = perf_start();
+    modbus_result_t result = modbus_exchange(slave_id, function_code, start_addr, data,
+                                             response_data, max_response_length, quiet);
+    perf_end_modbus(slave_id, start);
+    modbus_bus_unlock();
+    return result;
+}
+
+// Read holding (0x03) or input (0x04) registers into response_buffer. The caller
+// holds the bus so the registers are still its own when it reads them.
+static modbus_result_t modbus_read_into_buffer(uint8_t slave_id, uint8_t function_code,
+                                               uint16_t start_addr, uint16_t num_regs, bool quiet)
 {
     uint8_t response[MODBUS_MAX_BUFFER_SIZE];
-    
-    ESP_LOGI(TAG, "[READ] Reading %d holding registers from slave %d, starting at 0x%04X", 
-             num_regs, slave_id, start_addr);
-    
-    modbus_result_t result = modbus_send_request(slave_id, MODBUS_READ_HOLDING_REGISTERS,
-                                               start_addr, num_regs, response, sizeof(response));
+    const char *kind = function_code == MODBUS_READ_INPUT_REGISTERS ? "input" : "holding";
+
+    MODBUS_LOGI(quiet, "[READ] Reading %d %s registers from slave %d, starting at 0x%04X",
+                num_regs, kind, slave_id, start_addr);
+
+    // Until the registers are in response_buffer (nested in the caller's lock, if any)
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        return MODBUS_TIMEOUT;
+    }
+    modbus_result_t result = modbus_send_request(slave_id, function_code,
+                                                 start_addr, num_regs, response, sizeof(response), quiet);
 
     if (result == MODBUS_SUCCESS) {
         uint8_t byte_count = response[2];
@@ -319,6 +424,7 @@ modbus_result_t modbus_read_holding_registers(uint8_t slave_id, uint16_t start_a
         // Bounds check 1: Validate byte_count to prevent buffer overflow from malformed response
         if (byte_count > MODBUS_MAX_REGISTERS * 2) {
             ESP_LOGE(TAG, "[ERROR] Response byte_count too large: %d bytes (max %d)", byte_count, MODBUS_MAX_REGISTERS * 2);
+            modbus_bus_unlock();
             return MODBUS_INVALID_RESPONSE;
         }
 
@@ -327,6 +433,7 @@ modbus_result_t modbus_read_holding_registers(uint8_t slave_id, uint16_t start_a
         if (last_response_bytes < expected_bytes) {
             ESP_LOGE(TAG, "[ERROR] Response too short: got %d bytes, need %d for %d data bytes",
                      last_response_bytes, expected_bytes, byte_count);
+            modbus_bus_unlock();
             return MODBUS_INVALID_RESPONSE;
         }
 
@@ -339,61 +446,50 @@ modbus_result_t modbus_read_holding_registers(uint8_t slave_id, uint16_t start_a
 
         response_length = num_registers;
 
-        ESP_LOGI(TAG, "[OK] Successfully read %d registers", num_registers);
+        MODBUS_LOGI(quiet, "[OK] Successfully read %d %s registers", num_registers, kind);
 
         // Log register values for debugging
-        for (int i = 0; i < num_registers; i++) {
-            ESP_LOGI(TAG, "[DATA] Register[%d]: 0x%04X (%d)", i, response_buffer[i], response_buffer[i]);
+        for (int i = 0; i < num_registers && !quiet; i++) {
+            MODBUS_LOGI(quiet, "[DATA] Register[%d]: 0x%04X (%d)", i, response_buffer[i], response_buffer[i]);
         }
     }
 
+    modbus_bus_unlock();
     return result;
 }
 
+// Read Holding Registers
+modbus_result_t modbus_read_holding_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs)
+{
+    return modbus_read_into_buffer(slave_id, MODBUS_READ_HOLDING_REGISTERS, start_addr, num_regs, false);
+}
+
 // Read Input Registers
 modbus_result_t modbus_read_input_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs)
 {
-    uint8_t response[MODBUS_MAX_BUFFER_SIZE];
-
-    ESP_LOGI(TAG, "[READ] Reading %d input registers from slave %d, starting at 0x%04X",
-             num_regs, slave_id, start_addr);
-
-    modbus_result_t result = modbus_send_request(slave_id, MODBUS_READ_INPUT_REGISTERS,
-                                               start_addr, num_regs, response, sizeof(response));
+    return modbus_read_into_buffer(slave_id, MODBUS_READ_INPUT_REGISTERS, start_addr, num_regs, false);
+}
 
+// Read registers straight into the caller's array, under the bus lock
+modbus_result_t modbus_read_registers(uint8_t slave_id, uint8_t function_code, uint16_t start_addr,
+                                      uint16_t num_regs, uint16_t* values, bool quiet)
+{
+    if (!values || num_regs == 0 || num_regs > MODBUS_MAX_REGISTERS ||
+        (function_code != MODBUS_READ_HOLDING_REGISTERS && function_code != MODBUS_READ_INPUT_REGISTERS)) {
+        return MODBUS_ILLEGAL_DATA_VALUE;
+    }
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        return MODBUS_TIMEOUT;
+    }
+    modbus_result_t result = modbus_read_into_buffer(slave_id, function_code, start_addr, num_regs, quiet);
     if (result == MODBUS_SUCCESS) {
-        uint8_t byte_count = response[2];
-
-        // Bounds check 1: Validate byte_count to prevent buffer overflow from malformed response
-        if (byte_count > MODBUS_MAX_REGISTERS * 2) {
-            ESP_LOGE(TAG, "[ERROR] Response byte_count too large: %d bytes (max %d)", byte_count, MODBUS_MAX_REGISTERS * 2);
-            return MODBUS_INVALID_RESPONSE;
-        }
-
-        // Bounds check 2: Validate actual response has enough bytes (header + data + CRC)
-        int expected_bytes = 3 + byte_count + 2;  // slave_id + func + byte_count + data + CRC
-        if (last_response_bytes < expected_bytes) {
-            ESP_LOGE(TAG, "[ERROR] Response too short: got %d bytes, need %d for %d data bytes",
-                     last_response_bytes, expected_bytes, byte_count);
-            return MODBUS_INVALID_RESPONSE;
-        }
-
-        int num_registers = byte_count / 2;
-
-        // Extract register values into response buffer
-        for (int i = 0; i < num_registers && i < MODBUS_MAX_REGISTERS; i++) {
-            response_buffer[i] = (response[3 + i*2] << 8) | response[4 + i*2];
-        }
-
-        response_length = num_registers;
-        ESP_LOGI(TAG, "[OK] Successfully read %d input registers", num_registers);
-
-        // Log register values for debugging
-        for (int i = 0; i < num_registers; i++) {
-            ESP_LOGI(TAG, "[DATA] Register[%d]: 0x%04X (%d)", i, response_buffer[i], response_buffer[i]);
+        if (response_length < num_regs) {
+            result = MODBUS_INVALID_RESPONSE;
+        } else {
+            memcpy(values, response_buffer, num_regs * sizeof(values[0]));
         }
     }
-
+    modbus_bus_unlock();
     return result;
 }
 
@@ -403,11 +499,11 @@ modbus_result_t modbus_write_single_register(uint8_t slave_id, uint16_t addr, ui
     ESP_LOGI(TAG, "Writing value 0x%04X to register 0x%04X on slave %d", value, addr, slave_id);
     
     uint8_t response[MODBUS_MAX_BUFFER_SIZE];
-    return modbus_send_request(slave_id, MODBUS_WRITE_SINGLE_REGISTER, addr, value, response, sizeof(response));
+    return modbus_send_request(slave_id, MODBUS_WRITE_SINGLE_REGISTER, addr, value, response, sizeof(response), false);
 }
 
-// Write Multiple Registers
-modbus_result_t modbus_write_multiple_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs, const uint16_t* values)
+// Write Multiple Registers (bus held by the caller)
+static modbus_result_t modbus_write_multiple_exchange(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs, const uint16_t* values)
 {
     if (!values || num_regs == 0 || num_regs > MODBUS_MAX_REGISTERS) {
         ESP_LOGE(TAG, "[ERROR] Invalid parameters for write multiple registers");
@@ -549,6 +645,16 @@ modbus_result_t modbus_write_multiple_registers(uint8_t slave_id, uint16_t start
     return MODBUS_SUCCESS;
 }
 
+modbus_result_t modbus_write_multiple_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs, const uint16_t* values)
+{
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        return MODBUS_TIMEOUT;
+    }
+    modbus_result_t result = modbus_write_multiple_exchange(slave_id, start_addr, num_regs, values);
+    modbus_bus_unlock();
+    return result;
+}
+
 // Get Response Buffer Value
 uint16_t modbus_get_response_buffer(uint8_t index)
 {
@@ -587,8 +693,8 @@ void modbus_reset_statistics(void)
     ESP_LOGI(TAG, "[STATS] Modbus statistics reset");
 }
 
-// Flow Meter Data Reading Function
-esp_err_t flow_meter_read_data(const meter_config_t* config, flow_meter_data_t* data)
+// Flow Meter Data Reading Function (bus held by the caller)
+static esp_err_t flow_meter_read_locked(const meter_config_t* config, flow_meter_data_t* data)
 {
     if (!config || !data) {
         ESP_LOGE(TAG, "[ERROR] Invalid parameters for flow meter reading");
@@ -687,6 +793,17 @@ esp_err_t flow_meter_read_data(const meter_config_t* config, flow_meter_data_t*
     return ESP_OK;
 }
 
+esp_err_t flow_meter_read_data(const meter_config_t* config, flow_meter_data_t* data)
+{
+    // Hold the bus until the registers are decoded out of response_buffer
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = flow_meter_read_locked(config, data);
+    modbus_bus_unlock();
+    return ret;
+}
+
 // Print Flow Meter Data
 void flow_meter_print_data(const flow_meter_data_t* data)
 {
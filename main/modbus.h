@@ -23,6 +23,8 @@
 #define RS485_BAUD_RATE 9600
 #define RS485_BUF_SIZE 2048
 #define MODBUS_RESPONSE_TIMEOUT_MS 1000
+#define MODBUS_FRAME_MARGIN_MS 20       // Slack after the header for the rest of the reply
+#define MODBUS_BUS_LOCK_TIMEOUT_MS 15000 // Longest wait for another task's bus transaction (portal tests read several sensors)
 #define RXD2 GPIO_NUM_16
 #define TXD2 GPIO_NUM_17
 #define RS485_RTS_PIN GPIO_NUM_18  // Changed from GPIO_NUM_32 to avoid conflict with SIM RX pin
@@ -80,10 +82,22 @@ esp_err_t modbus_init(void);
 esp_err_t modbus_set_baud_rate(int baud_rate);
 void modbus_deinit(void);
 
+// Bus ownership (recursive). The read functions below leave their registers in a
+// shared response buffer: hold the bus from modbus_set_baud_rate() until the
+// values are copied out with modbus_get_response_buffer(), or use
+// modbus_read_registers(). Each function also takes the bus for its own frame.
+bool modbus_bus_lock(uint32_t timeout_ms);
+void modbus_bus_unlock(void);
+
 // Read Functions
 modbus_result_t modbus_read_holding_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs);
 modbus_result_t modbus_read_input_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs);
 
+// Read num_regs holding/input registers into values (MODBUS_INVALID_RESPONSE if the
+// slave returns fewer); quiet skips the per-frame INFO logs (bulk dumps)
+modbus_result_t modbus_read_registers(uint8_t slave_id, uint8_t function_code, uint16_t start_addr,
+                                      uint16_t num_regs, uint16_t* values, bool quiet);
+
 // Write Functions
 modbus_result_t modbus_write_single_register(uint8_t slave_id, uint16_t addr, uint16_t value);
 modbus_result_t modbus_write_multiple_registers(uint8_t slave_id, uint16_t start_addr, uint16_t num_regs, const uint16_t* values);
@@ -0,0 +1,106 @@
+// modbus_dump.c - Bulk register dump with exception bisection (see modbus_dump.h)
+
+#include "modbus_dump.h"
+
+#include <string.h>
+
+// Failed spans this short are re-read one register at a time instead of halved
+#define DUMP_SINGLE_SPAN 4
+// Pending spans: halving down to DUMP_SINGLE_SPAN leaves at most log2(n) + DUMP_SINGLE_SPAN
+#define DUMP_PENDING_MAX 16
+
+typedef struct {
+    uint16_t start;
+    uint16_t count;
+    uint8_t depth;
+} dump_span_t;
+
+static bool is_exception(int result)
+{
+    return result > 0 && result < 0x80;
+}
+
+bool modbus_dump_run(const modbus_dump_t *dump, uint16_t start, uint32_t count, modbus_dump_stats_t *stats)
+{
+    uint16_t values[MODBUS_DUMP_MAX_BLOCK];
+    dump_span_t pending[DUMP_PENDING_MAX];
+    int n_pending = 0;
+    int errors_in_row = 0;
+
+    memset(stats, 0, sizeof(*stats));
+
+    uint16_t block = dump->block;
+    if (block < 1 || block > MODBUS_DUMP_MAX_BLOCK) {
+        block = MODBUS_DUMP_MAX_BLOCK;
+    }
+    uint32_t end = (uint32_t)start + count;
+    if (end > 0x10000) {
+        end = 0x10000;
+    }
+    uint32_t next = start;
+    uint16_t min_split = dump->min_split < 1 ? 1 : dump->min_split;
+    uint32_t hole_end = UINT32_MAX;   // Address just past the last span that failed with an exception
+
+    while (n_pending > 0 || next < end) {
+        dump_span_t span;
+        if (n_pending > 0) {
+            span = pending[--n_pending];
+        } else {
+            span.start = (uint16_t)next;
+            span.count = (uint16_t)((end - next) < block ? (end - next) : block);
+            span.depth = 0;
+            next += span.count;
+        }
+        if (span.start == hole_end && span.count > min_split) {
+            // Just past a failed span: probe min_split registers at a time until the
+            // map resumes rather than paying for a failed read of the whole span first
+            pending[n_pending++] = (dump_span_t){ (uint16_t)(span.start + min_split),
+                                                  (uint16_t)(span.count - min_split), span.depth };
+            span.count = min_split;
+        }
+
+        uint32_t t0 = dump->now_ms();
+        int result = dump->read(dump->ctx, span.start, span.count, values);
+        modbus_dump_block_t out = { span.start, span.count, result, dump->now_ms() - t0, span.depth };
+        stats->reads++;
+        stats->ms += out.ms;
+
+        if (is_exception(result) && span.count > min_split) {
+            // Halve, or go straight to single registers once that costs no more reads than
+            // bisecting (a span that is all hole costs 2n-1 reads bisected, n read singly).
+            // Pushed from the top down so the lowest part is read next and output stays ascending.
+            uint16_t parts = span.count <= DUMP_SINGLE_SPAN ? span.count : 2;
+            uint16_t size = span.count / parts;
+            for (int part = parts - 1; part >= 0; part--) {
+                uint16_t part_start = span.start + part * size;
+                uint16_t part_count = part == parts - 1 ? span.count - part * size : size;
+                pending[n_pending++] = (dump_span_t){ part_start, part_count, (uint8_t)(span.depth + 1) };
+            }
+            stats->splits++;
+            errors_in_row = 0;
+            continue;
+        }
+
+        hole_end = UINT32_MAX;
+        if (result == 0) {
+            stats->registers_ok += span.count;
+            errors_in_row = 0;
+        } else {
+            stats->registers_failed += span.count;
+            if (is_exception(result)) {
+                hole_end = (uint32_t)span.start + span.count;
+                errors_in_row = 0;
+            } else {
+                stats->errors++;
+                errors_in_row++;
+            }
+        }
+
+        if (!dump->emit(dump->ctx, &out, result == 0 ? values : NULL) ||
+            errors_in_row >= MODBUS_DUMP_MAX_ERRORS) {
+            stats->aborted = true;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+// modbus_dump.h - Bulk register dump with exception bisection
+//
+// Walks an address range in reads of up to MODBUS_DUMP_MAX_BLOCK registers.
+// A read the slave answers with an exception (usually 0x02, illegal data
+// address, because the block straddles a hole in the register map) is split
+// in half and both halves retried, down to single registers, so a hole costs
+// about 2*log2(block) short reads instead of losing the whole block. Past a
+// hole's first failed register the rest of the hole is walked a register at
+// a time, since exact mapping needs one read per unmapped register anyway; a
+// coarser min_split trades exactness at hole edges for fewer reads. Transport
+// errors (timeout, CRC) are not bisected - a silent slave would only multiply
+// the wait - and after MODBUS_DUMP_MAX_ERRORS of them in a row the dump stops.
+//
+// Blocks are emitted in ascending address order as soon as they are read, so
+// the caller can stream them. Pure C with no ESP-IDF calls;
+// tests/modbus_dump_test.py runs it on the host against a simulated meter.
+
+#ifndef MODBUS_DUMP_H
+#define MODBUS_DUMP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "iot_configs.h"
+
+typedef struct {
+    uint16_t start;
+    uint16_t count;
+    int result;                   // 0, exception code (< 0x80) or transport error (modbus_result_t)
+    uint32_t ms;                  // Duration of the read that produced this block
+    uint8_t depth;                // Bisection depth, 0 = full-size read
+} modbus_dump_block_t;
+
+// Read count registers at start into values; returns a modbus_result_t value
+typedef int (*modbus_dump_read_t)(void *ctx, uint16_t start, uint16_t count, uint16_t *values);
+// values is NULL for a failed block; return false to stop the dump (client gone)
+typedef bool (*modbus_dump_emit_t)(void *ctx, const modbus_dump_block_t *block, const uint16_t *values);
+typedef uint32_t (*modbus_dump_clock_t)(void);
+
+typedef struct {
+    modbus_dump_read_t read;
+    modbus_dump_emit_t emit;
+    modbus_dump_clock_t now_ms;
+    void *ctx;
+    uint16_t block;               // Registers per read, clamped to 1..MODBUS_DUMP_MAX_BLOCK
+    uint16_t min_split;           // Failed spans this short are reported, not split (1 = exact map)
+} modbus_dump_t;
+
+typedef struct {
+    uint32_t reads;
+    uint32_t splits;              // Reads answered with an exception and bisected
+    uint32_t registers_ok;
+    uint32_t registers_failed;
+    uint32_t errors;              // Transport errors
+    uint32_t ms;                  // Total bus time
+    bool aborted;                 // Too many errors in a row, or emit() said stop
+} modbus_dump_stats_t;
+
+// Dump count registers from start (clipped at 0xFFFF); false if aborted
+bool modbus_dump_run(const modbus_dump_t *dump, uint16_t start, uint32_t count, modbus_dump_stats_t *stats);
+
+#endif // MODBUS_DUMP_H
@@ -0,0 +1,397 @@
+// mqtt_outbox.c - Asynchronous QoS 1 telemetry outbox with in-flight tracking
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "mqtt_outbox.h"
+#include "sd_card_logger.h"
+#include "telemetry_codec.h"
+#include "iot_configs.h"
+#include "perf_trace.h"
+
+static const char *TAG = "MQTT_OUTBOX";
+
+typedef enum {
+    OUTBOX_SLOT_FREE = 0,
+    OUTBOX_SLOT_IN_FLIGHT,   // Enqueued, waiting for PUBACK
+    OUTBOX_SLOT_ACKED,       // SD origin: PUBACK received, waiter releases the slot
+    OUTBOX_SLOT_LOST,        // SD origin: connection dropped, still on SD
+    OUTBOX_SLOT_SPILL        // Live: connection dropped/expired, write to SD
+} outbox_slot_state_t;
+
+typedef struct {
+    outbox_slot_state_t state;
+    int msg_id;
+    uint32_t origin;         // MQTT_OUTBOX_ORIGIN_LIVE or SD message id
+    size_t len;
+    uint8_t* payload;        // Copy kept for live messages only (spill source)
+    int64_t enqueued_ms;
+    char timestamp[32];
+    char topic[SD_CARD_TOPIC_MAX];   // Spilled to SD under this topic
+} outbox_slot_t;
+
+static outbox_slot_t slots[MQTT_OUTBOX_MAX_IN_FLIGHT];
+static SemaphoreHandle_t outbox_mutex = NULL;
+static mqtt_outbox_stats_t stats = {0};
+
+// PUBACKs that arrived before mqtt_outbox_publish() recorded the msg_id
+#define OUTBOX_EARLY_ACKS 4
+static int early_acks[OUTBOX_EARLY_ACKS] = {-1, -1, -1, -1};
+static int early_ack_index = 0;
+
+static int64_t now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+static outbox_slot_t* find_slot(int msg_id) {
+    for (int i = 0; i < MQTT_OUTBOX_MAX_IN_FLIGHT; i++) {
+        if (slots[i].state != OUTBOX_SLOT_FREE && slots[i].msg_id == msg_id) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+// Caller holds outbox_mutex
+static void release_slot(outbox_slot_t* slot) {
+    if (slot->state == OUTBOX_SLOT_IN_FLIGHT || slot->state == OUTBOX_SLOT_SPILL) {
+        stats.in_flight--;
+        stats.bytes_in_flight -= slot->len;
+    }
+    free(slot->payload);
+    memset(slot, 0, sizeof(*slot));
+}
+
+// Caller holds outbox_mutex. Live entries move to SPILL, SD-origin entries to LOST
+// (they are still on the card and will be replayed again).
+static void mark_undelivered(outbox_slot_t* slot) {
+    if (slot->state != OUTBOX_SLOT_IN_FLIGHT) {
+        return;
+    }
+    if (slot->origin == MQTT_OUTBOX_ORIGIN_LIVE) {
+        slot->state = OUTBOX_SLOT_SPILL;
+    } else {
+        stats.in_flight--;
+        stats.bytes_in_flight -= slot->len;
+        free(slot->payload);
+        slot->payload = NULL;
+        slot->state = OUTBOX_SLOT_LOST;
+    }
+}
+
+static void spill_to_sd(const char* topic, const uint8_t* payload, size_t len, const char* timestamp) {
+    // Cache lines are text: CBOR payloads go back to base64, JSON is stored as-is
+    static char line[SD_CARD_PAYLOAD_MAX];
+    esp_err_t ret;
+
+    if (telemetry_topic_is_cbor(topic)) {
+        ret = telemetry_cache_encode(payload, len, line, sizeof(line));
+    } else if (len < sizeof(line)) {
+        memcpy(line, payload, len);
+        line[len] = '\0';
+        ret = ESP_OK;
+    } else {
+        ret = ESP_ERR_INVALID_SIZE;
+    }
+
+    if (ret == ESP_OK) {
+        ret = sd_card_save_message(topic, line, timestamp);
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "[SD] Spilled unacknowledged message (%d bytes) to SD", (int)len);
+    } else {
+        ESP_LOGE(TAG, "[SD] Failed to spill unacknowledged message: %s - data lost", esp_err_to_name(ret));
+    }
+}
+
+// Spill every slot in SPILL state. SD I/O is done without holding the outbox mutex:
+// the slot is detached first so the MQTT task is never blocked on the card.
+static void spill_marked(void) {
+    for (int i = 0; i < MQTT_OUTBOX_MAX_IN_FLIGHT; i++) {
+        char topic[sizeof(slots[i].topic)];
+        char timestamp[sizeof(slots[i].timestamp)];
+        uint8_t* payload = NULL;
+        size_t len = 0;
+
+        xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+        if (slots[i].state == OUTBOX_SLOT_SPILL) {
+            strcpy(topic, slots[i].topic);
+            strcpy(timestamp, slots[i].timestamp);
+            payload = slots[i].payload;
+            len = slots[i].len;
+            slots[i].payload = NULL;
+            release_slot(&slots[i]);
+            stats.spilled++;
+        }
+        xSemaphoreGive(outbox_mutex);
+
+        if (payload) {
+            spill_to_sd(topic, payload, len, timestamp);
+            free(payload);
+        }
+    }
+}
+
+esp_err_t mqtt_outbox_init(void) {
+    if (outbox_mutex != NULL) {
+        return ESP_OK;
+    }
+    outbox_mutex = xSemaphoreCreateMutex();
+    if (outbox_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create outbox mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    memset(slots, 0, sizeof(slots));
+    ESP_LOGI(TAG, "Outbox ready: %d in flight, %d byte budget, %d ms ack timeout",
+             MQTT_OUTBOX_MAX_IN_FLIGHT, MQTT_OUTBOX_BUDGET_BYTES, MQTT_OUTBOX_ACK_TIMEOUT_MS);
+    return ESP_OK;
+}
+
+bool mqtt_outbox_has_space(size_t len) {
+    if (outbox_mutex == NULL) {
+        return false;
+    }
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    bool space = stats.in_flight < MQTT_OUTBOX_MAX_IN_FLIGHT &&
+                 stats.bytes_in_flight + len <= MQTT_OUTBOX_BUDGET_BYTES;
+    xSemaphoreGive(outbox_mutex);
+    return space;
+}
+
+int mqtt_outbox_publish(esp_mqtt_client_handle_t client, const char* topic,
+                        const void* payload, size_t len, uint32_t origin) {
+    if (outbox_mutex == NULL || client == NULL || topic == NULL || payload == NULL || len == 0) {
+        return -1;
+    }
+    if (strlen(topic) >= sizeof(slots[0].topic)) {
+        ESP_LOGE(TAG, "Topic too long for outbox: %s", topic);
+        return -1;
+    }
+
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+
+    outbox_slot_t* slot = NULL;
+    if (stats.in_flight < MQTT_OUTBOX_MAX_IN_FLIGHT &&
+        stats.bytes_in_flight + len <= MQTT_OUTBOX_BUDGET_BYTES) {
+        for (int i = 0; i < MQTT_OUTBOX_MAX_IN_FLIGHT; i++) {
+            if (slots[i].state == OUTBOX_SLOT_FREE) {
+                slot = &slots[i];
+                break;
+            }
+        }
+    }
+    if (slot == NULL) {
+        stats.rejected++;
+        xSemaphoreGive(outbox_mutex);
+        ESP_LOGW(TAG, "Outbox full (%lu in flight, %lu bytes) - caller should cache",
+                 stats.in_flight, stats.bytes_in_flight);
+        return -1;
+    }
+
+    // Live payloads are copied so they can be spilled to SD if the PUBACK never comes
+    uint8_t* copy = NULL;
+    if (origin == MQTT_OUTBOX_ORIGIN_LIVE) {
+        copy = malloc(len);
+        if (copy == NULL) {
+            stats.rejected++;
+            xSemaphoreGive(outbox_mutex);
+            ESP_LOGW(TAG, "No heap for outbox copy (%d bytes)", (int)len);
+            return -1;
+        }
+        memcpy(copy, payload, len);
+    }
+
+    // Reserve the slot, then enqueue without holding the mutex: the MQTT task
+    // dispatches PUBLISHED events under the client lock that enqueue() also takes
+    time_t now = time(NULL);
+    struct tm timeinfo;
+    gmtime_r(&now, &timeinfo);
+    strftime(slot->timestamp, sizeof(slot->timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
+    strcpy(slot->topic, topic);
+    slot->state = OUTBOX_SLOT_IN_FLIGHT;
+    slot->msg_id = -1;
+    slot->origin = origin;
+    slot->len = len;
+    slot->payload = copy;
+    slot->enqueued_ms = now_ms();
+    stats.in_flight++;
+    stats.bytes_in_flight += len;
+    xSemaphoreGive(outbox_mutex);
+
+    // enqueue() only copies into the client's outbox - the MQTT task does the
+    // network write, so the acquisition path never blocks on the link
+    int msg_id = esp_mqtt_client_enqueue(client, topic, (const char*)payload, len, 1, 0, true);
+
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    if (slot->state == OUTBOX_SLOT_FREE || slot->msg_id != -1) {
+        // Released by mqtt_outbox_spill_all() while enqueuing - already on SD
+    } else if (msg_id < 0) {
+        release_slot(slot);
+        stats.rejected++;
+    } else if (slot->state == OUTBOX_SLOT_IN_FLIGHT) {
+        slot->msg_id = msg_id;
+        stats.enqueued++;
+        // PUBACK may already have been processed before the id was recorded
+        for (int i = 0; i < OUTBOX_EARLY_ACKS; i++) {
+            if (early_acks[i] == msg_id) {
+                early_acks[i] = -1;
+                xSemaphoreGive(outbox_mutex);
+                mqtt_outbox_on_published(msg_id);
+                return msg_id;
+            }
+        }
+    } else {
+        // Disconnect raced the enqueue: the slot was already marked for spill/loss
+        slot->msg_id = msg_id;
+        stats.enqueued++;
+    }
+    xSemaphoreGive(outbox_mutex);
+
+    return msg_id;
+}
+
+void mqtt_outbox_on_published(int msg_id) {
+    if (outbox_mutex == NULL) {
+        return;
+    }
+    int64_t enqueued_ms = -1;
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    outbox_slot_t* slot = find_slot(msg_id);
+    if (slot != NULL && (slot->state == OUTBOX_SLOT_IN_FLIGHT || slot->state == OUTBOX_SLOT_SPILL)) {
+        // A PUBACK that beats the spill (resend after reconnect) cancels it
+        stats.acked++;
+        enqueued_ms = slot->enqueued_ms;
+        if (slot->origin == MQTT_OUTBOX_ORIGIN_LIVE) {
+            release_slot(slot);
+        } else {
+            stats.in_flight--;
+            stats.bytes_in_flight -= slot->len;
+            slot->state = OUTBOX_SLOT_ACKED;
+        }
+    } else if (slot == NULL) {
+        // Either not ours (twin report) or a publish still recording its msg_id
+        early_acks[early_ack_index] = msg_id;
+        early_ack_index = (early_ack_index + 1) % OUTBOX_EARLY_ACKS;
+    }
+    xSemaphoreGive(outbox_mutex);
+
+    if (enqueued_ms >= 0) {
+        perf_span(PERF_MQTT_PUBACK, enqueued_ms * 1000, esp_timer_get_time());
+    }
+}
+
+void mqtt_outbox_on_deleted(int msg_id) {
+    // Only reported with CONFIG_MQTT_REPORT_DELETED_MESSAGES; otherwise expiry is
+    // caught by the ack timeout in mqtt_outbox_service()
+    if (outbox_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    outbox_slot_t* slot = find_slot(msg_id);
+    if (slot != NULL) {
+        ESP_LOGW(TAG, "msg_id=%d expired in MQTT outbox without PUBACK", msg_id);
+        mark_undelivered(slot);
+    }
+    xSemaphoreGive(outbox_mutex);
+}
+
+void mqtt_outbox_on_disconnected(void) {
+    if (outbox_mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    int marked = 0;
+    for (int i = 0; i < MQTT_OUTBOX_MAX_IN_FLIGHT; i++) {
+        if (slots[i].state == OUTBOX_SLOT_IN_FLIGHT) {
+            mark_undelivered(&slots[i]);
+            marked++;
+        }
+    }
+    xSemaphoreGive(outbox_mutex);
+
+    if (marked > 0) {
+        ESP_LOGW(TAG, "Disconnected with %d unacknowledged messages - spilling to SD", marked);
+    }
+}
+
+void mqtt_outbox_service(void) {
+    if (outbox_mutex == NULL) {
+        return;
+    }
+
+    // The client's own outbox drops unacknowledged messages after its expiry
+    // timeout, so anything older than that will never be acknowledged
+    int64_t now = now_ms();
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    for (int i = 0; i < MQTT_OUTBOX_MAX_IN_FLIGHT; i++) {
+        if (slots[i].state == OUTBOX_SLOT_IN_FLIGHT &&
+            slots[i].origin == MQTT_OUTBOX_ORIGIN_LIVE &&
+            now - slots[i].enqueued_ms > MQTT_OUTBOX_ACK_TIMEOUT_MS) {
+            ESP_LOGW(TAG, "No PUBACK for msg_id=%d after %lld ms", slots[i].msg_id,
+                     (long long)(now - slots[i].enqueued_ms));
+            mark_undelivered(&slots[i]);
+        }
+    }
+    xSemaphoreGive(outbox_mutex);
+
+    spill_marked();
+}
+
+void mqtt_outbox_spill_all(void) {
+    if (outbox_mutex == NULL) {
+        return;
+    }
+    mqtt_outbox_on_disconnected();
+    spill_marked();
+
+    // SD-origin slots have no waiter once the client is gone
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    for (int i = 0; i < MQTT_OUTBOX_MAX_IN_FLIGHT; i++) {
+        if (slots[i].state == OUTBOX_SLOT_LOST || slots[i].state == OUTBOX_SLOT_ACKED) {
+            release_slot(&slots[i]);
+        }
+    }
+    xSemaphoreGive(outbox_mutex);
+}
+
+bool mqtt_outbox_wait_acked(int msg_id, uint32_t timeout_ms) {
+    if (outbox_mutex == NULL) {
+        return false;
+    }
+
+    int64_t deadline = now_ms() + timeout_ms;
+    while (1) {
+        xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+        outbox_slot_t* slot = find_slot(msg_id);
+        outbox_slot_state_t state = slot ? slot->state : OUTBOX_SLOT_FREE;
+        bool done = (state != OUTBOX_SLOT_IN_FLIGHT) || now_ms() >= deadline;
+        if (done && slot != NULL) {
+            release_slot(slot);
+        }
+        xSemaphoreGive(outbox_mutex);
+
+        if (done) {
+            return state == OUTBOX_SLOT_ACKED;
+        }
+        vTaskDelay(pdMS_TO_TICKS(50));
+    }
+}
+
+void mqtt_outbox_get_stats(mqtt_outbox_stats_t* out) {
+    if (out == NULL) {
+        return;
+    }
+    if (outbox_mutex == NULL) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    xSemaphoreTake(outbox_mutex, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(outbox_mutex);
+}
@@ -0,0 +1,60 @@
+// mqtt_outbox.h - Asynchronous QoS 1 telemetry outbox over esp_mqtt_client_enqueue()
+//
+// Every telemetry publish is enqueued (never sent from the caller's context) and
+// tracked by msg_id until its PUBACK arrives. The in-flight window and the RAM
+// held by payload copies are both bounded; when either is exhausted the caller
+// caches to SD like any other offline reading. Messages still unacknowledged
+// when the connection drops (or the client is destroyed) are spilled to the SD
+// journal, so delivery is at-least-once end to end.
+
+#ifndef MQTT_OUTBOX_H
+#define MQTT_OUTBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "mqtt_client.h"
+
+// Origin of an outbox entry. Live messages are spilled to SD when they cannot be
+// delivered; SD-origin messages are already on the card and are only removed from
+// it after their PUBACK (see mqtt_outbox_wait_acked()).
+#define MQTT_OUTBOX_ORIGIN_LIVE 0
+
+typedef struct {
+    uint32_t in_flight;        // Enqueued, waiting for PUBACK
+    uint32_t bytes_in_flight;  // Payload bytes held by in-flight entries
+    uint32_t enqueued;         // Total accepted by the outbox
+    uint32_t acked;            // Total PUBACKs received
+    uint32_t spilled;          // Live messages written to SD after a disconnect
+    uint32_t rejected;         // Refused (window full / over budget / client error)
+} mqtt_outbox_stats_t;
+
+esp_err_t mqtt_outbox_init(void);
+
+// Enqueue a QoS 1 publish. origin is MQTT_OUTBOX_ORIGIN_LIVE or the SD message id.
+// Returns the MQTT msg_id, or -1 if the window/budget is full or the client refused
+// it - the caller keeps ownership of the data and should cache it instead.
+int mqtt_outbox_publish(esp_mqtt_client_handle_t client, const char* topic,
+                        const void* payload, size_t len, uint32_t origin);
+
+// MQTT event hooks (called from mqtt_event_handler)
+void mqtt_outbox_on_published(int msg_id);
+void mqtt_outbox_on_deleted(int msg_id);
+void mqtt_outbox_on_disconnected(void);
+
+// Write live entries marked by a disconnect/expiry to SD and release them.
+// Runs in the telemetry task so SD I/O never happens in the MQTT task.
+void mqtt_outbox_service(void);
+
+// Spill every outstanding entry now - call before destroying the MQTT client,
+// since a new client restarts msg_id numbering.
+void mqtt_outbox_spill_all(void);
+
+// Block until msg_id is acknowledged (true) or lost/timed out (false)
+bool mqtt_outbox_wait_acked(int msg_id, uint32_t timeout_ms);
+
+bool mqtt_outbox_has_space(size_t len);
+void mqtt_outbox_get_stats(mqtt_outbox_stats_t* stats);
+
+#endif // MQTT_OUTBOX_H
@@ -0,0 +1,234 @@
+// mqtt_tls_transport.c - esp-tls transport with cached client session
+
+#include <string.h>
+#include <stdlib.h>
+#include <sys/select.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_tls.h"
+#include "esp_crt_bundle.h"
+#include "sdkconfig.h"
+#include "mqtt_tls_transport.h"
+#include "net_cache.h"
+
+static const char *TAG = "MQTT_TLS";
+
+typedef struct {
+    esp_tls_t* tls;
+} tls_transport_ctx_t;
+
+static mqtt_tls_stats_t stats = {0};
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+// Only touched from the MQTT task (connect/close)
+static esp_tls_client_session_t* cached_session = NULL;
+
+static void drop_cached_session(void) {
+    if (cached_session != NULL) {
+        esp_tls_free_client_session(cached_session);
+        cached_session = NULL;
+    }
+    stats.session_cached = false;
+}
+
+// TLS 1.2 sessions are available right after the handshake; TLS 1.3 tickets
+// arrive afterwards, so this is called again before the connection is closed
+static void save_session(esp_tls_t* tls) {
+    esp_tls_client_session_t* session = esp_tls_get_client_session(tls);
+    if (session != NULL) {
+        drop_cached_session();
+        cached_session = session;
+        stats.session_cached = true;
+    }
+}
+#endif
+
+static int tls_poll(esp_transport_handle_t t, int timeout_ms, bool for_write) {
+    tls_transport_ctx_t* ctx = esp_transport_get_context_data(t);
+    if (ctx == NULL || ctx->tls == NULL) {
+        return -1;
+    }
+    // Decrypted bytes already buffered by mbedTLS do not show up on the socket
+    if (!for_write && esp_tls_get_bytes_avail(ctx->tls) > 0) {
+        return 1;
+    }
+
+    int sockfd;
+    if (esp_tls_get_conn_sockfd(ctx->tls, &sockfd) != ESP_OK || sockfd < 0) {
+        return -1;
+    }
+
+    fd_set ioset, errset;
+    FD_ZERO(&ioset);
+    FD_ZERO(&errset);
+    FD_SET(sockfd, &ioset);
+    FD_SET(sockfd, &errset);
+
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000,
+    };
+    int ret = select(sockfd + 1, for_write ? NULL : &ioset, for_write ? &ioset : NULL, &errset,
+                     timeout_ms >= 0 ? &timeout : NULL);
+    if (ret > 0 && FD_ISSET(sockfd, &errset)) {
+        ESP_LOGW(TAG, "Socket error on poll");
+        return -1;
+    }
+    return ret;
+}
+
+static int tls_poll_read(esp_transport_handle_t t, int timeout_ms) {
+    return tls_poll(t, timeout_ms, false);
+}
+
+static int tls_poll_write(esp_transport_handle_t t, int timeout_ms) {
+    return tls_poll(t, timeout_ms, true);
+}
+
+static int tls_close(esp_transport_handle_t t) {
+    tls_transport_ctx_t* ctx = esp_transport_get_context_data(t);
+    if (ctx == NULL || ctx->tls == NULL) {
+        return 0;
+    }
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    save_session(ctx->tls);
+#endif
+    esp_tls_conn_destroy(ctx->tls);
+    ctx->tls = NULL;
+    return 0;
+}
+
+static int tls_connect(esp_transport_handle_t t, const char* host, int port, int timeout_ms) {
+    tls_transport_ctx_t* ctx = esp_transport_get_context_data(t);
+    tls_close(t);
+
+    // Resolved through the shared cache: reconnects skip the DNS round trip,
+    // and while DNS is failing the connect fails here without a TLS attempt
+    ip4_addr_t addr;
+    if (net_dns_resolve(host, &addr) != ESP_OK) {
+        ESP_LOGW(TAG, "%s does not resolve", host);
+        return -1;
+    }
+    char addr_str[16];
+    ip4addr_ntoa_r(&addr, addr_str, sizeof(addr_str));
+
+    ctx->tls = esp_tls_init();
+    if (ctx->tls == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate TLS context");
+        return -1;
+    }
+
+    esp_tls_cfg_t cfg = {
+        .crt_bundle_attach = esp_crt_bundle_attach,
+        .timeout_ms = timeout_ms,
+        .common_name = host,      // SNI and certificate check - the connect goes to addr_str
+    };
+
+    bool offered = false;
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    cfg.client_session = cached_session;
+    offered = (cached_session != NULL);
+#endif
+
+    int64_t start_ms = esp_timer_get_time() / 1000;
+    if (esp_tls_conn_new_sync(addr_str, strlen(addr_str), port, &cfg, ctx->tls) <= 0) {
+        stats.failures++;
+        ESP_LOGW(TAG, "TLS handshake with %s:%d failed%s", host, port,
+                 offered ? " - dropping cached session" : "");
+        esp_tls_conn_destroy(ctx->tls);
+        ctx->tls = NULL;
+        net_dns_forget(host);
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        // A stale session must not keep the next attempt from doing a full handshake
+        if (offered) {
+            drop_cached_session();
+        }
+#endif
+        return -1;
+    }
+
+    stats.handshakes++;
+    stats.last_handshake_ms = (uint32_t)(esp_timer_get_time() / 1000 - start_ms);
+    if (offered) {
+        stats.resumed_offers++;
+    }
+    ESP_LOGI(TAG, "TLS connected to %s in %lu ms (%s)", host, stats.last_handshake_ms,
+             offered ? "session offered" : "full handshake");
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    save_session(ctx->tls);
+#endif
+    return 0;
+}
+
+static int tls_read(esp_transport_handle_t t, char* buffer, int len, int timeout_ms) {
+    tls_transport_ctx_t* ctx = esp_transport_get_context_data(t);
+    int poll = tls_poll_read(t, timeout_ms);
+    if (poll <= 0) {
+        return poll;  // 0 = timeout, -1 = error (same contract as the SSL transport)
+    }
+
+    ssize_t ret = esp_tls_conn_read(ctx->tls, (unsigned char*)buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+        return ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT;
+    }
+    if (ret == 0) {
+        return ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN;
+    }
+    if (ret < 0) {
+        ESP_LOGW(TAG, "TLS read error: -0x%x", (unsigned int)-ret);
+        return ERR_TCP_TRANSPORT_CONNECTION_FAILED;
+    }
+    return ret;
+}
+
+static int tls_write(esp_transport_handle_t t, const char* buffer, int len, int timeout_ms) {
+    tls_transport_ctx_t* ctx = esp_transport_get_context_data(t);
+    int poll = tls_poll_write(t, timeout_ms);
+    if (poll <= 0) {
+        return poll;
+    }
+
+    ssize_t ret = esp_tls_conn_write(ctx->tls, (const unsigned char*)buffer, len);
+    if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+        return 0;
+    }
+    if (ret < 0) {
+        ESP_LOGW(TAG, "TLS write error: -0x%x", (unsigned int)-ret);
+        return -1;
+    }
+    return ret;
+}
+
+static int tls_destroy(esp_transport_handle_t t) {
+    tls_close(t);
+    free(esp_transport_get_context_data(t));
+    return 0;
+}
+
+esp_transport_handle_t mqtt_tls_transport_create(void) {
+    esp_transport_handle_t t = esp_transport_init();
+    if (t == NULL) {
+        return NULL;
+    }
+    tls_transport_ctx_t* ctx = calloc(1, sizeof(tls_transport_ctx_t));
+    if (ctx == NULL) {
+        esp_transport_destroy(t);
+        return NULL;
+    }
+    esp_transport_set_context_data(t, ctx);
+    esp_transport_set_func(t, tls_connect, tls_read, tls_write, tls_close,
+                           tls_poll_read, tls_poll_write, tls_destroy);
+    esp_transport_set_default_port(t, 8883);
+
+#ifndef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    ESP_LOGW(TAG, "CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS disabled - every reconnect is a full handshake");
+#endif
+    return t;
+}
+
+void mqtt_tls_transport_get_stats(mqtt_tls_stats_t* out) {
+    if (out != NULL) {
+        *out = stats;
+    }
+}
@@ -0,0 +1,34 @@
+// mqtt_tls_transport.h - esp-tls transport for the Azure MQTT client with TLS
+// session resumption
+//
+// esp-mqtt's built-in SSL transport does a full handshake on every reconnect.
+// This transport keeps the client session (ticket / session ID) from the last
+// successful handshake and offers it on the next connect, so reconnects on
+// cellular links cost one round trip and a few hundred bytes instead of the
+// full certificate exchange. Requires CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS;
+// without it the transport behaves like the stock SSL transport.
+
+#ifndef MQTT_TLS_TRANSPORT_H
+#define MQTT_TLS_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_transport.h"
+
+typedef struct {
+    uint32_t handshakes;          // Successful TLS handshakes
+    uint32_t resumed_offers;      // Handshakes that offered a cached session
+    uint32_t failures;            // Failed handshakes
+    uint32_t last_handshake_ms;   // Duration of the most recent handshake
+    bool session_cached;          // A session is available for the next connect
+} mqtt_tls_stats_t;
+
+// Create a transport for esp_mqtt_client_config_t.network.transport.
+// esp-mqtt takes ownership and destroys it with the client; the cached
+// session is module state and survives client re-creation.
+esp_transport_handle_t mqtt_tls_transport_create(void);
+
+void mqtt_tls_transport_get_stats(mqtt_tls_stats_t* stats);
+
+#endif // MQTT_TLS_TRANSPORT_H
@@ -0,0 +1,287 @@
+// net_cache.c - DNS cache and keep-alive HTTPS connections for fixed endpoints
+
+#include "net_cache.h"
+#include "iot_configs.h"
+#include <string.h>
+#include <strings.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/dns.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include "lwip_hooks.h"        // After lwip/dns.h - declares the DNS hook
+#include "sdkconfig.h"
+
+static const char *TAG = "NET_CACHE";
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ── DNS cache ────────────────────────────────────────────────────────
+
+typedef struct {
+    char host[64];
+    ip4_addr_t addr;
+    int64_t expires_us;
+    bool ok;                      // false = negative entry (lookup failed)
+} dns_entry_t;
+
+static dns_entry_t s_dns[NET_DNS_CACHE_SIZE];
+
+// 1 = cached address, -1 = cached failure, 0 = not cached or expired.
+// Also runs in the tcpip thread from the lwIP hook, so it only copies.
+static int dns_lookup(const char *host, ip4_addr_t *addr)
+{
+    int64_t now = esp_timer_get_time();
+    int hit = 0;
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < NET_DNS_CACHE_SIZE; i++) {
+        if (s_dns[i].host[0] && s_dns[i].expires_us > now && strcasecmp(s_dns[i].host, host) == 0) {
+            hit = s_dns[i].ok ? 1 : -1;
+            *addr = s_dns[i].addr;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return hit;
+}
+
+static void dns_store(const char *host, const ip4_addr_t *addr, bool ok)
+{
+    if (strlen(host) >= sizeof(s_dns[0].host)) return;
+    int64_t now = esp_timer_get_time();
+    int64_t ttl_s = ok ? NET_DNS_TTL_S : NET_DNS_NEG_TTL_S;
+
+    portENTER_CRITICAL(&s_lock);
+    // Same host, else the entry that expires first
+    int slot = 0;
+    for (int i = 0; i < NET_DNS_CACHE_SIZE; i++) {
+        if (strcasecmp(s_dns[i].host, host) == 0) { slot = i; break; }
+        if (s_dns[i].expires_us < s_dns[slot].expires_us) slot = i;
+    }
+    strcpy(s_dns[slot].host, host);
+    s_dns[slot].addr = ok ? *addr : (ip4_addr_t){0};
+    s_dns[slot].expires_us = now + ttl_s * 1000000;
+    s_dns[slot].ok = ok;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+esp_err_t net_dns_resolve(const char *host, ip4_addr_t *addr)
+{
+    if (host == NULL || host[0] == '\0') return ESP_ERR_INVALID_ARG;
+    if (ip4addr_aton(host, addr)) return ESP_OK;
+
+    int hit = dns_lookup(host, addr);
+    if (hit != 0) {
+        ESP_LOGD(TAG, "DNS %s: cached %s", host, hit > 0 ? "address" : "failure");
+        return hit > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+    }
+
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    int64_t start = esp_timer_get_time();
+    int ret = getaddrinfo(host, NULL, &hints, &res);
+    if (ret != 0 || res == NULL) {
+        ESP_LOGW(TAG, "DNS %s failed (%d) - cached for %ds", host, ret, NET_DNS_NEG_TTL_S);
+        dns_store(host, NULL, false);
+        return ESP_ERR_NOT_FOUND;
+    }
+    const struct sockaddr_in *sin = (const struct sockaddr_in *)res->ai_addr;
+    inet_addr_to_ip4addr(addr, &sin->sin_addr);
+    freeaddrinfo(res);
+
+    dns_store(host, addr, true);
+    char ip_str[16];
+    ESP_LOGI(TAG, "DNS %s -> %s (%d ms)", host, ip4addr_ntoa_r(addr, ip_str, sizeof(ip_str)),
+             (int)((esp_timer_get_time() - start) / 1000));
+    return ESP_OK;
+}
+
+void net_dns_forget(const char *host)
+{
+    portENTER_CRITICAL(&s_lock);
+    for (int i = 0; i < NET_DNS_CACHE_SIZE; i++) {
+        if (strcasecmp(s_dns[i].host, host) == 0) {
+            s_dns[i].host[0] = '\0';
+            s_dns[i].expires_us = 0;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+#ifdef CONFIG_LWIP_HOOK_DNS_EXT_RESOLVE_CUSTOM
+// Called by dns_gethostbyname() before it queries a server. Returning 1 means
+// handled: *err is the result and *addr the address for ERR_OK. Only cached
+// addresses are served - failures stay with net_dns_resolve(), so a lookup
+// after the link comes back always reaches the server.
+int lwip_hook_dns_external_resolve(const char *name, ip_addr_t *addr, dns_found_callback found,
+                                   void *callback_arg, u8_t addrtype, err_t *err)
+{
+    (void)found;
+    (void)callback_arg;
+#if LWIP_IPV6
+    if (addrtype == LWIP_DNS_ADDRTYPE_IPV6) return 0;   // Only IPv4 answers are cached
+#else
+    (void)addrtype;
+#endif
+    ip4_addr_t a;
+    if (dns_lookup(name, &a) <= 0) return 0;
+    ip_addr_copy_from_ip4(*addr, a);
+    *err = ERR_OK;
+    return 1;
+}
+#endif
+
+bool net_url_host(const char *url, char *host, size_t host_size)
+{
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    const char *at = NULL;
+    const char *end = p;
+    while (*end && *end != '/' && *end != '?' && *end != '#') {
+        if (*end == '@') at = end;
+        end++;
+    }
+    if (at) p = at + 1;
+    // Port, unless the host is a bracketed IPv6 literal
+    const char *colon = NULL;
+    if (*p != '[') {
+        for (const char *c = p; c < end; c++) {
+            if (*c == ':') { colon = c; break; }
+        }
+    }
+    if (colon) end = colon;
+    size_t n = (size_t)(end - p);
+    if (n == 0 || n >= host_size) return false;
+    memcpy(host, p, n);
+    host[n] = '\0';
+    return true;
+}
+
+// ── Connection pool ──────────────────────────────────────────────────
+
+typedef struct {
+    esp_http_client_handle_t client;
+    char host[64];
+    int64_t last_used_us;
+    bool in_use;
+    bool open;                    // Connection may still be open
+} pool_slot_t;
+
+static pool_slot_t s_pool[NET_POOL_COUNT];
+
+esp_http_client_handle_t net_pool_acquire(net_pool_id_t id, const esp_http_client_config_t *config)
+{
+    char host[64];
+    ip4_addr_t addr;
+    if (id >= NET_POOL_COUNT || !net_url_host(config->url, host, sizeof(host))) {
+        return NULL;
+    }
+    if (net_dns_resolve(host, &addr) != ESP_OK) {
+        return NULL;
+    }
+
+    pool_slot_t *slot = &s_pool[id];
+    bool own = false;
+    portENTER_CRITICAL(&s_lock);
+    if (!slot->in_use) {
+        slot->in_use = true;
+        own = true;
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (own && slot->client) {
+        esp_http_client_handle_t c = slot->client;
+        // set_url() closes the connection itself if the host changed
+        if (esp_http_client_set_url(c, config->url) == ESP_OK) {
+            esp_http_client_set_method(c, config->method);
+            esp_http_client_set_timeout_ms(c, config->timeout_ms ? config->timeout_ms : 5000);
+            esp_http_client_set_post_field(c, NULL, 0);
+            strcpy(slot->host, host);
+            ESP_LOGD(TAG, "Pool %d: reusing %s connection to %s", (int)id,
+                     slot->open ? "open" : "closed", host);
+            return c;
+        }
+        esp_http_client_cleanup(c);
+        slot->client = NULL;
+    }
+
+    esp_http_client_config_t cfg = *config;
+    cfg.keep_alive_enable = true;
+#if CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    cfg.save_client_session = true;
+#endif
+    esp_http_client_handle_t c = esp_http_client_init(&cfg);
+
+    if (own) {
+        if (c) {
+            slot->client = c;
+            slot->open = false;
+            strcpy(slot->host, host);
+        } else {
+            portENTER_CRITICAL(&s_lock);
+            slot->in_use = false;
+            portEXIT_CRITICAL(&s_lock);
+        }
+    } else {
+        // Another task holds the pooled client - this one is not kept
+        ESP_LOGD(TAG, "Pool %d busy - one-off client", (int)id);
+    }
+    return c;
+}
+
+void net_pool_release(net_pool_id_t id, esp_http_client_handle_t client, bool ok)
+{
+    if (client == NULL) return;
+    if (id >= NET_POOL_COUNT || client != s_pool[id].client) {
+        esp_http_client_cleanup(client);
+        return;
+    }
+
+    pool_slot_t *slot = &s_pool[id];
+    if (!ok) {
+        esp_http_client_close(client);
+        net_dns_forget(slot->host);
+    }
+    slot->open = ok;
+    slot->last_used_us = esp_timer_get_time();
+    portENTER_CRITICAL(&s_lock);
+    slot->in_use = false;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void net_pool_sweep(bool low_heap)
+{
+    int64_t now = esp_timer_get_time();
+
+    for (int i = 0; i < NET_POOL_COUNT; i++) {
+        pool_slot_t *slot = &s_pool[i];
+        esp_http_client_handle_t to_free = NULL;
+        bool to_close = false;
+
+        portENTER_CRITICAL(&s_lock);
+        if (slot->client && !slot->in_use) {
+            int64_t idle_ms = (now - slot->last_used_us) / 1000;
+            if (low_heap || idle_ms >= NET_POOL_SESSION_MS) {
+                to_free = slot->client;
+                slot->client = NULL;
+            } else if (slot->open && idle_ms >= NET_POOL_IDLE_MS) {
+                to_close = true;
+                slot->in_use = true;
+            }
+        }
+        portEXIT_CRITICAL(&s_lock);
+
+        if (to_free) {
+            ESP_LOGI(TAG, "Pool %d: freeing idle client%s", i, low_heap ? " (low heap)" : "");
+            esp_http_client_cleanup(to_free);
+        } else if (to_close) {
+            // Keeps the handle and its TLS session for a resumed handshake
+            esp_http_client_close(slot->client);
+            slot->open = false;
+            portENTER_CRITICAL(&s_lock);
+            slot->in_use = false;
+            portEXIT_CRITICAL(&s_lock);
+        }
+    }
+}
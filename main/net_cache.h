@@ -0,0 +1,63 @@
+// net_cache.h - DNS cache and keep-alive HTTPS connections for fixed endpoints
+//
+// DNS: answers are kept for NET_DNS_TTL_S and failures for NET_DNS_NEG_TTL_S.
+// Cached answers also sit behind lwIP's external-resolve hook
+// (CONFIG_LWIP_HOOK_DNS_EXT_RESOLVE_CUSTOM), so every getaddrinfo() - esp-tls,
+// esp_http_client, MQTT - is answered from it once a name has been resolved
+// through net_dns_resolve(). Failures are only served by net_dns_resolve():
+// its callers fail at once during an outage instead of each waiting out the
+// DNS timeout, while plain lwIP lookups are never blocked by a stale failure.
+//
+// Pool: one esp_http_client per endpoint in net_pool_id_t (the Telegram slot
+// only with CONFIG_GATEWAY_TELEGRAM_BOT), with keep-alive and the TLS session
+// saved. Back-to-back requests reuse the open connection; after
+// NET_POOL_IDLE_MS the socket is closed but the handle (and its TLS session)
+// is kept, so the next request resumes the session instead of doing a full
+// handshake. net_pool_sweep() enforces both limits and frees everything idle
+// when heap is low.
+
+#ifndef NET_CACHE_H
+#define NET_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "esp_http_client.h"
+#include "lwip/ip4_addr.h"
+
+typedef enum {
+#ifdef CONFIG_GATEWAY_TELEGRAM_BOT
+    NET_POOL_TELEGRAM,            // api.telegram.org
+#endif
+    NET_POOL_COORD,               // WireGuard panel registration (HTTPS)
+    NET_POOL_COUNT
+} net_pool_id_t;
+
+// Resolve host to an IPv4 address through the cache. IP literals are returned
+// as is. ESP_ERR_NOT_FOUND if the name does not resolve (or failed recently).
+esp_err_t net_dns_resolve(const char *host, ip4_addr_t *addr);
+
+// Drop a cached answer, e.g. after a connection to it failed
+void net_dns_forget(const char *host);
+
+// Copy the host part of an http(s) URL. Returns false if there is none.
+bool net_url_host(const char *url, char *host, size_t host_size);
+
+// Client for one request to endpoint id. config is used when a new client has
+// to be created (keep_alive_enable and save_client_session are forced on);
+// a pooled client gets config's url, method and timeout. Headers set on a
+// pooled client stay set. Returns NULL if the host does not resolve or the
+// client could not be created. Always pair with net_pool_release().
+esp_http_client_handle_t net_pool_acquire(net_pool_id_t id, const esp_http_client_config_t *config);
+
+// Return a client from net_pool_acquire(). ok=false after a transport error:
+// the connection is closed and the host is resolved again next time.
+void net_pool_release(net_pool_id_t id, esp_http_client_handle_t client, bool ok);
+
+// Close connections idle for NET_POOL_IDLE_MS and free clients idle for
+// NET_POOL_SESSION_MS; with low_heap, free every idle client.
+// Called from the memory monitor.
+void net_pool_sweep(bool low_heap);
+
+#endif // NET_CACHE_H
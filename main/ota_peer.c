@@ -0,0 +1,605 @@
+// ota_peer.c - Firmware images shared between gateways on a site (see ota_peer.h)
+
+#include "ota_peer.h"
+#include "iot_configs.h"
+#include "sd_card_logger.h"
+#include "wireguard_client.h"
+
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_http_client.h"
+#include "nvs.h"
+#include "cJSON.h"
+#include "mbedtls/sha256.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static const char *TAG = "OTA_PEER";
+
+#define NVS_PEER_NAMESPACE "ota_peer"
+#define NVS_KEY_INSTALLED  "installed"
+
+#define PEER_MAX_HOSTS     4
+
+// What is staged on SD, loaded from OTA_PEER_INFO_PATH on first use
+static ota_peer_image_t s_staged;
+static bool s_staged_valid = false;
+static bool s_staged_loaded = false;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_serving = false;             // An image transfer has the file open (serve_task)
+
+static ota_peer_image_t s_note;            // Image the stage task copies
+static bool s_staging = false;
+
+static char s_manifest_buf[256];           // Peer manifest response (download task only)
+
+bool ota_peer_parse_sha256(const char *hex, uint8_t sha256[32])
+{
+    if (hex == NULL || strlen(hex) != 64) {
+        return false;
+    }
+    for (int i = 0; i < 32; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1) {
+            return false;
+        }
+        sha256[i] = (uint8_t)byte;
+    }
+    return true;
+}
+
+static void sha256_to_hex(const uint8_t sha256[32], char hex[65])
+{
+    for (int i = 0; i < 32; i++) {
+        sprintf(hex + i * 2, "%02x", sha256[i]);
+    }
+}
+
+// Copy of the staged image record; false if nothing is staged
+static bool staged_get(ota_peer_image_t *out)
+{
+    if (!s_staged_loaded && !s_staging && sd_card_is_available() && sd_card_acquire_mutex() == ESP_OK) {
+        ota_peer_image_t img = {0};
+        bool valid = false;
+        FILE *f = fopen(OTA_PEER_INFO_PATH, "r");
+        if (f) {
+            char line[80];
+            unsigned long size = 0;
+            struct stat st;
+            if (fgets(img.version, sizeof(img.version), f) && fgets(line, sizeof(line), f) &&
+                sscanf(line, "%lu", &size) == 1 && fgets(line, sizeof(line), f)) {
+                img.version[strcspn(img.version, "\r\n")] = '\0';
+                line[strcspn(line, "\r\n")] = '\0';
+                img.size = size;
+                valid = ota_peer_parse_sha256(line, img.sha256) &&
+                        stat(OTA_PEER_IMAGE_PATH, &st) == 0 && st.st_size == (off_t)img.size;
+            }
+            fclose(f);
+        }
+        sd_card_release_mutex();
+
+        taskENTER_CRITICAL(&s_lock);
+        s_staged = img;
+        s_staged_valid = valid;
+        s_staged_loaded = true;
+        taskEXIT_CRITICAL(&s_lock);
+        if (valid) {
+            ESP_LOGI(TAG, "Serving staged firmware v%s (%lu bytes) to peers", img.version, img.size);
+        }
+    }
+
+    taskENTER_CRITICAL(&s_lock);
+    bool valid = s_staged_valid;
+    if (valid) {
+        *out = s_staged;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return valid;
+}
+
+static void staged_set(const ota_peer_image_t *img)
+{
+    taskENTER_CRITICAL(&s_lock);
+    if (img) {
+        s_staged = *img;
+    }
+    s_staged_valid = img != NULL;
+    s_staged_loaded = true;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+// Stop serving the staged image and wait until a running transfer has closed
+// it; serve_begin() refuses new transfers from here on
+static void staged_retire(void)
+{
+    staged_set(NULL);
+    for (;;) {
+        taskENTER_CRITICAL(&s_lock);
+        bool serving = s_serving;
+        taskEXIT_CRITICAL(&s_lock);
+        if (!serving) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+// ============================================================================
+// STAGING
+// ============================================================================
+
+static bool note_load(ota_peer_image_t *img)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_PEER_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(*img);
+    esp_err_t err = nvs_get_blob(nvs, NVS_KEY_INSTALLED, img, &len);
+    nvs_close(nvs);
+    return err == ESP_OK && len == sizeof(*img);
+}
+
+static void note_clear(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_PEER_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        if (nvs_erase_key(nvs, NVS_KEY_INSTALLED) == ESP_OK) {
+            nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+}
+
+void ota_peer_note_installed(const char *version, uint32_t size, const uint8_t sha256[32])
+{
+    ota_peer_image_t img = {0};
+    strncpy(img.version, version ? version : "unknown", sizeof(img.version) - 1);
+    img.size = size;
+    memcpy(img.sha256, sha256, sizeof(img.sha256));
+
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_PEER_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_set_blob(nvs, NVS_KEY_INSTALLED, &img, sizeof(img));
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+}
+
+static bool write_info(const ota_peer_image_t *img)
+{
+    char hex[65];
+    sha256_to_hex(img->sha256, hex);
+    FILE *f = fopen(OTA_PEER_INFO_PATH, "w");
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = fprintf(f, "%s\n%lu\n%s\n", img->version, (unsigned long)img->size, hex) > 0;
+    return fclose(f) == 0 && ok;
+}
+
+// Copy the running partition to SD, hashing as it goes. The SD mutex is only
+// held per chunk so logging carries on meanwhile. The copy goes to
+// OTA_PEER_TEMP_PATH while the old image is still served, and is swapped in
+// once no transfer has the old one open.
+static void ota_stage_task(void *pvParameter)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    uint8_t *buf = malloc(OTA_PEER_STAGE_CHUNK);
+    FILE *f = NULL;
+    bool ok = false;
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+
+    if (buf == NULL || running == NULL || s_note.size == 0 || s_note.size > running->size) {
+        ESP_LOGW(TAG, "Cannot stage firmware v%s", s_note.version);
+        goto done;
+    }
+
+    if (sd_card_acquire_mutex() != ESP_OK) {
+        goto done;
+    }
+    f = fopen(OTA_PEER_TEMP_PATH, "wb");
+    sd_card_release_mutex();
+    if (f == NULL) {
+        ESP_LOGW(TAG, "Cannot create %s", OTA_PEER_TEMP_PATH);
+        goto done;
+    }
+
+    ESP_LOGI(TAG, "Staging firmware v%s (%lu bytes) on SD for peers", s_note.version, s_note.size);
+    for (uint32_t pos = 0; pos < s_note.size; ) {
+        size_t n = s_note.size - pos < OTA_PEER_STAGE_CHUNK ? s_note.size - pos : OTA_PEER_STAGE_CHUNK;
+        if (esp_partition_read(running, pos, buf, n) != ESP_OK) {
+            goto done;
+        }
+        mbedtls_sha256_update(&sha, buf, n);
+        if (sd_card_acquire_mutex() != ESP_OK) {
+            goto done;
+        }
+        size_t w = fwrite(buf, 1, n, f);
+        sd_card_release_mutex();
+        if (w != n) {
+            ESP_LOGW(TAG, "SD write failed at %lu bytes", pos);
+            goto done;
+        }
+        pos += n;
+    }
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&sha, digest);
+    if (memcmp(digest, s_note.sha256, sizeof(digest)) != 0) {
+        // Not the image that was installed (rolled back, or replaced since)
+        ESP_LOGW(TAG, "Running image does not match v%s - not staged", s_note.version);
+        goto done;
+    }
+
+    staged_retire();
+    if (sd_card_acquire_mutex() != ESP_OK) {
+        goto done;
+    }
+    ok = fclose(f) == 0;
+    f = NULL;
+    if (ok) {
+        remove(OTA_PEER_INFO_PATH);
+        remove(OTA_PEER_IMAGE_PATH);
+        ok = rename(OTA_PEER_TEMP_PATH, OTA_PEER_IMAGE_PATH) == 0 && write_info(&s_note);
+    }
+    if (!ok) {
+        remove(OTA_PEER_TEMP_PATH);
+    }
+    sd_card_release_mutex();
+
+done:
+    if (f) {
+        bool locked = sd_card_acquire_mutex() == ESP_OK;
+        fclose(f);
+        remove(OTA_PEER_TEMP_PATH);
+        if (locked) {
+            sd_card_release_mutex();
+        }
+    }
+    if (ok) {
+        staged_set(&s_note);
+        ESP_LOGI(TAG, "Firmware v%s staged for peers", s_note.version);
+    }
+    // A failed copy is not retried on every boot; the next install notes again
+    note_clear();
+    mbedtls_sha256_free(&sha);
+    free(buf);
+    s_staging = false;
+    vTaskDelete(NULL);
+}
+
+void ota_peer_stage_running(void)
+{
+    ota_peer_image_t note;
+    if (s_staging || !note_load(&note)) {
+        return;
+    }
+    if (!sd_card_is_available()) {
+        ESP_LOGI(TAG, "No SD card - firmware v%s not staged for peers", note.version);
+        return;
+    }
+
+    ota_peer_image_t staged;
+    if (staged_get(&staged) && memcmp(staged.sha256, note.sha256, sizeof(note.sha256)) == 0) {
+        note_clear();
+        return;
+    }
+
+    s_note = note;
+    s_staging = true;
+    if (xTaskCreate(ota_stage_task, "ota_stage", OTA_PEER_STAGE_STACK, NULL, 2, NULL) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create stage task");
+        s_staging = false;
+    }
+}
+
+// ============================================================================
+// FETCH
+// ============================================================================
+
+// GET http://<host>/ota/peer/manifest. A sleeping portal holds the first SYN
+// until its server listens (web_wake.c); one on older firmware answers with
+// its wake page and starts the server, so then ask once more.
+static bool fetch_manifest(const char *host, ota_peer_image_t *img)
+{
+    char url[64];
+    snprintf(url, sizeof(url), "http://%s/ota/peer/manifest", host);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        esp_http_client_config_t config = {
+            .url = url,
+            .timeout_ms = OTA_PEER_HTTP_TIMEOUT_MS,
+            .keep_alive_enable = false,
+            .buffer_size = 1024,
+            .buffer_size_tx = 512,
+        };
+        esp_http_client_handle_t client = esp_http_client_init(&config);
+        if (client == NULL) {
+            return false;
+        }
+        int status = 0;
+        int len = 0;
+        if (esp_http_client_open(client, 0) == ESP_OK) {
+            esp_http_client_fetch_headers(client);
+            status = esp_http_client_get_status_code(client);
+            len = esp_http_client_read_response(client, s_manifest_buf, sizeof(s_manifest_buf) - 1);
+        }
+        esp_http_client_close(client);
+        esp_http_client_cleanup(client);
+
+        if (status != 200 || len <= 0) {
+            ESP_LOGD(TAG, "%s: no manifest (HTTP %d)", host, status);
+            return false;
+        }
+        s_manifest_buf[len] = '\0';
+        if (s_manifest_buf[0] != '{') {
+            ESP_LOGI(TAG, "%s: portal waking up", host);
+            vTaskDelay(pdMS_TO_TICKS(OTA_PEER_WAKE_WAIT_MS));
+            continue;
+        }
+
+        cJSON *root = cJSON_Parse(s_manifest_buf);
+        if (root == NULL) {
+            return false;
+        }
+        cJSON *version = cJSON_GetObjectItem(root, "version");
+        cJSON *size = cJSON_GetObjectItem(root, "size");
+        cJSON *sha = cJSON_GetObjectItem(root, "sha256");
+        bool ok = cJSON_IsString(version) && cJSON_IsNumber(size) && size->valuedouble > 0 &&
+                  cJSON_IsString(sha) && ota_peer_parse_sha256(sha->valuestring, img->sha256);
+        if (ok) {
+            memset(img->version, 0, sizeof(img->version));
+            strncpy(img->version, version->valuestring, sizeof(img->version) - 1);
+            img->size = (uint32_t)size->valuedouble;
+        }
+        cJSON_Delete(root);
+        return ok;
+    }
+    return false;
+}
+
+bool ota_peer_find(const uint8_t sha256[32], char *url, size_t url_size, uint32_t *size)
+{
+    wireguard_peer_addr_t peers[PEER_MAX_HOSTS];
+    int count = wireguard_get_direct_peers(peers, PEER_MAX_HOSTS);
+    if (count == 0) {
+        ESP_LOGI(TAG, "No site peers to fetch firmware from");
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        // Same-site LAN first; the tunnel works when the LAN address does not
+        const char *hosts[2] = { peers[i].lan_ip, peers[i].vpn_ip };
+        for (int h = 0; h < 2; h++) {
+            if (hosts[h][0] == '\0' || (h == 1 && strcmp(hosts[0], hosts[1]) == 0)) {
+                continue;
+            }
+            ota_peer_image_t img;
+            if (!fetch_manifest(hosts[h], &img)) {
+                continue;
+            }
+            if (memcmp(img.sha256, sha256, sizeof(img.sha256)) != 0) {
+                ESP_LOGI(TAG, "%s has v%s, not the requested image", hosts[h], img.version);
+                break;      // Same image over the other address
+            }
+            snprintf(url, url_size, "http://%s/ota/peer/image", hosts[h]);
+            *size = img.size;
+            ESP_LOGI(TAG, "Peer %s has the image (v%s, %lu bytes)", hosts[h], img.version, img.size);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ============================================================================
+// SERVE
+// ============================================================================
+
+esp_err_t ota_peer_manifest_handler(httpd_req_t *req)
+{
+    ota_peer_image_t img;
+    if (!staged_get(&img)) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No firmware staged");
+        return ESP_OK;
+    }
+
+    char hex[65];
+    char json[160];
+    sha256_to_hex(img.sha256, hex);
+    snprintf(json, sizeof(json), "{\"version\":\"%s\",\"size\":%lu,\"sha256\":\"%s\"}",
+             img.version, (unsigned long)img.size, hex);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    return httpd_resp_sendstr(req, json);
+}
+
+typedef struct {
+    httpd_req_t *req;               // Async copy, owned by serve_task
+    ota_peer_image_t img;
+    FILE *f;
+    uint8_t *buf;
+    uint32_t start;
+    uint32_t end;
+    bool partial;
+    char etag[20];
+    char content_range[48];
+} serve_job_t;
+
+// Claim the transfer slot for the image that is still staged
+static bool serve_begin(const ota_peer_image_t *img)
+{
+    taskENTER_CRITICAL(&s_lock);
+    bool ok = !s_serving && s_staged_valid && memcmp(s_staged.sha256, img->sha256, sizeof(img->sha256)) == 0;
+    if (ok) {
+        s_serving = true;
+    }
+    taskEXIT_CRITICAL(&s_lock);
+    return ok;
+}
+
+static void serve_end(void)
+{
+    taskENTER_CRITICAL(&s_lock);
+    s_serving = false;
+    taskEXIT_CRITICAL(&s_lock);
+}
+
+static void serve_job_free(serve_job_t *job)
+{
+    if (job->f) {
+        bool locked = sd_card_acquire_mutex() == ESP_OK;
+        fclose(job->f);
+        if (locked) {
+            sd_card_release_mutex();
+        }
+    }
+    free(job->buf);
+    free(job);
+}
+
+// Streams the image outside the httpd task, so the portal keeps answering
+// during the ~1.9 MB transfer. The SD mutex is held per read, not while the
+// peer receives.
+static void serve_task(void *pvParameter)
+{
+    serve_job_t *job = pvParameter;
+    httpd_req_t *req = job->req;
+
+    if (job->partial) {
+        httpd_resp_set_status(req, "206 Partial Content");
+        httpd_resp_set_hdr(req, "Content-Range", job->content_range);
+    }
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "ETag", job->etag);
+    httpd_resp_set_hdr(req, "Accept-Ranges", "bytes");
+
+    esp_err_t err = ESP_OK;
+    uint32_t left = job->end - job->start + 1;
+    while (left > 0 && err == ESP_OK) {
+        size_t want = left < OTA_PEER_STAGE_CHUNK ? left : OTA_PEER_STAGE_CHUNK;
+        size_t got = 0;
+        if (sd_card_acquire_mutex() == ESP_OK) {
+            got = fread(job->buf, 1, want, job->f);
+            sd_card_release_mutex();
+        }
+        if (got == 0) {
+            err = ESP_FAIL;
+            break;
+        }
+        err = httpd_resp_send_chunk(req, (const char *)job->buf, got);
+        left -= got;
+    }
+
+    httpd_handle_t server = req->handle;
+    int fd = httpd_req_to_sockfd(req);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Image transfer stopped with %lu bytes left", left);
+    } else {
+        ESP_LOGI(TAG, "Sent firmware v%s bytes %lu-%lu to a peer", job->img.version, job->start, job->end);
+        httpd_resp_send_chunk(req, NULL, 0);
+    }
+    httpd_req_async_handler_complete(req);
+    if (err != ESP_OK) {
+        httpd_sess_trigger_close(server, fd);    // The peer resumes with Range
+    }
+
+    serve_job_free(job);
+    serve_end();
+    vTaskDelete(NULL);
+}
+
+// Whole image, or from a Range offset for a download that resumes
+esp_err_t ota_peer_image_handler(httpd_req_t *req)
+{
+    serve_job_t *job = calloc(1, sizeof(*job));
+    if (job == NULL) {
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_OK;
+    }
+    if (!staged_get(&job->img)) {
+        free(job);
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No firmware staged");
+        return ESP_OK;
+    }
+
+    char hex[65];
+    sha256_to_hex(job->img.sha256, hex);
+    snprintf(job->etag, sizeof(job->etag), "\"%.16s\"", hex);
+
+    // "bytes=<start>-[end]", ignored if If-Range names another image
+    job->start = 0;
+    job->end = job->img.size - 1;
+    char range[48];
+    char if_range[24];
+    if (httpd_req_get_hdr_value_str(req, "Range", range, sizeof(range)) == ESP_OK &&
+        (httpd_req_get_hdr_value_str(req, "If-Range", if_range, sizeof(if_range)) != ESP_OK ||
+         strcmp(if_range, job->etag) == 0)) {
+        unsigned long s = 0, e = 0;
+        int n = sscanf(range, "bytes=%lu-%lu", &s, &e);
+        if (n >= 1) {
+            if (s >= job->img.size || (n == 2 && e < s)) {
+                char content_range[32];
+                snprintf(content_range, sizeof(content_range), "bytes */%lu", (unsigned long)job->img.size);
+                free(job);
+                httpd_resp_set_status(req, "416 Range Not Satisfiable");
+                httpd_resp_set_hdr(req, "Content-Range", content_range);
+                return httpd_resp_send(req, NULL, 0);
+            }
+            job->start = s;
+            if (n == 2 && e < job->end) {
+                job->end = e;
+            }
+            job->partial = true;
+            snprintf(job->content_range, sizeof(job->content_range), "bytes %lu-%lu/%lu",
+                     (unsigned long)job->start, (unsigned long)job->end, (unsigned long)job->img.size);
+        }
+    }
+
+    if (!serve_begin(&job->img)) {
+        // Another peer is downloading; the caller falls back to the cloud URL
+        free(job);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Retry-After", "30");
+        return httpd_resp_sendstr(req, "Busy serving another peer");
+    }
+
+    job->buf = malloc(OTA_PEER_STAGE_CHUNK);
+    if (job->buf && sd_card_acquire_mutex() == ESP_OK) {
+        job->f = fopen(OTA_PEER_IMAGE_PATH, "rb");
+        if (job->f && fseek(job->f, job->start, SEEK_SET) != 0) {
+            fclose(job->f);
+            job->f = NULL;
+        }
+        sd_card_release_mutex();
+    }
+    if (job->f == NULL) {
+        serve_job_free(job);
+        serve_end();
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Staged image unreadable");
+        return ESP_OK;
+    }
+
+    if (httpd_req_async_handler_begin(req, &job->req) != ESP_OK) {
+        serve_job_free(job);
+        serve_end();
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        return ESP_OK;
+    }
+    if (xTaskCreate(serve_task, "ota_serve", OTA_PEER_SERVE_STACK, job, 2, NULL) != pdPASS) {
+        ESP_LOGW(TAG, "Failed to create serve task");
+        httpd_resp_send_err(job->req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        httpd_req_async_handler_complete(job->req);
+        serve_job_free(job);
+        serve_end();
+    }
+    return ESP_OK;
+}
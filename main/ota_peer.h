@@ -0,0 +1,96 @@
+/**
+ * ota_peer.h - Firmware images shared between gateways on the same site.
+ *
+ * A fleet rollout used to cost one cellular download per gateway. Now the
+ * first gateway on a site to install an image also serves it, and the others
+ * fetch it from there:
+ *
+ *   stage    After an OTA install, ota_update.c notes the image's version,
+ *            size and SHA-256 (ota_peer_note_installed()). Once the new
+ *            firmware has proven itself and marks itself valid
+ *            (ota_peer_stage_running()), the running partition is copied to
+ *            the SD card. It is hashed again during the copy, so an image
+ *            that rolled back is never staged.
+ *   serve    /ota/peer/manifest  {"version":..,"size":..,"sha256":".."}
+ *            /ota/peer/image     the staged image, with Range for resumes.
+ *                                Sent by its own task, one peer at a time
+ *                                (503 to the others), so the portal stays
+ *                                responsive during the transfer.
+ *   fetch    When an update comes with the image's SHA-256, the download
+ *            task asks the WireGuard direct peers (LAN address first, then
+ *            tunnel address) for their manifest. It uses a peer whose hash
+ *            matches. The downloaded image is checked against that hash
+ *            before it is made bootable. Any failure falls back to the cloud
+ *            URL.
+ *
+ * Peers only serve what the cloud command names by hash. With secure boot
+ * enabled, esp_ota_end() also checks the image signature as for any other
+ * source.
+ *
+ * A peer whose portal is asleep starts it on the first SYN and holds that
+ * SYN until the server listens (web_wake.c). Older firmware answers with a
+ * port-80 wake page instead; the manifest request is then repeated once the
+ * server has started.
+ */
+
+#ifndef OTA_PEER_H
+#define OTA_PEER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OTA_PEER_IMAGE_PATH "/sdcard/ota.bin"
+#define OTA_PEER_INFO_PATH  "/sdcard/ota.inf"     // version, size and SHA-256 hex, one per line
+#define OTA_PEER_TEMP_PATH  "/sdcard/ota.tmp"
+
+typedef struct {
+    char version[16];
+    uint32_t size;
+    uint8_t sha256[32];
+} ota_peer_image_t;
+
+/**
+ * Parse 64 hex digits into a SHA-256
+ *
+ * @return true if hex is exactly a SHA-256
+ */
+bool ota_peer_parse_sha256(const char *hex, uint8_t sha256[32]);
+
+/**
+ * Remember an image that was just installed; staged for peers once the new
+ * firmware marks itself valid
+ */
+void ota_peer_note_installed(const char *version, uint32_t size, const uint8_t sha256[32]);
+
+/**
+ * Copy the running image to SD in the background if it is the one noted at
+ * install time and is not staged yet. Called by ota_mark_valid().
+ */
+void ota_peer_stage_running(void);
+
+/**
+ * Ask the site's peers for the image with this SHA-256
+ *
+ * @param sha256   Hash the cloud command gave for the image
+ * @param url      Receives http://<peer>/ota/peer/image
+ * @param size     Receives the image size from the peer's manifest
+ * @return true if a peer serves it
+ */
+bool ota_peer_find(const uint8_t sha256[32], char *url, size_t url_size, uint32_t *size);
+
+// Portal handlers (registered by web_config.c)
+esp_err_t ota_peer_manifest_handler(httpd_req_t *req);
+esp_err_t ota_peer_image_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OTA_PEER_H
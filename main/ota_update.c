@@ -5,15 +5,20 @@
 
 #include "ota_update.h"
 #include "iot_configs.h"
+#include "delta_patch.h"
+#include "ota_peer.h"
 #include "web_config.h"
 #include "a7670c_ppp.h"
 // Note: a7670c_http.h removed - using ESP32 HTTP client for both WiFi and SIM modes
 // The A7670C modem's AT+HTTP* commands don't support HTTPS properly
 
+#include <stdarg.h>
+#include <stdio.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_ota_ops.h"
 #include "esp_https_ota.h"
@@ -23,6 +28,17 @@
 #include "nvs.h"
 #include "esp_crt_bundle.h"
 #include "esp_netif.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "spi_flash_mmap.h"
+#include "mbedtls/sha256.h"
+#include "esp32/rom/miniz.h"
+#include "esp_idf_version.h"
+
+// Resumed downloads use esp_ota_resume(), which older IDF releases lack
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 5, 0)
+#error "ota_update.c needs ESP-IDF v5.5 or later (esp_ota_resume)"
+#endif
 
 static const char *TAG = "OTA_UPDATE";
 
@@ -41,16 +57,54 @@ static const esp_partition_t *ota_partition = NULL;
 // NVS keys
 #define NVS_OTA_NAMESPACE "ota"
 #define NVS_KEY_BOOT_COUNT "boot_cnt"
+#define NVS_KEY_RESUME "resume"
+
+// Progress of an interrupted download, kept in NVS so it can continue after a
+// link drop or a reboot. Only whole flash sectors are counted: esp_ota_resume()
+// erases from the sector holding the offset onwards.
+#define OTA_RESUME_MAGIC 0x4F524553   // "SERO"
+
+typedef struct {
+    uint32_t magic;
+    char url[256];              // As given to ota_start_update(), before redirects
+    char version[16];
+    char etag[64];              // Sent back in If-Range, "" if the server gave none
+    char partition[17];         // Label of the partition being written
+    uint32_t total;             // Image size (Content-Length, or Content-Range total)
+    uint32_t written;           // Bytes in flash, a multiple of SPI_FLASH_SEC_SIZE
+    uint32_t crc;               // CRC-32 of those bytes
+} ota_resume_t;
+
+static ota_resume_t resume;
+static uint32_t image_written = 0;    // Bytes written to the partition, resumed offset included
+static uint32_t image_crc = 0;        // Running CRC-32 of those bytes
+static uint32_t stream_pos = 0;       // Bytes of the downloaded file consumed, the Range offset
+static uint32_t erased_end = 0;       // Partition offset up to which flash is erased for this image
+                                      // (same as image_written unless the file is a delta patch)
+
+// SHA-256 the update command gave for the image; when set, the installed image
+// must match it and a site peer holding it may be downloaded from instead
+static uint8_t expected_sha[32];
+static bool expected_sha_set = false;
+static bool peer_source = false;      // Downloading from peer_url rather than ota_info.update_url
+static char peer_url[64];
 
 // Forward declarations
 static void ota_download_task(void *pvParameter);
 static void notify_status_change(ota_status_t status, const char* message);
+static bool resume_load(ota_resume_t *rec);
+static void resume_clear(void);
 
 // Storage for redirect URL captured from event handler
 // GitHub CDN URLs can be very long (includes JWT tokens), need large buffer
 static char redirect_location[2048] = {0};
 
-// HTTP event handler to capture Location header during redirects
+// Validator and range of the last response, for resuming with Range/If-Range
+static char response_etag[64] = {0};
+static char response_range[64] = {0};
+
+// HTTP event handler to capture Location header during redirects, and the
+// ETag/Content-Range headers of the image response
 static esp_err_t http_event_handler(esp_http_client_event_t *evt)
 {
     switch (evt->event_id) {
@@ -66,6 +120,12 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
                 strncpy(redirect_location, evt->header_value, sizeof(redirect_location) - 1);
                 redirect_location[sizeof(redirect_location) - 1] = '\0';
                 ESP_LOGI(TAG, "Captured Location header (%d bytes)", strlen(redirect_location));
+            } else if (strcasecmp(evt->header_key, "ETag") == 0) {
+                strncpy(response_etag, evt->header_value, sizeof(response_etag) - 1);
+                response_etag[sizeof(response_etag) - 1] = '\0';
+            } else if (strcasecmp(evt->header_key, "Content-Range") == 0) {
+                strncpy(response_range, evt->header_value, sizeof(response_range) - 1);
+                response_range[sizeof(response_range) - 1] = '\0';
             }
             break;
         default:
@@ -141,15 +201,54 @@ esp_err_t ota_init(void)
         snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Rollback from failed update");
     }
 
+    // Report a download a reboot interrupted; ota_resume_pending() continues it
+    if (resume_load(&resume)) {
+        const esp_partition_t *next = esp_ota_get_next_update_partition(NULL);
+        if (next == NULL || strcmp(resume.partition, next->label) != 0) {
+            resume_clear();
+        } else {
+            ESP_LOGW(TAG, "Interrupted OTA of v%s: %lu/%lu bytes in %s, will resume",
+                     resume.version, resume.written, resume.total, resume.partition);
+            strncpy(ota_info.update_url, resume.url, sizeof(ota_info.update_url) - 1);
+            strncpy(ota_info.new_version, resume.version, sizeof(ota_info.new_version) - 1);
+            ota_info.bytes_downloaded = resume.written;
+            ota_info.total_bytes = resume.total;
+            if (resume.total > 0) {
+                ota_info.progress = ((uint64_t)resume.written * 100) / resume.total;
+            }
+        }
+    }
+
     return ESP_OK;
 }
 
+esp_err_t ota_resume_pending(void)
+{
+    ota_resume_t rec;
+    if (!resume_load(&rec)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_LOGI(TAG, "Resuming interrupted OTA of v%s", rec.version);
+    return ota_start_update(rec.url, rec.version);
+}
+
 esp_err_t ota_start_update(const char* firmware_url, const char* version)
+{
+    return ota_start_update_verified(firmware_url, version, NULL);
+}
+
+esp_err_t ota_start_update_verified(const char* firmware_url, const char* version, const char* sha256_hex)
 {
     if (firmware_url == NULL || strlen(firmware_url) == 0) {
         ESP_LOGE(TAG, "Invalid firmware URL");
         return ESP_ERR_INVALID_ARG;
     }
+    uint8_t sha[32];
+    bool has_sha = sha256_hex != NULL && sha256_hex[0] != '\0';
+    if (has_sha && !ota_peer_parse_sha256(sha256_hex, sha)) {
+        ESP_LOGE(TAG, "Invalid firmware SHA-256: %s", sha256_hex);
+        return ESP_ERR_INVALID_ARG;
+    }
 
     xSemaphoreTake(ota_mutex, portMAX_DELAY);
 
@@ -176,6 +275,10 @@ esp_err_t ota_start_update(const char* firmware_url, const char* version)
     } else {
         strcpy(ota_info.new_version, "unknown");
     }
+    expected_sha_set = has_sha;
+    if (has_sha) {
+        memcpy(expected_sha, sha, sizeof(expected_sha));
+    }
 
     xSemaphoreGive(ota_mutex);
 
@@ -211,142 +314,524 @@ bool ota_is_in_progress(void)
     return ota_in_progress;
 }
 
-static void ota_download_task(void *pvParameter)
+// Mark the update failed with a message for ota_info.error_msg
+static void set_failed(const char *fmt, ...)
 {
-    ESP_LOGI(TAG, "OTA download task started");
-    esp_err_t err;
+    va_list args;
+    va_start(args, fmt);
+    xSemaphoreTake(ota_mutex, portMAX_DELAY);
+    ota_info.status = OTA_STATUS_FAILED;
+    vsnprintf(ota_info.error_msg, sizeof(ota_info.error_msg), fmt, args);
+    xSemaphoreGive(ota_mutex);
+    va_end(args);
+}
 
-    // Set OTA in progress flag - MQTT should not reconnect during OTA
-    ota_in_progress = true;
+static bool resume_load(ota_resume_t *rec)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_OTA_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
+        return false;
+    }
+    size_t len = sizeof(*rec);
+    esp_err_t err = nvs_get_blob(nvs, NVS_KEY_RESUME, rec, &len);
+    nvs_close(nvs);
+    return err == ESP_OK && len == sizeof(*rec) && rec->magic == OTA_RESUME_MAGIC;
+}
 
-    // Check network mode for logging only
-    system_config_t *sys_config = get_system_config();
-    bool is_sim_mode = (sys_config != NULL && sys_config->network_mode == NETWORK_MODE_SIM);
+static void resume_save(const ota_resume_t *rec)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_OTA_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        nvs_set_blob(nvs, NVS_KEY_RESUME, rec, sizeof(*rec));
+        nvs_commit(nvs);
+        nvs_close(nvs);
+    }
+}
 
-    // Store PPP interface for HTTP client binding (SIM mode only)
-    struct ifreq ppp_ifreq;
-    memset(&ppp_ifreq, 0, sizeof(ppp_ifreq));
-    bool ppp_if_valid = false;
+static void resume_clear(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(NVS_OTA_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
+        if (nvs_erase_key(nvs, NVS_KEY_RESUME) == ESP_OK) {
+            nvs_commit(nvs);
+        }
+        nvs_close(nvs);
+    }
+}
 
-    if (is_sim_mode) {
-        ESP_LOGI(TAG, "========================================");
-        ESP_LOGI(TAG, "SIM Mode - Using ESP32 HTTP over PPP");
-        ESP_LOGI(TAG, "========================================");
+// Re-read the kept part of the partition and check it against the saved CRC,
+// so a partition erased or rewritten since (web upload, other firmware) is not resumed
+static bool resume_verify(const esp_partition_t *partition, const ota_resume_t *rec, uint8_t *buf, size_t buf_size)
+{
+    uint32_t crc = 0;
+    for (uint32_t pos = 0; pos < rec->written; ) {
+        size_t n = rec->written - pos < buf_size ? rec->written - pos : buf_size;
+        if (esp_partition_read(partition, pos, buf, n) != ESP_OK) {
+            return false;
+        }
+        crc = esp_rom_crc32_le(crc, buf, n);
+        pos += n;
+    }
+    return crc == rec->crc;
+}
 
-        // Log memory status
-        ESP_LOGI(TAG, "Free heap before SIM OTA: %lu bytes", esp_get_free_heap_size());
+// SHA-256 of the first size bytes of a partition, as sha256sum gives for the .bin
+static esp_err_t partition_sha256(const esp_partition_t *partition, uint32_t size, uint8_t *buf, size_t buf_size,
+                                  uint8_t digest[32])
+{
+    esp_err_t err = ESP_OK;
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    for (uint32_t pos = 0; pos < size && err == ESP_OK; ) {
+        size_t n = size - pos < buf_size ? size - pos : buf_size;
+        err = esp_partition_read(partition, pos, buf, n);
+        mbedtls_sha256_update(&sha, buf, n);
+        pos += n;
+    }
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+    return err;
+}
 
-        // CRITICAL: Stop MQTT to free PPP for exclusive OTA use
-        // Two concurrent TLS sessions over cellular PPP cause connection resets
-        extern void mqtt_stop_for_ota(void);
-        ESP_LOGI(TAG, "Stopping MQTT to free PPP connection for OTA...");
-        mqtt_stop_for_ota();
-        ESP_LOGI(TAG, "Free heap after stopping MQTT: %lu bytes", esp_get_free_heap_size());
+// "bytes <start>-<end>/<total>"
+static bool parse_content_range(const char *value, uint32_t *start, uint32_t *total)
+{
+    unsigned long s = 0, e = 0, t = 0;
+    if (sscanf(value, "bytes %lu-%lu/%lu", &s, &e, &t) != 3 || e < s || t <= e) {
+        return false;
+    }
+    *start = s;
+    *total = t;
+    return true;
+}
 
-        // CRITICAL: Verify PPP is actually connected before attempting OTA
-        if (!a7670c_ppp_is_connected()) {
-            ESP_LOGE(TAG, "PPP not connected - cannot perform OTA over SIM");
-            xSemaphoreTake(ota_mutex, portMAX_DELAY);
-            ota_info.status = OTA_STATUS_FAILED;
-            snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "PPP not connected");
-            xSemaphoreGive(ota_mutex);
-            ota_in_progress = false;
-            ota_task_handle = NULL;
-            vTaskDelete(NULL);
-            return;
+// Account for bytes that reached flash; the CRC is also snapshotted at every
+// sector boundary because only whole sectors can be resumed after a reboot
+static void track_written(const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t room = SPI_FLASH_SEC_SIZE - (image_written % SPI_FLASH_SEC_SIZE);
+        size_t n = len < room ? len : room;
+        image_crc = esp_rom_crc32_le(image_crc, data, n);
+        image_written += n;
+        data += n;
+        len -= n;
+        if (image_written % SPI_FLASH_SEC_SIZE == 0) {
+            resume.written = image_written;
+            resume.crc = image_crc;
         }
-        ESP_LOGI(TAG, "PPP connection verified - proceeding with OTA");
+    }
+}
+
+// Program image bytes at image_written. A download only has its first sector
+// erased by esp_ota_begin(); the rest is erased here, or earlier by
+// erase_ahead() while the writer waits for data.
+static esp_err_t flash_write(const void *data, size_t len)
+{
+    while (erased_end < image_written + len) {
+        esp_err_t err = esp_partition_erase_range(ota_partition, erased_end, SPI_FLASH_SEC_SIZE);
+        if (err != ESP_OK) {
+            return err;
+        }
+        erased_end += SPI_FLASH_SEC_SIZE;
+    }
+    return esp_ota_write(ota_handle, data, len);
+}
+
+// Delta patch being applied (see delta_patch.h). Only allocated when a download
+// or web upload turns out to be a patch rather than an image.
+typedef struct {
+    uint8_t header[DELTA_HEADER_SIZE];
+    size_t header_fill;
+    delta_header_t hdr;
+    tinfl_decompressor inflator;
+    uint8_t window[1 << DELTA_WINDOW_BITS];   // Inflate output ring, the patch's deflate window
+    size_t window_pos;
+    bool inflate_done;
+    delta_patch_t patch;
+    int patch_result;
+    mbedtls_sha256_context sha;               // Source check, then the rebuilt image
+    const esp_partition_t *source;
+    const char *error;
+} ota_delta_t;
+
+static ota_delta_t *delta = NULL;
+
+static int delta_read_source(void *ctx, uint32_t offset, uint8_t *buf, size_t len)
+{
+    return esp_partition_read(delta->source, offset, buf, len) == ESP_OK ? 0 : -1;
+}
+
+static int delta_write_target(void *ctx, const uint8_t *data, size_t len)
+{
+    if (flash_write(data, len) != ESP_OK) {
+        return -1;
+    }
+    mbedtls_sha256_update(&delta->sha, data, len);
+    image_written += len;
+    return 0;
+}
+
+static const char *delta_result_str(int result)
+{
+    switch (result) {
+        case DELTA_ERR_FORMAT: return "corrupt patch";
+        case DELTA_ERR_SOURCE: return "reads past the running image";
+        case DELTA_ERR_SIZE:   return "wrong image size";
+        case DELTA_ERR_READ:   return "flash read failed";
+        case DELTA_ERR_WRITE:  return "flash write failed";
+        default:               return "failed";
+    }
+}
+
+static esp_err_t delta_begin(void)
+{
+    delta = calloc(1, sizeof(*delta));
+    if (delta == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    delta->source = esp_ota_get_running_partition();
+    mbedtls_sha256_init(&delta->sha);
+    tinfl_init(&delta->inflator);
+    image_written = 0;
+    ESP_LOGI(TAG, "Firmware file is a delta patch against the running image");
+    return ESP_OK;
+}
+
+static void delta_free(void)
+{
+    if (delta) {
+        mbedtls_sha256_free(&delta->sha);
+        free(delta);
+        delta = NULL;
+    }
+}
+
+// The patch only applies to exactly the image it was made from
+static bool delta_source_matches(void)
+{
+    if (delta->hdr.source_size > delta->source->size) {
+        return false;
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_starts(&delta->sha, 0);
+    for (uint32_t pos = 0; pos < delta->hdr.source_size; ) {
+        size_t n = delta->hdr.source_size - pos;
+        if (n > sizeof(delta->window)) {
+            n = sizeof(delta->window);
+        }
+        if (esp_partition_read(delta->source, pos, delta->window, n) != ESP_OK) {
+            return false;
+        }
+        mbedtls_sha256_update(&delta->sha, delta->window, n);
+        pos += n;
+    }
+    mbedtls_sha256_finish(&delta->sha, digest);
+    return memcmp(digest, delta->hdr.source_sha256, sizeof(digest)) == 0;
+}
+
+// Feed patch file bytes: header first, then inflate and apply the commands
+static esp_err_t delta_write(const uint8_t *data, size_t len)
+{
+    if (delta->error) {
+        return ESP_FAIL;
+    }
+
+    if (delta->header_fill < DELTA_HEADER_SIZE) {
+        size_t n = DELTA_HEADER_SIZE - delta->header_fill;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(delta->header + delta->header_fill, data, n);
+        delta->header_fill += n;
+        data += n;
+        len -= n;
+        if (delta->header_fill < DELTA_HEADER_SIZE) {
+            return ESP_OK;
+        }
+        if (delta_parse_header(delta->header, DELTA_HEADER_SIZE, &delta->hdr) != DELTA_OK) {
+            delta->error = "unsupported patch";
+            return ESP_FAIL;
+        }
+        if (!delta_source_matches()) {
+            delta->error = "made for other firmware";
+            return ESP_FAIL;
+        }
+        ESP_LOGI(TAG, "Delta patch: %lu-byte running image -> %lu-byte image",
+                 delta->hdr.source_size, delta->hdr.target_size);
+        mbedtls_sha256_starts(&delta->sha, 0);
+        delta_patch_init(&delta->patch, &delta->hdr, delta_read_source, delta_write_target, NULL);
+    }
 
-        // CRITICAL: Set PPP as the default network interface for HTTP client
-        // Without this, HTTP client may try to route through WiFi interface
-        esp_netif_t *ppp_netif = a7670c_ppp_get_netif();
-        if (ppp_netif != NULL) {
-            esp_netif_set_default_netif(ppp_netif);
-            ESP_LOGI(TAG, "PPP set as default network interface for OTA");
-
-            // Get interface name for HTTP client binding
-            char if_name_buf[16] = {0};
-            esp_err_t ret = esp_netif_get_netif_impl_name(ppp_netif, if_name_buf);
-            if (ret == ESP_OK && strlen(if_name_buf) > 0) {
-                // Copy interface name to ifreq structure
-                strncpy(ppp_ifreq.ifr_name, if_name_buf, sizeof(ppp_ifreq.ifr_name) - 1);
-                ppp_if_valid = true;
-                ESP_LOGI(TAG, "PPP interface name: %s", ppp_ifreq.ifr_name);
-            } else {
-                ESP_LOGW(TAG, "Could not get PPP interface name, using default routing");
+    // Inflate into the window ring; every piece that comes out is applied at once
+    while (!delta->inflate_done) {
+        size_t in_bytes = len;
+        size_t out_bytes = sizeof(delta->window) - delta->window_pos;
+        tinfl_status status = tinfl_decompress(&delta->inflator, data, &in_bytes,
+                                               delta->window, delta->window + delta->window_pos, &out_bytes,
+                                               TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_bytes;
+        len -= in_bytes;
+        if (out_bytes > 0) {
+            int result = delta_patch_feed(&delta->patch, delta->window + delta->window_pos, out_bytes);
+            delta->window_pos = (delta->window_pos + out_bytes) & (sizeof(delta->window) - 1);
+            if (result < 0) {
+                delta->error = delta_result_str(result);
+                return ESP_FAIL;
             }
+            delta->patch_result = result;
+        }
+        if (status == TINFL_STATUS_DONE) {
+            delta->inflate_done = true;
+        } else if (status < TINFL_STATUS_DONE) {
+            delta->error = "corrupt patch";
+            return ESP_FAIL;
+        } else if (status == TINFL_STATUS_NEEDS_MORE_INPUT && len == 0) {
+            break;
+        }
+    }
+    return ESP_OK;
+}
+
+// Whole patch received: the rebuilt image must hash to what the patch was made for
+static esp_err_t delta_finish(void)
+{
+    if (delta->error) {
+        return ESP_FAIL;
+    }
+    if (!delta->inflate_done || delta->patch_result != DELTA_DONE) {
+        delta->error = "patch incomplete";
+        return ESP_FAIL;
+    }
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&delta->sha, digest);
+    if (memcmp(digest, delta->hdr.target_sha256, sizeof(digest)) != 0) {
+        delta->error = "image hash mismatch";
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+// Download pipeline. The download task only reads from the network into free
+// buffers and queues them; ota_writer_task() writes them to flash (or through
+// the delta patcher), so erasing and programming no longer hold up the TCP
+// receive. The download task leaves ota_handle, delta, image_written and
+// resume to the writer from the first PIPE_WRITE until pipe_sync() returns.
+typedef enum {
+    PIPE_WRITE,
+    PIPE_SYNC,                  // Reply once everything queued before it is written
+    PIPE_STOP,
+} pipe_op_t;
+
+typedef struct {
+    pipe_op_t op;
+    uint8_t *buf;
+    size_t len;
+} pipe_msg_t;
+
+static QueueHandle_t pipe_free = NULL;         // Empty buffers
+static QueueHandle_t pipe_full = NULL;         // Filled buffers and control messages, in order
+static uint8_t *pipe_bufs[OTA_PIPE_BUFFERS];
+static TaskHandle_t pipe_writer = NULL;
+static TaskHandle_t pipe_owner = NULL;         // Download task, notified on SYNC/STOP
+static volatile bool pipe_preerase = false;    // Writer may erase ahead: an image is open
+static volatile esp_err_t pipe_err = ESP_OK;   // First write error; later buffers are dropped
+static char pipe_error[64];
+static uint32_t pipe_checkpoint = 0;           // resume.written when last saved to NVS
+
+static esp_err_t pipe_write(const uint8_t *data, size_t len)
+{
+    if (delta) {
+        if (delta_write(data, len) != ESP_OK) {
+            snprintf(pipe_error, sizeof(pipe_error), "Delta: %s", delta->error);
+            return ESP_FAIL;
+        }
+        return ESP_OK;
+    }
+
+    esp_err_t err = flash_write(data, len);
+    if (err != ESP_OK) {
+        snprintf(pipe_error, sizeof(pipe_error), "Write failed: %s", esp_err_to_name(err));
+        return err;
+    }
+    track_written(data, len);
+
+    // Checkpoint whole sectors so a reboot loses at most OTA_RESUME_CHECKPOINT_BYTES
+    if (!peer_source && resume.written >= pipe_checkpoint + OTA_RESUME_CHECKPOINT_BYTES) {
+        resume_save(&resume);
+        pipe_checkpoint = resume.written;
+    }
+    return ESP_OK;
+}
+
+// Nothing queued: erase one more sector ahead of the write pointer
+static bool erase_ahead(void)
+{
+    if (!pipe_preerase || pipe_err != ESP_OK || erased_end >= ota_partition->size ||
+        erased_end >= image_written + OTA_PREERASE_AHEAD) {
+        return false;
+    }
+    if (esp_partition_erase_range(ota_partition, erased_end, SPI_FLASH_SEC_SIZE) != ESP_OK) {
+        pipe_preerase = false;  // flash_write() tries again and reports it
+        return false;
+    }
+    erased_end += SPI_FLASH_SEC_SIZE;
+    return true;
+}
+
+static void ota_writer_task(void *pvParameter)
+{
+    pipe_msg_t msg;
+
+    while (true) {
+        if (xQueueReceive(pipe_full, &msg, 0) != pdTRUE) {
+            if (erase_ahead()) {
+                continue;
+            }
+            xQueueReceive(pipe_full, &msg, portMAX_DELAY);
+        }
+
+        if (msg.op == PIPE_WRITE) {
+            if (pipe_err == ESP_OK) {
+                pipe_err = pipe_write(msg.buf, msg.len);
+            }
+            xQueueSend(pipe_free, &msg.buf, portMAX_DELAY);
+        } else if (msg.op == PIPE_SYNC) {
+            pipe_preerase = false;
+            xTaskNotifyGive(pipe_owner);
         } else {
-            ESP_LOGE(TAG, "PPP netif not available - cannot route OTA traffic");
-            xSemaphoreTake(ota_mutex, portMAX_DELAY);
-            ota_info.status = OTA_STATUS_FAILED;
-            snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "PPP interface unavailable");
-            xSemaphoreGive(ota_mutex);
-            ota_in_progress = false;
-            ota_task_handle = NULL;
+            xTaskNotifyGive(pipe_owner);
             vTaskDelete(NULL);
-            return;
         }
+    }
+}
 
-        // Give PPP connection time to stabilize before starting TLS
-        // Cellular networks need more time than WiFi for stable data connection
-        ESP_LOGI(TAG, "Waiting 5 seconds for PPP/cellular network to stabilize...");
-        vTaskDelay(pdMS_TO_TICKS(5000));
-
-        // Get IP address to verify network is working
-        char ip_str[32] = {0};
-        if (a7670c_ppp_get_ip_info(ip_str, sizeof(ip_str)) == ESP_OK) {
-            ESP_LOGI(TAG, "PPP IP address: %s", ip_str);
+static esp_err_t pipe_start(void)
+{
+    pipe_owner = xTaskGetCurrentTaskHandle();
+    pipe_err = ESP_OK;
+    pipe_preerase = false;
+    pipe_free = xQueueCreate(OTA_PIPE_BUFFERS, sizeof(uint8_t *));
+    pipe_full = xQueueCreate(OTA_PIPE_BUFFERS + 1, sizeof(pipe_msg_t));
+    if (pipe_free == NULL || pipe_full == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < OTA_PIPE_BUFFERS; i++) {
+        pipe_bufs[i] = malloc(OTA_BUF_SIZE);
+        if (pipe_bufs[i] == NULL) {
+            return ESP_ERR_NO_MEM;
         }
+        xQueueSend(pipe_free, &pipe_bufs[i], 0);
+    }
+    if (xTaskCreate(ota_writer_task, "ota_writer", OTA_WRITER_STACK, NULL, 5, &pipe_writer) != pdPASS) {
+        pipe_writer = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
 
-        ESP_LOGI(TAG, "PPP stabilization complete, starting OTA download...");
-        ESP_LOGI(TAG, "Free heap after PPP setup: %lu bytes", esp_get_free_heap_size());
+// Wait until everything queued so far is written; the writer is idle afterwards
+static void pipe_sync(void)
+{
+    pipe_msg_t msg = { .op = PIPE_SYNC };
+    xQueueSend(pipe_full, &msg, portMAX_DELAY);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+static void pipe_stop(void)
+{
+    if (pipe_writer) {
+        pipe_msg_t msg = { .op = PIPE_STOP };
+        xQueueSend(pipe_full, &msg, portMAX_DELAY);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        pipe_writer = NULL;
+    }
+    for (int i = 0; i < OTA_PIPE_BUFFERS; i++) {
+        free(pipe_bufs[i]);
+        pipe_bufs[i] = NULL;
     }
+    if (pipe_free) {
+        vQueueDelete(pipe_free);
+        pipe_free = NULL;
+    }
+    if (pipe_full) {
+        vQueueDelete(pipe_full);
+        pipe_full = NULL;
+    }
+}
 
-    // Both WiFi and SIM mode use ESP32 HTTP client
-    // For SIM mode, it works over the PPP connection
-    ESP_LOGI(TAG, "%s - Using ESP32 HTTP client", is_sim_mode ? "SIM Mode" : "WiFi Mode");
+// Look up the PPP interface for binding the HTTP client. PPP gets a new netif
+// when the connectivity task redials, so this is redone for every connection.
+static bool bind_ppp_interface(struct ifreq *ifr)
+{
+    memset(ifr, 0, sizeof(*ifr));
 
-    // CRITICAL: Stop MQTT for WiFi mode too - two TLS connections exhaust heap
-    // Min Free Heap was dropping to ~50 bytes causing TLS handshake failures
-    if (!is_sim_mode) {
-        extern void mqtt_stop_for_ota(void);
-        ESP_LOGI(TAG, "Stopping MQTT to free memory for OTA TLS connection...");
-        mqtt_stop_for_ota();
-        vTaskDelay(pdMS_TO_TICKS(1000));  // Give MQTT time to clean up
-        ESP_LOGI(TAG, "Free heap after stopping MQTT: %lu bytes", esp_get_free_heap_size());
+    esp_netif_t *ppp_netif = a7670c_ppp_get_netif();
+    if (ppp_netif == NULL) {
+        return false;
     }
 
-    esp_http_client_handle_t client = NULL;
-    char *download_buffer = NULL;
-    const int DOWNLOAD_BUFFER_SIZE = 4096;
-    bool ota_started = false;
-    int last_logged_progress = -10;
+    // CRITICAL: Set PPP as the default network interface for HTTP client
+    // Without this, HTTP client may try to route through WiFi interface
+    esp_netif_set_default_netif(ppp_netif);
 
-    xSemaphoreTake(ota_mutex, portMAX_DELAY);
-    ota_info.status = OTA_STATUS_DOWNLOADING;
-    xSemaphoreGive(ota_mutex);
-    notify_status_change(OTA_STATUS_DOWNLOADING, "Starting download");
+    char if_name_buf[16] = {0};
+    if (esp_netif_get_netif_impl_name(ppp_netif, if_name_buf) != ESP_OK || strlen(if_name_buf) == 0) {
+        ESP_LOGW(TAG, "Could not get PPP interface name, using default routing");
+        return false;
+    }
+    strncpy(ifr->ifr_name, if_name_buf, sizeof(ifr->ifr_name) - 1);
+    return true;
+}
 
-    // Allocate download buffer
-    download_buffer = malloc(DOWNLOAD_BUFFER_SIZE);
-    if (!download_buffer) {
-        ESP_LOGE(TAG, "Failed to allocate download buffer");
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Memory allocation failed");
-        xSemaphoreGive(ota_mutex);
-        goto cleanup;
+static void set_request_headers(esp_http_client_handle_t client, uint32_t offset, const char *etag)
+{
+    // Set User-Agent header (required by GitHub)
+    // Use simple User-Agent like in commit ed2bc9a
+    esp_http_client_set_header(client, "User-Agent", "ESP32-OTA/1.0");
+    esp_http_client_set_header(client, "Accept", "*/*");
+
+    if (offset > 0) {
+        char range[32];
+        snprintf(range, sizeof(range), "bytes=%lu-", (unsigned long)offset);
+        esp_http_client_set_header(client, "Range", range);
+        // A changed image then comes back whole (200) instead of as a bad splice.
+        // Weak validators are not allowed in If-Range.
+        if (etag[0] != '\0' && strncmp(etag, "W/", 2) != 0) {
+            esp_http_client_set_header(client, "If-Range", etag);
+        }
+    }
+}
+
+// Connect to url, following redirects, and request the image from offset onwards.
+// On success *out_client is open with the response headers fetched.
+static esp_err_t open_image_stream(const char *url, uint32_t offset, const char *etag, bool is_sim_mode,
+                                   esp_http_client_handle_t *out_client, int *out_status, int *out_length)
+{
+    esp_err_t err = ESP_OK;
+    esp_http_client_handle_t client = NULL;
+    struct ifreq ppp_ifreq;
+    bool ppp_if_valid = false;
+
+    if (is_sim_mode) {
+        if (!a7670c_ppp_is_connected()) {
+            ESP_LOGE(TAG, "PPP not connected - cannot perform OTA over SIM");
+            set_failed("PPP not connected");
+            return ESP_ERR_INVALID_STATE;
+        }
+        ppp_if_valid = bind_ppp_interface(&ppp_ifreq);
+        if (ppp_if_valid) {
+            ESP_LOGI(TAG, "PPP interface name: %s", ppp_ifreq.ifr_name);
+        }
     }
 
     // Current URL for redirect following
-    char *current_url = strdup(ota_info.update_url);
+    char *current_url = strdup(url);
     if (!current_url) {
         ESP_LOGE(TAG, "Failed to allocate URL buffer");
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Memory allocation failed");
-        xSemaphoreGive(ota_mutex);
-        goto cleanup;
+        set_failed("Memory allocation failed");
+        return ESP_ERR_NO_MEM;
     }
 
     // Handle redirects by recreating client for each redirect (more reliable than reusing)
@@ -356,8 +841,10 @@ static void ota_download_task(void *pvParameter)
     int content_length = 0;
 
     while (redirect_count < MAX_REDIRECTS) {
-        // Clear redirect location from previous iteration
+        // Clear captured headers from previous iteration
         redirect_location[0] = '\0';
+        response_etag[0] = '\0';
+        response_range[0] = '\0';
 
         // Check if URL is from GitHub or GitHub CDN (releases use CDN with different certificates)
         bool is_github_url = (strstr(current_url, "github.com") != NULL) ||
@@ -390,7 +877,7 @@ static void ota_download_task(void *pvParameter)
             // Now that MQTT is stopped first, we have enough memory (Min Free: 51KB+)
             .crt_bundle_attach = is_github_url ? NULL : esp_crt_bundle_attach,
             .disable_auto_redirect = true,        // Always manual redirect (auto doesn't work with streaming API)
-            .event_handler = http_event_handler,  // Capture Location header for redirects
+            .event_handler = http_event_handler,  // Capture Location/ETag/Content-Range headers
             .if_name = (is_sim_mode && ppp_if_valid) ? &ppp_ifreq : NULL,
         };
 
@@ -398,18 +885,11 @@ static void ota_download_task(void *pvParameter)
         client = esp_http_client_init(&http_config);
         if (!client) {
             ESP_LOGE(TAG, "Failed to create HTTP client");
-            xSemaphoreTake(ota_mutex, portMAX_DELAY);
-            ota_info.status = OTA_STATUS_FAILED;
-            snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Failed to create HTTP client");
-            xSemaphoreGive(ota_mutex);
+            set_failed("Failed to create HTTP client");
             free(current_url);
-            goto cleanup;
+            return ESP_FAIL;
         }
-
-        // Set User-Agent header (required by GitHub)
-        // Use simple User-Agent like in commit ed2bc9a
-        esp_http_client_set_header(client, "User-Agent", "ESP32-OTA/1.0");
-        esp_http_client_set_header(client, "Accept", "*/*");
+        set_request_headers(client, offset, etag);
 
         // Open HTTP connection with retry logic for SIM/PPP mode
         // TLS handshake can fail on mobile networks due to latency/packet loss
@@ -442,23 +922,18 @@ static void ota_download_task(void *pvParameter)
                     ESP_LOGE(TAG, "Failed to recreate HTTP client");
                     break;
                 }
-                esp_http_client_set_header(client, "User-Agent", "ESP32-OTA/1.0");
-                esp_http_client_set_header(client, "Accept", "*/*");
+                set_request_headers(client, offset, etag);
             }
         }
 
         if (!connection_success) {
             ESP_LOGE(TAG, "Failed to open HTTP connection after %d attempts: %s", max_connect_retries, esp_err_to_name(err));
-            xSemaphoreTake(ota_mutex, portMAX_DELAY);
-            ota_info.status = OTA_STATUS_FAILED;
-            snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Connection failed after %d retries", max_connect_retries);
-            xSemaphoreGive(ota_mutex);
+            set_failed("Connection failed after %d retries", max_connect_retries);
             if (client) {
                 esp_http_client_cleanup(client);
-                client = NULL;
             }
             free(current_url);
-            goto cleanup;
+            return err != ESP_OK ? err : ESP_FAIL;
         }
         ESP_LOGI(TAG, "HTTPS connection established successfully");
 
@@ -480,13 +955,9 @@ static void ota_download_task(void *pvParameter)
                 ESP_LOGE(TAG, "No Location header captured by event handler");
                 esp_http_client_close(client);
                 esp_http_client_cleanup(client);
-                client = NULL;
-                xSemaphoreTake(ota_mutex, portMAX_DELAY);
-                ota_info.status = OTA_STATUS_FAILED;
-                snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Redirect: no Location header");
-                xSemaphoreGive(ota_mutex);
+                set_failed("Redirect: no Location header");
                 free(current_url);
-                goto cleanup;
+                return ESP_FAIL;
             }
 
             ESP_LOGI(TAG, "Redirecting to: %s", redirect_location);
@@ -501,12 +972,9 @@ static void ota_download_task(void *pvParameter)
 
             if (!new_url) {
                 ESP_LOGE(TAG, "Failed to allocate redirect URL");
-                xSemaphoreTake(ota_mutex, portMAX_DELAY);
-                ota_info.status = OTA_STATUS_FAILED;
-                snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Memory allocation failed");
-                xSemaphoreGive(ota_mutex);
+                set_failed("Memory allocation failed");
                 free(current_url);
-                goto cleanup;
+                return ESP_ERR_NO_MEM;
             }
 
             // Update current URL for next iteration
@@ -522,148 +990,475 @@ static void ota_download_task(void *pvParameter)
 
     // Free URL buffer - no longer needed
     free(current_url);
-    current_url = NULL;
 
     if (redirect_count >= MAX_REDIRECTS) {
         ESP_LOGE(TAG, "Too many redirects");
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Too many redirects");
-        xSemaphoreGive(ota_mutex);
-        goto cleanup;
+        set_failed("Too many redirects");
+        return ESP_FAIL;
     }
 
-    if (status_code != 200) {
-        ESP_LOGE(TAG, "HTTP error: %d", status_code);
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "HTTP error: %d", status_code);
-        xSemaphoreGive(ota_mutex);
-        goto cleanup;
+    *out_client = client;
+    *out_status = status_code;
+    *out_length = content_length;
+    return ESP_OK;
+}
+
+// The site peer could not supply the image: drop what it sent and start over
+// from the cloud URL
+static void peer_fallback(esp_http_client_handle_t *client, bool *ota_started)
+{
+    ESP_LOGW(TAG, "Peer download failed - downloading from %s", ota_info.update_url);
+    if (*client) {
+        esp_http_client_close(*client);
+        esp_http_client_cleanup(*client);
+        *client = NULL;
+    }
+    if (*ota_started) {
+        esp_ota_abort(ota_handle);
+        ota_handle = 0;
+        *ota_started = false;
     }
+    delta_free();
+    peer_source = false;
+    image_written = 0;
+    image_crc = 0;
+    stream_pos = 0;
+    pipe_checkpoint = 0;
+    resume.written = 0;
+    resume.crc = 0;
+    resume.total = 0;
+    resume.etag[0] = '\0';
 
-    if (content_length > 0) {
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.total_bytes = content_length;
-        xSemaphoreGive(ota_mutex);
-        ESP_LOGI(TAG, "Firmware size: %d bytes", content_length);
+    xSemaphoreTake(ota_mutex, portMAX_DELAY);
+    ota_info.status = OTA_STATUS_DOWNLOADING;
+    ota_info.bytes_downloaded = 0;
+    ota_info.total_bytes = 0;
+    ota_info.progress = 0;
+    ota_info.error_msg[0] = '\0';
+    xSemaphoreGive(ota_mutex);
+}
+
+static void ota_download_task(void *pvParameter)
+{
+    ESP_LOGI(TAG, "OTA download task started");
+    esp_err_t err;
+
+    // Set OTA in progress flag - MQTT should not reconnect during OTA
+    ota_in_progress = true;
+
+    // Check network mode for logging only
+    system_config_t *sys_config = get_system_config();
+    bool is_sim_mode = (sys_config != NULL && sys_config->network_mode == NETWORK_MODE_SIM);
+
+    if (is_sim_mode) {
+        ESP_LOGI(TAG, "========================================");
+        ESP_LOGI(TAG, "SIM Mode - Using ESP32 HTTP over PPP");
+        ESP_LOGI(TAG, "========================================");
+
+        // Log memory status
+        ESP_LOGI(TAG, "Free heap before SIM OTA: %lu bytes", esp_get_free_heap_size());
+
+        // CRITICAL: Stop MQTT to free PPP for exclusive OTA use
+        // Two concurrent TLS sessions over cellular PPP cause connection resets
+        extern void mqtt_stop_for_ota(void);
+        ESP_LOGI(TAG, "Stopping MQTT to free PPP connection for OTA...");
+        mqtt_stop_for_ota();
+        ESP_LOGI(TAG, "Free heap after stopping MQTT: %lu bytes", esp_get_free_heap_size());
+
+        // CRITICAL: Verify PPP is actually connected before attempting OTA
+        if (!a7670c_ppp_is_connected()) {
+            ESP_LOGE(TAG, "PPP not connected - cannot perform OTA over SIM");
+            set_failed("PPP not connected");
+            ota_in_progress = false;
+            ota_task_handle = NULL;
+            vTaskDelete(NULL);
+            return;
+        }
+        ESP_LOGI(TAG, "PPP connection verified - proceeding with OTA");
+
+        if (a7670c_ppp_get_netif() == NULL) {
+            ESP_LOGE(TAG, "PPP netif not available - cannot route OTA traffic");
+            set_failed("PPP interface unavailable");
+            ota_in_progress = false;
+            ota_task_handle = NULL;
+            vTaskDelete(NULL);
+            return;
+        }
+
+        // Give PPP connection time to stabilize before starting TLS
+        // Cellular networks need more time than WiFi for stable data connection
+        ESP_LOGI(TAG, "Waiting 5 seconds for PPP/cellular network to stabilize...");
+        vTaskDelay(pdMS_TO_TICKS(5000));
+
+        // Get IP address to verify network is working
+        char ip_str[32] = {0};
+        if (a7670c_ppp_get_ip_info(ip_str, sizeof(ip_str)) == ESP_OK) {
+            ESP_LOGI(TAG, "PPP IP address: %s", ip_str);
+        }
+
+        ESP_LOGI(TAG, "PPP stabilization complete, starting OTA download...");
+        ESP_LOGI(TAG, "Free heap after PPP setup: %lu bytes", esp_get_free_heap_size());
+    }
+
+    // Both WiFi and SIM mode use ESP32 HTTP client
+    // For SIM mode, it works over the PPP connection
+    ESP_LOGI(TAG, "%s - Using ESP32 HTTP client", is_sim_mode ? "SIM Mode" : "WiFi Mode");
+
+    // CRITICAL: Stop MQTT for WiFi mode too - two TLS connections exhaust heap
+    // Min Free Heap was dropping to ~50 bytes causing TLS handshake failures
+    if (!is_sim_mode) {
+        extern void mqtt_stop_for_ota(void);
+        ESP_LOGI(TAG, "Stopping MQTT to free memory for OTA TLS connection...");
+        mqtt_stop_for_ota();
+        vTaskDelay(pdMS_TO_TICKS(1000));  // Give MQTT time to clean up
+        ESP_LOGI(TAG, "Free heap after stopping MQTT: %lu bytes", esp_get_free_heap_size());
+    }
+
+    esp_http_client_handle_t client = NULL;
+    bool ota_started = false;
+    bool keep_resume = false;     // Leave the NVS record so the download can continue later
+    int last_logged_progress = -10;
+    int retries;
+    uint8_t image_sha[32];
+
+    xSemaphoreTake(ota_mutex, portMAX_DELAY);
+    ota_info.status = OTA_STATUS_DOWNLOADING;
+    xSemaphoreGive(ota_mutex);
+    notify_status_change(OTA_STATUS_DOWNLOADING, "Starting download");
+
+    // Receive buffers and the flash writer task
+    if (pipe_start() != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to allocate download buffers");
+        set_failed("Memory allocation failed");
+        goto cleanup;
     }
 
     // Get OTA partition (same as web upload)
     ota_partition = esp_ota_get_next_update_partition(NULL);
     if (ota_partition == NULL) {
         ESP_LOGE(TAG, "No OTA partition available");
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "No OTA partition");
-        xSemaphoreGive(ota_mutex);
+        set_failed("No OTA partition");
         goto cleanup;
     }
 
+    // Continue an earlier download of the same URL into the same partition if
+    // what it left in flash is intact; otherwise start a fresh record
+    uint32_t offset = 0;
+    if (resume_load(&resume) && strcmp(resume.url, ota_info.update_url) == 0 &&
+        strcmp(resume.partition, ota_partition->label) == 0 && resume.written > 0) {
+        if (resume_verify(ota_partition, &resume, pipe_bufs[0], OTA_BUF_SIZE)) {
+            offset = resume.written;
+            ESP_LOGI(TAG, "Resuming download at %lu/%lu bytes", resume.written, resume.total);
+        } else {
+            ESP_LOGW(TAG, "Partially written image no longer matches - downloading from the start");
+        }
+    }
+    if (offset == 0) {
+        memset(&resume, 0, sizeof(resume));
+        resume.magic = OTA_RESUME_MAGIC;
+        strncpy(resume.url, ota_info.update_url, sizeof(resume.url) - 1);
+        strncpy(resume.version, ota_info.new_version, sizeof(resume.version) - 1);
+        strncpy(resume.partition, ota_partition->label, sizeof(resume.partition) - 1);
+    }
+    image_written = offset;
+    image_crc = resume.crc;
+    stream_pos = offset;
+    pipe_checkpoint = offset;
+
+    // Another gateway on the site may already hold this exact image. It is not
+    // checkpointed to NVS: a reboot resumes from the cloud URL.
+    peer_source = false;
+    if (offset == 0 && expected_sha_set) {
+        uint32_t peer_size = 0;
+        if (ota_peer_find(expected_sha, peer_url, sizeof(peer_url), &peer_size)) {
+            peer_source = true;
+            resume.total = peer_size;
+        }
+    }
+
     ESP_LOGI(TAG, "Writing to partition: %s @ 0x%lx", ota_partition->label, ota_partition->address);
 
-    // Start OTA (same as web upload)
-    err = esp_ota_begin(ota_partition, OTA_SIZE_UNKNOWN, &ota_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(err));
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "OTA begin failed: %s", esp_err_to_name(err));
-        xSemaphoreGive(ota_mutex);
-        goto cleanup;
-    }
-    ota_started = true;
+    // Each pass opens the stream at stream_pos; a link drop mid-body goes
+    // round again with a Range request instead of starting over
+download:
+    retries = 0;
+    last_logged_progress = -10;
+    while (true) {
+        int status_code = 0;
+        int content_length = 0;
+        uint32_t attempt_start = stream_pos;
+
+        // Peers are reached over the LAN or the tunnel, not bound to PPP
+        err = open_image_stream(peer_source ? peer_url : ota_info.update_url, stream_pos, resume.etag,
+                                is_sim_mode && !peer_source, &client, &status_code, &content_length);
+        if (err == ESP_OK) {
+            if (status_code == 206 && stream_pos > 0) {
+                uint32_t start = 0, total = 0;
+                if (!parse_content_range(response_range, &start, &total) || start != stream_pos ||
+                    (resume.total > 0 && total != resume.total)) {
+                    ESP_LOGW(TAG, "Unexpected Content-Range '%s' for offset %lu - restarting download",
+                             response_range, stream_pos);
+                    status_code = 0;   // Treated like an image change below
+                } else {
+                    resume.total = total;
+                }
+            }
 
-    xSemaphoreTake(ota_mutex, portMAX_DELAY);
-    ota_info.status = OTA_STATUS_INSTALLING;
-    ota_info.bytes_downloaded = 0;
-    xSemaphoreGive(ota_mutex);
-    notify_status_change(OTA_STATUS_INSTALLING, "Writing firmware to flash");
+            if (status_code == 200 || (status_code == 0 && stream_pos > 0) ||
+                (status_code == 416 && stream_pos > 0)) {
+                // Full body, or the file changed since the partial download
+                if (stream_pos > 0) {
+                    ESP_LOGW(TAG, "Server sent %s - discarding %lu downloaded bytes",
+                             status_code == 200 ? "the whole file" : "an unusable range", stream_pos);
+                    if (ota_started) {
+                        esp_ota_abort(ota_handle);
+                        ota_handle = 0;
+                        ota_started = false;
+                    }
+                    delta_free();
+                    image_written = 0;
+                    image_crc = 0;
+                    stream_pos = 0;
+                    pipe_checkpoint = 0;
+                    resume.written = 0;
+                    resume.crc = 0;
+                    resume.total = 0;
+                    resume_clear();
+                }
+                if (status_code != 200) {
+                    // Ask again for the whole file
+                    esp_http_client_close(client);
+                    esp_http_client_cleanup(client);
+                    client = NULL;
+                    if (++retries > OTA_MAX_RETRY) {
+                        set_failed("Server rejected resume");
+                        goto cleanup;
+                    }
+                    continue;
+                }
+                if (content_length > 0) {
+                    resume.total = content_length;
+                }
+            } else if (status_code != 206 && peer_source) {
+                ESP_LOGW(TAG, "Peer answered HTTP %d", status_code);
+                peer_fallback(&client, &ota_started);
+                goto download;
+            } else if (status_code != 206) {
+                ESP_LOGE(TAG, "HTTP error: %d", status_code);
+                set_failed("HTTP error: %d", status_code);
+                goto cleanup;
+            }
 
-    // Download and write firmware (same approach as web upload)
-    int bytes_read = 0;
-    int total_read = 0;
+            if (response_etag[0] != '\0') {
+                strncpy(resume.etag, response_etag, sizeof(resume.etag) - 1);
+            }
 
-    while ((bytes_read = esp_http_client_read(client, download_buffer, DOWNLOAD_BUFFER_SIZE)) > 0) {
-        // Check for cancel request
-        if (ota_cancel_requested) {
-            ESP_LOGW(TAG, "OTA cancelled by user");
             xSemaphoreTake(ota_mutex, portMAX_DELAY);
-            ota_info.status = OTA_STATUS_IDLE;
-            snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Cancelled by user");
+            ota_info.total_bytes = resume.total;
+            ota_info.bytes_downloaded = stream_pos;
             xSemaphoreGive(ota_mutex);
-            goto cleanup;
-        }
+            if (resume.total > 0) {
+                ESP_LOGI(TAG, "Firmware size: %lu bytes", resume.total);
+            }
 
-        // Write to flash (same as web upload)
-        err = esp_ota_write(ota_handle, download_buffer, bytes_read);
-        if (err != ESP_OK) {
-            ESP_LOGE(TAG, "esp_ota_write failed: %s", esp_err_to_name(err));
-            xSemaphoreTake(ota_mutex, portMAX_DELAY);
-            ota_info.status = OTA_STATUS_FAILED;
-            snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Write failed: %s", esp_err_to_name(err));
-            xSemaphoreGive(ota_mutex);
-            goto cleanup;
-        }
+            if (!ota_started) {
+                // A new image only has its first sector erased here; the writer
+                // erases the rest as it goes. A resumed image keeps the sectors
+                // already written and erases the rest up front.
+                if (image_written == 0) {
+                    err = esp_ota_begin(ota_partition, SPI_FLASH_SEC_SIZE, &ota_handle);
+                    erased_end = SPI_FLASH_SEC_SIZE;
+                } else {
+                    err = esp_ota_resume(ota_partition, OTA_SIZE_UNKNOWN, image_written, &ota_handle);
+                    erased_end = ota_partition->size;
+                }
+                if (err != ESP_OK) {
+                    ESP_LOGE(TAG, "esp_ota_%s failed: %s", image_written ? "resume" : "begin", esp_err_to_name(err));
+                    set_failed("OTA begin failed: %s", esp_err_to_name(err));
+                    goto cleanup;
+                }
+                ota_started = true;
+
+                xSemaphoreTake(ota_mutex, portMAX_DELAY);
+                ota_info.status = OTA_STATUS_INSTALLING;
+                xSemaphoreGive(ota_mutex);
+                notify_status_change(OTA_STATUS_INSTALLING, "Writing firmware to flash");
+            }
 
-        total_read += bytes_read;
+            // Receive into free buffers; the writer task puts them in flash
+            int bytes_read = 0;
+            pipe_preerase = true;
 
-        // Update progress
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.bytes_downloaded = total_read;
-        if (ota_info.total_bytes > 0) {
-            ota_info.progress = (total_read * 100) / ota_info.total_bytes;
-        }
-        xSemaphoreGive(ota_mutex);
+            while (true) {
+                uint8_t *buf;
+                xQueueReceive(pipe_free, &buf, portMAX_DELAY);
+                bytes_read = esp_http_client_read(client, (char *)buf, OTA_BUF_SIZE);
+                if (bytes_read <= 0 || ota_cancel_requested || pipe_err != ESP_OK) {
+                    xQueueSend(pipe_free, &buf, 0);
+                    break;
+                }
 
-        // Call progress callback
-        if (progress_callback) {
-            progress_callback(ota_info.progress, ota_info.bytes_downloaded, ota_info.total_bytes);
-        }
+                // A delta patch is recognised by its first bytes. It is small, so
+                // it is only resumed within this task, not after a reboot.
+                if (stream_pos == 0 && delta_is_patch(buf, bytes_read)) {
+                    err = delta_begin();
+                    if (err != ESP_OK) {
+                        xQueueSend(pipe_free, &buf, 0);
+                        set_failed("Delta patch: out of memory");
+                        goto cleanup;
+                    }
+                    resume_clear();
+                }
+
+                pipe_msg_t msg = { .op = PIPE_WRITE, .buf = buf, .len = bytes_read };
+                xQueueSend(pipe_full, &msg, portMAX_DELAY);
+                stream_pos += bytes_read;
+
+                // Update progress
+                xSemaphoreTake(ota_mutex, portMAX_DELAY);
+                ota_info.bytes_downloaded = stream_pos;
+                if (ota_info.total_bytes > 0) {
+                    ota_info.progress = ((uint64_t)stream_pos * 100) / ota_info.total_bytes;
+                }
+                xSemaphoreGive(ota_mutex);
+
+                // Call progress callback
+                if (progress_callback) {
+                    progress_callback(ota_info.progress, ota_info.bytes_downloaded, ota_info.total_bytes);
+                }
+
+                // Log progress every 10%
+                if (ota_info.progress >= last_logged_progress + 10) {
+                    ESP_LOGI(TAG, "Download progress: %d%% (%lu/%lu bytes)",
+                             ota_info.progress, stream_pos, ota_info.total_bytes);
+                    last_logged_progress = ota_info.progress;
+                }
+            }
+            pipe_sync();
+
+            // Check for cancel request
+            if (ota_cancel_requested) {
+                ESP_LOGW(TAG, "OTA cancelled by user");
+                xSemaphoreTake(ota_mutex, portMAX_DELAY);
+                ota_info.status = OTA_STATUS_IDLE;
+                snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Cancelled by user");
+                xSemaphoreGive(ota_mutex);
+                goto cleanup;
+            }
+            if (pipe_err != ESP_OK) {
+                ESP_LOGE(TAG, "%s", pipe_error);
+                set_failed("%s", pipe_error);
+                goto cleanup;
+            }
+
+            bool complete = bytes_read == 0 &&
+                            (resume.total > 0 ? stream_pos >= resume.total
+                                              : esp_http_client_is_complete_data_received(client));
+            esp_http_client_close(client);
+            esp_http_client_cleanup(client);
+            client = NULL;
 
-        // Log progress every 10%
-        if (ota_info.progress >= last_logged_progress + 10) {
-            ESP_LOGI(TAG, "Download progress: %d%% (%d/%lu bytes)",
-                     ota_info.progress, total_read, ota_info.total_bytes);
-            last_logged_progress = ota_info.progress;
+            if (complete) {
+                break;      // Whole file received
+            }
+            ESP_LOGW(TAG, "Download interrupted at %lu/%lu bytes", stream_pos, resume.total);
+        } else if (err == ESP_ERR_NO_MEM) {
+            if (!delta && !peer_source) {
+                resume_save(&resume);
+            }
+            keep_resume = !delta && !peer_source && resume.written > 0;
+            goto cleanup;
         }
-    }
 
-    if (bytes_read < 0) {
-        ESP_LOGE(TAG, "HTTP read error");
+        // Link dropped or the connection could not be opened: keep what is in
+        // flash and try again from there
+        if (!delta && !peer_source) {
+            resume_save(&resume);
+            pipe_checkpoint = resume.written;
+        }
+        if (stream_pos > attempt_start) {
+            retries = 0;
+        }
+        if (++retries > OTA_MAX_RETRY && peer_source) {
+            peer_fallback(&client, &ota_started);
+            goto download;
+        }
+        if (retries > OTA_MAX_RETRY) {
+            ESP_LOGE(TAG, "Giving up after %d retries - %lu bytes kept for resume", OTA_MAX_RETRY, resume.written);
+            set_failed("Interrupted at %lu/%lu bytes", stream_pos, resume.total);
+            keep_resume = !delta && resume.written > 0;
+            goto cleanup;
+        }
+        int retry_delay = is_sim_mode ? 10000 : 2000;
+        ESP_LOGI(TAG, "Retry %d/%d in %d ms, resuming at %lu bytes", retries, OTA_MAX_RETRY, retry_delay, stream_pos);
+        vTaskDelay(pdMS_TO_TICKS(retry_delay));
         xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Download failed");
+        ota_info.status = ota_started ? OTA_STATUS_INSTALLING : OTA_STATUS_DOWNLOADING;
+        ota_info.error_msg[0] = '\0';
         xSemaphoreGive(ota_mutex);
-        goto cleanup;
     }
 
-    ESP_LOGI(TAG, "Download complete: %d bytes", total_read);
+    ESP_LOGI(TAG, "Download complete: %lu bytes", stream_pos);
+
+    // The rebuilt image must match the SHA-256 the patch was made for
+    if (delta) {
+        err = delta_finish();
+        if (err != ESP_OK && peer_source) {
+            peer_fallback(&client, &ota_started);
+            goto download;
+        }
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Delta patch failed: %s", delta->error);
+            set_failed("Delta: %s", delta->error);
+            goto cleanup;
+        }
+        ESP_LOGI(TAG, "Delta patch applied: %lu-byte image verified", image_written);
+        delta_free();
+    }
 
     // Finish OTA (same as web upload - this validates the firmware)
     err = esp_ota_end(ota_handle);
     ota_handle = 0;
     ota_started = false;
 
+    if (err != ESP_OK && peer_source) {
+        peer_fallback(&client, &ota_started);
+        goto download;
+    }
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "esp_ota_end failed: %s", esp_err_to_name(err));
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Validation failed: %s", esp_err_to_name(err));
-        xSemaphoreGive(ota_mutex);
+        set_failed("Validation failed: %s", esp_err_to_name(err));
         goto cleanup;
     }
 
+    // Hashed after esp_ota_end(), which writes any bytes it still held back
+    err = partition_sha256(ota_partition, image_written, pipe_bufs[0], OTA_BUF_SIZE, image_sha);
+    if (err == ESP_OK && expected_sha_set && memcmp(image_sha, expected_sha, sizeof(image_sha)) != 0) {
+        if (peer_source) {
+            ESP_LOGW(TAG, "Image from peer does not match the expected SHA-256");
+            peer_fallback(&client, &ota_started);
+            goto download;
+        }
+        err = ESP_ERR_INVALID_CRC;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Image hash check failed: %s", esp_err_to_name(err));
+        set_failed("SHA-256 mismatch");
+        goto cleanup;
+    }
+    if (peer_source) {
+        ESP_LOGI(TAG, "Image from site peer verified against the expected SHA-256");
+    }
+
     // Set boot partition
     err = esp_ota_set_boot_partition(ota_partition);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "esp_ota_set_boot_partition failed: %s", esp_err_to_name(err));
-        xSemaphoreTake(ota_mutex, portMAX_DELAY);
-        ota_info.status = OTA_STATUS_FAILED;
-        snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Set boot failed: %s", esp_err_to_name(err));
-        xSemaphoreGive(ota_mutex);
+        set_failed("Set boot failed: %s", esp_err_to_name(err));
         goto cleanup;
     }
+    resume_clear();
+    ota_peer_note_installed(ota_info.new_version, image_written, image_sha);
 
     // Success!
     xSemaphoreTake(ota_mutex, portMAX_DELAY);
@@ -677,15 +1472,7 @@ static void ota_download_task(void *pvParameter)
     ESP_LOGI(TAG, "Rebooting in 5 seconds to apply update...");
 
     // Clean up before reboot
-    if (client) {
-        esp_http_client_close(client);
-        esp_http_client_cleanup(client);
-        client = NULL;
-    }
-    if (download_buffer) {
-        free(download_buffer);
-        download_buffer = NULL;
-    }
+    pipe_stop();
 
     // Wait 5 seconds for status to be reported, then reboot
     vTaskDelay(pdMS_TO_TICKS(5000));
@@ -699,17 +1486,21 @@ cleanup:
         notify_status_change(OTA_STATUS_FAILED, ota_info.error_msg);
     }
 
+    // The partition is left as written so a later ota_start_update() of the
+    // same URL, or ota_resume_pending() after a reboot, can pick it up
+    pipe_stop();
     if (ota_started && ota_handle) {
         esp_ota_abort(ota_handle);
         ota_handle = 0;
     }
+    delta_free();
+    if (!keep_resume) {
+        resume_clear();
+    }
     if (client) {
         esp_http_client_close(client);
         esp_http_client_cleanup(client);
     }
-    if (download_buffer) {
-        free(download_buffer);
-    }
 
     // Restart MQTT after OTA cleanup (was stopped to free memory for TLS)
     // This applies to both WiFi and SIM modes now
@@ -740,11 +1531,25 @@ esp_err_t ota_write_chunk(const uint8_t* data, size_t len, bool is_first, bool i
 
         ESP_LOGI(TAG, "Writing to partition: %s @ 0x%lx", ota_partition->label, ota_partition->address);
 
+        // esp_ota_begin() erases what an interrupted download left there
+        resume_clear();
+
         err = esp_ota_begin(ota_partition, OTA_SIZE_UNKNOWN, &ota_handle);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "esp_ota_begin failed: %s", esp_err_to_name(err));
             return err;
         }
+        erased_end = ota_partition->size;
+        image_written = 0;
+
+        // An uploaded .delta is applied against the running image as it arrives
+        delta_free();
+        if (data && delta_is_patch(data, len) && delta_begin() != ESP_OK) {
+            ESP_LOGE(TAG, "No memory for delta patch");
+            esp_ota_abort(ota_handle);
+            ota_handle = 0;
+            return ESP_ERR_NO_MEM;
+        }
 
         xSemaphoreTake(ota_mutex, portMAX_DELAY);
         ota_info.status = OTA_STATUS_INSTALLING;
@@ -754,11 +1559,22 @@ esp_err_t ota_write_chunk(const uint8_t* data, size_t len, bool is_first, bool i
     }
 
     if (data && len > 0) {
-        err = esp_ota_write(ota_handle, data, len);
+        if (delta) {
+            err = delta_write(data, len);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Delta patch failed: %s", delta->error);
+            }
+        } else {
+            err = esp_ota_write(ota_handle, data, len);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "esp_ota_write failed: %s", esp_err_to_name(err));
+            }
+            image_written += len;
+        }
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "esp_ota_write failed: %s", esp_err_to_name(err));
             esp_ota_abort(ota_handle);
             ota_handle = 0;
+            delta_free();
             return err;
         }
 
@@ -768,6 +1584,22 @@ esp_err_t ota_write_chunk(const uint8_t* data, size_t len, bool is_first, bool i
     }
 
     if (is_last) {
+        if (delta) {
+            err = delta_finish();
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Delta patch failed: %s", delta->error);
+                xSemaphoreTake(ota_mutex, portMAX_DELAY);
+                ota_info.status = OTA_STATUS_FAILED;
+                snprintf(ota_info.error_msg, sizeof(ota_info.error_msg), "Delta: %s", delta->error);
+                xSemaphoreGive(ota_mutex);
+                esp_ota_abort(ota_handle);
+                ota_handle = 0;
+                delta_free();
+                return err;
+            }
+            delta_free();
+        }
+
         err = esp_ota_end(ota_handle);
         ota_handle = 0;
 
@@ -790,6 +1622,16 @@ esp_err_t ota_write_chunk(const uint8_t* data, size_t len, bool is_first, bool i
             return err;
         }
 
+        // Staged for site peers once it boots and marks itself valid
+        uint8_t *buf = malloc(OTA_BUF_SIZE);
+        uint8_t sha[32];
+        esp_app_desc_t desc;
+        if (buf && partition_sha256(ota_partition, image_written, buf, OTA_BUF_SIZE, sha) == ESP_OK &&
+            esp_ota_get_partition_description(ota_partition, &desc) == ESP_OK) {
+            ota_peer_note_installed(desc.version, image_written, sha);
+        }
+        free(buf);
+
         xSemaphoreTake(ota_mutex, portMAX_DELAY);
         ota_info.status = OTA_STATUS_PENDING_REBOOT;
         ota_info.progress = 100;
@@ -841,6 +1683,9 @@ void ota_mark_valid(void)
     if (ota_info.status == OTA_STATUS_ROLLBACK) {
         ota_info.status = OTA_STATUS_IDLE;
     }
+
+    // This image has proven itself; copy it to SD if it was just installed
+    ota_peer_stage_running();
 }
 
 bool ota_is_rollback(void)
@@ -5,6 +5,10 @@
  * Features:
  * - HTTPS firmware download from URL (GitHub Releases, Azure Blob, etc.)
  * - Automatic rollback on boot failure (3 attempts)
+ * - Interrupted downloads resume with HTTP Range requests, also after a reboot
+ * - Delta patches (tools/ota_delta.py) are applied against the running image
+ * - Network receive and flash writes run in separate tasks, with sectors erased ahead
+ * - Images are shared with other gateways on the site (ota_peer.h)
  * - Progress reporting via callbacks
  * - Thread-safe status updates
  */
@@ -76,6 +80,32 @@ esp_err_t ota_init(void);
  */
 esp_err_t ota_start_update(const char* firmware_url, const char* version);
 
+/**
+ * @brief Start OTA update of a known image
+ *
+ * As ota_start_update(), but the installed image must hash to sha256_hex, and
+ * a gateway on the same site that holds the image is downloaded from instead
+ * of the URL when one is found (see ota_peer.h).
+ *
+ * @param firmware_url HTTPS URL of firmware binary
+ * @param version Version string of new firmware (for logging)
+ * @param sha256_hex SHA-256 of the .bin as 64 hex digits, or NULL
+ * @return ESP_OK if download started, ESP_ERR_INVALID_ARG for a malformed hash
+ */
+esp_err_t ota_start_update_verified(const char* firmware_url, const char* version, const char* sha256_hex);
+
+/**
+ * @brief Continue a download that a reboot interrupted
+ *
+ * Download progress is saved to NVS every OTA_RESUME_CHECKPOINT_BYTES and the
+ * partially written partition is kept, so the download picks up where it
+ * stopped. Call once the network is up. ota_start_update() with the same URL
+ * resumes the same way.
+ *
+ * @return ESP_OK if the download was restarted, ESP_ERR_NOT_FOUND if none is pending
+ */
+esp_err_t ota_resume_pending(void);
+
 /**
  * @brief Start OTA update from binary data (for web upload)
  *
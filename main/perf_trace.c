@@ -0,0 +1,453 @@
+// perf_trace.c - Latency histograms and an on-demand event trace (see perf_trace.h)
+
+#include "perf_trace.h"
+#include "iot_configs.h"
+
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "PERF";
+
+// Bucket i counts samples below perf_bucket_bounds_us[i]; the last one the rest (>= 5 s)
+static const uint32_t perf_bucket_bounds_us[PERF_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+    50000, 100000, 250000, 500000, 1000000, 2500000, 5000000
+};
+
+static const char *const s_metric_names[PERF_METRIC_COUNT] = {
+    "modbus", "sensor_decode", "payload_build", "telemetry_cycle",
+    "mqtt_puback", "sd_append", "sd_ack", "httpd"
+};
+
+typedef struct {
+    bool used;
+    uint8_t slave_id;
+    perf_hist_t hist;
+} slave_hist_t;
+
+static perf_hist_t s_hist[PERF_METRIC_COUNT];
+static slave_hist_t s_slaves[PERF_MODBUS_SLAVES];
+static uint32_t s_slaves_other = 0;        // Transactions with slaves beyond the table
+static int64_t s_since_us = 0;             // Last reset
+static portMUX_TYPE s_hist_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ---- Trace ring ------------------------------------------------------------
+
+typedef enum {
+    EVT_SWITCH = 0,             // id = task switched in
+    EVT_SPAN                    // id = metric, task = task that recorded it
+} trace_kind_t;
+
+typedef struct {
+    uint32_t ts_us;             // From capture start (span start for spans)
+    uint32_t dur_us;
+    uint8_t kind;
+    uint8_t core;
+    uint8_t id;
+    uint8_t task;
+    uint16_t arg;               // Modbus slave for PERF_MODBUS spans
+} trace_event_t;
+
+#define TASK_OTHER 0xFF         // Task table full
+
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];
+} trace_task_t;
+
+// Touched by the switch hook: DRAM only, under s_trace_lock
+static trace_event_t *s_ring = NULL;       // Allocated for the capture only
+static uint32_t s_ring_head = 0;           // Events recorded (oldest is overwritten)
+static volatile bool s_tracing = false;
+static int64_t s_t0 = 0;
+static trace_task_t s_tasks[PERF_TRACE_TASKS];
+static uint8_t s_task_count = 0;
+static portMUX_TYPE s_trace_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ---- Histograms ------------------------------------------------------------
+
+static void hist_add(perf_hist_t *hist, uint32_t us)
+{
+    int b = 0;
+    while (b < PERF_BUCKETS - 1 && us >= perf_bucket_bounds_us[b]) b++;
+    hist->buckets[b]++;
+    hist->count++;
+    hist->total_us += us;
+    if (us > hist->max_us) hist->max_us = us;
+}
+
+static uint32_t duration(int64_t start_us, int64_t end_us)
+{
+    int64_t d = end_us - start_us;
+    if (d < 0) return 0;
+    return d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+}
+
+// Index of the task in s_tasks, added on first sight. A handle reused by a
+// newer task gets its own entry (names differ). Call under s_trace_lock.
+static IRAM_ATTR uint8_t task_index(TaskHandle_t handle)
+{
+    const char *name = pcTaskGetName(handle);
+    for (uint8_t i = 0; i < s_task_count; i++) {
+        if (s_tasks[i].handle != handle) continue;
+        int c = 0;
+        while (c < configMAX_TASK_NAME_LEN && s_tasks[i].name[c] == name[c] && name[c]) c++;
+        if (c == configMAX_TASK_NAME_LEN || s_tasks[i].name[c] == name[c]) {
+            return i;
+        }
+    }
+    if (s_task_count >= PERF_TRACE_TASKS) {
+        return TASK_OTHER;
+    }
+    trace_task_t *t = &s_tasks[s_task_count];
+    t->handle = handle;
+    int c = 0;
+    for (; c < configMAX_TASK_NAME_LEN - 1 && name[c]; c++) t->name[c] = name[c];
+    t->name[c] = '\0';
+    return s_task_count++;
+}
+
+// Call under s_trace_lock with s_ring set
+static IRAM_ATTR void trace_put(const trace_event_t *evt)
+{
+    s_ring[s_ring_head % PERF_TRACE_EVENTS] = *evt;
+    s_ring_head++;
+}
+
+void IRAM_ATTR perf_trace_task_switched_in(void)
+{
+    if (!s_tracing) {
+        return;
+    }
+    TaskHandle_t handle = xTaskGetCurrentTaskHandle();
+    portENTER_CRITICAL_SAFE(&s_trace_lock);
+    if (s_tracing && s_ring) {
+        trace_event_t evt = {
+            .ts_us = (uint32_t)(esp_timer_get_time() - s_t0),
+            .kind = EVT_SWITCH,
+            .core = (uint8_t)xPortGetCoreID(),
+            .id = task_index(handle),
+        };
+        trace_put(&evt);
+    }
+    portEXIT_CRITICAL_SAFE(&s_trace_lock);
+}
+
+static void trace_span(perf_metric_t metric, int64_t start_us, uint32_t dur_us, uint16_t arg)
+{
+    if (!s_tracing) {
+        return;
+    }
+    TaskHandle_t handle = xTaskGetCurrentTaskHandle();
+    uint8_t core = (uint8_t)xPortGetCoreID();
+    taskENTER_CRITICAL(&s_trace_lock);
+    if (s_tracing && s_ring && start_us >= s_t0) {
+        trace_event_t evt = {
+            .ts_us = (uint32_t)(start_us - s_t0),
+            .dur_us = dur_us,
+            .kind = EVT_SPAN,
+            .core = core,
+            .id = (uint8_t)metric,
+            .task = task_index(handle),
+            .arg = arg,
+        };
+        trace_put(&evt);
+    }
+    taskEXIT_CRITICAL(&s_trace_lock);
+}
+
+void perf_span(perf_metric_t metric, int64_t start_us, int64_t end_us)
+{
+    if (metric >= PERF_METRIC_COUNT) {
+        return;
+    }
+    uint32_t us = duration(start_us, end_us);
+    taskENTER_CRITICAL(&s_hist_lock);
+    hist_add(&s_hist[metric], us);
+    taskEXIT_CRITICAL(&s_hist_lock);
+    trace_span(metric, start_us, us, 0);
+}
+
+void perf_end(perf_metric_t metric, int64_t start_us)
+{
+    perf_span(metric, start_us, esp_timer_get_time());
+}
+
+void perf_end_modbus(uint8_t slave_id, int64_t start_us)
+{
+    uint32_t us = duration(start_us, esp_timer_get_time());
+    taskENTER_CRITICAL(&s_hist_lock);
+    hist_add(&s_hist[PERF_MODBUS], us);
+    slave_hist_t *slot = NULL;
+    for (int i = 0; i < PERF_MODBUS_SLAVES; i++) {
+        if (s_slaves[i].used && s_slaves[i].slave_id == slave_id) {
+            slot = &s_slaves[i];
+            break;
+        }
+        if (!s_slaves[i].used && !slot) {
+            slot = &s_slaves[i];
+        }
+    }
+    if (slot) {
+        slot->used = true;
+        slot->slave_id = slave_id;
+        hist_add(&slot->hist, us);
+    } else {
+        s_slaves_other++;
+    }
+    taskEXIT_CRITICAL(&s_hist_lock);
+    trace_span(PERF_MODBUS, start_us, us, slave_id);
+}
+
+// ---- Portal ----------------------------------------------------------------
+
+// Response text, flushed as a chunk whenever the buffer fills
+typedef struct {
+    httpd_req_t *req;
+    int len;
+    bool failed;                // Client went away
+    char buf[768];
+} perf_out_t;
+
+static void out_flush(perf_out_t *out)
+{
+    if (out->len > 0 && !out->failed) {
+        out->failed = httpd_resp_send_chunk(out->req, out->buf, out->len) != ESP_OK;
+    }
+    out->len = 0;
+}
+
+static void out_printf(perf_out_t *out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void out_printf(perf_out_t *out, const char *fmt, ...)
+{
+    if (out->len > (int)sizeof(out->buf) - 160) {
+        out_flush(out);
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out->buf + out->len, sizeof(out->buf) - out->len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        out->len += n < (int)sizeof(out->buf) - out->len ? n : (int)sizeof(out->buf) - out->len - 1;
+    }
+}
+
+static void out_hist(perf_out_t *out, const perf_hist_t *hist)
+{
+    out_printf(out, "{\"count\":%lu,\"avg_us\":%lu,\"max_us\":%lu,\"buckets\":[",
+               (unsigned long)hist->count,
+               (unsigned long)(hist->count ? hist->total_us / hist->count : 0),
+               (unsigned long)hist->max_us);
+    for (int b = 0; b < PERF_BUCKETS; b++) {
+        out_printf(out, "%s%lu", b ? "," : "", (unsigned long)hist->buckets[b]);
+    }
+    out_printf(out, "]}");
+}
+
+// GET /api/perf[?reset=1]
+esp_err_t perf_stats_handler(httpd_req_t *req)
+{
+    bool reset = false;
+    char query[32], param[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "reset", param, sizeof(param)) == ESP_OK) {
+        reset = atoi(param) != 0;
+    }
+
+    perf_out_t *out = calloc(1, sizeof(perf_out_t));
+    if (!out) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    out->req = req;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+
+    int64_t now = esp_timer_get_time();
+    out_printf(out, "{\"window_ms\":%lld,\"bounds_us\":[", (long long)((now - s_since_us) / 1000));
+    for (int b = 0; b < PERF_BUCKETS - 1; b++) {
+        out_printf(out, "%s%lu", b ? "," : "", (unsigned long)perf_bucket_bounds_us[b]);
+    }
+    out_printf(out, "],\"metrics\":{");
+
+    perf_hist_t hist;
+    for (int m = 0; m < PERF_METRIC_COUNT; m++) {
+        taskENTER_CRITICAL(&s_hist_lock);
+        hist = s_hist[m];
+        taskEXIT_CRITICAL(&s_hist_lock);
+        out_printf(out, "%s\"%s\":", m ? "," : "", s_metric_names[m]);
+        out_hist(out, &hist);
+    }
+
+    out_printf(out, "},\"modbus_slaves\":{");
+    bool first = true;
+    for (int i = 0; i < PERF_MODBUS_SLAVES; i++) {
+        taskENTER_CRITICAL(&s_hist_lock);
+        bool used = s_slaves[i].used;
+        uint8_t slave_id = s_slaves[i].slave_id;
+        hist = s_slaves[i].hist;
+        taskEXIT_CRITICAL(&s_hist_lock);
+        if (!used) continue;
+        out_printf(out, "%s\"%u\":", first ? "" : ",", slave_id);
+        out_hist(out, &hist);
+        first = false;
+    }
+    out_printf(out, "},\"modbus_slaves_other\":%lu}", (unsigned long)s_slaves_other);
+    out_flush(out);
+
+    if (reset) {
+        taskENTER_CRITICAL(&s_hist_lock);
+        memset(s_hist, 0, sizeof(s_hist));
+        memset(s_slaves, 0, sizeof(s_slaves));
+        s_slaves_other = 0;
+        s_since_us = now;
+        taskEXIT_CRITICAL(&s_hist_lock);
+    }
+
+    bool failed = out->failed;
+    free(out);
+    if (failed) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static const char *trace_task_name(uint8_t index)
+{
+    return index < s_task_count ? s_tasks[index].name : "other";
+}
+
+static esp_err_t trace_start(httpd_req_t *req)
+{
+    char json[96];
+    if (!s_ring) {
+        size_t size = PERF_TRACE_EVENTS * sizeof(trace_event_t);
+        if (heap_caps_get_free_size(MALLOC_CAP_INTERNAL) < PERF_TRACE_MIN_HEAP + size) {
+            httpd_resp_set_status(req, "503 Service Unavailable");
+            return httpd_resp_sendstr(req, "{\"error\":\"Not enough heap for a trace\"}");
+        }
+        trace_event_t *ring = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!ring) {
+            httpd_resp_send_500(req);
+            return ESP_FAIL;
+        }
+        taskENTER_CRITICAL(&s_trace_lock);
+        s_ring = ring;
+        s_ring_head = 0;
+        s_task_count = 0;
+        s_t0 = esp_timer_get_time();
+        s_tracing = true;
+        taskEXIT_CRITICAL(&s_trace_lock);
+        ESP_LOGI(TAG, "Trace started (%d events, %u bytes)", PERF_TRACE_EVENTS, (unsigned)size);
+    }
+    snprintf(json, sizeof(json), "{\"tracing\":true,\"capacity\":%d,\"recorded\":%lu}",
+             PERF_TRACE_EVENTS, (unsigned long)s_ring_head);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, json);
+}
+
+// GET /api/trace?start=1 starts a capture; GET /api/trace stops it and
+// returns Chrome trace JSON
+esp_err_t perf_trace_handler(httpd_req_t *req)
+{
+    char query[32], param[8];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "start", param, sizeof(param)) == ESP_OK &&
+        atoi(param) != 0) {
+        return trace_start(req);
+    }
+    if (!s_ring) {
+        httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No trace running - start one with /api/trace?start=1");
+        return ESP_OK;
+    }
+
+    // Stop recording; the hook only writes while s_tracing is set
+    taskENTER_CRITICAL(&s_trace_lock);
+    s_tracing = false;
+    uint32_t end_ts = (uint32_t)(esp_timer_get_time() - s_t0);
+    taskEXIT_CRITICAL(&s_trace_lock);
+
+    perf_out_t *out = calloc(1, sizeof(perf_out_t));
+    if (!out) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    out->req = req;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.json\"");
+
+    // pid 0: which task ran on each core; pid 1: spans, one row per task
+    out_printf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":["
+                    "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Cores\"}},"
+                    "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Spans\"}}");
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        out_printf(out, ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"Core %d\"}}", c, c);
+    }
+    for (int t = 0; t < s_task_count; t++) {
+        out_printf(out, ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                   t, s_tasks[t].name);
+    }
+
+    // A switch event opens a slice that the next switch on the same core closes
+    struct { bool open; uint8_t task; uint32_t ts; } slice[portNUM_PROCESSORS] = {0};
+    uint32_t first = s_ring_head > PERF_TRACE_EVENTS ? s_ring_head - PERF_TRACE_EVENTS : 0;
+    for (uint32_t i = first; i < s_ring_head && !out->failed; i++) {
+        const trace_event_t *evt = &s_ring[i % PERF_TRACE_EVENTS];
+        if (evt->kind == EVT_SWITCH) {
+            if (evt->core >= portNUM_PROCESSORS) continue;
+            if (slice[evt->core].open) {
+                out_printf(out, ",{\"name\":\"%s\",\"cat\":\"sched\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%lu,\"dur\":%lu}",
+                           trace_task_name(slice[evt->core].task), evt->core,
+                           (unsigned long)slice[evt->core].ts,
+                           (unsigned long)(evt->ts_us - slice[evt->core].ts));
+            }
+            slice[evt->core].open = true;
+            slice[evt->core].task = evt->id;
+            slice[evt->core].ts = evt->ts_us;
+        } else {
+            out_printf(out, ",{\"name\":\"%s\",\"cat\":\"perf\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%lu,\"dur\":%lu,"
+                            "\"args\":{\"core\":%u",
+                       evt->id < PERF_METRIC_COUNT ? s_metric_names[evt->id] : "?", evt->task,
+                       (unsigned long)evt->ts_us, (unsigned long)evt->dur_us, evt->core);
+            if (evt->id == PERF_MODBUS) {
+                out_printf(out, ",\"slave\":%u", evt->arg);
+            }
+            out_printf(out, "}}");
+        }
+    }
+    for (int c = 0; c < portNUM_PROCESSORS; c++) {
+        if (slice[c].open) {
+            out_printf(out, ",{\"name\":\"%s\",\"cat\":\"sched\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%lu,\"dur\":%lu}",
+                       trace_task_name(slice[c].task), c, (unsigned long)slice[c].ts,
+                       (unsigned long)(end_ts - slice[c].ts));
+        }
+    }
+    out_printf(out, "]}");
+    out_flush(out);
+
+    uint32_t recorded = s_ring_head;
+    taskENTER_CRITICAL(&s_trace_lock);
+    trace_event_t *ring = s_ring;
+    s_ring = NULL;
+    taskEXIT_CRITICAL(&s_trace_lock);
+    free(ring);
+    ESP_LOGI(TAG, "Trace stopped: %lu events (%lu kept)", (unsigned long)recorded,
+             (unsigned long)(recorded - first));
+
+    bool failed = out->failed;
+    free(out);
+    if (failed) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
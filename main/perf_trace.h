@@ -0,0 +1,86 @@
+/**
+ * perf_trace.h - Latency histograms and an on-demand event trace
+ *
+ * histograms   Each hot path records its duration into a fixed-bucket
+ *              histogram in a static table: count, total, max and 16
+ *              buckets from <100 us to >=5 s. Modbus is also split per
+ *              slave. GET /api/perf returns the table as JSON; ?reset=1
+ *              clears it after the read.
+ *   trace      GET /api/trace?start=1 allocates a ring of PERF_TRACE_EVENTS
+ *              and records task switches (a scheduler hook, see
+ *              freertos_trace_hooks.h) plus one span per histogram sample.
+ *              The next GET /api/trace stops the capture, returns it as
+ *              Chrome trace JSON (chrome://tracing, ui.perfetto.dev) and
+ *              frees the ring. The ring keeps the latest events.
+ *
+ * Recording costs one esp_timer read and a short critical section. The
+ * switch hook returns at once unless a capture is running.
+ */
+
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PERF_MODBUS = 0,            // One request/response (modbus.c), also per slave
+    PERF_SENSOR_DECODE,         // Register decode and calculation (sensor_test_live), failures included
+    PERF_PAYLOAD_BUILD,         // JSON/CBOR for one telemetry message
+    PERF_TELEMETRY_CYCLE,       // create_telemetry_payload(): read, build and publish
+    PERF_MQTT_PUBACK,           // Outbox enqueue to PUBACK
+    PERF_SD_APPEND,             // sd_card_save_message()
+    PERF_SD_ACK,                // sd_card_remove_message() once a replayed message is acked
+    PERF_HTTPD,                 // Portal handler, admission wait included
+    PERF_METRIC_COUNT
+} perf_metric_t;
+
+#define PERF_BUCKETS 16
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[PERF_BUCKETS];     // Upper bounds in perf_bucket_bounds_us[]
+} perf_hist_t;
+
+static inline int64_t perf_start(void)
+{
+    return esp_timer_get_time();
+}
+
+/**
+ * Record a sample from start_us (perf_start()) to now
+ */
+void perf_end(perf_metric_t metric, int64_t start_us);
+
+/**
+ * Record a sample that began elsewhere, e.g. on another task
+ */
+void perf_span(perf_metric_t metric, int64_t start_us, int64_t end_us);
+
+/**
+ * Record a Modbus transaction for the aggregate and the slave's histogram
+ */
+void perf_end_modbus(uint8_t slave_id, int64_t start_us);
+
+/**
+ * Scheduler hook: called on each task switch (freertos_trace_hooks.h)
+ */
+void perf_trace_task_switched_in(void);
+
+// Portal handlers (registered by web_config.c)
+esp_err_t perf_stats_handler(httpd_req_t *req);
+esp_err_t perf_trace_handler(httpd_req_t *req);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERF_TRACE_H
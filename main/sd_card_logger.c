@@ -14,6 +14,7 @@
 #include "freertos/semphr.h"
 #include "sd_card_logger.h"
 #include "iot_configs.h"
+#include "perf_trace.h"
 
 // Mutex for thread-safe SD card access
 static SemaphoreHandle_t sd_card_mutex = NULL;
@@ -49,8 +50,8 @@ static volatile bool recovery_in_progress = false;  // Recursion guard
 typedef struct {
     bool valid;
     char timestamp[32];
-    char topic[128];
-    char payload[512];
+    char topic[SD_CARD_TOPIC_MAX];
+    char payload[SD_CARD_PAYLOAD_MAX];
 } ram_buffer_message_t;
 
 static ram_buffer_message_t ram_buffer[SD_CARD_RAM_BUFFER_SIZE];
@@ -546,7 +547,7 @@ static esp_err_t sd_card_cleanup_oldest_messages(uint32_t count_to_delete) {
     }
 
     // Find the oldest message IDs
-    char line[700];
+    char line[SD_CARD_LINE_MAX];
     uint32_t deleted = 0;
 
     while (fgets(line, sizeof(line), file) != NULL && deleted < count_to_delete) {
@@ -610,14 +611,14 @@ static esp_err_t sd_card_save_message_internal(const char* topic, const char* pa
 }
 
 // Save message to SD card with retry logic and RAM buffer fallback
-esp_err_t sd_card_save_message(const char* topic, const char* payload, const char* timestamp) {
+static esp_err_t sd_card_save_message_retrying(const char* topic, const char* payload, const char* timestamp) {
     // Validate parameters first (before mutex to fail fast)
     if (topic == NULL || payload == NULL || timestamp == NULL) {
         ESP_LOGE(TAG, "Invalid message parameters");
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (strlen(topic) > 128 || strlen(payload) > 512) {
+    if (strlen(topic) >= SD_CARD_TOPIC_MAX || strlen(payload) >= SD_CARD_PAYLOAD_MAX) {
         ESP_LOGE(TAG, "Message too large to save");
         return ESP_ERR_INVALID_SIZE;
     }
@@ -709,6 +710,14 @@ esp_err_t sd_card_save_message(const char* topic, const char* payload, const cha
     return sd_card_add_to_ram_buffer(topic, payload, timestamp);
 }
 
+// Public: timed append, mutex wait and recovery included (perf_trace.h)
+esp_err_t sd_card_save_message(const char* topic, const char* payload, const char* timestamp) {
+    int64_t start = perf_start();
+    esp_err_t result = sd_card_save_message_retrying(topic, payload, timestamp);
+    perf_end(PERF_SD_APPEND, start);
+    return result;
+}
+
 // Get count of pending messages
 esp_err_t sd_card_get_pending_count(uint32_t* count) {
     if (count == NULL) {
@@ -727,7 +736,7 @@ esp_err_t sd_card_get_pending_count(uint32_t* count) {
     }
 
     uint32_t msg_count = 0;
-    char line[700];
+    char line[SD_CARD_LINE_MAX];
 
     while (fgets(line, sizeof(line), file) != NULL) {
         if (strlen(line) > 1) { // Skip empty lines
@@ -780,8 +789,8 @@ esp_err_t sd_card_replay_messages(void (*publish_callback)(const pending_message
 
     ESP_LOGI(TAG, "📤 Found %lu pending messages to replay", total_messages);
 
-    char line[700];
-    char line_backup[700];  // Backup for logging corrupted lines
+    char line[SD_CARD_LINE_MAX];
+    char line_backup[SD_CARD_LINE_MAX];  // Backup for logging corrupted lines
     uint32_t replayed_count = 0;
     uint32_t deleted_corrupt_count = 0;
     // Use config value for batch limit (defined in iot_configs.h)
@@ -809,7 +818,7 @@ esp_err_t sd_card_replay_messages(void (*publish_callback)(const pending_message
             FILE *src = fopen(pending_messages_file, "r");
             FILE *dst = fopen(temp_messages_file, "w");
             if (src && dst) {
-                char temp_line[700];
+                char temp_line[SD_CARD_LINE_MAX];
                 while (fgets(temp_line, sizeof(temp_line), src) != NULL) {
                     // Only write non-corrupted lines
                     if (!is_corrupted_line(temp_line)) {
@@ -907,7 +916,7 @@ esp_err_t sd_card_replay_messages(void (*publish_callback)(const pending_message
                 FILE *src = fopen(pending_messages_file, "r");
                 FILE *dst = fopen(temp_messages_file, "w");
                 if (src && dst) {
-                    char temp_line[700];
+                    char temp_line[SD_CARD_LINE_MAX];
                     bool skipped_one = false;
                     while (fgets(temp_line, sizeof(temp_line), src) != NULL) {
                         // Skip the first matching corrupted line
@@ -1022,7 +1031,7 @@ static esp_err_t sd_card_remove_message_internal(uint32_t message_id) {
     }
 
     bool message_found = false;
-    char line[700];
+    char line[SD_CARD_LINE_MAX];
 
     while (fgets(line, sizeof(line), source_file) != NULL) {
         if (strlen(line) < 10) {
@@ -1064,6 +1073,8 @@ static esp_err_t sd_card_remove_message_internal(uint32_t message_id) {
 
 // Public: Remove a specific message by ID (acquires mutex)
 esp_err_t sd_card_remove_message(uint32_t message_id) {
+    int64_t start = perf_start();
+
     // Acquire mutex for thread safety
     if (sd_card_mutex != NULL) {
         if (xSemaphoreTake(sd_card_mutex, pdMS_TO_TICKS(SD_MUTEX_TIMEOUT_MS)) != pdTRUE) {
@@ -1075,6 +1086,7 @@ esp_err_t sd_card_remove_message(uint32_t message_id) {
     esp_err_t result = sd_card_remove_message_internal(message_id);
 
     if (sd_card_mutex != NULL) xSemaphoreGive(sd_card_mutex);
+    perf_end(PERF_SD_ACK, start);
     return result;
 }
 
@@ -1123,7 +1135,7 @@ esp_err_t sd_card_restore_message_counter(void) {
 
     uint32_t max_id = 0;
     uint32_t message_count = 0;
-    char line[700];
+    char line[SD_CARD_LINE_MAX];
 
     while (fgets(line, sizeof(line), file) != NULL) {
         if (strlen(line) < 10) {
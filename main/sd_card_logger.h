@@ -9,6 +9,10 @@
 #define SD_CARD_RETRY_DELAY_MS 100         // Delay between retries
 #define SD_CARD_RECOVERY_INTERVAL_SEC 60   // Try to recover failed SD card every 60 seconds
 #define SD_CARD_RAM_BUFFER_SIZE 3          // Reduced from 5 to save ~1.3KB (15min offline buffer at 5min interval)
+#define SD_CARD_TOPIC_MAX 200              // Topic field incl. NUL - telemetry topics carry routing properties
+#define SD_CARD_PAYLOAD_MAX 512            // Payload field incl. NUL
+// One cache line: "<id>|<timestamp>|<topic>|<payload>\n" + NUL
+#define SD_CARD_LINE_MAX (10 + 1 + 32 + 1 + SD_CARD_TOPIC_MAX + 1 + SD_CARD_PAYLOAD_MAX + 2)
 
 // SD Card status
 typedef struct {
@@ -25,8 +29,8 @@ typedef struct {
 typedef struct {
     uint32_t message_id;
     char timestamp[32];
-    char topic[128];
-    char payload[512];
+    char topic[SD_CARD_TOPIC_MAX];
+    char payload[SD_CARD_PAYLOAD_MAX];
 } pending_message_t;
 
 // SD Card initialization and management
@@ -3,7 +3,10 @@
 #include "sensor_manager.h"
 #include "modbus.h"
 #include "web_config.h"
+#include "gateway_status.h"
 #include "esp_log.h"
+#include "dlog.h"
+#include "perf_trace.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -14,6 +17,52 @@
 
 static const char *TAG = "SENSOR_MGR";
 
+static sensor_latest_t s_latest[SENSOR_LATEST_SLOTS];
+static uint32_t s_latest_version = 0;
+static portMUX_TYPE s_latest_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// reading is NULL when every attempt failed; the last good value is kept
+static void sensor_latest_update(int index, const sensor_reading_t *reading, uint32_t read_ms, int attempts)
+{
+    if (index < 0 || index >= SENSOR_LATEST_SLOTS) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_latest_lock);
+    sensor_latest_t *slot = &s_latest[index];
+    slot->valid = reading != NULL;
+    slot->updated_us = now;
+    slot->read_ms = read_ms;
+    slot->attempts = attempts;
+    if (reading) {
+        slot->value = reading->value;
+        slot->quality = reading->quality_params;
+        slot->has_value = true;
+        slot->good_us = now;
+        slot->fail_streak = 0;
+    } else if (slot->fail_streak < UINT16_MAX) {
+        slot->fail_streak++;
+    }
+    slot->version = ++s_latest_version;
+    portEXIT_CRITICAL(&s_latest_lock);
+}
+
+void sensor_latest_get(int index, sensor_latest_t *out)
+{
+    if (index < 0 || index >= SENSOR_LATEST_SLOTS) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    portENTER_CRITICAL(&s_latest_lock);
+    *out = s_latest[index];
+    portEXIT_CRITICAL(&s_latest_lock);
+}
+
+uint32_t sensor_latest_version(void)
+{
+    return s_latest_version;
+}
+
 esp_err_t sensor_manager_init(void)
 {
     ESP_LOGI(TAG, "Initializing sensor manager");
@@ -28,7 +77,7 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
         return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_LOGI(TAG, "Converting data: Type=%s, Order=%s, Scale=%.6f", data_type, byte_order, scale_factor);
+    DLOGI(TAG, "Converting data: Type=%s, Order=%s, Scale=%.6f", data_type, byte_order, scale_factor);
 
     // Handle specific format names from web interface
     const char* actual_data_type = data_type;
@@ -83,18 +132,18 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
         actual_byte_order = "MIXED_BADC";     // 78563412/7856341 = mixed order
     }
     
-    ESP_LOGI(TAG, "Mapped to: Type=%s, Order=%s", actual_data_type, actual_byte_order);
+    DLOGI(TAG, "Mapped to: Type=%s, Order=%s", actual_data_type, actual_byte_order);
 
     if (strcmp(actual_data_type, "UINT16") == 0 && reg_count >= 1) {
         *raw_value = registers[0];
         *result = (double)(*raw_value) * scale_factor;
-        ESP_LOGI(TAG, "UINT16: Raw=0x%04" PRIX32 " (%" PRIu32 ") -> %.6f", *raw_value, *raw_value, *result);
+        DLOGI(TAG, "UINT16: Raw=0x%04" PRIX32 " (%" PRIu32 ") -> %.6f", *raw_value, *raw_value, *result);
         
     } else if (strcmp(actual_data_type, "INT16") == 0 && reg_count >= 1) {
         int16_t signed_val = (int16_t)registers[0];
         *raw_value = registers[0];
         *result = (double)signed_val * scale_factor;
-        ESP_LOGI(TAG, "INT16: Raw=0x%04" PRIX32 " (%d) -> %.6f", *raw_value, signed_val, *result);
+        DLOGI(TAG, "INT16: Raw=0x%04" PRIX32 " (%d) -> %.6f", *raw_value, signed_val, *result);
         
     } else if ((strcmp(actual_data_type, "UINT32") == 0 || strcmp(actual_data_type, "INT32") == 0) && reg_count >= 2) {
         uint32_t combined_value;
@@ -125,10 +174,10 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
         if (strcmp(actual_data_type, "INT32") == 0) {
             int32_t signed_val = (int32_t)combined_value;
             *result = (double)signed_val * scale_factor;
-            ESP_LOGI(TAG, "INT32: Raw=0x%08" PRIX32 " (%" PRId32 ") -> %.6f", combined_value, signed_val, *result);
+            DLOGI(TAG, "INT32: Raw=0x%08" PRIX32 " (%" PRId32 ") -> %.6f", combined_value, signed_val, *result);
         } else {
             *result = (double)combined_value * scale_factor;
-            ESP_LOGI(TAG, "UINT32: Raw=0x%08" PRIX32 " (%" PRIu32 ") -> %.6f", combined_value, combined_value, *result);
+            DLOGI(TAG, "UINT32: Raw=0x%08" PRIX32 " (%" PRIu32 ") -> %.6f", combined_value, combined_value, *result);
         }
 
     } else if ((strcmp(actual_data_type, "UINT32") == 0 || strcmp(actual_data_type, "INT32") == 0) && reg_count == 1) {
@@ -138,11 +187,11 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
             int16_t signed_val = (int16_t)registers[0];
             *raw_value = registers[0];
             *result = (double)signed_val * scale_factor;
-            ESP_LOGI(TAG, "INT32->INT16 fallback: Raw=0x%04" PRIX32 " (%d) -> %.6f", *raw_value, signed_val, *result);
+            DLOGI(TAG, "INT32->INT16 fallback: Raw=0x%04" PRIX32 " (%d) -> %.6f", *raw_value, signed_val, *result);
         } else {
             *raw_value = registers[0];
             *result = (double)(*raw_value) * scale_factor;
-            ESP_LOGI(TAG, "UINT32->UINT16 fallback: Raw=0x%04" PRIX32 " (%" PRIu32 ") -> %.6f", *raw_value, *raw_value, *result);
+            DLOGI(TAG, "UINT32->UINT16 fallback: Raw=0x%04" PRIX32 " (%" PRIu32 ") -> %.6f", *raw_value, *raw_value, *result);
         }
 
     } else if (strcmp(actual_data_type, "HEX") == 0) {
@@ -152,7 +201,7 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
             *raw_value = (*raw_value << 16) | registers[i];
         }
         *result = (double)(*raw_value) * scale_factor;
-        ESP_LOGI(TAG, "HEX: Raw=0x%08" PRIX32 " -> %.6f", *raw_value, *result);
+        DLOGI(TAG, "HEX: Raw=0x%08" PRIX32 " -> %.6f", *raw_value, *result);
         
     } else if (strcmp(actual_data_type, "FLOAT32") == 0 && reg_count >= 2) {
         uint32_t combined_value;
@@ -185,7 +234,7 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
         
         *raw_value = combined_value;
         *result = (double)converter.f * scale_factor;
-        ESP_LOGI(TAG, "FLOAT32: Raw=0x%08" PRIX32 " (%.6f) -> %.6f", combined_value, converter.f, *result);
+        DLOGI(TAG, "FLOAT32: Raw=0x%08" PRIX32 " (%.6f) -> %.6f", combined_value, converter.f, *result);
         
     } else if (strcmp(actual_data_type, "FLOAT64") == 0 && reg_count >= 4) {
         // FLOAT64 handling - 4 registers (64-bit double precision)
@@ -220,7 +269,7 @@ esp_err_t convert_modbus_data(uint16_t *registers, int reg_count,
         
         *raw_value = (uint32_t)(combined_value64 & 0xFFFFFFFF);  // Store lower 32 bits for compatibility
         *result = converter64.d * scale_factor;
-        ESP_LOGI(TAG, "FLOAT64: Raw=0x%016" PRIX64 " (%.6f) -> %.6f", combined_value64, converter64.d, *result);
+        DLOGI(TAG, "FLOAT64: Raw=0x%016" PRIX64 " (%.6f) -> %.6f", combined_value64, converter64.d, *result);
         
     } else {
         // Calculate expected register count for better error message
@@ -248,8 +297,8 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
     // Clear result
     memset(result, 0, sizeof(sensor_test_result_t));
     
-    ESP_LOGI(TAG, "Testing sensor: %s (Unit: %s, Slave: %d)", 
-             sensor->name, sensor->unit_id, sensor->slave_id);
+    DLOGI(TAG, "Testing sensor: %s (Unit: %s, Slave: %d)", 
+         sensor->name, sensor->unit_id, sensor->slave_id);
 
     uint32_t start_time = esp_timer_get_time() / 1000;
     
@@ -273,24 +322,24 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
     int quantity_to_read = sensor->quantity;
     if (strcmp(sensor->sensor_type, "Aquadax_Quality") == 0) {
         quantity_to_read = 12;
-        ESP_LOGI(TAG, "Aquadax_Quality sensor detected, reading 12 registers for 5x FLOAT32 (COD,BOD,TSS,pH,Temp)");
+        DLOGI(TAG, "Aquadax_Quality sensor detected, reading 12 registers for 5x FLOAT32 (COD,BOD,TSS,pH,Temp)");
     } else if (strcmp(sensor->sensor_type, "Flow-Meter") == 0) {
         quantity_to_read = 4;
-        ESP_LOGI(TAG, "Flow-Meter sensor detected, reading 4 registers for UINT32_BADC + FLOAT32_BADC interpretation");
+        DLOGI(TAG, "Flow-Meter sensor detected, reading 4 registers for UINT32_BADC + FLOAT32_BADC interpretation");
     } else if (strcmp(sensor->sensor_type, "ZEST") == 0) {
         quantity_to_read = 4;
-        ESP_LOGI(TAG, "ZEST sensor detected, reading 4 registers for UINT32_CDAB + FLOAT32_ABCD interpretation");
+        DLOGI(TAG, "ZEST sensor detected, reading 4 registers for UINT32_CDAB + FLOAT32_ABCD interpretation");
     } else if (strcmp(sensor->sensor_type, "Panda_USM") == 0) {
         quantity_to_read = 4;
-        ESP_LOGI(TAG, "Panda USM sensor detected, reading 4 registers for DOUBLE64 (Net Volume)");
+        DLOGI(TAG, "Panda USM sensor detected, reading 4 registers for DOUBLE64 (Net Volume)");
     } else if (strcmp(sensor->sensor_type, "Hardness_Sensor") == 0) {
         quantity_to_read = 6;
-        ESP_LOGI(TAG, "Hardness sensor detected, reading 6 registers for 3x FLOAT32 CDAB (Hardness, _, Temp)");
+        DLOGI(TAG, "Hardness sensor detected, reading 6 registers for 3x FLOAT32 CDAB (Hardness, _, Temp)");
     }
     
     // Set the baud rate for this sensor
     int baud_rate = sensor->baud_rate > 0 ? sensor->baud_rate : 9600;
-    ESP_LOGI(TAG, "Setting baud rate to %d bps for sensor '%s'", baud_rate, sensor->name);
+    DLOGI(TAG, "Setting baud rate to %d bps for sensor '%s'", baud_rate, sensor->name);
     esp_err_t baud_err = modbus_set_baud_rate(baud_rate);
     if (baud_err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set baud rate for sensor '%s': %s", sensor->name, esp_err_to_name(baud_err));
@@ -339,9 +388,12 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
     }
 
     if (attempt > 1) {
-        ESP_LOGI(TAG, "Modbus read succeeded on attempt %d/%d", attempt, retry_count + 1);
+        DLOGI(TAG, "Modbus read succeeded on attempt %d/%d", attempt, retry_count + 1);
     }
 
+    // Failed decodes are recorded too; timed-out reads show up under PERF_MODBUS
+    int64_t decode_start = perf_start();
+
     // Get the raw register values
     // Use larger buffer to handle all sensor types (max 8 registers for 64-bit values)
     uint16_t registers[16];
@@ -357,6 +409,7 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->success = false;
         snprintf(result->error_message, sizeof(result->error_message),
                 "Insufficient registers received: got %d, expected %d", reg_count, sensor->quantity);
+        perf_end(PERF_SENSOR_DECODE, decode_start);
         return ESP_FAIL;
     }
 
@@ -394,9 +447,9 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = (integer_part + decimal_part) * sensor->scale_factor;
         result->raw_value = integer_part_raw; // Store integer part as raw value
 
-        ESP_LOGI(TAG, "Flow-Meter Calculation: Integer=0x%08lX(%lu) + Decimal(FLOAT)=0x%08lX(%.6f) = %.6f",
-                 (unsigned long)integer_part_raw, (unsigned long)integer_part_raw,
-                 (unsigned long)float_bits, decimal_part, result->scaled_value);
+        DLOGI(TAG, "Flow-Meter Calculation: Integer=0x%08lX(%lu) + Decimal(FLOAT)=0x%08lX(%.6f) = %.6f",
+             (unsigned long)integer_part_raw, (unsigned long)integer_part_raw,
+             (unsigned long)float_bits, decimal_part, result->scaled_value);
     }
     // Special handling for ZEST sensors (AquaGen Flow Meter format)
     else if (strcmp(sensor->sensor_type, "ZEST") == 0 && reg_count >= 4) {
@@ -423,9 +476,9 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = (integer_part + decimal_part) * sensor->scale_factor;
         result->raw_value = integer_part_raw;
 
-        ESP_LOGI(TAG, "ZEST Calculation: Integer=0x%04X(%lu) + Float=0x%08lX(%.6f) = %.6f",
-                 (unsigned int)integer_part_raw, (unsigned long)integer_part_raw,
-                 (unsigned long)float_bits, decimal_part, result->scaled_value);
+        DLOGI(TAG, "ZEST Calculation: Integer=0x%04X(%lu) + Float=0x%08lX(%.6f) = %.6f",
+             (unsigned int)integer_part_raw, (unsigned long)integer_part_raw,
+             (unsigned long)float_bits, decimal_part, result->scaled_value);
     }
     // Special handling for Panda USM sensors (64-bit double format)
     else if (strcmp(sensor->sensor_type, "Panda_USM") == 0 && reg_count >= 4) {
@@ -444,8 +497,8 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = net_volume * sensor->scale_factor;
         result->raw_value = (uint32_t)(combined_value64 >> 32); // Store upper 32 bits as raw value
 
-        ESP_LOGI(TAG, "Panda USM Calculation: DOUBLE64=0x%016llX = %.6f m³",
-                 (unsigned long long)combined_value64, result->scaled_value);
+        DLOGI(TAG, "Panda USM Calculation: DOUBLE64=0x%016llX = %.6f m³",
+             (unsigned long long)combined_value64, result->scaled_value);
     }
     // Special handling for Clampon flow meters (4 registers: UINT32_BADC + FLOAT32_BADC)
     else if (strcmp(sensor->sensor_type, "Clampon") == 0 && reg_count >= 4) {
@@ -468,9 +521,9 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = (integer_part + decimal_part) * sensor->scale_factor;
         result->raw_value = integer_part_raw; // Store integer part as raw value
 
-        ESP_LOGI(TAG, "Clampon Calculation: Integer=0x%08lX(%lu) + Decimal(FLOAT)=0x%08lX(%.6f) = %.6f",
-                 (unsigned long)integer_part_raw, (unsigned long)integer_part_raw,
-                 (unsigned long)float_bits, decimal_part, result->scaled_value);
+        DLOGI(TAG, "Clampon Calculation: Integer=0x%08lX(%lu) + Decimal(FLOAT)=0x%08lX(%.6f) = %.6f",
+             (unsigned long)integer_part_raw, (unsigned long)integer_part_raw,
+             (unsigned long)float_bits, decimal_part, result->scaled_value);
     }
     // Special handling for Dailian EMF flow meters (2 registers: UINT32 word-swapped totaliser)
     else if (strcmp(sensor->sensor_type, "Dailian_EMF") == 0 && reg_count >= 2) {
@@ -485,9 +538,9 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = (double)totaliser_raw * sensor->scale_factor;
         result->raw_value = totaliser_raw;
 
-        ESP_LOGI(TAG, "Dailian_EMF Calculation: Totaliser=0x%08lX(%lu) * %.6f = %.6f",
-                 (unsigned long)totaliser_raw, (unsigned long)totaliser_raw,
-                 sensor->scale_factor, result->scaled_value);
+        DLOGI(TAG, "Dailian_EMF Calculation: Totaliser=0x%08lX(%lu) * %.6f = %.6f",
+             (unsigned long)totaliser_raw, (unsigned long)totaliser_raw,
+             sensor->scale_factor, result->scaled_value);
     }
     // Special handling for Panda EMF flow meters (4 registers: INT32_BE + FLOAT32_BE)
     else if (strcmp(sensor->sensor_type, "Panda_EMF") == 0 && reg_count >= 4) {
@@ -510,9 +563,9 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = (integer_value + decimal_value) * sensor->scale_factor;
         result->raw_value = (uint32_t)integer_part; // Store integer part as raw value
 
-        ESP_LOGI(TAG, "Panda_EMF Calculation: Integer=0x%08lX(%ld) + Decimal(FLOAT)=0x%08lX(%.6f) = %.6f",
-                 (unsigned long)((uint32_t)integer_part), (long)integer_part,
-                 (unsigned long)float_bits, decimal_value, result->scaled_value);
+        DLOGI(TAG, "Panda_EMF Calculation: Integer=0x%08lX(%ld) + Decimal(FLOAT)=0x%08lX(%.6f) = %.6f",
+             (unsigned long)((uint32_t)integer_part), (long)integer_part,
+             (unsigned long)float_bits, decimal_value, result->scaled_value);
     }
     // Special handling for Panda Level sensors (1 register: UINT16 level value)
     else if (strcmp(sensor->sensor_type, "Panda_Level") == 0 && reg_count >= 1) {
@@ -537,8 +590,8 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         }
         result->raw_value = raw_level;
 
-        ESP_LOGI(TAG, "Panda_Level Calculation: Raw=%u, SensorHeight=%.2f, TankHeight=%.2f, Level%%=%.2f",
-                 raw_level, sensor->sensor_height, sensor->max_water_level, result->scaled_value);
+        DLOGI(TAG, "Panda_Level Calculation: Raw=%u, SensorHeight=%.2f, TankHeight=%.2f, Level%%=%.2f",
+             raw_level, sensor->sensor_height, sensor->max_water_level, result->scaled_value);
     }
     // Special handling for Hydrostatic Level sensors (Aquagen) - 1 register at address 0x0004
     // Formula: Level % = (Raw Value / Tank Height) * 100
@@ -561,8 +614,8 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         }
         result->raw_value = raw_level;
 
-        ESP_LOGI(TAG, "Hydrostatic_Level Calculation: Raw=%u, TankHeight=%.2f, Level%%=%.2f",
-                 raw_level, sensor->max_water_level, result->scaled_value);
+        DLOGI(TAG, "Hydrostatic_Level Calculation: Raw=%u, TankHeight=%.2f, Level%%=%.2f",
+             raw_level, sensor->max_water_level, result->scaled_value);
     }
     // Special handling for Aquadax Quality sensors (12 registers: 5x FLOAT32)
     else if (strcmp(sensor->sensor_type, "Aquadax_Quality") == 0 && reg_count >= 10) {
@@ -588,7 +641,7 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
         result->scaled_value = (double)cod_value * sensor->scale_factor;
         result->raw_value = float_bits;
 
-        ESP_LOGI(TAG, "Aquadax_Quality Test: COD=%.3f (primary display value)", result->scaled_value);
+        DLOGI(TAG, "Aquadax_Quality Test: COD=%.3f (primary display value)", result->scaled_value);
 
         // Log all 5 parameters for debugging
         for (int p = 0; p < 5; p++) {
@@ -600,7 +653,7 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
             uint32_t fb = ((uint32_t)hi_s << 16) | lo_s;
             float fv;
             memcpy(&fv, &fb, sizeof(float));
-            ESP_LOGI(TAG, "  %s = %.3f (raw: 0x%08lX)", param_names[p], fv, (unsigned long)fb);
+            DLOGI(TAG, "  %s = %.3f (raw: 0x%08lX)", param_names[p], fv, (unsigned long)fb);
         }
     } else {
         // Convert the data using standard conversion
@@ -613,6 +666,7 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
             result->success = false;
             snprintf(result->error_message, sizeof(result->error_message), 
                     "Data conversion failed");
+            perf_end(PERF_SENSOR_DECODE, decode_start);
             return conv_result;
         }
     }
@@ -621,24 +675,44 @@ esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *
     if (sensor->calculation.calc_type != CALC_NONE) {
         double pre_calc_value = result->scaled_value;
         result->scaled_value = apply_calculation(sensor, pre_calc_value, registers, reg_count);
-        ESP_LOGI(TAG, "Calculation applied: %.6f -> %.6f (type: %s)",
-                 pre_calc_value, result->scaled_value,
-                 get_calculation_type_name(sensor->calculation.calc_type));
+        DLOGI(TAG, "Calculation applied: %.6f -> %.6f (type: %s)",
+             pre_calc_value, result->scaled_value,
+             get_calculation_type_name(sensor->calculation.calc_type));
     }
 
     result->success = true;
-    ESP_LOGI(TAG, "Test successful: %.6f (Response: %lu ms)",
-             result->scaled_value, result->response_time_ms);
+    perf_end(PERF_SENSOR_DECODE, decode_start);
+    DLOGI(TAG, "Test successful: %.6f (Response: %lu ms)",
+         result->scaled_value, result->response_time_ms);
 
     return ESP_OK;
 }
 
+static esp_err_t sensor_read_single_locked(const sensor_config_t *sensor, sensor_reading_t *reading);
+
 esp_err_t sensor_read_single(const sensor_config_t *sensor, sensor_reading_t *reading)
 {
     if (!sensor || !reading) {
         return ESP_ERR_INVALID_ARG;
     }
 
+    // One sensor at a time on the RS485 bus: baud rate, requests and the copy out of
+    // modbus.c's response buffer - portal tests and dumps wait in between sensors
+    if (!modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        memset(reading, 0, sizeof(*reading));
+        strncpy(reading->unit_id, sensor->unit_id, sizeof(reading->unit_id) - 1);
+        strncpy(reading->sensor_name, sensor->name, sizeof(reading->sensor_name) - 1);
+        strncpy(reading->data_source, "error", sizeof(reading->data_source) - 1);
+        ESP_LOGE(TAG, "Failed to read sensor %s: RS485 bus busy", sensor->unit_id);
+        return ESP_ERR_TIMEOUT;
+    }
+    esp_err_t ret = sensor_read_single_locked(sensor, reading);
+    modbus_bus_unlock();
+    return ret;
+}
+
+static esp_err_t sensor_read_single_locked(const sensor_config_t *sensor, sensor_reading_t *reading)
+{
     // For water quality sensors, use specialized multi-parameter reading
     if (strcmp(sensor->sensor_type, "QUALITY") == 0) {
         return sensor_read_quality(sensor, reading);
@@ -692,8 +766,8 @@ esp_err_t sensor_read_single(const sensor_config_t *sensor, sensor_reading_t *re
             }
             
             reading->value = level_percentage;
-            ESP_LOGI(TAG, "Level Sensor %s: Raw=%.6f, Height=%.2f, MaxLevel=%.2f -> %.2f%%", 
-                     reading->unit_id, raw_scaled_value, sensor->sensor_height, sensor->max_water_level, level_percentage);
+            DLOGI(TAG, "Level Sensor %s: Raw=%.6f, Height=%.2f, MaxLevel=%.2f -> %.2f%%", 
+                 reading->unit_id, raw_scaled_value, sensor->sensor_height, sensor->max_water_level, level_percentage);
         } else if (strcmp(sensor->sensor_type, "Radar Level") == 0) {
             // Radar Level sensor calculation: (Raw Value / Maximum Water Level) * 100
             double raw_scaled_value = test_result.scaled_value;
@@ -706,17 +780,17 @@ esp_err_t sensor_read_single(const sensor_config_t *sensor, sensor_reading_t *re
             }
             
             reading->value = level_percentage;
-            ESP_LOGI(TAG, "Radar Level Sensor %s: Raw=%.6f, MaxLevel=%.2f -> %.2f%%", 
-                     reading->unit_id, raw_scaled_value, sensor->max_water_level, level_percentage);
+            DLOGI(TAG, "Radar Level Sensor %s: Raw=%.6f, MaxLevel=%.2f -> %.2f%%", 
+                 reading->unit_id, raw_scaled_value, sensor->max_water_level, level_percentage);
         } else if (strcmp(sensor->sensor_type, "ZEST") == 0) {
             // ZEST sensor uses the sensor_test_live function which handles the special format
             // The test_result.scaled_value already contains the combined integer + decimal value
             reading->value = test_result.scaled_value;
-            ESP_LOGI(TAG, "ZEST Sensor %s: %.6f", reading->unit_id, reading->value);
+            DLOGI(TAG, "ZEST Sensor %s: %.6f", reading->unit_id, reading->value);
         } else {
             // Flow-Meter or other sensor types use direct scaled value
             reading->value = test_result.scaled_value;
-            ESP_LOGI(TAG, "Sensor %s: %.6f", reading->unit_id, reading->value);
+            DLOGI(TAG, "Sensor %s: %.6f", reading->unit_id, reading->value);
         }
         
         reading->valid = true;
@@ -788,8 +862,8 @@ esp_err_t sensor_read_quality(const sensor_config_t *sensor, sensor_reading_t *r
             continue;
         }
 
-        ESP_LOGI(TAG, "Reading sub-sensor %d: %s (Slave:%d, Reg:%d)", 
-                 i, sub_sensor->parameter_name, sub_sensor->slave_id, sub_sensor->register_address);
+        DLOGI(TAG, "Reading sub-sensor %d: %s (Slave:%d, Reg:%d)", 
+             i, sub_sensor->parameter_name, sub_sensor->slave_id, sub_sensor->register_address);
 
         // Create a temporary sensor config for this sub-sensor
         sensor_config_t temp_sensor = *sensor;  // Copy main sensor config
@@ -814,31 +888,31 @@ esp_err_t sensor_read_quality(const sensor_config_t *sensor, sensor_reading_t *r
             if (strcasecmp(sub_sensor->parameter_name, "pH") == 0 || strcasecmp(sub_sensor->parameter_name, "PH") == 0) {
                 reading->quality_params.ph_value = scaled_value;
                 reading->quality_params.ph_valid = true;
-                ESP_LOGI(TAG, "pH: %.2f", scaled_value);
+                DLOGI(TAG, "pH: %.2f", scaled_value);
             } else if (strcasecmp(sub_sensor->parameter_name, "TDS") == 0 || strcasecmp(sub_sensor->parameter_name, "Conductivity") == 0) {
                 reading->quality_params.tds_value = scaled_value;
                 reading->quality_params.tds_valid = true;
-                ESP_LOGI(TAG, "TDS/Conductivity: %.2f ppm", scaled_value);
+                DLOGI(TAG, "TDS/Conductivity: %.2f ppm", scaled_value);
             } else if (strcasecmp(sub_sensor->parameter_name, "Temp") == 0 || strcasecmp(sub_sensor->parameter_name, "Temperature") == 0) {
                 reading->quality_params.temp_value = scaled_value;
                 reading->quality_params.temp_valid = true;
-                ESP_LOGI(TAG, "Temperature: %.2f°C", scaled_value);
+                DLOGI(TAG, "Temperature: %.2f°C", scaled_value);
             } else if (strcasecmp(sub_sensor->parameter_name, "HUMIDITY") == 0 || strcasecmp(sub_sensor->parameter_name, "Humidity") == 0) {
                 reading->quality_params.humidity_value = scaled_value;
                 reading->quality_params.humidity_valid = true;
-                ESP_LOGI(TAG, "Humidity: %.2f%%", scaled_value);
+                DLOGI(TAG, "Humidity: %.2f%%", scaled_value);
             } else if (strcasecmp(sub_sensor->parameter_name, "TSS") == 0) {
                 reading->quality_params.tss_value = scaled_value;
                 reading->quality_params.tss_valid = true;
-                ESP_LOGI(TAG, "TSS: %.2f mg/L", scaled_value);
+                DLOGI(TAG, "TSS: %.2f mg/L", scaled_value);
             } else if (strcasecmp(sub_sensor->parameter_name, "BOD") == 0) {
                 reading->quality_params.bod_value = scaled_value;
                 reading->quality_params.bod_valid = true;
-                ESP_LOGI(TAG, "BOD: %.2f mg/L", scaled_value);
+                DLOGI(TAG, "BOD: %.2f mg/L", scaled_value);
             } else if (strcasecmp(sub_sensor->parameter_name, "COD") == 0) {
                 reading->quality_params.cod_value = scaled_value;
                 reading->quality_params.cod_valid = true;
-                ESP_LOGI(TAG, "COD: %.2f mg/L", scaled_value);
+                DLOGI(TAG, "COD: %.2f mg/L", scaled_value);
             } else {
                 ESP_LOGW(TAG, "Unknown parameter: %s (value=%.2f)", sub_sensor->parameter_name, scaled_value);
             }
@@ -951,8 +1025,8 @@ esp_err_t sensor_read_aquadax_quality(const sensor_config_t *sensor, sensor_read
         uint16_t hi_swapped = ((registers[off+1] & 0xFF) << 8) | ((registers[off+1] >> 8) & 0xFF);
         uint32_t float_bits = ((uint32_t)hi_swapped << 16) | lo_swapped;
         memcpy(&params[p], &float_bits, sizeof(float));
-        ESP_LOGI(TAG, "Aquadax_Quality %s: %.3f (raw: 0x%08lX)",
-                 param_names[p], params[p], (unsigned long)float_bits);
+        DLOGI(TAG, "Aquadax_Quality %s: %.3f (raw: 0x%08lX)",
+             param_names[p], params[p], (unsigned long)float_bits);
     }
 
     // Map to quality_params_t
@@ -1065,8 +1139,8 @@ esp_err_t sensor_read_opruss_ace(const sensor_config_t *sensor, sensor_reading_t
         float fv;
         memcpy(&fv, &float_bits, sizeof(float));
         params[p] = (double)fv;
-        ESP_LOGI(TAG, "Opruss_Ace %s: reg[%d]=0x%04X reg[%d]=0x%04X -> FLOAT32=%.2f mg/L",
-                 param_names[p], off, registers[off], off + 1, registers[off + 1], params[p]);
+        DLOGI(TAG, "Opruss_Ace %s: reg[%d]=0x%04X reg[%d]=0x%04X -> FLOAT32=%.2f mg/L",
+             param_names[p], off, registers[off], off + 1, registers[off + 1], params[p]);
     }
 
     // Map to quality_params_t
@@ -1106,8 +1180,8 @@ esp_err_t sensor_read_opruss_ace(const sensor_config_t *sensor, sensor_reading_t
             memcpy(&tds_fv, &d_bits, sizeof(float));
             reading->quality_params.tds_value = (double)tds_fv;
             reading->quality_params.tds_valid = true;
-            ESP_LOGI(TAG, "Opruss_Ace TDS = %.2f ppt (reg: %04X %04X -> swap: %04X %04X -> 0x%08lX)",
-                     (double)tds_fv, tds_regs[0], tds_regs[1], lo_s, hi_s, (unsigned long)d_bits);
+            DLOGI(TAG, "Opruss_Ace TDS = %.2f ppt (reg: %04X %04X -> swap: %04X %04X -> 0x%08lX)",
+                 (double)tds_fv, tds_regs[0], tds_regs[1], lo_s, hi_s, (unsigned long)d_bits);
         } else {
             ESP_LOGW(TAG, "Opruss_Ace TDS: Insufficient registers (got %d, need 2)", tds_reg_count);
         }
@@ -1143,8 +1217,8 @@ esp_err_t sensor_read_opruss_ace(const sensor_config_t *sensor, sensor_reading_t
             memcpy(&temp_fv, &t_bits, sizeof(float));
             reading->quality_params.temp_value = (double)temp_fv;
             reading->quality_params.temp_valid = true;
-            ESP_LOGI(TAG, "Opruss_Ace Temp = %.2f C (reg: %04X %04X -> swap: %04X %04X -> 0x%08lX)",
-                     (double)temp_fv, temp_regs[0], temp_regs[1], lo_s, hi_s, (unsigned long)t_bits);
+            DLOGI(TAG, "Opruss_Ace Temp = %.2f C (reg: %04X %04X -> swap: %04X %04X -> 0x%08lX)",
+                 (double)temp_fv, temp_regs[0], temp_regs[1], lo_s, hi_s, (unsigned long)t_bits);
         } else {
             ESP_LOGW(TAG, "Opruss_Ace Temp: Insufficient registers (got %d, need 2)", temp_reg_count);
         }
@@ -1246,8 +1320,8 @@ esp_err_t sensor_read_hardness(const sensor_config_t *sensor, sensor_reading_t *
         float fv;
         memcpy(&fv, &float_bits, sizeof(float));
         params[p] = (double)fv;
-        ESP_LOGI(TAG, "Hardness_Sensor %s: reg[%d]=0x%04X reg[%d]=0x%04X -> FLOAT32_CDAB=%.2f",
-                 param_names[p], off, registers[off], off + 1, registers[off + 1], params[p]);
+        DLOGI(TAG, "Hardness_Sensor %s: reg[%d]=0x%04X reg[%d]=0x%04X -> FLOAT32_CDAB=%.2f",
+             param_names[p], off, registers[off], off + 1, registers[off + 1], params[p]);
     }
 
     reading->quality_params.hardness_value = params[0];
@@ -1261,10 +1335,10 @@ esp_err_t sensor_read_hardness(const sensor_config_t *sensor, sensor_reading_t *
     strncpy(reading->data_source, "modbus_rs485_multi", sizeof(reading->data_source) - 1);
     reading->data_source[sizeof(reading->data_source) - 1] = '\0';
 
-    ESP_LOGI(TAG, "Hardness_Sensor %s: Hardness=%.2f mg/L, Temp=%.2f C",
-             reading->unit_id,
-             reading->quality_params.hardness_value,
-             reading->quality_params.temp_value);
+    DLOGI(TAG, "Hardness_Sensor %s: Hardness=%.2f mg/L, Temp=%.2f C",
+         reading->unit_id,
+         reading->quality_params.hardness_value,
+         reading->quality_params.temp_value);
 
     return ESP_OK;
 }
@@ -1278,17 +1352,19 @@ esp_err_t sensor_read_all_configured(sensor_reading_t *readings, int max_reading
     system_config_t *config = get_system_config();
     *actual_count = 0;
 
-    ESP_LOGI(TAG, "Reading all configured sensors (%d total)", config->sensor_count);
+    DLOGI(TAG, "Reading all configured sensors (%d total)", config->sensor_count);
 
     for (int i = 0; i < config->sensor_count && *actual_count < max_readings; i++) {
         if (config->sensors[i].enabled) {
-            ESP_LOGI(TAG, "Reading sensor %d: %s (Unit: %s, Slave: %d)",
-                     i + 1, config->sensors[i].name, config->sensors[i].unit_id, config->sensors[i].slave_id);
+            DLOGI(TAG, "Reading sensor %d: %s (Unit: %s, Slave: %d)",
+                 i + 1, config->sensors[i].name, config->sensors[i].unit_id, config->sensors[i].slave_id);
 
             // Retry logic - try up to 3 times before giving up
             const int MAX_RETRIES = 3;
             const int RETRY_DELAY_MS = 500;  // Wait 500ms between retries
             bool read_success = false;
+            int attempts = 0;
+            int64_t read_start = esp_timer_get_time();
 
             for (int retry = 0; retry < MAX_RETRIES && !read_success; retry++) {
                 if (retry > 0) {
@@ -1296,11 +1372,12 @@ esp_err_t sensor_read_all_configured(sensor_reading_t *readings, int max_reading
                     vTaskDelay(pdMS_TO_TICKS(RETRY_DELAY_MS));
                 }
 
+                attempts++;
                 esp_err_t ret = sensor_read_single(&config->sensors[i], &readings[*actual_count]);
                 if (ret == ESP_OK && readings[*actual_count].valid) {
-                    ESP_LOGI(TAG, "Sensor %s read successfully: %.2f%s",
-                             config->sensors[i].unit_id, readings[*actual_count].value,
-                             retry > 0 ? " (after retry)" : "");
+                    DLOGI(TAG, "Sensor %s read successfully: %.2f%s",
+                         config->sensors[i].unit_id, readings[*actual_count].value,
+                         retry > 0 ? " (after retry)" : "");
                     (*actual_count)++;
                     read_success = true;
                 } else if (retry < MAX_RETRIES - 1) {
@@ -1313,12 +1390,15 @@ esp_err_t sensor_read_all_configured(sensor_reading_t *readings, int max_reading
                 ESP_LOGE(TAG, "Failed to read sensor %s after %d attempts",
                          config->sensors[i].unit_id, MAX_RETRIES);
             }
+            sensor_latest_update(i, read_success ? &readings[*actual_count - 1] : NULL,
+                                 (uint32_t)((esp_timer_get_time() - read_start) / 1000), attempts);
         } else {
             ESP_LOGW(TAG, "Sensor %d (%s) is disabled", i + 1, config->sensors[i].name);
         }
     }
 
-    ESP_LOGI(TAG, "Successfully read %d/%d sensors", *actual_count, config->sensor_count);
+    DLOGI(TAG, "Successfully read %d/%d sensors", *actual_count, config->sensor_count);
+    gateway_status_update_modbus(*actual_count);
     return ESP_OK;
 }
 
@@ -1510,9 +1590,9 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
 
                 result = (high_value * calc->combine_multiplier) + low_value;
 
-                ESP_LOGI(TAG, "CALC_COMBINE: HIGH[%d]=%.4f × %.1f + LOW[%d]=%.4f = %.4f",
-                         calc->high_register_offset, high_value, calc->combine_multiplier,
-                         calc->low_register_offset, low_value, result);
+                DLOGI(TAG, "CALC_COMBINE: HIGH[%d]=%.4f × %.1f + LOW[%d]=%.4f = %.4f",
+                     calc->high_register_offset, high_value, calc->combine_multiplier,
+                     calc->low_register_offset, low_value, result);
             } else {
                 ESP_LOGW(TAG, "CALC_COMBINE: Insufficient registers (have %d, need %d)",
                          register_count, calc->low_register_offset + 2);
@@ -1528,8 +1608,8 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
                 result = raw_value;
             } else {
                 result = (raw_value * calc->scale) + calc->offset;
-                ESP_LOGI(TAG, "CALC_SCALE_OFFSET: %.4f × %.4f + %.4f = %.4f",
-                         raw_value, calc->scale, calc->offset, result);
+                DLOGI(TAG, "CALC_SCALE_OFFSET: %.4f × %.4f + %.4f = %.4f",
+                     raw_value, calc->scale, calc->offset, result);
             }
             break;
 
@@ -1550,9 +1630,9 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
                 if (result < 0) result = 0;
                 if (result > 100) result = 100;
 
-                ESP_LOGI(TAG, "CALC_LEVEL_PCT: raw=%.4f, empty=%.4f, full=%.4f, invert=%d -> %.2f%%",
-                         raw_value, calc->tank_empty_value, calc->tank_full_value,
-                         calc->invert_level, result);
+                DLOGI(TAG, "CALC_LEVEL_PCT: raw=%.4f, empty=%.4f, full=%.4f, invert=%d -> %.2f%%",
+                     raw_value, calc->tank_empty_value, calc->tank_full_value,
+                     calc->invert_level, result);
             }
             break;
 
@@ -1573,9 +1653,9 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
                     default: result = volume_m3 * 1000.0; break;
                 }
 
-                ESP_LOGI(TAG, "CALC_CYLINDER: level=%.2f%%, height=%.2fm, dia=%.2fm -> %.2f %s",
-                         level_percent, calc->tank_height, calc->tank_diameter, result,
-                         calc->volume_unit == 0 ? "L" : (calc->volume_unit == 1 ? "m³" : "gal"));
+                DLOGI(TAG, "CALC_CYLINDER: level=%.2f%%, height=%.2fm, dia=%.2fm -> %.2f %s",
+                     level_percent, calc->tank_height, calc->tank_diameter, result,
+                     calc->volume_unit == 0 ? "L" : (calc->volume_unit == 1 ? "m³" : "gal"));
             }
             break;
 
@@ -1611,8 +1691,8 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
             // Convert pulse count to flow units
             if (calc->pulses_per_unit > 0) {
                 result = raw_value / calc->pulses_per_unit;
-                ESP_LOGI(TAG, "CALC_PULSE: %.4f pulses / %.4f = %.4f units",
-                         raw_value, calc->pulses_per_unit, result);
+                DLOGI(TAG, "CALC_PULSE: %.4f pulses / %.4f = %.4f units",
+                     raw_value, calc->pulses_per_unit, result);
             }
             break;
 
@@ -1623,9 +1703,9 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
                 double normalized = (raw_value - calc->input_min) / (calc->input_max - calc->input_min);
                 result = calc->output_min + normalized * (calc->output_max - calc->output_min);
 
-                ESP_LOGI(TAG, "CALC_LINEAR_INTERP: %.4f [%.1f-%.1f] -> %.4f [%.1f-%.1f]",
-                         raw_value, calc->input_min, calc->input_max,
-                         result, calc->output_min, calc->output_max);
+                DLOGI(TAG, "CALC_LINEAR_INTERP: %.4f [%.1f-%.1f] -> %.4f [%.1f-%.1f]",
+                     raw_value, calc->input_min, calc->input_max,
+                     result, calc->output_min, calc->output_max);
             }
             break;
 
@@ -1634,8 +1714,8 @@ double apply_calculation(const sensor_config_t *sensor, double raw_value,
             result = (calc->poly_a * raw_value * raw_value) +
                      (calc->poly_b * raw_value) +
                      calc->poly_c;
-            ESP_LOGI(TAG, "CALC_POLY: %.4f × %.4f² + %.4f × %.4f + %.4f = %.4f",
-                     calc->poly_a, raw_value, calc->poly_b, raw_value, calc->poly_c, result);
+            DLOGI(TAG, "CALC_POLY: %.4f × %.4f² + %.4f × %.4f + %.4f = %.4f",
+                 calc->poly_a, raw_value, calc->poly_b, raw_value, calc->poly_c, result);
             break;
 
         case CALC_FLOW_INT_DECIMAL:
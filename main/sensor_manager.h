@@ -50,10 +50,29 @@ typedef struct {
     quality_params_t quality_params; // Water quality parameters (for QUALITY sensors)
 } sensor_reading_t;
 
+// Latest reading per sensor slot (index into config->sensors), kept by
+// sensor_read_all_configured() so status pages never touch the RS485 bus
+#define SENSOR_LATEST_SLOTS 10
+
+typedef struct {
+    bool has_value;         // At least one successful read since boot
+    bool valid;             // Last read attempt succeeded
+    double value;           // Last good value (kept across failed attempts)
+    int64_t updated_us;     // esp_timer time of the last attempt, 0 = never
+    int64_t good_us;        // esp_timer time of the last good value, 0 = never
+    uint32_t version;       // sensor_latest_version() right after this slot changed
+    uint32_t read_ms;       // Duration of the last read, retries included
+    uint8_t attempts;       // Modbus attempts the last read needed
+    uint16_t fail_streak;   // Consecutive failed reads
+    quality_params_t quality; // Sub-parameters of the last good read (QUALITY types)
+} sensor_latest_t;
+
 // Function prototypes
 esp_err_t sensor_manager_init(void);
 esp_err_t sensor_test_live(const sensor_config_t *sensor, sensor_test_result_t *result);
 esp_err_t sensor_read_all_configured(sensor_reading_t *readings, int max_readings, int *actual_count);
+void sensor_latest_get(int index, sensor_latest_t *out);
+uint32_t sensor_latest_version(void);   // Bumps on every update
 esp_err_t sensor_read_single(const sensor_config_t *sensor, sensor_reading_t *reading);
 esp_err_t sensor_read_quality(const sensor_config_t *sensor, sensor_reading_t *reading);
 esp_err_t sensor_read_aquadax_quality(const sensor_config_t *sensor, sensor_reading_t *reading);
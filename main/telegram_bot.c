@@ -3,6 +3,8 @@
 
 #include "telegram_bot.h"
 #include "web_config.h"
+#include "net_cache.h"
+#include "iot_configs.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
 #include "esp_system.h"
@@ -12,6 +14,7 @@
 #include "cJSON.h"
 #include <string.h>
 #include <time.h>
+#include <ctype.h>
 
 static const char *TAG = "TELEGRAM";
 
@@ -22,17 +25,55 @@ static bool telegram_running = false;
 // Last update ID for polling
 static int last_update_id = 0;
 
+// Alerts waiting to be sent as one batch by telegram_task()
+typedef struct {
+    char title[48];
+    char message[160];
+    int count;                // Times raised while pending
+} pending_alert_t;
+
+static pending_alert_t pending_alerts[TELEGRAM_ALERT_QUEUE];
+static int pending_count = 0;
+static int dropped_alerts = 0;
+static int64_t first_pending_us = 0;   // When the oldest pending alert was raised
+static int64_t last_batch_us = 0;      // When the last batch was sent
+static portMUX_TYPE alert_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// Plain copy, safe inside alert_lock
+static void copy_str(char *dst, size_t size, const char *src) {
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+// Response body of one request (the client's user_data)
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool truncated;
+} response_sink_t;
+
 // HTTP event handler
 static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
     switch(evt->event_id) {
         case HTTP_EVENT_ERROR:
             ESP_LOGD(TAG, "HTTP_EVENT_ERROR");
             break;
-        case HTTP_EVENT_ON_DATA:
-            if (!esp_http_client_is_chunked_response(evt->client)) {
-                // Response data available
+        case HTTP_EVENT_ON_DATA: {
+            // perform() consumes the body, so it is collected here
+            response_sink_t *sink = (response_sink_t *)evt->user_data;
+            if (sink && sink->buf && sink->size > 0) {
+                size_t space = sink->size - 1 - sink->len;
+                size_t n = (size_t)evt->data_len < space ? (size_t)evt->data_len : space;
+                if (n < (size_t)evt->data_len) {
+                    sink->truncated = true;
+                }
+                memcpy(sink->buf + sink->len, evt->data, n);
+                sink->len += n;
+                sink->buf[sink->len] = '\0';
             }
             break;
+        }
         default:
             break;
     }
@@ -61,7 +102,8 @@ static void url_encode_string(const char *input, char *output, size_t output_siz
 }
 
 // Send HTTP request to Telegram API
-static esp_err_t telegram_api_request(const char *method, const char *params, char *response, size_t response_size) {
+static esp_err_t telegram_api_request(const char *method, const char *params, char *response, size_t response_size,
+                                      int timeout_ms) {
     system_config_t *config = get_system_config();
 
     if (!config->telegram_config.enabled || strlen(config->telegram_config.bot_token) == 0) {
@@ -74,35 +116,41 @@ static esp_err_t telegram_api_request(const char *method, const char *params, ch
              config->telegram_config.bot_token, method,
              params ? "?" : "", params ? params : "");
 
-    ESP_LOGI(TAG, "Telegram API: %s", method);
+    ESP_LOGD(TAG, "Telegram API: %s", method);
 
     esp_http_client_config_t http_config = {
         .url = url,
         .event_handler = http_event_handler,
-        .timeout_ms = 10000,
+        .timeout_ms = timeout_ms,
         .buffer_size = 2048,
     };
 
-    esp_http_client_handle_t client = esp_http_client_init(&http_config);
+    // Pooled keep-alive client: consecutive calls skip DNS and the TLS handshake
+    esp_http_client_handle_t client = net_pool_acquire(NET_POOL_TELEGRAM, &http_config);
     if (client == NULL) {
         ESP_LOGE(TAG, "Failed to init HTTP client");
         return ESP_FAIL;
     }
 
+    response_sink_t sink = { .buf = response, .size = response ? response_size : 0 };
+    if (response && response_size > 0) {
+        response[0] = '\0';
+    }
+    esp_http_client_set_user_data(client, &sink);
+
     esp_err_t err = esp_http_client_perform(client);
+    bool connection_ok = (err == ESP_OK);
+    esp_http_client_set_user_data(client, NULL);
 
     if (err == ESP_OK) {
         int status_code = esp_http_client_get_status_code(client);
         int content_length = esp_http_client_get_content_length(client);
 
         if (status_code == 200) {
-            if (response && response_size > 0) {
-                int data_read = esp_http_client_read(client, response, response_size - 1);
-                if (data_read > 0) {
-                    response[data_read] = '\0';
-                }
+            if (sink.truncated) {
+                ESP_LOGW(TAG, "%s response truncated at %u bytes", method, (unsigned)sink.len);
             }
-            ESP_LOGI(TAG, "✅ API request successful");
+            ESP_LOGD(TAG, "API request successful");
         } else {
             ESP_LOGW(TAG, "HTTP Status: %d, Length: %d", status_code, content_length);
             err = ESP_FAIL;
@@ -111,7 +159,7 @@ static esp_err_t telegram_api_request(const char *method, const char *params, ch
         ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(err));
     }
 
-    esp_http_client_cleanup(client);
+    net_pool_release(NET_POOL_TELEGRAM, client, connection_ok);
     return err;
 }
 
@@ -134,17 +182,139 @@ esp_err_t telegram_send_message(const char *message) {
     snprintf(params, sizeof(params), "chat_id=%s&text=%s&parse_mode=HTML",
              config->telegram_config.chat_id, encoded_text);
 
-    return telegram_api_request("sendMessage", params, NULL, 0);
+    return telegram_api_request("sendMessage", params, NULL, 0, 10000);
 }
 
 // Send alert with formatting
+// While the bot task runs, alerts are queued and sent in batches: the first
+// waits TELEGRAM_ALERT_COALESCE_MS for others, and batches are at least
+// TELEGRAM_ALERT_MIN_GAP_MS apart. A repeated title only bumps its count.
 esp_err_t telegram_send_alert(const char *title, const char *message) {
-    char alert_msg[512];
-    snprintf(alert_msg, sizeof(alert_msg),
-             "<b>⚠️ %s</b>\n\n%s\n\n<i>Time: %s</i>",
-             title, message, "Now"); // TODO: Add timestamp
+    if (!title || !message) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!telegram_running) {
+        char alert_msg[512];
+        snprintf(alert_msg, sizeof(alert_msg),
+                 "<b>⚠️ %s</b>\n\n%s\n\n<i>Time: %s</i>",
+                 title, message, "Now"); // TODO: Add timestamp
+        return telegram_send_message(alert_msg);
+    }
+
+    portENTER_CRITICAL(&alert_lock);
+    int i;
+    for (i = 0; i < pending_count; i++) {
+        if (strncmp(pending_alerts[i].title, title, sizeof(pending_alerts[i].title) - 1) == 0) {
+            // Same alert again: keep the latest details
+            copy_str(pending_alerts[i].message, sizeof(pending_alerts[i].message), message);
+            pending_alerts[i].count++;
+            break;
+        }
+    }
+    if (i == pending_count) {
+        if (pending_count < TELEGRAM_ALERT_QUEUE) {
+            pending_alert_t *a = &pending_alerts[pending_count++];
+            copy_str(a->title, sizeof(a->title), title);
+            copy_str(a->message, sizeof(a->message), message);
+            a->count = 1;
+        } else {
+            dropped_alerts++;
+        }
+    }
+    if (first_pending_us == 0) {
+        first_pending_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&alert_lock);
+    return ESP_OK;
+}
+
+// Milliseconds until the pending batch may be sent, -1 if nothing is pending
+static int64_t alert_batch_due_ms(void) {
+    portENTER_CRITICAL(&alert_lock);
+    int64_t first = first_pending_us;
+    portEXIT_CRITICAL(&alert_lock);
+    if (first == 0) {
+        return -1;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t due = first + (int64_t)TELEGRAM_ALERT_COALESCE_MS * 1000;
+    if (last_batch_us != 0 && last_batch_us + (int64_t)TELEGRAM_ALERT_MIN_GAP_MS * 1000 > due) {
+        due = last_batch_us + (int64_t)TELEGRAM_ALERT_MIN_GAP_MS * 1000;
+    }
+    return due > now ? (due - now) / 1000 : 0;
+}
 
-    return telegram_send_message(alert_msg);
+// Put an undelivered batch back with the alerts raised since; it goes out again after the gap
+static void requeue_alert_batch(const pending_alert_t *batch, int n, int dropped) {
+    portENTER_CRITICAL(&alert_lock);
+    for (int b = 0; b < n; b++) {
+        int i;
+        for (i = 0; i < pending_count; i++) {
+            if (strcmp(pending_alerts[i].title, batch[b].title) == 0) {
+                // Raised again meanwhile: the pending entry already has the latest details
+                pending_alerts[i].count += batch[b].count;
+                break;
+            }
+        }
+        if (i == pending_count) {
+            if (pending_count < TELEGRAM_ALERT_QUEUE) {
+                pending_alerts[pending_count++] = batch[b];
+            } else {
+                dropped += batch[b].count;
+            }
+        }
+    }
+    dropped_alerts += dropped;
+    if (first_pending_us == 0) {
+        first_pending_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&alert_lock);
+}
+
+// Send the pending alerts as one message if the batch is due
+static void flush_alert_batch(void) {
+    if (alert_batch_due_ms() != 0) {
+        return;
+    }
+
+    static pending_alert_t batch[TELEGRAM_ALERT_QUEUE];
+    portENTER_CRITICAL(&alert_lock);
+    int n = pending_count;
+    int dropped = dropped_alerts;
+    memcpy(batch, pending_alerts, sizeof(pending_alert_t) * n);
+    pending_count = 0;
+    dropped_alerts = 0;
+    first_pending_us = 0;
+    portEXIT_CRITICAL(&alert_lock);
+
+    static char msg[1024];
+    int offset = 0;
+    if (n == 1 && dropped == 0 && batch[0].count == 1) {
+        snprintf(msg, sizeof(msg), "<b>⚠️ %s</b>\n\n%s\n\n<i>Time: %s</i>",
+                 batch[0].title, batch[0].message, "Now");
+    } else {
+        offset += snprintf(msg + offset, sizeof(msg) - offset, "<b>⚠️ %d alerts</b>\n\n", n + dropped);
+        for (int i = 0; i < n && offset < (int)sizeof(msg); i++) {
+            offset += snprintf(msg + offset, sizeof(msg) - offset, "<b>%s</b>", batch[i].title);
+            if (batch[i].count > 1 && offset < (int)sizeof(msg)) {
+                offset += snprintf(msg + offset, sizeof(msg) - offset, " (×%d)", batch[i].count);
+            }
+            if (offset < (int)sizeof(msg)) {
+                offset += snprintf(msg + offset, sizeof(msg) - offset, "\n%s\n\n", batch[i].message);
+            }
+        }
+        if (dropped > 0 && offset < (int)sizeof(msg)) {
+            snprintf(msg + offset, sizeof(msg) - offset, "<i>... and %d more</i>", dropped);
+        }
+    }
+
+    last_batch_us = esp_timer_get_time();
+    if (telegram_send_message(msg) != ESP_OK) {
+        ESP_LOGW(TAG, "Alert batch (%d) not delivered, retrying in %d s", n, TELEGRAM_ALERT_MIN_GAP_MS / 1000);
+        requeue_alert_batch(batch, n, dropped);
+    }
 }
 
 // Get system uptime string
@@ -367,9 +537,14 @@ static void process_telegram_updates(const char *json_response) {
 }
 
 // Telegram polling task
+// getUpdates is a long poll: Telegram holds the request until a message
+// arrives or TELEGRAM_LONG_POLL_S passes, so commands are handled as they
+// come in. Requests go over the pooled keep-alive connection (net_cache.h).
+// poll_interval is only the retry delay after a failed poll.
 static void telegram_task(void *pvParameters) {
     system_config_t *config = get_system_config();
-    char response[4096];
+    static char response[TELEGRAM_RESPONSE_SIZE];
+    int retry_s = 0;
 
     ESP_LOGI(TAG, "Telegram bot task started");
 
@@ -379,16 +554,39 @@ static void telegram_task(void *pvParameters) {
             continue;
         }
 
-        char params[128];
-        snprintf(params, sizeof(params), "offset=%d&timeout=10", last_update_id + 1);
+        flush_alert_batch();
 
-        esp_err_t err = telegram_api_request("getUpdates", params, response, sizeof(response));
+        // Come back in time for a pending alert batch
+        int wait_s = TELEGRAM_LONG_POLL_S;
+        int64_t due_ms = alert_batch_due_ms();
+        if (due_ms >= 0 && (due_ms + 999) / 1000 < wait_s) {
+            wait_s = (int)((due_ms + 999) / 1000);
+        }
+        if (wait_s < 1) {
+            wait_s = 1;   // timeout=0 would spin on back-to-back requests until the batch is due
+        }
+
+        char params[160];
+        snprintf(params, sizeof(params),
+                 "offset=%d&timeout=%d&limit=%d&allowed_updates=%%5B%%22message%%22%%5D",
+                 last_update_id + 1, wait_s, TELEGRAM_UPDATE_LIMIT);
+
+        esp_err_t err = telegram_api_request("getUpdates", params, response, sizeof(response),
+                                             (wait_s + 10) * 1000);
 
         if (err == ESP_OK) {
             process_telegram_updates(response);
+            retry_s = 0;
+        } else {
+            // Back off from poll_interval up to TELEGRAM_MAX_RETRY_S
+            int base = config->telegram_config.poll_interval > 0 ? config->telegram_config.poll_interval : 10;
+            retry_s = retry_s == 0 ? base : retry_s * 2;
+            if (retry_s > TELEGRAM_MAX_RETRY_S) {
+                retry_s = TELEGRAM_MAX_RETRY_S;
+            }
+            ESP_LOGW(TAG, "getUpdates failed - retry in %ds", retry_s);
+            vTaskDelay(pdMS_TO_TICKS(retry_s * 1000));
         }
-
-        vTaskDelay(pdMS_TO_TICKS(config->telegram_config.poll_interval * 1000));
     }
 
     ESP_LOGI(TAG, "Telegram bot task stopped");
@@ -452,8 +650,8 @@ esp_err_t telegram_bot_stop(void) {
 
     telegram_running = false;
 
-    // Wait for task to finish
-    int timeout = 50;  // 5 seconds
+    // Wait for task to finish (a long poll in flight has to time out first)
+    int timeout = (TELEGRAM_LONG_POLL_S + 15) * 10;
     while (telegram_task_handle != NULL && timeout-- > 0) {
         vTaskDelay(pdMS_TO_TICKS(100));
     }
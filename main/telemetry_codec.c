@@ -0,0 +1,443 @@
+// telemetry_codec.c - Compact CBOR telemetry encoding and topic properties
+//
+// Cellular (SIM) sites pay per byte. The JSON batch repeats "unit_id",
+// "created_on", "type" and the value key for every sensor; the CBOR batch
+// below shares one timestamp, uses integer keys and binary numbers, which
+// makes a typical 10-sensor batch 3-5x smaller.
+
+#include "telemetry_codec.h"
+#include "esp_log.h"
+#include "mbedtls/base64.h"
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <math.h>
+#include <inttypes.h>
+
+static const char *TAG = "TELEMETRY_CODEC";
+
+// ============================================================================
+// Sensor classification (shared with the JSON batch builder in main.c)
+// ============================================================================
+
+static bool type_matches(const char* sensor_type, const char* const* names)
+{
+    for (int i = 0; names[i] != NULL; i++) {
+        if (strcasecmp(sensor_type, names[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void telemetry_classify_sensor(const char* sensor_type, telemetry_sensor_class_t* out)
+{
+    static const char* const level_types[] = {
+        "Level", "Radar Level", "Panda_Level", "Hydrostatic_Level", "Piezometer", NULL
+    };
+    static const char* const flow_types[] = {
+        "Flow-Meter", "ZEST", "Panda_EMF", "Panda_USM", "Dailian", "Dailian_EMF", "Clampon", NULL
+    };
+    static const char* const quality_types[] = {
+        "QUALITY", "Aquadax_Quality", "Opruss_Ace", "Aster", "Hardness_Sensor", NULL
+    };
+
+    out->type = JSON_TYPE_UNKNOWN;
+    out->type_name = "SENSOR";
+    out->value_key = "value";
+
+    if (sensor_type == NULL) {
+        return;
+    }
+
+    if (type_matches(sensor_type, level_types)) {
+        out->type = JSON_TYPE_LEVEL;
+        out->type_name = "LEVEL";
+        out->value_key = "level_filled";
+    } else if (type_matches(sensor_type, flow_types)) {
+        out->type = JSON_TYPE_FLOW;
+        out->type_name = "FLOW";
+        out->value_key = "consumption";
+    } else if (strcasecmp(sensor_type, "RAINGAUGE") == 0) {
+        out->type = JSON_TYPE_RAINGAUGE;
+        out->type_name = "RAINGAUGE";
+        out->value_key = "raingauge";
+    } else if (strcasecmp(sensor_type, "BOREWELL") == 0) {
+        out->type = JSON_TYPE_BOREWELL;
+        out->type_name = "BOREWELL";
+        out->value_key = "borewell";
+    } else if (strcasecmp(sensor_type, "ENERGY") == 0) {
+        out->type = JSON_TYPE_ENERGY;
+        out->type_name = "ENERGY";
+        out->value_key = "ene_con_hex";
+    } else if (type_matches(sensor_type, quality_types)) {
+        out->type = JSON_TYPE_QUALITY;
+        out->type_name = "QUALITY";
+        out->value_key = "value";
+    }
+}
+
+// ============================================================================
+// Encoding names and topics
+// ============================================================================
+
+const char* telemetry_encoding_name(telemetry_encoding_t encoding)
+{
+    return encoding == TELEMETRY_ENCODING_CBOR ? "cbor" : "json";
+}
+
+bool telemetry_encoding_from_name(const char* name, telemetry_encoding_t* encoding)
+{
+    if (name == NULL || encoding == NULL) {
+        return false;
+    }
+    if (strcasecmp(name, "json") == 0) {
+        *encoding = TELEMETRY_ENCODING_JSON;
+        return true;
+    }
+    if (strcasecmp(name, "cbor") == 0) {
+        *encoding = TELEMETRY_ENCODING_CBOR;
+        return true;
+    }
+    return false;
+}
+
+// Longest topic build_topic() can produce: JSON system properties, the longest
+// type name, a 10-digit seq, 3-digit part/parts and a fully %-encoded unit_id
+#define TOPIC_WORST_CASE_LEN                                                      \
+    (sizeof("devices/") - 1 + sizeof(((system_config_t*)0)->azure_device_id) - 1 + \
+     sizeof("/messages/events/$.ct=application%2Fjson&$.ce=utf-8") - 1 +          \
+     sizeof("&type=RAINGAUGE") - 1 + sizeof("&seq=4294967295") - 1 +              \
+     sizeof("&part=255&parts=255") - 1 +                                          \
+     sizeof("&unit_id=") - 1 + 3 * (sizeof(((sensor_config_t*)0)->unit_id) - 1))
+_Static_assert(TOPIC_WORST_CASE_LEN < TELEMETRY_TOPIC_MAX,
+               "TELEMETRY_TOPIC_MAX too small to keep every routing property");
+
+// Append "&name=value" (value URL-encoded) only if all of it fits
+static bool append_property(char* topic, size_t topic_size, const char* name, const char* value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    char encoded[48];
+    size_t n = 0;
+
+    for (const char* c = value; *c != '\0'; c++) {
+        bool plain = (*c >= 'A' && *c <= 'Z') || (*c >= 'a' && *c <= 'z') ||
+                     (*c >= '0' && *c <= '9') || *c == '-' || *c == '_' || *c == '.';
+        if (n + (plain ? 1 : 3) >= sizeof(encoded)) {
+            ESP_LOGW(TAG, "Routing property %s dropped - value too long", name);
+            return false;
+        }
+        if (plain) {
+            encoded[n++] = *c;
+        } else {
+            encoded[n++] = '%';
+            encoded[n++] = hex[((unsigned char)*c) >> 4];
+            encoded[n++] = hex[((unsigned char)*c) & 0x0F];
+        }
+    }
+    encoded[n] = '\0';
+
+    size_t len = strlen(topic);
+    size_t needed = 1 + strlen(name) + 1 + n;
+    if (len + needed >= topic_size) {
+        ESP_LOGW(TAG, "Routing property %s dropped - topic exceeds %d bytes", name, (int)topic_size);
+        return false;
+    }
+    snprintf(topic + len, topic_size - len, "&%s=%s", name, encoded);
+    return true;
+}
+
+void telemetry_build_topic(char* topic, size_t topic_size, const char* device_id,
+                           telemetry_encoding_t encoding, const telemetry_msg_props_t* props)
+{
+    if (encoding == TELEMETRY_ENCODING_CBOR) {
+        snprintf(topic, topic_size, "devices/%s/messages/events/$.ct=application%%2Fcbor", device_id);
+    } else {
+        snprintf(topic, topic_size, "devices/%s/messages/events/$.ct=application%%2Fjson&$.ce=utf-8", device_id);
+    }
+
+    if (props == NULL) {
+        return;
+    }
+
+    char number[12];
+    if (props->type != NULL) {
+        append_property(topic, topic_size, "type", props->type);
+    }
+    if (props->seq != 0) {
+        snprintf(number, sizeof(number), "%lu", (unsigned long)props->seq);
+        append_property(topic, topic_size, "seq", number);
+    }
+    if (props->parts != 0) {
+        // part without parts is useless to the consumer - both or neither
+        size_t len = strlen(topic);
+        snprintf(number, sizeof(number), "%u", props->part);
+        bool ok = append_property(topic, topic_size, "part", number);
+        snprintf(number, sizeof(number), "%u", props->parts);
+        if (!ok || !append_property(topic, topic_size, "parts", number)) {
+            topic[len] = '\0';
+        }
+    }
+    if (props->unit_id != NULL) {
+        append_property(topic, topic_size, "unit_id", props->unit_id);
+    }
+}
+
+bool telemetry_topic_is_cbor(const char* topic)
+{
+    return topic != NULL && strstr(topic, "$.ct=application%2Fcbor") != NULL;
+}
+
+// ============================================================================
+// Minimal CBOR writer (RFC 8949) - only the major types we emit
+// ============================================================================
+
+typedef struct {
+    uint8_t* buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} cbor_writer_t;
+
+#define CBOR_MAJOR_UINT   0
+#define CBOR_MAJOR_NINT   1
+#define CBOR_MAJOR_TEXT   3
+#define CBOR_MAJOR_ARRAY  4
+#define CBOR_MAJOR_MAP    5
+#define CBOR_MAJOR_SIMPLE 7
+
+static void cbor_put(cbor_writer_t* w, const uint8_t* data, size_t len)
+{
+    if (w->overflow || w->len + len > w->size) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(w->buf + w->len, data, len);
+    w->len += len;
+}
+
+static void cbor_put_head(cbor_writer_t* w, uint8_t major, uint64_t value)
+{
+    uint8_t head[9];
+    size_t n;
+
+    if (value < 24) {
+        head[0] = (major << 5) | (uint8_t)value;
+        n = 1;
+    } else if (value <= 0xFF) {
+        head[0] = (major << 5) | 24;
+        head[1] = (uint8_t)value;
+        n = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = (major << 5) | 25;
+        head[1] = (uint8_t)(value >> 8);
+        head[2] = (uint8_t)value;
+        n = 3;
+    } else if (value <= 0xFFFFFFFFULL) {
+        head[0] = (major << 5) | 26;
+        for (int i = 0; i < 4; i++) {
+            head[1 + i] = (uint8_t)(value >> (24 - 8 * i));
+        }
+        n = 5;
+    } else {
+        head[0] = (major << 5) | 27;
+        for (int i = 0; i < 8; i++) {
+            head[1 + i] = (uint8_t)(value >> (56 - 8 * i));
+        }
+        n = 9;
+    }
+    cbor_put(w, head, n);
+}
+
+static void cbor_put_text(cbor_writer_t* w, const char* text)
+{
+    size_t len = strlen(text);
+    cbor_put_head(w, CBOR_MAJOR_TEXT, len);
+    cbor_put(w, (const uint8_t*)text, len);
+}
+
+// Numbers are written in the smallest form that keeps the 3 decimals the
+// JSON payloads carry: integers as CBOR ints, otherwise float32 when the
+// rounding error stays below 0.0005, else float64.
+static void cbor_put_number(cbor_writer_t* w, double value)
+{
+    if (isfinite(value) && value == floor(value) && fabs(value) < 4294967296.0) {
+        if (value >= 0) {
+            cbor_put_head(w, CBOR_MAJOR_UINT, (uint64_t)value);
+        } else {
+            cbor_put_head(w, CBOR_MAJOR_NINT, (uint64_t)(-value - 1));
+        }
+        return;
+    }
+
+    float f = (float)value;
+    if (!isfinite(value) || fabs((double)f - value) < 0.0005) {
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        uint8_t out[5] = { (CBOR_MAJOR_SIMPLE << 5) | 26,
+                           (uint8_t)(bits >> 24), (uint8_t)(bits >> 16),
+                           (uint8_t)(bits >> 8), (uint8_t)bits };
+        cbor_put(w, out, sizeof(out));
+        return;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t out[9];
+    out[0] = (CBOR_MAJOR_SIMPLE << 5) | 27;
+    for (int i = 0; i < 8; i++) {
+        out[1 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    cbor_put(w, out, sizeof(out));
+}
+
+static void cbor_put_quality_params(cbor_writer_t* w, const quality_params_t* q)
+{
+    const struct { bool valid; telemetry_param_t key; double value; } params[] = {
+        { q->ph_valid,       TELEMETRY_PARAM_PH,       q->ph_value },
+        { q->tds_valid,      TELEMETRY_PARAM_TDS,      q->tds_value },
+        { q->temp_valid,     TELEMETRY_PARAM_TEMP,     q->temp_value },
+        { q->humidity_valid, TELEMETRY_PARAM_HUMIDITY, q->humidity_value },
+        { q->tss_valid,      TELEMETRY_PARAM_TSS,      q->tss_value },
+        { q->bod_valid,      TELEMETRY_PARAM_BOD,      q->bod_value },
+        { q->cod_valid,      TELEMETRY_PARAM_COD,      q->cod_value },
+        { q->hardness_valid, TELEMETRY_PARAM_HARDNESS, q->hardness_value },
+    };
+    const int param_count = sizeof(params) / sizeof(params[0]);
+
+    int valid = 0;
+    for (int i = 0; i < param_count; i++) {
+        if (params[i].valid) valid++;
+    }
+
+    cbor_put_head(w, CBOR_MAJOR_MAP, valid);
+    for (int i = 0; i < param_count; i++) {
+        if (params[i].valid) {
+            cbor_put_head(w, CBOR_MAJOR_UINT, params[i].key);
+            cbor_put_number(w, params[i].value);
+        }
+    }
+}
+
+static const sensor_config_t* find_enabled_sensor(const system_config_t* config, const char* unit_id)
+{
+    for (int j = 0; j < config->sensor_count; j++) {
+        if (strcmp(config->sensors[j].unit_id, unit_id) == 0) {
+            return config->sensors[j].enabled ? &config->sensors[j] : NULL;
+        }
+    }
+    return NULL;
+}
+
+// ENERGY hex string exactly as the JSON message sends it (ene_con_hex in
+// json_templates.c): the Modbus bytes without spaces, else the raw value
+static void energy_hex(const sensor_reading_t* reading, char* out, size_t out_size)
+{
+    if (reading->raw_hex[0] != '\0') {
+        size_t n = 0;
+        for (const char* src = reading->raw_hex; *src && n < out_size - 1; src++) {
+            if (*src != ' ') {
+                out[n++] = *src;
+            }
+        }
+        out[n] = '\0';
+        return;
+    }
+    uint32_t raw = reading->raw_value ? reading->raw_value : (uint32_t)(reading->value * 10000);
+    snprintf(out, out_size, "%08" PRIX32, raw);
+}
+
+esp_err_t telemetry_cbor_encode_batch(const system_config_t* config,
+                                      const sensor_reading_t* readings, int count,
+                                      time_t created_on,
+                                      uint8_t* out, size_t out_size, size_t* out_len)
+{
+    if (!config || !readings || !out || !out_len) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Count first - CBOR arrays carry their length up front
+    int sensor_count = 0;
+    for (int i = 0; i < count; i++) {
+        if (readings[i].valid && find_enabled_sensor(config, readings[i].unit_id)) {
+            sensor_count++;
+        }
+    }
+    if (sensor_count == 0) {
+        *out_len = 0;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    cbor_writer_t w = { .buf = out, .size = out_size, .len = 0, .overflow = false };
+
+    cbor_put_head(&w, CBOR_MAJOR_MAP, 3);
+    cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_KEY_VERSION);
+    cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_CBOR_SCHEMA_VERSION);
+    cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_KEY_CREATED_ON);
+    cbor_put_head(&w, CBOR_MAJOR_UINT, (uint64_t)created_on);
+    cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_KEY_SENSORS);
+    cbor_put_head(&w, CBOR_MAJOR_ARRAY, sensor_count);
+
+    for (int i = 0; i < count; i++) {
+        if (!readings[i].valid) continue;
+        const sensor_config_t* sensor = find_enabled_sensor(config, readings[i].unit_id);
+        if (!sensor) continue;
+
+        telemetry_sensor_class_t cls;
+        telemetry_classify_sensor(sensor->sensor_type, &cls);
+        bool is_quality = (cls.type == JSON_TYPE_QUALITY);
+
+        bool is_energy = (cls.type == JSON_TYPE_ENERGY);
+
+        cbor_put_head(&w, CBOR_MAJOR_MAP, is_energy ? 4 : 3);
+        cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_SENSOR_KEY_UNIT_ID);
+        cbor_put_text(&w, sensor->unit_id);
+        cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_SENSOR_KEY_TYPE);
+        cbor_put_head(&w, CBOR_MAJOR_UINT, cls.type);
+        if (is_quality) {
+            cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_SENSOR_KEY_PARAMS);
+            cbor_put_quality_params(&w, &readings[i].quality_params);
+        } else {
+            cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_SENSOR_KEY_VALUE);
+            cbor_put_number(&w, readings[i].value);
+        }
+        if (is_energy) {
+            char hex[32];
+            energy_hex(&readings[i], hex, sizeof(hex));
+            cbor_put_head(&w, CBOR_MAJOR_UINT, TELEMETRY_SENSOR_KEY_HEX);
+            cbor_put_text(&w, hex);
+        }
+    }
+
+    if (w.overflow) {
+        ESP_LOGE(TAG, "CBOR batch does not fit in %d bytes (%d sensors)", (int)out_size, sensor_count);
+        *out_len = 0;
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    *out_len = w.len;
+    return ESP_OK;
+}
+
+// ============================================================================
+// SD cache helpers
+// ============================================================================
+
+esp_err_t telemetry_cache_encode(const uint8_t* data, size_t len, char* out, size_t out_size)
+{
+    size_t written = 0;
+    if (mbedtls_base64_encode((unsigned char*)out, out_size, &written, data, len) != 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    out[written] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t telemetry_cache_decode(const char* text, uint8_t* out, size_t out_size, size_t* out_len)
+{
+    if (mbedtls_base64_decode(out, out_size, out_len,
+                              (const unsigned char*)text, strlen(text)) != 0) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
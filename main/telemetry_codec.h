@@ -0,0 +1,102 @@
+// telemetry_codec.h - Telemetry payload encodings (JSON / compact CBOR) and
+// Azure IoT Hub topic properties for the selected encoding
+
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include "esp_err.h"
+#include "web_config.h"
+#include "sensor_manager.h"
+#include "json_templates.h"
+#include "sd_card_logger.h"
+
+// Worst case CBOR batch for 10 QUALITY sensors with 8 params each is ~900 bytes
+#define TELEMETRY_CBOR_MAX_SIZE 1024
+
+// CBOR batch layout (integer keys, decoder lives on the cloud side):
+//   { 0: schema version, 1: created_on (epoch s), 2: [ sensor, ... ] }
+//   sensor = { 0: unit_id, 1: type (json_template_type_t), 2: value }          other types
+//   sensor = { 0: unit_id, 1: type (json_template_type_t), 3: { param: value } } QUALITY
+//   sensor = { 0: unit_id, 1: type, 2: value, 4: "00004351" }                  ENERGY
+// Keys 2 and 3 are mutually exclusive. The key 3 map holds only the valid
+// parameters, keyed by TELEMETRY_PARAM_* codes. Key 4 is the meter's raw hex
+// string, the same one JSON sends as ene_con_hex.
+#define TELEMETRY_CBOR_SCHEMA_VERSION 2
+
+#define TELEMETRY_KEY_VERSION       0
+#define TELEMETRY_KEY_CREATED_ON    1
+#define TELEMETRY_KEY_SENSORS       2
+
+#define TELEMETRY_SENSOR_KEY_UNIT_ID 0
+#define TELEMETRY_SENSOR_KEY_TYPE    1
+#define TELEMETRY_SENSOR_KEY_VALUE   2
+#define TELEMETRY_SENSOR_KEY_PARAMS  3
+#define TELEMETRY_SENSOR_KEY_HEX     4
+
+typedef enum {
+    TELEMETRY_PARAM_PH = 0,
+    TELEMETRY_PARAM_TDS,
+    TELEMETRY_PARAM_TEMP,
+    TELEMETRY_PARAM_HUMIDITY,
+    TELEMETRY_PARAM_TSS,
+    TELEMETRY_PARAM_BOD,
+    TELEMETRY_PARAM_COD,
+    TELEMETRY_PARAM_HARDNESS
+} telemetry_param_t;
+
+// Sensor classification shared by the JSON and CBOR builders
+typedef struct {
+    json_template_type_t type;  // JSON_TYPE_UNKNOWN for generic sensors
+    const char* type_name;      // "FLOW", "LEVEL", ... or "SENSOR"
+    const char* value_key;      // JSON value key ("consumption", "level_filled", ...)
+} telemetry_sensor_class_t;
+
+void telemetry_classify_sensor(const char* sensor_type, telemetry_sensor_class_t* out);
+
+// Encoding names for web UI / Device Twin ("json", "cbor")
+const char* telemetry_encoding_name(telemetry_encoding_t encoding);
+bool telemetry_encoding_from_name(const char* name, telemetry_encoding_t* encoding);
+
+// Topics are cached to SD with the message, so they must fit its topic field.
+// Sized so the longest device ID and unit ID keep every routing property.
+#define TELEMETRY_TOPIC_MAX SD_CARD_TOPIC_MAX
+
+// Application properties for hub-side routing without parsing the body
+typedef struct {
+    const char* type;           // "FLOW", "QUALITY", ... - every sensor in the message (NULL = omit)
+    const char* unit_id;        // Single-sensor messages only (NULL = omit)
+    uint32_t seq;               // Telemetry cycle sequence number (0 = omit)
+    uint8_t part;               // 1-based message index within the cycle...
+    uint8_t parts;              // ...and message count (0 = omit)
+} telemetry_msg_props_t;
+
+// D2C topic with system properties matching the encoding:
+//   JSON: devices/{id}/messages/events/$.ct=application%2Fjson&$.ce=utf-8
+//   CBOR: devices/{id}/messages/events/$.ct=application%2Fcbor
+// ($.ce is left out for CBOR - IoT Hub only accepts utf-8/16/32 there)
+// followed by the application properties (props may be NULL):
+//   &type=FLOW&seq=42&part=1&parts=3&unit_id=FG24001
+// Properties are URL-encoded and added in that order. TELEMETRY_TOPIC_MAX fits
+// them all; with a smaller topic_size one that does not fit is left out whole
+// (never cut) and logged.
+void telemetry_build_topic(char* topic, size_t topic_size, const char* device_id,
+                           telemetry_encoding_t encoding, const telemetry_msg_props_t* props);
+bool telemetry_topic_is_cbor(const char* topic);
+
+// Encode valid, enabled readings as one CBOR batch (see layout above)
+esp_err_t telemetry_cbor_encode_batch(const system_config_t* config,
+                                      const sensor_reading_t* readings, int count,
+                                      time_t created_on,
+                                      uint8_t* out, size_t out_size, size_t* out_len);
+
+// SD cache lines are text - binary payloads are stored base64 encoded, so a
+// cached CBOR batch can be at most TELEMETRY_CACHE_CBOR_MAX bytes
+#define TELEMETRY_CACHE_CBOR_MAX ((SD_CARD_PAYLOAD_MAX - 1) / 4 * 3)
+esp_err_t telemetry_cache_encode(const uint8_t* data, size_t len, char* out, size_t out_size);
+esp_err_t telemetry_cache_decode(const char* text, uint8_t* out, size_t out_size, size_t* out_len);
+
+#endif // TELEMETRY_CODEC_H
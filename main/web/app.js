@@ -5,7 +5,24 @@ sections.forEach(function(s){s.classList.remove('active');});
 menuItems.forEach(function(m){m.classList.remove('active');});
 var el=document.getElementById(sectionId);if(el)el.classList.add('active');
 var activeBtn=document.querySelector('[onclick*="'+sectionId+'"]'); if(activeBtn) activeBtn.classList.add('active');
+loadSection(sectionId);
 }
+// Sections other than the overview are fetched the first time they are opened and
+// then stay in the page; their ?v= URLs are cached by the browser across visits
+var sectionLoads={};
+function loadSection(sectionId){
+var el=document.getElementById(sectionId);
+if(!el||!el.getAttribute('data-src'))return;
+if(sectionLoads[sectionId])return;
+el.innerHTML="<p style='padding:20px;color:#6c757d'>Loading...</p>";
+sectionLoads[sectionId]=fetch(el.getAttribute('data-src')).then(function(r){if(!r.ok)throw new Error('HTTP '+r.status);return r.text();}).then(function(html){
+el.innerHTML=html;el.removeAttribute('data-src');initSection(el);
+}).catch(function(e){
+delete sectionLoads[sectionId];
+el.innerHTML="<div class='sensor-card'><p>Could not load this section ("+escHtml(e.message)+").</p><button class='btn' onclick='showSection(\""+sectionId+"\")'>Retry</button></div>";});}
+function initSection(el){
+if(portalConfig)applyConfig(portalConfig,el);
+if(el.id==='ota')refreshOtaStatus();}
 function showAzureSection(){
 const password=prompt('Azure IoT Configuration Access\\n\\nPlease enter the admin password to access Azure IoT Hub settings:');
 if(password===null) return;
@@ -14,8 +31,9 @@ showSection('azure');
 }else{
 alert('Access Denied\\n\\nIncorrect password. Azure IoT Hub configuration is protected for security reasons.\\n\\nContact your system administrator if you need access.');
 }}
+// One snapshot for the overview, Modbus and Azure cards (/api/status, cacheable for a few seconds)
 function updateSystemStatus(){
-fetch('/api/system_status').then(response=>response.json()).then(data=>{
+fetch('/api/status').then(response=>response.json()).then(data=>{
 document.getElementById('uptime').textContent=data.system.uptime_formatted;
 document.getElementById('mac_address').textContent=data.system.mac_address;
 document.getElementById('flash_total').textContent=(data.system.flash_total/1024/1024).toFixed(1)+' MB';
@@ -27,8 +45,8 @@ heapUsage.className=data.memory.heap_usage_percent>80?'status-error':(data.memor
 document.getElementById('internal_heap').textContent=(data.memory.internal_heap/1024).toFixed(1)+' KB';
 document.getElementById('spiram_heap').textContent=data.memory.spiram_heap>0?(data.memory.spiram_heap/1024).toFixed(1)+' KB':'Not Available';
 document.getElementById('largest_block').textContent=(data.memory.largest_free_block/1024).toFixed(1)+' KB';
-document.getElementById('app_partition').textContent=(data.partitions.app_partition_size/1024).toFixed(0)+' KB ('+data.partitions.app_usage_percent.toFixed(1)+'% used)';
-document.getElementById('nvs_partition').textContent=(data.partitions.nvs_partition_size/1024).toFixed(0)+' KB ('+data.partitions.nvs_usage_percent.toFixed(1)+'% used)';
+document.getElementById('app_partition').textContent=(data.partitions.app_partition_size/1024).toFixed(0)+' KB';
+document.getElementById('nvs_partition').textContent=(data.partitions.nvs_partition_size/1024).toFixed(0)+' KB';
 const wifiStatus=document.getElementById('wifi_status');
 wifiStatus.textContent=data.wifi.status;
 wifiStatus.className=data.wifi.status==='connected'?'status-good':'status-error';
@@ -61,34 +79,74 @@ else if(data.sim.status==='connected'){simIp.textContent='Assigned';}
 else{simIp.textContent='N/A';}
 }
 }
-}).catch(err=>console.log('Status update failed:',err));
-fetch('/api/modbus/status').then(r=>r.json()).then(data=>{
-const ids=['modbus_','ov_modbus_'];
-ids.forEach(prefix=>{
-const el=document.getElementById(prefix+'total_reads');if(el)el.textContent=data.total_reads;
-const el2=document.getElementById(prefix+'success');if(el2)el2.textContent=data.successful_reads;
-const el3=document.getElementById(prefix+'failed');if(el3)el3.textContent=data.failed_reads;
+const mb=data.modbus;
+['modbus_','ov_modbus_'].forEach(prefix=>{
+const el=document.getElementById(prefix+'total_reads');if(el)el.textContent=mb.total_reads;
+const el2=document.getElementById(prefix+'success');if(el2)el2.textContent=mb.successful_reads;
+const el3=document.getElementById(prefix+'failed');if(el3)el3.textContent=mb.failed_reads;
 const rate=document.getElementById(prefix+'success_rate');
-if(rate){rate.textContent=data.success_rate.toFixed(1)+'%';rate.className=data.success_rate>95?'status-good':(data.success_rate>80?'status-warning':'status-error');}
-const el5=document.getElementById(prefix+'crc_errors');if(el5)el5.textContent=data.crc_errors;
-const el6=document.getElementById(prefix+'timeout_errors');if(el6)el6.textContent=data.timeout_errors;
+if(rate){rate.textContent=mb.success_rate.toFixed(1)+'%';rate.className=mb.success_rate>95?'status-good':(mb.success_rate>80?'status-warning':'status-error');}
+const el5=document.getElementById(prefix+'crc_errors');if(el5)el5.textContent=mb.crc_errors;
+const el6=document.getElementById(prefix+'timeout_errors');if(el6)el6.textContent=mb.timeout_errors;
 });
-}).catch(err=>console.log('Modbus status failed:',err));
-fetch('/api/azure/status').then(r=>r.json()).then(data=>{
-const ids=['azure_','ov_azure_'];
-ids.forEach(prefix=>{
+const az=data.azure;
+['azure_','ov_azure_'].forEach(prefix=>{
 const conn=document.getElementById(prefix+'connection');
-if(conn){conn.textContent=data.connection_state;conn.className=data.connection_state==='connected'?'status-good':'status-error';}
-const hours=Math.floor(data.connection_uptime/3600);
-const mins=Math.floor((data.connection_uptime%3600)/60);
+if(conn){conn.textContent=az.connection_state;conn.className=az.connection_state==='connected'?'status-good':'status-error';}
+const hours=Math.floor(az.connection_uptime/3600);
+const mins=Math.floor((az.connection_uptime%3600)/60);
 const up=document.getElementById(prefix+'uptime');if(up)up.textContent=hours+'h '+mins+'m';
-const msg=document.getElementById(prefix+'messages');if(msg)msg.textContent=data.messages_sent;
-const lastTel=data.last_telemetry_ago;
+const msg=document.getElementById(prefix+'messages');if(msg)msg.textContent=az.messages_sent;
+const lastTel=az.last_telemetry_ago;
 const lt=document.getElementById(prefix+'last_telemetry');if(lt)lt.textContent=lastTel>0?lastTel+'s ago':'Never';
-const rc=document.getElementById(prefix+'reconnects');if(rc)rc.textContent=data.reconnect_attempts;
-const did=document.getElementById(prefix+'device_id');if(did)did.textContent=data.device_id;
+const rc=document.getElementById(prefix+'reconnects');if(rc)rc.textContent=az.reconnect_attempts;
+const did=document.getElementById(prefix+'device_id');if(did)did.textContent=az.device_id;
 });
-}).catch(err=>console.log('Azure status failed:',err));}
+}).catch(err=>console.log('Status update failed:',err));}
+
+// Live status over /ws - the gateway pushes only changed values; polling is the fallback
+var liveState={},liveBase=null,liveSocket=null,livePollTimer=null;
+function setLiveText(ids,text,cls){ids.forEach(function(id){var el=document.getElementById(id);if(el){el.textContent=text;if(cls!==undefined)el.className=cls;}});}
+function pad2(n){return (n<10?'0':'')+n;}
+function renderLiveTimes(){
+if(!liveBase)return;
+var s=liveState,t=liveBase.t+Math.floor((Date.now()-liveBase.at)/1000);
+setLiveText(['uptime'],pad2(Math.floor(t/3600))+':'+pad2(Math.floor(t%3600/60))+':'+pad2(t%60));
+var up=s.az?t-s.az_since:0;
+setLiveText(['azure_uptime','ov_azure_uptime'],Math.floor(up/3600)+'h '+Math.floor(up%3600/60)+'m');
+setLiveText(['azure_last_telemetry','ov_azure_last_telemetry'],s.az_last>0?(t-s.az_last)+'s ago':'Never');}
+function applyLiveStatus(msg){
+var s=liveState,d=msg.d;
+Object.keys(d).forEach(function(k){s[k]=d[k];});
+liveBase={t:msg.t,at:Date.now()};
+if('heap' in d)setLiveText(['heap'],s.heap.toFixed(1)+' KB');
+if('heap_pct' in d)setLiveText(['heap_usage'],s.heap_pct.toFixed(1)+'%',s.heap_pct>80?'status-error':(s.heap_pct>60?'status-warning':'status-good'));
+if('heap_int' in d)setLiveText(['internal_heap'],s.heap_int.toFixed(1)+' KB');
+if('heap_big' in d)setLiveText(['largest_block'],s.heap_big.toFixed(1)+' KB');
+if('tasks' in d)setLiveText(['tasks'],s.tasks);
+if('wifi' in d)setLiveText(['wifi_status'],s.wifi?'connected':'disconnected',s.wifi?'status-good':'status-error');
+if('rssi' in d)setLiveText(['rssi'],s.rssi+' dBm',s.rssi>-50?'status-good':(s.rssi>-70?'status-warning':'status-error'));
+if('ssid' in d)setLiveText(['ssid'],s.ssid);
+if('sim' in d)setLiveText(['sim_status'],s.sim?'Connected':'Disconnected',s.sim?'status-good':'status-error');
+if('sim' in d||'sim_ip' in d)setLiveText(['sim_ip'],s.sim_ip!=='N/A'?s.sim_ip:(s.sim?'Assigned':'N/A'));
+if('mb_total' in d)setLiveText(['modbus_total_reads','ov_modbus_total_reads'],s.mb_total);
+if('mb_ok' in d)setLiveText(['modbus_success','ov_modbus_success'],s.mb_ok);
+if('mb_fail' in d)setLiveText(['modbus_failed','ov_modbus_failed'],s.mb_fail);
+if('mb_rate' in d)setLiveText(['modbus_success_rate','ov_modbus_success_rate'],s.mb_rate.toFixed(1)+'%',s.mb_rate>95?'status-good':(s.mb_rate>80?'status-warning':'status-error'));
+if('mb_crc' in d)setLiveText(['modbus_crc_errors','ov_modbus_crc_errors'],s.mb_crc);
+if('mb_to' in d)setLiveText(['modbus_timeout_errors','ov_modbus_timeout_errors'],s.mb_to);
+if('az' in d)setLiveText(['azure_connection','ov_azure_connection'],s.az?'connected':'disconnected',s.az?'status-good':'status-error');
+if('az_msgs' in d)setLiveText(['azure_messages','ov_azure_messages'],s.az_msgs);
+if('az_rc' in d)setLiveText(['azure_reconnects','ov_azure_reconnects'],s.az_rc);
+Object.keys(d).forEach(function(k){if(/^s\d+$/.test(k))setLiveText(['live-value-'+k.substring(1)],d[k]===null?'-':d[k]);});
+renderLiveTimes();}
+function startLivePolling(){if(!livePollTimer)livePollTimer=setInterval(updateSystemStatus,5000);}
+function startLiveStatus(){
+if(!window.WebSocket){startLivePolling();return;}
+liveSocket=new WebSocket((location.protocol==='https:'?'wss://':'ws://')+location.host+'/ws');
+liveSocket.onopen=function(){if(livePollTimer){clearInterval(livePollTimer);livePollTimer=null;}};
+liveSocket.onmessage=function(e){try{applyLiveStatus(JSON.parse(e.data));}catch(err){console.log('Bad live status message:',err);}};
+liveSocket.onclose=function(){liveSocket=null;startLivePolling();setTimeout(startLiveStatus,10000);};}
 
 function performWatchdogAction(action){
 const btn=event.target;
@@ -236,12 +294,14 @@ resultDiv.style.backgroundColor='#f8d7da';
 
 function toggleNetworkMode(){
 var w=document.getElementById('mode_wifi');var s=document.getElementById('mode_sim');
-if(!w||!s)return;
-var wm=w.checked;var sm=s.checked;
+var wm,sm;
+if(w&&s){wm=w.checked;sm=s.checked;}
+else if(portalConfig){sm=String(portalConfig.fields.network_mode)==='1';wm=!sm;}
+else return;
 var e=document.getElementById('wifi_panel');if(e)e.style.display=wm?'block':'none';
 e=document.getElementById('sim_panel');if(e)e.style.display=sm?'block':'none';
-e=document.getElementById('wifi-network-status');if(e)e.style.display=wm?'block':'none';
-e=document.getElementById('sim-network-status');if(e)e.style.display=sm?'block':'none';}
+document.querySelectorAll('[id=wifi-network-status]').forEach(function(el){el.style.display=wm?'block':'none';});
+document.querySelectorAll('[id=sim-network-status]').forEach(function(el){el.style.display=sm?'block':'none';});}
 function toggleSDOptions(){
 var c=document.getElementById('sd_enabled');if(!c)return;var en=c.checked;
 var e=document.getElementById('sd_options');if(e)e.style.display=en?'block':'none';
@@ -271,5 +331,2806 @@ var bm=document.getElementById('btn-modbus-explorer');
 if(menuType==='regular'){if(r)r.style.display='block';if(w)w.style.display='none';if(m)m.style.display='none';if(br)br.style.background='#007bff';if(bw)bw.style.background='#6c757d';if(bm)bm.style.background='#6c757d';}
 else if(menuType==='water_quality'){if(r)r.style.display='none';if(w)w.style.display='block';if(m)m.style.display='none';if(br)br.style.background='#6c757d';if(bw)bw.style.background='#17a2b8';if(bm)bm.style.background='#6c757d';}
 else if(menuType==='explorer'){if(r)r.style.display='none';if(w)w.style.display='none';if(m)m.style.display='block';if(br)br.style.background='#6c757d';if(bw)bw.style.background='#6c757d';if(bm)bm.style.background='#6c757d';}}
-window.onload=function(){const savedSection=sessionStorage.getItem('showSection');if(savedSection){sessionStorage.removeItem('showSection');if(savedSection==='azure'){showAzureSection();}else{showSection(savedSection);}}else{const hash=window.location.hash.substring(1);if(hash&&hash!==''){if(hash==='azure'){showAzureSection();}else{showSection(hash);}}else{showSection('overview');}}toggleNetworkMode();toggleSDOptions();toggleRTCOptions();updateSystemStatus();setInterval(updateSystemStatus,5000);refreshOtaStatus();if(document.getElementById('wd-uptime')){updateWatchdogStatus();setInterval(updateWatchdogStatus,30000);}}
+window.onload=function(){const savedSection=sessionStorage.getItem('showSection');if(savedSection){sessionStorage.removeItem('showSection');if(savedSection==='azure'){showAzureSection();}else{showSection(savedSection);}}else{const hash=window.location.hash.substring(1);if(hash&&hash!==''){if(hash==='azure'){showAzureSection();}else{showSection(hash);}}else{showSection('overview');}}loadConfig();updateSystemStatus();startLiveStatus();setInterval(renderLiveTimes,1000);if(document.getElementById('wd-uptime')){updateWatchdogStatus();setInterval(updateWatchdogStatus,30000);}}
+let sensorCount = 0;
+function addSensor() {
+  console.log('ADD SENSOR CLICKED - Current count:', sensorCount);
+  var div = document.getElementById('sensors');
+  if (!div) { alert('ERROR: Sensors container not found!'); console.error('sensors div missing'); return; }
+  console.log('Found sensors div, building HTML...');
+  var h = '<div class="sensor-card" id="sensor-card-' + sensorCount + '" style="border:2px dashed #007bff;padding:15px;margin:10px 0;background:#f8f9fa">';
+  h += '<h4 style="color:#007bff;margin-top:0">New Sensor ' + (sensorCount+1) + '</h4>';
+  h += '<style>.sensor-card label { display:inline-block; width:160px; font-weight:bold; margin-bottom:8px; vertical-align:top; } .sensor-card input, .sensor-card select { margin-bottom:12px; } .sensor-form-row { margin-bottom:12px; }</style>';
+  h += '<label><strong>Sensor Type:</strong></label><select name="sensor_' + sensorCount + '_sensor_type" onchange="updateSensorForm(' + sensorCount + ')" style="width:200px;border:1px solid #ccc">';
+  h += '<option value="">Select Sensor Type</option>';
+  h += '<option value="Flow-Meter">Flow-Meter</option>';
+  h += '<option value="Panda_USM">Panda USM</option>';
+  h += '<option value="Clampon">Clampon</option>';
+  h += '<option value="Dailian">Dailian Ultrasonic</option>';
+  h += '<option value="Dailian_EMF">Dailian EMF</option>';
+  h += '<option value="Panda_EMF">Panda EMF</option>';
+  h += '<option value="Panda_Level">Panda Level</option>';
+  h += '<option value="Hydrostatic_Level">Hydrostatic Level (Aquagen)</option>';
+  h += '<option value="Piezometer">Piezometer (Water Level)</option>';
+  h += '<option value="Level">Level</option>';
+  h += '<option value="Radar Level">Radar Level</option>';
+  h += '<option value="RAINGAUGE">Rain Gauge</option>';
+  h += '<option value="BOREWELL">Borewell</option>';
+  h += '<option value="ENERGY">Energy Meter</option>';
+  h += '<option value="ZEST">ZEST</option>';
+  h += '</select><br>';
+  h += '<div id="sensor-form-' + sensorCount + '" style="display:none">';
+  h += '</div>';
+  h += '<div style="margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + sensorCount + ')" style="background:linear-gradient(135deg,#17a2b8,#138496);color:white;padding:12px 28px;margin:5px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(23,162,184,0.3);transition:all 0.3s ease;font-size:15px" onmouseover="this.style.transform=\'translateY(-2px)\';this.style.boxShadow=\'0 5px 12px rgba(23,162,184,0.4)\'" onmouseout="this.style.transform=\'translateY(0)\';this.style.boxShadow=\'0 3px 8px rgba(23,162,184,0.3)\'">🔍 Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + sensorCount + ')" style="background:linear-gradient(135deg,#28a745,#218838);color:white;padding:12px 28px;margin:5px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(40,167,69,0.3);transition:all 0.3s ease;font-size:15px" onmouseover="this.style.transform=\'translateY(-2px)\';this.style.boxShadow=\'0 5px 12px rgba(40,167,69,0.4)\'" onmouseout="this.style.transform=\'translateY(0)\';this.style.boxShadow=\'0 3px 8px rgba(40,167,69,0.3)\'">💾 Save This Sensor</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + sensorCount + ')" style="background:linear-gradient(135deg,#dc3545,#c82333);color:white;padding:12px 28px;margin:5px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(220,53,69,0.3);transition:all 0.3s ease;font-size:15px" onmouseover="this.style.transform=\'translateY(-2px)\';this.style.boxShadow=\'0 5px 12px rgba(220,53,69,0.4)\'" onmouseout="this.style.transform=\'translateY(0)\';this.style.boxShadow=\'0 3px 8px rgba(220,53,69,0.3)\'">❌ Cancel</button>';
+  h += '<div id="test-result-new-' + sensorCount + '" style="margin-top:10px;display:none"></div>';
+  h += '</div></div>';
+  console.log('Adding HTML to sensors div...');
+  div.innerHTML += h;
+  var currentSensorId = sensorCount;
+  sensorCount++;
+  setTimeout(() => {
+    const select = document.querySelector('select[name="sensor_' + currentSensorId + '_data_type"]');
+    if (select) {
+      select.value = '';
+      showDataTypeInfo(select, currentSensorId);
+    }
+  }, 100);
+  console.log('SUCCESS: New sensor added. Updated count:', sensorCount);
+  alert('SUCCESS: New sensor form added!\n\nSTEPS:\n1. Fill in Name and Unit ID (fill in the fields as needed)\n2. Select data type to see detailed format interpretations\n3. Review auto-set quantity and adjust other settings as needed\n4. Click Save This Sensor\n\nEach sensor is saved individually to flash memory!');
+}
+function addRegularSensor() {
+  console.log('ADD REGULAR SENSOR CLICKED - Current count:', sensorCount);
+  var div = document.getElementById('regular-sensors-list');
+  if (!div) { alert('ERROR: Regular sensors container not found!'); console.error('regular-sensors-list div missing'); return; }
+  console.log('Found regular sensors div, building HTML...');
+  var h = '<div class="sensor-card" id="sensor-card-' + sensorCount + '" style="border:2px solid #e0e0e0;border-radius:8px;padding:25px;margin:20px 0;background:#ffffff;box-shadow:0 2px 4px rgba(0,0,0,0.1)">';
+  h += '<h4 style="color:#007bff;margin-top:0;margin-bottom:20px;font-size:18px">New Regular Sensor ' + (sensorCount+1) + '</h4>';
+  h += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-bottom:20px">';
+  h += '<label style="font-weight:600;padding-top:10px">Sensor Type:</label>';
+  h += '<div>';
+  h += '<select name="sensor_' + sensorCount + '_sensor_type" onchange="updateSensorForm(' + sensorCount + ')" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+  h += '<option value="">Select Regular Sensor Type</option>';
+  h += '<option value="Flow-Meter">Flow-Meter</option>';
+  h += '<option value="Panda_USM">Panda USM</option>';
+  h += '<option value="Clampon">Clampon</option>';
+  h += '<option value="Dailian">Dailian Ultrasonic</option>';
+  h += '<option value="Dailian_EMF">Dailian EMF</option>';
+  h += '<option value="Panda_EMF">Panda EMF</option>';
+  h += '<option value="Panda_Level">Panda Level</option>';
+  h += '<option value="Hydrostatic_Level">Hydrostatic Level (Aquagen)</option>';
+  h += '<option value="Piezometer">Piezometer (Water Level)</option>';
+  h += '<option value="Level">Level</option>';
+  h += '<option value="Radar Level">Radar Level</option>';
+  h += '<option value="RAINGAUGE">Rain Gauge</option>';
+  h += '<option value="BOREWELL">Borewell</option>';
+  h += '<option value="ENERGY">Energy Meter</option>';
+  h += '<option value="ZEST">ZEST</option>';
+  h += '</select>';
+  h += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Choose the type of sensor to configure</small>';
+  h += '</div></div>';
+  h += '<div id="sensor-form-' + sensorCount + '" style="display:none">';
+  h += '</div>';
+  h += '<div style="margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + sensorCount + ')" style="background:linear-gradient(135deg,#17a2b8,#138496);color:white;padding:12px 28px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin-right:10px;box-shadow:0 3px 8px rgba(23,162,184,0.3);transition:all 0.3s ease;font-size:15px" onmouseover="this.style.transform=\'translateY(-2px)\';this.style.boxShadow=\'0 5px 12px rgba(23,162,184,0.4)\'" onmouseout="this.style.transform=\'translateY(0)\';this.style.boxShadow=\'0 3px 8px rgba(23,162,184,0.3)\'">🔍 Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + sensorCount + ')" style="background:linear-gradient(135deg,#28a745,#218838);color:white;padding:12px 28px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin-right:10px;box-shadow:0 3px 8px rgba(40,167,69,0.3);transition:all 0.3s ease;font-size:15px" onmouseover="this.style.transform=\'translateY(-2px)\';this.style.boxShadow=\'0 5px 12px rgba(40,167,69,0.4)\'" onmouseout="this.style.transform=\'translateY(0)\';this.style.boxShadow=\'0 3px 8px rgba(40,167,69,0.3)\'">💾 Save This Sensor</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + sensorCount + ')" style="background:linear-gradient(135deg,#dc3545,#c82333);color:white;padding:12px 28px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(220,53,69,0.3);transition:all 0.3s ease;font-size:15px" onmouseover="this.style.transform=\'translateY(-2px)\';this.style.boxShadow=\'0 5px 12px rgba(220,53,69,0.4)\'" onmouseout="this.style.transform=\'translateY(0)\';this.style.boxShadow=\'0 3px 8px rgba(220,53,69,0.3)\'">❌ Cancel</button>';
+  h += '<div id="test-result-new-' + sensorCount + '" style="margin-top:15px;display:none"></div>';
+  h += '</div></div>';
+  console.log('Adding HTML to regular sensors div...');
+  div.innerHTML += h;
+  var currentSensorId = sensorCount;
+  sensorCount++;
+  setTimeout(() => {
+    const select = document.querySelector('select[name="sensor_' + currentSensorId + '_data_type"]');
+    if (select) {
+      select.value = '';
+      showDataTypeInfo(select, currentSensorId);
+    }
+  }, 100);
+  console.log('SUCCESS: New regular sensor added. Updated count:', sensorCount);
+  alert('SUCCESS: New regular sensor form added!\n\nSTEPS:\n1. Fill in Name and Unit ID (fill in the fields as needed)\n2. Select sensor type and data type\n3. Configure parameters as needed\n4. Click Save This Sensor\n\nThis will be saved as a regular sensor!');
+}
+function addWaterQualitySensor() {
+  console.log('ADD WATER QUALITY SENSOR CLICKED - Current count:', sensorCount);
+  var div = document.getElementById('water-quality-sensors-list');
+  if (!div) { alert('ERROR: Water quality sensors container not found!'); console.error('water-quality-sensors-list div missing'); return; }
+  console.log('Found water quality sensors div, building HTML...');
+  var h = '<div class="sensor-card" id="sensor-card-' + sensorCount + '" style="border:2px solid #17a2b8;border-radius:8px;padding:25px;margin:20px 0;background:#ffffff;box-shadow:0 2px 4px rgba(0,0,0,0.1)">';
+  h += '<h4 style="color:#17a2b8;margin-top:0;margin-bottom:20px;font-size:18px">New Water Quality Sensor ' + (sensorCount+1) + '</h4>';
+  h += '<input type="hidden" name="sensor_' + sensorCount + '_sensor_type" value="QUALITY">';
+  h += '<p style="color:#17a2b8;font-weight:600;margin:15px 0;padding:10px;background:#e3f2fd;border-radius:6px;font-size:14px">[TEST] Water Quality Sensor - Automatically set to QUALITY type</p>';
+  h += '<div id="sensor-form-' + sensorCount + '" style="display:block">';
+  h += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-bottom:20px">';
+  h += '<label style="font-weight:600;padding-top:10px">Sensor Name:</label>';
+  h += '<div><input type="text" name="sensor_' + sensorCount + '_name" placeholder="e.g., Tank 1 Water Quality" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+  h += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Display name for this sensor</small></div>';
+  h += '<label style="font-weight:600;padding-top:10px">Unit ID:</label>';
+  h += '<div><input type="text" name="sensor_' + sensorCount + '_unit_id" placeholder="e.g., TFG2235Q" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+  h += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Unique identifier for this water quality sensor</small></div>';
+  h += '<label style="font-weight:600;padding-top:10px">Description:</label>';
+  h += '<div><input type="text" name="sensor_' + sensorCount + '_description" placeholder="e.g., Main tank water quality monitoring" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+  h += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Optional description of sensor location or purpose</small></div>';
+  h += '<label style="font-weight:600;padding-top:10px">Baud Rate:</label>';
+  h += '<div><select name="sensor_' + sensorCount + '_baud_rate" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+  h += '<option value="9600">9600</option><option value="19200">19200</option><option value="38400">38400</option><option value="115200">115200</option>';
+  h += '</select>';
+  h += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Serial communication speed</small></div>';
+  h += '<label style="font-weight:600;padding-top:10px">Parity:</label>';
+  h += '<div><select name="sensor_' + sensorCount + '_parity" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+  h += '<option value="none">None</option><option value="even">Even</option><option value="odd">Odd</option>';
+  h += '</select>';
+  h += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Error checking method</small></div></div>';
+  h += '<p style="color:#28a745;font-size:14px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px">';
+  h += '[INFO] <strong>Main Configuration:</strong> Set the shared Unit ID and communication settings. Individual parameter readings (pH, TDS, etc.) are configured as sub-sensors below.';
+  h += '</p>';
+  h += '<div style="margin-top:20px;padding:15px;background:#f0f8ff;border:2px dashed #17a2b8;border-radius:8px">';
+  h += '<h4 style="color:#17a2b8;margin-top:0">[PARAM] Sub-Sensors - Water Quality Parameters</h4>';
+  h += '<p style="color:#666;font-size:12px;margin:5px 0">Add water quality parameters that will be grouped under this Unit ID in JSON format:</p>';
+  h += '<p style="color:#28a745;font-size:11px;font-family:monospace;background:#f8f8f8;padding:8px;border-radius:4px;margin:5px 0">';
+  h += '{"params_data":{"pH":7,"TDS":100,"Temp":32,"HUMIDITY":65,"BOD":15,"COD":45},"type":"QUALITY","unit_id":"TFG2235Q"}';
+  h += '</p>';
+  h += '<div id="sub-sensors-' + sensorCount + '" style="margin:10px 0"></div>';
+  h += '<button type="button" onclick="addSubSensorToQualitySensor(' + sensorCount + ')" style="background:#28a745;color:white;padding:8px 16px;border:none;border-radius:4px;font-size:14px;cursor:pointer">➕ Add Sub-Sensor</button>';
+  h += '</div>';
+  h += '<div style="margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + sensorCount + ')" style="background:#17a2b8;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + sensorCount + ')" style="background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Save Sensor</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + sensorCount + ')" style="background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Cancel</button>';
+  h += '<div id="test-result-new-' + sensorCount + '" style="margin-top:15px;display:none"></div>';
+  h += '</div></div>';
+  div.innerHTML += h;
+  sensorCount++;
+}
+function addAquadaxQualitySensor() {
+  var div = document.getElementById('water-quality-sensors-list');
+  if (!div) { alert('Container not found!'); return; }
+  var s = sensorCount;
+  var h = '<div class="sensor-card" id="sensor-card-' + s + '" style="border:2px solid #0d6efd;padding:20px;margin:15px 0">';
+  h += '<h4 style="color:#0d6efd">New Aquadax Quality Sensor ' + (s+1) + '</h4>';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_type" value="Aquadax_Quality">';
+  h += '<input type="hidden" name="sensor_' + s + '_data_type" value="AQUADAX_QUALITY_FIXED">';
+  h += '<input type="hidden" name="sensor_' + s + '_byte_order" value="BIG_ENDIAN">';
+  h += '<input type="hidden" name="sensor_' + s + '_register_type" value="HOLDING">';
+  h += '<input type="hidden" name="sensor_' + s + '_quantity" value="12">';
+  h += '<input type="hidden" name="sensor_' + s + '_scale_factor" value="1.0">';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_height" value="0">';
+  h += '<input type="hidden" name="sensor_' + s + '_max_water_level" value="0">';
+  h += '<p style="color:#0d6efd;font-weight:600;padding:8px;background:#e7f1ff;border-radius:6px">Aquadax - COD, BOD, TSS, pH, Temp (5x FLOAT32 CDAB)</p>';
+  h += '<div id="sensor-form-' + s + '">';
+  h += '<div style="display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px">';
+  h += '<label style="font-weight:600;padding-top:8px">Name:</label>';
+  h += '<input type="text" name="sensor_' + s + '_name" placeholder="Aquadax WQ 1" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Unit ID:</label>';
+  h += '<input type="text" name="sensor_' + s + '_unit_id" placeholder="AQ001" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Slave ID:</label>';
+  h += '<input type="number" name="sensor_' + s + '_slave_id" value="1" min="1" max="247" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Register:</label>';
+  h += '<input type="number" name="sensor_' + s + '_register_address" value="1280" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Baud Rate:</label>';
+  h += '<select name="sensor_' + s + '_baud_rate" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="9600">9600</option><option value="19200">19200</option><option value="38400">38400</option><option value="115200">115200</option></select>';
+  h += '<label style="font-weight:600;padding-top:8px">Parity:</label>';
+  h += '<select name="sensor_' + s + '_parity" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="none">None</option><option value="even">Even</option><option value="odd">Odd</option></select></div>';
+  h += '<div style="text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + s + ')" style="background:#0d6efd;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + s + ')" style="background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Save</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + s + ')" style="background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Cancel</button>';
+  h += '<div id="test-result-new-' + s + '" style="margin-top:10px;display:none"></div>';
+  h += '</div></div></div>';
+  div.innerHTML += h;
+  sensorCount++;
+}
+function addOprussAceSensor() {
+  var div = document.getElementById('water-quality-sensors-list');
+  if (!div) { alert('Container not found!'); return; }
+  var s = sensorCount;
+  var h = '<div class="sensor-card" id="sensor-card-' + s + '" style="border:2px solid #e67e22;padding:20px;margin:15px 0">';
+  h += '<h4 style="color:#e67e22">New Opruss Ace Sensor ' + (s+1) + '</h4>';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_type" value="Opruss_Ace">';
+  h += '<input type="hidden" name="sensor_' + s + '_data_type" value="OPRUSS_ACE_FIXED">';
+  h += '<input type="hidden" name="sensor_' + s + '_byte_order" value="BIG_ENDIAN">';
+  h += '<input type="hidden" name="sensor_' + s + '_register_type" value="HOLDING">';
+  h += '<input type="hidden" name="sensor_' + s + '_quantity" value="22">';
+  h += '<input type="hidden" name="sensor_' + s + '_scale_factor" value="1.0">';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_height" value="0">';
+  h += '<input type="hidden" name="sensor_' + s + '_max_water_level" value="0">';
+  h += '<p style="color:#e67e22;font-weight:600;padding:8px;background:#fef5e7;border-radius:6px">Opruss Ace - COD, BOD, TSS + TDS, Temp (Slave 2)</p>';
+  h += '<div id="sensor-form-' + s + '">';
+  h += '<div style="display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px">';
+  h += '<label style="font-weight:600;padding-top:8px">Name:</label>';
+  h += '<input type="text" name="sensor_' + s + '_name" placeholder="Opruss Ace WQ 1" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Unit ID:</label>';
+  h += '<input type="text" name="sensor_' + s + '_unit_id" placeholder="OPA001" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Slave ID:</label>';
+  h += '<input type="number" name="sensor_' + s + '_slave_id" value="1" min="1" max="247" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Register:</label>';
+  h += '<input type="number" name="sensor_' + s + '_register_address" value="0" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Baud Rate:</label>';
+  h += '<select name="sensor_' + s + '_baud_rate" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="9600">9600</option><option value="19200">19200</option><option value="38400">38400</option><option value="115200">115200</option></select>';
+  h += '<label style="font-weight:600;padding-top:8px">Parity:</label>';
+  h += '<select name="sensor_' + s + '_parity" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="none">None</option><option value="even">Even</option><option value="odd">Odd</option></select></div>';
+  h += '<div style="text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + s + ')" style="background:#e67e22;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + s + ')" style="background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Save</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + s + ')" style="background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Cancel</button>';
+  h += '<div id="test-result-new-' + s + '" style="margin-top:10px;display:none"></div>';
+  h += '</div></div></div>';
+  div.innerHTML += h;
+  sensorCount++;
+}
+function addAsterSensor() {
+  var div = document.getElementById('water-quality-sensors-list');
+  if (!div) { alert('Container not found!'); return; }
+  var s = sensorCount;
+  var h = '<div class="sensor-card" id="sensor-card-' + s + '" style="border:2px solid #8e44ad;padding:20px;margin:15px 0">';
+  h += '<h4 style="color:#8e44ad">New Aster Sensor ' + (s+1) + '</h4>';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_type" value="Aster">';
+  h += '<input type="hidden" name="sensor_' + s + '_data_type" value="ASTER_FIXED">';
+  h += '<input type="hidden" name="sensor_' + s + '_byte_order" value="BIG_ENDIAN">';
+  h += '<input type="hidden" name="sensor_' + s + '_register_type" value="HOLDING">';
+  h += '<input type="hidden" name="sensor_' + s + '_quantity" value="4">';
+  h += '<input type="hidden" name="sensor_' + s + '_scale_factor" value="0.01">';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_height" value="0">';
+  h += '<input type="hidden" name="sensor_' + s + '_max_water_level" value="0">';
+  h += '<p style="color:#8e44ad;font-weight:600;padding:8px;background:#f4ecf7;border-radius:6px">Aster - pH (Reg 6) + TDS (Slave 2, Reg 0) UINT16</p>';
+  h += '<div id="sensor-form-' + s + '">';
+  h += '<div style="display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px">';
+  h += '<label style="font-weight:600;padding-top:8px">Name:</label>';
+  h += '<input type="text" name="sensor_' + s + '_name" placeholder="Aster WQ 1" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Unit ID:</label>';
+  h += '<input type="text" name="sensor_' + s + '_unit_id" placeholder="AST001" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Slave ID:</label>';
+  h += '<input type="number" name="sensor_' + s + '_slave_id" value="1" min="1" max="247" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Register:</label>';
+  h += '<input type="number" name="sensor_' + s + '_register_address" value="6" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Baud Rate:</label>';
+  h += '<select name="sensor_' + s + '_baud_rate" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="9600">9600</option><option value="19200">19200</option><option value="38400">38400</option><option value="115200">115200</option></select>';
+  h += '<label style="font-weight:600;padding-top:8px">Parity:</label>';
+  h += '<select name="sensor_' + s + '_parity" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="none">None</option><option value="even">Even</option><option value="odd">Odd</option></select></div>';
+  h += '<div style="text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + s + ')" style="background:#8e44ad;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + s + ')" style="background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Save</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + s + ')" style="background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Cancel</button>';
+  h += '<div id="test-result-new-' + s + '" style="margin-top:10px;display:none"></div>';
+  h += '</div></div></div>';
+  div.innerHTML += h;
+  sensorCount++;
+}
+function addHardnessSensor() {
+  var div = document.getElementById('water-quality-sensors-list');
+  if (!div) { alert('Container not found!'); return; }
+  var s = sensorCount;
+  var h = '<div class="sensor-card" id="sensor-card-' + s + '" style="border:2px solid #6f42c1;padding:20px;margin:15px 0">';
+  h += '<h4 style="color:#6f42c1">New Hardness Sensor ' + (s+1) + '</h4>';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_type" value="Hardness_Sensor">';
+  h += '<input type="hidden" name="sensor_' + s + '_data_type" value="HARDNESS_FIXED">';
+  h += '<input type="hidden" name="sensor_' + s + '_byte_order" value="BIG_ENDIAN">';
+  h += '<input type="hidden" name="sensor_' + s + '_register_type" value="HOLDING">';
+  h += '<input type="hidden" name="sensor_' + s + '_quantity" value="6">';
+  h += '<input type="hidden" name="sensor_' + s + '_scale_factor" value="1.0">';
+  h += '<input type="hidden" name="sensor_' + s + '_sensor_height" value="0">';
+  h += '<input type="hidden" name="sensor_' + s + '_max_water_level" value="0">';
+  h += '<p style="color:#6f42c1;font-weight:600;padding:8px;background:#f3eefb;border-radius:6px">Hardness - Hardness (mg/L) + Temperature (&deg;C) (FLOAT32 CDAB, 6 regs from 230)</p>';
+  h += '<div id="sensor-form-' + s + '">';
+  h += '<div style="display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px">';
+  h += '<label style="font-weight:600;padding-top:8px">Name:</label>';
+  h += '<input type="text" name="sensor_' + s + '_name" placeholder="Hardness 1" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Unit ID:</label>';
+  h += '<input type="text" name="sensor_' + s + '_unit_id" placeholder="HARD-01" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Slave ID:</label>';
+  h += '<input type="number" name="sensor_' + s + '_slave_id" value="1" min="1" max="247" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Register:</label>';
+  h += '<input type="number" name="sensor_' + s + '_register_address" value="230" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<label style="font-weight:600;padding-top:8px">Baud Rate:</label>';
+  h += '<select name="sensor_' + s + '_baud_rate" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="9600">9600</option><option value="19200">19200</option><option value="38400">38400</option><option value="115200">115200</option></select>';
+  h += '<label style="font-weight:600;padding-top:8px">Parity:</label>';
+  h += '<select name="sensor_' + s + '_parity" style="padding:8px;border:1px solid #ccc;border-radius:4px">';
+  h += '<option value="none">None</option><option value="even">Even</option><option value="odd">Odd</option></select></div>';
+  h += '<div style="text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0">';
+  h += '<button type="button" onclick="testNewSensorRS485(' + s + ')" style="background:#6f42c1;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Test RS485</button>';
+  h += '<button type="button" onclick="saveSingleSensor(' + s + ')" style="background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Save</button>';
+  h += '<button type="button" onclick="removeSensorForm(' + s + ')" style="background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px">Cancel</button>';
+  h += '<div id="test-result-new-' + s + '" style="margin-top:10px;display:none"></div>';
+  h += '</div></div></div>';
+  div.innerHTML += h;
+  sensorCount++;
+}
+var qualityParameterTypes = [
+  {key: 'pH', name: 'pH', units: 'pH', description: 'Acidity/Alkalinity measurement'},
+  {key: 'Temp', name: 'Temp', units: 'degC', description: 'Water temperature sensor'},
+  {key: 'HUMIDITY', name: 'HUMIDITY', units: '%RH', description: 'Relative humidity measurement'},
+  {key: 'TDS', name: 'TDS', units: 'ppm', description: 'Total dissolved solids concentration'},
+  {key: 'TSS', name: 'TSS', units: 'mg/L', description: 'Total suspended solids'},
+  {key: 'BOD', name: 'BOD', units: 'mg/L', description: 'Biochemical oxygen demand'},
+  {key: 'COD', name: 'COD', units: 'mg/L', description: 'Chemical oxygen demand'},
+  {key: 'conductivity', name: 'Conductivity', units: 'µS/cm', description: 'Electrical conductivity'},
+  {key: 'do', name: 'Dissolved Oxygen', units: 'mg/L', description: 'Oxygen content in water'},
+  {key: 'orp', name: 'ORP (Oxidation Reduction Potential)', units: 'mV', description: 'Oxidation potential'},
+  {key: 'ammonia', name: 'Ammonia', units: 'mg/L', description: 'Ammonia concentration'},
+  {key: 'nitrate', name: 'Nitrate', units: 'mg/L', description: 'Nitrate levels'},
+  {key: 'phosphate', name: 'Phosphate', units: 'mg/L', description: 'Phosphate concentration'},
+  {key: 'chlorine', name: 'Chlorine', units: 'mg/L', description: 'Chlorine disinfectant level'},
+  {key: 'salinity', name: 'Salinity', units: 'ppt', description: 'Salt concentration'}
+];
+function addSubSensorToQualitySensor(sensorIndex) {
+  var subSensorDiv = document.getElementById('sub-sensors-' + sensorIndex);
+  if (!subSensorDiv) {
+    alert('ERROR: Sub-sensors container not found');
+    return;
+  }
+  
+  var subSensorCount = subSensorDiv.querySelectorAll('.sub-sensor').length;
+  var subSensorId = 'sub-sensor-' + sensorIndex + '-' + subSensorCount;
+  
+  var h = '<div class="sub-sensor" id="' + subSensorId + '" style="border:1px solid #28a745;padding:10px;margin:10px 0;background:#f8fff8;border-radius:5px">';
+  h += '<h5 style="color:#28a745;margin-top:0">[PARAM] Sub-Sensor ' + (subSensorCount + 1) + '</h5>';
+  h += '<div style="display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0">';
+  h += '<div><label style="font-weight:bold">Parameter Type:</label><br><select name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_parameter" style="width:100%;padding:5px">';
+  h += '<option value="">Select Parameter</option>';
+  for (var i = 0; i < qualityParameterTypes.length; i++) {
+    var param = qualityParameterTypes[i];
+    h += '<option value="' + param.key + '">' + param.name + ' (' + param.units + ')</option>';
+  }
+  h += '</select></div>';
+  h += '<div><label style="font-weight:bold">Slave ID:</label><br><input type="number" name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_slave_id" value="1" min="1" max="247" style="width:100%;padding:5px"></div>';
+  h += '<div><label style="font-weight:bold">Register:</label><br><input type="number" name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_register" value="1" min="0" max="65535" style="width:100%;padding:5px"></div>';
+  h += '</div>';
+  h += '<div style="display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0">';
+  h += '<div><label style="font-weight:bold">Quantity:</label><br><input type="number" name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_quantity" value="1" min="1" max="10" style="width:100%;padding:5px"></div>';
+  h += '<div><label style="font-weight:bold">Register Type:</label><br><select name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_register_type" style="width:100%;padding:5px">';
+  h += '<option value="HOLDING_REGISTER" selected>Holding Register</option>';
+  h += '<option value="INPUT_REGISTER">Input Register</option>';
+  h += '</select></div>';
+  h += '</div>';
+  h += '<div style="display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0">';
+  h += '<div><label style="font-weight:bold">Data Type:</label><br><select name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_data_type" style="width:100%;padding:5px">';
+  h += '<option value="">Select Data Type</option>';
+  h += '<optgroup label="8-bit Integer Types">';
+  h += '<option value="INT8">INT8 - 8-bit Signed</option>';
+  h += '<option value="UINT8">UINT8 - 8-bit Unsigned</option>';
+  h += '</optgroup>';
+  h += '<optgroup label="16-bit Integer Types">';
+  h += '<option value="INT16">INT16 - 16-bit Signed</option>';
+  h += '<option value="UINT16">UINT16 - 16-bit Unsigned</option>';
+  h += '</optgroup>';
+  h += '<optgroup label="32-bit Integer Types">';
+  h += '<option value="INT32_ABCD">INT32_ABCD - Big Endian</option>';
+  h += '<option value="INT32_DCBA">INT32_DCBA - Little Endian</option>';
+  h += '<option value="INT32_BADC">INT32_BADC - Mid-Big Endian</option>';
+  h += '<option value="INT32_CDAB">INT32_CDAB - Mid-Little Endian</option>';
+  h += '<option value="UINT32_ABCD">UINT32_ABCD - Big Endian</option>';
+  h += '<option value="UINT32_DCBA">UINT32_DCBA - Little Endian</option>';
+  h += '<option value="UINT32_BADC">UINT32_BADC - Mid-Big Endian</option>';
+  h += '<option value="UINT32_CDAB">UINT32_CDAB - Mid-Little Endian</option>';
+  h += '</optgroup>';
+  h += '<optgroup label="32-bit Float Types">';
+  h += '<option value="FLOAT32_ABCD">FLOAT32_ABCD - Big Endian</option>';
+  h += '<option value="FLOAT32_DCBA">FLOAT32_DCBA - Little Endian</option>';
+  h += '<option value="FLOAT32_BADC">FLOAT32_BADC - Mid-Big Endian</option>';
+  h += '<option value="FLOAT32_CDAB">FLOAT32_CDAB - Mid-Little Endian</option>';
+  h += '</optgroup>';
+  h += '<optgroup label="64-bit Integer Types">';
+  h += '<option value="INT64_12345678">INT64_12345678 - Big Endian</option>';
+  h += '<option value="INT64_87654321">INT64_87654321 - Little Endian</option>';
+  h += '<option value="INT64_21436587">INT64_21436587 - Mid-Big Endian</option>';
+  h += '<option value="INT64_78563412">INT64_78563412 - Mid-Little Endian</option>';
+  h += '<option value="UINT64_12345678">UINT64_12345678 - Big Endian</option>';
+  h += '<option value="UINT64_87654321">UINT64_87654321 - Little Endian</option>';
+  h += '<option value="UINT64_21436587">UINT64_21436587 - Mid-Big Endian</option>';
+  h += '<option value="UINT64_78563412">UINT64_78563412 - Mid-Little Endian</option>';
+  h += '</optgroup>';
+  h += '<optgroup label="64-bit Float Types">';
+  h += '<option value="FLOAT64_12345678">FLOAT64_12345678 - Big Endian</option>';
+  h += '<option value="FLOAT64_87654321">FLOAT64_87654321 - Little Endian</option>';
+  h += '<option value="FLOAT64_21436587">FLOAT64_21436587 - Mid-Big Endian</option>';
+  h += '<option value="FLOAT64_78563412">FLOAT64_78563412 - Mid-Little Endian</option>';
+  h += '</optgroup>';
+  h += '<optgroup label="Special Types">';
+  h += '<option value="ASCII">ASCII String</option>';
+  h += '<option value="HEX">Hexadecimal</option>';
+  h += '<option value="BOOL">Boolean</option>';
+  h += '<option value="PDU">PDU (Protocol Data Unit)</option>';
+  h += '</optgroup>';
+  h += '</select></div>';
+  h += '<div><label style="font-weight:bold">Scale Factor:</label><br><input type="number" name="sensor_' + sensorIndex + '_sub_' + subSensorCount + '_scale" value="1" step="0.001" style="width:100%;padding:5px"></div>';
+  h += '</div>';
+  h += '<div style="text-align:right;margin-top:10px">';
+  h += '<button type="button" onclick="saveSubSensor(\'' + subSensorId + '\')" style="background:#28a745;color:white;padding:5px 15px;border:none;border-radius:3px;cursor:pointer;margin-right:5px">[SAVE] Save</button>';
+  h += '<button type="button" onclick="removeSubSensor(\'' + subSensorId + '\')" style="background:#dc3545;color:white;padding:5px 15px;border:none;border-radius:3px;cursor:pointer">[ERROR] Remove</button>';
+  h += '</div>';
+  h += '</div>';
+  
+  subSensorDiv.insertAdjacentHTML('beforeend', h);
+  alert('Sub-sensor added! Configure its parameters and save the water quality sensor.');
+}
+function removeSubSensor(subSensorId) {
+  var subSensor = document.getElementById(subSensorId);
+  if (subSensor && confirm('Remove this sub-sensor?')) {
+    subSensor.remove();
+  }
+}
+function saveSubSensor(subSensorId) {
+  alert('Sub-sensor configuration saved locally.\n\nClick the main SAVE button to save all changes to the device.');
+}
+function updateSensorForm(sensorId) {
+const sensorType = document.querySelector('select[name="sensor_' + sensorId + '_sensor_type"]').value;
+const formDiv = document.getElementById('sensor-form-' + sensorId);
+if (!sensorType) {
+formDiv.style.display = 'none';
+return;
+}
+let formHtml = '';
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Name:</label>';
+formHtml += '<div><input type="text" name="sensor_' + sensorId + '_name" placeholder="e.g., Flow Meter 1" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Sensor display name</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Unit ID:</label>';
+formHtml += '<div><input type="text" name="sensor_' + sensorId + '_unit_id" placeholder="e.g., FG1234" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Unique identifier for this sensor</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Slave ID:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_slave_id" value="1" min="1" max="247" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Modbus slave address (1-247)</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Register Address:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_register_address" value="0" min="0" max="65535" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Starting register to read (0-65535)</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Quantity:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_quantity" value="1" min="1" max="125" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Number of registers to read (1-125)</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Register Type:</label>';
+formHtml += '<div><select name="sensor_' + sensorId + '_register_type" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<option value="HOLDING">Holding Registers (03) - Read/Write</option>';
+formHtml += '<option value="INPUT">Input Registers (04) - Read Only</option>';
+formHtml += '</select>';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Modbus register type</small></div>';
+formHtml += '</div>';
+if (sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && sensorType !== 'Panda_USM' && sensorType !== 'Aquadax_Quality' && sensorType !== 'Opruss_Ace' && sensorType !== 'Hardness_Sensor') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Data Type:</label>';
+formHtml += '<div><select name="sensor_' + sensorId + '_data_type" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px" onchange="showDataTypeInfo(this, ' + sensorId + ')">';
+formHtml += '<option value="" disabled selected>-- Select Data Type (Required) --</option>';
+formHtml += '<optgroup label="8-bit Formats (0.5 register)">';
+formHtml += '<option value="INT8">8-bit INT (-128 to 127)</option>';
+formHtml += '<option value="UINT8">8-bit UINT (0 to 255)</option>';
+formHtml += '</optgroup>';
+formHtml += '<optgroup label="16-bit Formats (1 register)">';
+formHtml += '<option value="INT16_HI">16-bit INT, high byte first</option>';
+formHtml += '<option value="INT16_LO">16-bit INT, low byte first</option>';
+formHtml += '<option value="UINT16_HI">16-bit UINT, high byte first</option>';
+formHtml += '<option value="UINT16_LO">16-bit UINT, low byte first</option>';
+formHtml += '</optgroup>';
+formHtml += '<optgroup label="32-bit Float Formats (2 registers)">';
+formHtml += '<option value="FLOAT32_1234">32-bit float, Byte order 1,2,3,4</option>';
+formHtml += '<option value="FLOAT32_4321">32-bit float, Byte order 4,3,2,1</option>';
+formHtml += '<option value="FLOAT32_2143">32-bit float, Byte order 2,1,4,3</option>';
+formHtml += '<option value="FLOAT32_3412">32-bit float, Byte order 3,4,1,2</option>';
+formHtml += '</optgroup>';
+formHtml += '<optgroup label="32-bit Integer Formats (2 registers)">';
+formHtml += '<option value="INT32_1234">32-bit INT, Byte order 1,2,3,4</option>';
+formHtml += '<option value="INT32_4321">32-bit INT, Byte order 4,3,2,1</option>';
+formHtml += '<option value="INT32_2143">32-bit INT, Byte order 2,1,4,3</option>';
+formHtml += '<option value="INT32_3412">32-bit INT, Byte order 3,4,1,2</option>';
+formHtml += '<option value="UINT32_1234">32-bit UINT, Byte order 1,2,3,4</option>';
+formHtml += '<option value="UINT32_4321">32-bit UINT, Byte order 4,3,2,1</option>';
+formHtml += '<option value="UINT32_2143">32-bit UINT, Byte order 2,1,4,3</option>';
+formHtml += '<option value="UINT32_3412">32-bit UINT, Byte order 3,4,1,2</option>';
+formHtml += '</optgroup>';
+formHtml += '<optgroup label="64-bit Integer Formats (4 registers)">';
+formHtml += '<option value="INT64_12345678">64-bit INT, Byte order 1,2,3,4,5,6,7,8</option>';
+formHtml += '<option value="INT64_87654321">64-bit INT, Byte order 8,7,6,5,4,3,2,1</option>';
+formHtml += '<option value="INT64_21436587">64-bit INT, Byte order 2,1,4,3,6,5,8,7</option>';
+formHtml += '<option value="INT64_78563412">64-bit INT, Byte order 7,8,5,6,3,4,1,2</option>';
+formHtml += '<option value="UINT64_12345678">64-bit UINT, Byte order 1,2,3,4,5,6,7,8</option>';
+formHtml += '<option value="UINT64_87654321">64-bit UINT, Byte order 8,7,6,5,4,3,2,1</option>';
+formHtml += '<option value="UINT64_21436587">64-bit UINT, Byte order 2,1,4,3,6,5,8,7</option>';
+formHtml += '<option value="UINT64_78563412">64-bit UINT, Byte order 7,8,5,6,3,4,1,2</option>';
+formHtml += '</optgroup>';
+formHtml += '<optgroup label="64-bit Float Formats (4 registers)">';
+formHtml += '<option value="FLOAT64_12345678">64-bit float, Byte order 1,2,3,4,5,6,7,8</option>';
+formHtml += '<option value="FLOAT64_87654321">64-bit float, Byte order 8,7,6,5,4,3,2,1</option>';
+formHtml += '<option value="FLOAT64_21436587">64-bit float, Byte order 2,1,4,3,6,5,8,7</option>';
+formHtml += '<option value="FLOAT64_78563412">64-bit float, Byte order 7,8,5,6,3,4,1,2</option>';
+formHtml += '</optgroup>';
+formHtml += '<optgroup label="Special Formats">';
+formHtml += '<option value="ASCII">ASCII String</option>';
+formHtml += '<option value="HEX">Hexadecimal</option>';
+formHtml += '<option value="BOOL">Boolean (True/False)</option>';
+formHtml += '<option value="PDU">PDU (Protocol Data Unit)</option>';
+formHtml += '</optgroup></select>';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Select the format of data returned by sensor</small></div>';
+formHtml += '</div>';
+formHtml += '<div id="datatype-info-' + sensorId + '" style="background:#e3f2fd;padding:15px;margin:20px 0;border-radius:6px;font-size:13px;display:none"></div>';
+} else if (sensorType === 'ZEST') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="ZEST_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - INT32_BE + INT32_LE_SWAP</p>';
+} else if (sensorType === 'Clampon') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="CLAMPON_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - INT32 + FLOAT32 (word-swapped)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Clampon defaults: Register 8, Quantity 4 - Integer (2 reg) + Float decimal (2 reg)</em></p>';
+} else if (sensorType === 'Dailian') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="UINT32_3412">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - UINT32_3412 (CDAB byte order)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Dailian Ultrasonic defaults: Register 8, Quantity 2 - 32-bit value</em></p>';
+} else if (sensorType === 'Dailian_EMF') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="DAILIAN_EMF_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - UINT32 word-swapped (Totaliser)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Dailian EMF defaults: Register 2006 (0x07D6), Quantity 2 - 32-bit totaliser value</em></p>';
+} else if (sensorType === 'Panda_EMF') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="PANDA_EMF_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - INT32_BE (Integer) + FLOAT32_BE (Decimal)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Panda EMF defaults: Register 4114 (0x1012), Quantity 4 - Totaliser (Integer + Float decimal)</em></p>';
+} else if (sensorType === 'Panda_Level') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="PANDA_LEVEL_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - UINT16 (16-bit level value)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Panda Level defaults: Register 1 (0x0001), Quantity 1 - Level percentage = ((Sensor Height - Value) / Tank Height) × 100</em></p>';
+} else if (sensorType === 'Hydrostatic_Level') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="UINT16_BE">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - UINT16_BE (16-bit unsigned)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Hydrostatic Level defaults: Register 4 (0x0004), Quantity 1 - Level percentage = (Raw Value / Tank Height) × 100</em></p>';
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Tank Height (m):</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_max_water_level" value="0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Total tank height for level % calculation (Level % = Raw Value / Tank Height × 100)</small></div></div>';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_sensor_height" value="0">';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_scale_factor" value="1.0">';
+} else if (sensorType === 'Aquadax_Quality') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="AQUADAX_QUALITY_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - 5x FLOAT32 CDAB (word-swap)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Aquadax Quality defaults: Address 1280 (0x0500), Qty 12 - Reads COD, BOD, TSS, pH, Temperature as Float32</em></p>';
+} else if (sensorType === 'Opruss_Ace') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="OPRUSS_ACE_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - COD/BOD/TSS (FLOAT32 CDAB) + TDS/Temp from Slave 2 (FLOAT32 DCBA)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Opruss Ace: Address 0, Qty 22 (COD/BOD/TSS) + Slave 2 Input Reg 0x0016 (TDS) &amp; 0x0020 (Temp)</em></p>';
+} else if (sensorType === 'Aster') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="ASTER_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px"><b>Aster:</b> pH UINT16x0.01 (Reg 6) + TDS UINT16 (Slave 2, Reg 0)</p>';
+} else if (sensorType === 'Hardness_Sensor') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="HARDNESS_FIXED">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - 2x FLOAT32 CDAB (word-swap)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Hardness defaults: Address 230 (0x00E6), Qty 6 - Reads Hardness (mg/L) and Temperature (&deg;C)</em></p>';
+} else if (sensorType === 'Piezometer') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="UINT16_HI">';
+formHtml += '<p style="color:#28a745;font-size:12px;margin:10px 0"><strong>Data Format:</strong> Fixed - UINT16_HI (16-bit unsigned integer)</p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Piezometer defaults: Register 10, Quantity 1, Scale 0.01 - reads water level in mwc (e.g., 14542 × 0.01 = 145.42 mwc)</em></p>';
+}
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Baud Rate:</label>';
+formHtml += '<div><select name="sensor_' + sensorId + '_baud_rate" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<option value="2400">2400 bps</option><option value="4800">4800 bps</option><option value="9600" selected>9600 bps</option><option value="19200">19200 bps</option><option value="38400">38400 bps</option><option value="57600">57600 bps</option><option value="115200">115200 bps</option></select>';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Serial communication speed</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Parity:</label>';
+formHtml += '<div><select name="sensor_' + sensorId + '_parity" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<option value="none" selected>None</option><option value="even">Even</option><option value="odd">Odd</option></select>';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Error checking method</small></div>';
+formHtml += '</div>';
+if (sensorType === 'Flow-Meter') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Multiplier applied to raw sensor value (e.g., 0.1 for /10, 1.0 for no scaling)</small></div></div>';
+} else if (sensorType === 'Panda_USM') {
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_data_type" value="FLOAT64_12345678">';
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Multiplier for positive volume (usually 1.0)</small></div></div>';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - FLOAT64_12345678 (Big-Endian Double) - no data type selection needed</strong></p>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>Panda USM defaults: Register 8 (Positive Volume), Quantity 4 (64-bit Double)</em></p>';
+} else if (sensorType === 'Level') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Sensor Height:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_sensor_height" value="0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Physical height of the sensor from bottom (meters or your unit)</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Max Water Level:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_max_water_level" value="0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Maximum water level for calculation (meters or your unit)</small></div></div>';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_scale_factor" value="1.0">';
+} else if (sensorType === 'Radar Level') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Max Water Level:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_max_water_level" value="0" step="any" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Maximum water level for percentage calculation (meters or your unit)</small></div></div>';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_sensor_height" value="0">';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_scale_factor" value="1.0">';
+} else if (sensorType === 'ENERGY') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Meter Type:</label>';
+formHtml += '<div><input type="text" name="sensor_' + sensorId + '_meter_type" placeholder="e.g., Power Meter, Electric Meter" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Type of energy meter (will be used as meter identifier in JSON)</small></div></div>';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_scale_factor" value="1.0">';
+} else if (sensorType === 'RAINGAUGE') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Rain gauge scaling factor (e.g., 0.1 for mm/tips, 1.0 for direct reading)</small></div></div>';
+} else if (sensorType === 'BOREWELL') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Scaling multiplier for borewell measurements</small></div></div>';
+} else if (sensorType === 'ZEST') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Applied to both INT32 values</small></div></div>';
+formHtml += '<p style="color:#007bff;font-size:11px;margin:5px 0"><em>ZEST defaults: Register 4121, Quantity 4 - First 2 as INT32_BE, next 2 as INT32_LE_SWAP, then sums them</em></p>';
+formHtml += '<p style="color:#28a745;font-size:10px;margin:5px 0"><strong>Fixed format - no data type selection needed</strong></p>';
+} else if (sensorType === 'Clampon') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Multiplier for raw value</small></div></div>';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - INT32 + FLOAT32 (word-swapped) - no data type selection needed</strong></p>';
+} else if (sensorType === 'Dailian') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Value multiplier</small></div></div>';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - UINT32_3412 (CDAB) - no data type selection needed</strong></p>';
+} else if (sensorType === 'Dailian_EMF') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Multiplier for totaliser value</small></div></div>';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - UINT32 word-swapped (Dailian EMF) - no data type selection needed</strong></p>';
+} else if (sensorType === 'Panda_EMF') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="1.0" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Multiplier for totaliser value</small></div></div>';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - INT32_BE + FLOAT32_BE (Panda EMF) - no data type selection needed</strong></p>';
+} else if (sensorType === 'Panda_Level') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Sensor Height (m):</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_sensor_height" value="0" step="any" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Distance from sensor to bottom of tank (meters)</small></div>';
+formHtml += '<label style="font-weight:600;padding-top:10px">Tank Height (m):</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_max_water_level" value="0" step="any" style="width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">Total tank height for percentage calculation</small></div></div>';
+formHtml += '<input type="hidden" name="sensor_' + sensorId + '_scale_factor" value="1.0">';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - UINT16 (Panda Level) - Level % = ((Sensor Height - Raw Value) / Tank Height) × 100</strong></p>';
+} else if (sensorType === 'Piezometer') {
+formHtml += '<div style="display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px">';
+formHtml += '<label style="font-weight:600;padding-top:10px">Scale Factor:</label>';
+formHtml += '<div><input type="number" name="sensor_' + sensorId + '_scale_factor" value="0.01" step="any" style="width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px">';
+formHtml += '<small style="color:#888;display:block;margin-top:5px;font-size:13px">0.01 for 2 implicit decimals: 14542 = 145.42</small></div></div>';
+formHtml += '<p style="color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px"><strong>Fixed format - UINT16_HI (16-bit) - no data type selection needed</strong></p>';
+}
+formHtml += '<br>';
+formDiv.innerHTML = formHtml;
+formDiv.style.display = 'block';
+if (sensorType === 'Clampon') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+if (quantityInput) quantityInput.value = '4';
+if (regAddrInput) regAddrInput.value = '8';
+} else if (sensorType === 'Dailian') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '2';
+if (regAddrInput) regAddrInput.value = '8';
+if (scaleInput) scaleInput.value = '1.0';
+} else if (sensorType === 'Dailian_EMF') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '2';
+if (regAddrInput) regAddrInput.value = '2006';
+if (scaleInput) scaleInput.value = '1.0';
+} else if (sensorType === 'Panda_EMF') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '4';
+if (regAddrInput) regAddrInput.value = '4114';
+if (scaleInput) scaleInput.value = '1.0';
+} else if (sensorType === 'Panda_Level') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+if (quantityInput) quantityInput.value = '1';
+if (regAddrInput) regAddrInput.value = '1';
+} else if (sensorType === 'Hydrostatic_Level') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+if (quantityInput) quantityInput.value = '1';
+if (regAddrInput) regAddrInput.value = '4';
+} else if (sensorType === 'Piezometer') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '1';
+if (regAddrInput) regAddrInput.value = '10';
+if (scaleInput) scaleInput.value = '0.01';
+} else if (sensorType === 'Panda_USM') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '4';
+if (regAddrInput) regAddrInput.value = '8';
+if (scaleInput) scaleInput.value = '1.0';
+} else if (sensorType === 'ZEST') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+if (quantityInput) quantityInput.value = '4';
+if (regAddrInput) regAddrInput.value = '4121';
+} else if (sensorType === 'Aquadax_Quality') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+if (quantityInput) quantityInput.value = '12';
+if (regAddrInput) regAddrInput.value = '1280';
+} else if (sensorType === 'Opruss_Ace') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '22';
+if (regAddrInput) regAddrInput.value = '0';
+if (scaleInput) scaleInput.value = '1.0';
+} else if (sensorType === 'Aster') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '4';
+if (regAddrInput) regAddrInput.value = '6';
+if (scaleInput) scaleInput.value = '0.01';
+} else if (sensorType === 'Hardness_Sensor') {
+const quantityInput = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+const regAddrInput = document.querySelector('input[name="sensor_' + sensorId + '_register_address"]');
+const scaleInput = document.querySelector('input[name="sensor_' + sensorId + '_scale_factor"]');
+if (quantityInput) quantityInput.value = '6';
+if (regAddrInput) regAddrInput.value = '230';
+if (scaleInput) scaleInput.value = '1.0';
+}
+}
+function showDataTypeInfo(selectElement, sensorId) {
+const infoDiv = document.getElementById('datatype-info-' + sensorId);
+const dataType = selectElement.value;
+let infoHtml = '';
+if(dataType.startsWith('UINT16')) {
+const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';
+infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Unsigned</strong><br>- Range: 0 to 65,535<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Counters, status flags, small measurements<br>- Registers: 1';
+} else if(dataType.startsWith('INT16')) {
+const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';
+infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Signed</strong><br>- Range: -32,768 to 32,767<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Temperature, pressure differences, signed measurements<br>- Registers: 1';
+} else if(dataType.startsWith('UINT32')) {
+const order = dataType.split('_')[1];
+let orderDesc = '';
+switch(order) {
+case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;
+case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;
+case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;
+case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;
+}
+infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: 0 to 4,294,967,295<br>- Byte Order: ' + order + '<br>- Uses: Large counters, totalizers, flow accumulators<br>- Registers: 2';
+} else if(dataType.startsWith('INT32')) {
+const order = dataType.split('_')[1];
+let orderDesc = '';
+switch(order) {
+case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;
+case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;
+case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;
+case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;
+}
+infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: -2,147,483,648 to 2,147,483,647<br>- Byte Order: ' + order + '<br>- Uses: Large signed measurements, differences<br>- Registers: 2';
+} else if(dataType.startsWith('FLOAT32')) {
+const order = dataType.split('_')[1];
+let orderDesc = '';
+switch(order) {
+case 'ABCD': orderDesc = 'Big Endian IEEE 754'; break;
+case 'DCBA': orderDesc = 'Little Endian IEEE 754'; break;
+case 'BADC': orderDesc = 'Mid-Big Endian IEEE 754'; break;
+case 'CDAB': orderDesc = 'Mid-Little Endian IEEE 754'; break;
+}
+infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: +/-3.4E+/-38 (7 decimal digits)<br>- Byte Order: ' + order + '<br>- Uses: Precise measurements, flow rates, calculated values<br>- Registers: 2';
+}
+infoDiv.innerHTML = infoHtml;
+infoDiv.style.display = 'block';
+const quantityField = document.querySelector('input[name="sensor_' + sensorId + '_quantity"]');
+if (quantityField) {
+if (dataType.startsWith('UINT16') || dataType.startsWith('INT16')) {
+quantityField.value = '1';
+} else if (dataType.startsWith('UINT32') || dataType.startsWith('INT32') || dataType.startsWith('FLOAT32')) {
+quantityField.value = '2';
+}
+}
+}
+function showEditDataTypeInfo(selectElement, sensorId) {
+const infoDiv = document.getElementById('edit-datatype-info-' + sensorId);
+const dataType = selectElement.value;
+let infoHtml = '';
+if(dataType.startsWith('UINT16')) {
+const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';
+infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Unsigned</strong><br>- Range: 0 to 65,535<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Counters, status flags, small measurements<br>- Registers: 1';
+} else if(dataType.startsWith('INT16')) {
+const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';
+infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Signed</strong><br>- Range: -32,768 to 32,767<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Temperature, pressure differences, signed measurements<br>- Registers: 1';
+} else if(dataType.startsWith('UINT32')) {
+const order = dataType.split('_')[1];
+let orderDesc = '';
+switch(order) {
+case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;
+case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;
+case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;
+case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;
+}
+infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: 0 to 4,294,967,295<br>- Byte Order: ' + order + '<br>- Uses: Large counters, totalizers, flow accumulators<br>- Registers: 2';
+} else if(dataType.startsWith('INT32')) {
+const order = dataType.split('_')[1];
+let orderDesc = '';
+switch(order) {
+case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;
+case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;
+case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;
+case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;
+}
+infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: -2,147,483,648 to 2,147,483,647<br>- Byte Order: ' + order + '<br>- Uses: Large signed measurements, differences<br>- Registers: 2';
+} else if(dataType.startsWith('FLOAT32')) {
+const order = dataType.split('_')[1];
+let orderDesc = '';
+switch(order) {
+case 'ABCD': orderDesc = 'Big Endian IEEE 754'; break;
+case 'DCBA': orderDesc = 'Little Endian IEEE 754'; break;
+case 'BADC': orderDesc = 'Mid-Big Endian IEEE 754'; break;
+case 'CDAB': orderDesc = 'Mid-Little Endian IEEE 754'; break;
+}
+infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: +/-3.4E+/-38 (7 decimal digits)<br>- Byte Order: ' + order + '<br>- Uses: Precise measurements, flow rates, calculated values<br>- Registers: 2';
+}
+infoDiv.innerHTML = infoHtml;
+infoDiv.style.display = 'block';
+const quantityField = document.getElementById('edit_quantity_' + sensorId);
+if (quantityField) {
+if (dataType.startsWith('UINT16') || dataType.startsWith('INT16')) {
+quantityField.value = '1';
+} else if (dataType.startsWith('UINT32') || dataType.startsWith('INT32') || dataType.startsWith('FLOAT32')) {
+quantityField.value = '2';
+}
+}
+}
+function saveSingleSensor(sensorId) {
+console.log('Saving sensor:', sensorId);
+const nameField = document.querySelector('input[name="sensor_' + sensorId + '_name"]');
+const unitIdField = document.querySelector('input[name="sensor_' + sensorId + '_unit_id"]');
+console.log('Name field:', nameField, 'Value:', nameField ? nameField.value : 'NOT FOUND');
+console.log('Unit ID field:', unitIdField, 'Value:', unitIdField ? unitIdField.value : 'NOT FOUND');
+if (!nameField || !unitIdField) {
+alert('ERROR: Cannot find sensor form fields. Please try adding the sensor again.');
+return;
+}
+const name = nameField.value.trim();
+const unitId = unitIdField.value.trim();
+if (!name || !unitId) {
+alert('ERROR: Please fill in required fields:\n\n- Sensor Name: "' + name + '"\n- Unit ID: "' + unitId + '"\n\nBoth fields must have values.');
+return;
+}
+console.log('Building form data for sensor:', sensorId);
+const formData = new URLSearchParams();
+const sensorFields = document.querySelectorAll('input[name^="sensor_' + sensorId + '_"], select[name^="sensor_' + sensorId + '_"]');
+console.log('Found', sensorFields.length, 'sensor fields');
+sensorFields.forEach(field => {
+console.log('Adding field:', field.name, '=', field.value);
+formData.append(field.name, field.value);
+});
+console.log('Form data:', formData.toString());
+fetch('/save_single_sensor', {method: 'POST', headers: {'Content-Type': 'application/x-www-form-urlencoded'}, body: formData})
+.then(response => response.json()).then(data => {
+console.log('Save response:', data);
+if(data.status === 'success') {
+alert('SUCCESS: Sensor saved successfully!\n\nSensor: ' + data.sensor_name + '\nUnit ID: ' + data.unit_id + '\n\nYou can now test this sensor using the Test RS485 button.');
+sessionStorage.setItem('showSection', 'sensors');
+window.location.reload();
+} else {
+alert('ERROR: Failed to save sensor:\n\n' + data.message);
+}
+}).catch(e => {
+console.error('Save error:', e);
+alert('ERROR: Save failed: ' + e.message);
+});
+}
+function removeSensorForm(sensorId){
+if(confirm('Remove this sensor form?\n\nThis will only remove the form - no saved sensors will be deleted.')) {
+const sensorCard=document.getElementById('sensor-card-'+sensorId);
+if(sensorCard){sensorCard.remove();}
+}}
+function togglePassword(){
+const input=document.getElementById('wifi_password');
+const toggle=event.target;
+if(input.type==='password'){input.type='text';toggle.textContent='HIDE';}else{input.type='password';toggle.textContent='SHOW';}
+}
+let simTestPollInterval=null;
+function testSIMConnection(){
+const result=document.getElementById('sim_test_result');
+result.innerHTML='<div style="text-align:center">⏳ Starting SIM test...<br><small>Please wait</small></div>';
+result.style.display='block';
+result.style.backgroundColor='#fff3cd';
+result.style.color='#856404';
+fetch('/api/sim_test',{method:'POST'})
+.then(r=>r.json())
+.then(data=>{
+if(data.status==='started'){
+result.innerHTML='<div style="text-align:center">⏳ Testing SIM connection...<br><small>Initializing modem and connecting to network (this may take up to 30 seconds)</small></div>';
+if(simTestPollInterval) clearInterval(simTestPollInterval);
+simTestPollInterval=setInterval(checkSIMTestStatus,2000);
+}else{
+result.innerHTML='<span style="color:#721c24">❌ Failed to start test: '+data.message+'</span>';
+result.style.backgroundColor='#f8d7da';
+}
+})
+.catch(err=>{
+result.innerHTML='<span style="color:#721c24">❌ Test failed: '+err+'</span>';
+result.style.backgroundColor='#f8d7da';
+});
+}
+function checkSIMTestStatus(){
+fetch('/api/sim_test_status')
+.then(r=>r.json())
+.then(data=>{
+const result=document.getElementById('sim_test_result');
+if(data.status==='in_progress'){
+return;
+}
+if(simTestPollInterval){
+clearInterval(simTestPollInterval);
+simTestPollInterval=null;
+}
+if(data.status==='completed'){
+if(data.success){
+let msg='<div style="color:#155724"><strong>✅ SIM Module Connected Successfully!</strong><br>';
+msg+='<div style="margin-top:10px;font-size:14px;line-height:1.6">';
+msg+='<strong>📡 IP Address:</strong> <span style="background:#e7f3ff;padding:2px 8px;border-radius:3px;font-family:monospace">'+data.ip+'</span><br>';
+msg+='<strong>📶 Signal:</strong> '+data.signal+' dBm ('+data.signal_quality+')<br>';
+msg+='<strong>📱 Operator:</strong> '+data.operator+'<br>';
+msg+='<strong>🌐 APN:</strong> '+data.apn+'<br>';
+msg+='</div>';
+msg+='<div style="margin-top:10px;padding:10px;background:#d1ecf1;border-left:4px solid #17a2b8;border-radius:4px;color:#0c5460">';
+msg+='✓ Modem is working correctly<br>';
+msg+='✓ Network registration successful<br>';
+msg+='✓ Internet connectivity established';
+msg+='</div></div>';
+result.innerHTML=msg;
+result.style.backgroundColor='#d4edda';
+result.style.color='#155724';
+}else{
+let msg='<div style="color:#721c24"><strong>❌ SIM Connection Failed</strong><br>';
+msg+='<div style="margin-top:8px;font-size:14px">'+data.error+'</div>';
+if(data.signal){
+msg+='<div style="margin-top:10px;padding:8px;background:#fff3cd;border-radius:4px;color:#856404">';
+msg+='📶 Signal: '+data.signal+' dBm';
+if(data.operator){msg+=' | Operator: '+data.operator;}
+msg+='</div>';
+}
+msg+='</div>';
+result.innerHTML=msg;
+result.style.backgroundColor='#f8d7da';
+result.style.color='#721c24';
+}
+}
+})
+.catch(err=>console.error('Poll error:',err));
+}
+function checkSDStatus(){
+const result=document.getElementById('sd_status_result');
+result.innerHTML='Checking SD card...';
+result.style.display='block';
+result.style.backgroundColor='#fff3cd';
+fetch('/api/sd_status')
+.then(r=>r.json())
+.then(data=>{
+if(data.mounted){
+result.innerHTML='<span style="color:#155724">SD Card: '+data.size_mb+' MB total, '+data.free_mb+' MB free, '+data.cached_messages+' messages cached</span>';
+result.style.backgroundColor='#d4edda';
+}else{
+result.innerHTML='<span style="color:#721c24">SD Card not mounted</span>';
+result.style.backgroundColor='#f8d7da';
+}
+})
+.catch(err=>{
+result.innerHTML='<span style="color:#721c24">Failed to check SD: '+err+'</span>';
+result.style.backgroundColor='#f8d7da';
+});
+}
+function replayCachedMessages(){
+if(!confirm('Replay all cached messages now?'))return;
+fetch('/api/sd_replay',{method:'POST'})
+.then(r=>r.json())
+.then(data=>{
+if(data.success){
+alert('Replayed '+data.count+' messages successfully');
+}else{
+alert('Replay failed: '+data.error);
+}
+})
+.catch(err=>{alert('Replay failed: '+err);});
+}
+function clearCachedMessages(){
+if(!confirm('Clear all cached messages? This cannot be undone!'))return;
+fetch('/api/sd_clear',{method:'POST'})
+.then(r=>r.json())
+.then(data=>{
+if(data.success){
+alert('Cleared '+data.count+' cached messages');
+}else{
+alert('Clear failed: '+data.error);
+}
+})
+.catch(err=>{alert('Clear failed: '+err);});
+}
+function getRTCTime(){
+const result=document.getElementById('rtc_time_result');
+result.innerHTML='Reading RTC...';
+result.style.display='block';
+result.style.backgroundColor='#fff3cd';
+fetch('/api/rtc_time')
+.then(r=>r.json())
+.then(data=>{
+if(data.success){
+result.innerHTML='<span style="color:#155724">RTC Time: '+data.time+', Temperature: '+data.temp+'C</span>';
+result.style.backgroundColor='#d4edda';
+}else{
+result.innerHTML='<span style="color:#721c24">RTC not available</span>';
+result.style.backgroundColor='#f8d7da';
+}
+})
+.catch(err=>{
+result.innerHTML='<span style="color:#721c24">Failed to read RTC: '+err+'</span>';
+result.style.backgroundColor='#f8d7da';
+});
+}
+function syncRTCFromNTP(){
+if(!confirm('Sync RTC from NTP now? Requires internet connection.'))return;
+fetch('/api/rtc_sync',{method:'POST'})
+.then(r=>r.json())
+.then(data=>{
+if(data.success){
+alert('RTC synced successfully from NTP');
+}else{
+alert('RTC sync failed: '+data.error);
+}
+})
+.catch(err=>{alert('RTC sync failed: '+err);});
+}
+function syncSystemFromRTC(){
+if(!confirm('Sync system time from RTC now?'))return;
+fetch('/api/rtc_set',{method:'POST'})
+.then(r=>r.json())
+.then(data=>{
+if(data.success){
+alert('System time synced from RTC');
+}else{
+alert('Sync failed: '+data.error);
+}
+})
+.catch(err=>{alert('Sync failed: '+err);});
+}
+function saveNetworkMode(e){
+e.preventDefault();
+const formData=new URLSearchParams(new FormData(e.target));
+const resultDiv=document.getElementById('network_mode_result');
+resultDiv.innerHTML='<span style="color:#856404">Saving network mode...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+fetch('/save_network_mode',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json())
+.then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+setTimeout(()=>{
+resultDiv.style.display='none';
+},3000);
+}else{
+resultDiv.innerHTML='<span style="color:#721c24">❌ Failed to save: '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+}
+})
+.catch(err=>{
+resultDiv.innerHTML='<span style="color:#721c24">❌ Error: '+err+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+});
+return false;
+}
+function saveSDConfig(){
+const formData=new URLSearchParams();
+if(document.getElementById('sd_enabled').checked) formData.append('sd_enabled','1');
+if(document.getElementById('sd_cache_on_failure').checked) formData.append('sd_cache_on_failure','1');
+formData.append('sd_mosi',document.getElementById('sd_mosi').value);
+formData.append('sd_miso',document.getElementById('sd_miso').value);
+formData.append('sd_clk',document.getElementById('sd_clk').value);
+formData.append('sd_cs',document.getElementById('sd_cs').value);
+formData.append('sd_spi_host',document.getElementById('sd_spi_host').value);
+const resultDiv=document.getElementById('sd_save_result');
+resultDiv.innerHTML='<span style="color:#856404">Saving SD Card configuration...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+fetch('/save_sd_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json())
+.then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Error: '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+}
+})
+.catch(e=>{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Network Error: '+e.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+});
+return false;
+}
+function saveRTCConfig(){
+const formData=new URLSearchParams();
+if(document.getElementById('rtc_enabled').checked) formData.append('rtc_enabled','1');
+if(document.getElementById('rtc_sync_on_boot').checked) formData.append('rtc_sync_on_boot','1');
+if(document.getElementById('rtc_update_from_ntp').checked) formData.append('rtc_update_from_ntp','1');
+formData.append('rtc_sda',document.getElementById('rtc_sda').value);
+formData.append('rtc_scl',document.getElementById('rtc_scl').value);
+formData.append('rtc_i2c_num',document.getElementById('rtc_i2c_num').value);
+const resultDiv=document.getElementById('rtc_save_result');
+resultDiv.innerHTML='<span style="color:#856404">Saving RTC configuration...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+fetch('/save_rtc_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json())
+.then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Error: '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+}
+})
+.catch(e=>{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Network Error: '+e.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+});
+return false;
+}
+function saveWiFiConfig(){
+const ssid=document.getElementById('wifi_ssid').value;
+const password=document.getElementById('wifi_password').value;
+if(!ssid){alert('Please enter a WiFi network name');return false;}
+const formData=new URLSearchParams();
+formData.append('wifi_ssid',ssid);
+formData.append('wifi_password',password);
+const resultDiv=document.getElementById('wifi_save_result');
+const saveBtn=document.getElementById('wifi_save_btn');
+saveBtn.disabled=true;
+saveBtn.textContent='Connecting...';
+resultDiv.innerHTML='<span style="color:#856404">📡 Saving and connecting to WiFi...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+fetch('/save_wifi_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json())
+.then(data=>{
+saveBtn.disabled=false;
+saveBtn.textContent='Save & Connect';
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else if(data.status==='connecting'){
+resultDiv.innerHTML='<span style="color:#17a2b8">📶 '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d1ecf1';
+resultDiv.style.borderColor='#bee5eb';
+resultDiv.style.color='#0c5460';
+let wifiPoll=0;
+const wifiTimer=setInterval(function(){
+wifiPoll++;
+fetch('/api/system_status').then(r=>r.json()).then(s=>{
+if(s.wifi&&s.wifi.status==='connected'){
+clearInterval(wifiTimer);
+resultDiv.innerHTML='<span style="color:#28a745">✅ Connected to '+s.wifi.ssid+' ('+s.wifi.rssi+' dBm)</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else if(wifiPoll>=15){
+clearInterval(wifiTimer);
+resultDiv.innerHTML='<span style="color:#856404">⚠️ Saved. Refresh page to verify connection.</span>';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+}
+}).catch(()=>{});
+},2000);
+}else{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+}
+})
+.catch(e=>{
+saveBtn.disabled=false;
+saveBtn.textContent='Save & Connect';
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Network Error: '+e.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+});
+return false;
+}
+function saveSIMConfig(){
+const formData=new URLSearchParams();
+formData.append('sim_apn',document.getElementById('sim_apn').value);
+formData.append('sim_apn_user',document.getElementById('sim_apn_user').value);
+formData.append('sim_apn_pass',document.getElementById('sim_apn_pass').value);
+formData.append('sim_uart',document.getElementById('sim_uart').value);
+formData.append('sim_tx_pin',document.getElementById('sim_tx_pin').value);
+formData.append('sim_rx_pin',document.getElementById('sim_rx_pin').value);
+formData.append('sim_pwr_pin',document.getElementById('sim_pwr_pin').value);
+formData.append('sim_reset_pin',document.getElementById('sim_reset_pin').value);
+formData.append('sim_baud',document.getElementById('sim_baud').value);
+formData.append('sim_rts_pin',document.getElementById('sim_rts_pin').value);
+formData.append('sim_cts_pin',document.getElementById('sim_cts_pin').value);
+formData.append('sim_ppp_baud',document.getElementById('sim_ppp_baud').value);
+const resultDiv=document.getElementById('sim_save_result');
+resultDiv.innerHTML='<span style="color:#856404">Saving SIM configuration...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+fetch('/save_sim_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json())
+.then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Error: '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+}
+})
+.catch(e=>{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Network Error: '+e.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+});
+return false;
+}
+function saveAzureConfig(){
+const password=prompt('Save Azure Configuration\n\nThis will update sensitive Azure IoT Hub settings.\nPlease enter the admin password to confirm:');
+if(password===null) return;
+if(password!=='admin123'){
+alert('Access Denied\n\nIncorrect password. Cannot save Azure configuration.\n\nContact your system administrator if you need access.');
+return;}
+const deviceId=document.querySelector('input[name="azure_device_id"]').value;
+const deviceKey=document.getElementById('azure_device_key').value;
+const telemetryInterval=document.querySelector('input[name="telemetry_interval"]').value;
+const batchTelemetry=document.querySelector('input[name="batch_telemetry"]').checked?'1':'0';
+const telemetryEncoding=document.querySelector('select[name="telemetry_encoding"]').value;
+const telemetryMaxBatch=document.querySelector('input[name="telemetry_max_batch"]').value;
+const telemetryRouteByType=document.querySelector('input[name="telemetry_route_by_type"]').checked?'1':'0';
+const modbusRetryCount=document.querySelector('select[name="modbus_retry_count"]').value;
+const modbusRetryDelay=document.querySelector('input[name="modbus_retry_delay"]').value;
+if(!deviceId){alert('ERROR: Please enter the Azure device ID');return;}
+if(!deviceKey){alert('ERROR: Please enter the Azure device key');return;}
+const formData='azure_device_id='+encodeURIComponent(deviceId)+'&azure_device_key='+encodeURIComponent(deviceKey)+'&telemetry_interval='+telemetryInterval+'&batch_telemetry='+batchTelemetry+'&telemetry_encoding='+telemetryEncoding+'&telemetry_max_batch='+telemetryMaxBatch+'&telemetry_route_by_type='+telemetryRouteByType+'&modbus_retry_count='+modbusRetryCount+'&modbus_retry_delay='+modbusRetryDelay;
+fetch('/save_azure_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'){alert('SUCCESS: Azure configuration saved successfully!\n\nDevice ID, device key, and telemetry interval updated.');}else{alert('ERROR: '+data.message);}
+}).catch(e=>{alert('ERROR: Save failed: '+e.message);});
+}
+function saveModemConfig(){
+console.log('saveModemConfig function called');
+const formData=new URLSearchParams();
+const modemEnabled=document.getElementById('modem_reset_enabled').checked;
+const gpioPin=document.getElementById('modem_reset_gpio_pin').value;
+const bootDelay=document.getElementById('modem_boot_delay').value;
+if(gpioPin<2||gpioPin>39||(gpioPin>=6&&gpioPin<=11)){
+alert('ERROR: Invalid GPIO pin. Please use pins 2-39, excluding 6-11 which are reserved.');return false;
+}
+if(bootDelay<5||bootDelay>60){
+alert('ERROR: Boot delay must be between 5 and 60 seconds.');return false;
+}
+if(modemEnabled) formData.append('modem_reset_enabled','1');
+formData.append('modem_reset_gpio_pin',gpioPin);
+formData.append('modem_boot_delay',bootDelay);
+const resultDiv=document.getElementById('modem-result');
+resultDiv.innerHTML='<span style="color:#856404">Saving modem configuration...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+fetch('/save_modem_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Error: '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+}
+}).catch(e=>{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Network Error: '+e.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+});return false;
+}
+function saveSystemConfig(){
+const triggerPin=document.getElementById('trigger_gpio_pin').value;
+if(triggerPin<0||triggerPin>39){
+alert('ERROR: Invalid GPIO pin. Use pins 0-39.');return false;
+}
+const formData=new URLSearchParams();
+formData.append('trigger_gpio_pin',triggerPin);
+const resultDiv=document.getElementById('system-control-result');
+resultDiv.innerHTML='<span style="color:#856404">Saving system settings...</span>';
+resultDiv.style.display='block';
+resultDiv.style.backgroundColor='#fff3cd';
+resultDiv.style.borderColor='#ffeaa7';
+resultDiv.style.color='#856404';
+fetch('/save_system_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<span style="color:#28a745">✅ '+data.message+'</span>';
+resultDiv.style.backgroundColor='#d4edda';
+resultDiv.style.borderColor='#c3e6cb';
+resultDiv.style.color='#155724';
+}else{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Error: '+data.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+}
+}).catch(e=>{
+resultDiv.innerHTML='<span style="color:#dc3545">❌ Communication Error: '+e.message+'</span>';
+resultDiv.style.backgroundColor='#f8d7da';
+resultDiv.style.borderColor='#f5c6cb';
+resultDiv.style.color='#721c24';
+});return false;
+}
+let scanInProgress = false;
+function scanWiFi(){
+const statusDiv=document.getElementById('scan-status');
+const networksDiv=document.getElementById('networks');
+const scanBtn=document.querySelector('.scan-button');
+if (!statusDiv || !networksDiv) {
+console.error('Required elements not found for WiFi scan');
+return;
+}
+if (scanInProgress) {
+statusDiv.innerHTML='<span style="color:#ffc107">Scan already in progress. Please wait...</span>';
+return;
+}
+scanInProgress = true;
+if (scanBtn) {
+scanBtn.style.opacity='0.6';
+scanBtn.style.pointerEvents='none';
+}
+statusDiv.innerHTML='<span style="color:#17a2b8">Scanning for networks...</span>';
+networksDiv.style.display='none';
+console.log('Starting WiFi scan...');
+fetch('/scan_wifi').then(r=>{
+console.log('Received response:', r.status, r.statusText);
+if (!r.ok) {
+throw new Error('HTTP ' + r.status + ': ' + r.statusText);
+}
+return r.text();
+}).then(text=>{
+console.log('Response text:', text);
+let data;
+try {
+data = JSON.parse(text);
+} catch (e) {
+console.error('JSON parse error:', e, 'Text:', text);
+throw new Error('Invalid server response');
+}
+console.log('Parsed data:', data);
+if(data.error){
+statusDiv.innerHTML='<span style="color:#dc3545">Error: '+data.error+'</span>';
+return;
+}
+const count = data.count || 0;
+statusDiv.innerHTML='<span style="color:#28a745">'+count+' networks found</span>';
+networksDiv.innerHTML='';
+if(!data.networks || data.networks.length===0){
+networksDiv.innerHTML='<div style="padding:20px;text-align:center;color:#666;background:white;border-radius:6px;margin:8px"><i>No networks found</i><br><small>Try scanning again</small></div>';
+networksDiv.style.display='block';
+return;
+}
+data.networks.sort((a,b)=>b.rssi-a.rssi);
+const maxHeight=count>15?'400px':count>10?'300px':count>5?'200px':'180px';
+networksDiv.style.maxHeight=maxHeight;
+networksDiv.style.overflowY='auto';
+networksDiv.style.padding='10px';
+data.networks.forEach((n,i)=>{
+const item=document.createElement('div');
+const signalColor=n.rssi>-50?'#28a745':n.rssi>-70?'#ffc107':'#dc3545';
+item.className='network-item';
+item.style.cssText='padding:12px;cursor:pointer;border-radius:6px;margin:4px 0;background:white;border:1px solid #e0e0e0;transition:all 0.2s ease';
+item.innerHTML='<div style="display:flex;justify-content:space-between;align-items:center"><div><div style="display:flex;align-items:center;gap:8px"><strong style="color:#2c3e50">'+n.ssid+'</strong>'+n.security_icon+'</div><small style="color:#666;margin-top:2px;display:block">Channel '+n.channel+' * '+n.signal_strength+'</small></div><div style="text-align:right"><div style="color:'+signalColor+';font-weight:bold;font-size:13px">'+n.rssi+'dBm</div><small style="color:#888">'+n.signal_icon+'</small></div></div>';
+item.onmouseover=()=>{item.style.background='#e3f2fd';item.style.borderColor='#2196f3'};
+item.onmouseout=()=>{item.style.background='white';item.style.borderColor='#e0e0e0'};
+item.onclick=()=>{
+document.getElementById('wifi_ssid').value=n.ssid;
+networksDiv.style.display='none';
+statusDiv.innerHTML='<span style="color:#17a2b8">Selected: <strong>'+n.ssid+'</strong> ('+n.signal_strength+')</span>';
+document.getElementById('wifi_ssid').focus();
+};
+networksDiv.appendChild(item);
+});
+networksDiv.style.display='block';
+}).catch(e=>{
+console.error('Scan error:', e);
+statusDiv.innerHTML='<span style="color:#dc3545">Scan failed: '+e.message+'</span>';
+}).finally(()=>{
+scanInProgress = false;
+if (scanBtn) {
+scanBtn.style.opacity='1';
+scanBtn.style.pointerEvents='auto';
+}
+console.log('Scan completed');
+});
+}
+function rebootSystem(){
+if(confirm('Are you sure you want to reboot the system? This will restart the device and it may take a few minutes to come back online.')){
+fetch('/reboot',{method:'POST',headers:{'Content-Type':'application/json'}})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'){
+alert('System is rebooting. Please wait a few minutes and refresh the page.');
+}else{
+alert('Reboot failed: '+data.message);
+}
+}).catch(e=>{
+alert('Reboot request sent. Please wait a few minutes and refresh the page.');
+});
+}
+}
+function testSensor(sensorId){
+const resultDiv=document.getElementById('test-result-'+sensorId);
+resultDiv.innerHTML='<div style="background:#e3f2fd;padding:8px;border-radius:4px;margin:5px 0">Testing RS485 Modbus communication...</div>';
+resultDiv.style.display='block';
+fetch('/test_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'sensor_id='+sensorId})
+.then(r=>r.text()).then(htmlData=>{
+resultDiv.innerHTML=htmlData;
+}).catch(e=>{
+resultDiv.innerHTML='<div style="background:#ffebee;padding:8px;border-radius:4px;color:red;margin:5px 0">Communication Error: '+e.message+'</div>';
+});}
+const sensorData=[
+];
+window.addEventListener('load', function() {
+setTimeout(() => {
+for(let i = 0; i < sensorData.length; i++) {
+const sensorCard = document.getElementById('sensor-card-' + i);
+if(sensorCard) {
+const dataType = sensorData[i].data_type;
+console.log('Sensor', i, 'data type:', dataType);
+}
+}
+}, 500);
+});
+function editSensor(sensorId){
+if(confirm('Edit Sensor '+(sensorId+1)+'? This will show an edit form.')){
+const sensor=sensorData[sensorId];
+if(!sensor){alert('Sensor data not found');return;}
+var editForm='<div class="sensor-card" style="border:2px solid #007bff;background:#f0f8ff">';
+editForm+='<h3 style="color:#007bff">Editing Sensor '+(sensorId+1)+' - <span style="color:#28a745;font-weight:bold;">'+(sensor.sensor_type||'Flow-Meter')+'</span></h3>';
+editForm+='<div class="form-grid">';
+editForm+='<label>Name:</label><input id="edit_name_'+sensorId+'" value="'+sensor.name+'">';
+editForm+='<label>Unit ID:</label><input id="edit_unit_'+sensorId+'" value="'+sensor.unit_id+'">';
+if (sensor.sensor_type !== 'QUALITY') {
+editForm+='<label>Slave ID:</label><input type="number" id="edit_slave_'+sensorId+'" value="'+sensor.slave_id+'" min="1" max="247">';
+editForm+='<label>Register:</label><input type="number" id="edit_register_'+sensorId+'" value="'+sensor.register_address+'">';
+editForm+='<label>Quantity:</label><input type="number" id="edit_quantity_'+sensorId+'" value="'+sensor.quantity+'" min="1" max="125">';
+editForm+='<label>Register Type:</label><select id="edit_register_type_'+sensorId+'">';
+editForm+='<option value="HOLDING" '+(sensor.register_type==='HOLDING'?'selected':'')+'>Holding Registers (03) - Read/Write</option>';
+editForm+='<option value="INPUT" '+(sensor.register_type==='INPUT'?'selected':'')+'>Input Registers (04) - Read Only</option>';
+editForm+='<option value="COILS" '+(sensor.register_type==='COILS'?'selected':'')+'>Coils (01) - Single Bit Read/Write</option>';
+editForm+='<option value="DISCRETE" '+(sensor.register_type==='DISCRETE'?'selected':'')+'>Discrete Inputs (02) - Single Bit Read Only</option>';
+editForm+='</select>';
+}
+if (sensor.sensor_type === 'ZEST') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - INT32_BE + INT32_LE_SWAP</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="ZEST_FIXED">';
+} else if (sensor.sensor_type === 'Panda_USM') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - FLOAT64_12345678 (Big-Endian Double)</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="FLOAT64_12345678">';
+} else if (sensor.sensor_type === 'Clampon') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - INT32 + FLOAT32 (word-swapped)</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="CLAMPON_FIXED">';
+} else if (sensor.sensor_type === 'Dailian') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - UINT32_3412 (CDAB)</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="UINT32_3412">';
+} else if (sensor.sensor_type === 'Dailian_EMF') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - UINT32 word-swapped</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="DAILIAN_EMF_FIXED">';
+} else if (sensor.sensor_type === 'Panda_EMF') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - INT32_BE + FLOAT32_BE</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="PANDA_EMF_FIXED">';
+} else if (sensor.sensor_type === 'Panda_Level') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - UINT16 (Level %)</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="PANDA_LEVEL_FIXED">';
+} else if (sensor.sensor_type === 'Piezometer') {
+editForm+='<label>Data Type:</label><div style="padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold">Fixed - UINT16_HI (16-bit)</div><input type="hidden" id="edit_datatype_'+sensorId+'" value="UINT16_HI">';
+} else {
+var mappedDataType = sensor.data_type || '';
+console.log('Edit form - Original data_type:', sensor.data_type, 'length:', sensor.data_type ? sensor.data_type.length : 0);
+if (sensor.data_type === '' || sensor.data_type === null || sensor.data_type === undefined) {
+  mappedDataType = 'UINT16_HI';
+} else if (sensor.data_type === 'FLOAT32_AB') mappedDataType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_43') mappedDataType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_ABCD') mappedDataType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_1234') mappedDataType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_DCBA') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_4321') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_432') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_BADC') mappedDataType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_2143') mappedDataType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_214') mappedDataType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_CDAB') mappedDataType = 'FLOAT32_3412';
+else if (sensor.data_type === 'FLOAT32_3412') mappedDataType = 'FLOAT32_3412';
+else if (sensor.data_type === 'FLOAT32_341') mappedDataType = 'FLOAT32_3412';
+else if (sensor.data_type === 'UINT32_AB') mappedDataType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_ABCD') mappedDataType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_1234') mappedDataType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_DCBA') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_432') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_4321') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_BADC') mappedDataType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_2143') mappedDataType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_CDAB') mappedDataType = 'UINT32_3412';
+else if (sensor.data_type === 'UINT32_3412') mappedDataType = 'UINT32_3412';
+else if (sensor.data_type === 'INT32_AB') mappedDataType = 'INT32_1234';
+else if (sensor.data_type === 'INT32_ABCD') mappedDataType = 'INT32_1234';
+else if (sensor.data_type === 'INT32_1234') mappedDataType = 'INT32_1234';
+else if (sensor.data_type === 'INT32_DCBA') mappedDataType = 'INT32_4321';
+else if (sensor.data_type === 'INT32_432') mappedDataType = 'INT32_4321';
+else if (sensor.data_type === 'INT32_4321') mappedDataType = 'INT32_4321';
+else if (sensor.data_type === 'UINT16') mappedDataType = 'UINT16_HI';
+else if (sensor.data_type === 'UINT16_BE') mappedDataType = 'UINT16_HI';
+else if (sensor.data_type === 'UINT16_HI') mappedDataType = 'UINT16_HI';
+else if (sensor.data_type === 'UINT16_LE') mappedDataType = 'UINT16_LO';
+else if (sensor.data_type === 'UINT16_LO') mappedDataType = 'UINT16_LO';
+else if (sensor.data_type === 'INT16') mappedDataType = 'INT16_HI';
+else if (sensor.data_type === 'INT16_BE') mappedDataType = 'INT16_HI';
+else if (sensor.data_type === 'INT16_HI') mappedDataType = 'INT16_HI';
+else if (sensor.data_type === 'INT16_LE') mappedDataType = 'INT16_LO';
+else if (sensor.data_type === 'INT16_LO') mappedDataType = 'INT16_LO';
+else if (sensor.data_type === 'INT32_BADC') mappedDataType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_2143') mappedDataType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_214') mappedDataType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_CDAB') mappedDataType = 'INT32_3412';
+else if (sensor.data_type === 'INT32_3412') mappedDataType = 'INT32_3412';
+else if (sensor.data_type === 'INT32_341') mappedDataType = 'INT32_3412';
+else if (sensor.data_type === 'UINT32_DCB') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'INT32_DCB') mappedDataType = 'INT32_4321';
+else if (sensor.data_type === 'FLOAT32_DCB') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'UINT32') mappedDataType = 'UINT32_1234';
+else if (sensor.data_type === 'INT32') mappedDataType = 'INT32_1234';
+else if (sensor.data_type === 'UINT32_CDA') mappedDataType = 'UINT32_3412';
+else if (sensor.data_type === 'UINT32_BAD') mappedDataType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_DCA') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'FLOAT32_DC') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_CDA') mappedDataType = 'FLOAT32_3412';
+else if (sensor.data_type === 'FLOAT32_BAD') mappedDataType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_DCA') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'UINT16_SWAP') mappedDataType = 'UINT16_LO';
+else if (sensor.data_type === 'INT16_SWAP') mappedDataType = 'INT16_LO';
+else if (sensor.data_type === 'UINT32_SWAP') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_1234') mappedDataType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_4321') mappedDataType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_2143') mappedDataType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_3412') mappedDataType = 'UINT32_3412';
+else if (sensor.data_type === 'INT32_SWAP') mappedDataType = 'INT32_4321';
+else if (sensor.data_type === 'INT32_1234') mappedDataType = 'INT32_1234';
+else if (sensor.data_type === 'FLOAT32_SWAP') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32') mappedDataType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_1234') mappedDataType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_4321') mappedDataType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_2143') mappedDataType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_3412') mappedDataType = 'FLOAT32_3412';
+else if (sensor.data_type === 'INT8') mappedDataType = 'INT8';
+else if (sensor.data_type === 'UINT8') mappedDataType = 'UINT8';
+else if (sensor.data_type === 'BOOL') mappedDataType = 'BOOL';
+else if (sensor.data_type === 'ASCII') mappedDataType = 'ASCII';
+else if (sensor.data_type === 'HEX') mappedDataType = 'HEX';
+else if (sensor.data_type === 'PDU') mappedDataType = 'PDU';
+else if (sensor.data_type === 'INT64_12345678') mappedDataType = 'INT64_12345678';
+else if (sensor.data_type === 'INT64_87654321') mappedDataType = 'INT64_87654321';
+else if (sensor.data_type === 'INT64_21436587') mappedDataType = 'INT64_21436587';
+else if (sensor.data_type === 'INT64_78563412') mappedDataType = 'INT64_78563412';
+else if (sensor.data_type === 'UINT64_12345678') mappedDataType = 'UINT64_12345678';
+else if (sensor.data_type === 'UINT64_87654321') mappedDataType = 'UINT64_87654321';
+else if (sensor.data_type === 'UINT64_21436587') mappedDataType = 'UINT64_21436587';
+else if (sensor.data_type === 'UINT64_78563412') mappedDataType = 'UINT64_78563412';
+else if (sensor.data_type === 'FLOAT64_12345678') mappedDataType = 'FLOAT64_12345678';
+else if (sensor.data_type === 'FLOAT64_87654321') mappedDataType = 'FLOAT64_87654321';
+else if (sensor.data_type === 'FLOAT64_21436587') mappedDataType = 'FLOAT64_21436587';
+else if (sensor.data_type === 'FLOAT64_78563412') mappedDataType = 'FLOAT64_78563412';
+else if (sensor.data_type === 'FLOAT64') mappedDataType = 'FLOAT64_12345678';
+else if (sensor.data_type === 'INT64') mappedDataType = 'INT64_12345678';
+else if (sensor.data_type === 'UINT64') mappedDataType = 'UINT64_12345678';
+else if (sensor.data_type === 'INT64_BE') mappedDataType = 'INT64_12345678';
+else if (sensor.data_type === 'INT64_LE') mappedDataType = 'INT64_87654321';
+else if (sensor.data_type === 'UINT64_BE') mappedDataType = 'UINT64_12345678';
+else if (sensor.data_type === 'UINT64_LE') mappedDataType = 'UINT64_87654321';
+else if (sensor.data_type === 'FLOAT64_BE') mappedDataType = 'FLOAT64_12345678';
+else if (sensor.data_type === 'FLOAT64_LE') mappedDataType = 'FLOAT64_87654321';
+else {
+  console.warn('Edit form - UNMAPPED data_type:', sensor.data_type, '- using as-is');
+  mappedDataType = sensor.data_type || 'UINT16_HI';
+}
+console.log('Edit form - Mapped data_type:', mappedDataType);
+editForm+='<label>Data Type:</label><select id="edit_datatype_'+sensorId+'" style="width:280px">';
+editForm+='<option value="UINT16_HI" '+(mappedDataType===''||mappedDataType==='UINT16_HI'?'selected':'')+'>16-bit UINT, high byte first (Default)</option>';
+editForm+='<optgroup label="8-bit Formats (0.5 register)">';
+editForm+='<option value="INT8" '+(mappedDataType==='INT8'?'selected':'')+'>8-bit INT (-128 to 127)</option>';
+editForm+='<option value="UINT8" '+(mappedDataType==='UINT8'?'selected':'')+'>8-bit UINT (0 to 255)</option>';
+editForm+='</optgroup>';
+editForm+='<optgroup label="16-bit Formats (1 register)">';
+editForm+='<option value="INT16_HI" '+(mappedDataType==='INT16_HI'?'selected':'')+'>16-bit INT, high byte first</option>';
+editForm+='<option value="INT16_LO" '+(mappedDataType==='INT16_LO'?'selected':'')+'>16-bit INT, low byte first</option>';
+editForm+='<option value="UINT16_LO" '+(mappedDataType==='UINT16_LO'?'selected':'')+'>16-bit UINT, low byte first</option>';
+editForm+='</optgroup>';
+editForm+='<optgroup label="32-bit Float Formats (2 registers)">';
+var float32_1234_selected = (mappedDataType==='FLOAT32_1234');
+editForm+='<option value="FLOAT32_1234" '+(float32_1234_selected?'selected':'')+'>32-bit float, Byte order 1,2,3,4</option>';
+editForm+='<option value="FLOAT32_4321" '+(mappedDataType==='FLOAT32_4321'?'selected':'')+'>32-bit float, Byte order 4,3,2,1</option>';
+editForm+='<option value="FLOAT32_2143" '+(mappedDataType==='FLOAT32_2143'?'selected':'')+'>32-bit float, Byte order 2,1,4,3</option>';
+editForm+='<option value="FLOAT32_3412" '+(mappedDataType==='FLOAT32_3412'?'selected':'')+'>32-bit float, Byte order 3,4,1,2</option>';
+editForm+='</optgroup>';
+editForm+='<optgroup label="32-bit Integer Formats (2 registers)">';
+editForm+='<option value="INT32_1234" '+(mappedDataType==='INT32_1234'?'selected':'')+'>32-bit INT, Byte order 1,2,3,4</option>';
+editForm+='<option value="INT32_4321" '+(mappedDataType==='INT32_4321'?'selected':'')+'>32-bit INT, Byte order 4,3,2,1</option>';
+editForm+='<option value="INT32_2143" '+(mappedDataType==='INT32_2143'?'selected':'')+'>32-bit INT, Byte order 2,1,4,3</option>';
+editForm+='<option value="INT32_3412" '+(mappedDataType==='INT32_3412'?'selected':'')+'>32-bit INT, Byte order 3,4,1,2</option>';
+editForm+='<option value="UINT32_1234" '+(mappedDataType==='UINT32_1234'?'selected':'')+'>32-bit UINT, Byte order 1,2,3,4</option>';
+editForm+='<option value="UINT32_4321" '+(mappedDataType==='UINT32_4321'?'selected':'')+'>32-bit UINT, Byte order 4,3,2,1</option>';
+editForm+='<option value="UINT32_2143" '+(mappedDataType==='UINT32_2143'?'selected':'')+'>32-bit UINT, Byte order 2,1,4,3</option>';
+editForm+='<option value="UINT32_3412" '+(mappedDataType==='UINT32_3412'?'selected':'')+'>32-bit UINT, Byte order 3,4,1,2</option>';
+editForm+='</optgroup>';
+editForm+='<optgroup label="64-bit Integer Formats (4 registers)">';
+editForm+='<option value="INT64_12345678" '+(mappedDataType==='INT64_12345678'?'selected':'')+'>64-bit INT, Byte order 1,2,3,4,5,6,7,8</option>';
+editForm+='<option value="INT64_87654321" '+(mappedDataType==='INT64_87654321'?'selected':'')+'>64-bit INT, Byte order 8,7,6,5,4,3,2,1</option>';
+editForm+='<option value="INT64_21436587" '+(mappedDataType==='INT64_21436587'?'selected':'')+'>64-bit INT, Byte order 2,1,4,3,6,5,8,7</option>';
+editForm+='<option value="INT64_78563412" '+(mappedDataType==='INT64_78563412'?'selected':'')+'>64-bit INT, Byte order 7,8,5,6,3,4,1,2</option>';
+editForm+='<option value="UINT64_12345678" '+(mappedDataType==='UINT64_12345678'?'selected':'')+'>64-bit UINT, Byte order 1,2,3,4,5,6,7,8</option>';
+editForm+='<option value="UINT64_87654321" '+(mappedDataType==='UINT64_87654321'?'selected':'')+'>64-bit UINT, Byte order 8,7,6,5,4,3,2,1</option>';
+editForm+='<option value="UINT64_21436587" '+(mappedDataType==='UINT64_21436587'?'selected':'')+'>64-bit UINT, Byte order 2,1,4,3,6,5,8,7</option>';
+editForm+='<option value="UINT64_78563412" '+(mappedDataType==='UINT64_78563412'?'selected':'')+'>64-bit UINT, Byte order 7,8,5,6,3,4,1,2</option>';
+editForm+='</optgroup>';
+editForm+='<optgroup label="64-bit Float Formats (4 registers)">';
+editForm+='<option value="FLOAT64_12345678" '+(mappedDataType==='FLOAT64_12345678'?'selected':'')+'>64-bit float, Byte order 1,2,3,4,5,6,7,8</option>';
+editForm+='<option value="FLOAT64_87654321" '+(mappedDataType==='FLOAT64_87654321'?'selected':'')+'>64-bit float, Byte order 8,7,6,5,4,3,2,1</option>';
+editForm+='<option value="FLOAT64_21436587" '+(mappedDataType==='FLOAT64_21436587'?'selected':'')+'>64-bit float, Byte order 2,1,4,3,6,5,8,7</option>';
+editForm+='<option value="FLOAT64_78563412" '+(mappedDataType==='FLOAT64_78563412'?'selected':'')+'>64-bit float, Byte order 7,8,5,6,3,4,1,2</option>';
+editForm+='</optgroup>';
+editForm+='<optgroup label="Special Formats">';
+editForm+='<option value="ASCII" '+(mappedDataType==='ASCII'?'selected':'')+'>ASCII String</option>';
+editForm+='<option value="HEX" '+(mappedDataType==='HEX'?'selected':'')+'>Hexadecimal</option>';
+editForm+='<option value="BOOL" '+(mappedDataType==='BOOL'?'selected':'')+'>Boolean (True/False)</option>';
+editForm+='<option value="PDU" '+(mappedDataType==='PDU'?'selected':'')+'>PDU (Protocol Data Unit)</option>';
+editForm+='</optgroup></select>';
+}
+editForm+='<label>Baud Rate:</label><select id="edit_baud_'+sensorId+'">';
+editForm+='<option value="2400" '+(sensor.baud_rate==2400?'selected':'')+'>2400 bps</option>';
+editForm+='<option value="4800" '+(sensor.baud_rate==4800?'selected':'')+'>4800 bps</option>';
+editForm+='<option value="9600" '+(sensor.baud_rate==9600?'selected':'')+'>9600 bps</option>';
+editForm+='<option value="14400" '+(sensor.baud_rate==14400?'selected':'')+'>14400 bps</option>';
+editForm+='<option value="19200" '+(sensor.baud_rate==19200?'selected':'')+'>19200 bps</option>';
+editForm+='<option value="28800" '+(sensor.baud_rate==28800?'selected':'')+'>28800 bps</option>';
+editForm+='<option value="38400" '+(sensor.baud_rate==38400?'selected':'')+'>38400 bps</option>';
+editForm+='<option value="57600" '+(sensor.baud_rate==57600?'selected':'')+'>57600 bps</option>';
+editForm+='<option value="115200" '+(sensor.baud_rate==115200?'selected':'')+'>115200 bps</option>';
+editForm+='<option value="230400" '+(sensor.baud_rate==230400?'selected':'')+'>230400 bps</option>';
+editForm+='</select>';
+editForm+='<label>Parity:</label><select id="edit_parity_'+sensorId+'">';
+editForm+='<option value="none" '+(sensor.parity==='none'||!sensor.parity?'selected':'')+'>None</option>';
+editForm+='<option value="even" '+(sensor.parity==='even'?'selected':'')+'>Even</option>';
+editForm+='<option value="odd" '+(sensor.parity==='odd'?'selected':'')+'>Odd</option>';
+editForm+='</select>';
+if (sensor.sensor_type === 'Level') {
+editForm+='<label>Sensor Height:</label><div><input type="number" id="edit_sensor_height_'+sensorId+'" value="'+sensor.sensor_height+'" step="any"><small style="color:#666;margin-left:8px">(meters or your unit)</small></div>';
+editForm+='<label>Max Water Level:</label><div><input type="number" id="edit_max_water_level_'+sensorId+'" value="'+sensor.max_water_level+'" step="any"><small style="color:#666;margin-left:8px">(meters or your unit)</small></div>';
+} else if (sensor.sensor_type === 'Radar Level') {
+editForm+='<label>Max Water Level:</label><div><input type="number" id="edit_max_water_level_'+sensorId+'" value="'+sensor.max_water_level+'" step="any" style="border:1px solid #ccc"><small style="color:#666;margin-left:8px">(meters or your unit)</small></div>';
+} else if (sensor.sensor_type === 'Hydrostatic_Level') {
+editForm+='<label>Tank Height (m):</label><div><input type="number" id="edit_max_water_level_'+sensorId+'" value="'+sensor.max_water_level+'" step="any" style="border:1px solid #ccc"><small style="color:#666;margin-left:8px">(Total tank height - Level % = Raw Value / Tank Height × 100)</small></div>';
+} else if (sensor.sensor_type === 'ENERGY') {
+editForm+='<label>Meter Type:</label><div><input type="text" id="edit_meter_type_'+sensorId+'" value="'+(sensor.meter_type||'')+'" placeholder="e.g., Power Meter"><small style="color:#666;margin-left:8px">(Used as meter identifier)</small></div>';
+} else if (sensor.sensor_type === 'QUALITY') {
+editForm+='<p style="color:#17a2b8;font-weight:bold;margin:10px 0">[TEST] Water Quality Sensor - Sub-Sensors Configuration</p>';
+editForm+='<div style="margin-top:20px;padding:15px;background:#f0f8ff;border:2px dashed #17a2b8;border-radius:8px">';
+editForm+='<h4 style="color:#17a2b8;margin-top:0">[PARAM] Sub-Sensors - Water Quality Parameters</h4>';
+editForm+='<div id="edit-sub-sensors-'+sensorId+'" style="margin:10px 0"></div>';
+editForm+='<button type="button" onclick="addEditSubSensor('+sensorId+')" style="background:#28a745;color:white;padding:8px 16px;border:none;border-radius:4px;font-size:14px;cursor:pointer">➕ Add Sub-Sensor</button>';
+editForm+='</div>';
+} else if (sensor.sensor_type === 'RAINGAUGE') {
+console.log('Edit form: Creating RAINGAUGE sensor edit form for sensor', sensorId, 'with scale_factor:', sensor.scale_factor);
+editForm+='<label>Scale Factor:</label><div><input type="number" id="edit_scale_factor_'+sensorId+'" value="'+(sensor.scale_factor||1.0)+'" step="any" style="width:100px"><small style="color:#666;margin-left:8px">(Rain gauge scaling - e.g., 0.1 for mm/tips)</small></div>';
+} else if (sensor.sensor_type === 'BOREWELL') {
+console.log('Edit form: Creating BOREWELL sensor edit form for sensor', sensorId, 'with scale_factor:', sensor.scale_factor);
+editForm+='<label>Scale Factor:</label><div><input type="number" id="edit_scale_factor_'+sensorId+'" value="'+(sensor.scale_factor||1.0)+'" step="any" style="width:100px"><small style="color:#666;margin-left:8px">(Borewell sensor scaling)</small></div>';
+} else {
+console.log('Edit form: Creating generic sensor edit form for sensor', sensorId, 'type:', sensor.sensor_type, 'scale_factor:', sensor.scale_factor);
+editForm+='<label>Scale Factor:</label><input type="number" id="edit_scale_factor_'+sensorId+'" value="'+(sensor.scale_factor||1.0)+'" step="any">';
+}
+editForm+='</div>';
+editForm+='<div id="test-result-edit-'+sensorId+'" style="margin:10px 0;display:none"></div>';
+editForm+='<div style="display:flex;gap:10px;margin-top:15px;justify-content:flex-start;align-items:center">';
+editForm+='<button type="button" onclick="saveSensorEdit('+sensorId+')" style="background:#28a745;color:white;padding:10px 20px;border:none;border-radius:4px;font-weight:bold;min-width:120px;cursor:pointer">Save Changes</button>';
+editForm+='<button type="button" onclick="testEditSensorRS485('+sensorId+')" style="background:#007bff;color:white;padding:10px 20px;border:none;border-radius:4px;font-weight:bold;min-width:120px;cursor:pointer">Test RS485</button>';
+editForm+='<button type="button" onclick="cancelSensorEdit('+sensorId+')" style="background:#6c757d;color:white;padding:10px 20px;border:none;border-radius:4px;font-weight:bold;min-width:120px;cursor:pointer">Cancel</button>';
+editForm+='</div>';
+editForm+='</div>';
+document.getElementById('sensor-card-'+sensorId).outerHTML=editForm;
+setTimeout(() => {
+const editSelect = document.getElementById('edit_datatype_' + sensorId);
+if (editSelect) {
+if (editSelect.value !== sensor.data_type) {
+let mappedType = sensor.data_type;
+if (sensor.data_type === '' || sensor.data_type === null || sensor.data_type === undefined) {
+mappedType = 'UINT16_HI';
+} else if (sensor.data_type === 'FLOAT32_AB') mappedType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_43') mappedType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_ABCD') mappedType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_1234') mappedType = 'FLOAT32_1234';
+else if (sensor.data_type === 'FLOAT32_DCBA') mappedType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_4321') mappedType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_432') mappedType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_BADC') mappedType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_2143') mappedType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_214') mappedType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_CDAB') mappedType = 'FLOAT32_3412';
+else if (sensor.data_type === 'FLOAT32_3412') mappedType = 'FLOAT32_3412';
+else if (sensor.data_type === 'FLOAT32_341') mappedType = 'FLOAT32_3412';
+else if (sensor.data_type === 'UINT32_AB') mappedType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_ABCD') mappedType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_1234') mappedType = 'UINT32_1234';
+else if (sensor.data_type === 'UINT32_DCBA') mappedType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_4321') mappedType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_432') mappedType = 'UINT32_4321';
+else if (sensor.data_type === 'UINT32_BADC') mappedType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_2143') mappedType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_214') mappedType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_CDAB') mappedType = 'UINT32_3412';
+else if (sensor.data_type === 'UINT32_3412') mappedType = 'UINT32_3412';
+else if (sensor.data_type === 'UINT32_341') mappedType = 'UINT32_3412';
+else if (sensor.data_type === 'INT32_AB') mappedType = 'INT32_1234';
+else if (sensor.data_type === 'INT32_ABCD') mappedType = 'INT32_1234';
+else if (sensor.data_type === 'INT32_1234') mappedType = 'INT32_1234';
+else if (sensor.data_type === 'INT32_DCBA') mappedType = 'INT32_4321';
+else if (sensor.data_type === 'INT32_4321') mappedType = 'INT32_4321';
+else if (sensor.data_type === 'INT32_432') mappedType = 'INT32_4321';
+else if (sensor.data_type === 'INT32_BADC') mappedType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_2143') mappedType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_214') mappedType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_CDAB') mappedType = 'INT32_3412';
+else if (sensor.data_type === 'INT32_3412') mappedType = 'INT32_3412';
+else if (sensor.data_type === 'INT32_341') mappedType = 'INT32_3412';
+else if (sensor.data_type === 'UINT32_DCB') mappedType = 'UINT32_4321';
+else if (sensor.data_type === 'INT32_DCB') mappedType = 'INT32_4321';
+else if (sensor.data_type === 'FLOAT32_DCB') mappedType = 'FLOAT32_4321';
+else if (sensor.data_type === 'UINT32') mappedType = 'UINT32_1234';
+else if (sensor.data_type === 'INT32') mappedType = 'INT32_1234';
+else if (sensor.data_type === 'UINT32_CDA') mappedType = 'UINT32_3412';
+else if (sensor.data_type === 'UINT32_BAD') mappedType = 'UINT32_2143';
+else if (sensor.data_type === 'UINT32_DCA') mappedType = 'UINT32_4321';
+else if (sensor.data_type === 'INT32_CDA') mappedType = 'INT32_3412';
+else if (sensor.data_type === 'INT32_BAD') mappedType = 'INT32_2143';
+else if (sensor.data_type === 'INT32_DCA') mappedType = 'INT32_4321';
+else if (sensor.data_type === 'FLOAT32_DC') mappedType = 'FLOAT32_4321';
+else if (sensor.data_type === 'FLOAT32_CDA') mappedType = 'FLOAT32_3412';
+else if (sensor.data_type === 'FLOAT32_BAD') mappedType = 'FLOAT32_2143';
+else if (sensor.data_type === 'FLOAT32_DCA') mappedType = 'FLOAT32_4321';
+else if (sensor.data_type === 'UINT16_B') mappedType = 'UINT16_HI';
+else if (sensor.data_type === 'UINT16_BE') mappedType = 'UINT16_HI';
+else if (sensor.data_type === 'UINT16_HI') mappedType = 'UINT16_HI';
+else if (sensor.data_type === 'UINT16_L') mappedType = 'UINT16_LO';
+else if (sensor.data_type === 'UINT16_LE') mappedType = 'UINT16_LO';
+else if (sensor.data_type === 'UINT16_LO') mappedType = 'UINT16_LO';
+else if (sensor.data_type === 'UINT16') mappedType = 'UINT16_HI';
+else if (sensor.data_type === 'INT16_B') mappedType = 'INT16_HI';
+else if (sensor.data_type === 'INT16_BE') mappedType = 'INT16_HI';
+else if (sensor.data_type === 'INT16_HI') mappedType = 'INT16_HI';
+else if (sensor.data_type === 'INT16_L') mappedType = 'INT16_LO';
+else if (sensor.data_type === 'INT16_LE') mappedType = 'INT16_LO';
+else if (sensor.data_type === 'INT16_LO') mappedType = 'INT16_LO';
+else if (sensor.data_type === 'INT16') mappedType = 'INT16_HI';
+else if (sensor.data_type === 'UINT8') mappedType = 'UINT8';
+else if (sensor.data_type === 'INT8') mappedType = 'INT8';
+else if (sensor.data_type === 'ASCII') mappedType = 'ASCII';
+else if (sensor.data_type === 'HEX') mappedType = 'HEX';
+else if (sensor.data_type === 'BOOL') mappedType = 'BOOL';
+else if (sensor.data_type === 'PDU') mappedType = 'PDU';
+else if (sensor.data_type === 'INT64_12345678') mappedType = 'INT64_12345678';
+else if (sensor.data_type === 'INT64_87654321') mappedType = 'INT64_87654321';
+else if (sensor.data_type === 'INT64_21436587') mappedType = 'INT64_21436587';
+else if (sensor.data_type === 'INT64_78563412') mappedType = 'INT64_78563412';
+else if (sensor.data_type === 'UINT64_12345678') mappedType = 'UINT64_12345678';
+else if (sensor.data_type === 'UINT64_87654321') mappedType = 'UINT64_87654321';
+else if (sensor.data_type === 'UINT64_21436587') mappedType = 'UINT64_21436587';
+else if (sensor.data_type === 'UINT64_78563412') mappedType = 'UINT64_78563412';
+else if (sensor.data_type === 'FLOAT64_12345678') mappedType = 'FLOAT64_12345678';
+else if (sensor.data_type === 'FLOAT64_87654321') mappedType = 'FLOAT64_87654321';
+else if (sensor.data_type === 'FLOAT64_21436587') mappedType = 'FLOAT64_21436587';
+else if (sensor.data_type === 'FLOAT64_78563412') mappedType = 'FLOAT64_78563412';
+else if (sensor.data_type === 'INT64') mappedType = 'INT64_12345678';
+else if (sensor.data_type === 'UINT64') mappedType = 'UINT64_12345678';
+else if (sensor.data_type === 'FLOAT64') mappedType = 'FLOAT64_12345678';
+else if (sensor.data_type === 'INT64_BE') mappedType = 'INT64_12345678';
+else if (sensor.data_type === 'INT64_LE') mappedType = 'INT64_87654321';
+else if (sensor.data_type === 'UINT64_BE') mappedType = 'UINT64_12345678';
+else if (sensor.data_type === 'UINT64_LE') mappedType = 'UINT64_87654321';
+else if (sensor.data_type === 'FLOAT64_BE') mappedType = 'FLOAT64_12345678';
+else if (sensor.data_type === 'FLOAT64_LE') mappedType = 'FLOAT64_87654321';
+editSelect.value = mappedType;
+if (!editSelect.value) {
+for (let option of editSelect.options) {
+if (option.value === mappedType) {
+option.selected = true;
+editSelect.value = mappedType;
+break;
+}
+}
+if (!editSelect.value) {
+}
+}
+} else {
+}
+} else {
+}
+if (sensor.sensor_type === 'QUALITY') {
+loadEditSubSensors(sensorId);
+} else {
+}
+}, 500);
+}}
+function loadEditSubSensors(sensorId) {
+const sensor = sensorData[sensorId];
+if (!sensor) {
+console.error('[ERROR] ERROR: No sensor data found for sensor', sensorId);
+return;
+}
+if (!sensor.sub_sensors) {
+console.error('[ERROR] ERROR: No sub_sensors property found for sensor', sensorId);
+return;
+}
+const subSensorsDiv = document.getElementById('edit-sub-sensors-' + sensorId);
+if (!subSensorsDiv) {
+console.error('Sub-sensors div not found for sensor', sensorId);
+return;
+}
+subSensorsDiv.innerHTML = '';
+for (let i = 0; i < sensor.sub_sensors.length; i++) {
+const subSensor = sensor.sub_sensors[i];
+if (subSensor.parameter_name) {
+const subSensorId = 'edit-sub-sensor-' + sensorId + '-' + i;
+let h = '<div class="sub-sensor" id="' + subSensorId + '" style="border:1px solid #28a745;padding:10px;margin:10px 0;background:#f8fff8;border-radius:5px">';
+h += '<h5 style="color:#28a745;margin-top:0">[PARAM] Sub-Sensor ' + (i + 1) + '</h5>';
+h += '<div style="display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0">';
+h += '<div><label style="font-weight:bold">Parameter Type:</label><br><select name="sensor_' + sensorId + '_sub_' + i + '_parameter" style="width:100%;padding:5px">';
+for (let j = 0; j < qualityParameterTypes.length; j++) {
+const param = qualityParameterTypes[j];
+const selected = (param.key === subSensor.parameter_name) ? ' selected' : '';
+h += '<option value="' + param.key + '"' + selected + '>' + param.name + ' (' + param.units + ')</option>';
+}
+h += '</select></div>';
+h += '<div><label style="font-weight:bold">Slave ID:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + i + '_slave_id" value="' + subSensor.slave_id + '" min="1" max="247" style="width:100%;padding:5px"></div>';
+h += '<div><label style="font-weight:bold">Register:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + i + '_register" value="' + subSensor.register_address + '" min="0" max="65535" style="width:100%;padding:5px"></div>';
+h += '</div>';
+h += '<div style="display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0">';
+h += '<div><label style="font-weight:bold">Quantity:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + i + '_quantity" value="' + subSensor.quantity + '" min="1" max="10" style="width:100%;padding:5px"></div>';
+h += '<div><label style="font-weight:bold">Register Type:</label><br><select name="sensor_' + sensorId + '_sub_' + i + '_register_type" style="width:100%;padding:5px">';
+const inputSelected = (subSensor.register_type === 'INPUT') ? ' selected' : '';
+const holdingSelected = (subSensor.register_type === 'HOLDING' || !subSensor.register_type) ? ' selected' : '';
+h += '<option value="INPUT"' + inputSelected + '>Input Register</option>';
+h += '<option value="HOLDING"' + holdingSelected + '>Holding Register</option>';
+h += '</select></div>';
+h += '<div><label style="font-weight:bold">Scale Factor:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + i + '_scale_factor" value="' + subSensor.scale_factor + '" step="any" style="width:100%;padding:5px"></div>';
+h += '</div>';
+h += '<div style="display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0">';
+h += '<div><label style="font-weight:bold">Data Type:</label><br><select name="sensor_' + sensorId + '_sub_' + i + '_data_type" style="width:100%;padding:5px">';
+h += '<optgroup label="8-bit Integer Types">';
+const int8Selected = (subSensor.data_type === 'INT8') ? ' selected' : '';
+const uint8Selected = (subSensor.data_type === 'UINT8') ? ' selected' : '';
+h += '<option value="INT8"' + int8Selected + '>INT8 - 8-bit Signed</option>';
+h += '<option value="UINT8"' + uint8Selected + '>UINT8 - 8-bit Unsigned</option>';
+h += '</optgroup>';
+h += '<optgroup label="16-bit Integer Types">';
+const int16Selected = (subSensor.data_type === 'INT16') ? ' selected' : '';
+const uint16Selected = (subSensor.data_type === 'UINT16') ? ' selected' : '';
+h += '<option value="INT16"' + int16Selected + '>INT16 - 16-bit Signed</option>';
+h += '<option value="UINT16"' + uint16Selected + '>UINT16 - 16-bit Unsigned</option>';
+h += '</optgroup>';
+h += '<optgroup label="32-bit Integer Types">';
+const int32AbcdSelected = (subSensor.data_type === 'INT32_ABCD') ? ' selected' : '';
+const int32DcbaSelected = (subSensor.data_type === 'INT32_DCBA') ? ' selected' : '';
+const int32BadcSelected = (subSensor.data_type === 'INT32_BADC') ? ' selected' : '';
+const int32CdabSelected = (subSensor.data_type === 'INT32_CDAB') ? ' selected' : '';
+const uint32AbcdSelected = (subSensor.data_type === 'UINT32_ABCD') ? ' selected' : '';
+const uint32DcbaSelected = (subSensor.data_type === 'UINT32_DCBA') ? ' selected' : '';
+const uint32BadcSelected = (subSensor.data_type === 'UINT32_BADC') ? ' selected' : '';
+const uint32CdabSelected = (subSensor.data_type === 'UINT32_CDAB') ? ' selected' : '';
+h += '<option value="INT32_ABCD"' + int32AbcdSelected + '>INT32_ABCD - Big Endian</option>';
+h += '<option value="INT32_DCBA"' + int32DcbaSelected + '>INT32_DCBA - Little Endian</option>';
+h += '<option value="INT32_BADC"' + int32BadcSelected + '>INT32_BADC - Mid-Big Endian</option>';
+h += '<option value="INT32_CDAB"' + int32CdabSelected + '>INT32_CDAB - Mid-Little Endian</option>';
+h += '<option value="UINT32_ABCD"' + uint32AbcdSelected + '>UINT32_ABCD - Big Endian</option>';
+h += '<option value="UINT32_DCBA"' + uint32DcbaSelected + '>UINT32_DCBA - Little Endian</option>';
+h += '<option value="UINT32_BADC"' + uint32BadcSelected + '>UINT32_BADC - Mid-Big Endian</option>';
+h += '<option value="UINT32_CDAB"' + uint32CdabSelected + '>UINT32_CDAB - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="32-bit Float Types">';
+const float32AbcdSelected = (subSensor.data_type === 'FLOAT32_ABCD') ? ' selected' : '';
+const float32DcbaSelected = (subSensor.data_type === 'FLOAT32_DCBA') ? ' selected' : '';
+const float32BadcSelected = (subSensor.data_type === 'FLOAT32_BADC') ? ' selected' : '';
+const float32CdabSelected = (subSensor.data_type === 'FLOAT32_CDAB') ? ' selected' : '';
+h += '<option value="FLOAT32_ABCD"' + float32AbcdSelected + '>FLOAT32_ABCD - Big Endian</option>';
+h += '<option value="FLOAT32_DCBA"' + float32DcbaSelected + '>FLOAT32_DCBA - Little Endian</option>';
+h += '<option value="FLOAT32_BADC"' + float32BadcSelected + '>FLOAT32_BADC - Mid-Big Endian</option>';
+h += '<option value="FLOAT32_CDAB"' + float32CdabSelected + '>FLOAT32_CDAB - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="64-bit Integer Types">';
+const int64_1Selected = (subSensor.data_type === 'INT64_12345678') ? ' selected' : '';
+const int64_2Selected = (subSensor.data_type === 'INT64_87654321') ? ' selected' : '';
+const int64_3Selected = (subSensor.data_type === 'INT64_21436587') ? ' selected' : '';
+const int64_4Selected = (subSensor.data_type === 'INT64_78563412') ? ' selected' : '';
+const uint64_1Selected = (subSensor.data_type === 'UINT64_12345678') ? ' selected' : '';
+const uint64_2Selected = (subSensor.data_type === 'UINT64_87654321') ? ' selected' : '';
+const uint64_3Selected = (subSensor.data_type === 'UINT64_21436587') ? ' selected' : '';
+const uint64_4Selected = (subSensor.data_type === 'UINT64_78563412') ? ' selected' : '';
+h += '<option value="INT64_12345678"' + int64_1Selected + '>INT64_12345678 - Big Endian</option>';
+h += '<option value="INT64_87654321"' + int64_2Selected + '>INT64_87654321 - Little Endian</option>';
+h += '<option value="INT64_21436587"' + int64_3Selected + '>INT64_21436587 - Mid-Big Endian</option>';
+h += '<option value="INT64_78563412"' + int64_4Selected + '>INT64_78563412 - Mid-Little Endian</option>';
+h += '<option value="UINT64_12345678"' + uint64_1Selected + '>UINT64_12345678 - Big Endian</option>';
+h += '<option value="UINT64_87654321"' + uint64_2Selected + '>UINT64_87654321 - Little Endian</option>';
+h += '<option value="UINT64_21436587"' + uint64_3Selected + '>UINT64_21436587 - Mid-Big Endian</option>';
+h += '<option value="UINT64_78563412"' + uint64_4Selected + '>UINT64_78563412 - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="64-bit Float Types">';
+const float64_1Selected = (subSensor.data_type === 'FLOAT64_12345678') ? ' selected' : '';
+const float64_2Selected = (subSensor.data_type === 'FLOAT64_87654321') ? ' selected' : '';
+const float64_3Selected = (subSensor.data_type === 'FLOAT64_21436587') ? ' selected' : '';
+const float64_4Selected = (subSensor.data_type === 'FLOAT64_78563412') ? ' selected' : '';
+h += '<option value="FLOAT64_12345678"' + float64_1Selected + '>FLOAT64_12345678 - Big Endian</option>';
+h += '<option value="FLOAT64_87654321"' + float64_2Selected + '>FLOAT64_87654321 - Little Endian</option>';
+h += '<option value="FLOAT64_21436587"' + float64_3Selected + '>FLOAT64_21436587 - Mid-Big Endian</option>';
+h += '<option value="FLOAT64_78563412"' + float64_4Selected + '>FLOAT64_78563412 - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="Special Types">';
+const asciiSelected = (subSensor.data_type === 'ASCII') ? ' selected' : '';
+const hexSelected = (subSensor.data_type === 'HEX') ? ' selected' : '';
+const boolSelected = (subSensor.data_type === 'BOOL') ? ' selected' : '';
+const pduSelected = (subSensor.data_type === 'PDU') ? ' selected' : '';
+h += '<option value="ASCII"' + asciiSelected + '>ASCII String</option>';
+h += '<option value="HEX"' + hexSelected + '>Hexadecimal</option>';
+h += '<option value="BOOL"' + boolSelected + '>Boolean</option>';
+h += '<option value="PDU"' + pduSelected + '>PDU (Protocol Data Unit)</option>';
+h += '</optgroup>';
+h += '</select></div>';
+h += '<div style="display:flex;align-items:end"><button type="button" onclick="removeEditSubSensor(\"' + subSensorId + '\")" style="background:#dc3545;color:white;padding:8px 12px;border:none;border-radius:4px;font-size:12px;cursor:pointer">[DEL] Remove</button></div>';
+h += '</div>';
+h += '</div>';
+subSensorsDiv.innerHTML += h;
+}
+}
+}
+function addEditSubSensor(sensorId) {
+const subSensorsDiv = document.getElementById('edit-sub-sensors-' + sensorId);
+if (!subSensorsDiv) {
+alert('ERROR: Sub-sensors container not found');
+return;
+}
+const subSensorCount = subSensorsDiv.querySelectorAll('.sub-sensor').length;
+const subSensorId = 'edit-sub-sensor-' + sensorId + '-' + subSensorCount;
+let h = '<div class="sub-sensor" id="' + subSensorId + '" style="border:1px solid #28a745;padding:10px;margin:10px 0;background:#f8fff8;border-radius:5px">';
+h += '<h5 style="color:#28a745;margin-top:0">[PARAM] Sub-Sensor ' + (subSensorCount + 1) + '</h5>';
+h += '<div style="display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0">';
+h += '<div><label style="font-weight:bold">Parameter Type:</label><br><select name="sensor_' + sensorId + '_sub_' + subSensorCount + '_parameter" style="width:100%;padding:5px">';
+h += '<option value="">Select Parameter</option>';
+for (let i = 0; i < qualityParameterTypes.length; i++) {
+const param = qualityParameterTypes[i];
+h += '<option value="' + param.key + '">' + param.name + ' (' + param.units + ')</option>';
+}
+h += '</select></div>';
+h += '<div><label style="font-weight:bold">Slave ID:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + subSensorCount + '_slave_id" value="1" min="1" max="247" style="width:100%;padding:5px"></div>';
+h += '<div><label style="font-weight:bold">Register:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + subSensorCount + '_register" value="1" min="0" max="65535" style="width:100%;padding:5px"></div>';
+h += '</div>';
+h += '<div style="display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0">';
+h += '<div><label style="font-weight:bold">Quantity:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + subSensorCount + '_quantity" value="1" min="1" max="10" style="width:100%;padding:5px"></div>';
+h += '<div><label style="font-weight:bold">Register Type:</label><br><select name="sensor_' + sensorId + '_sub_' + subSensorCount + '_register_type" style="width:100%;padding:5px">';
+h += '<option value="HOLDING" selected>Holding Register</option>';
+h += '<option value="INPUT">Input Register</option>';
+h += '</select></div>';
+h += '<div><label style="font-weight:bold">Scale Factor:</label><br><input type="number" name="sensor_' + sensorId + '_sub_' + subSensorCount + '_scale_factor" value="1.0" step="any" style="width:100%;padding:5px"></div>';
+h += '</div>';
+h += '<div style="display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0">';
+h += '<div><label style="font-weight:bold">Data Type:</label><br><select name="sensor_' + sensorId + '_sub_' + subSensorCount + '_data_type" style="width:100%;padding:5px">';
+h += '<option value="">Select Data Type</option>';
+h += '<optgroup label="8-bit Integer Types">';
+h += '<option value="INT8">INT8 - 8-bit Signed</option>';
+h += '<option value="UINT8">UINT8 - 8-bit Unsigned</option>';
+h += '</optgroup>';
+h += '<optgroup label="16-bit Integer Types">';
+h += '<option value="INT16">INT16 - 16-bit Signed</option>';
+h += '<option value="UINT16">UINT16 - 16-bit Unsigned</option>';
+h += '</optgroup>';
+h += '<optgroup label="32-bit Integer Types">';
+h += '<option value="INT32_ABCD">INT32_ABCD - Big Endian</option>';
+h += '<option value="INT32_DCBA">INT32_DCBA - Little Endian</option>';
+h += '<option value="INT32_BADC">INT32_BADC - Mid-Big Endian</option>';
+h += '<option value="INT32_CDAB">INT32_CDAB - Mid-Little Endian</option>';
+h += '<option value="UINT32_ABCD">UINT32_ABCD - Big Endian</option>';
+h += '<option value="UINT32_DCBA">UINT32_DCBA - Little Endian</option>';
+h += '<option value="UINT32_BADC">UINT32_BADC - Mid-Big Endian</option>';
+h += '<option value="UINT32_CDAB">UINT32_CDAB - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="32-bit Float Types">';
+h += '<option value="FLOAT32_ABCD">FLOAT32_ABCD - Big Endian</option>';
+h += '<option value="FLOAT32_DCBA">FLOAT32_DCBA - Little Endian</option>';
+h += '<option value="FLOAT32_BADC">FLOAT32_BADC - Mid-Big Endian</option>';
+h += '<option value="FLOAT32_CDAB">FLOAT32_CDAB - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="64-bit Integer Types">';
+h += '<option value="INT64_12345678">INT64_12345678 - Big Endian</option>';
+h += '<option value="INT64_87654321">INT64_87654321 - Little Endian</option>';
+h += '<option value="INT64_21436587">INT64_21436587 - Mid-Big Endian</option>';
+h += '<option value="INT64_78563412">INT64_78563412 - Mid-Little Endian</option>';
+h += '<option value="UINT64_12345678">UINT64_12345678 - Big Endian</option>';
+h += '<option value="UINT64_87654321">UINT64_87654321 - Little Endian</option>';
+h += '<option value="UINT64_21436587">UINT64_21436587 - Mid-Big Endian</option>';
+h += '<option value="UINT64_78563412">UINT64_78563412 - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="64-bit Float Types">';
+h += '<option value="FLOAT64_12345678">FLOAT64_12345678 - Big Endian</option>';
+h += '<option value="FLOAT64_87654321">FLOAT64_87654321 - Little Endian</option>';
+h += '<option value="FLOAT64_21436587">FLOAT64_21436587 - Mid-Big Endian</option>';
+h += '<option value="FLOAT64_78563412">FLOAT64_78563412 - Mid-Little Endian</option>';
+h += '</optgroup>';
+h += '<optgroup label="Special Types">';
+h += '<option value="ASCII">ASCII String</option>';
+h += '<option value="HEX">Hexadecimal</option>';
+h += '<option value="BOOL">Boolean</option>';
+h += '<option value="PDU">PDU (Protocol Data Unit)</option>';
+h += '</optgroup>';
+h += '</select></div>';
+h += '<div style="display:flex;align-items:end;gap:5px">';
+h += '<button type="button" onclick="saveEditSubSensor(\"' + subSensorId + '\")" style="background:#28a745;color:white;padding:8px 12px;border:none;border-radius:4px;font-size:12px;cursor:pointer">[SAVE] Save</button>';
+h += '<button type="button" onclick="removeEditSubSensor(\"' + subSensorId + '\")" style="background:#dc3545;color:white;padding:8px 12px;border:none;border-radius:4px;font-size:12px;cursor:pointer">[DEL] Remove</button>';
+h += '</div>';
+h += '</div>';
+h += '</div>';
+subSensorsDiv.insertAdjacentHTML('beforeend', h);
+}
 
+function removeEditSubSensor(subSensorId) {
+const subSensorDiv = document.getElementById(subSensorId);
+if (subSensorDiv) {
+subSensorDiv.remove();
+}
+}
+function saveSensorEdit(sensorId){
+const name=document.getElementById('edit_name_'+sensorId).value;
+const unitId=document.getElementById('edit_unit_'+sensorId).value;
+const sensor=sensorData[sensorId];
+const slaveIdEl=document.getElementById('edit_slave_'+sensorId);
+const registerEl=document.getElementById('edit_register_'+sensorId);
+const quantityEl=document.getElementById('edit_quantity_'+sensorId);
+const dataTypeEl=document.getElementById('edit_datatype_'+sensorId);
+const baudRateEl=document.getElementById('edit_baud_'+sensorId);
+const parityEl=document.getElementById('edit_parity_'+sensorId);
+const registerTypeEl=document.getElementById('edit_register_type_'+sensorId);
+const slaveId=slaveIdEl?slaveIdEl.value:'0';
+const register=registerEl?registerEl.value:'0';
+const quantity=quantityEl?quantityEl.value:'1';
+const dataType=dataTypeEl?dataTypeEl.value:'UINT16_BE';
+const baudRate=baudRateEl?baudRateEl.value:'9600';
+const parity=parityEl?parityEl.value:'none';
+const registerType=registerTypeEl?registerTypeEl.value:'HOLDING';
+let formData='sensor_id='+sensorId+'&name='+encodeURIComponent(name)+'&unit_id='+encodeURIComponent(unitId)+
+'&slave_id='+slaveId+'&register_address='+register+'&quantity='+quantity+'&data_type='+encodeURIComponent(dataType)+'&register_type='+registerType+'&baud_rate='+baudRate+'&parity='+parity;
+if (sensor.sensor_type === 'Level') {
+const sensorHeight=document.getElementById('edit_sensor_height_'+sensorId).value||'0';
+const maxWaterLevel=document.getElementById('edit_max_water_level_'+sensorId).value||'0';
+formData+='&sensor_type=Level&sensor_height='+sensorHeight+'&max_water_level='+maxWaterLevel+'&scale_factor=1.0&meter_type=';
+console.log('Saving Level sensor:',sensorId,'Height:',sensorHeight,'MaxLevel:',maxWaterLevel);
+} else if (sensor.sensor_type === 'Radar Level') {
+const maxWaterLevel=document.getElementById('edit_max_water_level_'+sensorId).value||'0';
+formData+='&sensor_type=Radar Level&sensor_height=0&max_water_level='+maxWaterLevel+'&scale_factor=1.0&meter_type=';
+console.log('Saving Radar Level sensor:',sensorId,'MaxLevel:',maxWaterLevel);
+} else if (sensor.sensor_type === 'Hydrostatic_Level') {
+const maxWaterLevel=document.getElementById('edit_max_water_level_'+sensorId).value||'0';
+formData+='&sensor_type=Hydrostatic_Level&sensor_height=0&max_water_level='+maxWaterLevel+'&scale_factor=1.0&meter_type=';
+console.log('Saving Hydrostatic_Level sensor:',sensorId,'TankHeight:',maxWaterLevel);
+} else if (sensor.sensor_type === 'ENERGY') {
+const meterType=document.getElementById('edit_meter_type_'+sensorId).value||'';
+formData+='&sensor_type=ENERGY&meter_type='+encodeURIComponent(meterType)+'&scale_factor=1.0&sensor_height=0&max_water_level=0';
+console.log('Saving ENERGY sensor:',sensorId,'MeterType:',meterType);
+} else if (sensor.sensor_type === 'QUALITY') {
+formData+='&sensor_type=QUALITY&scale_factor=1.0&sensor_height=0&max_water_level=0&meter_type=';
+const subSensors = document.querySelectorAll('#edit-sub-sensors-' + sensorId + ' .sub-sensor');
+for (let i = 0; i < subSensors.length; i++) {
+const subSensor = subSensors[i];
+const parameterSelect = subSensor.querySelector('select[name*="_parameter"]');
+const slaveIdInput = subSensor.querySelector('input[name*="_slave_id"]');
+const registerInput = subSensor.querySelector('input[name*="_register"]');
+const quantityInput = subSensor.querySelector('input[name*="_quantity"]');
+const registerTypeSelect = subSensor.querySelector('select[name*="_register_type"]');
+const scaleFactorInput = subSensor.querySelector('input[name*="_scale_factor"]');
+const dataTypeSelect = subSensor.querySelector('select[name*="_data_type"]');
+if (parameterSelect && parameterSelect.value && slaveIdInput && registerInput) {
+formData += '&sensor_' + sensorId + '_sub_' + i + '_parameter=' + encodeURIComponent(parameterSelect.value);
+formData += '&sensor_' + sensorId + '_sub_' + i + '_slave_id=' + (slaveIdInput.value || '1');
+formData += '&sensor_' + sensorId + '_sub_' + i + '_register=' + (registerInput.value || '30001');
+formData += '&sensor_' + sensorId + '_sub_' + i + '_quantity=' + (quantityInput ? quantityInput.value || '1' : '1');
+formData += '&sensor_' + sensorId + '_sub_' + i + '_register_type=' + (registerTypeSelect ? registerTypeSelect.value || 'HOLDING' : 'HOLDING');
+formData += '&sensor_' + sensorId + '_sub_' + i + '_scale_factor=' + (scaleFactorInput ? scaleFactorInput.value || '1.0' : '1.0');
+formData += '&sensor_' + sensorId + '_sub_' + i + '_data_type=' + (dataTypeSelect ? dataTypeSelect.value : '');
+}
+}
+console.log('Saving QUALITY sensor:',sensorId,'Sub-sensors count:',subSensors.length);
+} else if (sensor.sensor_type === 'RAINGAUGE') {
+const scaleFactor=document.getElementById('edit_scale_factor_'+sensorId).value||'1.0';
+formData+='&sensor_type=RAINGAUGE&scale_factor='+scaleFactor+'&sensor_height=0&max_water_level=0&meter_type=';
+console.log('Saving RAINGAUGE sensor:',sensorId,'ScaleFactor:',scaleFactor);
+} else if (sensor.sensor_type === 'BOREWELL') {
+const scaleFactor=document.getElementById('edit_scale_factor_'+sensorId).value||'1.0';
+formData+='&sensor_type=BOREWELL&scale_factor='+scaleFactor+'&sensor_height=0&max_water_level=0&meter_type=';
+console.log('Saving BOREWELL sensor:',sensorId,'ScaleFactor:',scaleFactor);
+} else {
+console.log('Edit save debug: Unknown sensor_type=', sensor.sensor_type, 'preserving original type for sensorId=', sensorId);
+const scaleFactor=document.getElementById('edit_scale_factor_'+sensorId).value||'1.0';
+const sensorTypeToSave = sensor.sensor_type || 'Flow-Meter';
+formData+='&sensor_type='+encodeURIComponent(sensorTypeToSave)+'&scale_factor='+scaleFactor+'&sensor_height=0&max_water_level=0&meter_type=';
+console.log('Saving sensor:',sensorId,'SensorType:',sensorTypeToSave,'ScaleFactor:',scaleFactor);
+}
+if(!name||!unitId){alert('ERROR: Please fill in Name and Unit ID');return;}
+fetch('/edit_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'){alert('SUCCESS: Sensor updated successfully');sessionStorage.setItem('showSection', 'sensors');window.location.reload();}else{alert('ERROR: '+data.message);}
+}).catch(e=>{alert('ERROR: Update failed: '+e.message);});}
+function cancelSensorEdit(sensorId){sessionStorage.setItem('showSection', 'sensors');window.location.reload();}
+function deleteSensor(sensorId){
+if(confirm('Are you sure you want to delete this sensor?')){
+fetch('/delete_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'sensor_id='+sensorId})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'){alert('SUCCESS: Sensor deleted');sessionStorage.setItem('showSection', 'sensors');window.location.reload();}else{alert('ERROR: '+data.message);}
+}).catch(e=>{alert('ERROR: Delete failed: '+e.message);});
+}}
+function testNewSensorRS485(sensorId){
+console.log('Testing new sensor RS485 for sensor ID:', sensorId);
+const resultDiv=document.getElementById('test-result-new-'+sensorId);
+if(!resultDiv){alert('Error: Result div not found for ID: test-result-new-'+sensorId);return;}
+resultDiv.style.display='block';
+resultDiv.innerHTML='<div style="background:#fff3cd;padding:10px;border-radius:4px;color:#856404">Testing RS485 communication...</div>';
+let sensorTypeElem=document.querySelector('select[name="sensor_'+sensorId+'_sensor_type"]');
+if(!sensorTypeElem) sensorTypeElem=document.querySelector('input[name="sensor_'+sensorId+'_sensor_type"]');
+let sensorType=sensorTypeElem ? sensorTypeElem.value : '';
+const baudRateElem=document.querySelector('select[name="sensor_'+sensorId+'_baud_rate"]');
+const parityElem=document.querySelector('select[name="sensor_'+sensorId+'_parity"]');
+const baudRate=baudRateElem ? baudRateElem.value : '9600';
+const parity=parityElem ? parityElem.value : 'none';
+if(sensorType==='QUALITY'){
+console.log('Testing QUALITY sensor - gathering sub-sensor data');
+const subSensorContainer=document.getElementById('sub-sensors-container-'+sensorId);
+if(!subSensorContainer){resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR:</strong> Sub-sensor container not found</div>';return;}
+const subSensors=subSensorContainer.querySelectorAll('.sub-sensor-form');
+if(subSensors.length===0){resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR:</strong> Please add at least one sub-sensor before testing</div>';return;}
+let data='sensor_type=QUALITY&baud_rate='+baudRate+'&parity='+parity+'&sub_sensor_count='+subSensors.length;
+for(let i=0;i<subSensors.length;i++){
+const paramElem=subSensors[i].querySelector('select[name*="_parameter"]');
+const slaveElem=subSensors[i].querySelector('input[name*="_slave_id"]');
+const regElem=subSensors[i].querySelector('input[name*="_register"]');
+const qtyElem=subSensors[i].querySelector('input[name*="_quantity"]');
+const dtElem=subSensors[i].querySelector('select[name*="_data_type"]');
+const scaleElem=subSensors[i].querySelector('input[name*="_scale"]');
+const regTypeElem=subSensors[i].querySelector('select[name*="_register_type"]');
+data+='&sub_'+i+'_param='+(paramElem?encodeURIComponent(paramElem.value):'');
+data+='&sub_'+i+'_slave='+(slaveElem?slaveElem.value:'1');
+data+='&sub_'+i+'_reg='+(regElem?regElem.value:'1');
+data+='&sub_'+i+'_qty='+(qtyElem?qtyElem.value:'1');
+data+='&sub_'+i+'_dtype='+(dtElem?encodeURIComponent(dtElem.value):'UINT16_BE');
+data+='&sub_'+i+'_scale='+(scaleElem?scaleElem.value:'1.0');
+data+='&sub_'+i+'_regtype='+(regTypeElem?regTypeElem.value:'HOLDING');
+}
+console.log('QUALITY test data:',data);
+fetch('/test_quality_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(r=>{if(!r.ok)throw new Error('HTTP '+r.status);return r.text();})
+.then(html=>{resultDiv.innerHTML=html;})
+.catch(e=>{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR:</strong> '+e.message+'</div>';});
+return;}
+console.log('Looking for form elements with sensor ID:', sensorId);
+const slaveIdElem=document.querySelector('input[name="sensor_'+sensorId+'_slave_id"]');
+const regAddrElem=document.querySelector('input[name="sensor_'+sensorId+'_register_address"]');
+const quantityElem=document.querySelector('input[name="sensor_'+sensorId+'_quantity"]');
+let dataTypeElem=document.querySelector('select[name="sensor_'+sensorId+'_data_type"]');
+if(!dataTypeElem) dataTypeElem=document.querySelector('input[name="sensor_'+sensorId+'_data_type"]');
+const scaleFactorElem=document.querySelector('input[name="sensor_'+sensorId+'_scale_factor"]');
+const registerTypeElem=document.querySelector('select[name="sensor_'+sensorId+'_register_type"]');
+console.log('Form elements found:', {slaveId: !!slaveIdElem, regAddr: !!regAddrElem, quantity: !!quantityElem, dataType: !!dataTypeElem, baudRate: !!baudRateElem, parity: !!parityElem, registerType: !!registerTypeElem, sensorType: !!sensorTypeElem});
+if(!slaveIdElem||!regAddrElem||!quantityElem||(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataTypeElem)||!baudRateElem||!parityElem){
+let missingFields=[];
+if(!slaveIdElem) missingFields.push('slave_id');
+if(!regAddrElem) missingFields.push('register_address');
+if(!quantityElem) missingFields.push('quantity');
+if(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataTypeElem) missingFields.push('data_type');
+if(!baudRateElem) missingFields.push('baud_rate');
+if(!parityElem) missingFields.push('parity');
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Missing Form Elements</strong><br>Cannot find: '+missingFields.join(', ')+'<br>Please make sure all form fields are filled and visible.</div>';
+return;}
+const slaveId=slaveIdElem.value||'1';
+const regAddr=regAddrElem.value||'0';
+const quantity=quantityElem.value||'1';
+let dataType=dataTypeElem ? dataTypeElem.value : '';
+if(sensorType==='Piezometer' && !dataType) dataType='UINT16_HI';
+if(sensorType==='Clampon' && !dataType) dataType='CLAMPON_FIXED';
+if(sensorType==='Dailian' && !dataType) dataType='UINT32_3412';
+if(sensorType==='Dailian_EMF' && !dataType) dataType='DAILIAN_EMF_FIXED';
+if(sensorType==='Panda_EMF' && !dataType) dataType='PANDA_EMF_FIXED';
+if(sensorType==='Panda_Level' && !dataType) dataType='PANDA_LEVEL_FIXED';
+if(sensorType==='ZEST' && !dataType) dataType='ZEST_FIXED';
+const registerType=registerTypeElem ? registerTypeElem.value : 'HOLDING';
+const scaleFactor=(scaleFactorElem ? scaleFactorElem.value : null)||'1.0';
+if(!sensorType){
+console.log('Sensor type not found, using Flow-Meter as default');
+sensorType='Flow-Meter';
+}
+console.log('New sensor test params:',{slaveId,regAddr,quantity,dataType,baudRate,parity,scaleFactor,sensorType});
+if(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataType){
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Data Type Required</strong><br>Please select a data type before testing.</div>';
+return;}
+if(!slaveId||!regAddr||!quantity||!scaleFactor){
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Validation Error</strong><br>Please fill in all required fields before testing.</div>';
+return;}
+let data='slave_id='+slaveId+'&register_address='+regAddr+'&quantity='+quantity+'&data_type='+dataType+'&register_type='+registerType+'&baud_rate='+baudRate+'&parity='+parity+'&scale_factor='+scaleFactor;
+data+='&sensor_type='+encodeURIComponent(sensorType);
+const sensorHeightElem=document.querySelector('input[name="sensor_'+sensorId+'_sensor_height"]');
+const maxWaterLevelElem=document.querySelector('input[name="sensor_'+sensorId+'_max_water_level"]');
+if(sensorHeightElem) data+='&sensor_height='+sensorHeightElem.value;
+if(maxWaterLevelElem) data+='&max_water_level='+maxWaterLevelElem.value;
+console.log('Sending new sensor test data:', data);
+fetch('/test_rs485',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(response => {
+console.log('New sensor test response status:', response.status);
+if (!response.ok) {
+throw new Error('HTTP '+response.status+': '+response.statusText);
+}
+return response.text();
+})
+.then(htmlData=>{
+console.log('New sensor test response HTML received');
+resultDiv.innerHTML=htmlData;
+}).catch(e=>{
+console.error('New sensor test error:', e);
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Communication Error</strong><br>'+e.message+'<br>Check browser console (F12) for details.</div>';
+});
+}
+function testEditSensorRS485(sensorId){
+console.log('Testing edit sensor RS485 for sensor ID:', sensorId);
+const resultDiv=document.getElementById('test-result-edit-'+sensorId);
+if(!resultDiv){alert('Error: Result div not found');return;}
+resultDiv.style.display='block';
+resultDiv.innerHTML='<div style="background:#fff3cd;padding:10px;border-radius:4px;color:#856404">Testing RS485 communication...</div>';
+const sensor=sensorData[sensorId];
+const sensorType=sensor ? sensor.sensor_type : '';
+const baudRateElem=document.getElementById('edit_baud_'+sensorId);
+const parityElem=document.getElementById('edit_parity_'+sensorId);
+const baudRate=baudRateElem ? baudRateElem.value : '9600';
+const parity=parityElem ? parityElem.value : 'none';
+if(sensorType==='QUALITY'){
+console.log('Testing QUALITY sensor - gathering sub-sensor data');
+const subSensorContainer=document.getElementById('edit-sub-sensors-'+sensorId);
+if(!subSensorContainer){resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR:</strong> Sub-sensor container not found</div>';return;}
+const subSensors=subSensorContainer.querySelectorAll('.sub-sensor');
+if(subSensors.length===0){resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR:</strong> No sub-sensors configured</div>';return;}
+let data='sensor_type=QUALITY&baud_rate='+baudRate+'&parity='+parity+'&sub_sensor_count='+subSensors.length;
+for(let i=0;i<subSensors.length;i++){
+const paramElem=subSensors[i].querySelector('select[name*="_parameter"]');
+const slaveElem=subSensors[i].querySelector('input[name*="_slave_id"]');
+const regElem=subSensors[i].querySelector('input[name*="_register"]');
+const qtyElem=subSensors[i].querySelector('input[name*="_quantity"]');
+const dtElem=subSensors[i].querySelector('select[name*="_data_type"]');
+const scaleElem=subSensors[i].querySelector('input[name*="_scale"]');
+const regTypeElem=subSensors[i].querySelector('select[name*="_register_type"]');
+data+='&sub_'+i+'_param='+(paramElem?encodeURIComponent(paramElem.value):'');
+data+='&sub_'+i+'_slave='+(slaveElem?slaveElem.value:'1');
+data+='&sub_'+i+'_reg='+(regElem?regElem.value:'1');
+data+='&sub_'+i+'_qty='+(qtyElem?qtyElem.value:'1');
+data+='&sub_'+i+'_dtype='+(dtElem?encodeURIComponent(dtElem.value):'UINT16_BE');
+data+='&sub_'+i+'_scale='+(scaleElem?scaleElem.value:'1.0');
+data+='&sub_'+i+'_regtype='+(regTypeElem?regTypeElem.value:'HOLDING');
+}
+console.log('QUALITY edit test data:',data);
+fetch('/test_quality_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(r=>{if(!r.ok)throw new Error('HTTP '+r.status);return r.text();})
+.then(html=>{resultDiv.innerHTML=html;})
+.catch(e=>{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR:</strong> '+e.message+'</div>';});
+return;}
+const slaveIdElem=document.getElementById('edit_slave_'+sensorId);
+const regAddrElem=document.getElementById('edit_register_'+sensorId);
+const quantityElem=document.getElementById('edit_quantity_'+sensorId);
+const registerTypeElem=document.getElementById('edit_register_type_'+sensorId);
+const dataTypeElem=document.getElementById('edit_datatype_'+sensorId);
+const scaleFactorElem=document.getElementById('edit_scale_factor_'+sensorId);
+if(!slaveIdElem||!regAddrElem||!quantityElem||!registerTypeElem||!dataTypeElem||!baudRateElem||!parityElem){
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Form Error</strong><br>Cannot find form elements. Please refresh the page.</div>';
+return;}
+const slaveId=slaveIdElem.value||'1';
+const regAddr=regAddrElem.value||'0';
+const quantity=quantityElem.value||'1';
+const registerType=registerTypeElem.value||'HOLDING';
+const dataType=dataTypeElem.value||'';
+const scaleFactor=(scaleFactorElem ? scaleFactorElem.value : null)||'1.0';
+console.log('Edit test params:',{slaveId,regAddr,quantity,registerType,dataType,baudRate,parity,scaleFactor,sensorType});
+if(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataType){
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Data Type Required</strong><br>Please select a data type before testing.</div>';
+return;}
+if(!slaveId||!regAddr||!quantity||!registerType||!baudRate||!parity||!scaleFactor){
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Validation Error</strong><br>Please fill in all required fields before testing.</div>';
+return;}
+let data='slave_id='+slaveId+'&register_address='+regAddr+'&quantity='+quantity+'&register_type='+registerType+'&data_type='+dataType+'&baud_rate='+baudRate+'&parity='+parity+'&scale_factor='+scaleFactor;
+data+='&sensor_type='+encodeURIComponent(sensorType);
+const sensorHeightElem=document.getElementById('edit_sensor_height_'+sensorId);
+const maxWaterLevelElem=document.getElementById('edit_max_water_level_'+sensorId);
+if(sensorHeightElem) data+='&sensor_height='+sensorHeightElem.value;
+if(maxWaterLevelElem) data+='&max_water_level='+maxWaterLevelElem.value;
+fetch('/test_rs485',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(r=>r.text()).then(htmlData=>{
+resultDiv.innerHTML=htmlData;
+}).catch(e=>{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24"><strong>ERROR: Communication Error</strong><br>'+e.message+'</div>';
+});
+}
+function writeSingleRegister(){
+const slaveId=document.getElementById('write_single_slave').value;
+const address=document.getElementById('write_single_addr').value;
+const value=document.getElementById('write_single_value').value;
+const resultDiv=document.getElementById('write_single_result');
+if(slaveId===''||address===''||value===''){alert('Please fill all fields');return;}
+if(slaveId<0||slaveId>247){alert('Slave ID must be between 0-247 (0 for broadcast)');return;}
+if(address<0||address>65535){alert('Register address must be between 0-65535');return;}
+if(value<0||value>65535){alert('Value must be between 0-65535');return;}
+resultDiv.style.display='block';
+resultDiv.innerHTML='<div style="background:#fff3cd;padding:10px;border-radius:4px;color:#856404">Writing single register...</div>';
+const data='slave_id='+slaveId+'&register_addr='+address+'&value='+value;
+fetch('/write_single_register',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(response=>response.json()).then(result=>{
+if(result.status==='success'){
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">SUCCESS: Register '+address+' = '+value+' written to slave '+slaveId+'</div>';
+}else{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+result.message+'</div>';
+}
+}).catch(error=>{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+error.message+'</div>';
+});}
+function writeMultipleRegisters(){
+const slaveId=document.getElementById('write_multi_slave').value;
+const startAddr=document.getElementById('write_multi_start').value;
+const valuesText=document.getElementById('write_multi_values').value;
+const resultDiv=document.getElementById('write_multi_result');
+if(slaveId===''||startAddr===''||!valuesText){alert('Please fill all fields');return;}
+if(slaveId<0||slaveId>247){alert('Slave ID must be between 0-247 (0 for broadcast)');return;}
+if(startAddr<0||startAddr>65535){alert('Start register must be between 0-65535');return;}
+const values=valuesText.split(',').map(v=>parseInt(v.trim())).filter(v=>!isNaN(v));
+if(values.length===0){alert('Please enter valid comma-separated values');return;}
+if(values.length>125){alert('Maximum 125 registers can be written at once');return;}
+for(let v of values){if(v<0||v>65535){alert('All values must be between 0-65535');return;}}
+resultDiv.style.display='block';
+resultDiv.innerHTML='<div style="background:#fff3cd;padding:10px;border-radius:4px;color:#856404">Writing '+values.length+' registers...</div>';
+const data='slave_id='+slaveId+'&start_addr='+startAddr+'&values='+values.join(',');
+fetch('/write_multiple_registers',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(response=>response.json()).then(result=>{
+if(result.status==='success'){
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">SUCCESS: '+values.length+' registers written starting at '+startAddr+' on slave '+slaveId+'</div>';
+}else{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+result.message+'</div>';
+}
+}).catch(error=>{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+error.message+'</div>';
+});}
+function startOtaUpdate(){
+const url=document.getElementById('ota_url').value.trim();
+if(!url){alert('Please enter a firmware URL');return;}
+if(!url.startsWith('http://') && !url.startsWith('https://')){alert('URL must start with http:// or https://');return;}
+if(!confirm('Start OTA update from:\n'+url+'\n\nThe device will download and install the new firmware.')){return;}
+const resultDiv=document.getElementById('ota_result');
+const progressDiv=document.getElementById('ota_progress');
+resultDiv.style.display='block';resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Starting OTA update...</div>';
+progressDiv.style.display='block';
+fetch('/api/ota/start',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({url:url})})
+.then(r=>r.json()).then(data=>{
+if(data.status==='success'||data.status==='started'){
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">OTA update started. Please wait...</div>';
+pollOtaProgress();
+}else{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+(data.message||'Failed to start OTA')+'</div>';
+progressDiv.style.display='none';
+}
+}).catch(e=>{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+e.message+'</div>';
+progressDiv.style.display='none';});}
+function pollOtaProgress(){
+const progressBar=document.getElementById('ota_progress_bar');
+const progressText=document.getElementById('ota_progress_text');
+const resultDiv=document.getElementById('ota_result');
+const progressDiv=document.getElementById('ota_progress');
+fetch('/api/ota/status').then(r=>r.json()).then(data=>{
+const pct=data.progress||0;
+progressBar.style.width=pct+'%';progressText.textContent=pct+'%';
+if(data.state==='downloading'||data.state==='installing'||data.state==='checking'||data.state==='verifying'){
+setTimeout(pollOtaProgress,1000);
+}else if(data.state==='pending_reboot'||data.state==='success'){
+progressBar.style.width='100%';progressText.textContent='100%';
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">OTA update completed! Device will reboot automatically or click Reboot Device.</div>';
+}else if(data.state==='failed'){
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">OTA FAILED: '+(data.error||'Unknown error')+'</div>';
+progressDiv.style.display='none';
+}else if(data.state==='idle'||data.state==='rollback'){refreshOtaStatus();}else{setTimeout(pollOtaProgress,1000);}
+}).catch(e=>{setTimeout(pollOtaProgress,2000);});}
+function uploadOtaFile(){
+const fileInput=document.getElementById('ota_file');
+if(!fileInput.files||!fileInput.files[0]){alert('Please select a firmware file');return;}
+const file=fileInput.files[0];
+if(!file.name.endsWith('.bin')){alert('Please select a .bin firmware file');return;}
+if(!confirm('Upload firmware file:\n'+file.name+' ('+Math.round(file.size/1024)+' KB)\n\nProceed with OTA update?')){return;}
+/* Raw binary upload - no FormData */
+const resultDiv=document.getElementById('ota_result');
+const progressDiv=document.getElementById('ota_upload_progress');
+const progressBar=document.getElementById('ota_upload_bar');
+const progressText=document.getElementById('ota_upload_text');
+resultDiv.style.display='block';resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Uploading firmware...</div>';
+progressDiv.style.display='block';
+const xhr=new XMLHttpRequest();
+xhr.upload.onprogress=function(e){if(e.lengthComputable){const pct=Math.round((e.loaded/e.total)*100);progressBar.style.width=pct+'%';progressText.textContent=pct+'%';}};
+xhr.onload=function(){
+if(xhr.status===200){
+const data=JSON.parse(xhr.responseText);
+if(data.status==='success'){
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">Firmware uploaded successfully! Rebooting in 3 seconds...</div>';
+setTimeout(function(){if(confirm('Firmware uploaded! Reboot now to apply update?')){fetch('/api/ota/reboot',{method:'POST'});}},1000);
+}else{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+(data.message||'Upload failed')+'</div>';}
+}else{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">HTTP ERROR: '+xhr.status+'</div>';}
+};
+xhr.onerror=function(){resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">Network error during upload</div>';};
+xhr.open('POST','/api/ota/upload',true);xhr.setRequestHeader('Content-Type','application/octet-stream');xhr.send(file);}
+function confirmOta(){
+if(!confirm('Confirm the current firmware as valid?\n\nThis makes the update permanent.')){return;}
+const resultDiv=document.getElementById('ota_result');
+resultDiv.style.display='block';resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Confirming update...</div>';
+fetch('/api/ota/confirm',{method:'POST'}).then(r=>r.json()).then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">Firmware confirmed! Update is now permanent.</div>';
+refreshOtaStatus();
+}else{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+(data.message||'Confirm failed')+'</div>';}
+}).catch(e=>{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+e.message+'</div>';});}
+function cancelOta(){
+if(!confirm('Cancel the pending OTA update?')){return;}
+const resultDiv=document.getElementById('ota_result');
+resultDiv.style.display='block';resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Cancelling update...</div>';
+fetch('/api/ota/cancel',{method:'POST'}).then(r=>r.json()).then(data=>{
+if(data.status==='success'){
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">OTA update cancelled.</div>';
+document.getElementById('ota_progress').style.display='none';
+document.getElementById('ota_upload_progress').style.display='none';
+refreshOtaStatus();
+}else{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+(data.message||'Cancel failed')+'</div>';}
+}).catch(e=>{resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+e.message+'</div>';});}
+function rebootDevice(){
+if(!confirm('Reboot the device now?\n\nThe device will restart and may take a minute to come back online.')){return;}
+const resultDiv=document.getElementById('ota_result');
+resultDiv.style.display='block';resultDiv.innerHTML='<div style="background:#fff3cd;padding:10px;border-radius:4px;color:#856404">Rebooting device...</div>';
+fetch('/api/ota/reboot',{method:'POST'}).then(r=>r.json()).then(data=>{
+resultDiv.innerHTML='<div style="background:#d4edda;padding:10px;border-radius:4px;color:#155724">Reboot command sent. Device is restarting...</div>';
+setTimeout(function(){location.reload();},30000);
+}).catch(e=>{resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Device is rebooting. Page will refresh shortly...</div>';setTimeout(function(){location.reload();},30000);});}
+let autoRefreshInterval=null;
+function scanModbusDevices(){
+const startId=parseInt(document.getElementById('scan_start').value);
+const endId=parseInt(document.getElementById('scan_end').value);
+const testRegister=parseInt(document.getElementById('scan_register').value);
+const regType=document.getElementById('scan_reg_type').value;
+const progressDiv=document.getElementById('scan_progress');
+const resultsDiv=document.getElementById('scan_results');
+if(startId<1||startId>247||endId<1||endId>247||startId>endId){
+alert('Invalid slave ID range (1-247)');return;}
+progressDiv.style.display='block';
+progressDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Scanning devices '+startId+'-'+endId+'...</div>';
+resultsDiv.innerHTML='';
+const data='start_id='+startId+'&end_id='+endId+'&test_register='+testRegister+'&reg_type='+regType;
+fetch('/modbus_scan',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(response=>response.json()).then(result=>{
+progressDiv.style.display='none';
+if(result.status==='success'){
+if(result.devices.length===0){
+resultsDiv.innerHTML='<div class="sensor-card"><h3>No Devices Found</h3><p>No responsive Modbus devices found in range '+startId+'-'+endId+'</p></div>';
+}else{
+let html='<div class="sensor-card"><h3>Discovered Devices ('+result.devices.length+')</h3><table style="width:100%;border-collapse:collapse"><thead><tr><th>Slave ID</th><th>Status</th></tr></thead><tbody>';
+result.devices.forEach(dev=>{
+html+='<tr><td>'+dev.slave_id+'</td><td><span style="color:#28a745;font-weight:bold">✓ Responsive</span></td></tr>';
+});
+html+='</tbody></table></div>';
+resultsDiv.innerHTML=html;
+}
+}else{
+resultsDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+result.message+'</div>';
+}
+}).catch(error=>{
+progressDiv.style.display='none';
+resultsDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+error.message+'</div>';
+});}
+function readLiveRegisters(){
+const slaveId=parseInt(document.getElementById('live_slave').value);
+const startRegister=parseInt(document.getElementById('live_register').value);
+const quantity=parseInt(document.getElementById('live_quantity').value);
+const regType=document.getElementById('live_reg_type').value;
+const resultDiv=document.getElementById('live_result');
+if(slaveId<1||slaveId>247){alert('Slave ID must be 1-247');return;}
+if(quantity<1||quantity>10){alert('Quantity must be 1-10');return;}
+const data='slave_id='+slaveId+'&start_register='+startRegister+'&quantity='+quantity+'&reg_type='+regType;
+fetch('/modbus_read_live',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})
+.then(response=>response.json()).then(result=>{
+if(result.status==='success'){
+const f=result.formats;
+let html='<div class="sensor-card"><h3>Register Values</h3>';
+html+='<table class="scada-table"><thead><tr class="scada-header-main"><th colspan="2">Raw Data</th></tr></thead><tbody>';
+html+='<tr><td><strong>Hex String</strong></td><td>'+f.hex_string+'</td></tr></tbody></table>';
+if(f.uint16_be!==undefined){
+html+='<table class="scada-table"><thead><tr class="scada-header-uint"><th colspan="2">16-bit Formats</th></tr></thead><tbody>';
+html+='<tr><td><strong>UINT16 Big Endian</strong></td><td>'+f.uint16_be+'</td></tr>';
+html+='<tr><td><strong>UINT16 Little Endian</strong></td><td>'+f.uint16_le+'</td></tr>';
+html+='<tr><td><strong>INT16 Big Endian</strong></td><td>'+f.int16_be+'</td></tr>';
+html+='<tr><td><strong>INT16 Little Endian</strong></td><td>'+f.int16_le+'</td></tr></tbody></table>';
+}
+if(f.uint32_abcd!==undefined){
+html+='<table class="scada-table"><thead><tr class="scada-header-uint"><th colspan="2">32-bit UINT Formats</th></tr></thead><tbody>';
+html+='<tr><td><strong>UINT32 ABCD</strong></td><td>'+f.uint32_abcd+'</td></tr>';
+html+='<tr><td><strong>UINT32 DCBA</strong></td><td>'+f.uint32_dcba+'</td></tr>';
+html+='<tr><td><strong>UINT32 BADC</strong></td><td>'+f.uint32_badc+'</td></tr>';
+html+='<tr><td><strong>UINT32 CDAB</strong></td><td>'+f.uint32_cdab+'</td></tr></tbody></table>';
+html+='<table class="scada-table"><thead><tr class="scada-header-int"><th colspan="2">32-bit INT Formats</th></tr></thead><tbody>';
+html+='<tr><td><strong>INT32 ABCD</strong></td><td>'+f.int32_abcd+'</td></tr>';
+html+='<tr><td><strong>INT32 DCBA</strong></td><td>'+f.int32_dcba+'</td></tr>';
+html+='<tr><td><strong>INT32 BADC</strong></td><td>'+f.int32_badc+'</td></tr>';
+html+='<tr><td><strong>INT32 CDAB</strong></td><td>'+f.int32_cdab+'</td></tr></tbody></table>';
+html+='<table class="scada-table"><thead><tr class="scada-header-float"><th colspan="2">32-bit FLOAT Formats</th></tr></thead><tbody>';
+html+='<tr><td><strong>FLOAT32 ABCD</strong></td><td>'+f.float32_abcd.toFixed(6)+'</td></tr>';
+html+='<tr><td><strong>FLOAT32 DCBA</strong></td><td>'+f.float32_dcba.toFixed(6)+'</td></tr>';
+html+='<tr><td><strong>FLOAT32 BADC</strong></td><td>'+f.float32_badc.toFixed(6)+'</td></tr>';
+html+='<tr><td><strong>FLOAT32 CDAB</strong></td><td>'+f.float32_cdab.toFixed(6)+'</td></tr></tbody></table>';
+}
+html+='</div>';
+resultDiv.innerHTML=html;
+}else{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+result.message+'</div>';
+}
+}).catch(error=>{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+error.message+'</div>';
+});}
+function toggleAutoRefresh(){
+const btn=document.getElementById('auto_refresh_btn');
+if(autoRefreshInterval){
+clearInterval(autoRefreshInterval);
+autoRefreshInterval=null;
+btn.textContent='Enable Auto-Refresh';
+btn.style.background='var(--color-primary)';
+}else{
+readLiveRegisters();
+autoRefreshInterval=setInterval(readLiveRegisters,2000);
+btn.textContent='Disable Auto-Refresh';
+btn.style.background='var(--color-error)';
+}}
+function registerDumpQuery(){
+return 'slave='+parseInt(document.getElementById('dump_slave').value)+'&fc='+document.getElementById('dump_fc').value+
+'&start='+parseInt(document.getElementById('dump_start').value)+'&count='+parseInt(document.getElementById('dump_count').value)+
+'&resolution='+document.getElementById('dump_resolution').value;}
+function downloadRegisterDump(){window.location='/api/modbus_dump?'+registerDumpQuery()+'&format=csv';}
+function runRegisterDump(){
+const resultDiv=document.getElementById('dump_result');
+const btn=document.getElementById('dump_btn');
+btn.disabled=true;
+resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460">Reading registers...</div>';
+fetch('/api/modbus_dump?'+registerDumpQuery()).then(r=>r.json()).then(data=>{
+btn.disabled=false;
+if(data.status==='error'){resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+data.message+'</div>';return;}
+const s=data.summary;
+let html='<div style="margin-bottom:8px">'+s.registers_ok+' registers read, '+s.registers_failed+' unavailable - '+s.reads+' reads in '+(s.ms/1000).toFixed(1)+' s'+(s.aborted?' <strong>(stopped: device not responding)</strong>':'')+'</div>';
+html+='<table class="scada-table"><thead><tr class="scada-header-main"><th>Registers</th><th>Status</th><th>Time</th><th>Values</th></tr></thead><tbody>';
+data.blocks.forEach(b=>{
+html+='<tr><td>'+b.start+(b.count>1?'-'+(b.start+b.count-1):'')+'</td><td>'+b.status+'</td><td>'+b.ms+' ms</td><td style="font-family:monospace;word-break:break-all">'+(b.values?b.values.join(' '):'')+'</td></tr>';});
+resultDiv.innerHTML=html+'</tbody></table>';
+}).catch(error=>{
+btn.disabled=false;
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+error.message+'</div>';
+});}
+let modbusPollInterval=null;
+function startModbusPoll(){
+const slaveId=parseInt(document.getElementById('poll_slave').value);
+const startReg=parseInt(document.getElementById('poll_register').value);
+const quantity=parseInt(document.getElementById('poll_quantity').value);
+const regType=document.getElementById('poll_reg_type').value;
+const interval=parseInt(document.getElementById('poll_interval').value);
+const resultDiv=document.getElementById('poll_result');
+const startBtn=document.getElementById('start_poll_btn');
+const stopBtn=document.getElementById('stop_poll_btn');
+if(slaveId<1||slaveId>247||startReg<0||startReg>65535||quantity<1||quantity>20){
+alert('Invalid parameters');return;}
+startBtn.style.display='none';
+stopBtn.style.display='block';
+resultDiv.style.display='block';
+resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460;margin-bottom:10px">● Polling Slave '+slaveId+', Reg '+startReg+'-'+(startReg+quantity-1)+' ('+regType+') every '+(interval/1000)+'s</div>';
+const pollFunc=()=>{
+fetch('/api/modbus_poll?slave='+slaveId+'&reg='+startReg+'&qty='+quantity+'&type='+regType)
+.then(r=>r.json())
+.then(data=>{
+if(data.status==='success'){
+let html='<table style="width:100%;border-collapse:collapse;background:white;border:1px solid #dee2e6">';
+html+='<thead><tr style="background:#28a745;color:white"><th style="padding:8px;text-align:left">Register</th><th style="padding:8px;text-align:right">Value (Dec)</th><th style="padding:8px;text-align:right">Value (Hex)</th></tr></thead><tbody>';
+for(let i=0;i<data.values.length;i++){
+html+='<tr style="border-bottom:1px solid #dee2e6"><td style="padding:6px;font-weight:bold">'+(startReg+i)+'</td><td style="padding:6px;text-align:right;font-family:monospace">'+data.values[i]+'</td><td style="padding:6px;text-align:right;font-family:monospace;color:#007bff">0x'+data.values[i].toString(16).toUpperCase().padStart(4,'0')+'</td></tr>';
+}
+html+='</tbody></table>';
+html+='<div style="margin-top:8px;font-size:12px;color:#6c757d">Last update: '+new Date().toLocaleTimeString()+'</div>';
+resultDiv.innerHTML='<div style="background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460;margin-bottom:10px">● Polling Active - Slave '+slaveId+', Reg '+startReg+'-'+(startReg+quantity-1)+'</div>'+html;
+}else{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">ERROR: '+data.message+'</div>';
+}
+}).catch(err=>{
+resultDiv.innerHTML='<div style="background:#f8d7da;padding:10px;border-radius:4px;color:#721c24">NETWORK ERROR: '+err.message+'</div>';
+});
+};
+pollFunc();
+modbusPollInterval=setInterval(pollFunc,interval);
+}
+function stopModbusPoll(){
+if(modbusPollInterval){
+clearInterval(modbusPollInterval);
+modbusPollInterval=null;}
+document.getElementById('start_poll_btn').style.display='block';
+document.getElementById('stop_poll_btn').style.display='none';
+document.getElementById('poll_result').innerHTML='<div style="background:#fff3cd;padding:10px;border-radius:4px;color:#856404">Polling stopped</div>';
+}
+console.log('Script loaded successfully. addSensor function defined:', typeof addSensor);
+// Current configuration - the page itself is static and cached, values come from /api/config
+var QUALITY_TYPES=['QUALITY','Aquadax_Quality','Opruss_Ace','Hardness_Sensor'];
+function escHtml(s){return String(s==null?'':s).replace(/&/g,'&amp;').replace(/</g,'&lt;').replace(/>/g,'&gt;').replace(/"/g,'&quot;').replace(/'/g,'&#39;');}
+function hex4(n){return ('0000'+(n>>>0).toString(16).toUpperCase()).slice(-4);}
+function cardButtons(i,big){
+var v=liveState['s'+i],live="<p><strong>Latest:</strong> <span id='live-value-"+i+"'>"+(v==null?'-':v)+"</span></p>";
+var st=big?'margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer':'margin:2px;padding:6px 12px';
+return live+"<button type='button' onclick='editSensor("+i+")' style='background:#17a2b8;color:white;"+st+"'>Edit</button> "+
+"<button type='button' onclick='testSensor("+i+")' style='background:#007bff;color:white;"+st+"'>Test RS485</button> "+
+"<button type='button' onclick='deleteSensor("+i+")' style='background:#dc3545;color:white;"+st+"'>Delete</button>"+
+"<div id='test-result-"+i+"' class='test-result' style='display:none'></div></div>";}
+function regularSensorCard(s,i){
+var t=s.sensor_type,color='#007bff',label=t||'Flow-Meter',note='RS485 Modbus - Real-time data with ScadaCore format interpretations';
+if(t==='Level'){note='RS485 Modbus - Level calc: (Height - Raw) / MaxLevel * 100';}
+else if(t==='RAINGAUGE'){color='#28a745';label='Rain Gauge';note='RS485 Modbus - Rain gauge measurement in mm or inches';}
+else if(t==='BOREWELL'){color='#6f42c1';label='Borewell';note='RS485 Modbus - Borewell water level and flow monitoring';}
+else if(t==='ENERGY'){color='#fd7e14';label='Energy Meter';note='RS485 Modbus - Energy meter monitoring with power consumption data';}
+var h="<div class='sensor-card' id='sensor-card-"+i+"'>"+
+"<h3>"+escHtml(s.name)+" (Sensor "+(i+1)+") - <span style='color:"+color+";font-weight:bold;'>"+escHtml(label)+"</span></h3>"+
+"<p><strong>Unit ID:</strong> "+escHtml(s.unit_id)+"</p>"+
+"<p><strong>Slave ID:</strong> "+s.slave_id+"</p>"+
+"<p><strong>Register:</strong> "+s.register_address+"</p>"+
+"<p><strong>Quantity:</strong> "+s.quantity+"</p>"+
+"<p><strong>Register Type:</strong> "+escHtml(s.register_type||'HOLDING')+"</p>"+
+"<p><strong>Data Type:</strong> "+escHtml(s.data_type)+"</p>";
+if(t==='Level'){h+="<p><strong>Sensor Height:</strong> "+s.sensor_height.toFixed(2)+"</p><p><strong>Max Water Level:</strong> "+s.max_water_level.toFixed(2)+"</p>";}
+else{h+="<p><strong>Scale:</strong> "+s.scale_factor.toFixed(3)+"</p>";}
+return h+"<p style='color:#666;font-size:12px;margin:5px 0;grid-column:1/-1'>"+note+"</p>"+cardButtons(i,true);}
+var QUALITY_BADGES={
+Aquadax_Quality:{c1:'#17a2b8',c2:'#20c997',badge:'AQUADAX QUALITY',qty:12,green:['COD','BOD','TSS','pH'],blue:['Temp']},
+Opruss_Ace:{c1:'#e67e22',c2:'#f39c12',badge:'OPRUSS ACE',qty:22,green:['COD','BOD','TSS'],blue:['TDS','Temp']},
+Hardness_Sensor:{c1:'#6f42c1',c2:'#8e5be2',badge:'HARDNESS',qty:6,purple:['Hardness (mg/L)'],blue:['Temp (&deg;C)']}};
+function qualitySensorCard(s,i){
+var baud=s.baud_rate>0?s.baud_rate:9600,b=QUALITY_BADGES[s.sensor_type];
+var h="<div class='sensor-card' id='sensor-card-"+i+"'>";
+if(b){
+h+="<div style='display:flex;justify-content:space-between;align-items:center;margin-bottom:12px;padding-bottom:10px;border-bottom:2px solid "+b.c1+"'>"+
+"<h3 style='margin:0;font-size:18px'>"+escHtml(s.name)+" <span style='color:#888;font-weight:normal'>(Sensor "+(i+1)+")</span></h3>"+
+"<span style='background:linear-gradient(135deg,"+b.c1+","+b.c2+");color:white;padding:4px 14px;border-radius:20px;font-size:12px;font-weight:600'>"+b.badge+"</span></div>"+
+"<div style='display:grid;grid-template-columns:1fr 1fr;gap:8px 20px;margin-bottom:12px;padding:12px;background:#f8f9fa;border-radius:8px;font-size:13px'>"+
+"<div><strong style='color:#555'>Unit ID:</strong> <span style='color:#0d6efd'>"+escHtml(s.unit_id)+"</span></div>"+
+"<div><strong style='color:#555'>Slave ID:</strong> "+s.slave_id+"</div>"+
+"<div><strong style='color:#555'>Register:</strong> "+s.register_address+" (0x"+hex4(s.register_address)+")</div>"+
+"<div><strong style='color:#555'>Baud Rate:</strong> "+baud+" bps</div>"+
+"<div><strong style='color:#555'>Quantity:</strong> "+b.qty+" registers</div>"+
+"<div><strong style='color:#555'>Data Format:</strong> FLOAT32 CDAB</div></div>"+
+"<div style='display:flex;flex-wrap:wrap;gap:6px;margin-bottom:10px'>";
+(b.green||[]).forEach(function(p){h+="<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>"+p+"</span>";});
+(b.purple||[]).forEach(function(p){h+="<span style='background:#e8daef;color:#5b2c8a;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #d2b4de'>"+p+"</span>";});
+(b.blue||[]).forEach(function(p){h+="<span style='background:#cce5ff;color:#004085;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #b8daff'>"+p+"</span>";});
+h+="</div>";
+}else if(s.sensor_type==='Aster'){
+var chip="<span style='background:#e8daef;color:#6c3483;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600'>";
+h+="<div style='display:flex;justify-content:space-between;align-items:center;margin-bottom:12px;padding-bottom:10px;border-bottom:2px solid #8e44ad'>"+
+"<h3 style='margin:0'>"+escHtml(s.name)+" <span style='color:#888;font-weight:normal'>(Sensor "+(i+1)+")</span></h3>"+
+"<span style='background:#8e44ad;color:white;padding:4px 14px;border-radius:20px;font-size:12px;font-weight:600'>ASTER</span></div>"+
+"<div style='display:grid;grid-template-columns:1fr 1fr;gap:8px 20px;margin-bottom:12px;padding:12px;background:#f8f9fa;border-radius:8px;font-size:13px'>"+
+"<div><b>Unit ID:</b> "+escHtml(s.unit_id)+"</div><div><b>Slave:</b> "+s.slave_id+"</div>"+
+"<div><b>Reg:</b> "+s.register_address+" (0x"+hex4(s.register_address)+")</div><div><b>Baud:</b> "+baud+"</div>"+
+"<div><b>Qty:</b> 4</div><div><b>Format:</b> UINT16</div></div>"+
+chip+"pH</span> "+chip+"TDS</span><br><br>";
+}else{
+h+="<h3>"+escHtml(s.name)+" (Sensor "+(i+1)+") - <span style='color:#17a2b8;font-weight:bold;'>Water Quality</span></h3>"+
+"<p><strong>Unit ID:</strong> "+escHtml(s.unit_id)+" | <strong>Sub-Sensors:</strong> "+s.sub_sensor_count+" configured</p>"+
+"<p style='color:#666;font-size:12px;margin:5px 0'>[TEST] Water Quality Modbus Sensor - Real-time water parameter monitoring</p>";
+var params=(s.sub_sensors||[]).filter(function(p){return p.enabled&&p.parameter_name;}).map(function(p){
+return "<span style='color:#28a745;font-weight:bold'>"+escHtml(p.parameter_name)+"</span> (ID:"+p.slave_id+", Reg:"+p.register_address+")";});
+if(s.sub_sensor_count>0){h+="<div style='background:#f0f8ff;padding:10px;margin:5px 0;border-radius:4px;border:1px solid #17a2b8'><strong style='color:#17a2b8'>[PARAM] Configured Parameters:</strong> "+params.join(', ')+"</div>";}
+}
+return h+cardButtons(i,false);}
+function renderSensorCards(sensors){
+var reg='',qual='';
+sensors.forEach(function(s,i){
+if(!s.enabled)return;
+if(QUALITY_TYPES.indexOf(s.sensor_type)<0)reg+=regularSensorCard(s,i);
+if(QUALITY_TYPES.indexOf(s.sensor_type)>=0||s.sensor_type==='Aster')qual+=qualitySensorCard(s,i);});
+document.getElementById('regular-sensor-cards').innerHTML=reg||"<div style='background:#e3f2fd;border:1px solid #90caf9;padding:10px;margin:10px 0;border-radius:4px'><p><strong>INFO: No regular sensors configured yet.</strong></p><p>Use the Add New Regular Sensor button below to add regular sensors like Level, Flow-Meter, Energy, etc.</p></div>";
+document.getElementById('quality-sensor-cards').innerHTML=qual||"<div style='background:#fff3cd;border:1px solid #ffeaa7;padding:10px;margin:10px 0;border-radius:4px'><p><strong>INFO: No water quality sensors configured yet.</strong></p><p>Use the Add New Water Quality Sensor button below to add water quality sensors like pH, TDS, Temperature, etc.</p></div>";
+document.getElementById('no-sensors-notice').style.display=sensors.length?'none':'block';}
+function applyConfigFields(fields,root){
+Object.keys(fields).forEach(function(name){
+var v=fields[name];
+Array.prototype.forEach.call(root.querySelectorAll('[name="'+name+'"]'),function(el){
+if(el.type==='radio')el.checked=(String(v)===el.value);
+else if(el.type==='checkbox')el.checked=!!v;
+else el.value=v;});});}
+// Fill the form fields, counters and sensor cards under root (a section that has
+// just been loaded, or the whole document when the config arrives)
+var portalConfig=null;
+function applyConfig(cfg,root){
+applyConfigFields(cfg.fields,root);
+var counts={sensor_count:cfg.sensors.length,regular_count:0,quality_count:0};
+cfg.sensors.forEach(function(s){if(s.enabled)counts[QUALITY_TYPES.indexOf(s.sensor_type)>=0?'quality_count':'regular_count']++;});
+root.querySelectorAll('[data-cfg]').forEach(function(el){el.textContent=counts[el.getAttribute('data-cfg')];});
+if(document.getElementById('regular-sensor-cards')){
+renderSensorCards(cfg.sensors);
+Object.keys(liveState).forEach(function(k){if(/^s\d+$/.test(k))setLiveText(['live-value-'+k.substring(1)],liveState[k]===null?'-':liveState[k]);});}
+toggleNetworkMode();toggleSDOptions();toggleRTCOptions();}
+function loadConfig(){
+fetch('/api/config',{cache:'no-store'}).then(function(r){if(!r.ok)throw new Error('HTTP '+r.status);return r.json();}).then(function(cfg){
+portalConfig=cfg;
+// sensorData keeps the escaped strings the edit forms splice into their HTML
+sensorData.length=0;
+cfg.sensors.forEach(function(s){
+var d={name:escHtml(s.name),unit_id:escHtml(s.unit_id),slave_id:s.slave_id,register_address:s.register_address,quantity:s.quantity,
+data_type:escHtml(s.data_type),baud_rate:s.baud_rate,parity:s.parity||'none',scale_factor:s.scale_factor,register_type:s.register_type||'HOLDING',
+sensor_type:s.sensor_type||'Flow-Meter',sensor_height:s.sensor_height,max_water_level:s.max_water_level,meter_type:escHtml(s.meter_type)};
+if(s.sensor_type==='QUALITY'){d.sub_sensors=(s.sub_sensors||[]).filter(function(p){return p.enabled;}).map(function(p){
+return {parameter_name:escHtml(p.parameter_name),slave_id:p.slave_id,register_address:p.register_address,quantity:p.quantity,
+data_type:escHtml(p.data_type),scale_factor:p.scale_factor,register_type:escHtml(p.register_type)||'HOLDING'};});}
+sensorData.push(d);});
+sensorCount=cfg.sensors.length;
+applyConfig(cfg,document);
+// Low heap: the gateway left out sub-sensors, fetch the full config again shortly
+if(cfg.degraded)setTimeout(loadConfig,5000);
+}).catch(function(e){console.error('Failed to load configuration:',e);setTimeout(loadConfig,5000);});}
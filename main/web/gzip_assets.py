@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""
+Web Asset Compressor - Gzips the portal assets (index.html, styles.css, app.js)
+at build time so the firmware can serve them with Content-Encoding: gzip.
+
+Output is deterministic (mtime=0), so an unchanged source gives byte-identical
+.gz files and the same ETag. The CRC32 of each .gz is the ETag the firmware
+sends (web_config.c computes the same value with esp_rom_crc32_le), and
+index.html references the other assets as /styles.css?v=<crc> and
+/app.js?v=<crc> so they can be cached as immutable.
+
+Portal sections other than the overview live in sections/<id>.html and are
+fetched by app.js when first opened. index.html holds an empty placeholder
+per section (data-src='/section/<id>'), versioned the same way; each
+fragment is written as section_<id>.html.gz.
+
+Called from main/CMakeLists.txt; can also be run by hand:
+    python gzip_assets.py <web source dir> <output dir>
+"""
+
+import gzip
+import os
+import sys
+import zlib
+
+VERSIONED_ASSETS = ["styles.css", "app.js"]
+
+
+def compress(data):
+    return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def write_file(path, data):
+    with open(path, "wb") as f:
+        f.write(data)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+    src_dir, out_dir = sys.argv[1], sys.argv[2]
+    os.makedirs(out_dir, exist_ok=True)
+
+    with open(os.path.join(src_dir, "index.html"), "rb") as f:
+        index = f.read()
+
+    for name in VERSIONED_ASSETS:
+        with open(os.path.join(src_dir, name), "rb") as f:
+            gz = compress(f.read())
+        write_file(os.path.join(out_dir, name + ".gz"), gz)
+
+        ref = ("/" + name).encode()
+        if index.count(b"'" + ref + b"'") != 1:
+            print(f"gzip_assets: index.html must reference '{ref.decode()}' exactly once")
+            return 1
+        version = "%08x" % (zlib.crc32(gz) & 0xFFFFFFFF)
+        index = index.replace(b"'" + ref + b"'", b"'" + ref + b"?v=" + version.encode() + b"'")
+
+    sections_dir = os.path.join(src_dir, "sections")
+    for fname in sorted(os.listdir(sections_dir)):
+        name, ext = os.path.splitext(fname)
+        if ext != ".html":
+            continue
+        with open(os.path.join(sections_dir, fname), "rb") as f:
+            gz = compress(f.read())
+        write_file(os.path.join(out_dir, "section_" + name + ".html.gz"), gz)
+
+        ref = ("/section/" + name).encode()
+        if index.count(b"'" + ref + b"'") != 1:
+            print(f"gzip_assets: index.html must have one placeholder for '{ref.decode()}'")
+            return 1
+        version = "%08x" % (zlib.crc32(gz) & 0xFFFFFFFF)
+        index = index.replace(b"'" + ref + b"'", b"'" + ref + b"?v=" + version.encode() + b"'")
+
+    write_file(os.path.join(out_dir, "index.html.gz"), compress(index))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
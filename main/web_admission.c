@@ -0,0 +1,193 @@
+/**
+ * web_admission.c - Per-route heap budget gate in front of the URI handlers.
+ *
+ * See web_admission.h. Everything here runs in the httpd task, which serves
+ * one request at a time, so the per-request state needs no locking.
+ */
+
+#include "web_admission.h"
+#include "iot_configs.h"
+#include "perf_trace.h"
+#include "modbus.h"
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "WEB_ADMIT";
+
+typedef struct {
+    const char *uri;          // As registered (string literal), outlives the request
+    esp_err_t (*handler)(httpd_req_t *req);
+    void *user_ctx;
+    const web_route_cost_t *cost;
+} admitted_route_t;
+
+static const web_route_cost_t s_default_cost = { NULL, WEB_ADMIT_DEFAULT_COST, 0, 0 };
+
+static const web_route_cost_t *s_costs = NULL;
+static size_t s_cost_count = 0;
+static admitted_route_t s_routes[WEB_ADMIT_MAX_ROUTES];
+static size_t s_route_count = 0;
+static bool s_degraded = false;   // Current request only
+static web_admission_stats_t s_stats = { .stack_free_min = UINT32_MAX };
+
+void web_admission_init(const web_route_cost_t *costs, size_t count)
+{
+    s_costs = costs;
+    s_cost_count = count;
+}
+
+static const web_route_cost_t *find_cost(const char *uri)
+{
+    for (size_t i = 0; i < s_cost_count; i++) {
+        if (strcmp(s_costs[i].uri, uri) == 0) {
+            return &s_costs[i];
+        }
+    }
+    return &s_default_cost;
+}
+
+static bool fits(uint32_t heap)
+{
+    return esp_get_free_heap_size() >= heap + WEB_ADMIT_HEAP_RESERVE &&
+           heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) >= heap;
+}
+
+static esp_err_t send_503(httpd_req_t *req, const char *body)
+{
+    char retry_after[8];
+    snprintf(retry_after, sizeof(retry_after), "%d", WEB_ADMIT_RETRY_AFTER_S);
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", retry_after);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, body);
+    // The body was never read; drop the connection rather than parse it as the next request
+    return req->content_len > 0 ? ESP_FAIL : ESP_OK;
+}
+
+static esp_err_t reject(httpd_req_t *req, const admitted_route_t *route)
+{
+    const web_route_cost_t *cost = route->cost;
+    s_stats.rejected++;
+    s_stats.last_rejected_uri = route->uri;
+    ESP_LOGW(TAG, "503 %s - needs %lu B, free %lu B, largest block %lu B (%lu rejected)",
+             req->uri, (unsigned long)cost->heap, (unsigned long)esp_get_free_heap_size(),
+             (unsigned long)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT),
+             (unsigned long)s_stats.rejected);
+    return send_503(req, "{\"status\":\"error\",\"message\":\"Gateway is low on memory, retry shortly\"}");
+}
+
+static esp_err_t reject_bus_busy(httpd_req_t *req, const admitted_route_t *route)
+{
+    s_stats.rejected++;
+    s_stats.last_rejected_uri = route->uri;
+    ESP_LOGW(TAG, "503 %s - RS485 bus busy (%lu rejected)", req->uri, (unsigned long)s_stats.rejected);
+    return send_503(req, "{\"status\":\"error\",\"message\":\"RS485 bus is busy, retry shortly\"}");
+}
+
+static void check_stack(const admitted_route_t *route)
+{
+    uint32_t free_bytes = uxTaskGetStackHighWaterMark(NULL) * sizeof(StackType_t);
+    if (free_bytes < s_stats.stack_free_min) {
+        s_stats.stack_free_min = free_bytes;
+        s_stats.stack_min_uri = route->uri;
+        if (free_bytes < WEB_ADMIT_STACK_MARGIN) {
+            ESP_LOGW(TAG, "httpd stack down to %lu B free after %s", (unsigned long)free_bytes, route->uri);
+        }
+    }
+}
+
+static esp_err_t admission_gate(httpd_req_t *req)
+{
+    admitted_route_t *route = (admitted_route_t *)req->user_ctx;
+    const web_route_cost_t *cost = route->cost;
+    int64_t start = perf_start();
+
+    s_degraded = false;
+    if (!(cost->flags & WEB_ROUTE_ESSENTIAL) && !fits(cost->heap)) {
+        if ((cost->flags & WEB_ROUTE_DEGRADABLE) && fits(cost->degraded_heap)) {
+            s_degraded = true;
+            s_stats.degraded++;
+        } else {
+            // Wait briefly - MQTT/TLS usually hands its buffers back within a publish cycle
+            int waited = 0;
+            while (waited < WEB_ADMIT_QUEUE_MS && !fits(cost->heap)) {
+                vTaskDelay(pdMS_TO_TICKS(WEB_ADMIT_POLL_MS));
+                waited += WEB_ADMIT_POLL_MS;
+            }
+            if (!fits(cost->heap)) {
+                esp_err_t ret = reject(req, route);
+                perf_end(PERF_HTTPD, start);
+                return ret;
+            }
+            s_stats.queued++;
+        }
+    }
+    // Bus routes run as one RS485 transaction - the telemetry task waits in between sensors
+    bool bus = (cost->flags & WEB_ROUTE_RS485) != 0;
+    if (bus && !modbus_bus_lock(MODBUS_BUS_LOCK_TIMEOUT_MS)) {
+        s_degraded = false;
+        esp_err_t ret = reject_bus_busy(req, route);
+        perf_end(PERF_HTTPD, start);
+        return ret;
+    }
+    if (!s_degraded) {
+        s_stats.served++;
+    }
+
+    req->user_ctx = route->user_ctx;
+    esp_err_t ret = route->handler(req);
+    if (bus) {
+        modbus_bus_unlock();
+    }
+    s_degraded = false;
+    check_stack(route);
+    perf_end(PERF_HTTPD, start);
+    return ret;
+}
+
+esp_err_t web_admission_register(httpd_handle_t server, const httpd_uri_t *uri)
+{
+    if (s_route_count >= WEB_ADMIT_MAX_ROUTES) {
+        ESP_LOGE(TAG, "No admission slot for %s - raise WEB_HTTPD_MAX_URI_HANDLERS", uri->uri);
+        return ESP_ERR_NO_MEM;
+    }
+    admitted_route_t *route = &s_routes[s_route_count];
+    route->uri = uri->uri;
+    route->handler = uri->handler;
+    route->user_ctx = uri->user_ctx;
+    route->cost = find_cost(uri->uri);
+
+    httpd_uri_t wrapped = *uri;
+    wrapped.handler = admission_gate;
+    wrapped.user_ctx = route;
+    esp_err_t ret = httpd_register_uri_handler(server, &wrapped);
+    if (ret == ESP_OK) {
+        s_route_count++;
+    }
+    return ret;
+}
+
+bool web_admission_degraded(httpd_req_t *req)
+{
+    (void)req;
+    return s_degraded;
+}
+
+void web_admission_reset(void)
+{
+    s_route_count = 0;
+    s_degraded = false;
+}
+
+void web_admission_get_stats(web_admission_stats_t *stats)
+{
+    *stats = s_stats;
+}
@@ -0,0 +1,90 @@
+/**
+ * web_admission.h - Heap-budget admission control for the portal's httpd.
+ *
+ * The portal shares a small heap with MQTT/TLS. Instead of the memory monitor
+ * tearing the whole server down under pressure, every URI handler is wrapped
+ * by a gate that checks the route's declared worst-case heap cost against the
+ * current free heap (and largest free block) before the handler runs:
+ *
+ *   serve      free - cost >= WEB_ADMIT_HEAP_RESERVE
+ *   degraded   the route has a cheaper variant that fits (web_admission_degraded())
+ *   queue      wait up to WEB_ADMIT_QUEUE_MS for heap to come back (TLS buffers
+ *              are usually released within a few hundred ms)
+ *   reject     503 with Retry-After, the request never allocates
+ *
+ * Essential routes (reboot, watchdog, OTA cancel) are always served so the
+ * device stays recoverable. The httpd task runs handlers one at a time, so the
+ * current request is the only one in flight and the budget is simply free heap.
+ *
+ * RS485 routes (sensor tests, register reads and writes) also own the Modbus
+ * bus while they run, so their baud rate changes, requests and reads of the
+ * shared response buffer never interleave with telemetry polling.
+ *
+ * Costs are declared once in a table (web_config.c); a route without an entry
+ * gets WEB_ADMIT_DEFAULT_COST. After each handler the httpd task's stack high
+ * water mark is checked, so a route that outgrows its stack budget is named
+ * in the log before it overflows.
+ */
+
+#ifndef WEB_ADMISSION_H
+#define WEB_ADMISSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEB_ROUTE_ESSENTIAL  (1 << 0)   // Always served - small, needed to recover the device
+#define WEB_ROUTE_DEGRADABLE (1 << 1)   // Handler checks web_admission_degraded()
+#define WEB_ROUTE_RS485      (1 << 2)   // Handler runs holding modbus_bus_lock(); 503 if the bus stays busy
+
+typedef struct {
+    const char *uri;
+    uint32_t heap;            // Worst-case transient heap of the handler, bytes
+    uint32_t degraded_heap;   // Same for the degraded variant (WEB_ROUTE_DEGRADABLE)
+    uint8_t flags;
+} web_route_cost_t;
+
+typedef struct {
+    uint32_t served;
+    uint32_t degraded;
+    uint32_t queued;          // Served after waiting for heap
+    uint32_t rejected;        // 503
+    uint32_t stack_free_min;  // Lowest httpd stack high water mark seen, bytes
+    const char *stack_min_uri;
+    const char *last_rejected_uri;
+} web_admission_stats_t;
+
+/**
+ * Set the route cost table. Call before the first web_admission_register();
+ * the table must stay valid while the server runs.
+ */
+void web_admission_init(const web_route_cost_t *costs, size_t count);
+
+/**
+ * httpd_register_uri_handler() with the handler wrapped by the admission gate.
+ * The handler still sees its own user_ctx.
+ */
+esp_err_t web_admission_register(httpd_handle_t server, const httpd_uri_t *uri);
+
+/**
+ * Inside a handler: true if only the degraded variant fits right now.
+ */
+bool web_admission_degraded(httpd_req_t *req);
+
+/**
+ * Forget all wrapped routes. Call after httpd_stop().
+ */
+void web_admission_reset(void);
+
+void web_admission_get_stats(web_admission_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEB_ADMISSION_H
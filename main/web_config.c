@@ -4,8 +4,14 @@
 
 #include "web_config.h"
 #include "web_wake.h"
+#include "web_push.h"
+#include "web_admission.h"
 #include "modbus.h"
 #include "sensor_manager.h"
+#include "telemetry_codec.h"
+#include "body_parser.h"
+#include "modbus_dump.h"
+#include "gateway_status.h"
 #include "iot_configs.h"  // For hardcoded values
 #include "esp_wifi.h"
 #include "esp_event.h"
@@ -22,6 +28,8 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
 #include "esp_timer.h"
 #include "esp_heap_caps.h"
 #include "a7670c_ppp.h"
@@ -38,8 +46,12 @@
 #include "esp_mac.h"
 #include "esp_ota_ops.h"
 #include "ota_update.h"
+#include "ota_peer.h"
+#include "dlog.h"
+#include "perf_trace.h"
 #include "driver/gpio.h"
 #include "esp_task_wdt.h"
+#include "esp_rom_crc.h"
 
 // Define MIN macro if not available
 #ifndef MIN
@@ -90,15 +102,25 @@ typedef struct {
 static sim_test_status_t g_sim_test_status = {0};
 static SemaphoreHandle_t g_sim_test_mutex = NULL;
 
-// HTML templates - loaded from embedded file (main/web/index.html)
-extern const uint8_t index_html_start[] asm("_binary_index_html_start");
-extern const uint8_t index_html_end[] asm("_binary_index_html_end");
-
-// html_header now points to the embedded index.html file
-// This replaces the 650-line C string literal that was here before
-
-// Legacy html_header compatibility - original started here:
-// "<!DOCTYPE html><html><head>"
+// Portal assets - gzipped at build time from main/web/ by web/gzip_assets.py
+extern const uint8_t index_html_gz_start[] asm("_binary_index_html_gz_start");
+extern const uint8_t index_html_gz_end[] asm("_binary_index_html_gz_end");
+extern const uint8_t styles_css_gz_start[] asm("_binary_styles_css_gz_start");
+extern const uint8_t styles_css_gz_end[] asm("_binary_styles_css_gz_end");
+extern const uint8_t app_js_gz_start[] asm("_binary_app_js_gz_start");
+extern const uint8_t app_js_gz_end[] asm("_binary_app_js_gz_end");
+extern const uint8_t section_wifi_html_gz_start[] asm("_binary_section_wifi_html_gz_start");
+extern const uint8_t section_wifi_html_gz_end[] asm("_binary_section_wifi_html_gz_end");
+extern const uint8_t section_azure_html_gz_start[] asm("_binary_section_azure_html_gz_start");
+extern const uint8_t section_azure_html_gz_end[] asm("_binary_section_azure_html_gz_end");
+extern const uint8_t section_sensors_html_gz_start[] asm("_binary_section_sensors_html_gz_start");
+extern const uint8_t section_sensors_html_gz_end[] asm("_binary_section_sensors_html_gz_end");
+extern const uint8_t section_write_ops_html_gz_start[] asm("_binary_section_write_ops_html_gz_start");
+extern const uint8_t section_write_ops_html_gz_end[] asm("_binary_section_write_ops_html_gz_end");
+extern const uint8_t section_ota_html_gz_start[] asm("_binary_section_ota_html_gz_start");
+extern const uint8_t section_ota_html_gz_end[] asm("_binary_section_ota_html_gz_end");
+extern const uint8_t section_monitoring_html_gz_start[] asm("_binary_section_monitoring_html_gz_start");
+extern const uint8_t section_monitoring_html_gz_end[] asm("_binary_section_monitoring_html_gz_end");
 
 static const char* html_footer = "</div></div></body></html>";
 
@@ -594,6 +616,7 @@ static esp_err_t save_sim_config_handler(httpd_req_t *req);
 static esp_err_t save_sd_config_handler(httpd_req_t *req);
 static esp_err_t save_rtc_config_handler(httpd_req_t *req);
 static esp_err_t api_modbus_poll_handler(httpd_req_t *req);
+static esp_err_t api_modbus_dump_handler(httpd_req_t *req);
 static esp_err_t api_sim_test_handler(httpd_req_t *req);
 static esp_err_t api_sim_test_status_handler(httpd_req_t *req);
 static esp_err_t api_sd_status_handler(httpd_req_t *req);
@@ -738,53 +761,171 @@ static esp_err_t wifi_scan_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-// Live data handler
+// Adds the sub-parameters a QUALITY-type read actually returned
+static void live_data_add_quality(cJSON *item, const quality_params_t *q)
+{
+    const struct { const char *key; bool valid; double value; } params[] = {
+        { "ph", q->ph_valid, q->ph_value },
+        { "tds", q->tds_valid, q->tds_value },
+        { "temp", q->temp_valid, q->temp_value },
+        { "humidity", q->humidity_valid, q->humidity_value },
+        { "tss", q->tss_valid, q->tss_value },
+        { "bod", q->bod_valid, q->bod_value },
+        { "cod", q->cod_valid, q->cod_value },
+        { "hardness", q->hardness_valid, q->hardness_value },
+    };
+    cJSON *quality = NULL;
+    for (size_t p = 0; p < sizeof(params) / sizeof(params[0]); p++) {
+        if (!params[p].valid || !isfinite(params[p].value)) {
+            continue;
+        }
+        if (!quality) {
+            quality = cJSON_AddObjectToObject(item, "quality");
+        }
+        cJSON_AddNumberToObject(quality, params[p].key, params[p].value);
+    }
+}
+
+// ok: last read good and recent / stale: good value, but old or last read failed
+// error: never read successfully / pending: not read yet / disabled
+static const char *live_data_status(const sensor_config_t *sensor, const sensor_latest_t *latest,
+                                    int64_t age_ms, int64_t stale_ms)
+{
+    if (!sensor->enabled) {
+        return "disabled";
+    } else if (latest->updated_us == 0) {
+        return "pending";
+    } else if (!latest->has_value) {
+        return "error";
+    } else if (!latest->valid || (stale_ms > 0 && age_ms > stale_ms)) {
+        return "stale";
+    }
+    return "ok";
+}
+
+// Live data handler - latest readings from the sensor_manager cache, never the RS485 bus.
+// The (weak) ETag changes with every new reading, sensor config change, since=
+// value or sensor turning stale, so a refresh loop sending If-None-Match mostly
+// gets 304s but still sees a sensor go stale once readings stop. age_ms and the
+// timestamps are not part of it. since=<version> (the "version" of the previous
+// response) returns only the sensors updated after it.
 static esp_err_t live_data_handler(httpd_req_t *req)
 {
-    char response[1024];
+    system_config_t *config = get_system_config();
+    uint32_t version = sensor_latest_version();
+    int64_t now_us = esp_timer_get_time();
+    int64_t stale_ms = (int64_t)config->telemetry_interval * 1000 * LIVE_DATA_STALE_INTERVALS;
+
+    uint32_t since = 0;
+    char query[32], param[12];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+        httpd_query_key_value(query, "since", param, sizeof(param)) == ESP_OK) {
+        since = strtoul(param, NULL, 10);
+    }
+
+    // Status only changes with time by going stale - one bit per stale sensor
+    uint32_t stale_mask = 0;
+    for (int i = 0; i < config->sensor_count && i < SENSOR_LATEST_SLOTS; i++) {
+        sensor_latest_t latest;
+        sensor_latest_get(i, &latest);
+        int64_t age_ms = latest.has_value ? (now_us - latest.good_us) / 1000 : -1;
+        if (strcmp(live_data_status(&config->sensors[i], &latest, age_ms, stale_ms), "stale") == 0) {
+            stale_mask |= 1u << i;
+        }
+    }
+
+    char etag[48];
+    uint32_t config_crc = esp_rom_crc32_le(0, (const uint8_t *)config->sensors,
+                                           sizeof(config->sensors[0]) * config->sensor_count);
+    snprintf(etag, sizeof(etag), "W/\"%" PRIx32 "-%08" PRIx32 "-%" PRIx32 "-%" PRIx32 "\"",
+             version, config_crc, since, stale_mask);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    // Weak comparison: match the quoted tag with or without the W/ prefix
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, etag + 2) != NULL) {
+        httpd_resp_set_hdr(req, "ETag", etag);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    // Low heap: no quality blocks, and no ETag so the cut-down reply is not revalidated as current
+    bool degraded = web_admission_degraded(req);
+    if (!degraded) {
+        httpd_resp_set_hdr(req, "ETag", etag);
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+
     time_t now = time(NULL);
     struct tm timeinfo;
-    char timestamp[64];
-    
+    char timestamp[32];
     gmtime_r(&now, &timeinfo);
     strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &timeinfo);
-    
-    // Get system configuration for real sensor data
-    system_config_t* config = get_system_config();
-    
-    // Start JSON response
-    snprintf(response, sizeof(response), 
-        "{\"timestamp\":\"%s\",\"sensors\":[", timestamp);
-    
-    // Add configured sensors with simulated or real data
-    for (int i = 0; i < config->sensor_count && i < 8; i++) {
-        if (config->sensors[i].enabled) {
-            char sensor_data[200];
-            float simulated_value = 100.0 + (esp_random() % 5000) / 100.0;
-            
-            snprintf(sensor_data, sizeof(sensor_data),
-                "%s{\"name\":\"%s\",\"unit_id\":\"%s\",\"value\":%.2f,\"slave_id\":%d,\"register\":%d,\"status\":\"simulated\"}",
-                (strlen(response) > 50) ? "," : "",
-                config->sensors[i].name,
-                config->sensors[i].unit_id,
-                simulated_value,
-                config->sensors[i].slave_id,
-                config->sensors[i].register_address
-            );
-            strncat(response, sensor_data, sizeof(response) - strlen(response) - 1);
+
+    cJSON_AddStringToObject(root, "timestamp", timestamp);
+    cJSON_AddNumberToObject(root, "uptime_ms", (double)(now_us / 1000));
+    cJSON_AddNumberToObject(root, "version", version);
+    cJSON_AddBoolToObject(root, "partial", since != 0);
+    if (degraded) {
+        cJSON_AddBoolToObject(root, "degraded", true);
+    }
+    cJSON *sensors = cJSON_AddArrayToObject(root, "sensors");
+
+    for (int i = 0; i < config->sensor_count && i < SENSOR_LATEST_SLOTS; i++) {
+        const sensor_config_t *sensor = &config->sensors[i];
+        sensor_latest_t latest;
+        sensor_latest_get(i, &latest);
+        if (since != 0 && latest.version <= since) {
+            continue;
+        }
+
+        int64_t age_ms = latest.has_value ? (now_us - latest.good_us) / 1000 : -1;
+        const char *status = live_data_status(sensor, &latest, age_ms, stale_ms);
+
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddItemToArray(sensors, item);
+        cJSON_AddNumberToObject(item, "index", i);
+        cJSON_AddStringToObject(item, "name", sensor->name);
+        cJSON_AddStringToObject(item, "unit_id", sensor->unit_id);
+        cJSON_AddStringToObject(item, "sensor_type", sensor->sensor_type);
+        cJSON_AddNumberToObject(item, "slave_id", sensor->slave_id);
+        cJSON_AddNumberToObject(item, "register", sensor->register_address);
+        cJSON_AddStringToObject(item, "status", status);
+        if (latest.has_value && isfinite(latest.value)) {
+            cJSON_AddNumberToObject(item, "value", latest.value);
+            cJSON_AddNumberToObject(item, "age_ms", (double)age_ms);
+        } else {
+            cJSON_AddNullToObject(item, "value");
+            cJSON_AddNullToObject(item, "age_ms");
+        }
+        cJSON_AddBoolToObject(item, "last_read_ok", latest.valid);
+        if (latest.updated_us != 0) {
+            cJSON_AddNumberToObject(item, "read_ms", latest.read_ms);
+            cJSON_AddNumberToObject(item, "attempts", latest.attempts);
+        }
+        cJSON_AddNumberToObject(item, "fail_streak", latest.fail_streak);
+        cJSON_AddNumberToObject(item, "version", latest.version);
+        if (latest.has_value && !degraded) {
+            live_data_add_quality(item, &latest.quality);
         }
     }
-    
-    // If no sensors configured, add placeholder
-    if (config->sensor_count == 0) {
-        strncat(response, "{\"name\":\"No sensors configured\",\"value\":0,\"status\":\"none\"}", 
-                sizeof(response) - strlen(response) - 1);
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!json) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
     }
-    
-    strncat(response, "]}", sizeof(response) - strlen(response) - 1);
-    
+
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, response, strlen(response));
+    httpd_resp_sendstr(req, json);
+    free(json);
     return ESP_OK;
 }
 
@@ -1203,4127 +1344,216 @@ static esp_err_t favicon_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
-// Configuration page HTML
-static esp_err_t config_page_handler(httpd_req_t *req)
+// Portal assets (index.html, styles.css, app.js) are static and gzipped at build
+// time. The browser revalidates index.html with If-None-Match and caches the
+// ?v=-versioned styles.css/app.js for a year, so a repeat visit costs one 304.
+// index.html carries only the overview; the other sections are fragments that
+// app.js fetches from /section/<id>?v=<crc> the first time they are opened.
+typedef struct {
+    const uint8_t *start;
+    const uint8_t *end;
+    const char *content_type;
+    bool versioned;           // Referenced from index.html as ?v=<crc>
+    char etag[11];            // "%08x" of the compressed bytes, computed on first use
+} web_asset_t;
+
+static web_asset_t g_web_assets[] = {
+    { index_html_gz_start, index_html_gz_end, "text/html; charset=UTF-8", false, "" },
+    { styles_css_gz_start, styles_css_gz_end, "text/css", true, "" },
+    { app_js_gz_start, app_js_gz_end, "application/javascript", true, "" },
+};
+#define WEB_ASSET_INDEX  0
+#define WEB_ASSET_STYLES 1
+#define WEB_ASSET_APP    2
+
+typedef struct {
+    const char *id;           // Element id in index.html, /section/<id>
+    web_asset_t asset;
+} web_section_t;
+
+static web_section_t g_web_sections[] = {
+    { "wifi",       { section_wifi_html_gz_start, section_wifi_html_gz_end, "text/html; charset=UTF-8", true, "" } },
+    { "azure",      { section_azure_html_gz_start, section_azure_html_gz_end, "text/html; charset=UTF-8", true, "" } },
+    { "sensors",    { section_sensors_html_gz_start, section_sensors_html_gz_end, "text/html; charset=UTF-8", true, "" } },
+    { "write_ops",  { section_write_ops_html_gz_start, section_write_ops_html_gz_end, "text/html; charset=UTF-8", true, "" } },
+    { "ota",        { section_ota_html_gz_start, section_ota_html_gz_end, "text/html; charset=UTF-8", true, "" } },
+    { "monitoring", { section_monitoring_html_gz_start, section_monitoring_html_gz_end, "text/html; charset=UTF-8", true, "" } },
+};
+
+static const char *web_asset_etag(web_asset_t *asset)
 {
-    // Check available heap before processing - need at least 15KB free
-    size_t free_heap = esp_get_free_heap_size();
-    if (free_heap < 15000) {
-        ESP_LOGW(TAG, "Low memory (%d bytes) - sending minimal page", free_heap);
-        httpd_resp_set_type(req, "text/html");
-        char low_mem_page[512];
-        snprintf(low_mem_page, sizeof(low_mem_page),
-            "<!DOCTYPE html><html><head><title>Low Memory</title></head>"
-            "<body style='font-family:Arial;text-align:center;padding:50px'>"
-            "<h1>&#9888; Low Memory</h1>"
-            "<p>Free heap: <b>%d bytes</b></p>"
-            "<p>Please wait and refresh, or reboot the device.</p>"
-            "<button onclick='location.reload()'>Refresh</button> "
-            "<button onclick=\"fetch('/api/system/reboot',{method:'POST'}).then(()=>alert('Rebooting...'))\">Reboot</button>"
-            "</body></html>", (int)free_heap);
-        httpd_resp_sendstr(req, low_mem_page);
-        return ESP_OK;
+    if (asset->etag[0] == '\0') {
+        // Same CRC32 as zlib.crc32() in gzip_assets.py, which versions the URLs
+        uint32_t crc = esp_rom_crc32_le(0, asset->start, asset->end - asset->start);
+        snprintf(asset->etag, sizeof(asset->etag), "\"%08" PRIx32 "\"", crc);
     }
+    return asset->etag;
+}
 
-    httpd_resp_set_type(req, "text/html; charset=UTF-8");
+static esp_err_t web_asset_send(httpd_req_t *req, web_asset_t *asset)
+{
+    const char *etag = web_asset_etag(asset);
 
-    // Disable caching - ensures form fields always show current config values
-    // Without this, browser shows stale cached data when using back button
-    httpd_resp_set_hdr(req, "Cache-Control", "no-cache, no-store, must-revalidate");
-    httpd_resp_set_hdr(req, "Pragma", "no-cache");
-    httpd_resp_set_hdr(req, "Expires", "0");
-
-    // Track connection state - abort page generation on first send error
-    // Prevents flood of error 128 (ENOTCONN) after client disconnects
-    bool connection_alive = true;
-    #define SEND_OR_ABORT(req, str) do { \
-        if (!connection_alive) goto page_done; \
-        if (httpd_resp_sendstr_chunk(req, str) != ESP_OK) { \
-            ESP_LOGW(TAG, "Client disconnected, aborting page"); \
-            connection_alive = false; \
-            goto page_done; \
-        } \
-    } while(0)
-
-    // Generate escaped values for HTML safety
-    char escaped_ssid[64], escaped_password[128];
-    html_escape(escaped_ssid, g_system_config.wifi_ssid, sizeof(escaped_ssid));
-    html_escape(escaped_password, g_system_config.wifi_password, sizeof(escaped_password));
-
-    // Send HTML header in small pieces to avoid TCP send buffer overflow
-    // Send embedded index.html in chunks (from main/web/index.html)
-    {
-        const char *ptr = (const char *)index_html_start;
-        size_t remaining = (size_t)(index_html_end - index_html_start);
-        while (remaining > 0) {
-            size_t send_len = remaining > 4096 ? 4096 : remaining;
-            if (httpd_resp_send_chunk(req, ptr, send_len) != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to send header (remaining: %d bytes)", (int)remaining);
-                httpd_resp_sendstr_chunk(req, NULL);
-                return ESP_OK;
-            }
-            ptr += send_len;
-            remaining -= send_len;
-        }
-    }
-
-    // Send main form HTML in chunks
-    char chunk[5120];  // Buffer for HTML chunks with dynamic content
-    
-    // Overview Section with Real-time System Resources
-    httpd_resp_sendstr_chunk(req,
-        "<div id='overview' class='section active'>"
-        "<h2 class='section-title'><i>📊</i>System Overview</h2>");
-
-    // Modbus and Azure status cards at the top for immediate visibility
-    httpd_resp_sendstr_chunk(req,
-        "<div class='sensor-card'>"
-        "<h3>Modbus Communication</h3>"
-        "<p><strong>Total Reads:</strong> <span id='ov_modbus_total_reads'>Loading...</span></p>"
-        "<p><strong>Successful:</strong> <span id='ov_modbus_success'>Loading...</span></p>"
-        "<p><strong>Failed:</strong> <span id='ov_modbus_failed'>Loading...</span></p>"
-        "<p><strong>Success Rate:</strong> <span id='ov_modbus_success_rate'>Loading...</span></p>"
-        "<p><strong>CRC Errors:</strong> <span id='ov_modbus_crc_errors'>Loading...</span></p>"
-        "<p><strong>Timeout Errors:</strong> <span id='ov_modbus_timeout_errors'>Loading...</span></p>"
-        "</div>"
-
-        "<div class='sensor-card'>"
-        "<h3>Azure IoT Hub</h3>"
-        "<p><strong>Connection:</strong> <span id='ov_azure_connection'>Loading...</span></p>"
-        "<p><strong>Uptime:</strong> <span id='ov_azure_uptime'>Loading...</span></p>"
-        "<p><strong>Messages Sent:</strong> <span id='ov_azure_messages'>Loading...</span></p>"
-        "<p><strong>Last Telemetry:</strong> <span id='ov_azure_last_telemetry'>Loading...</span></p>"
-        "<p><strong>Reconnects:</strong> <span id='ov_azure_reconnects'>Loading...</span></p>"
-        "<p><strong>Device ID:</strong> <span id='ov_azure_device_id'>Loading...</span></p>"
-        "</div>"
-
-        "<div class='sensor-card'>"
-        "<h3>System Status</h3>"
-        "<p><strong>Firmware:</strong> <span>v1.1.0-final</span></p>"
-        "<p><strong>MAC Address:</strong> <span id='mac_address'>Loading...</span></p>"
-        "<p><strong>Uptime:</strong> <span id='uptime'>Loading...</span></p>"
-        "<p><strong>Flash Memory:</strong> <span id='flash_total'>Loading...</span></p>"
-        "<p><strong>Active Tasks:</strong> <span id='tasks'>Loading...</span></p>"
-        "</div>"
-
-        "<div class='sensor-card'>"
-        "<h3>Memory Usage</h3>"
-        "<p><strong>Heap Usage:</strong> <span id='heap_usage'>Loading...</span></p>"
-        "<p><strong>Free Heap:</strong> <span id='heap'>Loading...</span></p>"
-        "<p><strong>Internal RAM:</strong> <span id='internal_heap'>Loading...</span></p>"
-        "<p><strong>SPIRAM:</strong> <span id='spiram_heap'>Loading...</span></p>"
-        "<p><strong>Largest Block:</strong> <span id='largest_block'>Loading...</span></p>"
-        "</div>"
-
-        "<div class='sensor-card'>"
-        "<h3>Storage Partitions</h3>"
-        "<p><strong>App Partition:</strong> <span id='app_partition'>Loading...</span></p>"
-        "<p><strong>NVS Partition:</strong> <span id='nvs_partition'>Loading...</span></p>"
-        "</div>");
-
-    // Network Status - show WiFi or SIM based on network mode
-    snprintf(chunk, sizeof(chunk),
-        "<div class='sensor-card' id='wifi-network-status' style='display:%s'>"
-        "<h3>WiFi Network Status</h3>"
-        "<p><strong>WiFi Status:</strong> <span id='wifi_status'>Loading...</span></p>"
-        "<p><strong>WiFi RSSI:</strong> <span id='rssi'>Loading...</span></p>"
-        "<p><strong>SSID:</strong> <span id='ssid'>Loading...</span></p>"
-        "</div>"
-
-        "<div class='sensor-card' id='sim-network-status' style='display:%s'>"
-        "<h3>SIM Network Status</h3>"
-        "<p><strong>SIM Status:</strong> <span id='sim_status'>Loading...</span></p>"
-        "<p><strong>Signal Quality:</strong> <span id='sim_signal'>Loading...</span></p>"
-        "<p><strong>Network:</strong> <span id='sim_network'>Loading...</span></p>"
-        "<p><strong>IP Address:</strong> <span id='sim_ip'>Loading...</span></p>"
-        "</div>",
-        g_system_config.network_mode == 0 ? "block" : "none",
-        g_system_config.network_mode == 1 ? "block" : "none");
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    httpd_resp_sendstr_chunk(req,
-        "<div class='sensor-card'>"
-        "<h3>Industrial Configuration</h3>");
-
-    snprintf(chunk, sizeof(chunk),
-        "<p><strong>Sensors Configured:</strong> <span>%d</span></p>"
-        "<p><strong>RS485 Interface:</strong> <span>GPIO16(RX), GPIO17(TX), GPIO4(RTS)</span></p>"
-        "<p><strong>Modbus Protocol:</strong> <span>RTU over RS485</span></p>"
-        "<p><strong>Supported Baud Rates:</strong> <span>2400-230400 bps</span></p>"
-        "<p><strong>Supported Data Types:</strong> <span>UINT16, INT16, UINT32, INT32, FLOAT32 (All byte orders)</span></p>"
-        "</div>",
-        g_system_config.sensor_count);
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    SEND_OR_ABORT(req, "</div>");
-
-    // Network Mode Selection Section (main WiFi config section)
-    snprintf(chunk, sizeof(chunk),
-        "<div id='wifi' class='section'>"
-        "<h2 class='section-title'><i>🌐</i>Network Configuration</h2>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-top:0;margin-bottom:20px;color:#007bff;font-size:20px'>Network Connectivity Mode</h3>"
-        "<p style='color:#666;margin-bottom:25px;text-align:center;font-size:14px'>Choose your network connectivity method</p>"
-        "<form id='network_mode_form' onsubmit='return saveNetworkMode(event)'>"
-        "<div style='display:flex;justify-content:center;gap:20px;margin-bottom:25px'>"
-        "<label style='display:flex;align-items:center;cursor:pointer;padding:15px 25px;border:2px solid #e0e0e0;border-radius:8px;background:#f8f9fa;transition:all 0.3s'>"
-        "<input type='radio' name='network_mode' value='0' id='mode_wifi' %s onchange='toggleNetworkMode()' style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "<span style='font-weight:600;font-size:15px'>WiFi</span>"
-        "</label>"
-        "<label style='display:flex;align-items:center;cursor:pointer;padding:15px 25px;border:2px solid #e0e0e0;border-radius:8px;background:#f8f9fa;transition:all 0.3s'>"
-        "<input type='radio' name='network_mode' value='1' id='mode_sim' %s onchange='toggleNetworkMode()' style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "<span style='font-weight:600;font-size:15px'>SIM Module (4G)</span>"
-        "</label>"
-        "</div>"
-        "<div id='network_mode_result' style='display:none;padding:12px;margin:15px 0;border-radius:6px'></div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='submit' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save Network Mode</button>"
-        "</div>"
-        "</form>"
-        "</div>",  // Close sensor-card only, NOT the main id='wifi' section
-        g_system_config.network_mode == 0 ? "checked" : "",
-        g_system_config.network_mode == 1 ? "checked" : "");
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // WiFi Configuration Section with Enhanced Layout (wrapped for conditional display)
-    snprintf(chunk, sizeof(chunk),
-        "<div id='wifi_panel' style='display:%s'>"
-        "<div>"
-        "<h2 class='section-title'><i>📡</i>WiFi Settings</h2>"
-        "<form onsubmit='return saveWiFiConfig()'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-top:0;margin-bottom:20px;color:#007bff;font-size:20px'>WiFi Network Configuration</h3>"
-        "<div style='text-align:center;margin-bottom:20px'>"
-        "<button type='button' class='scan-button' onclick='scanWiFi()' style='background:linear-gradient(135deg,#38b2ac,#48bb78);color:white;padding:12px 25px;border:none;border-radius:6px;font-weight:bold;cursor:pointer;font-size:15px;box-shadow:0 2px 8px rgba(56,178,172,0.3)'>📡 Scan WiFi Networks</button>"
-        "</div>"
-        "<div id='scan-status' style='color:#666;font-size:13px;margin-bottom:10px;text-align:center'></div>"
-        "<div id='networks' style='display:none;border:1px solid #e0e0e0;border-radius:8px;margin-bottom:20px;background:#f8f9fa;max-height:200px;overflow-y:auto'></div>"
-        "<div style='display:grid;grid-template-columns:120px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>Network:</label>"
-        "<input type='text' id='wifi_ssid' name='wifi_ssid' value='%s' required style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<label style='font-weight:600;padding-top:10px'>Password:</label>"
-        "<div style='position:relative'>"
-        "<input type='password' id='wifi_password' name='wifi_password' value='%s' style='width:100%%;padding:10px;padding-right:60px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<span onclick='togglePassword()' style='position:absolute;right:10px;top:50%%;transform:translateY(-50%%);cursor:pointer;color:#007bff;font-size:12px;font-weight:600;user-select:none;padding:4px 8px;background:#f0f8ff;border-radius:4px'>SHOW</span>"
-        "</div>"
-        "</div>"
-        "<div id='wifi_save_result' style='display:none;padding:12px;border-radius:6px;margin-bottom:15px;text-align:center'></div>"
-        "<div style='background:#e8f4f8;padding:var(--space-sm);border-radius:var(--radius-sm);margin-top:var(--space-md);border-left:4px solid #17a2b8'>"
-        "<small style='color:#0c5460'><strong>💡 Tip:</strong> Click on any scanned network to auto-fill the SSID field.</small>"
-        "</div>"
-        "<div style='margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center'>"
-        "<button type='submit' id='wifi_save_btn' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:600;cursor:pointer;font-size:16px;box-shadow:0 2px 4px rgba(0,0,0,0.1)'>Save & Connect</button>"
-        "<p style='color:#666;font-size:12px;margin-top:10px'>Saves WiFi settings and connects to the network.</p>"
-        "</div>"
-        "</div>",
-        g_system_config.network_mode == 0 ? "block" : "none",
-        escaped_ssid, escaped_password);
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // Close WiFi form section
-    snprintf(chunk, sizeof(chunk),
-        "</form>"
-        "</div>"
-        "</div>");  // Close wifi section and wifi_panel wrapper
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // SIM Configuration Panel - Part 1: Cellular Network Settings
-    snprintf(chunk, sizeof(chunk),
-        "<div id='sim_panel' style='display:%s'>"
-        "<div>"
-        "<h2 class='section-title'><i>📱</i>SIM Module Configuration (A7670C)</h2>"
-        "<form onsubmit='return saveSIMConfig()'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-top:0;margin-bottom:20px;color:#007bff;font-size:20px'>Cellular Network Settings</h3>"
-        "<p style='color:#666;margin-bottom:25px;text-align:center;font-size:14px'>Configure 4G cellular connectivity</p>"
-        "<div style='display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>APN (Access Point Name):</label>"
-        "<div>"
-        "<input type='text' id='sim_apn' name='sim_apn' value='%s' placeholder='airteliot' maxlength='63' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Default: airteliot (Airtel) | Use jionet for Jio SIM</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>APN Username:</label>"
-        "<div>"
-        "<input type='text' id='sim_apn_user' name='sim_apn_user' value='%s' placeholder='username' maxlength='63' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Leave blank if not required by carrier</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>APN Password:</label>"
-        "<div>"
-        "<input type='password' id='sim_apn_pass' name='sim_apn_pass' value='%s' maxlength='63' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Leave blank if not required by carrier</small>"
-        "</div>"
-        "</div>"
-        "</div>",
-        g_system_config.network_mode == 1 ? "block" : "none",
-        g_system_config.sim_config.apn,
-        g_system_config.sim_config.apn_user,
-        g_system_config.sim_config.apn_pass);
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // SIM Configuration Panel - Part 2: Hardware Configuration
-    snprintf(chunk, sizeof(chunk),
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#17a2b8'>Hardware Configuration</h3>"
-        "<div style='display:grid;grid-template-columns:120px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>UART Port:</label>"
-        "<div>"
-        "<select id='sim_uart' name='sim_uart' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px;background:white'>"
-        "<option value='1' %s>UART1</option>"
-        "<option value='2' %s>UART2</option>"
-        "</select>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>TX Pin:</label>"
-        "<div>"
-        "<input type='number' id='sim_tx_pin' name='sim_tx_pin' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>GPIO for UART TX</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>RX Pin:</label>"
-        "<div>"
-        "<input type='number' id='sim_rx_pin' name='sim_rx_pin' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>GPIO for UART RX</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Power Pin:</label>"
-        "<div>"
-        "<input type='number' id='sim_pwr_pin' name='sim_pwr_pin' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>GPIO for module power</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Reset Pin:</label>"
-        "<div>"
-        "<input type='number' id='sim_reset_pin' name='sim_reset_pin' value='%d' min='-1' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>-1 to disable (GPIO 15 used by SD card)</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Baud Rate:</label>"
-        "<select id='sim_baud' name='sim_baud' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px;background:white'>"
-        "<option value='9600' %s>9600</option>"
-        "<option value='19200' %s>19200</option>"
-        "<option value='38400' %s>38400</option>"
-        "<option value='57600' %s>57600</option>"
-        "<option value='115200' %s>115200</option>"
-        "</select>"
-        "</div>"
-        "<div style='text-align:center;margin-top:25px'>"
-        "<button type='button' onclick='testSIMConnection()' style='background:#17a2b8;color:white;padding:12px 25px;border:none;border-radius:6px;font-weight:bold;cursor:pointer;font-size:15px'>Test SIM Connection</button>"
-        "</div>"
-        "<div id='sim_test_result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='submit' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save SIM Configuration</button>"
-        "<p style='color:#666;font-size:12px;margin:10px 0 0 0'>This saves SIM module settings.</p>"
-        "</div>"
-        "<div id='sim_save_result' style='margin-top:10px;padding:10px;border-radius:4px;display:none;border:1px solid'></div>"
-        "</div>"
-        "</form>"
-        "</div>"
-        "</div>",
-        g_system_config.sim_config.uart_num == 1 ? "selected" : "",
-        g_system_config.sim_config.uart_num == 2 ? "selected" : "",
-        g_system_config.sim_config.uart_tx_pin,
-        g_system_config.sim_config.uart_rx_pin,
-        g_system_config.sim_config.pwr_pin,
-        g_system_config.sim_config.reset_pin,
-        g_system_config.sim_config.uart_baud_rate == 9600 ? "selected" : "",
-        g_system_config.sim_config.uart_baud_rate == 19200 ? "selected" : "",
-        g_system_config.sim_config.uart_baud_rate == 38400 ? "selected" : "",
-        g_system_config.sim_config.uart_baud_rate == 57600 ? "selected" : "",
-        g_system_config.sim_config.uart_baud_rate == 115200 ? "selected" : "");
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // SD Card Configuration Panel
-    snprintf(chunk, sizeof(chunk),
-        "<div id='sd_panel'>"
-        "<h2 class='section-title'><i>💾</i>SD Card Configuration</h2>"
-        "<form onsubmit='return saveSDConfig()'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-top:0;margin-bottom:20px;color:#007bff;font-size:20px'>Offline Message Caching</h3>"
-        "<p style='color:#666;margin-bottom:25px;text-align:center;font-size:14px'>Enable offline message caching during network outages</p>"
-        "<div style='display:flex;align-items:center;justify-content:center;padding:15px;background:#f0f8ff;border-radius:8px;margin-bottom:15px'>"
-        "<label for='sd_enabled' style='display:flex;align-items:center;justify-content:center;font-weight:600;font-size:16px;cursor:pointer;margin:0'>"
-        "<input type='checkbox' id='sd_enabled' name='sd_enabled' value='1' %s onchange='toggleSDOptions()' style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "Enable SD Card</label>"
-        "</div>"
-        "<div id='sd_options' style='display:%s;margin-top:15px'>"
-        "<div style='display:flex;align-items:center;justify-content:center;padding:15px;background:#e8f4f8;border-radius:8px'>"
-        "<label for='sd_cache_on_failure' style='display:flex;align-items:center;justify-content:center;font-size:15px;cursor:pointer;margin:0'>"
-        "<input type='checkbox' id='sd_cache_on_failure' name='sd_cache_on_failure' value='1' %s style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "Cache Messages When Network Unavailable</label>"
-        "</div>"
-        "</div>"
-        "</div>"
-        "<div id='sd_hw_options' style='display:%s'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#17a2b8'>SPI Pin Configuration</h3>"
-        "<div style='display:grid;grid-template-columns:120px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>MOSI Pin:</label>"
-        "<div>"
-        "<input type='number' id='sd_mosi' name='sd_mosi' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>SPI Master Out Slave In</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>MISO Pin:</label>"
-        "<div>"
-        "<input type='number' id='sd_miso' name='sd_miso' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>SPI Master In Slave Out</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>CLK Pin:</label>"
-        "<div>"
-        "<input type='number' id='sd_clk' name='sd_clk' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>SPI Clock</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>CS Pin:</label>"
-        "<div>"
-        "<input type='number' id='sd_cs' name='sd_cs' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Chip Select</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>SPI Host:</label>"
-        "<div>"
-        "<select id='sd_spi_host' name='sd_spi_host' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px;background:white'>"
-        "<option value='1' %s>HSPI (SPI2)</option>"
-        "<option value='2' %s>VSPI (SPI3)</option>"
-        "</select>"
-        "</div>"
-        "</div>"
-        "<div style='display:flex;gap:10px;margin-top:20px;flex-wrap:wrap;justify-content:center'>"
-        "<button type='button' onclick='checkSDStatus()' style='background:#17a2b8;color:white;padding:12px 20px;border:none;border-radius:6px;font-weight:bold;min-width:150px;cursor:pointer'>Check SD Card Status</button>"
-        "<button type='button' onclick='replayCachedMessages()' style='background:#ffc107;color:#333;padding:12px 20px;border:none;border-radius:6px;font-weight:bold;min-width:150px;cursor:pointer'>Replay Cached Messages</button>"
-        "<button type='button' onclick='clearCachedMessages()' style='background:#dc3545;color:white;padding:12px 20px;border:none;border-radius:6px;font-weight:bold;min-width:150px;cursor:pointer'>Clear All Cached Messages</button>"
-        "</div>"
-        "<div id='sd_status_result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='submit' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save SD Card Configuration</button>"
-        "<div id='sd_save_result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "</div>"
-        "</div>"
-        "</div>"
-        "</form>"
-        "</div>",
-        g_system_config.sd_config.enabled ? "checked" : "",
-        g_system_config.sd_config.enabled ? "block" : "none",
-        g_system_config.sd_config.cache_on_failure ? "checked" : "",
-        g_system_config.sd_config.enabled ? "block" : "none",
-        g_system_config.sd_config.mosi_pin,
-        g_system_config.sd_config.miso_pin,
-        g_system_config.sd_config.clk_pin,
-        g_system_config.sd_config.cs_pin,
-        g_system_config.sd_config.spi_host == 1 ? "selected" : "",
-        g_system_config.sd_config.spi_host == 2 ? "selected" : "");
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // RTC Configuration Panel
-    snprintf(chunk, sizeof(chunk),
-        "<div id='rtc_panel'>"
-        "<h2 class='section-title'><i>🕐</i>Real-Time Clock (DS3231)</h2>"
-        "<form onsubmit='return saveRTCConfig()'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-top:0;margin-bottom:20px;color:#007bff;font-size:20px'>Accurate Timekeeping</h3>"
-        "<p style='color:#666;margin-bottom:25px;text-align:center;font-size:14px'>Maintain accurate time even during network outages</p>"
-        "<div style='display:flex;align-items:center;justify-content:center;padding:15px;background:#f0f8ff;border-radius:8px;margin-bottom:15px'>"
-        "<label for='rtc_enabled' style='display:flex;align-items:center;justify-content:center;font-weight:600;font-size:16px;cursor:pointer;margin:0'>"
-        "<input type='checkbox' id='rtc_enabled' name='rtc_enabled' value='1' %s onchange='toggleRTCOptions()' style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "Enable RTC</label>"
-        "</div>"
-        "<div id='rtc_options' style='display:%s;margin-top:15px'>"
-        "<div style='display:flex;align-items:center;justify-content:center;padding:15px;background:#e8f4f8;border-radius:8px;margin-bottom:10px'>"
-        "<label for='rtc_sync_on_boot' style='display:flex;align-items:center;justify-content:center;font-size:15px;cursor:pointer;margin:0'>"
-        "<input type='checkbox' id='rtc_sync_on_boot' name='rtc_sync_on_boot' value='1' %s style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "Sync System Time from RTC on Boot</label>"
-        "</div>"
-        "<div style='display:flex;align-items:center;justify-content:center;padding:15px;background:#e8f4f8;border-radius:8px'>"
-        "<label for='rtc_update_from_ntp' style='display:flex;align-items:center;justify-content:center;font-size:15px;cursor:pointer;margin:0'>"
-        "<input type='checkbox' id='rtc_update_from_ntp' name='rtc_update_from_ntp' value='1' %s style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "Update RTC from NTP When Online</label>"
-        "</div>"
-        "</div>"
-        "</div>"
-        "<div id='rtc_hw_options' style='display:%s'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#17a2b8'>I2C Pin Configuration</h3>"
-        "<div style='display:grid;grid-template-columns:120px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>SDA Pin:</label>"
-        "<div>"
-        "<input type='number' id='rtc_sda' name='rtc_sda' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>I2C Data Line</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>SCL Pin:</label>"
-        "<div>"
-        "<input type='number' id='rtc_scl' name='rtc_scl' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>I2C Clock Line</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>I2C Port:</label>"
-        "<div>"
-        "<select id='rtc_i2c_num' name='rtc_i2c_num' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px;background:white'>"
-        "<option value='0' %s>I2C_NUM_0</option>"
-        "<option value='1' %s>I2C_NUM_1</option>"
-        "</select>"
-        "</div>"
-        "</div>"
-        "<div style='display:flex;gap:10px;margin-top:20px;flex-wrap:wrap;justify-content:center'>"
-        "<button type='button' onclick='getRTCTime()' style='background:#17a2b8;color:white;padding:12px 20px;border:none;border-radius:6px;font-weight:bold;min-width:150px;cursor:pointer'>Get RTC Time</button>"
-        "<button type='button' onclick='syncRTCFromNTP()' style='background:#ffc107;color:#333;padding:12px 20px;border:none;border-radius:6px;font-weight:bold;min-width:150px;cursor:pointer'>Sync RTC from NTP Now</button>"
-        "<button type='button' onclick='syncSystemFromRTC()' style='background:#6c757d;color:white;padding:12px 20px;border:none;border-radius:6px;font-weight:bold;min-width:150px;cursor:pointer'>Sync System Time from RTC</button>"
-        "</div>"
-        "<div id='rtc_time_result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='submit' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save RTC Configuration</button>"
-        "<div id='rtc_save_result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "</div>"
-        "</div>"
-        "</div>"
-        "</form>"
-        "</div>",
-        g_system_config.rtc_config.enabled ? "checked" : "",
-        g_system_config.rtc_config.enabled ? "block" : "none",
-        g_system_config.rtc_config.sync_on_boot ? "checked" : "",
-        g_system_config.rtc_config.update_from_ntp ? "checked" : "",
-        g_system_config.rtc_config.enabled ? "block" : "none",
-        g_system_config.rtc_config.sda_pin,
-        g_system_config.rtc_config.scl_pin,
-        g_system_config.rtc_config.i2c_num == 0 ? "selected" : "",
-        g_system_config.rtc_config.i2c_num == 1 ? "selected" : "");
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // Configuration Trigger Section
-    snprintf(chunk, sizeof(chunk),
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#17a2b8'>Configuration Trigger</h3>"
-        "<form id='system-control-form' onsubmit='return saveSystemConfig()'>"
-        "<div style='display:grid;grid-template-columns:150px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>Trigger GPIO Pin:</label>"
-        "<div>"
-        "<input type='number' id='trigger_gpio_pin' name='trigger_gpio_pin' value='%d' min='0' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>GPIO pin for configuration mode trigger (0-39, pull LOW to enter config mode)</small>"
-        "</div>"
-        "</div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='submit' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save System Settings</button>"
-        "</div>"
-        "<div id='system-control-result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "</form>"
-        "</div>",
-        g_system_config.trigger_gpio_pin > 0 ? g_system_config.trigger_gpio_pin : 34);
-    httpd_resp_sendstr_chunk(req, chunk);
-    
-    // Modem Control Section
-    snprintf(chunk, sizeof(chunk),
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#17a2b8'>Modem Control</h3>"
-        "<form id='modem-form' onsubmit='return saveModemConfig()'>"
-        "<div style='display:flex;align-items:center;justify-content:center;padding:15px;background:#f0f8ff;border-radius:8px;margin-bottom:20px'>"
-        "<label for='modem_reset_enabled' style='display:flex;align-items:center;justify-content:center;font-weight:600;font-size:15px;cursor:pointer;margin:0'>"
-        "<input type='checkbox' id='modem_reset_enabled' name='modem_reset_enabled' value='1' %s style='margin-right:10px;width:18px;height:18px;cursor:pointer'>"
-        "Enable Modem Reset on MQTT Disconnect</label>"
-        "</div>"
-        "<p style='color:#666;text-align:center;font-size:13px;margin-bottom:20px'>When enabled, the specified GPIO will power cycle the modem (2 seconds) on MQTT disconnection</p>"
-        "<div style='display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>GPIO Pin for Modem Reset:</label>"
-        "<div>"
-        "<input type='number' id='modem_reset_gpio_pin' name='modem_reset_gpio_pin' value='%d' min='2' max='39' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>GPIO pin to control modem power (2-39, avoid 0,1,6-11 which are reserved)</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Modem Boot Delay:</label>"
-        "<div>"
-        "<input type='number' id='modem_boot_delay' name='modem_boot_delay' value='%d' min='5' max='60' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Time to wait for modem to boot up after reset (5-60 seconds)</small>"
-        "</div>"
-        "</div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='submit' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save Modem Settings</button>"
-        "</div>"
-        "<div id='modem-result' style='margin-top:15px;padding:10px;border-radius:6px;display:none'></div>"
-        "</form>"
-        "</div>", 
-        g_system_config.modem_reset_enabled ? "checked" : "",
-        g_system_config.modem_reset_gpio_pin > 0 ? g_system_config.modem_reset_gpio_pin : 2,
-        g_system_config.modem_boot_delay > 0 ? g_system_config.modem_boot_delay : 15);
-    httpd_resp_sendstr_chunk(req, chunk);
-    
-    snprintf(chunk, sizeof(chunk),
-        "<div style='margin-top:25px;padding:20px;background:#fef4f4;border-radius:8px;text-align:center;border:1px solid #f8d7da'>"
-        "<button type='button' onclick='rebootSystem()' style='background:#dc3545;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer;box-shadow:0 2px 8px rgba(220,53,69,0.3)'>Reboot to Normal Mode</button>"
-        "<p style='color:#721c24;font-size:13px;margin:10px 0 0 0'>Exit configuration mode and restart to normal operation mode.</p>"
-        "</div>"
-        "</div>");  // Close main WiFi section (id='wifi') containing Network Mode, WiFi, SIM, SD, RTC, Config Trigger, and Modem Control
-    SEND_OR_ABORT(req, chunk);
-
-    // Separate Azure IoT Hub Configuration Section - Part 1
-    snprintf(chunk, sizeof(chunk),
-        "<div id='azure' class='section'>"
-        "<h2 class='section-title'><i>☁️</i>Azure IoT Hub Configuration (Password Protected)</h2>"
-        "<div style='background:#fff3cd;border:1px solid #ffeaa7;padding:10px;margin:10px 0;border-radius:4px'>"
-        "<p style='margin:0;color:#856404'><strong>Security Notice:</strong> This section contains sensitive Azure IoT Hub configuration. Access is password protected for security.</p>"
-        "</div>"
-        "<form method='POST' action='/save_azure_config'>"
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#007bff;font-size:20px'>Connection Settings</h3>"
-        "<div style='display:grid;grid-template-columns:150px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>IoT Hub FQDN:</label>"
-        "<div>"
-        "<input type='text' name='azure_hub_fqdn' value='%s' readonly style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px;background:#f8f9fa'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>This is configured in the firmware (read-only)</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Device ID:</label>"
-        "<div>"
-        "<input type='text' name='azure_device_id' value='%s' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px' placeholder='Enter your Azure device ID' required>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Your Azure IoT Hub device identifier</small>"
-        "</div>",
-        IOT_CONFIG_IOTHUB_FQDN, g_system_config.azure_device_id);
-    httpd_resp_sendstr_chunk(req, chunk);
-    
-    // Azure section - Part 2
-    snprintf(chunk, sizeof(chunk),
-        "<label style='font-weight:600;padding-top:10px'>Device Key:</label>"
-        "<div>"
-        "<div style='position:relative'>"
-        "<input type='password' id='azure_device_key' name='azure_device_key' value='%s' style='width:100%%;padding:10px;padding-right:60px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px' placeholder='Enter your Azure device primary key' required>"
-        "<span onclick='toggleAzurePassword()' style='position:absolute;right:10px;top:50%%;transform:translateY(-50%%);cursor:pointer;color:#007bff;font-size:12px;font-weight:600;user-select:none;padding:4px 8px;background:#f0f8ff;border-radius:4px'>SHOW</span>"
-        "</div>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Required: Primary key from Azure IoT Hub device registration</small>"
-        "</div>"
-        "</div>"
-        "</div>",
-        g_system_config.azure_device_key);
-    httpd_resp_sendstr_chunk(req, chunk);
-    
-    // Azure section - Part 3
-    snprintf(chunk, sizeof(chunk),
-        "<div class='sensor-card' style='padding:25px'>"
-        "<h3 style='text-align:center;margin-bottom:20px;color:#007bff;font-size:20px'>Telemetry Settings</h3>"
-        "<div style='display:grid;grid-template-columns:150px 1fr;gap:20px;align-items:start;margin-bottom:20px'>"
-        "<label style='font-weight:600;padding-top:10px'>Send Interval:</label>"
-        "<div>"
-        "<input type='number' name='telemetry_interval' value='%d' min='30' max='3600' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>How often to send sensor data to Azure (30-3600 seconds)</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Batch Mode:</label>"
-        "<div>"
-        "<label style='display:flex;align-items:center;gap:10px;cursor:pointer'>"
-        "<input type='checkbox' name='batch_telemetry' %s style='width:20px;height:20px'>"
-        "<span style='font-size:15px'>Send all sensors in single JSON message</span>"
-        "</label>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>When enabled, all sensor data is sent as one message with \"body\" array. When disabled, each sensor is sent separately.</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Modbus Retries:</label>"
-        "<div>"
-        "<select name='modbus_retry_count' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<option value='0' %s>No retries (fastest)</option>"
-        "<option value='1' %s>1 retry (recommended)</option>"
-        "<option value='2' %s>2 retries</option>"
-        "<option value='3' %s>3 retries (most reliable)</option>"
-        "</select>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Number of retry attempts when a Modbus sensor read fails</small>"
-        "</div>"
-        "<label style='font-weight:600;padding-top:10px'>Retry Delay:</label>"
-        "<div>"
-        "<input type='number' name='modbus_retry_delay' value='%d' min='10' max='500' style='width:100%%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px'>"
-        "<small style='color:#888;display:block;margin-top:5px;font-size:13px'>Delay in milliseconds between retry attempts (10-500ms)</small>"
-        "</div>"
-        "</div>"
-        "<div style='margin-top:25px;padding:20px;background:#f8f9fa;border-radius:8px;text-align:center'>"
-        "<button type='button' onclick='saveAzureConfig()' style='background:#28a745;color:white;padding:12px 30px;border:none;border-radius:6px;font-weight:bold;font-size:16px;cursor:pointer'>Save Azure Configuration</button>"
-        "<p style='color:#666;font-size:12px;margin:10px 0 0 0'>This saves Azure IoT Hub settings only.</p>"
-        "</div>"
-        "</div>"
-        "</form>"
-        "</div>",
-        g_system_config.telemetry_interval,
-        g_system_config.batch_telemetry ? "checked" : "",
-        g_system_config.modbus_retry_count == 0 ? "selected" : "",
-        g_system_config.modbus_retry_count == 1 ? "selected" : "",
-        g_system_config.modbus_retry_count == 2 ? "selected" : "",
-        g_system_config.modbus_retry_count == 3 ? "selected" : "",
-        g_system_config.modbus_retry_delay);
-    SEND_OR_ABORT(req, chunk);
-
-    // Sensors section with sub-menus
-    int regular_sensor_count = 0;
-    int water_quality_sensor_count = 0;
-    
-    // Count sensors by type
-    for (int i = 0; i < g_system_config.sensor_count; i++) {
-        if (g_system_config.sensors[i].enabled) {
-            if (strcmp(g_system_config.sensors[i].sensor_type, "QUALITY") == 0 ||
-                strcmp(g_system_config.sensors[i].sensor_type, "Aquadax_Quality") == 0 ||
-                strcmp(g_system_config.sensors[i].sensor_type, "Opruss_Ace") == 0 ||
-                strcmp(g_system_config.sensors[i].sensor_type, "Hardness_Sensor") == 0) {
-                water_quality_sensor_count++;
-            } else {
-                regular_sensor_count++;
-            }
-        }
-    }
-    
-    snprintf(chunk, sizeof(chunk), 
-        "<div id='sensors' class='section'>"
-        "<h2 class='section-title'><i>🔌</i>Modbus Sensors (Total: %d)</h2>"
-        
-        "<!-- Sub-menu Navigation -->"
-        "<div style='background:#f8f9fa;padding:15px;margin:10px 0;border-radius:5px;border:1px solid #dee2e6'>"
-        "<div style='display:flex;gap:10px;flex-wrap:wrap'>"
-        "<button type='button' onclick='showSensorSubMenu(\"regular\")' id='btn-regular-sensors' style='background:#007bff;color:white;padding:12px 20px;border:none;border-radius:6px;cursor:pointer;font-weight:bold;min-width:150px'>Regular Sensors (%d)</button>"
-        "<button type='button' onclick='showSensorSubMenu(\"water_quality\")' id='btn-water-quality-sensors' style='background:#17a2b8;color:white;padding:12px 20px;border:none;border-radius:6px;cursor:pointer;font-weight:bold;min-width:150px'>Water Quality Sensors (%d)</button>"
-"<button type='button' onclick='showSensorSubMenu(\"explorer\")' id='btn-modbus-explorer' style='background:#6c757d;color:white;padding:12px 20px;border:none;border-radius:6px;cursor:pointer;font-weight:bold;min-width:150px'>🔍 Modbus Explorer</button>"
-        "</div>"
-        "</div>", 
-        g_system_config.sensor_count, regular_sensor_count, water_quality_sensor_count);
-    httpd_resp_sendstr_chunk(req, chunk);
-    
-    // Regular Sensors Section
-    httpd_resp_sendstr_chunk(req,
-        "<div id='regular-sensors-list' class='sensor-submenu' style='display:block'>"
-        "<h3 style='color:#007bff;margin:15px 0 10px 0'>Regular Sensors</h3>");
-    
-    ESP_LOGI(TAG, "Displaying regular sensors in web interface");
-    bool has_regular_sensors = false;
-    for (int i = 0; i < g_system_config.sensor_count; i++) {
-        if (!connection_alive) goto page_done;
-        if (g_system_config.sensors[i].enabled && strcmp(g_system_config.sensors[i].sensor_type, "QUALITY") != 0 && strcmp(g_system_config.sensors[i].sensor_type, "Aquadax_Quality") != 0 && strcmp(g_system_config.sensors[i].sensor_type, "Opruss_Ace") != 0 && strcmp(g_system_config.sensors[i].sensor_type, "Hardness_Sensor") != 0) {
-            has_regular_sensors = true;
-            ESP_LOGI(TAG, "Display Regular Sensor %d: name='%s', sensor_type='%s' (len=%d)", i, g_system_config.sensors[i].name, g_system_config.sensors[i].sensor_type, strlen(g_system_config.sensors[i].sensor_type));
-            
-            // Show different parameters based on sensor type
-            if (strcmp(g_system_config.sensors[i].sensor_type, "Level") == 0) {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<h3>%s (Sensor %d) - <span style='color:#007bff;font-weight:bold;'>%s</span></h3>"
-                    "<p><strong>Unit ID:</strong> %s</p>"
-                    "<p><strong>Slave ID:</strong> %d</p>"
-                    "<p><strong>Register:</strong> %d</p>"
-                    "<p><strong>Quantity:</strong> %d</p>"
-                    "<p><strong>Register Type:</strong> %s</p>"
-                    "<p><strong>Data Type:</strong> %s</p>"
-                    "<p><strong>Sensor Height:</strong> %.2f</p>"
-                    "<p><strong>Max Water Level:</strong> %.2f</p>"
-                    "<p style='color:#666;font-size:12px;margin:5px 0;grid-column:1/-1'>RS485 Modbus - Level calc: (Height - Raw) / MaxLevel * 100</p>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1, g_system_config.sensors[i].sensor_type,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].quantity,
-                    g_system_config.sensors[i].register_type[0] ? g_system_config.sensors[i].register_type : "HOLDING",
-                    g_system_config.sensors[i].data_type, 
-                    g_system_config.sensors[i].sensor_height, g_system_config.sensors[i].max_water_level,
-                    i, i, i, i);
-            } else if (strcmp(g_system_config.sensors[i].sensor_type, "RAINGAUGE") == 0) {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<h3>%s (Sensor %d) - <span style='color:#28a745;font-weight:bold;'>Rain Gauge</span></h3>"
-                    "<p><strong>Unit ID:</strong> %s</p>"
-                    "<p><strong>Slave ID:</strong> %d</p>"
-                    "<p><strong>Register:</strong> %d</p>"
-                    "<p><strong>Quantity:</strong> %d</p>"
-                    "<p><strong>Register Type:</strong> %s</p>"
-                    "<p><strong>Data Type:</strong> %s</p>"
-                    "<p><strong>Scale:</strong> %.3f</p>"
-                    "<p style='color:#666;font-size:12px;margin:5px 0;grid-column:1/-1'>RS485 Modbus - Rain gauge measurement in mm or inches</p>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].quantity,
-                    g_system_config.sensors[i].register_type[0] ? g_system_config.sensors[i].register_type : "HOLDING",
-                    g_system_config.sensors[i].data_type, g_system_config.sensors[i].scale_factor,
-                    i, i, i, i);
-            } else if (strcmp(g_system_config.sensors[i].sensor_type, "BOREWELL") == 0) {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<h3>%s (Sensor %d) - <span style='color:#6f42c1;font-weight:bold;'>Borewell</span></h3>"
-                    "<p><strong>Unit ID:</strong> %s</p>"
-                    "<p><strong>Slave ID:</strong> %d</p>"
-                    "<p><strong>Register:</strong> %d</p>"
-                    "<p><strong>Quantity:</strong> %d</p>"
-                    "<p><strong>Register Type:</strong> %s</p>"
-                    "<p><strong>Data Type:</strong> %s</p>"
-                    "<p><strong>Scale:</strong> %.3f</p>"
-                    "<p style='color:#666;font-size:12px;margin:5px 0;grid-column:1/-1'>RS485 Modbus - Borewell water level and flow monitoring</p>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].quantity,
-                    g_system_config.sensors[i].register_type[0] ? g_system_config.sensors[i].register_type : "HOLDING",
-                    g_system_config.sensors[i].data_type, g_system_config.sensors[i].scale_factor,
-                    i, i, i, i);
-            } else if (strcmp(g_system_config.sensors[i].sensor_type, "ENERGY") == 0) {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<h3>%s (Sensor %d) - <span style='color:#fd7e14;font-weight:bold;'>Energy Meter</span></h3>"
-                    "<p><strong>Unit ID:</strong> %s</p>"
-                    "<p><strong>Slave ID:</strong> %d</p>"
-                    "<p><strong>Register:</strong> %d</p>"
-                    "<p><strong>Quantity:</strong> %d</p>"
-                    "<p><strong>Register Type:</strong> %s</p>"
-                    "<p><strong>Data Type:</strong> %s</p>"
-                    "<p><strong>Scale:</strong> %.3f</p>"
-                    "<p style='color:#666;font-size:12px;margin:5px 0;grid-column:1/-1'>RS485 Modbus - Energy meter monitoring with power consumption data</p>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].quantity,
-                    g_system_config.sensors[i].register_type[0] ? g_system_config.sensors[i].register_type : "HOLDING",
-                    g_system_config.sensors[i].data_type, g_system_config.sensors[i].scale_factor,
-                    i, i, i, i);
-            } else {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<h3>%s (Sensor %d) - <span style='color:#007bff;font-weight:bold;'>%s</span></h3>"
-                    "<p><strong>Unit ID:</strong> %s</p>"
-                    "<p><strong>Slave ID:</strong> %d</p>"
-                    "<p><strong>Register:</strong> %d</p>"
-                    "<p><strong>Quantity:</strong> %d</p>"
-                    "<p><strong>Register Type:</strong> %s</p>"
-                    "<p><strong>Data Type:</strong> %s</p>"
-                    "<p><strong>Scale:</strong> %.3f</p>"
-                    "<p style='color:#666;font-size:12px;margin:5px 0;grid-column:1/-1'>RS485 Modbus - Real-time data with ScadaCore format interpretations</p>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:3px;padding:10px 18px;border:none;border-radius:5px;font-weight:bold;cursor:pointer'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1, g_system_config.sensors[i].sensor_type[0] ? g_system_config.sensors[i].sensor_type : "Flow-Meter",
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].quantity,
-                    g_system_config.sensors[i].register_type[0] ? g_system_config.sensors[i].register_type : "HOLDING",
-                    g_system_config.sensors[i].data_type, g_system_config.sensors[i].scale_factor, i, i, i, i);
-            }
-            httpd_resp_sendstr_chunk(req, chunk);
-        }
-    }
-    
-    if (!has_regular_sensors) {
-        httpd_resp_sendstr_chunk(req, 
-            "<div style='background:#e3f2fd;border:1px solid #90caf9;padding:10px;margin:10px 0;border-radius:4px'>"
-            "<p><strong>INFO: No regular sensors configured yet.</strong></p>"
-            "<p>Use the Add New Regular Sensor button below to add regular sensors like Level, Flow-Meter, Energy, etc.</p>"
-            "</div>");
+    // A versioned URL never changes content; the bare URL and the page revalidate
+    bool immutable = asset->versioned && httpd_req_get_url_query_len(req) > 0;
+    httpd_resp_set_hdr(req, "Cache-Control", immutable ? "public, max-age=31536000, immutable" : "no-cache");
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
     }
-    
-    // Add New Regular Sensor button
-    httpd_resp_sendstr_chunk(req, 
-        "<div style='background:#f8f9fa;padding:15px;margin:15px 0;border-radius:8px;border:1px solid #dee2e6'>"
-        "<button type='button' onclick='addRegularSensor()' style='background:linear-gradient(135deg,#28a745,#20c997);color:white;padding:14px 35px;margin:10px;border:none;border-radius:8px;font-size:16px;font-weight:600;cursor:pointer;box-shadow:0 4px 12px rgba(40,167,69,0.3);transition:all 0.3s ease' onmouseover='this.style.transform=\"translateY(-2px)\";this.style.boxShadow=\"0 6px 16px rgba(40,167,69,0.4)\"' onmouseout='this.style.transform=\"translateY(0)\";this.style.boxShadow=\"0 4px 12px rgba(40,167,69,0.3)\"'>➕ Add New Regular Sensor</button>"
-        "<p style='color:#666;font-size:12px;margin:10px 0 5px 0'>Add Level, Flow-Meter, Energy, or other regular Modbus sensors</p>"
-        "</div>");
-    
-    SEND_OR_ABORT(req, "</div>");
 
-    // Water Quality Sensors Section
-    if (!connection_alive) goto page_done;
-    SEND_OR_ABORT(req,
-        "<div id='water-quality-sensors-list' class='sensor-submenu' style='display:none'>"
-        "<h3 style='color:#17a2b8;margin:15px 0 10px 0'>Water Quality Sensors</h3>");
-    
-    ESP_LOGI(TAG, "Displaying water quality sensors in web interface");
-    bool has_quality_sensors = false;
-    for (int i = 0; i < g_system_config.sensor_count; i++) {
-        if (!connection_alive) goto page_done;
-        if (g_system_config.sensors[i].enabled &&
-            (strcmp(g_system_config.sensors[i].sensor_type, "QUALITY") == 0 ||
-             strcmp(g_system_config.sensors[i].sensor_type, "Aquadax_Quality") == 0 ||
-             strcmp(g_system_config.sensors[i].sensor_type, "Opruss_Ace") == 0 ||
-             strcmp(g_system_config.sensors[i].sensor_type, "Aster") == 0 ||
-             strcmp(g_system_config.sensors[i].sensor_type, "Hardness_Sensor") == 0)) {
-            has_quality_sensors = true;
-            bool is_aquadax = (strcmp(g_system_config.sensors[i].sensor_type, "Aquadax_Quality") == 0);
-            bool is_opruss_ace = (strcmp(g_system_config.sensors[i].sensor_type, "Opruss_Ace") == 0);
-            bool is_aster = (strcmp(g_system_config.sensors[i].sensor_type, "Aster") == 0);
-            bool is_hardness = (strcmp(g_system_config.sensors[i].sensor_type, "Hardness_Sensor") == 0);
-            ESP_LOGI(TAG, "Water Quality Sensor %d: %s (type: %s)", i, g_system_config.sensors[i].name, g_system_config.sensors[i].sensor_type);
-
-            if (is_aquadax) {
-                // Aquadax card - entire card in single send to reduce TCP round trips
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<div style='display:flex;justify-content:space-between;align-items:center;margin-bottom:12px;padding-bottom:10px;border-bottom:2px solid #17a2b8'>"
-                    "<h3 style='margin:0;font-size:18px'>%s <span style='color:#888;font-weight:normal'>(Sensor %d)</span></h3>"
-                    "<span style='background:linear-gradient(135deg,#17a2b8,#20c997);color:white;padding:4px 14px;border-radius:20px;font-size:12px;font-weight:600'>AQUADAX QUALITY</span>"
-                    "</div>"
-                    "<div style='display:grid;grid-template-columns:1fr 1fr;gap:8px 20px;margin-bottom:12px;padding:12px;background:#f8f9fa;border-radius:8px;font-size:13px'>"
-                    "<div><strong style='color:#555'>Unit ID:</strong> <span style='color:#0d6efd'>%s</span></div>"
-                    "<div><strong style='color:#555'>Slave ID:</strong> %d</div>"
-                    "<div><strong style='color:#555'>Register:</strong> %d (0x%04X)</div>"
-                    "<div><strong style='color:#555'>Baud Rate:</strong> %d bps</div>"
-                    "<div><strong style='color:#555'>Quantity:</strong> 12 registers</div>"
-                    "<div><strong style='color:#555'>Data Format:</strong> FLOAT32 CDAB</div>"
-                    "</div>"
-                    "<div style='display:flex;flex-wrap:wrap;gap:6px;margin-bottom:10px'>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>COD</span>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>BOD</span>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>TSS</span>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>pH</span>"
-                    "<span style='background:#cce5ff;color:#004085;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #b8daff'>Temp</span>"
-                    "</div>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:2px;padding:6px 12px'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:2px;padding:6px 12px'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:2px;padding:6px 12px'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].register_address,
-                    g_system_config.sensors[i].baud_rate > 0 ? g_system_config.sensors[i].baud_rate : 9600,
-                    i, i, i, i);
-                SEND_OR_ABORT(req, chunk);
-                continue;  // Skip shared button code below
-            } else if (is_opruss_ace) {
-                // Opruss Ace card - entire card in single send to reduce TCP round trips
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<div style='display:flex;justify-content:space-between;align-items:center;margin-bottom:12px;padding-bottom:10px;border-bottom:2px solid #e67e22'>"
-                    "<h3 style='margin:0;font-size:18px'>%s <span style='color:#888;font-weight:normal'>(Sensor %d)</span></h3>"
-                    "<span style='background:linear-gradient(135deg,#e67e22,#f39c12);color:white;padding:4px 14px;border-radius:20px;font-size:12px;font-weight:600'>OPRUSS ACE</span>"
-                    "</div>"
-                    "<div style='display:grid;grid-template-columns:1fr 1fr;gap:8px 20px;margin-bottom:12px;padding:12px;background:#f8f9fa;border-radius:8px;font-size:13px'>"
-                    "<div><strong style='color:#555'>Unit ID:</strong> <span style='color:#0d6efd'>%s</span></div>"
-                    "<div><strong style='color:#555'>Slave ID:</strong> %d</div>"
-                    "<div><strong style='color:#555'>Register:</strong> %d (0x%04X)</div>"
-                    "<div><strong style='color:#555'>Baud Rate:</strong> %d bps</div>"
-                    "<div><strong style='color:#555'>Quantity:</strong> 22 registers</div>"
-                    "<div><strong style='color:#555'>Data Format:</strong> FLOAT32 CDAB</div>"
-                    "</div>"
-                    "<div style='display:flex;flex-wrap:wrap;gap:6px;margin-bottom:10px'>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>COD</span>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>BOD</span>"
-                    "<span style='background:#d4edda;color:#155724;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #c3e6cb'>TSS</span>"
-                    "<span style='background:#cce5ff;color:#004085;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #b8daff'>TDS</span>"
-                    "<span style='background:#cce5ff;color:#004085;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #b8daff'>Temp</span>"
-                    "</div>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:2px;padding:6px 12px'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:2px;padding:6px 12px'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:2px;padding:6px 12px'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].register_address,
-                    g_system_config.sensors[i].baud_rate > 0 ? g_system_config.sensors[i].baud_rate : 9600,
-                    i, i, i, i);
-                SEND_OR_ABORT(req, chunk);
-                continue;  // Skip shared button code below
-            } else if (is_aster) {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<div style='display:flex;justify-content:space-between;align-items:center;margin-bottom:12px;padding-bottom:10px;border-bottom:2px solid #8e44ad'>"
-                    "<h3 style='margin:0'>%s <span style='color:#888;font-weight:normal'>(Sensor %d)</span></h3>"
-                    "<span style='background:#8e44ad;color:white;padding:4px 14px;border-radius:20px;font-size:12px;font-weight:600'>ASTER</span></div>"
-                    "<div style='display:grid;grid-template-columns:1fr 1fr;gap:8px 20px;margin-bottom:12px;padding:12px;background:#f8f9fa;border-radius:8px;font-size:13px'>"
-                    "<div><b>Unit ID:</b> %s</div><div><b>Slave:</b> %d</div>"
-                    "<div><b>Reg:</b> %d (0x%04X)</div><div><b>Baud:</b> %d</div>"
-                    "<div><b>Qty:</b> 4</div><div><b>Format:</b> UINT16</div></div>"
-                    "<span style='background:#e8daef;color:#6c3483;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600'>pH</span> "
-                    "<span style='background:#e8daef;color:#6c3483;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600'>TDS</span><br><br>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:2px;padding:6px 12px'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:2px;padding:6px 12px'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:2px;padding:6px 12px'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div></div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].register_address,
-                    g_system_config.sensors[i].baud_rate > 0 ? g_system_config.sensors[i].baud_rate : 9600,
-                    i, i, i, i);
-                SEND_OR_ABORT(req, chunk);
-                continue;
-            } else if (is_hardness) {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<div style='display:flex;justify-content:space-between;align-items:center;margin-bottom:12px;padding-bottom:10px;border-bottom:2px solid #6f42c1'>"
-                    "<h3 style='margin:0;font-size:18px'>%s <span style='color:#888;font-weight:normal'>(Sensor %d)</span></h3>"
-                    "<span style='background:linear-gradient(135deg,#6f42c1,#8e5be2);color:white;padding:4px 14px;border-radius:20px;font-size:12px;font-weight:600'>HARDNESS</span>"
-                    "</div>"
-                    "<div style='display:grid;grid-template-columns:1fr 1fr;gap:8px 20px;margin-bottom:12px;padding:12px;background:#f8f9fa;border-radius:8px;font-size:13px'>"
-                    "<div><strong style='color:#555'>Unit ID:</strong> <span style='color:#0d6efd'>%s</span></div>"
-                    "<div><strong style='color:#555'>Slave ID:</strong> %d</div>"
-                    "<div><strong style='color:#555'>Register:</strong> %d (0x%04X)</div>"
-                    "<div><strong style='color:#555'>Baud Rate:</strong> %d bps</div>"
-                    "<div><strong style='color:#555'>Quantity:</strong> 6 registers</div>"
-                    "<div><strong style='color:#555'>Data Format:</strong> FLOAT32 CDAB</div>"
-                    "</div>"
-                    "<div style='display:flex;flex-wrap:wrap;gap:6px;margin-bottom:10px'>"
-                    "<span style='background:#e8daef;color:#5b2c8a;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #d2b4de'>Hardness (mg/L)</span>"
-                    "<span style='background:#cce5ff;color:#004085;padding:4px 10px;border-radius:12px;font-size:12px;font-weight:600;border:1px solid #b8daff'>Temp (&deg;C)</span>"
-                    "</div>"
-                    "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:2px;padding:6px 12px'>Edit</button> "
-                    "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:2px;padding:6px 12px'>Test RS485</button> "
-                    "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:2px;padding:6px 12px'>Delete</button>"
-                    "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                    "</div>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].slave_id,
-                    g_system_config.sensors[i].register_address, g_system_config.sensors[i].register_address,
-                    g_system_config.sensors[i].baud_rate > 0 ? g_system_config.sensors[i].baud_rate : 9600,
-                    i, i, i, i);
-                SEND_OR_ABORT(req, chunk);
-                continue;
-            } else {
-                snprintf(chunk, sizeof(chunk),
-                    "<div class='sensor-card' id='sensor-card-%d'>"
-                    "<h3>%s (Sensor %d) - <span style='color:#17a2b8;font-weight:bold;'>Water Quality</span></h3>"
-                    "<p><strong>Unit ID:</strong> %s | <strong>Sub-Sensors:</strong> %d configured</p>"
-                    "<p style='color:#666;font-size:12px;margin:5px 0'>[TEST] Water Quality Modbus Sensor - Real-time water parameter monitoring</p>",
-                    i, g_system_config.sensors[i].name, i + 1,
-                    g_system_config.sensors[i].unit_id, g_system_config.sensors[i].sub_sensor_count);
-            }
-            httpd_resp_sendstr_chunk(req, chunk);
-
-            // Show configured sub-sensor parameters (only for QUALITY type, not Aquadax)
-            if (!is_aquadax && g_system_config.sensors[i].sub_sensor_count > 0) {
-                httpd_resp_sendstr_chunk(req, "<div style='background:#f0f8ff;padding:10px;margin:5px 0;border-radius:4px;border:1px solid #17a2b8'>");
-                httpd_resp_sendstr_chunk(req, "<strong style='color:#17a2b8'>[PARAM] Configured Parameters:</strong> ");
-                bool first_param = true;
-                for (int j = 0; j < g_system_config.sensors[i].sub_sensor_count; j++) {
-                    if (g_system_config.sensors[i].sub_sensors[j].enabled && 
-                        strlen(g_system_config.sensors[i].sub_sensors[j].parameter_name) > 0) {
-                        if (!first_param) {
-                            httpd_resp_sendstr_chunk(req, ", ");
-                        }
-                        char escaped_param_name[64];
-                        html_escape(escaped_param_name, g_system_config.sensors[i].sub_sensors[j].parameter_name, sizeof(escaped_param_name));
-                        snprintf(chunk, sizeof(chunk), "<span style='color:#28a745;font-weight:bold'>%s</span> (ID:%d, Reg:%d)", 
-                                escaped_param_name,
-                                g_system_config.sensors[i].sub_sensors[j].slave_id,
-                                g_system_config.sensors[i].sub_sensors[j].register_address);
-                        httpd_resp_sendstr_chunk(req, chunk);
-                        first_param = false;
-                    }
-                }
-                httpd_resp_sendstr_chunk(req, "</div>");
-            }
-            
-            snprintf(chunk, sizeof(chunk),
-                "<button type='button' onclick='editSensor(%d)' style='background:#17a2b8;color:white;margin:2px;padding:6px 12px'>Edit</button> "
-                "<button type='button' onclick='testSensor(%d)' style='background:#007bff;color:white;margin:2px;padding:6px 12px'>Test RS485</button> "
-                "<button type='button' onclick='deleteSensor(%d)' style='background:#dc3545;color:white;margin:2px;padding:6px 12px'>Delete</button>"
-                "<div id='test-result-%d' class='test-result' style='display:none'></div>"
-                "</div>", i, i, i, i);
-            httpd_resp_sendstr_chunk(req, chunk);
-        }
-    }
-    
-    if (!has_quality_sensors) {
-        httpd_resp_sendstr_chunk(req, 
-            "<div style='background:#fff3cd;border:1px solid #ffeaa7;padding:10px;margin:10px 0;border-radius:4px'>"
-            "<p><strong>INFO: No water quality sensors configured yet.</strong></p>"
-            "<p>Use the Add New Water Quality Sensor button below to add water quality sensors like pH, TDS, Temperature, etc.</p>"
-            "</div>");
-    }
-    
-    // Add New Water Quality Sensor button
-    httpd_resp_sendstr_chunk(req, 
-        "<div style='background:#f8f9fa;padding:15px;margin:15px 0;border-radius:8px;border:1px solid #dee2e6'>"
-        "<button type='button' onclick='addWaterQualitySensor()' style='background:#17a2b8;color:white;padding:14px 30px;margin:8px;border:none;border-radius:8px;font-size:15px;font-weight:600;cursor:pointer'>Add Water Quality</button>"
-        "<button type='button' onclick='addAquadaxQualitySensor()' style='background:#0d6efd;color:white;padding:14px 30px;margin:8px;border:none;border-radius:8px;font-size:15px;font-weight:600;cursor:pointer'>Add Aquadax</button>"
-        "<button type='button' onclick='addOprussAceSensor()' style='background:#e67e22;color:white;padding:14px 30px;margin:8px;border:none;border-radius:8px;font-size:15px;font-weight:600;cursor:pointer'>Add Opruss Ace</button>"
-        "<button type='button' onclick='addAsterSensor()' style='background:#8e44ad;color:white;padding:14px 30px;margin:8px;border:none;border-radius:8px;font-size:15px;font-weight:600;cursor:pointer'>Add Aster</button>"
-        "<button type='button' onclick='addHardnessSensor()' style='background:#6f42c1;color:white;padding:14px 30px;margin:8px;border:none;border-radius:8px;font-size:15px;font-weight:600;cursor:pointer'>Add Hardness</button>"
-        "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Modbus Explorer Section
-    if (!connection_alive) goto page_done;
-    SEND_OR_ABORT(req,
-        "<div id='modbus-explorer-list' class='sensor-submenu' style='display:none'>"
-        "<h3 style='color:#6c757d;margin:15px 0 10px 0'>Modbus Explorer</h3>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Device Scanner</h3>"
-        "<p>Scan the RS485 bus to discover Modbus devices by checking responses from slave IDs.</p>"
-        "<div class='form-grid'>"
-        "<label>Start Slave ID:</label>"
-        "<input type='number' id='scan_start' min='1' max='247' value='1'>"
-        "<label>End Slave ID:</label>"
-        "<input type='number' id='scan_end' min='1' max='247' value='10'>"
-        "<label>Register to Test:</label>"
-        "<input type='number' id='scan_register' min='0' max='65535' value='0'>"
-        "<label>Register Type:</label>"
-        "<select id='scan_reg_type'>"
-        "<option value='holding'>Holding Register (0x03)</option>"
-        "<option value='input'>Input Register (0x04)</option>"
-        "</select>"
-        "</div>"
-        "<button onclick='scanModbusDevices()' class='btn' style='background:var(--color-accent);color:white;width:auto;min-width:200px'>Scan for Devices</button>"
-        "<div id='scan_progress' style='margin-top:var(--space-md);padding:var(--space-md);background:var(--color-bg-secondary);border-radius:var(--radius-md);display:none'></div>"
-        "<div id='scan_results' style='margin-top:var(--space-md)'></div>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Live Register Reader</h3>"
-        "<p>Read registers in real-time with automatic format interpretation (ScadaCore compatible).</p>"
-        "<div class='form-grid'>"
-        "<label>Slave ID:</label>"
-        "<input type='number' id='live_slave' min='1' max='247' value='1'>"
-        "<label>Start Register:</label>"
-        "<input type='number' id='live_register' min='0' max='65535' value='0'>"
-        "<label>Quantity:</label>"
-        "<input type='number' id='live_quantity' min='1' max='10' value='2'>"
-        "<label>Register Type:</label>"
-        "<select id='live_reg_type'>"
-        "<option value='holding'>Holding Register (0x03)</option>"
-        "<option value='input'>Input Register (0x04)</option>"
-        "</select>"
-        "</div>"
-        "<div style='display:flex;gap:var(--space-md);margin-top:var(--space-md)'>"
-        "<button onclick='readLiveRegisters()' class='btn' style='background:var(--color-success);color:white;flex:1'>Read Once</button>"
-        "<button onclick='toggleAutoRefresh()' id='auto_refresh_btn' class='btn' style='background:var(--color-primary);color:white;flex:1'>Enable Auto-Refresh</button>"
-        "</div>"
-        "<div id='live_result' style='margin-top:var(--space-md)'></div>"
-        "</div>");
-
-    // Live Sensor Poll Card - Modbus Poll style
-    httpd_resp_sendstr_chunk(req,
-        ""
-        "<div class='sensor-card'>"
-        "<h3>📊 Live Sensor Poll (Modbus Poll Style)</h3>"
-        "<p>Test ANY Modbus device in real-time - just like Modbus Poll software. Enter parameters and start polling to see live register values.</p>"
-        "<div class='form-grid'>"
-        "<label>Slave ID:</label>"
-        "<input type='number' id='poll_slave' min='1' max='247' value='1'>"
-        "<label>Start Register:</label>"
-        "<input type='number' id='poll_register' min='0' max='65535' value='0'>"
-        "<label>Quantity:</label>"
-        "<input type='number' id='poll_quantity' min='1' max='20' value='5'>"
-        "<label>Register Type:</label>"
-        "<select id='poll_reg_type'>"
-        "<option value='holding'>Holding Register (0x03)</option>"
-        "<option value='input'>Input Register (0x04)</option>"
-        "</select>"
-        "<label>Poll Interval:</label>"
-        "<select id='poll_interval'>"
-        "<option value='1000'>1 second</option>"
-        "<option value='2000'>2 seconds</option>"
-        "<option value='3000' selected>3 seconds</option>"
-        "<option value='5000'>5 seconds</option>"
-        "<option value='10000'>10 seconds</option>"
-        "</select>"
-        "</div>"
-        "<div style='display:flex;gap:var(--space-md);margin-top:var(--space-md)'>"
-        "<button onclick='startModbusPoll()' id='start_poll_btn' class='btn' style='background:#28a745;color:white;flex:1'>Start Polling</button>"
-        "<button onclick='stopModbusPoll()' id='stop_poll_btn' class='btn' style='background:#dc3545;color:white;flex:1;display:none'>Stop Polling</button>"
-        "</div>"
-        "<div id='poll_result' style='margin-top:var(--space-md)'></div>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Explorer Notes</h3>"
-        "<ul style='margin:10px 0;padding-left:20px'>"
-        "<li><strong>Device Scanner:</strong> Tests each slave ID for a response. Non-responsive IDs are skipped.</li>"
-        "<li><strong>Register Reader:</strong> Reads registers and shows all possible format interpretations.</li>"
-        "<li><strong>Auto-Refresh:</strong> Continuously reads registers every 2 seconds for monitoring.</li>"
-        "<li><strong>Format Display:</strong> Shows data in 16 formats (UINT16/32, INT16/32, FLOAT32, all byte orders).</li>"
-        "<li><strong>Industrial Use:</strong> Useful for commissioning, troubleshooting, and device discovery.</li>"
-        "</ul>"
-        "</div>"
-        "</div>"
-    );
+    httpd_resp_set_type(req, asset->content_type);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    return httpd_resp_send(req, (const char *)asset->start, asset->end - asset->start);
+}
 
-    // Add debug info if no sensors at all
-    if (g_system_config.sensor_count == 0) {
-        httpd_resp_sendstr_chunk(req, 
-            "<div style='background:#f8d7da;border:1px solid #f5c6cb;padding:15px;margin:15px 0;border-radius:5px'>"
-            "<h4 style='color:#721c24;margin:0 0 10px 0'>No Sensors Configured</h4>"
-            "<p style='color:#721c24;margin:5px 0'>Get started by adding sensors:</p>"
-            "<ul style='color:#721c24;margin:10px 0;padding-left:20px'>"
-            "<li><strong>Regular Sensors:</strong> Use the 'Add New Regular Sensor' button in the Regular Sensors section for Level, Flow-Meter, Energy sensors</li>"
-            "<li><strong>Water Quality Sensors:</strong> Use the 'Add New Water Quality Sensor' button in the Water Quality section for pH, TDS, Temperature sensors</li>"
-            "</ul>"
-            "</div>");
-    }
-
-    // Close the sensors section
-    SEND_OR_ABORT(req, "</div>");
-
-    // JavaScript - split into smaller chunks
-    if (!connection_alive) goto page_done;  
-    snprintf(chunk, sizeof(chunk),
-        "<script>"
-        "console.log('Script loading - Initial sensor count: %d');"
-        "let sensorCount = %d;"
-        "function addSensor() {"
-        "  console.log('ADD SENSOR CLICKED - Current count:', sensorCount);"
-        "  var div = document.getElementById('sensors');"
-        "  if (!div) { alert('ERROR: Sensors container not found!'); console.error('sensors div missing'); return; }"
-        "  console.log('Found sensors div, building HTML...');"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + sensorCount + '\" style=\"border:2px dashed #007bff;padding:15px;margin:10px 0;background:#f8f9fa\">';"
-        "  h += '<h4 style=\"color:#007bff;margin-top:0\">New Sensor ' + (sensorCount+1) + '</h4>';"
-        "  h += '<style>.sensor-card label { display:inline-block; width:160px; font-weight:bold; margin-bottom:8px; vertical-align:top; } .sensor-card input, .sensor-card select { margin-bottom:12px; } .sensor-form-row { margin-bottom:12px; }</style>';"
-        "  h += '<label><strong>Sensor Type:</strong></label><select name=\"sensor_' + sensorCount + '_sensor_type\" onchange=\"updateSensorForm(' + sensorCount + ')\" style=\"width:200px;border:1px solid #ccc\">';"
-        "  h += '<option value=\"\">Select Sensor Type</option>';"
-        "  h += '<option value=\"Flow-Meter\">Flow-Meter</option>';"
-        "  h += '<option value=\"Panda_USM\">Panda USM</option>';"
-        "  h += '<option value=\"Clampon\">Clampon</option>';"
-        "  h += '<option value=\"Dailian\">Dailian Ultrasonic</option>';"
-        "  h += '<option value=\"Dailian_EMF\">Dailian EMF</option>';"
-        "  h += '<option value=\"Panda_EMF\">Panda EMF</option>';"
-        "  h += '<option value=\"Panda_Level\">Panda Level</option>';"
-        "  h += '<option value=\"Hydrostatic_Level\">Hydrostatic Level (Aquagen)</option>';"
-        "  h += '<option value=\"Piezometer\">Piezometer (Water Level)</option>';"
-        "  h += '<option value=\"Level\">Level</option>';"
-        "  h += '<option value=\"Radar Level\">Radar Level</option>';"
-        "  h += '<option value=\"RAINGAUGE\">Rain Gauge</option>';"
-        "  h += '<option value=\"BOREWELL\">Borewell</option>';"
-        "  h += '<option value=\"ENERGY\">Energy Meter</option>';"
-        "  h += '<option value=\"ZEST\">ZEST</option>';"
-        "  h += '</select><br>';"
-        "  h += '<div id=\"sensor-form-' + sensorCount + '\" style=\"display:none\">';"
-        "  h += '</div>';",
-        g_system_config.sensor_count, g_system_config.sensor_count);
-    httpd_resp_sendstr_chunk(req, chunk);
-
-    // Add buttons and closing for the sensor form container
-    httpd_resp_sendstr_chunk(req,
-        "  h += '<div style=\"margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + sensorCount + ')\" style=\"background:linear-gradient(135deg,#17a2b8,#138496);color:white;padding:12px 28px;margin:5px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(23,162,184,0.3);transition:all 0.3s ease;font-size:15px\" onmouseover=\"this.style.transform=\\'translateY(-2px)\\';this.style.boxShadow=\\'0 5px 12px rgba(23,162,184,0.4)\\'\" onmouseout=\"this.style.transform=\\'translateY(0)\\';this.style.boxShadow=\\'0 3px 8px rgba(23,162,184,0.3)\\'\">🔍 Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + sensorCount + ')\" style=\"background:linear-gradient(135deg,#28a745,#218838);color:white;padding:12px 28px;margin:5px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(40,167,69,0.3);transition:all 0.3s ease;font-size:15px\" onmouseover=\"this.style.transform=\\'translateY(-2px)\\';this.style.boxShadow=\\'0 5px 12px rgba(40,167,69,0.4)\\'\" onmouseout=\"this.style.transform=\\'translateY(0)\\';this.style.boxShadow=\\'0 3px 8px rgba(40,167,69,0.3)\\'\">💾 Save This Sensor</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + sensorCount + ')\" style=\"background:linear-gradient(135deg,#dc3545,#c82333);color:white;padding:12px 28px;margin:5px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(220,53,69,0.3);transition:all 0.3s ease;font-size:15px\" onmouseover=\"this.style.transform=\\'translateY(-2px)\\';this.style.boxShadow=\\'0 5px 12px rgba(220,53,69,0.4)\\'\" onmouseout=\"this.style.transform=\\'translateY(0)\\';this.style.boxShadow=\\'0 3px 8px rgba(220,53,69,0.3)\\'\">❌ Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + sensorCount + '\" style=\"margin-top:10px;display:none\"></div>';"
-        "  h += '</div></div>';");
-
-    httpd_resp_sendstr_chunk(req,
-        "  console.log('Adding HTML to sensors div...');"
-        "  div.innerHTML += h;"
-        "  var currentSensorId = sensorCount;"
-        "  sensorCount++;"
-        "  setTimeout(() => {"
-        "    const select = document.querySelector('select[name=\"sensor_' + currentSensorId + '_data_type\"]');"
-        "    if (select) {"
-        "      select.value = '';"
-        "      showDataTypeInfo(select, currentSensorId);"
-        "    }"
-        "  }, 100);"
-        "  console.log('SUCCESS: New sensor added. Updated count:', sensorCount);"
-        "  alert('SUCCESS: New sensor form added!\\n\\nSTEPS:\\n1. Fill in Name and Unit ID (fill in the fields as needed)\\n2. Select data type to see detailed format interpretations\\n3. Review auto-set quantity and adjust other settings as needed\\n4. Click Save This Sensor\\n\\nEach sensor is saved individually to flash memory!');"
-        "}"
-        "function addRegularSensor() {"
-        "  console.log('ADD REGULAR SENSOR CLICKED - Current count:', sensorCount);"
-        "  var div = document.getElementById('regular-sensors-list');"
-        "  if (!div) { alert('ERROR: Regular sensors container not found!'); console.error('regular-sensors-list div missing'); return; }"
-        "  console.log('Found regular sensors div, building HTML...');"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + sensorCount + '\" style=\"border:2px solid #e0e0e0;border-radius:8px;padding:25px;margin:20px 0;background:#ffffff;box-shadow:0 2px 4px rgba(0,0,0,0.1)\">';"
-        "  h += '<h4 style=\"color:#007bff;margin-top:0;margin-bottom:20px;font-size:18px\">New Regular Sensor ' + (sensorCount+1) + '</h4>';"
-        "  h += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-bottom:20px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:10px\">Sensor Type:</label>';"
-        "  h += '<div>';"
-        "  h += '<select name=\"sensor_' + sensorCount + '_sensor_type\" onchange=\"updateSensorForm(' + sensorCount + ')\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "  h += '<option value=\"\">Select Regular Sensor Type</option>';"
-        "  h += '<option value=\"Flow-Meter\">Flow-Meter</option>';"
-        "  h += '<option value=\"Panda_USM\">Panda USM</option>';"
-        "  h += '<option value=\"Clampon\">Clampon</option>';"
-        "  h += '<option value=\"Dailian\">Dailian Ultrasonic</option>';"
-        "  h += '<option value=\"Dailian_EMF\">Dailian EMF</option>';"
-        "  h += '<option value=\"Panda_EMF\">Panda EMF</option>';"
-        "  h += '<option value=\"Panda_Level\">Panda Level</option>';"
-        "  h += '<option value=\"Hydrostatic_Level\">Hydrostatic Level (Aquagen)</option>';"
-        "  h += '<option value=\"Piezometer\">Piezometer (Water Level)</option>';"
-        "  h += '<option value=\"Level\">Level</option>';"
-        "  h += '<option value=\"Radar Level\">Radar Level</option>';"
-        "  h += '<option value=\"RAINGAUGE\">Rain Gauge</option>';"
-        "  h += '<option value=\"BOREWELL\">Borewell</option>';"
-        "  h += '<option value=\"ENERGY\">Energy Meter</option>';"
-        "  h += '<option value=\"ZEST\">ZEST</option>';"
-        "  h += '</select>';"
-        "  h += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Choose the type of sensor to configure</small>';"
-        "  h += '</div></div>';"
-        "  h += '<div id=\"sensor-form-' + sensorCount + '\" style=\"display:none\">';"
-        "  h += '</div>';"
-        "  h += '<div style=\"margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + sensorCount + ')\" style=\"background:linear-gradient(135deg,#17a2b8,#138496);color:white;padding:12px 28px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin-right:10px;box-shadow:0 3px 8px rgba(23,162,184,0.3);transition:all 0.3s ease;font-size:15px\" onmouseover=\"this.style.transform=\\'translateY(-2px)\\';this.style.boxShadow=\\'0 5px 12px rgba(23,162,184,0.4)\\'\" onmouseout=\"this.style.transform=\\'translateY(0)\\';this.style.boxShadow=\\'0 3px 8px rgba(23,162,184,0.3)\\'\">🔍 Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + sensorCount + ')\" style=\"background:linear-gradient(135deg,#28a745,#218838);color:white;padding:12px 28px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin-right:10px;box-shadow:0 3px 8px rgba(40,167,69,0.3);transition:all 0.3s ease;font-size:15px\" onmouseover=\"this.style.transform=\\'translateY(-2px)\\';this.style.boxShadow=\\'0 5px 12px rgba(40,167,69,0.4)\\'\" onmouseout=\"this.style.transform=\\'translateY(0)\\';this.style.boxShadow=\\'0 3px 8px rgba(40,167,69,0.3)\\'\">💾 Save This Sensor</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + sensorCount + ')\" style=\"background:linear-gradient(135deg,#dc3545,#c82333);color:white;padding:12px 28px;border:none;border-radius:6px;font-weight:600;cursor:pointer;box-shadow:0 3px 8px rgba(220,53,69,0.3);transition:all 0.3s ease;font-size:15px\" onmouseover=\"this.style.transform=\\'translateY(-2px)\\';this.style.boxShadow=\\'0 5px 12px rgba(220,53,69,0.4)\\'\" onmouseout=\"this.style.transform=\\'translateY(0)\\';this.style.boxShadow=\\'0 3px 8px rgba(220,53,69,0.3)\\'\">❌ Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + sensorCount + '\" style=\"margin-top:15px;display:none\"></div>';"
-        "  h += '</div></div>';"
-        "  console.log('Adding HTML to regular sensors div...');"
-        "  div.innerHTML += h;"
-        "  var currentSensorId = sensorCount;"
-        "  sensorCount++;"
-        "  setTimeout(() => {"
-        "    const select = document.querySelector('select[name=\"sensor_' + currentSensorId + '_data_type\"]');"
-        "    if (select) {"
-        "      select.value = '';"
-        "      showDataTypeInfo(select, currentSensorId);"
-        "    }"
-        "  }, 100);"
-        "  console.log('SUCCESS: New regular sensor added. Updated count:', sensorCount);"
-        "  alert('SUCCESS: New regular sensor form added!\\n\\nSTEPS:\\n1. Fill in Name and Unit ID (fill in the fields as needed)\\n2. Select sensor type and data type\\n3. Configure parameters as needed\\n4. Click Save This Sensor\\n\\nThis will be saved as a regular sensor!');"
-        "}"
-        "function addWaterQualitySensor() {"
-        "  console.log('ADD WATER QUALITY SENSOR CLICKED - Current count:', sensorCount);"
-        "  var div = document.getElementById('water-quality-sensors-list');"
-        "  if (!div) { alert('ERROR: Water quality sensors container not found!'); console.error('water-quality-sensors-list div missing'); return; }"
-        "  console.log('Found water quality sensors div, building HTML...');"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + sensorCount + '\" style=\"border:2px solid #17a2b8;border-radius:8px;padding:25px;margin:20px 0;background:#ffffff;box-shadow:0 2px 4px rgba(0,0,0,0.1)\">';"
-        "  h += '<h4 style=\"color:#17a2b8;margin-top:0;margin-bottom:20px;font-size:18px\">New Water Quality Sensor ' + (sensorCount+1) + '</h4>';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + sensorCount + '_sensor_type\" value=\"QUALITY\">';"
-        "  h += '<p style=\"color:#17a2b8;font-weight:600;margin:15px 0;padding:10px;background:#e3f2fd;border-radius:6px;font-size:14px\">[TEST] Water Quality Sensor - Automatically set to QUALITY type</p>';"
-        "  h += '<div id=\"sensor-form-' + sensorCount + '\" style=\"display:block\">';"
-        "  h += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-bottom:20px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:10px\">Sensor Name:</label>';"
-        "  h += '<div><input type=\"text\" name=\"sensor_' + sensorCount + '_name\" placeholder=\"e.g., Tank 1 Water Quality\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "  h += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Display name for this sensor</small></div>';"
-        "  h += '<label style=\"font-weight:600;padding-top:10px\">Unit ID:</label>';"
-        "  h += '<div><input type=\"text\" name=\"sensor_' + sensorCount + '_unit_id\" placeholder=\"e.g., TFG2235Q\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "  h += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Unique identifier for this water quality sensor</small></div>';"
-        "  h += '<label style=\"font-weight:600;padding-top:10px\">Description:</label>';"
-        "  h += '<div><input type=\"text\" name=\"sensor_' + sensorCount + '_description\" placeholder=\"e.g., Main tank water quality monitoring\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "  h += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Optional description of sensor location or purpose</small></div>';"
-        "  h += '<label style=\"font-weight:600;padding-top:10px\">Baud Rate:</label>';"
-        "  h += '<div><select name=\"sensor_' + sensorCount + '_baud_rate\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "  h += '<option value=\"9600\">9600</option><option value=\"19200\">19200</option><option value=\"38400\">38400</option><option value=\"115200\">115200</option>';"
-        "  h += '</select>';"
-        "  h += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Serial communication speed</small></div>';"
-        "  h += '<label style=\"font-weight:600;padding-top:10px\">Parity:</label>';"
-        "  h += '<div><select name=\"sensor_' + sensorCount + '_parity\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "  h += '<option value=\"none\">None</option><option value=\"even\">Even</option><option value=\"odd\">Odd</option>';"
-        "  h += '</select>';"
-        "  h += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Error checking method</small></div></div>';"
-        "  h += '<p style=\"color:#28a745;font-size:14px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\">';"
-        "  h += '[INFO] <strong>Main Configuration:</strong> Set the shared Unit ID and communication settings. Individual parameter readings (pH, TDS, etc.) are configured as sub-sensors below.';"
-        "  h += '</p>';"
-        "  h += '<div style=\"margin-top:20px;padding:15px;background:#f0f8ff;border:2px dashed #17a2b8;border-radius:8px\">';"
-        "  h += '<h4 style=\"color:#17a2b8;margin-top:0\">[PARAM] Sub-Sensors - Water Quality Parameters</h4>';"
-        "  h += '<p style=\"color:#666;font-size:12px;margin:5px 0\">Add water quality parameters that will be grouped under this Unit ID in JSON format:</p>';"
-        "  h += '<p style=\"color:#28a745;font-size:11px;font-family:monospace;background:#f8f8f8;padding:8px;border-radius:4px;margin:5px 0\">';"
-        "  h += '{\"params_data\":{\"pH\":7,\"TDS\":100,\"Temp\":32,\"HUMIDITY\":65,\"BOD\":15,\"COD\":45},\"type\":\"QUALITY\",\"unit_id\":\"TFG2235Q\"}';"
-        "  h += '</p>';"
-        "  h += '<div id=\"sub-sensors-' + sensorCount + '\" style=\"margin:10px 0\"></div>';"
-        "  h += '<button type=\"button\" onclick=\"addSubSensorToQualitySensor(' + sensorCount + ')\" style=\"background:#28a745;color:white;padding:8px 16px;border:none;border-radius:4px;font-size:14px;cursor:pointer\">➕ Add Sub-Sensor</button>';"
-        "  h += '</div>';"
-        "  h += '<div style=\"margin-top:25px;padding-top:20px;border-top:1px solid #e0e0e0;text-align:center\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + sensorCount + ')\" style=\"background:#17a2b8;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + sensorCount + ')\" style=\"background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Save Sensor</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + sensorCount + ')\" style=\"background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + sensorCount + '\" style=\"margin-top:15px;display:none\"></div>';"
-        "  h += '</div></div>';"
-        "  div.innerHTML += h;"
-        "  sensorCount++;"
-        "}"
-        "function addAquadaxQualitySensor() {"
-        "  var div = document.getElementById('water-quality-sensors-list');"
-        "  if (!div) { alert('Container not found!'); return; }"
-        "  var s = sensorCount;"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + s + '\" style=\"border:2px solid #0d6efd;padding:20px;margin:15px 0\">';"
-        "  h += '<h4 style=\"color:#0d6efd\">New Aquadax Quality Sensor ' + (s+1) + '</h4>';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_type\" value=\"Aquadax_Quality\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_data_type\" value=\"AQUADAX_QUALITY_FIXED\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_byte_order\" value=\"BIG_ENDIAN\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_register_type\" value=\"HOLDING\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_quantity\" value=\"12\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_scale_factor\" value=\"1.0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_height\" value=\"0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_max_water_level\" value=\"0\">';"
-        "  h += '<p style=\"color:#0d6efd;font-weight:600;padding:8px;background:#e7f1ff;border-radius:6px\">Aquadax - COD, BOD, TSS, pH, Temp (5x FLOAT32 CDAB)</p>';"
-        "  h += '<div id=\"sensor-form-' + s + '\">';"
-        "  h += '<div style=\"display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Name:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_name\" placeholder=\"Aquadax WQ 1\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Unit ID:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_unit_id\" placeholder=\"AQ001\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Slave ID:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Register:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_register_address\" value=\"1280\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Baud Rate:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_baud_rate\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"9600\">9600</option><option value=\"19200\">19200</option><option value=\"38400\">38400</option><option value=\"115200\">115200</option></select>';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Parity:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_parity\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"none\">None</option><option value=\"even\">Even</option><option value=\"odd\">Odd</option></select></div>';"
-        "  h += '<div style=\"text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + s + ')\" style=\"background:#0d6efd;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + s + ')\" style=\"background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Save</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + s + ')\" style=\"background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + s + '\" style=\"margin-top:10px;display:none\"></div>';"
-        "  h += '</div></div></div>';"
-        "  div.innerHTML += h;"
-        "  sensorCount++;"
-        "}"
-        "function addOprussAceSensor() {"
-        "  var div = document.getElementById('water-quality-sensors-list');"
-        "  if (!div) { alert('Container not found!'); return; }"
-        "  var s = sensorCount;"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + s + '\" style=\"border:2px solid #e67e22;padding:20px;margin:15px 0\">';"
-        "  h += '<h4 style=\"color:#e67e22\">New Opruss Ace Sensor ' + (s+1) + '</h4>';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_type\" value=\"Opruss_Ace\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_data_type\" value=\"OPRUSS_ACE_FIXED\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_byte_order\" value=\"BIG_ENDIAN\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_register_type\" value=\"HOLDING\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_quantity\" value=\"22\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_scale_factor\" value=\"1.0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_height\" value=\"0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_max_water_level\" value=\"0\">';"
-        "  h += '<p style=\"color:#e67e22;font-weight:600;padding:8px;background:#fef5e7;border-radius:6px\">Opruss Ace - COD, BOD, TSS + TDS, Temp (Slave 2)</p>';"
-        "  h += '<div id=\"sensor-form-' + s + '\">';"
-        "  h += '<div style=\"display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Name:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_name\" placeholder=\"Opruss Ace WQ 1\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Unit ID:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_unit_id\" placeholder=\"OPA001\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Slave ID:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Register:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_register_address\" value=\"0\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Baud Rate:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_baud_rate\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"9600\">9600</option><option value=\"19200\">19200</option><option value=\"38400\">38400</option><option value=\"115200\">115200</option></select>';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Parity:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_parity\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"none\">None</option><option value=\"even\">Even</option><option value=\"odd\">Odd</option></select></div>';"
-        "  h += '<div style=\"text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + s + ')\" style=\"background:#e67e22;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + s + ')\" style=\"background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Save</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + s + ')\" style=\"background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + s + '\" style=\"margin-top:10px;display:none\"></div>';"
-        "  h += '</div></div></div>';"
-        "  div.innerHTML += h;"
-        "  sensorCount++;"
-        "}"
-        "function addAsterSensor() {"
-        "  var div = document.getElementById('water-quality-sensors-list');"
-        "  if (!div) { alert('Container not found!'); return; }"
-        "  var s = sensorCount;"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + s + '\" style=\"border:2px solid #8e44ad;padding:20px;margin:15px 0\">';"
-        "  h += '<h4 style=\"color:#8e44ad\">New Aster Sensor ' + (s+1) + '</h4>';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_type\" value=\"Aster\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_data_type\" value=\"ASTER_FIXED\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_byte_order\" value=\"BIG_ENDIAN\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_register_type\" value=\"HOLDING\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_quantity\" value=\"4\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_scale_factor\" value=\"0.01\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_height\" value=\"0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_max_water_level\" value=\"0\">';"
-        "  h += '<p style=\"color:#8e44ad;font-weight:600;padding:8px;background:#f4ecf7;border-radius:6px\">Aster - pH (Reg 6) + TDS (Slave 2, Reg 0) UINT16</p>';"
-        "  h += '<div id=\"sensor-form-' + s + '\">';"
-        "  h += '<div style=\"display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Name:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_name\" placeholder=\"Aster WQ 1\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Unit ID:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_unit_id\" placeholder=\"AST001\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Slave ID:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Register:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_register_address\" value=\"6\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Baud Rate:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_baud_rate\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"9600\">9600</option><option value=\"19200\">19200</option><option value=\"38400\">38400</option><option value=\"115200\">115200</option></select>';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Parity:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_parity\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"none\">None</option><option value=\"even\">Even</option><option value=\"odd\">Odd</option></select></div>';"
-        "  h += '<div style=\"text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + s + ')\" style=\"background:#8e44ad;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + s + ')\" style=\"background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Save</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + s + ')\" style=\"background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + s + '\" style=\"margin-top:10px;display:none\"></div>';"
-        "  h += '</div></div></div>';"
-        "  div.innerHTML += h;"
-        "  sensorCount++;"
-        "}"
-        "function addHardnessSensor() {"
-        "  var div = document.getElementById('water-quality-sensors-list');"
-        "  if (!div) { alert('Container not found!'); return; }"
-        "  var s = sensorCount;"
-        "  var h = '<div class=\"sensor-card\" id=\"sensor-card-' + s + '\" style=\"border:2px solid #6f42c1;padding:20px;margin:15px 0\">';"
-        "  h += '<h4 style=\"color:#6f42c1\">New Hardness Sensor ' + (s+1) + '</h4>';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_type\" value=\"Hardness_Sensor\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_data_type\" value=\"HARDNESS_FIXED\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_byte_order\" value=\"BIG_ENDIAN\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_register_type\" value=\"HOLDING\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_quantity\" value=\"6\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_scale_factor\" value=\"1.0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_sensor_height\" value=\"0\">';"
-        "  h += '<input type=\"hidden\" name=\"sensor_' + s + '_max_water_level\" value=\"0\">';"
-        "  h += '<p style=\"color:#6f42c1;font-weight:600;padding:8px;background:#f3eefb;border-radius:6px\">Hardness - Hardness (mg/L) + Temperature (&deg;C) (FLOAT32 CDAB, 6 regs from 230)</p>';"
-        "  h += '<div id=\"sensor-form-' + s + '\">';"
-        "  h += '<div style=\"display:grid;grid-template-columns:140px 1fr;gap:12px;margin-bottom:15px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Name:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_name\" placeholder=\"Hardness 1\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Unit ID:</label>';"
-        "  h += '<input type=\"text\" name=\"sensor_' + s + '_unit_id\" placeholder=\"HARD-01\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Slave ID:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Register:</label>';"
-        "  h += '<input type=\"number\" name=\"sensor_' + s + '_register_address\" value=\"230\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Baud Rate:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_baud_rate\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"9600\">9600</option><option value=\"19200\">19200</option><option value=\"38400\">38400</option><option value=\"115200\">115200</option></select>';"
-        "  h += '<label style=\"font-weight:600;padding-top:8px\">Parity:</label>';"
-        "  h += '<select name=\"sensor_' + s + '_parity\" style=\"padding:8px;border:1px solid #ccc;border-radius:4px\">';"
-        "  h += '<option value=\"none\">None</option><option value=\"even\">Even</option><option value=\"odd\">Odd</option></select></div>';"
-        "  h += '<div style=\"text-align:center;margin-top:15px;padding-top:15px;border-top:1px solid #e0e0e0\">';"
-        "  h += '<button type=\"button\" onclick=\"testNewSensorRS485(' + s + ')\" style=\"background:#6f42c1;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Test RS485</button>';"
-        "  h += '<button type=\"button\" onclick=\"saveSingleSensor(' + s + ')\" style=\"background:#28a745;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Save</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSensorForm(' + s + ')\" style=\"background:#dc3545;color:white;padding:10px 24px;border:none;border-radius:6px;font-weight:600;cursor:pointer;margin:4px\">Cancel</button>';"
-        "  h += '<div id=\"test-result-new-' + s + '\" style=\"margin-top:10px;display:none\"></div>';"
-        "  h += '</div></div></div>';"
-        "  div.innerHTML += h;"
-        "  sensorCount++;"
-        "}"
-        "var qualityParameterTypes = ["
-        "  {key: 'pH', name: 'pH', units: 'pH', description: 'Acidity/Alkalinity measurement'},"
-        "  {key: 'Temp', name: 'Temp', units: 'degC', description: 'Water temperature sensor'},"
-        "  {key: 'HUMIDITY', name: 'HUMIDITY', units: '%RH', description: 'Relative humidity measurement'},"
-        "  {key: 'TDS', name: 'TDS', units: 'ppm', description: 'Total dissolved solids concentration'},"
-        "  {key: 'TSS', name: 'TSS', units: 'mg/L', description: 'Total suspended solids'},"
-        "  {key: 'BOD', name: 'BOD', units: 'mg/L', description: 'Biochemical oxygen demand'},"
-        "  {key: 'COD', name: 'COD', units: 'mg/L', description: 'Chemical oxygen demand'},"
-        "  {key: 'conductivity', name: 'Conductivity', units: 'µS/cm', description: 'Electrical conductivity'},"
-        "  {key: 'do', name: 'Dissolved Oxygen', units: 'mg/L', description: 'Oxygen content in water'},"
-        "  {key: 'orp', name: 'ORP (Oxidation Reduction Potential)', units: 'mV', description: 'Oxidation potential'},"
-        "  {key: 'ammonia', name: 'Ammonia', units: 'mg/L', description: 'Ammonia concentration'},"
-        "  {key: 'nitrate', name: 'Nitrate', units: 'mg/L', description: 'Nitrate levels'},"
-        "  {key: 'phosphate', name: 'Phosphate', units: 'mg/L', description: 'Phosphate concentration'},"
-        "  {key: 'chlorine', name: 'Chlorine', units: 'mg/L', description: 'Chlorine disinfectant level'},"
-        "  {key: 'salinity', name: 'Salinity', units: 'ppt', description: 'Salt concentration'}"
-        "];"
-        "function addSubSensorToQualitySensor(sensorIndex) {"
-        "  var subSensorDiv = document.getElementById('sub-sensors-' + sensorIndex);"
-        "  if (!subSensorDiv) {"
-        "    alert('ERROR: Sub-sensors container not found');"
-        "    return;"
-        "  }"
-        "  "
-        "  var subSensorCount = subSensorDiv.querySelectorAll('.sub-sensor').length;"
-        "  var subSensorId = 'sub-sensor-' + sensorIndex + '-' + subSensorCount;"
-        "  "
-        "  var h = '<div class=\"sub-sensor\" id=\"' + subSensorId + '\" style=\"border:1px solid #28a745;padding:10px;margin:10px 0;background:#f8fff8;border-radius:5px\">';"
-        "  h += '<h5 style=\"color:#28a745;margin-top:0\">[PARAM] Sub-Sensor ' + (subSensorCount + 1) + '</h5>';"
-        "  h += '<div style=\"display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0\">';"
-        "  h += '<div><label style=\"font-weight:bold\">Parameter Type:</label><br><select name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_parameter\" style=\"width:100%;padding:5px\">';"
-        "  h += '<option value=\"\">Select Parameter</option>';"
-        "  for (var i = 0; i < qualityParameterTypes.length; i++) {"
-        "    var param = qualityParameterTypes[i];"
-        "    h += '<option value=\"' + param.key + '\">' + param.name + ' (' + param.units + ')</option>';"
-        "  }"
-        "  h += '</select></div>';"
-        "  h += '<div><label style=\"font-weight:bold\">Slave ID:</label><br><input type=\"number\" name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"width:100%;padding:5px\"></div>';"
-        "  h += '<div><label style=\"font-weight:bold\">Register:</label><br><input type=\"number\" name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_register\" value=\"1\" min=\"0\" max=\"65535\" style=\"width:100%;padding:5px\"></div>';"
-        "  h += '</div>';"
-        "  h += '<div style=\"display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0\">';"
-        "  h += '<div><label style=\"font-weight:bold\">Quantity:</label><br><input type=\"number\" name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_quantity\" value=\"1\" min=\"1\" max=\"10\" style=\"width:100%;padding:5px\"></div>';"
-        "  h += '<div><label style=\"font-weight:bold\">Register Type:</label><br><select name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_register_type\" style=\"width:100%;padding:5px\">';"
-        "  h += '<option value=\"HOLDING_REGISTER\" selected>Holding Register</option>';"
-        "  h += '<option value=\"INPUT_REGISTER\">Input Register</option>';"
-        "  h += '</select></div>';"
-        "  h += '</div>';"
-        "  h += '<div style=\"display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0\">';"
-        "  h += '<div><label style=\"font-weight:bold\">Data Type:</label><br><select name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_data_type\" style=\"width:100%;padding:5px\">';"
-        "  h += '<option value=\"\">Select Data Type</option>';"
-        "  h += '<optgroup label=\"8-bit Integer Types\">';"
-        "  h += '<option value=\"INT8\">INT8 - 8-bit Signed</option>';"
-        "  h += '<option value=\"UINT8\">UINT8 - 8-bit Unsigned</option>';"
-        "  h += '</optgroup>';"
-        "  h += '<optgroup label=\"16-bit Integer Types\">';"
-        "  h += '<option value=\"INT16\">INT16 - 16-bit Signed</option>';"
-        "  h += '<option value=\"UINT16\">UINT16 - 16-bit Unsigned</option>';"
-        "  h += '</optgroup>';"
-        "  h += '<optgroup label=\"32-bit Integer Types\">';"
-        "  h += '<option value=\"INT32_ABCD\">INT32_ABCD - Big Endian</option>';"
-        "  h += '<option value=\"INT32_DCBA\">INT32_DCBA - Little Endian</option>';"
-        "  h += '<option value=\"INT32_BADC\">INT32_BADC - Mid-Big Endian</option>';"
-        "  h += '<option value=\"INT32_CDAB\">INT32_CDAB - Mid-Little Endian</option>';"
-        "  h += '<option value=\"UINT32_ABCD\">UINT32_ABCD - Big Endian</option>';"
-        "  h += '<option value=\"UINT32_DCBA\">UINT32_DCBA - Little Endian</option>';"
-        "  h += '<option value=\"UINT32_BADC\">UINT32_BADC - Mid-Big Endian</option>';"
-        "  h += '<option value=\"UINT32_CDAB\">UINT32_CDAB - Mid-Little Endian</option>';"
-        "  h += '</optgroup>';"
-        "  h += '<optgroup label=\"32-bit Float Types\">';"
-        "  h += '<option value=\"FLOAT32_ABCD\">FLOAT32_ABCD - Big Endian</option>';"
-        "  h += '<option value=\"FLOAT32_DCBA\">FLOAT32_DCBA - Little Endian</option>';"
-        "  h += '<option value=\"FLOAT32_BADC\">FLOAT32_BADC - Mid-Big Endian</option>';"
-        "  h += '<option value=\"FLOAT32_CDAB\">FLOAT32_CDAB - Mid-Little Endian</option>';"
-        "  h += '</optgroup>';"
-        "  h += '<optgroup label=\"64-bit Integer Types\">';"
-        "  h += '<option value=\"INT64_12345678\">INT64_12345678 - Big Endian</option>';"
-        "  h += '<option value=\"INT64_87654321\">INT64_87654321 - Little Endian</option>';"
-        "  h += '<option value=\"INT64_21436587\">INT64_21436587 - Mid-Big Endian</option>';"
-        "  h += '<option value=\"INT64_78563412\">INT64_78563412 - Mid-Little Endian</option>';"
-        "  h += '<option value=\"UINT64_12345678\">UINT64_12345678 - Big Endian</option>';"
-        "  h += '<option value=\"UINT64_87654321\">UINT64_87654321 - Little Endian</option>';"
-        "  h += '<option value=\"UINT64_21436587\">UINT64_21436587 - Mid-Big Endian</option>';"
-        "  h += '<option value=\"UINT64_78563412\">UINT64_78563412 - Mid-Little Endian</option>';"
-        "  h += '</optgroup>';"
-        "  h += '<optgroup label=\"64-bit Float Types\">';"
-        "  h += '<option value=\"FLOAT64_12345678\">FLOAT64_12345678 - Big Endian</option>';"
-        "  h += '<option value=\"FLOAT64_87654321\">FLOAT64_87654321 - Little Endian</option>';"
-        "  h += '<option value=\"FLOAT64_21436587\">FLOAT64_21436587 - Mid-Big Endian</option>';"
-        "  h += '<option value=\"FLOAT64_78563412\">FLOAT64_78563412 - Mid-Little Endian</option>';"
-        "  h += '</optgroup>';"
-        "  h += '<optgroup label=\"Special Types\">';"
-        "  h += '<option value=\"ASCII\">ASCII String</option>';"
-        "  h += '<option value=\"HEX\">Hexadecimal</option>';"
-        "  h += '<option value=\"BOOL\">Boolean</option>';"
-        "  h += '<option value=\"PDU\">PDU (Protocol Data Unit)</option>';"
-        "  h += '</optgroup>';"
-        "  h += '</select></div>';"
-        "  h += '<div><label style=\"font-weight:bold\">Scale Factor:</label><br><input type=\"number\" name=\"sensor_' + sensorIndex + '_sub_' + subSensorCount + '_scale\" value=\"1\" step=\"0.001\" style=\"width:100%;padding:5px\"></div>';"
-        "  h += '</div>';"
-        "  h += '<div style=\"text-align:right;margin-top:10px\">';"
-        "  h += '<button type=\"button\" onclick=\"saveSubSensor(\\'' + subSensorId + '\\')\" style=\"background:#28a745;color:white;padding:5px 15px;border:none;border-radius:3px;cursor:pointer;margin-right:5px\">[SAVE] Save</button>';"
-        "  h += '<button type=\"button\" onclick=\"removeSubSensor(\\'' + subSensorId + '\\')\" style=\"background:#dc3545;color:white;padding:5px 15px;border:none;border-radius:3px;cursor:pointer\">[ERROR] Remove</button>';"
-        "  h += '</div>';"
-        "  h += '</div>';"
-        "  "
-        "  subSensorDiv.insertAdjacentHTML('beforeend', h);"
-        "  alert('Sub-sensor added! Configure its parameters and save the water quality sensor.');"
-        "}"
-        "function removeSubSensor(subSensorId) {"
-        "  var subSensor = document.getElementById(subSensorId);"
-        "  if (subSensor && confirm('Remove this sub-sensor?')) {"
-        "    subSensor.remove();"
-        "  }"
-        "}"
-        "function saveSubSensor(subSensorId) {"
-        "  alert('Sub-sensor configuration saved locally.\\n\\nClick the main SAVE button to save all changes to the device.');"
-        "}");
-    
-    // Sensor type form update function
-    httpd_resp_sendstr_chunk(req,
-        "function updateSensorForm(sensorId) {"
-        "const sensorType = document.querySelector('select[name=\"sensor_' + sensorId + '_sensor_type\"]').value;"
-        "const formDiv = document.getElementById('sensor-form-' + sensorId);"
-        "if (!sensorType) {"
-        "formDiv.style.display = 'none';"
-        "return;"
-        "}"
-        "let formHtml = '';"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Name:</label>';"
-        "formHtml += '<div><input type=\"text\" name=\"sensor_' + sensorId + '_name\" placeholder=\"e.g., Flow Meter 1\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Sensor display name</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Unit ID:</label>';"
-        "formHtml += '<div><input type=\"text\" name=\"sensor_' + sensorId + '_unit_id\" placeholder=\"e.g., FG1234\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Unique identifier for this sensor</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Slave ID:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Modbus slave address (1-247)</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Register Address:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_register_address\" value=\"0\" min=\"0\" max=\"65535\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Starting register to read (0-65535)</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Quantity:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_quantity\" value=\"1\" min=\"1\" max=\"125\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Number of registers to read (1-125)</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Register Type:</label>';"
-        "formHtml += '<div><select name=\"sensor_' + sensorId + '_register_type\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<option value=\"HOLDING\">Holding Registers (03) - Read/Write</option>';"
-        "formHtml += '<option value=\"INPUT\">Input Registers (04) - Read Only</option>';"
-        "formHtml += '</select>';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Modbus register type</small></div>';"
-        "formHtml += '</div>';"
-        "if (sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && sensorType !== 'Panda_USM' && sensorType !== 'Aquadax_Quality' && sensorType !== 'Opruss_Ace' && sensorType !== 'Hardness_Sensor') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Data Type:</label>';"
-        "formHtml += '<div><select name=\"sensor_' + sensorId + '_data_type\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\" onchange=\"showDataTypeInfo(this, ' + sensorId + ')\">';"
-        "formHtml += '<option value=\"\" disabled selected>-- Select Data Type (Required) --</option>';"
-        "formHtml += '<optgroup label=\"8-bit Formats (0.5 register)\">';"
-        "formHtml += '<option value=\"INT8\">8-bit INT (-128 to 127)</option>';"
-        "formHtml += '<option value=\"UINT8\">8-bit UINT (0 to 255)</option>';"
-        "formHtml += '</optgroup>';"
-        "formHtml += '<optgroup label=\"16-bit Formats (1 register)\">';"
-        "formHtml += '<option value=\"INT16_HI\">16-bit INT, high byte first</option>';"
-        "formHtml += '<option value=\"INT16_LO\">16-bit INT, low byte first</option>';"
-        "formHtml += '<option value=\"UINT16_HI\">16-bit UINT, high byte first</option>';"
-        "formHtml += '<option value=\"UINT16_LO\">16-bit UINT, low byte first</option>';"
-        "formHtml += '</optgroup>';"
-        "formHtml += '<optgroup label=\"32-bit Float Formats (2 registers)\">';"
-        "formHtml += '<option value=\"FLOAT32_1234\">32-bit float, Byte order 1,2,3,4</option>';"
-        "formHtml += '<option value=\"FLOAT32_4321\">32-bit float, Byte order 4,3,2,1</option>';"
-        "formHtml += '<option value=\"FLOAT32_2143\">32-bit float, Byte order 2,1,4,3</option>';"
-        "formHtml += '<option value=\"FLOAT32_3412\">32-bit float, Byte order 3,4,1,2</option>';"
-        "formHtml += '</optgroup>';"
-        "formHtml += '<optgroup label=\"32-bit Integer Formats (2 registers)\">';"
-        "formHtml += '<option value=\"INT32_1234\">32-bit INT, Byte order 1,2,3,4</option>';"
-        "formHtml += '<option value=\"INT32_4321\">32-bit INT, Byte order 4,3,2,1</option>';"
-        "formHtml += '<option value=\"INT32_2143\">32-bit INT, Byte order 2,1,4,3</option>';"
-        "formHtml += '<option value=\"INT32_3412\">32-bit INT, Byte order 3,4,1,2</option>';"
-        "formHtml += '<option value=\"UINT32_1234\">32-bit UINT, Byte order 1,2,3,4</option>';"
-        "formHtml += '<option value=\"UINT32_4321\">32-bit UINT, Byte order 4,3,2,1</option>';"
-        "formHtml += '<option value=\"UINT32_2143\">32-bit UINT, Byte order 2,1,4,3</option>';"
-        "formHtml += '<option value=\"UINT32_3412\">32-bit UINT, Byte order 3,4,1,2</option>';"
-        "formHtml += '</optgroup>';"
-        "formHtml += '<optgroup label=\"64-bit Integer Formats (4 registers)\">';"
-        "formHtml += '<option value=\"INT64_12345678\">64-bit INT, Byte order 1,2,3,4,5,6,7,8</option>';"
-        "formHtml += '<option value=\"INT64_87654321\">64-bit INT, Byte order 8,7,6,5,4,3,2,1</option>';"
-        "formHtml += '<option value=\"INT64_21436587\">64-bit INT, Byte order 2,1,4,3,6,5,8,7</option>';"
-        "formHtml += '<option value=\"INT64_78563412\">64-bit INT, Byte order 7,8,5,6,3,4,1,2</option>';"
-        "formHtml += '<option value=\"UINT64_12345678\">64-bit UINT, Byte order 1,2,3,4,5,6,7,8</option>';"
-        "formHtml += '<option value=\"UINT64_87654321\">64-bit UINT, Byte order 8,7,6,5,4,3,2,1</option>';"
-        "formHtml += '<option value=\"UINT64_21436587\">64-bit UINT, Byte order 2,1,4,3,6,5,8,7</option>';"
-        "formHtml += '<option value=\"UINT64_78563412\">64-bit UINT, Byte order 7,8,5,6,3,4,1,2</option>';"
-        "formHtml += '</optgroup>';"
-        "formHtml += '<optgroup label=\"64-bit Float Formats (4 registers)\">';"
-        "formHtml += '<option value=\"FLOAT64_12345678\">64-bit float, Byte order 1,2,3,4,5,6,7,8</option>';"
-        "formHtml += '<option value=\"FLOAT64_87654321\">64-bit float, Byte order 8,7,6,5,4,3,2,1</option>';"
-        "formHtml += '<option value=\"FLOAT64_21436587\">64-bit float, Byte order 2,1,4,3,6,5,8,7</option>';"
-        "formHtml += '<option value=\"FLOAT64_78563412\">64-bit float, Byte order 7,8,5,6,3,4,1,2</option>';"
-        "formHtml += '</optgroup>';"
-        "formHtml += '<optgroup label=\"Special Formats\">';"
-        "formHtml += '<option value=\"ASCII\">ASCII String</option>';"
-        "formHtml += '<option value=\"HEX\">Hexadecimal</option>';"
-        "formHtml += '<option value=\"BOOL\">Boolean (True/False)</option>';"
-        "formHtml += '<option value=\"PDU\">PDU (Protocol Data Unit)</option>';"
-        "formHtml += '</optgroup></select>';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Select the format of data returned by sensor</small></div>';"
-        "formHtml += '</div>';"
-        "formHtml += '<div id=\"datatype-info-' + sensorId + '\" style=\"background:#e3f2fd;padding:15px;margin:20px 0;border-radius:6px;font-size:13px;display:none\"></div>';"
-        "} else if (sensorType === 'ZEST') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"ZEST_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - INT32_BE + INT32_LE_SWAP</p>';"
-        "} else if (sensorType === 'Clampon') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"CLAMPON_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - INT32 + FLOAT32 (word-swapped)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Clampon defaults: Register 8, Quantity 4 - Integer (2 reg) + Float decimal (2 reg)</em></p>';"
-        "} else if (sensorType === 'Dailian') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"UINT32_3412\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - UINT32_3412 (CDAB byte order)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Dailian Ultrasonic defaults: Register 8, Quantity 2 - 32-bit value</em></p>';"
-        "} else if (sensorType === 'Dailian_EMF') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"DAILIAN_EMF_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - UINT32 word-swapped (Totaliser)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Dailian EMF defaults: Register 2006 (0x07D6), Quantity 2 - 32-bit totaliser value</em></p>';"
-        "} else if (sensorType === 'Panda_EMF') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"PANDA_EMF_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - INT32_BE (Integer) + FLOAT32_BE (Decimal)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Panda EMF defaults: Register 4114 (0x1012), Quantity 4 - Totaliser (Integer + Float decimal)</em></p>';"
-        "} else if (sensorType === 'Panda_Level') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"PANDA_LEVEL_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - UINT16 (16-bit level value)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Panda Level defaults: Register 1 (0x0001), Quantity 1 - Level percentage = ((Sensor Height - Value) / Tank Height) × 100</em></p>';"
-        "} else if (sensorType === 'Hydrostatic_Level') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"UINT16_BE\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - UINT16_BE (16-bit unsigned)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Hydrostatic Level defaults: Register 4 (0x0004), Quantity 1 - Level percentage = (Raw Value / Tank Height) × 100</em></p>';"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Tank Height (m):</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_max_water_level\" value=\"0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Total tank height for level % calculation (Level % = Raw Value / Tank Height × 100)</small></div></div>';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_sensor_height\" value=\"0\">';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\">';"
-        "} else if (sensorType === 'Aquadax_Quality') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"AQUADAX_QUALITY_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - 5x FLOAT32 CDAB (word-swap)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Aquadax Quality defaults: Address 1280 (0x0500), Qty 12 - Reads COD, BOD, TSS, pH, Temperature as Float32</em></p>';"
-        "} else if (sensorType === 'Opruss_Ace') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"OPRUSS_ACE_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - COD/BOD/TSS (FLOAT32 CDAB) + TDS/Temp from Slave 2 (FLOAT32 DCBA)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Opruss Ace: Address 0, Qty 22 (COD/BOD/TSS) + Slave 2 Input Reg 0x0016 (TDS) &amp; 0x0020 (Temp)</em></p>';"
-        "} else if (sensorType === 'Aster') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"ASTER_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px\"><b>Aster:</b> pH UINT16x0.01 (Reg 6) + TDS UINT16 (Slave 2, Reg 0)</p>';"
-        "} else if (sensorType === 'Hardness_Sensor') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"HARDNESS_FIXED\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - 2x FLOAT32 CDAB (word-swap)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Hardness defaults: Address 230 (0x00E6), Qty 6 - Reads Hardness (mg/L) and Temperature (&deg;C)</em></p>';"
-        "} else if (sensorType === 'Piezometer') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"UINT16_HI\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:12px;margin:10px 0\"><strong>Data Format:</strong> Fixed - UINT16_HI (16-bit unsigned integer)</p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Piezometer defaults: Register 10, Quantity 1, Scale 0.01 - reads water level in mwc (e.g., 14542 × 0.01 = 145.42 mwc)</em></p>';"
-        "}"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Baud Rate:</label>';"
-        "formHtml += '<div><select name=\"sensor_' + sensorId + '_baud_rate\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<option value=\"2400\">2400 bps</option><option value=\"4800\">4800 bps</option><option value=\"9600\" selected>9600 bps</option><option value=\"19200\">19200 bps</option><option value=\"38400\">38400 bps</option><option value=\"57600\">57600 bps</option><option value=\"115200\">115200 bps</option></select>';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Serial communication speed</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Parity:</label>';"
-        "formHtml += '<div><select name=\"sensor_' + sensorId + '_parity\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<option value=\"none\" selected>None</option><option value=\"even\">Even</option><option value=\"odd\">Odd</option></select>';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Error checking method</small></div>';"
-        "formHtml += '</div>';"
-        "if (sensorType === 'Flow-Meter') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Multiplier applied to raw sensor value (e.g., 0.1 for /10, 1.0 for no scaling)</small></div></div>';"
-        "} else if (sensorType === 'Panda_USM') {"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_data_type\" value=\"FLOAT64_12345678\">';"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Multiplier for positive volume (usually 1.0)</small></div></div>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - FLOAT64_12345678 (Big-Endian Double) - no data type selection needed</strong></p>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>Panda USM defaults: Register 8 (Positive Volume), Quantity 4 (64-bit Double)</em></p>';"
-        "} else if (sensorType === 'Level') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Sensor Height:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_sensor_height\" value=\"0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Physical height of the sensor from bottom (meters or your unit)</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Max Water Level:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_max_water_level\" value=\"0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Maximum water level for calculation (meters or your unit)</small></div></div>';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\">';"
-        "} else if (sensorType === 'Radar Level') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Max Water Level:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_max_water_level\" value=\"0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Maximum water level for percentage calculation (meters or your unit)</small></div></div>';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_sensor_height\" value=\"0\">';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\">';"
-        "} else if (sensorType === 'ENERGY') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Meter Type:</label>';"
-        "formHtml += '<div><input type=\"text\" name=\"sensor_' + sensorId + '_meter_type\" placeholder=\"e.g., Power Meter, Electric Meter\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Type of energy meter (will be used as meter identifier in JSON)</small></div></div>';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\">';"
-        "} else if (sensorType === 'RAINGAUGE') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Rain gauge scaling factor (e.g., 0.1 for mm/tips, 1.0 for direct reading)</small></div></div>';"
-        "} else if (sensorType === 'BOREWELL') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Scaling multiplier for borewell measurements</small></div></div>';"
-        "} else if (sensorType === 'ZEST') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Applied to both INT32 values</small></div></div>';"
-        "formHtml += '<p style=\"color:#007bff;font-size:11px;margin:5px 0\"><em>ZEST defaults: Register 4121, Quantity 4 - First 2 as INT32_BE, next 2 as INT32_LE_SWAP, then sums them</em></p>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:10px;margin:5px 0\"><strong>Fixed format - no data type selection needed</strong></p>';"
-        "} else if (sensorType === 'Clampon') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Multiplier for raw value</small></div></div>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - INT32 + FLOAT32 (word-swapped) - no data type selection needed</strong></p>';"
-        "} else if (sensorType === 'Dailian') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Value multiplier</small></div></div>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - UINT32_3412 (CDAB) - no data type selection needed</strong></p>';"
-        "} else if (sensorType === 'Dailian_EMF') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Multiplier for totaliser value</small></div></div>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - UINT32 word-swapped (Dailian EMF) - no data type selection needed</strong></p>';"
-        "} else if (sensorType === 'Panda_EMF') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Multiplier for totaliser value</small></div></div>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - INT32_BE + FLOAT32_BE (Panda EMF) - no data type selection needed</strong></p>';"
-        "} else if (sensorType === 'Panda_Level') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Sensor Height (m):</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_sensor_height\" value=\"0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Distance from sensor to bottom of tank (meters)</small></div>';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Tank Height (m):</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_max_water_level\" value=\"0\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #ccc;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">Total tank height for percentage calculation</small></div></div>';"
-        "formHtml += '<input type=\"hidden\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"1.0\">';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - UINT16 (Panda Level) - Level % = ((Sensor Height - Raw Value) / Tank Height) × 100</strong></p>';"
-        "} else if (sensorType === 'Piezometer') {"
-        "formHtml += '<div style=\"display:grid;grid-template-columns:180px 1fr;gap:20px;align-items:start;margin-top:20px\">';"
-        "formHtml += '<label style=\"font-weight:600;padding-top:10px\">Scale Factor:</label>';"
-        "formHtml += '<div><input type=\"number\" name=\"sensor_' + sensorId + '_scale_factor\" value=\"0.01\" step=\"any\" style=\"width:100%;padding:10px;border:1px solid #e0e0e0;border-radius:6px;font-size:15px\">';"
-        "formHtml += '<small style=\"color:#888;display:block;margin-top:5px;font-size:13px\">0.01 for 2 implicit decimals: 14542 = 145.42</small></div></div>';"
-        "formHtml += '<p style=\"color:#28a745;font-size:13px;margin:15px 0;padding:10px;background:#f0fff4;border:1px solid #28a745;border-radius:4px\"><strong>Fixed format - UINT16_HI (16-bit) - no data type selection needed</strong></p>';"
-        "}"
+static esp_err_t web_asset_handler(httpd_req_t *req)
+{
+    return web_asset_send(req, (web_asset_t *)req->user_ctx);
+}
 
-        "formHtml += '<br>';"
-        "formDiv.innerHTML = formHtml;"
-        "formDiv.style.display = 'block';"
-        "if (sensorType === 'Clampon') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "if (quantityInput) quantityInput.value = '4';"
-        "if (regAddrInput) regAddrInput.value = '8';"
-        "} else if (sensorType === 'Dailian') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '2';"
-        "if (regAddrInput) regAddrInput.value = '8';"
-        "if (scaleInput) scaleInput.value = '1.0';"
-        "} else if (sensorType === 'Dailian_EMF') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '2';"
-        "if (regAddrInput) regAddrInput.value = '2006';"
-        "if (scaleInput) scaleInput.value = '1.0';"
-        "} else if (sensorType === 'Panda_EMF') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '4';"
-        "if (regAddrInput) regAddrInput.value = '4114';"
-        "if (scaleInput) scaleInput.value = '1.0';"
-        "} else if (sensorType === 'Panda_Level') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "if (quantityInput) quantityInput.value = '1';"
-        "if (regAddrInput) regAddrInput.value = '1';"
-        "} else if (sensorType === 'Hydrostatic_Level') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "if (quantityInput) quantityInput.value = '1';"
-        "if (regAddrInput) regAddrInput.value = '4';"
-        "} else if (sensorType === 'Piezometer') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '1';"
-        "if (regAddrInput) regAddrInput.value = '10';"
-        "if (scaleInput) scaleInput.value = '0.01';"
-        "} else if (sensorType === 'Panda_USM') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '4';"
-        "if (regAddrInput) regAddrInput.value = '8';"
-        "if (scaleInput) scaleInput.value = '1.0';"
-        "} else if (sensorType === 'ZEST') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "if (quantityInput) quantityInput.value = '4';"
-        "if (regAddrInput) regAddrInput.value = '4121';"
-        "} else if (sensorType === 'Aquadax_Quality') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "if (quantityInput) quantityInput.value = '12';"
-        "if (regAddrInput) regAddrInput.value = '1280';"
-        "} else if (sensorType === 'Opruss_Ace') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '22';"
-        "if (regAddrInput) regAddrInput.value = '0';"
-        "if (scaleInput) scaleInput.value = '1.0';"
-        "} else if (sensorType === 'Aster') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '4';"
-        "if (regAddrInput) regAddrInput.value = '6';"
-        "if (scaleInput) scaleInput.value = '0.01';"
-        "} else if (sensorType === 'Hardness_Sensor') {"
-        "const quantityInput = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "const regAddrInput = document.querySelector('input[name=\"sensor_' + sensorId + '_register_address\"]');"
-        "const scaleInput = document.querySelector('input[name=\"sensor_' + sensorId + '_scale_factor\"]');"
-        "if (quantityInput) quantityInput.value = '6';"
-        "if (regAddrInput) regAddrInput.value = '230';"
-        "if (scaleInput) scaleInput.value = '1.0';"
-        "}"
-        "}");
-
-
-    // Data type information and helper functions
-    httpd_resp_sendstr_chunk(req,
-        "function showDataTypeInfo(selectElement, sensorId) {"
-        "const infoDiv = document.getElementById('datatype-info-' + sensorId);"
-        "const dataType = selectElement.value;"
-        "let infoHtml = '';"
-        "if(dataType.startsWith('UINT16')) {"
-        "const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';"
-        "infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Unsigned</strong><br>- Range: 0 to 65,535<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Counters, status flags, small measurements<br>- Registers: 1';"
-        "} else if(dataType.startsWith('INT16')) {"
-        "const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';"
-        "infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Signed</strong><br>- Range: -32,768 to 32,767<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Temperature, pressure differences, signed measurements<br>- Registers: 1';"
-        "} else if(dataType.startsWith('UINT32')) {"
-        "const order = dataType.split('_')[1];"
-        "let orderDesc = '';"
-        "switch(order) {"
-        "case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;"
-        "case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;"
-        "case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;"
-        "case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;"
-        "}"
-        "infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: 0 to 4,294,967,295<br>- Byte Order: ' + order + '<br>- Uses: Large counters, totalizers, flow accumulators<br>- Registers: 2';"
-        "} else if(dataType.startsWith('INT32')) {"
-        "const order = dataType.split('_')[1];"
-        "let orderDesc = '';"
-        "switch(order) {"
-        "case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;"
-        "case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;"
-        "case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;"
-        "case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;"
-        "}"
-        "infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: -2,147,483,648 to 2,147,483,647<br>- Byte Order: ' + order + '<br>- Uses: Large signed measurements, differences<br>- Registers: 2';"
-        "} else if(dataType.startsWith('FLOAT32')) {"
-        "const order = dataType.split('_')[1];"
-        "let orderDesc = '';"
-        "switch(order) {"
-        "case 'ABCD': orderDesc = 'Big Endian IEEE 754'; break;"
-        "case 'DCBA': orderDesc = 'Little Endian IEEE 754'; break;"
-        "case 'BADC': orderDesc = 'Mid-Big Endian IEEE 754'; break;"
-        "case 'CDAB': orderDesc = 'Mid-Little Endian IEEE 754'; break;"
-        "}"
-        "infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: +/-3.4E+/-38 (7 decimal digits)<br>- Byte Order: ' + order + '<br>- Uses: Precise measurements, flow rates, calculated values<br>- Registers: 2';"
-        "}"
-        "infoDiv.innerHTML = infoHtml;"
-        "infoDiv.style.display = 'block';"
-        
-        "const quantityField = document.querySelector('input[name=\"sensor_' + sensorId + '_quantity\"]');"
-        "if (quantityField) {"
-        "if (dataType.startsWith('UINT16') || dataType.startsWith('INT16')) {"
-        "quantityField.value = '1';"
-        "} else if (dataType.startsWith('UINT32') || dataType.startsWith('INT32') || dataType.startsWith('FLOAT32')) {"
-        "quantityField.value = '2';"
-        "}"
-        "}"
-        "}"
-        
-        "function showEditDataTypeInfo(selectElement, sensorId) {"
-        "const infoDiv = document.getElementById('edit-datatype-info-' + sensorId);"
-        "const dataType = selectElement.value;"
-        "let infoHtml = '';"
-        "if(dataType.startsWith('UINT16')) {"
-        "const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';"
-        "infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Unsigned</strong><br>- Range: 0 to 65,535<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Counters, status flags, small measurements<br>- Registers: 1';"
-        "} else if(dataType.startsWith('INT16')) {"
-        "const endian = dataType.includes('BE') ? 'Big Endian' : 'Little Endian';"
-        "infoHtml = '<strong>' + dataType + ' - ' + endian + ' 16-bit Signed</strong><br>- Range: -32,768 to 32,767<br>- Byte Order: ' + (dataType.includes('BE') ? 'AB (High-Low)' : 'BA (Low-High)') + '<br>- Uses: Temperature, pressure differences, signed measurements<br>- Registers: 1';"
-        "} else if(dataType.startsWith('UINT32')) {"
-        "const order = dataType.split('_')[1];"
-        "let orderDesc = '';"
-        "switch(order) {"
-        "case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;"
-        "case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;"
-        "case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;"
-        "case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;"
-        "}"
-        "infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: 0 to 4,294,967,295<br>- Byte Order: ' + order + '<br>- Uses: Large counters, totalizers, flow accumulators<br>- Registers: 2';"
-        "} else if(dataType.startsWith('INT32')) {"
-        "const order = dataType.split('_')[1];"
-        "let orderDesc = '';"
-        "switch(order) {"
-        "case 'ABCD': orderDesc = 'Big Endian - Reg0(AB) + Reg1(CD)'; break;"
-        "case 'DCBA': orderDesc = 'Little Endian - Completely byte-swapped'; break;"
-        "case 'BADC': orderDesc = 'Mid-Big Endian - Word swap only'; break;"
-        "case 'CDAB': orderDesc = 'Mid-Little Endian - Mixed byte/word swap'; break;"
-        "}"
-        "infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: -2,147,483,648 to 2,147,483,647<br>- Byte Order: ' + order + '<br>- Uses: Large signed measurements, differences<br>- Registers: 2';"
-        "} else if(dataType.startsWith('FLOAT32')) {"
-        "const order = dataType.split('_')[1];"
-        "let orderDesc = '';"
-        "switch(order) {"
-        "case 'ABCD': orderDesc = 'Big Endian IEEE 754'; break;"
-        "case 'DCBA': orderDesc = 'Little Endian IEEE 754'; break;"
-        "case 'BADC': orderDesc = 'Mid-Big Endian IEEE 754'; break;"
-        "case 'CDAB': orderDesc = 'Mid-Little Endian IEEE 754'; break;"
-        "}"
-        "infoHtml = '<strong>' + dataType + ' - ' + orderDesc + '</strong><br>- Range: +/-3.4E+/-38 (7 decimal digits)<br>- Byte Order: ' + order + '<br>- Uses: Precise measurements, flow rates, calculated values<br>- Registers: 2';"
-        "}"
-        "infoDiv.innerHTML = infoHtml;"
-        "infoDiv.style.display = 'block';"
-        
-        "const quantityField = document.getElementById('edit_quantity_' + sensorId);"
-        "if (quantityField) {"
-        "if (dataType.startsWith('UINT16') || dataType.startsWith('INT16')) {"
-        "quantityField.value = '1';"
-        "} else if (dataType.startsWith('UINT32') || dataType.startsWith('INT32') || dataType.startsWith('FLOAT32')) {"
-        "quantityField.value = '2';"
-        "}"
-        "}"
-        "}"
+// /section/<id> - one portal section as an HTML fragment
+static esp_err_t web_section_handler(httpd_req_t *req)
+{
+    const char *id = req->uri + strlen("/section/");
+    size_t id_len = strcspn(id, "?");
 
-        "function saveSingleSensor(sensorId) {"
-        "console.log('Saving sensor:', sensorId);"
-        "const nameField = document.querySelector('input[name=\"sensor_' + sensorId + '_name\"]');"
-        "const unitIdField = document.querySelector('input[name=\"sensor_' + sensorId + '_unit_id\"]');"
-        "console.log('Name field:', nameField, 'Value:', nameField ? nameField.value : 'NOT FOUND');"
-        "console.log('Unit ID field:', unitIdField, 'Value:', unitIdField ? unitIdField.value : 'NOT FOUND');"
-        "if (!nameField || !unitIdField) {"
-        "alert('ERROR: Cannot find sensor form fields. Please try adding the sensor again.');"
-        "return;"
-        "}"
-        "const name = nameField.value.trim();"
-        "const unitId = unitIdField.value.trim();"
-        "if (!name || !unitId) {"
-        "alert('ERROR: Please fill in required fields:\\n\\n- Sensor Name: \"' + name + '\"\\n- Unit ID: \"' + unitId + '\"\\n\\nBoth fields must have values.');"
-        "return;"
-        "}"
-        "console.log('Building form data for sensor:', sensorId);"
-        "const formData = new URLSearchParams();"
-        "const sensorFields = document.querySelectorAll('input[name^=\"sensor_' + sensorId + '_\"], select[name^=\"sensor_' + sensorId + '_\"]');"
-        "console.log('Found', sensorFields.length, 'sensor fields');"
-        "sensorFields.forEach(field => {"
-        "console.log('Adding field:', field.name, '=', field.value);"
-        "formData.append(field.name, field.value);"
-        "});"
-        "console.log('Form data:', formData.toString());"
-        "fetch('/save_single_sensor', {method: 'POST', headers: {'Content-Type': 'application/x-www-form-urlencoded'}, body: formData})"
-        ".then(response => response.json()).then(data => {"
-        "console.log('Save response:', data);"
-        "if(data.status === 'success') {"
-        "alert('SUCCESS: Sensor saved successfully!\\n\\nSensor: ' + data.sensor_name + '\\nUnit ID: ' + data.unit_id + '\\n\\nYou can now test this sensor using the Test RS485 button.');"
-        "sessionStorage.setItem('showSection', 'sensors');"
-        "window.location.reload();"
-        "} else {"
-        "alert('ERROR: Failed to save sensor:\\n\\n' + data.message);"
-        "}"
-        "}).catch(e => {"
-        "console.error('Save error:', e);"
-        "alert('ERROR: Save failed: ' + e.message);"
-        "});"
-        "}"
-        
-        "function removeSensorForm(sensorId){"
-        "if(confirm('Remove this sensor form?\\n\\nThis will only remove the form - no saved sensors will be deleted.')) {"
-        "const sensorCard=document.getElementById('sensor-card-'+sensorId);"
-        "if(sensorCard){sensorCard.remove();}"
-        "}}"
-        
-        "function togglePassword(){"
-        "const input=document.getElementById('wifi_password');"
-        "const toggle=event.target;"
-        "if(input.type==='password'){input.type='text';toggle.textContent='HIDE';}else{input.type='password';toggle.textContent='SHOW';}"
-        "}"
-        // toggleAzurePassword, toggleNetworkMode, toggleSDOptions, toggleRTCOptions
-        // moved to html_header <script> to ensure they load before window.onload
-        "let simTestPollInterval=null;"
-        "function testSIMConnection(){"
-        "const result=document.getElementById('sim_test_result');"
-        "result.innerHTML='<div style=\"text-align:center\">⏳ Starting SIM test...<br><small>Please wait</small></div>';"
-        "result.style.display='block';"
-        "result.style.backgroundColor='#fff3cd';"
-        "result.style.color='#856404';"
-        "fetch('/api/sim_test',{method:'POST'})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.status==='started'){"
-        "result.innerHTML='<div style=\"text-align:center\">⏳ Testing SIM connection...<br><small>Initializing modem and connecting to network (this may take up to 30 seconds)</small></div>';"
-        "if(simTestPollInterval) clearInterval(simTestPollInterval);"
-        "simTestPollInterval=setInterval(checkSIMTestStatus,2000);"
-        "}else{"
-        "result.innerHTML='<span style=\"color:#721c24\">❌ Failed to start test: '+data.message+'</span>';"
-        "result.style.backgroundColor='#f8d7da';"
-        "}"
-        "})"
-        ".catch(err=>{"
-        "result.innerHTML='<span style=\"color:#721c24\">❌ Test failed: '+err+'</span>';"
-        "result.style.backgroundColor='#f8d7da';"
-        "});"
-        "}"
-        "function checkSIMTestStatus(){"
-        "fetch('/api/sim_test_status')"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "const result=document.getElementById('sim_test_result');"
-        "if(data.status==='in_progress'){"
-        "return;"
-        "}"
-        "if(simTestPollInterval){"
-        "clearInterval(simTestPollInterval);"
-        "simTestPollInterval=null;"
-        "}"
-        "if(data.status==='completed'){"
-        "if(data.success){"
-        "let msg='<div style=\"color:#155724\"><strong>✅ SIM Module Connected Successfully!</strong><br>';"
-        "msg+='<div style=\"margin-top:10px;font-size:14px;line-height:1.6\">';"
-        "msg+='<strong>📡 IP Address:</strong> <span style=\"background:#e7f3ff;padding:2px 8px;border-radius:3px;font-family:monospace\">'+data.ip+'</span><br>';"
-        "msg+='<strong>📶 Signal:</strong> '+data.signal+' dBm ('+data.signal_quality+')<br>';"
-        "msg+='<strong>📱 Operator:</strong> '+data.operator+'<br>';"
-        "msg+='<strong>🌐 APN:</strong> '+data.apn+'<br>';"
-        "msg+='</div>';"
-        "msg+='<div style=\"margin-top:10px;padding:10px;background:#d1ecf1;border-left:4px solid #17a2b8;border-radius:4px;color:#0c5460\">';"
-        "msg+='✓ Modem is working correctly<br>';"
-        "msg+='✓ Network registration successful<br>';"
-        "msg+='✓ Internet connectivity established';"
-        "msg+='</div></div>';"
-        "result.innerHTML=msg;"
-        "result.style.backgroundColor='#d4edda';"
-        "result.style.color='#155724';"
-        "}else{"
-        "let msg='<div style=\"color:#721c24\"><strong>❌ SIM Connection Failed</strong><br>';"
-        "msg+='<div style=\"margin-top:8px;font-size:14px\">'+data.error+'</div>';"
-        "if(data.signal){"
-        "msg+='<div style=\"margin-top:10px;padding:8px;background:#fff3cd;border-radius:4px;color:#856404\">';"
-        "msg+='📶 Signal: '+data.signal+' dBm';"
-        "if(data.operator){msg+=' | Operator: '+data.operator;}"
-        "msg+='</div>';"
-        "}"
-        "msg+='</div>';"
-        "result.innerHTML=msg;"
-        "result.style.backgroundColor='#f8d7da';"
-        "result.style.color='#721c24';"
-        "}"
-        "}"
-        "})"
-        ".catch(err=>console.error('Poll error:',err));"
-        "}"
-        "function checkSDStatus(){"
-        "const result=document.getElementById('sd_status_result');"
-        "result.innerHTML='Checking SD card...';"
-        "result.style.display='block';"
-        "result.style.backgroundColor='#fff3cd';"
-        "fetch('/api/sd_status')"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.mounted){"
-        "result.innerHTML='<span style=\"color:#155724\">SD Card: '+data.size_mb+' MB total, '+data.free_mb+' MB free, '+data.cached_messages+' messages cached</span>';"
-        "result.style.backgroundColor='#d4edda';"
-        "}else{"
-        "result.innerHTML='<span style=\"color:#721c24\">SD Card not mounted</span>';"
-        "result.style.backgroundColor='#f8d7da';"
-        "}"
-        "})"
-        ".catch(err=>{"
-        "result.innerHTML='<span style=\"color:#721c24\">Failed to check SD: '+err+'</span>';"
-        "result.style.backgroundColor='#f8d7da';"
-        "});"
-        "}"
-        "function replayCachedMessages(){"
-        "if(!confirm('Replay all cached messages now?'))return;"
-        "fetch('/api/sd_replay',{method:'POST'})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.success){"
-        "alert('Replayed '+data.count+' messages successfully');"
-        "}else{"
-        "alert('Replay failed: '+data.error);"
-        "}"
-        "})"
-        ".catch(err=>{alert('Replay failed: '+err);});"
-        "}"
-        "function clearCachedMessages(){"
-        "if(!confirm('Clear all cached messages? This cannot be undone!'))return;"
-        "fetch('/api/sd_clear',{method:'POST'})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.success){"
-        "alert('Cleared '+data.count+' cached messages');"
-        "}else{"
-        "alert('Clear failed: '+data.error);"
-        "}"
-        "})"
-        ".catch(err=>{alert('Clear failed: '+err);});"
-        "}"
-        "function getRTCTime(){"
-        "const result=document.getElementById('rtc_time_result');"
-        "result.innerHTML='Reading RTC...';"
-        "result.style.display='block';"
-        "result.style.backgroundColor='#fff3cd';"
-        "fetch('/api/rtc_time')"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.success){"
-        "result.innerHTML='<span style=\"color:#155724\">RTC Time: '+data.time+', Temperature: '+data.temp+'C</span>';"
-        "result.style.backgroundColor='#d4edda';"
-        "}else{"
-        "result.innerHTML='<span style=\"color:#721c24\">RTC not available</span>';"
-        "result.style.backgroundColor='#f8d7da';"
-        "}"
-        "})"
-        ".catch(err=>{"
-        "result.innerHTML='<span style=\"color:#721c24\">Failed to read RTC: '+err+'</span>';"
-        "result.style.backgroundColor='#f8d7da';"
-        "});"
-        "}"
-        "function syncRTCFromNTP(){"
-        "if(!confirm('Sync RTC from NTP now? Requires internet connection.'))return;"
-        "fetch('/api/rtc_sync',{method:'POST'})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.success){"
-        "alert('RTC synced successfully from NTP');"
-        "}else{"
-        "alert('RTC sync failed: '+data.error);"
-        "}"
-        "})"
-        ".catch(err=>{alert('RTC sync failed: '+err);});"
-        "}"
-        "function syncSystemFromRTC(){"
-        "if(!confirm('Sync system time from RTC now?'))return;"
-        "fetch('/api/rtc_set',{method:'POST'})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.success){"
-        "alert('System time synced from RTC');"
-        "}else{"
-        "alert('Sync failed: '+data.error);"
-        "}"
-        "})"
-        ".catch(err=>{alert('Sync failed: '+err);});"
-        "}"
-        "function saveNetworkMode(e){"
-        "e.preventDefault();"
-        "const formData=new URLSearchParams(new FormData(e.target));"
-        "const resultDiv=document.getElementById('network_mode_result');"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">Saving network mode...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "fetch('/save_network_mode',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "setTimeout(()=>{"
-        "resultDiv.style.display='none';"
-        "},3000);"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#721c24\">❌ Failed to save: '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "}"
-        "})"
-        ".catch(err=>{"
-        "resultDiv.innerHTML='<span style=\"color:#721c24\">❌ Error: '+err+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "});"
-        "return false;"
-        "}"
-        "function saveSDConfig(){"
-        "const formData=new URLSearchParams();"
-        "if(document.getElementById('sd_enabled').checked) formData.append('sd_enabled','1');"
-        "if(document.getElementById('sd_cache_on_failure').checked) formData.append('sd_cache_on_failure','1');"
-        "formData.append('sd_mosi',document.getElementById('sd_mosi').value);"
-        "formData.append('sd_miso',document.getElementById('sd_miso').value);"
-        "formData.append('sd_clk',document.getElementById('sd_clk').value);"
-        "formData.append('sd_cs',document.getElementById('sd_cs').value);"
-        "formData.append('sd_spi_host',document.getElementById('sd_spi_host').value);"
-        "const resultDiv=document.getElementById('sd_save_result');"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">Saving SD Card configuration...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "fetch('/save_sd_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Error: '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "}"
-        "})"
-        ".catch(e=>{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Network Error: '+e.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "});"
-        "return false;"
-        "}"
-        "function saveRTCConfig(){"
-        "const formData=new URLSearchParams();"
-        "if(document.getElementById('rtc_enabled').checked) formData.append('rtc_enabled','1');"
-        "if(document.getElementById('rtc_sync_on_boot').checked) formData.append('rtc_sync_on_boot','1');"
-        "if(document.getElementById('rtc_update_from_ntp').checked) formData.append('rtc_update_from_ntp','1');"
-        "formData.append('rtc_sda',document.getElementById('rtc_sda').value);"
-        "formData.append('rtc_scl',document.getElementById('rtc_scl').value);"
-        "formData.append('rtc_i2c_num',document.getElementById('rtc_i2c_num').value);"
-        "const resultDiv=document.getElementById('rtc_save_result');"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">Saving RTC configuration...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "fetch('/save_rtc_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Error: '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "}"
-        "})"
-        ".catch(e=>{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Network Error: '+e.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "});"
-        "return false;"
-        "}"
-        "function saveWiFiConfig(){"
-        "const ssid=document.getElementById('wifi_ssid').value;"
-        "const password=document.getElementById('wifi_password').value;"
-        "if(!ssid){alert('Please enter a WiFi network name');return false;}"
-        "const formData=new URLSearchParams();"
-        "formData.append('wifi_ssid',ssid);"
-        "formData.append('wifi_password',password);"
-        "const resultDiv=document.getElementById('wifi_save_result');"
-        "const saveBtn=document.getElementById('wifi_save_btn');"
-        "saveBtn.disabled=true;"
-        "saveBtn.textContent='Connecting...';"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">📡 Saving and connecting to WiFi...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "fetch('/save_wifi_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "saveBtn.disabled=false;"
-        "saveBtn.textContent='Save & Connect';"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else if(data.status==='connecting'){"
-        "resultDiv.innerHTML='<span style=\"color:#17a2b8\">📶 '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d1ecf1';"
-        "resultDiv.style.borderColor='#bee5eb';"
-        "resultDiv.style.color='#0c5460';"
-        "let wifiPoll=0;"
-        "const wifiTimer=setInterval(function(){"
-        "wifiPoll++;"
-        "fetch('/api/system_status').then(r=>r.json()).then(s=>{"
-        "if(s.wifi&&s.wifi.status==='connected'){"
-        "clearInterval(wifiTimer);"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ Connected to '+s.wifi.ssid+' ('+s.wifi.rssi+' dBm)</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else if(wifiPoll>=15){"
-        "clearInterval(wifiTimer);"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">⚠️ Saved. Refresh page to verify connection.</span>';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "}"
-        "}).catch(()=>{});"
-        "},2000);"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "}"
-        "})"
-        ".catch(e=>{"
-        "saveBtn.disabled=false;"
-        "saveBtn.textContent='Save & Connect';"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Network Error: '+e.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "});"
-        "return false;"
-        "}"
-        "function saveSIMConfig(){"
-        "const formData=new URLSearchParams();"
-        "formData.append('sim_apn',document.getElementById('sim_apn').value);"
-        "formData.append('sim_apn_user',document.getElementById('sim_apn_user').value);"
-        "formData.append('sim_apn_pass',document.getElementById('sim_apn_pass').value);"
-        "formData.append('sim_uart',document.getElementById('sim_uart').value);"
-        "formData.append('sim_tx_pin',document.getElementById('sim_tx_pin').value);"
-        "formData.append('sim_rx_pin',document.getElementById('sim_rx_pin').value);"
-        "formData.append('sim_pwr_pin',document.getElementById('sim_pwr_pin').value);"
-        "formData.append('sim_reset_pin',document.getElementById('sim_reset_pin').value);"
-        "formData.append('sim_baud',document.getElementById('sim_baud').value);"
-        "const resultDiv=document.getElementById('sim_save_result');"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">Saving SIM configuration...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "fetch('/save_sim_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Error: '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "}"
-        "})"
-        ".catch(e=>{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Network Error: '+e.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "});"
-        "return false;"
-        "}"
-        "function saveAzureConfig(){"
-        "const password=prompt('Save Azure Configuration\\n\\nThis will update sensitive Azure IoT Hub settings.\\nPlease enter the admin password to confirm:');"
-        "if(password===null) return;"
-        "if(password!=='admin123'){"
-        "alert('Access Denied\\n\\nIncorrect password. Cannot save Azure configuration.\\n\\nContact your system administrator if you need access.');"
-        "return;}"
-        "const deviceId=document.querySelector('input[name=\"azure_device_id\"]').value;"
-        "const deviceKey=document.getElementById('azure_device_key').value;"
-        "const telemetryInterval=document.querySelector('input[name=\"telemetry_interval\"]').value;"
-        "const batchTelemetry=document.querySelector('input[name=\"batch_telemetry\"]').checked?'1':'0';"
-        "const modbusRetryCount=document.querySelector('select[name=\"modbus_retry_count\"]').value;"
-        "const modbusRetryDelay=document.querySelector('input[name=\"modbus_retry_delay\"]').value;"
-        "if(!deviceId){alert('ERROR: Please enter the Azure device ID');return;}"
-        "if(!deviceKey){alert('ERROR: Please enter the Azure device key');return;}"
-        "const formData='azure_device_id='+encodeURIComponent(deviceId)+'&azure_device_key='+encodeURIComponent(deviceKey)+'&telemetry_interval='+telemetryInterval+'&batch_telemetry='+batchTelemetry+'&modbus_retry_count='+modbusRetryCount+'&modbus_retry_delay='+modbusRetryDelay;"
-        "fetch('/save_azure_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){alert('SUCCESS: Azure configuration saved successfully!\\n\\nDevice ID, device key, and telemetry interval updated.');}else{alert('ERROR: '+data.message);}"
-        "}).catch(e=>{alert('ERROR: Save failed: '+e.message);});"
-        "}"
-        "function saveModemConfig(){"
-        "console.log('saveModemConfig function called');"
-        "const formData=new URLSearchParams();"
-        "const modemEnabled=document.getElementById('modem_reset_enabled').checked;"
-        "const gpioPin=document.getElementById('modem_reset_gpio_pin').value;"
-        "const bootDelay=document.getElementById('modem_boot_delay').value;"
-        "if(gpioPin<2||gpioPin>39||(gpioPin>=6&&gpioPin<=11)){"
-        "alert('ERROR: Invalid GPIO pin. Please use pins 2-39, excluding 6-11 which are reserved.');return false;"
-        "}"
-        "if(bootDelay<5||bootDelay>60){"
-        "alert('ERROR: Boot delay must be between 5 and 60 seconds.');return false;"
-        "}"
-        "if(modemEnabled) formData.append('modem_reset_enabled','1');"
-        "formData.append('modem_reset_gpio_pin',gpioPin);"
-        "formData.append('modem_boot_delay',bootDelay);"
-        "const resultDiv=document.getElementById('modem-result');"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">Saving modem configuration...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "fetch('/save_modem_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Error: '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "}"
-        "}).catch(e=>{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Network Error: '+e.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "});return false;"
-        "}");
-    
-    httpd_resp_sendstr_chunk(req,
-        "function saveSystemConfig(){"
-        "const triggerPin=document.getElementById('trigger_gpio_pin').value;"
-        "if(triggerPin<0||triggerPin>39){"
-        "alert('ERROR: Invalid GPIO pin. Use pins 0-39.');return false;"
-        "}"
-        "const formData=new URLSearchParams();"
-        "formData.append('trigger_gpio_pin',triggerPin);"
-        "const resultDiv=document.getElementById('system-control-result');"
-        "resultDiv.innerHTML='<span style=\"color:#856404\">Saving system settings...</span>';"
-        "resultDiv.style.display='block';"
-        "resultDiv.style.backgroundColor='#fff3cd';"
-        "resultDiv.style.borderColor='#ffeaa7';"
-        "resultDiv.style.color='#856404';"
-        "fetch('/save_system_config',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<span style=\"color:#28a745\">✅ '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#d4edda';"
-        "resultDiv.style.borderColor='#c3e6cb';"
-        "resultDiv.style.color='#155724';"
-        "}else{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Error: '+data.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "}"
-        "}).catch(e=>{"
-        "resultDiv.innerHTML='<span style=\"color:#dc3545\">❌ Communication Error: '+e.message+'</span>';"
-        "resultDiv.style.backgroundColor='#f8d7da';"
-        "resultDiv.style.borderColor='#f5c6cb';"
-        "resultDiv.style.color='#721c24';"
-        "});return false;"
-        "}");
-    
-    httpd_resp_sendstr_chunk(req,
-        "let scanInProgress = false;"
-        "function scanWiFi(){"
-        "const statusDiv=document.getElementById('scan-status');"
-        "const networksDiv=document.getElementById('networks');"
-        "const scanBtn=document.querySelector('.scan-button');"
-        "if (!statusDiv || !networksDiv) {"
-        "console.error('Required elements not found for WiFi scan');"
-        "return;"
-        "}"
-        "if (scanInProgress) {"
-        "statusDiv.innerHTML='<span style=\"color:#ffc107\">Scan already in progress. Please wait...</span>';"
-        "return;"
-        "}"
-        "scanInProgress = true;"
-        "if (scanBtn) {"
-        "scanBtn.style.opacity='0.6';"
-        "scanBtn.style.pointerEvents='none';"
-        "}"
-        "statusDiv.innerHTML='<span style=\"color:#17a2b8\">Scanning for networks...</span>';"
-        "networksDiv.style.display='none';"
-        "console.log('Starting WiFi scan...');"
-        "fetch('/scan_wifi').then(r=>{"
-        "console.log('Received response:', r.status, r.statusText);"
-        "if (!r.ok) {"
-        "throw new Error('HTTP ' + r.status + ': ' + r.statusText);"
-        "}"
-        "return r.text();"
-        "}).then(text=>{"
-        "console.log('Response text:', text);"
-        "let data;"
-        "try {"
-        "data = JSON.parse(text);"
-        "} catch (e) {"
-        "console.error('JSON parse error:', e, 'Text:', text);"
-        "throw new Error('Invalid server response');"
-        "}"
-        "console.log('Parsed data:', data);"
-        "if(data.error){"
-        "statusDiv.innerHTML='<span style=\"color:#dc3545\">Error: '+data.error+'</span>';"
-        "return;"
-        "}"
-        "const count = data.count || 0;"
-        "statusDiv.innerHTML='<span style=\"color:#28a745\">'+count+' networks found</span>';"
-        "networksDiv.innerHTML='';"
-        "if(!data.networks || data.networks.length===0){"
-        "networksDiv.innerHTML='<div style=\"padding:20px;text-align:center;color:#666;background:white;border-radius:6px;margin:8px\"><i>No networks found</i><br><small>Try scanning again</small></div>';"
-        "networksDiv.style.display='block';"
-        "return;"
-        "}"
-        "data.networks.sort((a,b)=>b.rssi-a.rssi);"
-        "const maxHeight=count>15?'400px':count>10?'300px':count>5?'200px':'180px';"
-        "networksDiv.style.maxHeight=maxHeight;"
-        "networksDiv.style.overflowY='auto';"
-        "networksDiv.style.padding='10px';"
-        "data.networks.forEach((n,i)=>{"
-        "const item=document.createElement('div');"
-        "const signalColor=n.rssi>-50?'#28a745':n.rssi>-70?'#ffc107':'#dc3545';"
-        "item.className='network-item';"
-        "item.style.cssText='padding:12px;cursor:pointer;border-radius:6px;margin:4px 0;background:white;border:1px solid #e0e0e0;transition:all 0.2s ease';"
-        "item.innerHTML='<div style=\"display:flex;justify-content:space-between;align-items:center\"><div><div style=\"display:flex;align-items:center;gap:8px\"><strong style=\"color:#2c3e50\">'+n.ssid+'</strong>'+n.security_icon+'</div><small style=\"color:#666;margin-top:2px;display:block\">Channel '+n.channel+' * '+n.signal_strength+'</small></div><div style=\"text-align:right\"><div style=\"color:'+signalColor+';font-weight:bold;font-size:13px\">'+n.rssi+'dBm</div><small style=\"color:#888\">'+n.signal_icon+'</small></div></div>';"
-        "item.onmouseover=()=>{item.style.background='#e3f2fd';item.style.borderColor='#2196f3'};"
-        "item.onmouseout=()=>{item.style.background='white';item.style.borderColor='#e0e0e0'};"
-        "item.onclick=()=>{"
-        "document.getElementById('wifi_ssid').value=n.ssid;"
-        "networksDiv.style.display='none';"
-        "statusDiv.innerHTML='<span style=\"color:#17a2b8\">Selected: <strong>'+n.ssid+'</strong> ('+n.signal_strength+')</span>';"
-        "document.getElementById('wifi_ssid').focus();"
-        "};"
-        "networksDiv.appendChild(item);"
-        "});"
-        "networksDiv.style.display='block';"
-        "}).catch(e=>{"
-        "console.error('Scan error:', e);"
-        "statusDiv.innerHTML='<span style=\"color:#dc3545\">Scan failed: '+e.message+'</span>';"
-        "}).finally(()=>{"
-        "scanInProgress = false;"
-        "if (scanBtn) {"
-        "scanBtn.style.opacity='1';"
-        "scanBtn.style.pointerEvents='auto';"
-        "}"
-        "console.log('Scan completed');"
-        "});"
-        "}");
-    
-    // Reboot system function
-    httpd_resp_sendstr_chunk(req,
-        "function rebootSystem(){"
-        "if(confirm('Are you sure you want to reboot the system? This will restart the device and it may take a few minutes to come back online.')){"
-        "fetch('/reboot',{method:'POST',headers:{'Content-Type':'application/json'}})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){"
-        "alert('System is rebooting. Please wait a few minutes and refresh the page.');"
-        "}else{"
-        "alert('Reboot failed: '+data.message);"
-        "}"
-        "}).catch(e=>{"
-        "alert('Reboot request sent. Please wait a few minutes and refresh the page.');"
-        "});"
-        "}"
-        "}");
-    
-    // Simplified test sensor function - real-time RS485 communication
-    httpd_resp_sendstr_chunk(req,
-        "function testSensor(sensorId){"
-        "const resultDiv=document.getElementById('test-result-'+sensorId);"
-        "resultDiv.innerHTML='<div style=\"background:#e3f2fd;padding:8px;border-radius:4px;margin:5px 0\">Testing RS485 Modbus communication...</div>';"
-        "resultDiv.style.display='block';"
-        "fetch('/test_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'sensor_id='+sensorId})"
-        ".then(r=>r.text()).then(htmlData=>{"
-        "resultDiv.innerHTML=htmlData;"
-        "}).catch(e=>{"
-        "resultDiv.innerHTML='<div style=\"background:#ffebee;padding:8px;border-radius:4px;color:red;margin:5px 0\">Communication Error: '+e.message+'</div>';"
-        "});}"
-        );
-    
-    // Generate sensor data array for JavaScript use
-    httpd_resp_sendstr_chunk(req, "const sensorData=[");
-    for (int i = 0; i < g_system_config.sensor_count; i++) {
-        char escaped_name[64], escaped_unit[32], escaped_type[64];
-        html_escape(escaped_name, g_system_config.sensors[i].name, sizeof(escaped_name));
-        html_escape(escaped_unit, g_system_config.sensors[i].unit_id, sizeof(escaped_unit));
-        html_escape(escaped_type, g_system_config.sensors[i].data_type, sizeof(escaped_type));
-        
-        ESP_LOGI(TAG, "sensorData[%d]: name='%s', sensor_type='%s' (len=%d), data_type='%s' (len=%d), escaped_type='%s', scale_factor=%.2f", 
-                 i, g_system_config.sensors[i].name, g_system_config.sensors[i].sensor_type, strlen(g_system_config.sensors[i].sensor_type), g_system_config.sensors[i].data_type, strlen(g_system_config.sensors[i].data_type), escaped_type, g_system_config.sensors[i].scale_factor);
-        
-        char escaped_meter_type[64];
-        html_escape(escaped_meter_type, g_system_config.sensors[i].meter_type, sizeof(escaped_meter_type));
-        
-        // Start building sensor data object
-        snprintf(chunk, sizeof(chunk),
-            "{name:'%s',unit_id:'%s',slave_id:%d,register_address:%d,quantity:%d,data_type:'%s',baud_rate:%d,parity:'%s',scale_factor:%.2f,register_type:'%s',sensor_type:'%s',sensor_height:%.2f,max_water_level:%.2f,meter_type:'%s'",
-            escaped_name, escaped_unit, g_system_config.sensors[i].slave_id, 
-            g_system_config.sensors[i].register_address, g_system_config.sensors[i].quantity, 
-            escaped_type, g_system_config.sensors[i].baud_rate, g_system_config.sensors[i].parity[0] ? g_system_config.sensors[i].parity : "none", g_system_config.sensors[i].scale_factor,
-            g_system_config.sensors[i].register_type[0] ? g_system_config.sensors[i].register_type : "HOLDING",
-            g_system_config.sensors[i].sensor_type[0] ? g_system_config.sensors[i].sensor_type : "Flow-Meter",
-            g_system_config.sensors[i].sensor_height, g_system_config.sensors[i].max_water_level,
-            escaped_meter_type);
-        httpd_resp_sendstr_chunk(req, chunk);
-        
-        // Add sub-sensor data for QUALITY sensors
-        if (strcmp(g_system_config.sensors[i].sensor_type, "QUALITY") == 0) {
-            ESP_LOGI(TAG, "[FIND] Adding sub-sensor data for QUALITY sensor[%d]: sub_sensor_count=%d", 
-                     i, g_system_config.sensors[i].sub_sensor_count);
-            httpd_resp_sendstr_chunk(req, ",sub_sensors:[");
-            bool first_sub_sensor = true;
-            for (int j = 0; j < g_system_config.sensors[i].sub_sensor_count; j++) {
-                if (g_system_config.sensors[i].sub_sensors[j].enabled) {
-                    ESP_LOGI(TAG, "[FIND] Sub-sensor[%d][%d]: enabled=%d, param='%s', slave_id=%d, reg=%d", 
-                             i, j, g_system_config.sensors[i].sub_sensors[j].enabled,
-                             g_system_config.sensors[i].sub_sensors[j].parameter_name,
-                             g_system_config.sensors[i].sub_sensors[j].slave_id,
-                             g_system_config.sensors[i].sub_sensors[j].register_address);
-                    char escaped_param_name[32], escaped_sub_data_type[32], escaped_sub_register_type[16];
-                    html_escape(escaped_param_name, g_system_config.sensors[i].sub_sensors[j].parameter_name, sizeof(escaped_param_name));
-                    html_escape(escaped_sub_data_type, g_system_config.sensors[i].sub_sensors[j].data_type, sizeof(escaped_sub_data_type));
-                    html_escape(escaped_sub_register_type, g_system_config.sensors[i].sub_sensors[j].register_type, sizeof(escaped_sub_register_type));
-                    
-                    snprintf(chunk, sizeof(chunk),
-                        "%s{parameter_name:'%s',slave_id:%d,register_address:%d,quantity:%d,data_type:'%s',scale_factor:%.3f,register_type:'%s'}",
-                        first_sub_sensor ? "" : ",",
-                        escaped_param_name, g_system_config.sensors[i].sub_sensors[j].slave_id,
-                        g_system_config.sensors[i].sub_sensors[j].register_address, g_system_config.sensors[i].sub_sensors[j].quantity,
-                        escaped_sub_data_type, g_system_config.sensors[i].sub_sensors[j].scale_factor,
-                        escaped_sub_register_type[0] ? escaped_sub_register_type : "HOLDING");
-                    httpd_resp_sendstr_chunk(req, chunk);
-                    first_sub_sensor = false;
-                }
-            }
-            httpd_resp_sendstr_chunk(req, "]");
+    for (size_t i = 0; i < sizeof(g_web_sections) / sizeof(g_web_sections[0]); i++) {
+        if (strlen(g_web_sections[i].id) == id_len && strncmp(g_web_sections[i].id, id, id_len) == 0) {
+            return web_asset_send(req, &g_web_sections[i].asset);
         }
-        
-        // Close sensor object and add comma if not last sensor
-        snprintf(chunk, sizeof(chunk), "}%s", (i < g_system_config.sensor_count - 1) ? "," : "");
-        httpd_resp_sendstr_chunk(req, chunk);
-    }
-    httpd_resp_sendstr_chunk(req, "];");
-    
-    // Add script to show format info for existing sensors on page load
-    httpd_resp_sendstr_chunk(req,
-        "window.addEventListener('load', function() {"
-        "setTimeout(() => {"
-        "for(let i = 0; i < sensorData.length; i++) {"
-        "const sensorCard = document.getElementById('sensor-card-' + i);"
-        "if(sensorCard) {"
-        "const dataType = sensorData[i].data_type;"
-        "console.log('Sensor', i, 'data type:', dataType);"
-        "}"
-        "}"
-        "}, 500);"
-        "});");
-
-    // Working edit sensor function with inline editing
-    httpd_resp_sendstr_chunk(req,
-        "function editSensor(sensorId){"
-        "if(confirm('Edit Sensor '+(sensorId+1)+'? This will show an edit form.')){"
-        "const sensor=sensorData[sensorId];"
-        "if(!sensor){alert('Sensor data not found');return;}"
-        "var editForm='<div class=\"sensor-card\" style=\"border:2px solid #007bff;background:#f0f8ff\">';"
-        "editForm+='<h3 style=\"color:#007bff\">Editing Sensor '+(sensorId+1)+' - <span style=\"color:#28a745;font-weight:bold;\">'+(sensor.sensor_type||'Flow-Meter')+'</span></h3>';"
-        "editForm+='<div class=\"form-grid\">';"
-        "editForm+='<label>Name:</label><input id=\"edit_name_'+sensorId+'\" value=\"'+sensor.name+'\">';"
-        "editForm+='<label>Unit ID:</label><input id=\"edit_unit_'+sensorId+'\" value=\"'+sensor.unit_id+'\">';"
-        "if (sensor.sensor_type !== 'QUALITY') {"
-        "editForm+='<label>Slave ID:</label><input type=\"number\" id=\"edit_slave_'+sensorId+'\" value=\"'+sensor.slave_id+'\" min=\"1\" max=\"247\">';"
-        "editForm+='<label>Register:</label><input type=\"number\" id=\"edit_register_'+sensorId+'\" value=\"'+sensor.register_address+'\">';"
-        "editForm+='<label>Quantity:</label><input type=\"number\" id=\"edit_quantity_'+sensorId+'\" value=\"'+sensor.quantity+'\" min=\"1\" max=\"125\">';"
-        "editForm+='<label>Register Type:</label><select id=\"edit_register_type_'+sensorId+'\">';"
-        "editForm+='<option value=\"HOLDING\" '+(sensor.register_type==='HOLDING'?'selected':'')+'>Holding Registers (03) - Read/Write</option>';"
-        "editForm+='<option value=\"INPUT\" '+(sensor.register_type==='INPUT'?'selected':'')+'>Input Registers (04) - Read Only</option>';"
-        "editForm+='<option value=\"COILS\" '+(sensor.register_type==='COILS'?'selected':'')+'>Coils (01) - Single Bit Read/Write</option>';"
-        "editForm+='<option value=\"DISCRETE\" '+(sensor.register_type==='DISCRETE'?'selected':'')+'>Discrete Inputs (02) - Single Bit Read Only</option>';"
-        "editForm+='</select>';"
-        "}"
-        "if (sensor.sensor_type === 'ZEST') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - INT32_BE + INT32_LE_SWAP</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"ZEST_FIXED\">';"
-        "} else if (sensor.sensor_type === 'Panda_USM') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - FLOAT64_12345678 (Big-Endian Double)</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"FLOAT64_12345678\">';"
-        "} else if (sensor.sensor_type === 'Clampon') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - INT32 + FLOAT32 (word-swapped)</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"CLAMPON_FIXED\">';"
-        "} else if (sensor.sensor_type === 'Dailian') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - UINT32_3412 (CDAB)</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"UINT32_3412\">';"
-        "} else if (sensor.sensor_type === 'Dailian_EMF') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - UINT32 word-swapped</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"DAILIAN_EMF_FIXED\">';"
-        "} else if (sensor.sensor_type === 'Panda_EMF') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - INT32_BE + FLOAT32_BE</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"PANDA_EMF_FIXED\">';"
-        "} else if (sensor.sensor_type === 'Panda_Level') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - UINT16 (Level %)</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"PANDA_LEVEL_FIXED\">';"
-        "} else if (sensor.sensor_type === 'Piezometer') {"
-        "editForm+='<label>Data Type:</label><div style=\"padding:8px;background:#e8f5e8;border-radius:4px;color:#4caf50;font-weight:bold\">Fixed - UINT16_HI (16-bit)</div><input type=\"hidden\" id=\"edit_datatype_'+sensorId+'\" value=\"UINT16_HI\">';"
-        "} else {"
-        "var mappedDataType = sensor.data_type || '';"
-        "console.log('Edit form - Original data_type:', sensor.data_type, 'length:', sensor.data_type ? sensor.data_type.length : 0);"
-        "if (sensor.data_type === '' || sensor.data_type === null || sensor.data_type === undefined) {"
-        "  mappedDataType = 'UINT16_HI';"
-        "} else if (sensor.data_type === 'FLOAT32_AB') mappedDataType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_43') mappedDataType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_ABCD') mappedDataType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_1234') mappedDataType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_DCBA') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_4321') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_432') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_BADC') mappedDataType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_2143') mappedDataType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_214') mappedDataType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_CDAB') mappedDataType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'FLOAT32_3412') mappedDataType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'FLOAT32_341') mappedDataType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'UINT32_AB') mappedDataType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_ABCD') mappedDataType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_1234') mappedDataType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_DCBA') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_432') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_4321') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_BADC') mappedDataType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_2143') mappedDataType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_CDAB') mappedDataType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'UINT32_3412') mappedDataType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'INT32_AB') mappedDataType = 'INT32_1234';"
-        "else if (sensor.data_type === 'INT32_ABCD') mappedDataType = 'INT32_1234';"
-        "else if (sensor.data_type === 'INT32_1234') mappedDataType = 'INT32_1234';"
-        "else if (sensor.data_type === 'INT32_DCBA') mappedDataType = 'INT32_4321';"
-        "else if (sensor.data_type === 'INT32_432') mappedDataType = 'INT32_4321';"
-        "else if (sensor.data_type === 'INT32_4321') mappedDataType = 'INT32_4321';"
-        "else if (sensor.data_type === 'UINT16') mappedDataType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'UINT16_BE') mappedDataType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'UINT16_HI') mappedDataType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'UINT16_LE') mappedDataType = 'UINT16_LO';"
-        "else if (sensor.data_type === 'UINT16_LO') mappedDataType = 'UINT16_LO';"
-        "else if (sensor.data_type === 'INT16') mappedDataType = 'INT16_HI';"
-        "else if (sensor.data_type === 'INT16_BE') mappedDataType = 'INT16_HI';"
-        "else if (sensor.data_type === 'INT16_HI') mappedDataType = 'INT16_HI';"
-        "else if (sensor.data_type === 'INT16_LE') mappedDataType = 'INT16_LO';"
-        "else if (sensor.data_type === 'INT16_LO') mappedDataType = 'INT16_LO';"
-        "else if (sensor.data_type === 'INT32_BADC') mappedDataType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_2143') mappedDataType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_214') mappedDataType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_CDAB') mappedDataType = 'INT32_3412';"
-        "else if (sensor.data_type === 'INT32_3412') mappedDataType = 'INT32_3412';"
-        "else if (sensor.data_type === 'INT32_341') mappedDataType = 'INT32_3412';"
-        "else if (sensor.data_type === 'UINT32_DCB') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'INT32_DCB') mappedDataType = 'INT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_DCB') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'UINT32') mappedDataType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'INT32') mappedDataType = 'INT32_1234';"
-        "else if (sensor.data_type === 'UINT32_CDA') mappedDataType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'UINT32_BAD') mappedDataType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_DCA') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_DC') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_CDA') mappedDataType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'FLOAT32_BAD') mappedDataType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_DCA') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'UINT16_SWAP') mappedDataType = 'UINT16_LO';"
-        "else if (sensor.data_type === 'INT16_SWAP') mappedDataType = 'INT16_LO';"
-        "else if (sensor.data_type === 'UINT32_SWAP') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_1234') mappedDataType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_4321') mappedDataType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_2143') mappedDataType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_3412') mappedDataType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'INT32_SWAP') mappedDataType = 'INT32_4321';"
-        "else if (sensor.data_type === 'INT32_1234') mappedDataType = 'INT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_SWAP') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32') mappedDataType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_1234') mappedDataType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_4321') mappedDataType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_2143') mappedDataType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_3412') mappedDataType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'INT8') mappedDataType = 'INT8';"
-        "else if (sensor.data_type === 'UINT8') mappedDataType = 'UINT8';"
-        "else if (sensor.data_type === 'BOOL') mappedDataType = 'BOOL';"
-        "else if (sensor.data_type === 'ASCII') mappedDataType = 'ASCII';"
-        "else if (sensor.data_type === 'HEX') mappedDataType = 'HEX';"
-        "else if (sensor.data_type === 'PDU') mappedDataType = 'PDU';"
-        "else if (sensor.data_type === 'INT64_12345678') mappedDataType = 'INT64_12345678';"
-        "else if (sensor.data_type === 'INT64_87654321') mappedDataType = 'INT64_87654321';"
-        "else if (sensor.data_type === 'INT64_21436587') mappedDataType = 'INT64_21436587';"
-        "else if (sensor.data_type === 'INT64_78563412') mappedDataType = 'INT64_78563412';"
-        "else if (sensor.data_type === 'UINT64_12345678') mappedDataType = 'UINT64_12345678';"
-        "else if (sensor.data_type === 'UINT64_87654321') mappedDataType = 'UINT64_87654321';"
-        "else if (sensor.data_type === 'UINT64_21436587') mappedDataType = 'UINT64_21436587';"
-        "else if (sensor.data_type === 'UINT64_78563412') mappedDataType = 'UINT64_78563412';"
-        "else if (sensor.data_type === 'FLOAT64_12345678') mappedDataType = 'FLOAT64_12345678';"
-        "else if (sensor.data_type === 'FLOAT64_87654321') mappedDataType = 'FLOAT64_87654321';"
-        "else if (sensor.data_type === 'FLOAT64_21436587') mappedDataType = 'FLOAT64_21436587';"
-        "else if (sensor.data_type === 'FLOAT64_78563412') mappedDataType = 'FLOAT64_78563412';"
-        "else if (sensor.data_type === 'FLOAT64') mappedDataType = 'FLOAT64_12345678';"
-        "else if (sensor.data_type === 'INT64') mappedDataType = 'INT64_12345678';"
-        "else if (sensor.data_type === 'UINT64') mappedDataType = 'UINT64_12345678';"
-        "else if (sensor.data_type === 'INT64_BE') mappedDataType = 'INT64_12345678';"
-        "else if (sensor.data_type === 'INT64_LE') mappedDataType = 'INT64_87654321';"
-        "else if (sensor.data_type === 'UINT64_BE') mappedDataType = 'UINT64_12345678';"
-        "else if (sensor.data_type === 'UINT64_LE') mappedDataType = 'UINT64_87654321';"
-        "else if (sensor.data_type === 'FLOAT64_BE') mappedDataType = 'FLOAT64_12345678';"
-        "else if (sensor.data_type === 'FLOAT64_LE') mappedDataType = 'FLOAT64_87654321';"
-        "else {"
-        "  console.warn('Edit form - UNMAPPED data_type:', sensor.data_type, '- using as-is');"
-        "  mappedDataType = sensor.data_type || 'UINT16_HI';"
-        "}"
-        "console.log('Edit form - Mapped data_type:', mappedDataType);"
-        "editForm+='<label>Data Type:</label><select id=\"edit_datatype_'+sensorId+'\" style=\"width:280px\">';"
-        "editForm+='<option value=\"UINT16_HI\" '+(mappedDataType===''||mappedDataType==='UINT16_HI'?'selected':'')+'>16-bit UINT, high byte first (Default)</option>';"
-        "editForm+='<optgroup label=\"8-bit Formats (0.5 register)\">';"
-        "editForm+='<option value=\"INT8\" '+(mappedDataType==='INT8'?'selected':'')+'>8-bit INT (-128 to 127)</option>';"
-        "editForm+='<option value=\"UINT8\" '+(mappedDataType==='UINT8'?'selected':'')+'>8-bit UINT (0 to 255)</option>';"
-        "editForm+='</optgroup>';"
-        "editForm+='<optgroup label=\"16-bit Formats (1 register)\">';"
-        "editForm+='<option value=\"INT16_HI\" '+(mappedDataType==='INT16_HI'?'selected':'')+'>16-bit INT, high byte first</option>';"
-        "editForm+='<option value=\"INT16_LO\" '+(mappedDataType==='INT16_LO'?'selected':'')+'>16-bit INT, low byte first</option>';"
-        "editForm+='<option value=\"UINT16_LO\" '+(mappedDataType==='UINT16_LO'?'selected':'')+'>16-bit UINT, low byte first</option>';"
-        "editForm+='</optgroup>';"
-        "editForm+='<optgroup label=\"32-bit Float Formats (2 registers)\">';"
-        "var float32_1234_selected = (mappedDataType==='FLOAT32_1234');"
-        "editForm+='<option value=\"FLOAT32_1234\" '+(float32_1234_selected?'selected':'')+'>32-bit float, Byte order 1,2,3,4</option>';"
-        "editForm+='<option value=\"FLOAT32_4321\" '+(mappedDataType==='FLOAT32_4321'?'selected':'')+'>32-bit float, Byte order 4,3,2,1</option>';"
-        "editForm+='<option value=\"FLOAT32_2143\" '+(mappedDataType==='FLOAT32_2143'?'selected':'')+'>32-bit float, Byte order 2,1,4,3</option>';"
-        "editForm+='<option value=\"FLOAT32_3412\" '+(mappedDataType==='FLOAT32_3412'?'selected':'')+'>32-bit float, Byte order 3,4,1,2</option>';"
-        "editForm+='</optgroup>';"
-        "editForm+='<optgroup label=\"32-bit Integer Formats (2 registers)\">';"
-        "editForm+='<option value=\"INT32_1234\" '+(mappedDataType==='INT32_1234'?'selected':'')+'>32-bit INT, Byte order 1,2,3,4</option>';"
-        "editForm+='<option value=\"INT32_4321\" '+(mappedDataType==='INT32_4321'?'selected':'')+'>32-bit INT, Byte order 4,3,2,1</option>';"
-        "editForm+='<option value=\"INT32_2143\" '+(mappedDataType==='INT32_2143'?'selected':'')+'>32-bit INT, Byte order 2,1,4,3</option>';"
-        "editForm+='<option value=\"INT32_3412\" '+(mappedDataType==='INT32_3412'?'selected':'')+'>32-bit INT, Byte order 3,4,1,2</option>';"
-        "editForm+='<option value=\"UINT32_1234\" '+(mappedDataType==='UINT32_1234'?'selected':'')+'>32-bit UINT, Byte order 1,2,3,4</option>';"
-        "editForm+='<option value=\"UINT32_4321\" '+(mappedDataType==='UINT32_4321'?'selected':'')+'>32-bit UINT, Byte order 4,3,2,1</option>';"
-        "editForm+='<option value=\"UINT32_2143\" '+(mappedDataType==='UINT32_2143'?'selected':'')+'>32-bit UINT, Byte order 2,1,4,3</option>';"
-        "editForm+='<option value=\"UINT32_3412\" '+(mappedDataType==='UINT32_3412'?'selected':'')+'>32-bit UINT, Byte order 3,4,1,2</option>';"
-        "editForm+='</optgroup>';"
-        "editForm+='<optgroup label=\"64-bit Integer Formats (4 registers)\">';"
-        "editForm+='<option value=\"INT64_12345678\" '+(mappedDataType==='INT64_12345678'?'selected':'')+'>64-bit INT, Byte order 1,2,3,4,5,6,7,8</option>';"
-        "editForm+='<option value=\"INT64_87654321\" '+(mappedDataType==='INT64_87654321'?'selected':'')+'>64-bit INT, Byte order 8,7,6,5,4,3,2,1</option>';"
-        "editForm+='<option value=\"INT64_21436587\" '+(mappedDataType==='INT64_21436587'?'selected':'')+'>64-bit INT, Byte order 2,1,4,3,6,5,8,7</option>';"
-        "editForm+='<option value=\"INT64_78563412\" '+(mappedDataType==='INT64_78563412'?'selected':'')+'>64-bit INT, Byte order 7,8,5,6,3,4,1,2</option>';"
-        "editForm+='<option value=\"UINT64_12345678\" '+(mappedDataType==='UINT64_12345678'?'selected':'')+'>64-bit UINT, Byte order 1,2,3,4,5,6,7,8</option>';"
-        "editForm+='<option value=\"UINT64_87654321\" '+(mappedDataType==='UINT64_87654321'?'selected':'')+'>64-bit UINT, Byte order 8,7,6,5,4,3,2,1</option>';"
-        "editForm+='<option value=\"UINT64_21436587\" '+(mappedDataType==='UINT64_21436587'?'selected':'')+'>64-bit UINT, Byte order 2,1,4,3,6,5,8,7</option>';"
-        "editForm+='<option value=\"UINT64_78563412\" '+(mappedDataType==='UINT64_78563412'?'selected':'')+'>64-bit UINT, Byte order 7,8,5,6,3,4,1,2</option>';"
-        "editForm+='</optgroup>';"
-        "editForm+='<optgroup label=\"64-bit Float Formats (4 registers)\">';"
-        "editForm+='<option value=\"FLOAT64_12345678\" '+(mappedDataType==='FLOAT64_12345678'?'selected':'')+'>64-bit float, Byte order 1,2,3,4,5,6,7,8</option>';"
-        "editForm+='<option value=\"FLOAT64_87654321\" '+(mappedDataType==='FLOAT64_87654321'?'selected':'')+'>64-bit float, Byte order 8,7,6,5,4,3,2,1</option>';"
-        "editForm+='<option value=\"FLOAT64_21436587\" '+(mappedDataType==='FLOAT64_21436587'?'selected':'')+'>64-bit float, Byte order 2,1,4,3,6,5,8,7</option>';"
-        "editForm+='<option value=\"FLOAT64_78563412\" '+(mappedDataType==='FLOAT64_78563412'?'selected':'')+'>64-bit float, Byte order 7,8,5,6,3,4,1,2</option>';"
-        "editForm+='</optgroup>';"
-        "editForm+='<optgroup label=\"Special Formats\">';"
-        "editForm+='<option value=\"ASCII\" '+(mappedDataType==='ASCII'?'selected':'')+'>ASCII String</option>';"
-        "editForm+='<option value=\"HEX\" '+(mappedDataType==='HEX'?'selected':'')+'>Hexadecimal</option>';"
-        "editForm+='<option value=\"BOOL\" '+(mappedDataType==='BOOL'?'selected':'')+'>Boolean (True/False)</option>';"
-        "editForm+='<option value=\"PDU\" '+(mappedDataType==='PDU'?'selected':'')+'>PDU (Protocol Data Unit)</option>';"
-        "editForm+='</optgroup></select>';"
-        "}"
-        "editForm+='<label>Baud Rate:</label><select id=\"edit_baud_'+sensorId+'\">';"
-        "editForm+='<option value=\"2400\" '+(sensor.baud_rate==2400?'selected':'')+'>2400 bps</option>';"
-        "editForm+='<option value=\"4800\" '+(sensor.baud_rate==4800?'selected':'')+'>4800 bps</option>';"
-        "editForm+='<option value=\"9600\" '+(sensor.baud_rate==9600?'selected':'')+'>9600 bps</option>';"
-        "editForm+='<option value=\"14400\" '+(sensor.baud_rate==14400?'selected':'')+'>14400 bps</option>';"
-        "editForm+='<option value=\"19200\" '+(sensor.baud_rate==19200?'selected':'')+'>19200 bps</option>';"
-        "editForm+='<option value=\"28800\" '+(sensor.baud_rate==28800?'selected':'')+'>28800 bps</option>';"
-        "editForm+='<option value=\"38400\" '+(sensor.baud_rate==38400?'selected':'')+'>38400 bps</option>';"
-        "editForm+='<option value=\"57600\" '+(sensor.baud_rate==57600?'selected':'')+'>57600 bps</option>';"
-        "editForm+='<option value=\"115200\" '+(sensor.baud_rate==115200?'selected':'')+'>115200 bps</option>';"
-        "editForm+='<option value=\"230400\" '+(sensor.baud_rate==230400?'selected':'')+'>230400 bps</option>';"
-        "editForm+='</select>';"
-        "editForm+='<label>Parity:</label><select id=\"edit_parity_'+sensorId+'\">';"
-        "editForm+='<option value=\"none\" '+(sensor.parity==='none'||!sensor.parity?'selected':'')+'>None</option>';"
-        "editForm+='<option value=\"even\" '+(sensor.parity==='even'?'selected':'')+'>Even</option>';"
-        "editForm+='<option value=\"odd\" '+(sensor.parity==='odd'?'selected':'')+'>Odd</option>';"
-        "editForm+='</select>';"
-        "if (sensor.sensor_type === 'Level') {"
-        "editForm+='<label>Sensor Height:</label><div><input type=\"number\" id=\"edit_sensor_height_'+sensorId+'\" value=\"'+sensor.sensor_height+'\" step=\"any\"><small style=\"color:#666;margin-left:8px\">(meters or your unit)</small></div>';"
-        "editForm+='<label>Max Water Level:</label><div><input type=\"number\" id=\"edit_max_water_level_'+sensorId+'\" value=\"'+sensor.max_water_level+'\" step=\"any\"><small style=\"color:#666;margin-left:8px\">(meters or your unit)</small></div>';"
-        "} else if (sensor.sensor_type === 'Radar Level') {"
-        "editForm+='<label>Max Water Level:</label><div><input type=\"number\" id=\"edit_max_water_level_'+sensorId+'\" value=\"'+sensor.max_water_level+'\" step=\"any\" style=\"border:1px solid #ccc\"><small style=\"color:#666;margin-left:8px\">(meters or your unit)</small></div>';"
-        "} else if (sensor.sensor_type === 'Hydrostatic_Level') {"
-        "editForm+='<label>Tank Height (m):</label><div><input type=\"number\" id=\"edit_max_water_level_'+sensorId+'\" value=\"'+sensor.max_water_level+'\" step=\"any\" style=\"border:1px solid #ccc\"><small style=\"color:#666;margin-left:8px\">(Total tank height - Level % = Raw Value / Tank Height × 100)</small></div>';"
-        "} else if (sensor.sensor_type === 'ENERGY') {"
-        "editForm+='<label>Meter Type:</label><div><input type=\"text\" id=\"edit_meter_type_'+sensorId+'\" value=\"'+(sensor.meter_type||'')+'\" placeholder=\"e.g., Power Meter\"><small style=\"color:#666;margin-left:8px\">(Used as meter identifier)</small></div>';"
-        "} else if (sensor.sensor_type === 'QUALITY') {"
-        "editForm+='<p style=\"color:#17a2b8;font-weight:bold;margin:10px 0\">[TEST] Water Quality Sensor - Sub-Sensors Configuration</p>';"
-        "editForm+='<div style=\"margin-top:20px;padding:15px;background:#f0f8ff;border:2px dashed #17a2b8;border-radius:8px\">';"
-        "editForm+='<h4 style=\"color:#17a2b8;margin-top:0\">[PARAM] Sub-Sensors - Water Quality Parameters</h4>';"
-        "editForm+='<div id=\"edit-sub-sensors-'+sensorId+'\" style=\"margin:10px 0\"></div>';"
-        "editForm+='<button type=\"button\" onclick=\"addEditSubSensor('+sensorId+')\" style=\"background:#28a745;color:white;padding:8px 16px;border:none;border-radius:4px;font-size:14px;cursor:pointer\">➕ Add Sub-Sensor</button>';"
-        "editForm+='</div>';"
-        "} else if (sensor.sensor_type === 'RAINGAUGE') {"
-        "console.log('Edit form: Creating RAINGAUGE sensor edit form for sensor', sensorId, 'with scale_factor:', sensor.scale_factor);"
-        "editForm+='<label>Scale Factor:</label><div><input type=\"number\" id=\"edit_scale_factor_'+sensorId+'\" value=\"'+(sensor.scale_factor||1.0)+'\" step=\"any\" style=\"width:100px\"><small style=\"color:#666;margin-left:8px\">(Rain gauge scaling - e.g., 0.1 for mm/tips)</small></div>';"
-        "} else if (sensor.sensor_type === 'BOREWELL') {"
-        "console.log('Edit form: Creating BOREWELL sensor edit form for sensor', sensorId, 'with scale_factor:', sensor.scale_factor);"
-        "editForm+='<label>Scale Factor:</label><div><input type=\"number\" id=\"edit_scale_factor_'+sensorId+'\" value=\"'+(sensor.scale_factor||1.0)+'\" step=\"any\" style=\"width:100px\"><small style=\"color:#666;margin-left:8px\">(Borewell sensor scaling)</small></div>';"
-        "} else {"
-        "console.log('Edit form: Creating generic sensor edit form for sensor', sensorId, 'type:', sensor.sensor_type, 'scale_factor:', sensor.scale_factor);"
-        "editForm+='<label>Scale Factor:</label><input type=\"number\" id=\"edit_scale_factor_'+sensorId+'\" value=\"'+(sensor.scale_factor||1.0)+'\" step=\"any\">';"
-        "}"
-        "editForm+='</div>';"
-        "editForm+='<div id=\"test-result-edit-'+sensorId+'\" style=\"margin:10px 0;display:none\"></div>';"
-        "editForm+='<div style=\"display:flex;gap:10px;margin-top:15px;justify-content:flex-start;align-items:center\">';"
-        "editForm+='<button type=\"button\" onclick=\"saveSensorEdit('+sensorId+')\" style=\"background:#28a745;color:white;padding:10px 20px;border:none;border-radius:4px;font-weight:bold;min-width:120px;cursor:pointer\">Save Changes</button>';"
-        "editForm+='<button type=\"button\" onclick=\"testEditSensorRS485('+sensorId+')\" style=\"background:#007bff;color:white;padding:10px 20px;border:none;border-radius:4px;font-weight:bold;min-width:120px;cursor:pointer\">Test RS485</button>';"
-        "editForm+='<button type=\"button\" onclick=\"cancelSensorEdit('+sensorId+')\" style=\"background:#6c757d;color:white;padding:10px 20px;border:none;border-radius:4px;font-weight:bold;min-width:120px;cursor:pointer\">Cancel</button>';"
-        "editForm+='</div>';"
-        "editForm+='</div>';"
-        "document.getElementById('sensor-card-'+sensorId).outerHTML=editForm;"
-        "setTimeout(() => {"
-        "const editSelect = document.getElementById('edit_datatype_' + sensorId);"
-        "if (editSelect) {"
-        "if (editSelect.value !== sensor.data_type) {"
-        "let mappedType = sensor.data_type;"
-        "if (sensor.data_type === '' || sensor.data_type === null || sensor.data_type === undefined) {"
-        "mappedType = 'UINT16_HI';"
-        "} else if (sensor.data_type === 'FLOAT32_AB') mappedType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_43') mappedType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_ABCD') mappedType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_1234') mappedType = 'FLOAT32_1234';"
-        "else if (sensor.data_type === 'FLOAT32_DCBA') mappedType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_4321') mappedType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_432') mappedType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_BADC') mappedType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_2143') mappedType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_214') mappedType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_CDAB') mappedType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'FLOAT32_3412') mappedType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'FLOAT32_341') mappedType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'UINT32_AB') mappedType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_ABCD') mappedType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_1234') mappedType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'UINT32_DCBA') mappedType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_4321') mappedType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_432') mappedType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'UINT32_BADC') mappedType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_2143') mappedType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_214') mappedType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_CDAB') mappedType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'UINT32_3412') mappedType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'UINT32_341') mappedType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'INT32_AB') mappedType = 'INT32_1234';"
-        "else if (sensor.data_type === 'INT32_ABCD') mappedType = 'INT32_1234';"
-        "else if (sensor.data_type === 'INT32_1234') mappedType = 'INT32_1234';"
-        "else if (sensor.data_type === 'INT32_DCBA') mappedType = 'INT32_4321';"
-        "else if (sensor.data_type === 'INT32_4321') mappedType = 'INT32_4321';"
-        "else if (sensor.data_type === 'INT32_432') mappedType = 'INT32_4321';"
-        "else if (sensor.data_type === 'INT32_BADC') mappedType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_2143') mappedType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_214') mappedType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_CDAB') mappedType = 'INT32_3412';"
-        "else if (sensor.data_type === 'INT32_3412') mappedType = 'INT32_3412';"
-        "else if (sensor.data_type === 'INT32_341') mappedType = 'INT32_3412';"
-        "else if (sensor.data_type === 'UINT32_DCB') mappedType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'INT32_DCB') mappedType = 'INT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_DCB') mappedType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'UINT32') mappedType = 'UINT32_1234';"
-        "else if (sensor.data_type === 'INT32') mappedType = 'INT32_1234';"
-        "else if (sensor.data_type === 'UINT32_CDA') mappedType = 'UINT32_3412';"
-        "else if (sensor.data_type === 'UINT32_BAD') mappedType = 'UINT32_2143';"
-        "else if (sensor.data_type === 'UINT32_DCA') mappedType = 'UINT32_4321';"
-        "else if (sensor.data_type === 'INT32_CDA') mappedType = 'INT32_3412';"
-        "else if (sensor.data_type === 'INT32_BAD') mappedType = 'INT32_2143';"
-        "else if (sensor.data_type === 'INT32_DCA') mappedType = 'INT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_DC') mappedType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'FLOAT32_CDA') mappedType = 'FLOAT32_3412';"
-        "else if (sensor.data_type === 'FLOAT32_BAD') mappedType = 'FLOAT32_2143';"
-        "else if (sensor.data_type === 'FLOAT32_DCA') mappedType = 'FLOAT32_4321';"
-        "else if (sensor.data_type === 'UINT16_B') mappedType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'UINT16_BE') mappedType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'UINT16_HI') mappedType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'UINT16_L') mappedType = 'UINT16_LO';"
-        "else if (sensor.data_type === 'UINT16_LE') mappedType = 'UINT16_LO';"
-        "else if (sensor.data_type === 'UINT16_LO') mappedType = 'UINT16_LO';"
-        "else if (sensor.data_type === 'UINT16') mappedType = 'UINT16_HI';"
-        "else if (sensor.data_type === 'INT16_B') mappedType = 'INT16_HI';"
-        "else if (sensor.data_type === 'INT16_BE') mappedType = 'INT16_HI';"
-        "else if (sensor.data_type === 'INT16_HI') mappedType = 'INT16_HI';"
-        "else if (sensor.data_type === 'INT16_L') mappedType = 'INT16_LO';"
-        "else if (sensor.data_type === 'INT16_LE') mappedType = 'INT16_LO';"
-        "else if (sensor.data_type === 'INT16_LO') mappedType = 'INT16_LO';"
-        "else if (sensor.data_type === 'INT16') mappedType = 'INT16_HI';"
-        "else if (sensor.data_type === 'UINT8') mappedType = 'UINT8';"
-        "else if (sensor.data_type === 'INT8') mappedType = 'INT8';"
-        "else if (sensor.data_type === 'ASCII') mappedType = 'ASCII';"
-        "else if (sensor.data_type === 'HEX') mappedType = 'HEX';"
-        "else if (sensor.data_type === 'BOOL') mappedType = 'BOOL';"
-        "else if (sensor.data_type === 'PDU') mappedType = 'PDU';"
-        "else if (sensor.data_type === 'INT64_12345678') mappedType = 'INT64_12345678';"
-        "else if (sensor.data_type === 'INT64_87654321') mappedType = 'INT64_87654321';"
-        "else if (sensor.data_type === 'INT64_21436587') mappedType = 'INT64_21436587';"
-        "else if (sensor.data_type === 'INT64_78563412') mappedType = 'INT64_78563412';"
-        "else if (sensor.data_type === 'UINT64_12345678') mappedType = 'UINT64_12345678';"
-        "else if (sensor.data_type === 'UINT64_87654321') mappedType = 'UINT64_87654321';"
-        "else if (sensor.data_type === 'UINT64_21436587') mappedType = 'UINT64_21436587';"
-        "else if (sensor.data_type === 'UINT64_78563412') mappedType = 'UINT64_78563412';"
-        "else if (sensor.data_type === 'FLOAT64_12345678') mappedType = 'FLOAT64_12345678';"
-        "else if (sensor.data_type === 'FLOAT64_87654321') mappedType = 'FLOAT64_87654321';"
-        "else if (sensor.data_type === 'FLOAT64_21436587') mappedType = 'FLOAT64_21436587';"
-        "else if (sensor.data_type === 'FLOAT64_78563412') mappedType = 'FLOAT64_78563412';"
-        "else if (sensor.data_type === 'INT64') mappedType = 'INT64_12345678';"
-        "else if (sensor.data_type === 'UINT64') mappedType = 'UINT64_12345678';"
-        "else if (sensor.data_type === 'FLOAT64') mappedType = 'FLOAT64_12345678';"
-        "else if (sensor.data_type === 'INT64_BE') mappedType = 'INT64_12345678';"
-        "else if (sensor.data_type === 'INT64_LE') mappedType = 'INT64_87654321';"
-        "else if (sensor.data_type === 'UINT64_BE') mappedType = 'UINT64_12345678';"
-        "else if (sensor.data_type === 'UINT64_LE') mappedType = 'UINT64_87654321';"
-        "else if (sensor.data_type === 'FLOAT64_BE') mappedType = 'FLOAT64_12345678';"
-        "else if (sensor.data_type === 'FLOAT64_LE') mappedType = 'FLOAT64_87654321';"
-        "editSelect.value = mappedType;"
-        "if (!editSelect.value) {"
-        "for (let option of editSelect.options) {"
-        "if (option.value === mappedType) {"
-        "option.selected = true;"
-        "editSelect.value = mappedType;"
-        "break;"
-        "}"
-        "}"
-        "if (!editSelect.value) {"
-        "}"
-        "}"
-        "} else {"
-        "}"
-        "} else {"
-        "}"
-        "if (sensor.sensor_type === 'QUALITY') {"
-        "loadEditSubSensors(sensorId);"
-        "} else {"
-        "}"
-        "}, 500);"
-        "}}");
-    
-    // Functions for editing water quality sub-sensors
-    httpd_resp_sendstr_chunk(req,
-        "function loadEditSubSensors(sensorId) {"
-        "const sensor = sensorData[sensorId];"
-        "if (!sensor) {"
-        "console.error('[ERROR] ERROR: No sensor data found for sensor', sensorId);"
-        "return;"
-        "}"
-        "if (!sensor.sub_sensors) {"
-        "console.error('[ERROR] ERROR: No sub_sensors property found for sensor', sensorId);"
-        "return;"
-        "}"
-        "const subSensorsDiv = document.getElementById('edit-sub-sensors-' + sensorId);"
-        "if (!subSensorsDiv) {"
-        "console.error('Sub-sensors div not found for sensor', sensorId);"
-        "return;"
-        "}"
-        "subSensorsDiv.innerHTML = '';"
-        "for (let i = 0; i < sensor.sub_sensors.length; i++) {"
-        "const subSensor = sensor.sub_sensors[i];"
-        "if (subSensor.parameter_name) {"
-        "const subSensorId = 'edit-sub-sensor-' + sensorId + '-' + i;"
-        "let h = '<div class=\"sub-sensor\" id=\"' + subSensorId + '\" style=\"border:1px solid #28a745;padding:10px;margin:10px 0;background:#f8fff8;border-radius:5px\">';"
-        "h += '<h5 style=\"color:#28a745;margin-top:0\">[PARAM] Sub-Sensor ' + (i + 1) + '</h5>';"
-        "h += '<div style=\"display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0\">';"
-        "h += '<div><label style=\"font-weight:bold\">Parameter Type:</label><br><select name=\"sensor_' + sensorId + '_sub_' + i + '_parameter\" style=\"width:100%;padding:5px\">';"
-        "for (let j = 0; j < qualityParameterTypes.length; j++) {"
-        "const param = qualityParameterTypes[j];"
-        "const selected = (param.key === subSensor.parameter_name) ? ' selected' : '';"
-        "h += '<option value=\"' + param.key + '\"' + selected + '>' + param.name + ' (' + param.units + ')</option>';"
-        "}"
-        "h += '</select></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Slave ID:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + i + '_slave_id\" value=\"' + subSensor.slave_id + '\" min=\"1\" max=\"247\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Register:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + i + '_register\" value=\"' + subSensor.register_address + '\" min=\"0\" max=\"65535\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '</div>';"
-        "h += '<div style=\"display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0\">';"
-        "h += '<div><label style=\"font-weight:bold\">Quantity:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + i + '_quantity\" value=\"' + subSensor.quantity + '\" min=\"1\" max=\"10\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Register Type:</label><br><select name=\"sensor_' + sensorId + '_sub_' + i + '_register_type\" style=\"width:100%;padding:5px\">';"
-        "const inputSelected = (subSensor.register_type === 'INPUT') ? ' selected' : '';"
-        "const holdingSelected = (subSensor.register_type === 'HOLDING' || !subSensor.register_type) ? ' selected' : '';"
-        "h += '<option value=\"INPUT\"' + inputSelected + '>Input Register</option>';"
-        "h += '<option value=\"HOLDING\"' + holdingSelected + '>Holding Register</option>';"
-        "h += '</select></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Scale Factor:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + i + '_scale_factor\" value=\"' + subSensor.scale_factor + '\" step=\"any\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '</div>';"
-        "h += '<div style=\"display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0\">';"
-        "h += '<div><label style=\"font-weight:bold\">Data Type:</label><br><select name=\"sensor_' + sensorId + '_sub_' + i + '_data_type\" style=\"width:100%;padding:5px\">';"
-        "h += '<optgroup label=\"8-bit Integer Types\">';"
-        "const int8Selected = (subSensor.data_type === 'INT8') ? ' selected' : '';"
-        "const uint8Selected = (subSensor.data_type === 'UINT8') ? ' selected' : '';"
-        "h += '<option value=\"INT8\"' + int8Selected + '>INT8 - 8-bit Signed</option>';"
-        "h += '<option value=\"UINT8\"' + uint8Selected + '>UINT8 - 8-bit Unsigned</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"16-bit Integer Types\">';"
-        "const int16Selected = (subSensor.data_type === 'INT16') ? ' selected' : '';"
-        "const uint16Selected = (subSensor.data_type === 'UINT16') ? ' selected' : '';"
-        "h += '<option value=\"INT16\"' + int16Selected + '>INT16 - 16-bit Signed</option>';"
-        "h += '<option value=\"UINT16\"' + uint16Selected + '>UINT16 - 16-bit Unsigned</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"32-bit Integer Types\">';"
-        "const int32AbcdSelected = (subSensor.data_type === 'INT32_ABCD') ? ' selected' : '';"
-        "const int32DcbaSelected = (subSensor.data_type === 'INT32_DCBA') ? ' selected' : '';"
-        "const int32BadcSelected = (subSensor.data_type === 'INT32_BADC') ? ' selected' : '';"
-        "const int32CdabSelected = (subSensor.data_type === 'INT32_CDAB') ? ' selected' : '';"
-        "const uint32AbcdSelected = (subSensor.data_type === 'UINT32_ABCD') ? ' selected' : '';"
-        "const uint32DcbaSelected = (subSensor.data_type === 'UINT32_DCBA') ? ' selected' : '';"
-        "const uint32BadcSelected = (subSensor.data_type === 'UINT32_BADC') ? ' selected' : '';"
-        "const uint32CdabSelected = (subSensor.data_type === 'UINT32_CDAB') ? ' selected' : '';"
-        "h += '<option value=\"INT32_ABCD\"' + int32AbcdSelected + '>INT32_ABCD - Big Endian</option>';"
-        "h += '<option value=\"INT32_DCBA\"' + int32DcbaSelected + '>INT32_DCBA - Little Endian</option>';"
-        "h += '<option value=\"INT32_BADC\"' + int32BadcSelected + '>INT32_BADC - Mid-Big Endian</option>';"
-        "h += '<option value=\"INT32_CDAB\"' + int32CdabSelected + '>INT32_CDAB - Mid-Little Endian</option>';"
-        "h += '<option value=\"UINT32_ABCD\"' + uint32AbcdSelected + '>UINT32_ABCD - Big Endian</option>';"
-        "h += '<option value=\"UINT32_DCBA\"' + uint32DcbaSelected + '>UINT32_DCBA - Little Endian</option>';"
-        "h += '<option value=\"UINT32_BADC\"' + uint32BadcSelected + '>UINT32_BADC - Mid-Big Endian</option>';"
-        "h += '<option value=\"UINT32_CDAB\"' + uint32CdabSelected + '>UINT32_CDAB - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"32-bit Float Types\">';"
-        "const float32AbcdSelected = (subSensor.data_type === 'FLOAT32_ABCD') ? ' selected' : '';"
-        "const float32DcbaSelected = (subSensor.data_type === 'FLOAT32_DCBA') ? ' selected' : '';"
-        "const float32BadcSelected = (subSensor.data_type === 'FLOAT32_BADC') ? ' selected' : '';"
-        "const float32CdabSelected = (subSensor.data_type === 'FLOAT32_CDAB') ? ' selected' : '';"
-        "h += '<option value=\"FLOAT32_ABCD\"' + float32AbcdSelected + '>FLOAT32_ABCD - Big Endian</option>';"
-        "h += '<option value=\"FLOAT32_DCBA\"' + float32DcbaSelected + '>FLOAT32_DCBA - Little Endian</option>';"
-        "h += '<option value=\"FLOAT32_BADC\"' + float32BadcSelected + '>FLOAT32_BADC - Mid-Big Endian</option>';"
-        "h += '<option value=\"FLOAT32_CDAB\"' + float32CdabSelected + '>FLOAT32_CDAB - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"64-bit Integer Types\">';"
-        "const int64_1Selected = (subSensor.data_type === 'INT64_12345678') ? ' selected' : '';"
-        "const int64_2Selected = (subSensor.data_type === 'INT64_87654321') ? ' selected' : '';"
-        "const int64_3Selected = (subSensor.data_type === 'INT64_21436587') ? ' selected' : '';"
-        "const int64_4Selected = (subSensor.data_type === 'INT64_78563412') ? ' selected' : '';"
-        "const uint64_1Selected = (subSensor.data_type === 'UINT64_12345678') ? ' selected' : '';"
-        "const uint64_2Selected = (subSensor.data_type === 'UINT64_87654321') ? ' selected' : '';"
-        "const uint64_3Selected = (subSensor.data_type === 'UINT64_21436587') ? ' selected' : '';"
-        "const uint64_4Selected = (subSensor.data_type === 'UINT64_78563412') ? ' selected' : '';"
-        "h += '<option value=\"INT64_12345678\"' + int64_1Selected + '>INT64_12345678 - Big Endian</option>';"
-        "h += '<option value=\"INT64_87654321\"' + int64_2Selected + '>INT64_87654321 - Little Endian</option>';"
-        "h += '<option value=\"INT64_21436587\"' + int64_3Selected + '>INT64_21436587 - Mid-Big Endian</option>';"
-        "h += '<option value=\"INT64_78563412\"' + int64_4Selected + '>INT64_78563412 - Mid-Little Endian</option>';"
-        "h += '<option value=\"UINT64_12345678\"' + uint64_1Selected + '>UINT64_12345678 - Big Endian</option>';"
-        "h += '<option value=\"UINT64_87654321\"' + uint64_2Selected + '>UINT64_87654321 - Little Endian</option>';"
-        "h += '<option value=\"UINT64_21436587\"' + uint64_3Selected + '>UINT64_21436587 - Mid-Big Endian</option>';"
-        "h += '<option value=\"UINT64_78563412\"' + uint64_4Selected + '>UINT64_78563412 - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"64-bit Float Types\">';"
-        "const float64_1Selected = (subSensor.data_type === 'FLOAT64_12345678') ? ' selected' : '';"
-        "const float64_2Selected = (subSensor.data_type === 'FLOAT64_87654321') ? ' selected' : '';"
-        "const float64_3Selected = (subSensor.data_type === 'FLOAT64_21436587') ? ' selected' : '';"
-        "const float64_4Selected = (subSensor.data_type === 'FLOAT64_78563412') ? ' selected' : '';"
-        "h += '<option value=\"FLOAT64_12345678\"' + float64_1Selected + '>FLOAT64_12345678 - Big Endian</option>';"
-        "h += '<option value=\"FLOAT64_87654321\"' + float64_2Selected + '>FLOAT64_87654321 - Little Endian</option>';"
-        "h += '<option value=\"FLOAT64_21436587\"' + float64_3Selected + '>FLOAT64_21436587 - Mid-Big Endian</option>';"
-        "h += '<option value=\"FLOAT64_78563412\"' + float64_4Selected + '>FLOAT64_78563412 - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"Special Types\">';"
-        "const asciiSelected = (subSensor.data_type === 'ASCII') ? ' selected' : '';"
-        "const hexSelected = (subSensor.data_type === 'HEX') ? ' selected' : '';"
-        "const boolSelected = (subSensor.data_type === 'BOOL') ? ' selected' : '';"
-        "const pduSelected = (subSensor.data_type === 'PDU') ? ' selected' : '';"
-        "h += '<option value=\"ASCII\"' + asciiSelected + '>ASCII String</option>';"
-        "h += '<option value=\"HEX\"' + hexSelected + '>Hexadecimal</option>';"
-        "h += '<option value=\"BOOL\"' + boolSelected + '>Boolean</option>';"
-        "h += '<option value=\"PDU\"' + pduSelected + '>PDU (Protocol Data Unit)</option>';"
-        "h += '</optgroup>';"
-        "h += '</select></div>';"
-        "h += '<div style=\"display:flex;align-items:end\"><button type=\"button\" onclick=\"removeEditSubSensor(\\\"' + subSensorId + '\\\")\" style=\"background:#dc3545;color:white;padding:8px 12px;border:none;border-radius:4px;font-size:12px;cursor:pointer\">[DEL] Remove</button></div>';"
-        "h += '</div>';"
-        "h += '</div>';"
-        "subSensorsDiv.innerHTML += h;"
-        "}"
-        "}"
-        "}"
-        "function addEditSubSensor(sensorId) {"
-        "const subSensorsDiv = document.getElementById('edit-sub-sensors-' + sensorId);"
-        "if (!subSensorsDiv) {"
-        "alert('ERROR: Sub-sensors container not found');"
-        "return;"
-        "}"
-        "const subSensorCount = subSensorsDiv.querySelectorAll('.sub-sensor').length;"
-        "const subSensorId = 'edit-sub-sensor-' + sensorId + '-' + subSensorCount;"
-        "let h = '<div class=\"sub-sensor\" id=\"' + subSensorId + '\" style=\"border:1px solid #28a745;padding:10px;margin:10px 0;background:#f8fff8;border-radius:5px\">';"
-        "h += '<h5 style=\"color:#28a745;margin-top:0\">[PARAM] Sub-Sensor ' + (subSensorCount + 1) + '</h5>';"
-        "h += '<div style=\"display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0\">';"
-        "h += '<div><label style=\"font-weight:bold\">Parameter Type:</label><br><select name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_parameter\" style=\"width:100%;padding:5px\">';"
-        "h += '<option value=\"\">Select Parameter</option>';"
-        "for (let i = 0; i < qualityParameterTypes.length; i++) {"
-        "const param = qualityParameterTypes[i];"
-        "h += '<option value=\"' + param.key + '\">' + param.name + ' (' + param.units + ')</option>';"
-        "}"
-        "h += '</select></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Slave ID:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_slave_id\" value=\"1\" min=\"1\" max=\"247\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Register:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_register\" value=\"1\" min=\"0\" max=\"65535\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '</div>';"
-        "h += '<div style=\"display:grid;grid-template-columns:1fr 1fr 1fr;gap:10px;margin:10px 0\">';"
-        "h += '<div><label style=\"font-weight:bold\">Quantity:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_quantity\" value=\"1\" min=\"1\" max=\"10\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Register Type:</label><br><select name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_register_type\" style=\"width:100%;padding:5px\">';"
-        "h += '<option value=\"HOLDING\" selected>Holding Register</option>';"
-        "h += '<option value=\"INPUT\">Input Register</option>';"
-        "h += '</select></div>';"
-        "h += '<div><label style=\"font-weight:bold\">Scale Factor:</label><br><input type=\"number\" name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_scale_factor\" value=\"1.0\" step=\"any\" style=\"width:100%;padding:5px\"></div>';"
-        "h += '</div>';"
-        "h += '<div style=\"display:grid;grid-template-columns:1fr 1fr;gap:10px;margin:10px 0\">';"
-        "h += '<div><label style=\"font-weight:bold\">Data Type:</label><br><select name=\"sensor_' + sensorId + '_sub_' + subSensorCount + '_data_type\" style=\"width:100%;padding:5px\">';"
-        "h += '<option value=\"\">Select Data Type</option>';"
-        "h += '<optgroup label=\"8-bit Integer Types\">';"
-        "h += '<option value=\"INT8\">INT8 - 8-bit Signed</option>';"
-        "h += '<option value=\"UINT8\">UINT8 - 8-bit Unsigned</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"16-bit Integer Types\">';"
-        "h += '<option value=\"INT16\">INT16 - 16-bit Signed</option>';"
-        "h += '<option value=\"UINT16\">UINT16 - 16-bit Unsigned</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"32-bit Integer Types\">';"
-        "h += '<option value=\"INT32_ABCD\">INT32_ABCD - Big Endian</option>';"
-        "h += '<option value=\"INT32_DCBA\">INT32_DCBA - Little Endian</option>';"
-        "h += '<option value=\"INT32_BADC\">INT32_BADC - Mid-Big Endian</option>';"
-        "h += '<option value=\"INT32_CDAB\">INT32_CDAB - Mid-Little Endian</option>';"
-        "h += '<option value=\"UINT32_ABCD\">UINT32_ABCD - Big Endian</option>';"
-        "h += '<option value=\"UINT32_DCBA\">UINT32_DCBA - Little Endian</option>';"
-        "h += '<option value=\"UINT32_BADC\">UINT32_BADC - Mid-Big Endian</option>';"
-        "h += '<option value=\"UINT32_CDAB\">UINT32_CDAB - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"32-bit Float Types\">';"
-        "h += '<option value=\"FLOAT32_ABCD\">FLOAT32_ABCD - Big Endian</option>';"
-        "h += '<option value=\"FLOAT32_DCBA\">FLOAT32_DCBA - Little Endian</option>';"
-        "h += '<option value=\"FLOAT32_BADC\">FLOAT32_BADC - Mid-Big Endian</option>';"
-        "h += '<option value=\"FLOAT32_CDAB\">FLOAT32_CDAB - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"64-bit Integer Types\">';"
-        "h += '<option value=\"INT64_12345678\">INT64_12345678 - Big Endian</option>';"
-        "h += '<option value=\"INT64_87654321\">INT64_87654321 - Little Endian</option>';"
-        "h += '<option value=\"INT64_21436587\">INT64_21436587 - Mid-Big Endian</option>';"
-        "h += '<option value=\"INT64_78563412\">INT64_78563412 - Mid-Little Endian</option>';"
-        "h += '<option value=\"UINT64_12345678\">UINT64_12345678 - Big Endian</option>';"
-        "h += '<option value=\"UINT64_87654321\">UINT64_87654321 - Little Endian</option>';"
-        "h += '<option value=\"UINT64_21436587\">UINT64_21436587 - Mid-Big Endian</option>';"
-        "h += '<option value=\"UINT64_78563412\">UINT64_78563412 - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"64-bit Float Types\">';"
-        "h += '<option value=\"FLOAT64_12345678\">FLOAT64_12345678 - Big Endian</option>';"
-        "h += '<option value=\"FLOAT64_87654321\">FLOAT64_87654321 - Little Endian</option>';"
-        "h += '<option value=\"FLOAT64_21436587\">FLOAT64_21436587 - Mid-Big Endian</option>';"
-        "h += '<option value=\"FLOAT64_78563412\">FLOAT64_78563412 - Mid-Little Endian</option>';"
-        "h += '</optgroup>';"
-        "h += '<optgroup label=\"Special Types\">';"
-        "h += '<option value=\"ASCII\">ASCII String</option>';"
-        "h += '<option value=\"HEX\">Hexadecimal</option>';"
-        "h += '<option value=\"BOOL\">Boolean</option>';"
-        "h += '<option value=\"PDU\">PDU (Protocol Data Unit)</option>';"
-        "h += '</optgroup>';"
-        "h += '</select></div>';"
-        "h += '<div style=\"display:flex;align-items:end;gap:5px\">';"
-        "h += '<button type=\"button\" onclick=\"saveEditSubSensor(\\\"' + subSensorId + '\\\")\" style=\"background:#28a745;color:white;padding:8px 12px;border:none;border-radius:4px;font-size:12px;cursor:pointer\">[SAVE] Save</button>';"
-        "h += '<button type=\"button\" onclick=\"removeEditSubSensor(\\\"' + subSensorId + '\\\")\" style=\"background:#dc3545;color:white;padding:8px 12px;border:none;border-radius:4px;font-size:12px;cursor:pointer\">[DEL] Remove</button>';"
-        "h += '</div>';"
-        "h += '</div>';"
-        "h += '</div>';"
-        "subSensorsDiv.insertAdjacentHTML('beforeend', h);"
-        "}"
-        ""
-        "function removeEditSubSensor(subSensorId) {"
-        "const subSensorDiv = document.getElementById(subSensorId);"
-        "if (subSensorDiv) {"
-        "subSensorDiv.remove();"
-        "}"
-        "}");
-    
-    // Save and cancel functions
-    httpd_resp_sendstr_chunk(req,
-        "function saveSensorEdit(sensorId){"
-        "const name=document.getElementById('edit_name_'+sensorId).value;"
-        "const unitId=document.getElementById('edit_unit_'+sensorId).value;"
-        "const sensor=sensorData[sensorId];"
-        "const slaveIdEl=document.getElementById('edit_slave_'+sensorId);"
-        "const registerEl=document.getElementById('edit_register_'+sensorId);"
-        "const quantityEl=document.getElementById('edit_quantity_'+sensorId);"
-        "const dataTypeEl=document.getElementById('edit_datatype_'+sensorId);"
-        "const baudRateEl=document.getElementById('edit_baud_'+sensorId);"
-        "const parityEl=document.getElementById('edit_parity_'+sensorId);"
-        "const registerTypeEl=document.getElementById('edit_register_type_'+sensorId);"
-        "const slaveId=slaveIdEl?slaveIdEl.value:'0';"
-        "const register=registerEl?registerEl.value:'0';"
-        "const quantity=quantityEl?quantityEl.value:'1';"
-        "const dataType=dataTypeEl?dataTypeEl.value:'UINT16_BE';"
-        "const baudRate=baudRateEl?baudRateEl.value:'9600';"
-        "const parity=parityEl?parityEl.value:'none';"
-        "const registerType=registerTypeEl?registerTypeEl.value:'HOLDING';"
-        "let formData='sensor_id='+sensorId+'&name='+encodeURIComponent(name)+'&unit_id='+encodeURIComponent(unitId)+"
-        "'&slave_id='+slaveId+'&register_address='+register+'&quantity='+quantity+'&data_type='+encodeURIComponent(dataType)+'&register_type='+registerType+'&baud_rate='+baudRate+'&parity='+parity;"
-        "if (sensor.sensor_type === 'Level') {"
-        "const sensorHeight=document.getElementById('edit_sensor_height_'+sensorId).value||'0';"
-        "const maxWaterLevel=document.getElementById('edit_max_water_level_'+sensorId).value||'0';"
-        "formData+='&sensor_type=Level&sensor_height='+sensorHeight+'&max_water_level='+maxWaterLevel+'&scale_factor=1.0&meter_type=';"
-        "console.log('Saving Level sensor:',sensorId,'Height:',sensorHeight,'MaxLevel:',maxWaterLevel);"
-        "} else if (sensor.sensor_type === 'Radar Level') {"
-        "const maxWaterLevel=document.getElementById('edit_max_water_level_'+sensorId).value||'0';"
-        "formData+='&sensor_type=Radar Level&sensor_height=0&max_water_level='+maxWaterLevel+'&scale_factor=1.0&meter_type=';"
-        "console.log('Saving Radar Level sensor:',sensorId,'MaxLevel:',maxWaterLevel);"
-        "} else if (sensor.sensor_type === 'Hydrostatic_Level') {"
-        "const maxWaterLevel=document.getElementById('edit_max_water_level_'+sensorId).value||'0';"
-        "formData+='&sensor_type=Hydrostatic_Level&sensor_height=0&max_water_level='+maxWaterLevel+'&scale_factor=1.0&meter_type=';"
-        "console.log('Saving Hydrostatic_Level sensor:',sensorId,'TankHeight:',maxWaterLevel);"
-        "} else if (sensor.sensor_type === 'ENERGY') {"
-        "const meterType=document.getElementById('edit_meter_type_'+sensorId).value||'';"
-        "formData+='&sensor_type=ENERGY&meter_type='+encodeURIComponent(meterType)+'&scale_factor=1.0&sensor_height=0&max_water_level=0';"
-        "console.log('Saving ENERGY sensor:',sensorId,'MeterType:',meterType);"
-        "} else if (sensor.sensor_type === 'QUALITY') {"
-        "formData+='&sensor_type=QUALITY&scale_factor=1.0&sensor_height=0&max_water_level=0&meter_type=';"
-        "const subSensors = document.querySelectorAll('#edit-sub-sensors-' + sensorId + ' .sub-sensor');"
-        "for (let i = 0; i < subSensors.length; i++) {"
-        "const subSensor = subSensors[i];"
-        "const parameterSelect = subSensor.querySelector('select[name*=\"_parameter\"]');"
-        "const slaveIdInput = subSensor.querySelector('input[name*=\"_slave_id\"]');"
-        "const registerInput = subSensor.querySelector('input[name*=\"_register\"]');"
-        "const quantityInput = subSensor.querySelector('input[name*=\"_quantity\"]');"
-        "const registerTypeSelect = subSensor.querySelector('select[name*=\"_register_type\"]');"
-        "const scaleFactorInput = subSensor.querySelector('input[name*=\"_scale_factor\"]');"
-        "const dataTypeSelect = subSensor.querySelector('select[name*=\"_data_type\"]');"
-        "if (parameterSelect && parameterSelect.value && slaveIdInput && registerInput) {"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_parameter=' + encodeURIComponent(parameterSelect.value);"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_slave_id=' + (slaveIdInput.value || '1');"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_register=' + (registerInput.value || '30001');"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_quantity=' + (quantityInput ? quantityInput.value || '1' : '1');"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_register_type=' + (registerTypeSelect ? registerTypeSelect.value || 'HOLDING' : 'HOLDING');"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_scale_factor=' + (scaleFactorInput ? scaleFactorInput.value || '1.0' : '1.0');"
-        "formData += '&sensor_' + sensorId + '_sub_' + i + '_data_type=' + (dataTypeSelect ? dataTypeSelect.value : '');"
-        "}"
-        "}"
-        "console.log('Saving QUALITY sensor:',sensorId,'Sub-sensors count:',subSensors.length);"
-        "} else if (sensor.sensor_type === 'RAINGAUGE') {"
-        "const scaleFactor=document.getElementById('edit_scale_factor_'+sensorId).value||'1.0';"
-        "formData+='&sensor_type=RAINGAUGE&scale_factor='+scaleFactor+'&sensor_height=0&max_water_level=0&meter_type=';"
-        "console.log('Saving RAINGAUGE sensor:',sensorId,'ScaleFactor:',scaleFactor);"
-        "} else if (sensor.sensor_type === 'BOREWELL') {"
-        "const scaleFactor=document.getElementById('edit_scale_factor_'+sensorId).value||'1.0';"
-        "formData+='&sensor_type=BOREWELL&scale_factor='+scaleFactor+'&sensor_height=0&max_water_level=0&meter_type=';"
-        "console.log('Saving BOREWELL sensor:',sensorId,'ScaleFactor:',scaleFactor);"
-        "} else {"
-        "console.log('Edit save debug: Unknown sensor_type=', sensor.sensor_type, 'preserving original type for sensorId=', sensorId);"
-        "const scaleFactor=document.getElementById('edit_scale_factor_'+sensorId).value||'1.0';"
-        "const sensorTypeToSave = sensor.sensor_type || 'Flow-Meter';"
-        "formData+='&sensor_type='+encodeURIComponent(sensorTypeToSave)+'&scale_factor='+scaleFactor+'&sensor_height=0&max_water_level=0&meter_type=';"
-        "console.log('Saving sensor:',sensorId,'SensorType:',sensorTypeToSave,'ScaleFactor:',scaleFactor);"
-        "}"
-        "if(!name||!unitId){alert('ERROR: Please fill in Name and Unit ID');return;}"
-        "fetch('/edit_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:formData})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){alert('SUCCESS: Sensor updated successfully');sessionStorage.setItem('showSection', 'sensors');window.location.reload();}else{alert('ERROR: '+data.message);}"
-        "}).catch(e=>{alert('ERROR: Update failed: '+e.message);});}"
-        "function cancelSensorEdit(sensorId){sessionStorage.setItem('showSection', 'sensors');window.location.reload();}"
-        "function deleteSensor(sensorId){"
-        "if(confirm('Are you sure you want to delete this sensor?')){"
-        "fetch('/delete_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:'sensor_id='+sensorId})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){alert('SUCCESS: Sensor deleted');sessionStorage.setItem('showSection', 'sensors');window.location.reload();}else{alert('ERROR: '+data.message);}"
-        "}).catch(e=>{alert('ERROR: Delete failed: '+e.message);});"
-        "}}"
-        "function testNewSensorRS485(sensorId){"
-        "console.log('Testing new sensor RS485 for sensor ID:', sensorId);"
-        "const resultDiv=document.getElementById('test-result-new-'+sensorId);"
-        "if(!resultDiv){alert('Error: Result div not found for ID: test-result-new-'+sensorId);return;}"
-        "resultDiv.style.display='block';"
-        "resultDiv.innerHTML='<div style=\"background:#fff3cd;padding:10px;border-radius:4px;color:#856404\">Testing RS485 communication...</div>';"
-        "let sensorTypeElem=document.querySelector('select[name=\"sensor_'+sensorId+'_sensor_type\"]');"
-        "if(!sensorTypeElem) sensorTypeElem=document.querySelector('input[name=\"sensor_'+sensorId+'_sensor_type\"]');"
-        "let sensorType=sensorTypeElem ? sensorTypeElem.value : '';"
-        "const baudRateElem=document.querySelector('select[name=\"sensor_'+sensorId+'_baud_rate\"]');"
-        "const parityElem=document.querySelector('select[name=\"sensor_'+sensorId+'_parity\"]');"
-        "const baudRate=baudRateElem ? baudRateElem.value : '9600';"
-        "const parity=parityElem ? parityElem.value : 'none';"
-        "if(sensorType==='QUALITY'){"
-        "console.log('Testing QUALITY sensor - gathering sub-sensor data');"
-        "const subSensorContainer=document.getElementById('sub-sensors-container-'+sensorId);"
-        "if(!subSensorContainer){resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR:</strong> Sub-sensor container not found</div>';return;}"
-        "const subSensors=subSensorContainer.querySelectorAll('.sub-sensor-form');"
-        "if(subSensors.length===0){resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR:</strong> Please add at least one sub-sensor before testing</div>';return;}"
-        "let data='sensor_type=QUALITY&baud_rate='+baudRate+'&parity='+parity+'&sub_sensor_count='+subSensors.length;"
-        "for(let i=0;i<subSensors.length;i++){"
-        "const paramElem=subSensors[i].querySelector('select[name*=\"_parameter\"]');"
-        "const slaveElem=subSensors[i].querySelector('input[name*=\"_slave_id\"]');"
-        "const regElem=subSensors[i].querySelector('input[name*=\"_register\"]');"
-        "const qtyElem=subSensors[i].querySelector('input[name*=\"_quantity\"]');"
-        "const dtElem=subSensors[i].querySelector('select[name*=\"_data_type\"]');"
-        "const scaleElem=subSensors[i].querySelector('input[name*=\"_scale\"]');"
-        "const regTypeElem=subSensors[i].querySelector('select[name*=\"_register_type\"]');"
-        "data+='&sub_'+i+'_param='+(paramElem?encodeURIComponent(paramElem.value):'');"
-        "data+='&sub_'+i+'_slave='+(slaveElem?slaveElem.value:'1');"
-        "data+='&sub_'+i+'_reg='+(regElem?regElem.value:'1');"
-        "data+='&sub_'+i+'_qty='+(qtyElem?qtyElem.value:'1');"
-        "data+='&sub_'+i+'_dtype='+(dtElem?encodeURIComponent(dtElem.value):'UINT16_BE');"
-        "data+='&sub_'+i+'_scale='+(scaleElem?scaleElem.value:'1.0');"
-        "data+='&sub_'+i+'_regtype='+(regTypeElem?regTypeElem.value:'HOLDING');"
-        "}"
-        "console.log('QUALITY test data:',data);"
-        "fetch('/test_quality_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(r=>{if(!r.ok)throw new Error('HTTP '+r.status);return r.text();})"
-        ".then(html=>{resultDiv.innerHTML=html;})"
-        ".catch(e=>{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR:</strong> '+e.message+'</div>';});"
-        "return;}"
-        "console.log('Looking for form elements with sensor ID:', sensorId);"
-        "const slaveIdElem=document.querySelector('input[name=\"sensor_'+sensorId+'_slave_id\"]');"
-        "const regAddrElem=document.querySelector('input[name=\"sensor_'+sensorId+'_register_address\"]');"
-        "const quantityElem=document.querySelector('input[name=\"sensor_'+sensorId+'_quantity\"]');"
-        "let dataTypeElem=document.querySelector('select[name=\"sensor_'+sensorId+'_data_type\"]');"
-        "if(!dataTypeElem) dataTypeElem=document.querySelector('input[name=\"sensor_'+sensorId+'_data_type\"]');"
-        "const scaleFactorElem=document.querySelector('input[name=\"sensor_'+sensorId+'_scale_factor\"]');"
-        "const registerTypeElem=document.querySelector('select[name=\"sensor_'+sensorId+'_register_type\"]');"
-        "console.log('Form elements found:', {slaveId: !!slaveIdElem, regAddr: !!regAddrElem, quantity: !!quantityElem, dataType: !!dataTypeElem, baudRate: !!baudRateElem, parity: !!parityElem, registerType: !!registerTypeElem, sensorType: !!sensorTypeElem});"
-        "if(!slaveIdElem||!regAddrElem||!quantityElem||(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataTypeElem)||!baudRateElem||!parityElem){"
-        "let missingFields=[];"
-        "if(!slaveIdElem) missingFields.push('slave_id');"
-        "if(!regAddrElem) missingFields.push('register_address');"
-        "if(!quantityElem) missingFields.push('quantity');"
-        "if(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataTypeElem) missingFields.push('data_type');"
-        "if(!baudRateElem) missingFields.push('baud_rate');"
-        "if(!parityElem) missingFields.push('parity');"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Missing Form Elements</strong><br>Cannot find: '+missingFields.join(', ')+'<br>Please make sure all form fields are filled and visible.</div>';"
-        "return;}"
-        "const slaveId=slaveIdElem.value||'1';"
-        "const regAddr=regAddrElem.value||'0';"
-        "const quantity=quantityElem.value||'1';"
-        "let dataType=dataTypeElem ? dataTypeElem.value : '';"
-        "if(sensorType==='Piezometer' && !dataType) dataType='UINT16_HI';"
-        "if(sensorType==='Clampon' && !dataType) dataType='CLAMPON_FIXED';"
-        "if(sensorType==='Dailian' && !dataType) dataType='UINT32_3412';"
-        "if(sensorType==='Dailian_EMF' && !dataType) dataType='DAILIAN_EMF_FIXED';"
-        "if(sensorType==='Panda_EMF' && !dataType) dataType='PANDA_EMF_FIXED';"
-        "if(sensorType==='Panda_Level' && !dataType) dataType='PANDA_LEVEL_FIXED';"
-        "if(sensorType==='ZEST' && !dataType) dataType='ZEST_FIXED';"
-        "const registerType=registerTypeElem ? registerTypeElem.value : 'HOLDING';"
-        "const scaleFactor=(scaleFactorElem ? scaleFactorElem.value : null)||'1.0';"
-        "if(!sensorType){"
-        "console.log('Sensor type not found, using Flow-Meter as default');"
-        "sensorType='Flow-Meter';"
-        "}"
-        "console.log('New sensor test params:',{slaveId,regAddr,quantity,dataType,baudRate,parity,scaleFactor,sensorType});"
-        "if(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataType){"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Data Type Required</strong><br>Please select a data type before testing.</div>';"
-        "return;}"
-        "if(!slaveId||!regAddr||!quantity||!scaleFactor){"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Validation Error</strong><br>Please fill in all required fields before testing.</div>';"
-        "return;}"
-        "let data='slave_id='+slaveId+'&register_address='+regAddr+'&quantity='+quantity+'&data_type='+dataType+'&register_type='+registerType+'&baud_rate='+baudRate+'&parity='+parity+'&scale_factor='+scaleFactor;"
-        "data+='&sensor_type='+encodeURIComponent(sensorType);"
-        "const sensorHeightElem=document.querySelector('input[name=\"sensor_'+sensorId+'_sensor_height\"]');"
-        "const maxWaterLevelElem=document.querySelector('input[name=\"sensor_'+sensorId+'_max_water_level\"]');"
-        "if(sensorHeightElem) data+='&sensor_height='+sensorHeightElem.value;"
-        "if(maxWaterLevelElem) data+='&max_water_level='+maxWaterLevelElem.value;"
-        "console.log('Sending new sensor test data:', data);"
-        "fetch('/test_rs485',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(response => {"
-        "console.log('New sensor test response status:', response.status);"
-        "if (!response.ok) {"
-        "throw new Error('HTTP '+response.status+': '+response.statusText);"
-        "}"
-        "return response.text();"
-        "})"
-        ".then(htmlData=>{"
-        "console.log('New sensor test response HTML received');"
-        "resultDiv.innerHTML=htmlData;"
-        "}).catch(e=>{"
-        "console.error('New sensor test error:', e);"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Communication Error</strong><br>'+e.message+'<br>Check browser console (F12) for details.</div>';"
-        "});"
-        "}"
-        "function testEditSensorRS485(sensorId){"
-        "console.log('Testing edit sensor RS485 for sensor ID:', sensorId);"
-        "const resultDiv=document.getElementById('test-result-edit-'+sensorId);"
-        "if(!resultDiv){alert('Error: Result div not found');return;}"
-        "resultDiv.style.display='block';"
-        "resultDiv.innerHTML='<div style=\"background:#fff3cd;padding:10px;border-radius:4px;color:#856404\">Testing RS485 communication...</div>';"
-        "const sensor=sensorData[sensorId];"
-        "const sensorType=sensor ? sensor.sensor_type : '';"
-        "const baudRateElem=document.getElementById('edit_baud_'+sensorId);"
-        "const parityElem=document.getElementById('edit_parity_'+sensorId);"
-        "const baudRate=baudRateElem ? baudRateElem.value : '9600';"
-        "const parity=parityElem ? parityElem.value : 'none';"
-        "if(sensorType==='QUALITY'){"
-        "console.log('Testing QUALITY sensor - gathering sub-sensor data');"
-        "const subSensorContainer=document.getElementById('edit-sub-sensors-'+sensorId);"
-        "if(!subSensorContainer){resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR:</strong> Sub-sensor container not found</div>';return;}"
-        "const subSensors=subSensorContainer.querySelectorAll('.sub-sensor');"
-        "if(subSensors.length===0){resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR:</strong> No sub-sensors configured</div>';return;}"
-        "let data='sensor_type=QUALITY&baud_rate='+baudRate+'&parity='+parity+'&sub_sensor_count='+subSensors.length;"
-        "for(let i=0;i<subSensors.length;i++){"
-        "const paramElem=subSensors[i].querySelector('select[name*=\"_parameter\"]');"
-        "const slaveElem=subSensors[i].querySelector('input[name*=\"_slave_id\"]');"
-        "const regElem=subSensors[i].querySelector('input[name*=\"_register\"]');"
-        "const qtyElem=subSensors[i].querySelector('input[name*=\"_quantity\"]');"
-        "const dtElem=subSensors[i].querySelector('select[name*=\"_data_type\"]');"
-        "const scaleElem=subSensors[i].querySelector('input[name*=\"_scale\"]');"
-        "const regTypeElem=subSensors[i].querySelector('select[name*=\"_register_type\"]');"
-        "data+='&sub_'+i+'_param='+(paramElem?encodeURIComponent(paramElem.value):'');"
-        "data+='&sub_'+i+'_slave='+(slaveElem?slaveElem.value:'1');"
-        "data+='&sub_'+i+'_reg='+(regElem?regElem.value:'1');"
-        "data+='&sub_'+i+'_qty='+(qtyElem?qtyElem.value:'1');"
-        "data+='&sub_'+i+'_dtype='+(dtElem?encodeURIComponent(dtElem.value):'UINT16_BE');"
-        "data+='&sub_'+i+'_scale='+(scaleElem?scaleElem.value:'1.0');"
-        "data+='&sub_'+i+'_regtype='+(regTypeElem?regTypeElem.value:'HOLDING');"
-        "}"
-        "console.log('QUALITY edit test data:',data);"
-        "fetch('/test_quality_sensor',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(r=>{if(!r.ok)throw new Error('HTTP '+r.status);return r.text();})"
-        ".then(html=>{resultDiv.innerHTML=html;})"
-        ".catch(e=>{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR:</strong> '+e.message+'</div>';});"
-        "return;}"
-        "const slaveIdElem=document.getElementById('edit_slave_'+sensorId);"
-        "const regAddrElem=document.getElementById('edit_register_'+sensorId);"
-        "const quantityElem=document.getElementById('edit_quantity_'+sensorId);"
-        "const registerTypeElem=document.getElementById('edit_register_type_'+sensorId);"
-        "const dataTypeElem=document.getElementById('edit_datatype_'+sensorId);"
-        "const scaleFactorElem=document.getElementById('edit_scale_factor_'+sensorId);"
-        "if(!slaveIdElem||!regAddrElem||!quantityElem||!registerTypeElem||!dataTypeElem||!baudRateElem||!parityElem){"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Form Error</strong><br>Cannot find form elements. Please refresh the page.</div>';"
-        "return;}"
-        "const slaveId=slaveIdElem.value||'1';"
-        "const regAddr=regAddrElem.value||'0';"
-        "const quantity=quantityElem.value||'1';"
-        "const registerType=registerTypeElem.value||'HOLDING';"
-        "const dataType=dataTypeElem.value||'';"
-        "const scaleFactor=(scaleFactorElem ? scaleFactorElem.value : null)||'1.0';"
-        "console.log('Edit test params:',{slaveId,regAddr,quantity,registerType,dataType,baudRate,parity,scaleFactor,sensorType});"
-        "if(sensorType !== 'ZEST' && sensorType !== 'Clampon' && sensorType !== 'Dailian' && sensorType !== 'Dailian_EMF' && sensorType !== 'Panda_EMF' && sensorType !== 'Panda_Level' && sensorType !== 'Piezometer' && !dataType){"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Data Type Required</strong><br>Please select a data type before testing.</div>';"
-        "return;}"
-        "if(!slaveId||!regAddr||!quantity||!registerType||!baudRate||!parity||!scaleFactor){"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Validation Error</strong><br>Please fill in all required fields before testing.</div>';"
-        "return;}"
-        "let data='slave_id='+slaveId+'&register_address='+regAddr+'&quantity='+quantity+'&register_type='+registerType+'&data_type='+dataType+'&baud_rate='+baudRate+'&parity='+parity+'&scale_factor='+scaleFactor;"
-        "data+='&sensor_type='+encodeURIComponent(sensorType);"
-        "const sensorHeightElem=document.getElementById('edit_sensor_height_'+sensorId);"
-        "const maxWaterLevelElem=document.getElementById('edit_max_water_level_'+sensorId);"
-        "if(sensorHeightElem) data+='&sensor_height='+sensorHeightElem.value;"
-        "if(maxWaterLevelElem) data+='&max_water_level='+maxWaterLevelElem.value;"
-        "fetch('/test_rs485',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(r=>r.text()).then(htmlData=>{"
-        "resultDiv.innerHTML=htmlData;"
-        "}).catch(e=>{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\"><strong>ERROR: Communication Error</strong><br>'+e.message+'</div>';"
-        "});"
-        "}"
-        "function writeSingleRegister(){"
-        "const slaveId=document.getElementById('write_single_slave').value;"
-        "const address=document.getElementById('write_single_addr').value;"
-        "const value=document.getElementById('write_single_value').value;"
-        "const resultDiv=document.getElementById('write_single_result');"
-        "if(slaveId===''||address===''||value===''){alert('Please fill all fields');return;}"
-        "if(slaveId<0||slaveId>247){alert('Slave ID must be between 0-247 (0 for broadcast)');return;}"
-        "if(address<0||address>65535){alert('Register address must be between 0-65535');return;}"
-        "if(value<0||value>65535){alert('Value must be between 0-65535');return;}"
-        "resultDiv.style.display='block';"
-        "resultDiv.innerHTML='<div style=\"background:#fff3cd;padding:10px;border-radius:4px;color:#856404\">Writing single register...</div>';"
-        "const data='slave_id='+slaveId+'&register_addr='+address+'&value='+value;"
-        "fetch('/write_single_register',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(response=>response.json()).then(result=>{"
-        "if(result.status==='success'){"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">SUCCESS: Register '+address+' = '+value+' written to slave '+slaveId+'</div>';"
-        "}else{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+result.message+'</div>';"
-        "}"
-        "}).catch(error=>{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+error.message+'</div>';"
-        "});}"
-        "function writeMultipleRegisters(){"
-        "const slaveId=document.getElementById('write_multi_slave').value;"
-        "const startAddr=document.getElementById('write_multi_start').value;"
-        "const valuesText=document.getElementById('write_multi_values').value;"
-        "const resultDiv=document.getElementById('write_multi_result');"
-        "if(slaveId===''||startAddr===''||!valuesText){alert('Please fill all fields');return;}"
-        "if(slaveId<0||slaveId>247){alert('Slave ID must be between 0-247 (0 for broadcast)');return;}"
-        "if(startAddr<0||startAddr>65535){alert('Start register must be between 0-65535');return;}"
-        "const values=valuesText.split(',').map(v=>parseInt(v.trim())).filter(v=>!isNaN(v));"
-        "if(values.length===0){alert('Please enter valid comma-separated values');return;}"
-        "if(values.length>125){alert('Maximum 125 registers can be written at once');return;}"
-        "for(let v of values){if(v<0||v>65535){alert('All values must be between 0-65535');return;}}"
-        "resultDiv.style.display='block';"
-        "resultDiv.innerHTML='<div style=\"background:#fff3cd;padding:10px;border-radius:4px;color:#856404\">Writing '+values.length+' registers...</div>';"
-        "const data='slave_id='+slaveId+'&start_addr='+startAddr+'&values='+values.join(',');"
-        "fetch('/write_multiple_registers',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(response=>response.json()).then(result=>{"
-        "if(result.status==='success'){"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">SUCCESS: '+values.length+' registers written starting at '+startAddr+' on slave '+slaveId+'</div>';"
-        "}else{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+result.message+'</div>';"
-        "}"
-        "}).catch(error=>{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+error.message+'</div>';"
-        "});}"
-        // refreshOtaStatus moved to html_header <script>
-        "function startOtaUpdate(){"
-        "const url=document.getElementById('ota_url').value.trim();"
-        "if(!url){alert('Please enter a firmware URL');return;}"
-        "if(!url.startsWith('http://') && !url.startsWith('https://')){alert('URL must start with http:// or https://');return;}"
-        "if(!confirm('Start OTA update from:\\n'+url+'\\n\\nThe device will download and install the new firmware.')){return;}"
-        "const resultDiv=document.getElementById('ota_result');"
-        "const progressDiv=document.getElementById('ota_progress');"
-        "resultDiv.style.display='block';resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460\">Starting OTA update...</div>';"
-        "progressDiv.style.display='block';"
-        "fetch('/api/ota/start',{method:'POST',headers:{'Content-Type':'application/json'},body:JSON.stringify({url:url})})"
-        ".then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'||data.status==='started'){"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">OTA update started. Please wait...</div>';"
-        "pollOtaProgress();"
-        "}else{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+(data.message||'Failed to start OTA')+'</div>';"
-        "progressDiv.style.display='none';"
-        "}"
-        "}).catch(e=>{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+e.message+'</div>';"
-        "progressDiv.style.display='none';});}"
-        "function pollOtaProgress(){"
-        "const progressBar=document.getElementById('ota_progress_bar');"
-        "const progressText=document.getElementById('ota_progress_text');"
-        "const resultDiv=document.getElementById('ota_result');"
-        "const progressDiv=document.getElementById('ota_progress');"
-        "fetch('/api/ota/status').then(r=>r.json()).then(data=>{"
-        "const pct=data.progress||0;"
-        "progressBar.style.width=pct+'%';progressText.textContent=pct+'%';"
-        "if(data.state==='downloading'||data.state==='installing'||data.state==='checking'||data.state==='verifying'){"
-        "setTimeout(pollOtaProgress,1000);"
-        "}else if(data.state==='pending_reboot'||data.state==='success'){"
-        "progressBar.style.width='100%';progressText.textContent='100%';"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">OTA update completed! Device will reboot automatically or click Reboot Device.</div>';"
-        "}else if(data.state==='failed'){"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">OTA FAILED: '+(data.error||'Unknown error')+'</div>';"
-        "progressDiv.style.display='none';"
-        "}else if(data.state==='idle'||data.state==='rollback'){refreshOtaStatus();}else{setTimeout(pollOtaProgress,1000);}"
-        "}).catch(e=>{setTimeout(pollOtaProgress,2000);});}"
-        "function uploadOtaFile(){"
-        "const fileInput=document.getElementById('ota_file');"
-        "if(!fileInput.files||!fileInput.files[0]){alert('Please select a firmware file');return;}"
-        "const file=fileInput.files[0];"
-        "if(!file.name.endsWith('.bin')){alert('Please select a .bin firmware file');return;}"
-        "if(!confirm('Upload firmware file:\\n'+file.name+' ('+Math.round(file.size/1024)+' KB)\\n\\nProceed with OTA update?')){return;}"
-        "/* Raw binary upload - no FormData */"
-        "const resultDiv=document.getElementById('ota_result');"
-        "const progressDiv=document.getElementById('ota_upload_progress');"
-        "const progressBar=document.getElementById('ota_upload_bar');"
-        "const progressText=document.getElementById('ota_upload_text');"
-        "resultDiv.style.display='block';resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460\">Uploading firmware...</div>';"
-        "progressDiv.style.display='block';"
-        "const xhr=new XMLHttpRequest();"
-        "xhr.upload.onprogress=function(e){if(e.lengthComputable){const pct=Math.round((e.loaded/e.total)*100);progressBar.style.width=pct+'%';progressText.textContent=pct+'%';}};"
-        "xhr.onload=function(){"
-        "if(xhr.status===200){"
-        "const data=JSON.parse(xhr.responseText);"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">Firmware uploaded successfully! Rebooting in 3 seconds...</div>';"
-        "setTimeout(function(){if(confirm('Firmware uploaded! Reboot now to apply update?')){fetch('/api/ota/reboot',{method:'POST'});}},1000);"
-        "}else{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+(data.message||'Upload failed')+'</div>';}"
-        "}else{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">HTTP ERROR: '+xhr.status+'</div>';}"
-        "};"
-        "xhr.onerror=function(){resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">Network error during upload</div>';};"
-        "xhr.open('POST','/api/ota/upload',true);xhr.setRequestHeader('Content-Type','application/octet-stream');xhr.send(file);}"
-        "function confirmOta(){"
-        "if(!confirm('Confirm the current firmware as valid?\\n\\nThis makes the update permanent.')){return;}"
-        "const resultDiv=document.getElementById('ota_result');"
-        "resultDiv.style.display='block';resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460\">Confirming update...</div>';"
-        "fetch('/api/ota/confirm',{method:'POST'}).then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">Firmware confirmed! Update is now permanent.</div>';"
-        "refreshOtaStatus();"
-        "}else{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+(data.message||'Confirm failed')+'</div>';}"
-        "}).catch(e=>{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+e.message+'</div>';});}"
-        "function cancelOta(){"
-        "if(!confirm('Cancel the pending OTA update?')){return;}"
-        "const resultDiv=document.getElementById('ota_result');"
-        "resultDiv.style.display='block';resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460\">Cancelling update...</div>';"
-        "fetch('/api/ota/cancel',{method:'POST'}).then(r=>r.json()).then(data=>{"
-        "if(data.status==='success'){"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">OTA update cancelled.</div>';"
-        "document.getElementById('ota_progress').style.display='none';"
-        "document.getElementById('ota_upload_progress').style.display='none';"
-        "refreshOtaStatus();"
-        "}else{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+(data.message||'Cancel failed')+'</div>';}"
-        "}).catch(e=>{resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+e.message+'</div>';});}"
-        "function rebootDevice(){"
-        "if(!confirm('Reboot the device now?\\n\\nThe device will restart and may take a minute to come back online.')){return;}"
-        "const resultDiv=document.getElementById('ota_result');"
-        "resultDiv.style.display='block';resultDiv.innerHTML='<div style=\"background:#fff3cd;padding:10px;border-radius:4px;color:#856404\">Rebooting device...</div>';"
-        "fetch('/api/ota/reboot',{method:'POST'}).then(r=>r.json()).then(data=>{"
-        "resultDiv.innerHTML='<div style=\"background:#d4edda;padding:10px;border-radius:4px;color:#155724\">Reboot command sent. Device is restarting...</div>';"
-        "setTimeout(function(){location.reload();},30000);"
-        "}).catch(e=>{resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460\">Device is rebooting. Page will refresh shortly...</div>';setTimeout(function(){location.reload();},30000);});}"
-        // showSensorSubMenu moved to html_header <script>
-        "let autoRefreshInterval=null;"
-        "function scanModbusDevices(){"
-        "const startId=parseInt(document.getElementById('scan_start').value);"
-        "const endId=parseInt(document.getElementById('scan_end').value);"
-        "const testRegister=parseInt(document.getElementById('scan_register').value);"
-        "const regType=document.getElementById('scan_reg_type').value;"
-        "const progressDiv=document.getElementById('scan_progress');"
-        "const resultsDiv=document.getElementById('scan_results');"
-        "if(startId<1||startId>247||endId<1||endId>247||startId>endId){"
-        "alert('Invalid slave ID range (1-247)');return;}"
-        "progressDiv.style.display='block';"
-        "progressDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460\">Scanning devices '+startId+'-'+endId+'...</div>';"
-        "resultsDiv.innerHTML='';"
-        "const data='start_id='+startId+'&end_id='+endId+'&test_register='+testRegister+'&reg_type='+regType;"
-        "fetch('/modbus_scan',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(response=>response.json()).then(result=>{"
-        "progressDiv.style.display='none';"
-        "if(result.status==='success'){"
-        "if(result.devices.length===0){"
-        "resultsDiv.innerHTML='<div class=\"sensor-card\"><h3>No Devices Found</h3><p>No responsive Modbus devices found in range '+startId+'-'+endId+'</p></div>';"
-        "}else{"
-        "let html='<div class=\"sensor-card\"><h3>Discovered Devices ('+result.devices.length+')</h3><table style=\"width:100%;border-collapse:collapse\"><thead><tr><th>Slave ID</th><th>Status</th></tr></thead><tbody>';"
-        "result.devices.forEach(dev=>{"
-        "html+='<tr><td>'+dev.slave_id+'</td><td><span style=\"color:#28a745;font-weight:bold\">✓ Responsive</span></td></tr>';"
-        "});"
-        "html+='</tbody></table></div>';"
-        "resultsDiv.innerHTML=html;"
-        "}"
-        "}else{"
-        "resultsDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+result.message+'</div>';"
-        "}"
-        "}).catch(error=>{"
-        "progressDiv.style.display='none';"
-        "resultsDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+error.message+'</div>';"
-        "});}"
-        "function readLiveRegisters(){"
-        "const slaveId=parseInt(document.getElementById('live_slave').value);"
-        "const startRegister=parseInt(document.getElementById('live_register').value);"
-        "const quantity=parseInt(document.getElementById('live_quantity').value);"
-        "const regType=document.getElementById('live_reg_type').value;"
-        "const resultDiv=document.getElementById('live_result');"
-        "if(slaveId<1||slaveId>247){alert('Slave ID must be 1-247');return;}"
-        "if(quantity<1||quantity>10){alert('Quantity must be 1-10');return;}"
-        "const data='slave_id='+slaveId+'&start_register='+startRegister+'&quantity='+quantity+'&reg_type='+regType;"
-        "fetch('/modbus_read_live',{method:'POST',headers:{'Content-Type':'application/x-www-form-urlencoded'},body:data})"
-        ".then(response=>response.json()).then(result=>{"
-        "if(result.status==='success'){"
-        "const f=result.formats;"
-        "let html='<div class=\"sensor-card\"><h3>Register Values</h3>';"
-        "html+='<table class=\"scada-table\"><thead><tr class=\"scada-header-main\"><th colspan=\"2\">Raw Data</th></tr></thead><tbody>';"
-        "html+='<tr><td><strong>Hex String</strong></td><td>'+f.hex_string+'</td></tr></tbody></table>';"
-        "if(f.uint16_be!==undefined){"
-        "html+='<table class=\"scada-table\"><thead><tr class=\"scada-header-uint\"><th colspan=\"2\">16-bit Formats</th></tr></thead><tbody>';"
-        "html+='<tr><td><strong>UINT16 Big Endian</strong></td><td>'+f.uint16_be+'</td></tr>';"
-        "html+='<tr><td><strong>UINT16 Little Endian</strong></td><td>'+f.uint16_le+'</td></tr>';"
-        "html+='<tr><td><strong>INT16 Big Endian</strong></td><td>'+f.int16_be+'</td></tr>';"
-        "html+='<tr><td><strong>INT16 Little Endian</strong></td><td>'+f.int16_le+'</td></tr></tbody></table>';"
-        "}"
-        "if(f.uint32_abcd!==undefined){"
-        "html+='<table class=\"scada-table\"><thead><tr class=\"scada-header-uint\"><th colspan=\"2\">32-bit UINT Formats</th></tr></thead><tbody>';"
-        "html+='<tr><td><strong>UINT32 ABCD</strong></td><td>'+f.uint32_abcd+'</td></tr>';"
-        "html+='<tr><td><strong>UINT32 DCBA</strong></td><td>'+f.uint32_dcba+'</td></tr>';"
-        "html+='<tr><td><strong>UINT32 BADC</strong></td><td>'+f.uint32_badc+'</td></tr>';"
-        "html+='<tr><td><strong>UINT32 CDAB</strong></td><td>'+f.uint32_cdab+'</td></tr></tbody></table>';"
-        "html+='<table class=\"scada-table\"><thead><tr class=\"scada-header-int\"><th colspan=\"2\">32-bit INT Formats</th></tr></thead><tbody>';"
-        "html+='<tr><td><strong>INT32 ABCD</strong></td><td>'+f.int32_abcd+'</td></tr>';"
-        "html+='<tr><td><strong>INT32 DCBA</strong></td><td>'+f.int32_dcba+'</td></tr>';"
-        "html+='<tr><td><strong>INT32 BADC</strong></td><td>'+f.int32_badc+'</td></tr>';"
-        "html+='<tr><td><strong>INT32 CDAB</strong></td><td>'+f.int32_cdab+'</td></tr></tbody></table>';"
-        "html+='<table class=\"scada-table\"><thead><tr class=\"scada-header-float\"><th colspan=\"2\">32-bit FLOAT Formats</th></tr></thead><tbody>';"
-        "html+='<tr><td><strong>FLOAT32 ABCD</strong></td><td>'+f.float32_abcd.toFixed(6)+'</td></tr>';"
-        "html+='<tr><td><strong>FLOAT32 DCBA</strong></td><td>'+f.float32_dcba.toFixed(6)+'</td></tr>';"
-        "html+='<tr><td><strong>FLOAT32 BADC</strong></td><td>'+f.float32_badc.toFixed(6)+'</td></tr>';"
-        "html+='<tr><td><strong>FLOAT32 CDAB</strong></td><td>'+f.float32_cdab.toFixed(6)+'</td></tr></tbody></table>';"
-        "}"
-        "html+='</div>';"
-        "resultDiv.innerHTML=html;"
-        "}else{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+result.message+'</div>';"
-        "}"
-        "}).catch(error=>{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+error.message+'</div>';"
-        "});}"
-        "function toggleAutoRefresh(){"
-        "const btn=document.getElementById('auto_refresh_btn');"
-        "if(autoRefreshInterval){"
-        "clearInterval(autoRefreshInterval);"
-        "autoRefreshInterval=null;"
-        "btn.textContent='Enable Auto-Refresh';"
-        "btn.style.background='var(--color-primary)';"
-        "}else{"
-        "readLiveRegisters();"
-        "autoRefreshInterval=setInterval(readLiveRegisters,2000);"
-        "btn.textContent='Disable Auto-Refresh';"
-        "btn.style.background='var(--color-error)';"
-        "}}"
-        "let modbusPollInterval=null;"
-        "function startModbusPoll(){"
-        "const slaveId=parseInt(document.getElementById('poll_slave').value);"
-        "const startReg=parseInt(document.getElementById('poll_register').value);"
-        "const quantity=parseInt(document.getElementById('poll_quantity').value);"
-        "const regType=document.getElementById('poll_reg_type').value;"
-        "const interval=parseInt(document.getElementById('poll_interval').value);"
-        "const resultDiv=document.getElementById('poll_result');"
-        "const startBtn=document.getElementById('start_poll_btn');"
-        "const stopBtn=document.getElementById('stop_poll_btn');"
-        "if(slaveId<1||slaveId>247||startReg<0||startReg>65535||quantity<1||quantity>20){"
-        "alert('Invalid parameters');return;}"
-        "startBtn.style.display='none';"
-        "stopBtn.style.display='block';"
-        "resultDiv.style.display='block';"
-        "resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460;margin-bottom:10px\">● Polling Slave '+slaveId+', Reg '+startReg+'-'+(startReg+quantity-1)+' ('+regType+') every '+(interval/1000)+'s</div>';"
-        "const pollFunc=()=>{"
-        "fetch('/api/modbus_poll?slave='+slaveId+'&reg='+startReg+'&qty='+quantity+'&type='+regType)"
-        ".then(r=>r.json())"
-        ".then(data=>{"
-        "if(data.status==='success'){"
-        "let html='<table style=\"width:100%;border-collapse:collapse;background:white;border:1px solid #dee2e6\">';"
-        "html+='<thead><tr style=\"background:#28a745;color:white\"><th style=\"padding:8px;text-align:left\">Register</th><th style=\"padding:8px;text-align:right\">Value (Dec)</th><th style=\"padding:8px;text-align:right\">Value (Hex)</th></tr></thead><tbody>';"
-        "for(let i=0;i<data.values.length;i++){"
-        "html+='<tr style=\"border-bottom:1px solid #dee2e6\"><td style=\"padding:6px;font-weight:bold\">'+(startReg+i)+'</td><td style=\"padding:6px;text-align:right;font-family:monospace\">'+data.values[i]+'</td><td style=\"padding:6px;text-align:right;font-family:monospace;color:#007bff\">0x'+data.values[i].toString(16).toUpperCase().padStart(4,'0')+'</td></tr>';"
-        "}"
-        "html+='</tbody></table>';"
-        "html+='<div style=\"margin-top:8px;font-size:12px;color:#6c757d\">Last update: '+new Date().toLocaleTimeString()+'</div>';"
-        "resultDiv.innerHTML='<div style=\"background:#d1ecf1;padding:10px;border-radius:4px;color:#0c5460;margin-bottom:10px\">● Polling Active - Slave '+slaveId+', Reg '+startReg+'-'+(startReg+quantity-1)+'</div>'+html;"
-        "}else{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">ERROR: '+data.message+'</div>';"
-        "}"
-        "}).catch(err=>{"
-        "resultDiv.innerHTML='<div style=\"background:#f8d7da;padding:10px;border-radius:4px;color:#721c24\">NETWORK ERROR: '+err.message+'</div>';"
-        "});"
-        "};"
-        "pollFunc();"
-        "modbusPollInterval=setInterval(pollFunc,interval);"
-        "}"
-        "function stopModbusPoll(){"
-        "if(modbusPollInterval){"
-        "clearInterval(modbusPollInterval);"
-        "modbusPollInterval=null;}"
-        "document.getElementById('start_poll_btn').style.display='block';"
-        "document.getElementById('stop_poll_btn').style.display='none';"
-        "document.getElementById('poll_result').innerHTML='<div style=\"background:#fff3cd;padding:10px;border-radius:4px;color:#856404\">Polling stopped</div>';"
-        "}"
-        "console.log('Script loaded successfully. addSensor function defined:', typeof addSensor);"
-        "</script>");
-    
-
-    // Write Operations section
-    if (!connection_alive) goto page_done;
-    SEND_OR_ABORT(req,
-        "<div id='write_ops' class='section'>"
-        "<h2 class='section-title'><i>✏️</i>Write Operations</h2>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Write Single Register (Function Code 06)</h3>"
-        "<p>Write a single value to a Modbus holding register for device control and configuration.</p>"
-    );
-    
-    // Write single register form
-    httpd_resp_sendstr_chunk(req,
-        "<div class='form-grid'>"
-        "<label>Slave ID:</label>"
-        "<input type='number' id='write_single_slave' min='0' max='247' value='1'>"
-        "<label>Register Address:</label>"
-        "<input type='number' id='write_single_addr' min='0' max='65535' value='0'>"
-        "<label>Value (decimal):</label>"
-        "<input type='number' id='write_single_value' min='0' max='65535' value='0'>"
-        "</div>"
-        "<button onclick='writeSingleRegister()' class='btn' style='background:var(--color-primary);color:white;width:auto;min-width:200px'>Write Single Register</button>"
-        "<div id='write_single_result' style='margin-top:var(--space-md);padding:var(--space-md);background:var(--color-bg-secondary);border-radius:var(--radius-md);display:none'></div>"
-        "</div>"
-    );
-    
-    // Write multiple registers section
-    httpd_resp_sendstr_chunk(req,
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Write Multiple Registers (Function Code 16)</h3>"
-        "<p>Write multiple consecutive values to Modbus holding registers for bulk configuration.</p>"
-        "<div class='form-grid'>"
-        "<label>Slave ID:</label>"
-        "<input type='number' id='write_multi_slave' min='0' max='247' value='1'>"
-        "<label>Start Register:</label>"
-        "<input type='number' id='write_multi_start' min='0' max='65535' value='0'>"
-        "<label>Values (comma-separated):</label>"
-        "<textarea id='write_multi_values' placeholder='Example: 1000,2000,3000' rows='3'></textarea>"
-        "</div>"
-        "<button onclick='writeMultipleRegisters()' class='btn' style='background:var(--color-success);color:white;width:auto;min-width:200px'>Write Multiple Registers</button>"
-        "<div id='write_multi_result' style='margin-top:var(--space-md);padding:var(--space-md);background:var(--color-bg-secondary);border-radius:var(--radius-md);display:none'></div>"
-        "</div>"
-    );
-    
-    // Write operations notes and monitoring section
-    httpd_resp_sendstr_chunk(req,
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Write Operation Notes</h3>"
-        "<ul style='margin:10px 0;padding-left:20px'>"
-        "<li><strong>Function Code 06:</strong> Write Single Register - For individual register writes</li>"
-        "<li><strong>Function Code 16:</strong> Write Multiple Registers - For bulk register writes (more efficient)</li>"
-        "<li><strong>Slave ID 0:</strong> Broadcast mode - sends command to all devices (no response expected)</li>"
-        "<li><strong>Holding Registers:</strong> Read/Write registers used for device configuration and control</li>"
-        "<li><strong>Values:</strong> All values are 16-bit unsigned integers (0-65535)</li>"
-        "<li><strong>Industrial Safety:</strong> Verify register addresses and values before writing to avoid equipment damage</li>"
-        "</ul>"
-        "</div>"
-        "</div>"
-    );
+    }
+    httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No such section");
+    return ESP_OK;
+}
 
-    // OTA Update section
-    if (!connection_alive) goto page_done;
-    SEND_OR_ABORT(req,
-        "<div id='ota' class='section'>"
-        "<h2 class='section-title'><i>⬆️</i>OTA Firmware Update</h2>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Current Firmware Status</h3>"
-        "<p><strong>Version:</strong> <span id='ota_current_version'>Loading...</span></p>"
-        "<p><strong>Partition:</strong> <span id='ota_current_partition'>Loading...</span></p>"
-        "<p><strong>OTA Status:</strong> <span id='ota_status'>Loading...</span></p>"
-        "<p><strong>Last Update:</strong> <span id='ota_last_update'>Never</span></p>"
-        "<button onclick='refreshOtaStatus()' class='btn' style='background:var(--color-secondary);color:white;width:auto;min-width:150px;margin-top:10px'>Refresh Status</button>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Update from URL</h3>"
-        "<p>Enter the URL to a firmware binary (.bin) file hosted on a web server.</p>"
-        "<div class='form-grid'>"
-        "<label>Firmware URL:</label>"
-        "<input type='text' id='ota_url' placeholder='https://example.com/firmware.bin' style='width:100%'>"
-        "</div>"
-        "<button onclick='startOtaUpdate()' class='btn' style='background:var(--color-primary);color:white;width:auto;min-width:200px;margin-top:10px'>Start OTA Update</button>"
-        "<div id='ota_progress' style='margin-top:15px;display:none'>"
-        "<div style='background:#e0e0e0;border-radius:10px;height:20px;overflow:hidden'>"
-        "<div id='ota_progress_bar' style='background:var(--color-primary);height:100%;width:0%;transition:width 0.3s'></div>"
-        "</div>"
-        "<p id='ota_progress_text' style='text-align:center;margin-top:5px'>0%</p>"
-        "</div>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Upload Firmware File</h3>"
-        "<p>Upload a firmware binary (.bin) file directly from your computer.</p>"
-        "<input type='file' id='ota_file' accept='.bin' style='margin:10px 0'>"
-        "<br>"
-        "<button onclick='uploadOtaFile()' class='btn' style='background:var(--color-success);color:white;width:auto;min-width:200px'>Upload Firmware</button>"
-        "<div id='ota_upload_progress' style='margin-top:15px;display:none'>"
-        "<div style='background:#e0e0e0;border-radius:10px;height:20px;overflow:hidden'>"
-        "<div id='ota_upload_bar' style='background:var(--color-success);height:100%;width:0%;transition:width 0.3s'></div>"
-        "</div>"
-        "<p id='ota_upload_text' style='text-align:center;margin-top:5px'>0%</p>"
-        "</div>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>OTA Controls</h3>"
-        "<p>After successful update, you must confirm the new firmware or it will rollback on next reboot.</p>"
-        "<div style='display:flex;gap:10px;flex-wrap:wrap'>"
-        "<button onclick='confirmOta()' class='btn' style='background:var(--color-success);color:white;width:auto;min-width:150px'>Confirm Update</button>"
-        "<button onclick='cancelOta()' class='btn' style='background:var(--color-warning);color:white;width:auto;min-width:150px'>Cancel Update</button>"
-        "<button onclick='rebootDevice()' class='btn' style='background:var(--color-danger);color:white;width:auto;min-width:150px'>Reboot Device</button>"
-        "</div>"
-        "<div id='ota_result' style='margin-top:15px;padding:15px;background:var(--color-bg-secondary);border-radius:var(--radius-md);display:none'></div>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>OTA Update Notes</h3>"
-        "<ul style='margin:10px 0;padding-left:20px'>"
-        "<li><strong>Dual Partition:</strong> ESP32 uses A/B partitioning - updates are written to inactive partition</li>"
-        "<li><strong>Rollback:</strong> If new firmware fails, device automatically rolls back to previous version</li>"
-        "<li><strong>Confirm Required:</strong> You must confirm the update after successful boot to make it permanent</li>"
-        "<li><strong>HTTPS Recommended:</strong> Use HTTPS URLs for secure firmware downloads</li>"
-        "<li><strong>Backup:</strong> Always test new firmware thoroughly before deploying to production</li>"
-        "</ul>"
-        "</div>"
-        "</div>"
-    );
+// Floats as the user typed them (0.1, not 0.10000000149011612)
+static double json_float(float value)
+{
+    return round((double)value * 1e6) / 1e6;
+}
 
-    // Modbus Explorer section
-    snprintf(chunk, sizeof(chunk),
-        "<div id='monitoring' class='section'>"
-        "<h2 class='section-title'><i>🖥️</i>System Monitor</h2>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>RS485 Configuration</h3>"
-        "<p><strong>RX Pin:</strong> <span>GPIO16</span></p>"
-        "<p><strong>TX Pin:</strong> <span>GPIO17</span></p>"
-        "<p><strong>RTS Pin:</strong> <span>GPIO4</span></p>"
-        "<p><strong>Baud Rate:</strong> <span>9600</span></p>"
-        "<p><strong>Parity:</strong> <span>None</span></p>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>System Status</h3>"
-        "<p><strong>Firmware:</strong> <span>v1.1.0-final</span></p>"
-        "<p><strong>MAC Address:</strong> <span id='mac_address'>Loading...</span></p>"
-        "<p><strong>Uptime:</strong> <span id='uptime'>Loading...</span></p>"
-        "<p><strong>Flash Memory:</strong> <span id='flash_total'>Loading...</span></p>"
-        "<p><strong>Active Tasks:</strong> <span id='tasks'>Loading...</span></p>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Memory Usage</h3>"
-        "<p><strong>Heap Usage:</strong> <span id='heap_usage'>Loading...</span></p>"
-        "<p><strong>Free Heap:</strong> <span id='heap'>Loading...</span></p>"
-        "<p><strong>Internal RAM:</strong> <span id='internal_heap'>Loading...</span></p>"
-        "<p><strong>SPIRAM:</strong> <span id='spiram_heap'>Loading...</span></p>"
-        "<p><strong>Largest Block:</strong> <span id='largest_block'>Loading...</span></p>"
-        "</div>"
-        ""
-        "<div class='sensor-card' id='wifi-network-status' style='display:%s'>"
-        "<h3>WiFi Network Status</h3>"
-        "<p><strong>WiFi Status:</strong> <span id='wifi_status'>Loading...</span></p>"
-        "<p><strong>WiFi RSSI:</strong> <span id='rssi'>Loading...</span></p>"
-        "<p><strong>SSID:</strong> <span id='ssid'>Loading...</span></p>"
-        "</div>"
-        ""
-        "<div class='sensor-card' id='sim-network-status' style='display:%s'>"
-        "<h3>SIM Network Status</h3>"
-        "<p><strong>SIM Status:</strong> <span id='sim_status'>Loading...</span></p>"
-        "<p><strong>Signal Quality:</strong> <span id='sim_signal'>Loading...</span></p>"
-        "<p><strong>Network:</strong> <span id='sim_network'>Loading...</span></p>"
-        "<p><strong>IP Address:</strong> <span id='sim_ip'>Loading...</span></p>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Modbus Communication</h3>"
-        "<p><strong>Total Reads:</strong> <span id='modbus_total_reads'>Loading...</span></p>"
-        "<p><strong>Successful:</strong> <span id='modbus_success'>Loading...</span></p>"
-        "<p><strong>Failed:</strong> <span id='modbus_failed'>Loading...</span></p>"
-        "<p><strong>Success Rate:</strong> <span id='modbus_success_rate'>Loading...</span></p>"
-        "<p><strong>CRC Errors:</strong> <span id='modbus_crc_errors'>Loading...</span></p>"
-        "<p><strong>Timeout Errors:</strong> <span id='modbus_timeout_errors'>Loading...</span></p>"
-        "</div>"
-        ""
-        "<div class='sensor-card'>"
-        "<h3>Azure IoT Hub</h3>"
-        "<p><strong>Connection:</strong> <span id='azure_connection'>Loading...</span></p>"
-        "<p><strong>Uptime:</strong> <span id='azure_uptime'>Loading...</span></p>"
-        "<p><strong>Messages Sent:</strong> <span id='azure_messages'>Loading...</span></p>"
-        "<p><strong>Last Telemetry:</strong> <span id='azure_last_telemetry'>Loading...</span></p>"
-        "<p><strong>Reconnects:</strong> <span id='azure_reconnects'>Loading...</span></p>"
-        "<p><strong>Device ID:</strong> <span id='azure_device_id'>Loading...</span></p>"
-        "</div>"
-        "</div>",
-        g_system_config.network_mode == 0 ? "block" : "none",
-        g_system_config.network_mode == 1 ? "block" : "none");
-    httpd_resp_sendstr_chunk(req, chunk);
-    
-page_done:
-    // Send HTML footer and end chunked transfer
-    httpd_resp_sendstr_chunk(req, html_footer);
-    httpd_resp_sendstr_chunk(req, NULL);
+// Current configuration for the portal - app.js fills the form fields from this.
+// Under memory pressure the sub-sensor lists are left out ("degraded":true) and
+// the page asks again a few seconds later.
+static esp_err_t api_config_handler(httpd_req_t *req)
+{
+    bool degraded = web_admission_degraded(req);
+    cJSON *root = cJSON_CreateObject();
+    if (!root) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    if (degraded) {
+        cJSON_AddBoolToObject(root, "degraded", true);
+    }
+
+    // Keys are the form field names
+    cJSON *fields = cJSON_AddObjectToObject(root, "fields");
+    cJSON_AddNumberToObject(fields, "network_mode", g_system_config.network_mode);
+    cJSON_AddStringToObject(fields, "wifi_ssid", g_system_config.wifi_ssid);
+    cJSON_AddStringToObject(fields, "wifi_password", g_system_config.wifi_password);
+    cJSON_AddStringToObject(fields, "sim_apn", g_system_config.sim_config.apn);
+    cJSON_AddStringToObject(fields, "sim_apn_user", g_system_config.sim_config.apn_user);
+    cJSON_AddStringToObject(fields, "sim_apn_pass", g_system_config.sim_config.apn_pass);
+    cJSON_AddNumberToObject(fields, "sim_uart", g_system_config.sim_config.uart_num);
+    cJSON_AddNumberToObject(fields, "sim_tx_pin", g_system_config.sim_config.uart_tx_pin);
+    cJSON_AddNumberToObject(fields, "sim_rx_pin", g_system_config.sim_config.uart_rx_pin);
+    cJSON_AddNumberToObject(fields, "sim_pwr_pin", g_system_config.sim_config.pwr_pin);
+    cJSON_AddNumberToObject(fields, "sim_reset_pin", g_system_config.sim_config.reset_pin);
+    cJSON_AddNumberToObject(fields, "sim_baud", g_system_config.sim_config.uart_baud_rate);
+    cJSON_AddNumberToObject(fields, "sim_rts_pin", g_system_config.modem_rts_pin);
+    cJSON_AddNumberToObject(fields, "sim_cts_pin", g_system_config.modem_cts_pin);
+    cJSON_AddNumberToObject(fields, "sim_ppp_baud", g_system_config.modem_ppp_baud);
+    cJSON_AddBoolToObject(fields, "sd_enabled", g_system_config.sd_config.enabled);
+    cJSON_AddBoolToObject(fields, "sd_cache_on_failure", g_system_config.sd_config.cache_on_failure);
+    cJSON_AddNumberToObject(fields, "sd_mosi", g_system_config.sd_config.mosi_pin);
+    cJSON_AddNumberToObject(fields, "sd_miso", g_system_config.sd_config.miso_pin);
+    cJSON_AddNumberToObject(fields, "sd_clk", g_system_config.sd_config.clk_pin);
+    cJSON_AddNumberToObject(fields, "sd_cs", g_system_config.sd_config.cs_pin);
+    cJSON_AddNumberToObject(fields, "sd_spi_host", g_system_config.sd_config.spi_host);
+    cJSON_AddBoolToObject(fields, "rtc_enabled", g_system_config.rtc_config.enabled);
+    cJSON_AddBoolToObject(fields, "rtc_sync_on_boot", g_system_config.rtc_config.sync_on_boot);
+    cJSON_AddBoolToObject(fields, "rtc_update_from_ntp", g_system_config.rtc_config.update_from_ntp);
+    cJSON_AddNumberToObject(fields, "rtc_sda", g_system_config.rtc_config.sda_pin);
+    cJSON_AddNumberToObject(fields, "rtc_scl", g_system_config.rtc_config.scl_pin);
+    cJSON_AddNumberToObject(fields, "rtc_i2c_num", g_system_config.rtc_config.i2c_num);
+    cJSON_AddNumberToObject(fields, "trigger_gpio_pin",
+                            g_system_config.trigger_gpio_pin > 0 ? g_system_config.trigger_gpio_pin : 34);
+    cJSON_AddBoolToObject(fields, "modem_reset_enabled", g_system_config.modem_reset_enabled);
+    cJSON_AddNumberToObject(fields, "modem_reset_gpio_pin",
+                            g_system_config.modem_reset_gpio_pin > 0 ? g_system_config.modem_reset_gpio_pin : 2);
+    cJSON_AddNumberToObject(fields, "modem_boot_delay",
+                            g_system_config.modem_boot_delay > 0 ? g_system_config.modem_boot_delay : 15);
+    cJSON_AddStringToObject(fields, "azure_hub_fqdn", IOT_CONFIG_IOTHUB_FQDN);
+    cJSON_AddStringToObject(fields, "azure_device_id", g_system_config.azure_device_id);
+    cJSON_AddStringToObject(fields, "azure_device_key", g_system_config.azure_device_key);
+    cJSON_AddNumberToObject(fields, "telemetry_interval", g_system_config.telemetry_interval);
+    cJSON_AddBoolToObject(fields, "batch_telemetry", g_system_config.batch_telemetry);
+    cJSON_AddStringToObject(fields, "telemetry_encoding",
+                            g_system_config.telemetry_encoding == TELEMETRY_ENCODING_CBOR ? "cbor" : "json");
+    cJSON_AddNumberToObject(fields, "telemetry_max_batch", g_system_config.telemetry_max_batch);
+    cJSON_AddBoolToObject(fields, "telemetry_route_by_type", g_system_config.telemetry_route_by_type);
+    cJSON_AddNumberToObject(fields, "modbus_retry_count", g_system_config.modbus_retry_count);
+    cJSON_AddNumberToObject(fields, "modbus_retry_delay", g_system_config.modbus_retry_delay);
+
+    cJSON *sensors = cJSON_AddArrayToObject(root, "sensors");
+    for (int i = 0; i < g_system_config.sensor_count; i++) {
+        const sensor_config_t *s = &g_system_config.sensors[i];
+        cJSON *item = cJSON_CreateObject();
+        cJSON_AddItemToArray(sensors, item);
+        cJSON_AddBoolToObject(item, "enabled", s->enabled);
+        cJSON_AddStringToObject(item, "name", s->name);
+        cJSON_AddStringToObject(item, "unit_id", s->unit_id);
+        cJSON_AddStringToObject(item, "sensor_type", s->sensor_type);
+        cJSON_AddNumberToObject(item, "slave_id", s->slave_id);
+        cJSON_AddNumberToObject(item, "baud_rate", s->baud_rate);
+        cJSON_AddStringToObject(item, "parity", s->parity);
+        cJSON_AddNumberToObject(item, "register_address", s->register_address);
+        cJSON_AddNumberToObject(item, "quantity", s->quantity);
+        cJSON_AddStringToObject(item, "data_type", s->data_type);
+        cJSON_AddStringToObject(item, "register_type", s->register_type);
+        cJSON_AddNumberToObject(item, "scale_factor", json_float(s->scale_factor));
+        cJSON_AddNumberToObject(item, "sensor_height", json_float(s->sensor_height));
+        cJSON_AddNumberToObject(item, "max_water_level", json_float(s->max_water_level));
+        cJSON_AddStringToObject(item, "meter_type", s->meter_type);
+        cJSON_AddNumberToObject(item, "sub_sensor_count", s->sub_sensor_count);
+        if (degraded) {
+            continue;
+        }
+
+        cJSON *subs = cJSON_AddArrayToObject(item, "sub_sensors");
+        for (int j = 0; j < s->sub_sensor_count && j < 8; j++) {
+            const sub_sensor_t *sub = &s->sub_sensors[j];
+            cJSON *sub_item = cJSON_CreateObject();
+            cJSON_AddItemToArray(subs, sub_item);
+            cJSON_AddBoolToObject(sub_item, "enabled", sub->enabled);
+            cJSON_AddStringToObject(sub_item, "parameter_name", sub->parameter_name);
+            cJSON_AddNumberToObject(sub_item, "slave_id", sub->slave_id);
+            cJSON_AddNumberToObject(sub_item, "register_address", sub->register_address);
+            cJSON_AddNumberToObject(sub_item, "quantity", sub->quantity);
+            cJSON_AddStringToObject(sub_item, "data_type", sub->data_type);
+            cJSON_AddNumberToObject(sub_item, "scale_factor", json_float(sub->scale_factor));
+            cJSON_AddStringToObject(sub_item, "register_type", sub->register_type);
+        }
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!json) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
 
-    #undef SEND_OR_ABORT
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_sendstr(req, json);
+    free(json);
     return ESP_OK;
 }
 
@@ -5350,57 +1580,102 @@ static void url_decode(char *dst, const char *src) {
     *dst = '\0';
 }
 
-// Parse form parameter
-static void parse_form_param(const char *param, const char *value) {
-    char decoded_value[256];
-    url_decode(decoded_value, value);
-    
-    ESP_LOGI(TAG, "Parsing: %s = %s", param, decoded_value);
-    
-    if (strcmp(param, "wifi_ssid") == 0) {
-        strncpy(g_system_config.wifi_ssid, decoded_value, sizeof(g_system_config.wifi_ssid) - 1);
-    } else if (strcmp(param, "wifi_password") == 0) {
-        strncpy(g_system_config.wifi_password, decoded_value, sizeof(g_system_config.wifi_password) - 1);
-    } else if (strcmp(param, "telemetry_interval") == 0) {
-        g_system_config.telemetry_interval = atoi(decoded_value);
-    } else if (strncmp(param, "sensor_", 7) == 0) {
-        // Parse sensor parameters
-        int sensor_idx = atoi(param + 7);
-        if (sensor_idx >= 0 && sensor_idx < 10) {  // Max 10 sensors
-            char *param_type = strchr(param + 7, '_');
-            if (param_type) {
-                param_type++; // Skip the underscore
-                
-                if (strcmp(param_type, "name") == 0) {
-                    strncpy(g_system_config.sensors[sensor_idx].name, decoded_value, sizeof(g_system_config.sensors[sensor_idx].name) - 1);
-                    g_system_config.sensors[sensor_idx].enabled = true;
-                    // Initialize default data_type if not already set
-                    if (strlen(g_system_config.sensors[sensor_idx].data_type) == 0) {
-                        strcpy(g_system_config.sensors[sensor_idx].data_type, "UINT16_HI");
-                        ESP_LOGI(TAG, "Set default data_type to UINT16_HI for new sensor %d", sensor_idx);
-                    }
-                    // Update sensor count if this is a new sensor
-                    if (sensor_idx >= g_system_config.sensor_count) {
-                        g_system_config.sensor_count = sensor_idx + 1;
-                    }
-                } else if (strcmp(param_type, "unit_id") == 0) {
-                    strncpy(g_system_config.sensors[sensor_idx].unit_id, decoded_value, sizeof(g_system_config.sensors[sensor_idx].unit_id) - 1);
-                } else if (strcmp(param_type, "slave_id") == 0) {
-                    g_system_config.sensors[sensor_idx].slave_id = atoi(decoded_value);
-                } else if (strcmp(param_type, "register_address") == 0) {
-                    g_system_config.sensors[sensor_idx].register_address = atoi(decoded_value);
-                } else if (strcmp(param_type, "quantity") == 0) {
-                    g_system_config.sensors[sensor_idx].quantity = atoi(decoded_value);
-                } else if (strcmp(param_type, "data_type") == 0) {
-                    strncpy(g_system_config.sensors[sensor_idx].data_type, decoded_value, sizeof(g_system_config.sensors[sensor_idx].data_type) - 1);
-                } else if (strcmp(param_type, "baud_rate") == 0) {
-                    g_system_config.sensors[sensor_idx].baud_rate = atoi(decoded_value);
-                }
-            }
+// Streams the request body through body_parser in BODY_CHUNK_SIZE pieces, so
+// a form is bounded by BODY_MAX_LEN instead of a stack buffer. JSON when the
+// Content-Type says so, form-urlencoded otherwise.
+static esp_err_t parse_request_body(httpd_req_t *req, const body_table_t *table, void *ctx, body_stats_t *stats)
+{
+    if (req->content_len > BODY_MAX_LEN) {
+        ESP_LOGW(TAG, "Request body too large: %d bytes (max %d)", (int)req->content_len, BODY_MAX_LEN);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    char content_type[48] = "";
+    httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type));
+    body_parser_t parser;
+    body_parser_init(&parser, strstr(content_type, "json") ? BODY_FORMAT_JSON : BODY_FORMAT_FORM, table, ctx);
+
+    char chunk[BODY_CHUNK_SIZE];
+    size_t remaining = req->content_len;
+    int timeouts = 0;
+    while (remaining > 0) {
+        int ret = httpd_req_recv(req, chunk, MIN(remaining, sizeof(chunk)));
+        if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < 3) {
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Request body receive failed (%d), %d bytes missing", ret, (int)remaining);
+            return ESP_FAIL;
         }
+        body_parser_feed(&parser, chunk, ret);
+        remaining -= ret;
+    }
+
+    bool complete = body_parser_finish(&parser);
+    if (stats) {
+        *stats = parser.stats;
+    }
+    if (parser.stats.truncated) {
+        ESP_LOGW(TAG, "%u request field(s) longer than %d bytes ignored", parser.stats.truncated, BODY_VALUE_MAX - 1);
     }
+    if (!complete) {
+        ESP_LOGW(TAG, "Malformed JSON request body");
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
 }
 
+// Record for a config form key: system_config_t, sensors[#] or sensors[#].sub_sensors[#]
+static void *config_body_record(void *ctx, const int *idx, int n_idx)
+{
+    system_config_t *config = (system_config_t *)ctx;
+    if (n_idx == 0) {
+        return config;
+    }
+    if (idx[0] >= (int)(sizeof(config->sensors) / sizeof(config->sensors[0]))) {
+        return NULL;
+    }
+    if (n_idx == 1) {
+        return &config->sensors[idx[0]];
+    }
+    if (idx[1] >= (int)(sizeof(config->sensors[0].sub_sensors) / sizeof(config->sensors[0].sub_sensors[0]))) {
+        return NULL;
+    }
+    return &config->sensors[idx[0]].sub_sensors[idx[1]];
+}
+
+// A named sensor slot is in use; extend sensor_count to cover it
+static void config_sensor_named(void *record, const int *idx, const char *value, void *ctx)
+{
+    sensor_config_t *sensor = (sensor_config_t *)record;
+    system_config_t *config = (system_config_t *)ctx;
+    sensor->enabled = true;
+    if (strlen(sensor->data_type) == 0) {
+        strcpy(sensor->data_type, "UINT16_HI");
+        ESP_LOGI(TAG, "Set default data_type to UINT16_HI for new sensor %d", idx[0]);
+    }
+    if (idx[0] >= config->sensor_count) {
+        config->sensor_count = idx[0] + 1;
+    }
+}
+
+// /save_config form fields
+static const body_field_t config_form_fields[] = {
+    BODY_FIELD("wifi_ssid", BODY_STR, system_config_t, wifi_ssid, NULL),
+    BODY_FIELD("wifi_password", BODY_STR, system_config_t, wifi_password, NULL),
+    BODY_FIELD("telemetry_interval", BODY_INT, system_config_t, telemetry_interval, NULL),
+    BODY_FIELD("sensor_#_name", BODY_STR, sensor_config_t, name, config_sensor_named),
+    BODY_FIELD("sensor_#_unit_id", BODY_STR, sensor_config_t, unit_id, NULL),
+    BODY_FIELD("sensor_#_slave_id", BODY_INT, sensor_config_t, slave_id, NULL),
+    BODY_FIELD("sensor_#_register_address", BODY_INT, sensor_config_t, register_address, NULL),
+    BODY_FIELD("sensor_#_quantity", BODY_INT, sensor_config_t, quantity, NULL),
+    BODY_FIELD("sensor_#_data_type", BODY_STR, sensor_config_t, data_type, NULL),
+    BODY_FIELD("sensor_#_baud_rate", BODY_INT, sensor_config_t, baud_rate, NULL),
+};
+static const body_table_t config_form_table = {
+    config_form_fields, sizeof(config_form_fields) / sizeof(config_form_fields[0]), config_body_record
+};
+
 // Save Azure configuration handler
 static esp_err_t save_azure_config_handler(httpd_req_t *req)
 {
@@ -5438,6 +1713,21 @@ static esp_err_t save_azure_config_handler(httpd_req_t *req)
         } else if (strncmp(param, "batch_telemetry=", 16) == 0) {
             g_system_config.batch_telemetry = (atoi(param + 16) == 1);
             ESP_LOGI(TAG, "Batch telemetry: %s", g_system_config.batch_telemetry ? "enabled" : "disabled");
+        } else if (strncmp(param, "telemetry_encoding=", 19) == 0) {
+            telemetry_encoding_t encoding;
+            if (telemetry_encoding_from_name(param + 19, &encoding)) {
+                g_system_config.telemetry_encoding = encoding;
+                ESP_LOGI(TAG, "Telemetry encoding: %s", telemetry_encoding_name(encoding));
+            }
+        } else if (strncmp(param, "telemetry_max_batch=", 20) == 0) {
+            int max_batch = atoi(param + 20);
+            if (max_batch >= 1 && max_batch <= 10) {
+                g_system_config.telemetry_max_batch = max_batch;
+                ESP_LOGI(TAG, "Max sensors per message: %d", max_batch);
+            }
+        } else if (strncmp(param, "telemetry_route_by_type=", 24) == 0) {
+            g_system_config.telemetry_route_by_type = (atoi(param + 24) == 1);
+            ESP_LOGI(TAG, "Batch per sensor type: %s", g_system_config.telemetry_route_by_type ? "enabled" : "disabled");
         } else if (strncmp(param, "modbus_retry_count=", 19) == 0) {
             int retry_count = atoi(param + 19);
             if (retry_count >= 0 && retry_count <= 3) {
@@ -5598,42 +1888,16 @@ static esp_err_t save_system_config_handler(httpd_req_t *req)
 // Save configuration handler
 static esp_err_t save_config_handler(httpd_req_t *req)
 {
-    char buf[4096];
     bool attempt_wifi_connection = false;  // Flag to attempt WiFi connection after HTTP response
-    
-    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (ret <= 0) {
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
-    }
-    buf[ret] = '\0';
 
-    ESP_LOGI(TAG, "Received configuration data: %s", buf);
-    
-    // Parse form data
-    char *param_start = buf;
-    while (param_start) {
-        char *param_end = strchr(param_start, '&');
-        if (param_end) {
-            *param_end = '\0';
-        }
-        
-        char *equals = strchr(param_start, '=');
-        if (equals) {
-            *equals = '\0';
-            char *param_name = param_start;
-            char *param_value = equals + 1;
-            
-            parse_form_param(param_name, param_value);
-        }
-        
-        if (param_end) {
-            param_start = param_end + 1;
-        } else {
-            break;
-        }
+    body_stats_t body_stats;
+    if (req->content_len == 0 ||
+        parse_request_body(req, &config_form_table, &g_system_config, &body_stats) != ESP_OK) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
     }
-    
+    ESP_LOGI(TAG, "Received configuration: %u fields, %u unknown", body_stats.fields, body_stats.unknown);
+
     // Save configuration to NVS
     esp_err_t err = config_save_to_nvs(&g_system_config);
     if (err != ESP_OK) {
@@ -5653,19 +1917,19 @@ static esp_err_t save_config_handler(httpd_req_t *req)
     // Send success response using chunked response
     httpd_resp_set_type(req, "text/html; charset=UTF-8");
 
-    // Send HTML header in small chunks (same pattern as config_page_handler)
+    // Page header - same stylesheet URL as the portal, so it comes from the browser cache
     {
-        const char *ptr = (const char *)index_html_start;
-        size_t remaining = (size_t)(index_html_end - index_html_start);
-        while (remaining > 0) {
-            size_t send_len = remaining > 4096 ? 4096 : remaining;
-            if (httpd_resp_send_chunk(req, ptr, send_len) != ESP_OK) {
-                ESP_LOGE(TAG, "Failed to send header in save response (remaining: %d bytes)", (int)remaining);
-                httpd_resp_sendstr_chunk(req, NULL);
-                return ESP_OK;
-            }
-            ptr += send_len;
-            remaining -= send_len;
+        char page_header[384];
+        snprintf(page_header, sizeof(page_header),
+            "<!DOCTYPE html><html><head><meta charset=UTF-8><title>FLUXGEN IoT Gateway</title>"
+            "<meta name=viewport content='width=device-width,initial-scale=1'>"
+            "<link rel='stylesheet' href='/styles.css?v=%.8s'>"
+            "</head><body><div class='container'><div class='main-content'>",
+            web_asset_etag(&g_web_assets[WEB_ASSET_STYLES]) + 1);
+        if (httpd_resp_sendstr_chunk(req, page_header) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to send header in save response");
+            httpd_resp_sendstr_chunk(req, NULL);
+            return ESP_OK;
         }
     }
 
@@ -6724,254 +2988,170 @@ static esp_err_t test_sensor_handler(httpd_req_t *req)
     }
 }
 
+// /save_single_sensor state: the edited slot and the required fields seen
+typedef struct {
+    system_config_t *config;
+    int sensor_id;
+    bool has_name;
+    bool has_unit_id;
+} single_sensor_form_t;
+
+// Like config_body_record(), plus: the first sensor index is the edited one, and
+// sub-sensor fields only apply to QUALITY sensors, enabling the sub-sensor with
+// defaults the first time one of its fields arrives
+static void *single_sensor_record(void *ctx, const int *idx, int n_idx)
+{
+    single_sensor_form_t *form = (single_sensor_form_t *)ctx;
+    void *record = config_body_record(form->config, idx, n_idx);
+    if (!record || n_idx == 0) {
+        return record;
+    }
+
+    sensor_config_t *sensor = &form->config->sensors[idx[0]];
+    if (n_idx == 1) {
+        if (form->sensor_id == -1) {
+            form->sensor_id = idx[0];
+        }
+        return record;
+    }
+
+    if (strcmp(sensor->sensor_type, "QUALITY") != 0) {
+        return NULL;
+    }
+    sub_sensor_t *sub = (sub_sensor_t *)record;
+    sub->enabled = true;
+    if (sub->quantity == 0) {
+        sub->quantity = 1;
+    }
+    if (strlen(sub->register_type) == 0) {
+        strcpy(sub->register_type, "HOLDING");
+    }
+    if (strlen(sub->data_type) == 0) {
+        strcpy(sub->data_type, "UINT16_HI");
+    }
+    if (sub->scale_factor == 0.0) {
+        sub->scale_factor = 1.0;
+    }
+    if (idx[1] >= sensor->sub_sensor_count) {
+        sensor->sub_sensor_count = idx[1] + 1;
+    }
+    return record;
+}
+
+static void single_sensor_named(void *record, const int *idx, const char *value, void *ctx)
+{
+    single_sensor_form_t *form = (single_sensor_form_t *)ctx;
+    form->has_name = strlen(value) > 0;
+    // Sub-sensor fields follow the name, so they rebuild the list from scratch
+    ((sensor_config_t *)record)->sub_sensor_count = 0;
+    config_sensor_named(record, idx, value, form->config);
+}
+
+static void single_sensor_unit_id(void *record, const int *idx, const char *value, void *ctx)
+{
+    ((single_sensor_form_t *)ctx)->has_unit_id = strlen(value) > 0;
+}
+
+static void single_sensor_scale(void *record, const int *idx, const char *value, void *ctx)
+{
+    sensor_config_t *sensor = (sensor_config_t *)record;
+    if (sensor->scale_factor == 0.0) {
+        sensor->scale_factor = 1.0;
+    }
+}
+
+// Accepts the long names the older edit forms send
+static void single_sensor_sub_register_type(void *record, const int *idx, const char *value, void *ctx)
+{
+    sub_sensor_t *sub = (sub_sensor_t *)record;
+    if (strcmp(value, "HOLDING_REGISTER") == 0 || strcmp(value, "HOLDING") == 0) {
+        strcpy(sub->register_type, "HOLDING");
+    } else if (strcmp(value, "INPUT_REGISTER") == 0 || strcmp(value, "INPUT") == 0) {
+        strcpy(sub->register_type, "INPUT");
+    } else {
+        strncpy(sub->register_type, value, sizeof(sub->register_type) - 1);
+        sub->register_type[sizeof(sub->register_type) - 1] = '\0';
+    }
+}
+
+#define SENSOR_FIELD(key, type, member, setter) BODY_FIELD("sensor_#_" key, type, sensor_config_t, member, setter)
+#define SUB_SENSOR_FIELD(key, type, member) BODY_FIELD("sensor_#_sub_#_" key, type, sub_sensor_t, member, NULL)
+
+// /save_single_sensor form fields
+static const body_field_t single_sensor_fields[] = {
+    SENSOR_FIELD("name", BODY_STR, name, single_sensor_named),
+    SENSOR_FIELD("unit_id", BODY_STR, unit_id, single_sensor_unit_id),
+    SENSOR_FIELD("slave_id", BODY_INT, slave_id, NULL),
+    SENSOR_FIELD("register_address", BODY_INT, register_address, NULL),
+    SENSOR_FIELD("quantity", BODY_INT, quantity, NULL),
+    SENSOR_FIELD("data_type", BODY_STR, data_type, NULL),
+    SENSOR_FIELD("baud_rate", BODY_INT, baud_rate, NULL),
+    SENSOR_FIELD("parity", BODY_STR, parity, NULL),
+    SENSOR_FIELD("scale_factor", BODY_FLOAT, scale_factor, single_sensor_scale),
+    SENSOR_FIELD("register_type", BODY_STR, register_type, NULL),
+    SENSOR_FIELD("sensor_type", BODY_STR, sensor_type, NULL),
+    SENSOR_FIELD("sensor_height", BODY_FLOAT, sensor_height, NULL),
+    SENSOR_FIELD("max_water_level", BODY_FLOAT, max_water_level, NULL),
+    SENSOR_FIELD("meter_type", BODY_STR, meter_type, NULL),
+    // Calculation engine
+    SENSOR_FIELD("calc_type", BODY_INT, calculation.calc_type, NULL),
+    SENSOR_FIELD("calc_high_reg", BODY_INT, calculation.high_register_offset, NULL),
+    SENSOR_FIELD("calc_low_reg", BODY_INT, calculation.low_register_offset, NULL),
+    SENSOR_FIELD("calc_multiplier", BODY_FLOAT, calculation.combine_multiplier, NULL),
+    SENSOR_FIELD("calc_scale", BODY_FLOAT, calculation.scale, NULL),
+    SENSOR_FIELD("calc_offset", BODY_FLOAT, calculation.offset, NULL),
+    SENSOR_FIELD("calc_empty_val", BODY_FLOAT, calculation.tank_empty_value, NULL),
+    SENSOR_FIELD("calc_full_val", BODY_FLOAT, calculation.tank_full_value, NULL),
+    SENSOR_FIELD("calc_invert", BODY_BOOL, calculation.invert_level, NULL),
+    SENSOR_FIELD("calc_tank_dia", BODY_FLOAT, calculation.tank_diameter, NULL),
+    SENSOR_FIELD("calc_tank_len", BODY_FLOAT, calculation.tank_length, NULL),
+    SENSOR_FIELD("calc_tank_wid", BODY_FLOAT, calculation.tank_width, NULL),
+    SENSOR_FIELD("calc_tank_hgt", BODY_FLOAT, calculation.tank_height, NULL),
+    SENSOR_FIELD("calc_vol_unit", BODY_INT, calculation.volume_unit, NULL),
+    SENSOR_FIELD("calc_pulses", BODY_FLOAT, calculation.pulses_per_unit, NULL),
+    SENSOR_FIELD("calc_in_min", BODY_FLOAT, calculation.input_min, NULL),
+    SENSOR_FIELD("calc_in_max", BODY_FLOAT, calculation.input_max, NULL),
+    SENSOR_FIELD("calc_out_min", BODY_FLOAT, calculation.output_min, NULL),
+    SENSOR_FIELD("calc_out_max", BODY_FLOAT, calculation.output_max, NULL),
+    SENSOR_FIELD("calc_poly_a", BODY_FLOAT, calculation.poly_a, NULL),
+    SENSOR_FIELD("calc_poly_b", BODY_FLOAT, calculation.poly_b, NULL),
+    SENSOR_FIELD("calc_poly_c", BODY_FLOAT, calculation.poly_c, NULL),
+    SENSOR_FIELD("calc_decimals", BODY_INT, calculation.decimal_places, NULL),
+    SENSOR_FIELD("calc_unit", BODY_STR, calculation.output_unit, NULL),
+    // Water quality sub-sensors
+    SUB_SENSOR_FIELD("parameter", BODY_STR, parameter_name),
+    SUB_SENSOR_FIELD("slave_id", BODY_INT, slave_id),
+    SUB_SENSOR_FIELD("register", BODY_INT, register_address),
+    SUB_SENSOR_FIELD("quantity", BODY_INT, quantity),
+    BODY_FIELD_CUSTOM("sensor_#_sub_#_register_type", single_sensor_sub_register_type),
+    SUB_SENSOR_FIELD("data_type", BODY_STR, data_type),
+    SUB_SENSOR_FIELD("scale_factor", BODY_FLOAT, scale_factor),
+    SUB_SENSOR_FIELD("scale", BODY_FLOAT, scale_factor),
+};
+static const body_table_t single_sensor_table = {
+    single_sensor_fields, sizeof(single_sensor_fields) / sizeof(single_sensor_fields[0]), single_sensor_record
+};
+
 // Save single sensor handler
 static esp_err_t save_single_sensor_handler(httpd_req_t *req)
 {
-    char buf[1024];
-    int ret = httpd_req_recv(req, buf, sizeof(buf) - 1);
-    if (ret <= 0) {
+    single_sensor_form_t form = { .config = &g_system_config, .sensor_id = -1 };
+    body_stats_t body_stats;
+    if (req->content_len == 0 ||
+        parse_request_body(req, &single_sensor_table, &form, &body_stats) != ESP_OK) {
         const char* error_response = "{\"status\":\"error\",\"message\":\"No data received\"}";
         httpd_resp_set_type(req, "application/json");
         httpd_resp_send(req, error_response, strlen(error_response));
         return ESP_OK;
     }
-    buf[ret] = '\0';
-    
-    ESP_LOGI(TAG, "Received single sensor data: %s", buf);
-    
-    // Parse form data
-    char *param_start = buf;
-    int sensor_id = -1;
-    bool has_name = false, has_unit_id = false;
-    
-    while (param_start) {
-        char *param_end = strchr(param_start, '&');
-        if (param_end) {
-            *param_end = '\0';
-        }
-        
-        char *equals = strchr(param_start, '=');
-        if (equals) {
-            *equals = '\0';
-            char *param_name = param_start;
-            char *param_value = equals + 1;
-            
-            // URL decode the value
-            char decoded_value[256];
-            url_decode(decoded_value, param_value);
-            
-            ESP_LOGI(TAG, "Processing: %s = %s", param_name, decoded_value);
-            
-            // Parse sensor parameters
-            if (strncmp(param_name, "sensor_", 7) == 0) {
-                // Check if this is a sub-sensor parameter first (contains "_sub_")
-                char *sub_start = strstr(param_name, "_sub_");
-                if (sub_start) {
-                    // Handle sub-sensor parameters (pattern: sensor_{index}_sub_{subIndex}_{param})
-                    int sensor_idx = atoi(param_name + 7);
-                    int sub_idx = atoi(sub_start + 5);
-                    char *param_type = strchr(sub_start + 5, '_');
-                    
-                    if (param_type && sensor_idx >= 0 && sensor_idx < 10 && sub_idx >= 0 && sub_idx < 8) {  // Max 10 sensors
-                        param_type++; // Skip the underscore
-                        ESP_LOGI(TAG, "Processing sub-sensor: sensor[%d].sub[%d].%s = %s", sensor_idx, sub_idx, param_type, decoded_value);
-                        
-                        // Ensure sensor is marked as enabled and is QUALITY type
-                        if (strcmp(g_system_config.sensors[sensor_idx].sensor_type, "QUALITY") == 0) {
-                            // Enable the sub-sensor when we process any of its parameters
-                            g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].enabled = true;
-                            
-                            // Initialize default values if not already set
-                            if (g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].quantity == 0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].quantity = 1;
-                            }
-                            if (strlen(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type) == 0) {
-                                strcpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type, "HOLDING");
-                            }
-                            if (strlen(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type) == 0) {
-                                strcpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type, "UINT16_HI");
-                            }
-                            if (g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].scale_factor == 0.0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].scale_factor = 1.0;
-                            }
-                            
-                            if (strcmp(param_type, "parameter") == 0) {
-                                strncpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].parameter_name, decoded_value, 
-                                       sizeof(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].parameter_name) - 1);
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].parameter_name[sizeof(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].parameter_name) - 1] = '\0';
-                            } else if (strcmp(param_type, "slave_id") == 0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].slave_id = atoi(decoded_value);
-                            } else if (strcmp(param_type, "register") == 0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_address = atoi(decoded_value);
-                            } else if (strcmp(param_type, "quantity") == 0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].quantity = atoi(decoded_value);
-                            } else if (strcmp(param_type, "register_type") == 0) {
-                                // Normalize register_type to short form
-                                if (strcmp(decoded_value, "HOLDING_REGISTER") == 0 || strcmp(decoded_value, "HOLDING") == 0) {
-                                    strcpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type, "HOLDING");
-                                } else if (strcmp(decoded_value, "INPUT_REGISTER") == 0 || strcmp(decoded_value, "INPUT") == 0) {
-                                    strcpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type, "INPUT");
-                                } else {
-                                    strncpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type, decoded_value,
-                                           sizeof(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type) - 1);
-                                    g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type[sizeof(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_type) - 1] = '\0';
-                                }
-                            } else if (strcmp(param_type, "data_type") == 0) {
-                                strncpy(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type, decoded_value,
-                                       sizeof(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type) - 1);
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type[sizeof(g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type) - 1] = '\0';
-                            } else if (strcmp(param_type, "scale_factor") == 0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].scale_factor = atof(decoded_value);
-                            } else if (strcmp(param_type, "scale") == 0) {
-                                g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].scale_factor = atof(decoded_value);
-                            }
-                            
-                            // Update sub-sensor count if this is the highest index
-                            if (sub_idx >= g_system_config.sensors[sensor_idx].sub_sensor_count) {
-                                g_system_config.sensors[sensor_idx].sub_sensor_count = sub_idx + 1;
-                            }
-                            
-                            ESP_LOGI(TAG, "Updated sensor[%d] sub_sensor_count to %d", sensor_idx, g_system_config.sensors[sensor_idx].sub_sensor_count);
-                            ESP_LOGI(TAG, "Sub-sensor[%d][%d]: param='%s', slave_id=%d, reg=%d, data_type='%s', scale=%.3f", 
-                                    sensor_idx, sub_idx,
-                                    g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].parameter_name,
-                                    g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].slave_id,
-                                    g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].register_address,
-                                    g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].data_type,
-                                    g_system_config.sensors[sensor_idx].sub_sensors[sub_idx].scale_factor);
-                        }
-                    }
-                } else {
-                    // Handle regular sensor parameters
-                    int current_sensor_idx = atoi(param_name + 7);
-                    if (sensor_id == -1) sensor_id = current_sensor_idx;
-
-                    if (current_sensor_idx >= 0 && current_sensor_idx < 10) {  // Max 10 sensors
-                        char *param_type = strchr(param_name + 7, '_');
-                        if (param_type) {
-                            param_type++; // Skip the underscore
-                        
-                        if (strcmp(param_type, "name") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].name, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].name) - 1);
-                            g_system_config.sensors[current_sensor_idx].enabled = true;
-                            has_name = (strlen(decoded_value) > 0);
-                            // Initialize sub-sensor count for new sensors
-                            g_system_config.sensors[current_sensor_idx].sub_sensor_count = 0;
-                            // Initialize default data_type if not already set
-                            if (strlen(g_system_config.sensors[current_sensor_idx].data_type) == 0) {
-                                strcpy(g_system_config.sensors[current_sensor_idx].data_type, "UINT16_HI");
-                                ESP_LOGI(TAG, "Save_single: Set default data_type to UINT16_HI for new sensor %d", current_sensor_idx);
-                            }
-                            // Update sensor count if this is a new sensor
-                            if (current_sensor_idx >= g_system_config.sensor_count) {
-                                g_system_config.sensor_count = current_sensor_idx + 1;
-                            }
-                        } else if (strcmp(param_type, "unit_id") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].unit_id, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].unit_id) - 1);
-                            has_unit_id = (strlen(decoded_value) > 0);
-                        } else if (strcmp(param_type, "slave_id") == 0) {
-                            g_system_config.sensors[current_sensor_idx].slave_id = atoi(decoded_value);
-                        } else if (strcmp(param_type, "register_address") == 0) {
-                            g_system_config.sensors[current_sensor_idx].register_address = atoi(decoded_value);
-                        } else if (strcmp(param_type, "quantity") == 0) {
-                            g_system_config.sensors[current_sensor_idx].quantity = atoi(decoded_value);
-                        } else if (strcmp(param_type, "data_type") == 0) {
-                            ESP_LOGI(TAG, "Save_single: Processing data_type - Original: '%s' (len=%d)", decoded_value, strlen(decoded_value));
-                            strncpy(g_system_config.sensors[current_sensor_idx].data_type, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].data_type) - 1);
-                            g_system_config.sensors[current_sensor_idx].data_type[sizeof(g_system_config.sensors[current_sensor_idx].data_type) - 1] = '\0';
-                            ESP_LOGI(TAG, "Save_single: Stored data_type: '%s' (len=%d) [Buffer size: %d]", 
-                                   g_system_config.sensors[current_sensor_idx].data_type, 
-                                   strlen(g_system_config.sensors[current_sensor_idx].data_type),
-                                   sizeof(g_system_config.sensors[current_sensor_idx].data_type));
-                        } else if (strcmp(param_type, "baud_rate") == 0) {
-                            g_system_config.sensors[current_sensor_idx].baud_rate = atoi(decoded_value);
-                        } else if (strcmp(param_type, "parity") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].parity, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].parity) - 1);
-                        } else if (strcmp(param_type, "scale_factor") == 0) {
-                            float parsed_scale = atof(decoded_value);
-                            g_system_config.sensors[current_sensor_idx].scale_factor = (parsed_scale == 0.0) ? 1.0 : parsed_scale;
-                            ESP_LOGI(TAG, "Save_single: Parsed scale_factor: '%s' -> %.3f (final: %.3f) for sensor %d", 
-                                     decoded_value, parsed_scale, g_system_config.sensors[current_sensor_idx].scale_factor, current_sensor_idx);
-                        } else if (strcmp(param_type, "register_type") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].register_type, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].register_type) - 1);
-                            g_system_config.sensors[current_sensor_idx].register_type[sizeof(g_system_config.sensors[current_sensor_idx].register_type) - 1] = '\0';
-                        } else if (strcmp(param_type, "sensor_type") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].sensor_type, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].sensor_type) - 1);
-                            g_system_config.sensors[current_sensor_idx].sensor_type[sizeof(g_system_config.sensors[current_sensor_idx].sensor_type) - 1] = '\0';
-                            ESP_LOGI(TAG, "Save_single: Stored sensor_type: '%s' for sensor %d", g_system_config.sensors[current_sensor_idx].sensor_type, current_sensor_idx);
-                        } else if (strcmp(param_type, "sensor_height") == 0) {
-                            g_system_config.sensors[current_sensor_idx].sensor_height = atof(decoded_value);
-                        } else if (strcmp(param_type, "max_water_level") == 0) {
-                            g_system_config.sensors[current_sensor_idx].max_water_level = atof(decoded_value);
-                        } else if (strcmp(param_type, "meter_type") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].meter_type, decoded_value, sizeof(g_system_config.sensors[current_sensor_idx].meter_type) - 1);
-                            g_system_config.sensors[current_sensor_idx].meter_type[sizeof(g_system_config.sensors[current_sensor_idx].meter_type) - 1] = '\0';
-                        }
-                        // ========== CALCULATION ENGINE PARAMETERS ==========
-                        else if (strcmp(param_type, "calc_type") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.calc_type = (calculation_type_t)atoi(decoded_value);
-                            ESP_LOGI(TAG, "Save_single: calc_type=%d for sensor %d",
-                                     g_system_config.sensors[current_sensor_idx].calculation.calc_type, current_sensor_idx);
-                        } else if (strcmp(param_type, "calc_high_reg") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.high_register_offset = atoi(decoded_value);
-                        } else if (strcmp(param_type, "calc_low_reg") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.low_register_offset = atoi(decoded_value);
-                        } else if (strcmp(param_type, "calc_multiplier") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.combine_multiplier = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_scale") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.scale = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_offset") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.offset = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_empty_val") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.tank_empty_value = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_full_val") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.tank_full_value = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_invert") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.invert_level = (atoi(decoded_value) == 1);
-                        } else if (strcmp(param_type, "calc_tank_dia") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.tank_diameter = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_tank_len") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.tank_length = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_tank_wid") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.tank_width = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_tank_hgt") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.tank_height = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_vol_unit") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.volume_unit = atoi(decoded_value);
-                        } else if (strcmp(param_type, "calc_pulses") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.pulses_per_unit = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_in_min") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.input_min = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_in_max") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.input_max = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_out_min") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.output_min = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_out_max") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.output_max = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_poly_a") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.poly_a = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_poly_b") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.poly_b = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_poly_c") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.poly_c = atof(decoded_value);
-                        } else if (strcmp(param_type, "calc_decimals") == 0) {
-                            g_system_config.sensors[current_sensor_idx].calculation.decimal_places = atoi(decoded_value);
-                        } else if (strcmp(param_type, "calc_unit") == 0) {
-                            strncpy(g_system_config.sensors[current_sensor_idx].calculation.output_unit, decoded_value,
-                                    sizeof(g_system_config.sensors[current_sensor_idx].calculation.output_unit) - 1);
-                        }
-                        // ========== END CALCULATION ENGINE PARAMETERS ==========
-                        }
-                    }
-                }
-            }
-        }
+    ESP_LOGI(TAG, "Received single sensor data: %u fields, %u unknown", body_stats.fields, body_stats.unknown);
 
-        if (param_end) {
-            param_start = param_end + 1;
-        } else {
-            break;
-        }
+    int sensor_id = form.sensor_id;
+    bool has_name = form.has_name, has_unit_id = form.has_unit_id;
+    if (sensor_id >= 0) {
+        const sensor_config_t *sensor = &g_system_config.sensors[sensor_id];
+        ESP_LOGI(TAG, "Sensor %d: type='%s', data_type='%s', scale=%.3f, sub_sensors=%d",
+                 sensor_id, sensor->sensor_type, sensor->data_type, sensor->scale_factor, sensor->sub_sensor_count);
     }
     
     // Validate required fields
@@ -8663,31 +4843,20 @@ static esp_err_t save_water_quality_sensor_handler(httpd_req_t *req)
 }
 
 
-// WiFi reconnection state
-static int s_wifi_retry_count = 0;
-static const int MAX_WIFI_RETRY = 5;
-
-// WiFi event handler
+// WiFi event handler. Reconnects after the first attempt are paced by
+// connectivity_task (conn_sm) through wifi_trigger_reconnect() - the driver
+// events only report what happened.
 static void wifi_event_handler(void* arg, esp_event_base_t event_base,
                                int32_t event_id, void* event_data)
 {
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
         esp_wifi_connect();
-        s_wifi_retry_count = 0;
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_wifi_retry_count < MAX_WIFI_RETRY) {
-            ESP_LOGI(TAG, "WiFi disconnected, retry %d/%d", s_wifi_retry_count + 1, MAX_WIFI_RETRY);
-            // IMPORTANT: Never use vTaskDelay() in event handlers - it blocks the WiFi task!
-            // The event loop will handle reconnection timing automatically
-            esp_wifi_connect();
-            s_wifi_retry_count++;
-        } else {
-            ESP_LOGW(TAG, "WiFi connection failed after %d attempts", MAX_WIFI_RETRY);
-        }
+        wifi_event_sta_disconnected_t* event = (wifi_event_sta_disconnected_t*) event_data;
+        ESP_LOGI(TAG, "WiFi disconnected (reason %d) - recovery left to connectivity task", event->reason);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
-        s_wifi_retry_count = 0;  // Reset retry counter on successful connection
 
         // Set DNS servers explicitly (in case DHCP didn't provide them)
         // This is critical for Azure IoT Hub connectivity
@@ -8719,7 +4888,6 @@ bool wifi_trigger_reconnect(void) {
     }
 
     ESP_LOGI(TAG, "[WIFI] Triggering periodic WiFi reconnection attempt...");
-    s_wifi_retry_count = 0;  // Reset retry counter for new attempt
     esp_wifi_connect();
     return true;
 }
@@ -8811,6 +4979,9 @@ static esp_err_t system_status_handler(httpd_req_t *req)
         xSemaphoreGive(g_sim_test_mutex);
     }
 
+    web_admission_stats_t web_stats;
+    web_admission_get_stats(&web_stats);
+
     // Build JSON response
     snprintf(response, sizeof(response),
         "{"
@@ -8859,6 +5030,13 @@ static esp_err_t system_status_handler(httpd_req_t *req)
         "},"
         "\"tasks\":{"
             "\"count\":%u"
+        "},"
+        "\"web\":{"
+            "\"served\":%lu,"
+            "\"degraded\":%lu,"
+            "\"queued\":%lu,"
+            "\"rejected\":%lu,"
+            "\"stack_free_min\":%lu"
         "}"
         "}",
         timestamp,
@@ -8891,7 +5069,12 @@ static esp_err_t system_status_handler(httpd_req_t *req)
         sim_operator,
         g_system_config.sensor_count,
         (g_system_config.sensor_count > 0) ? "true" : "false",
-        task_count
+        task_count,
+        (unsigned long)web_stats.served,
+        (unsigned long)web_stats.degraded,
+        (unsigned long)web_stats.queued,
+        (unsigned long)web_stats.rejected,
+        (unsigned long)(web_stats.stack_free_min == UINT32_MAX ? 0 : web_stats.stack_free_min)
     );
     
     httpd_resp_set_type(req, "application/json");
@@ -8900,6 +5083,52 @@ static esp_err_t system_status_handler(httpd_req_t *req)
     return ESP_OK;
 }
 
+// Consolidated status: GET /api/status[?fields=memory,modbus,...][&format=compact]
+// Served from the gateway_status snapshot - a copy and a serialization, no sampling
+static esp_err_t api_status_handler(httpd_req_t *req)
+{
+    static char response[STATUS_RESPONSE_SIZE];   // httpd task serves one request at a time
+    char query[128], fields_param[96] = "", format_param[16] = "";
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        httpd_query_key_value(query, "fields", fields_param, sizeof(fields_param));
+        httpd_query_key_value(query, "format", format_param, sizeof(format_param));
+    }
+    uint32_t fields = gateway_status_parse_fields(fields_param);
+    bool compact = strcmp(format_param, "compact") == 0;
+    if (fields == 0) {
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_set_type(req, "application/json");
+        return httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unknown fields - use system,memory,"
+                                       "partitions,wifi,sim,modbus,azure,sensors,tasks,web\"}");
+    }
+
+    gateway_status_t st;
+    gateway_status_get(&st);
+
+    char etag[32], cache_control[24];
+    snprintf(etag, sizeof(etag), "\"%" PRIx32 "-%" PRIx32 "%s\"", st.version, fields, compact ? "c" : "");
+    snprintf(cache_control, sizeof(cache_control), "max-age=%d", STATUS_CACHE_MAX_AGE_S);
+    httpd_resp_set_hdr(req, "ETag", etag);
+    httpd_resp_set_hdr(req, "Cache-Control", cache_control);
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+
+    char if_none_match[64];
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strstr(if_none_match, etag) != NULL) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, NULL, 0);
+    }
+
+    size_t len = gateway_status_format(&st, fields, compact, response, sizeof(response));
+    if (len == 0) {
+        httpd_resp_send_500(req);
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, response, len);
+}
+
 // Write Single Register Handler
 static esp_err_t write_single_register_handler(httpd_req_t *req)
 {
@@ -9309,45 +5538,41 @@ static esp_err_t api_ota_status_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// /api/ota/start JSON body: {"url":"...","version":"..."}
+typedef struct {
+    char url[BODY_VALUE_MAX];
+    char version[32];
+} ota_start_form_t;
+
+static const body_field_t ota_start_fields[] = {
+    BODY_FIELD("url", BODY_STR, ota_start_form_t, url, NULL),
+    BODY_FIELD("version", BODY_STR, ota_start_form_t, version, NULL),
+};
+static const body_table_t ota_start_table = {
+    ota_start_fields, sizeof(ota_start_fields) / sizeof(ota_start_fields[0]), NULL
+};
+
 // Start OTA update from URL
 static esp_err_t api_ota_start_handler(httpd_req_t *req) {
-    char buf[512];
-    int ret, remaining = req->content_len;
-
-    if (remaining > sizeof(buf) - 1) {
+    ota_start_form_t form = { .url = "", .version = "unknown" };
+    esp_err_t parse_ret = parse_request_body(req, &ota_start_table, &form, NULL);
+    if (parse_ret == ESP_ERR_INVALID_SIZE) {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Request too large");
         return ESP_FAIL;
     }
-
-    ret = httpd_req_recv(req, buf, MIN(remaining, sizeof(buf) - 1));
-    if (ret <= 0) {
-        httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Failed to receive data");
-        return ESP_FAIL;
-    }
-    buf[ret] = '\0';
-
-    // Parse JSON
-    cJSON *root = cJSON_Parse(buf);
-    if (!root) {
+    if (parse_ret != ESP_OK) {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Invalid JSON");
         return ESP_FAIL;
     }
-
-    cJSON *url = cJSON_GetObjectItem(root, "url");
-    cJSON *version = cJSON_GetObjectItem(root, "version");
-
-    if (!url || !cJSON_IsString(url)) {
-        cJSON_Delete(root);
+    if (form.url[0] == '\0') {
         httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Missing 'url' parameter");
         return ESP_FAIL;
     }
+    const char *fw_version = form.version;
 
-    const char *fw_version = (version && cJSON_IsString(version)) ? version->valuestring : "unknown";
-
-    ESP_LOGI(TAG, "[OTA] Starting update from URL: %s (v%s)", url->valuestring, fw_version);
+    ESP_LOGI(TAG, "[OTA] Starting update from URL: %s (v%s)", form.url, fw_version);
 
-    esp_err_t ota_ret = ota_start_update(url->valuestring, fw_version);
-    cJSON_Delete(root);
+    esp_err_t ota_ret = ota_start_update(form.url, fw_version);
 
     httpd_resp_set_type(req, "application/json");
     if (ota_ret == ESP_OK) {
@@ -9455,16 +5680,63 @@ static esp_err_t api_ota_upload_handler(httpd_req_t *req) {
 // AUTHENTICATION HANDLERS
 // ============================================================================
 
+// Worst-case transient heap per route, checked by the admission gate before the
+// handler runs (see web_admission.h). Unlisted routes cost WEB_ADMIT_DEFAULT_COST.
+static const web_route_cost_t g_route_costs[] = {
+    // Static assets are sent straight from flash
+    { "/",                           1024,  0, 0 },
+    { "/styles.css",                 1024,  0, 0 },
+    { "/app.js",                     1024,  0, 0 },
+    { "/section/*",                  1024,  0, 0 },
+    { "/favicon.ico",                1024,  0, 0 },
+    { "/logo",                       12288, 0, 0 },      // base64-decoded PNG
+    // cJSON trees; the degraded variants leave out sub-sensors / quality blocks
+    { "/api/config",                 24576, 8192, WEB_ROUTE_DEGRADABLE },
+    { "/live_data",                  8192,  4096, WEB_ROUTE_DEGRADABLE },
+    { "/api/status",                 1024,  0, 0 },      // Static response buffer
+    { "/api/system_status",          1024,  0, 0 },
+    { "/api/modbus/status",          1024,  0, 0 },
+    { "/api/azure/status",           1024,  0, 0 },
+    { "/api/ota/status",             1024,  0, 0 },
+    { "/api/sd_status",              1024,  0, 0 },
+    { "/api/rtc_time",               1024,  0, 0 },
+    { "/scan_wifi",                  6144,  0, 0 },      // AP list + 2KB response
+    // Hold the RS485 bus from baud rate change to response-buffer copy; /modbus_scan,
+    // the register writes and /api/modbus_dump only take it per frame or block
+    { "/test_sensor",                8192,  0, WEB_ROUTE_RS485 },      // 6KB format table
+    { "/test_rs485",                 8192,  0, WEB_ROUTE_RS485 },
+    { "/test_quality_sensor",        10240, 0, WEB_ROUTE_RS485 },      // 8KB HTML
+    { "/test_water_quality_sensor",  10240, 0, WEB_ROUTE_RS485 },
+    { "/api/modbus_poll",            WEB_ADMIT_DEFAULT_COST, 0, WEB_ROUTE_RS485 },
+    { "/modbus_read_live",           WEB_ADMIT_DEFAULT_COST, 0, WEB_ROUTE_RS485 },
+    { "/api/sim_test",               10240, 0, 0 },      // 8KB task stack
+    { "/api/ota/upload",             40960, 0, 0 },      // Delta patches inflate in a ~21KB context
+    { "/api/ota/start",              40960, 0, 0 },      // OTA task + TLS session
+    { "/ota/peer/manifest",          1024,  0, 0 },
+    { "/ota/peer/image",             10240, 0, 0 },      // SD read buffer + transfer task stack
+    { "/api/log",                    1024,  0, 0 },      // Lines formatted on the httpd stack
+    { "/api/perf",                   1024,  0, 0 },
+    { "/api/trace",                  10240, 0, 0 },      // Trace ring allocated by ?start=1
+    // Needed to recover the device, always served
+    { "/reboot",                     0,     0, WEB_ROUTE_ESSENTIAL },
+    { "/start_operation",            0,     0, WEB_ROUTE_ESSENTIAL },
+    { "/watchdog_control",           0,     0, WEB_ROUTE_ESSENTIAL },
+    { "/gpio_trigger",               0,     0, WEB_ROUTE_ESSENTIAL },
+    { "/api/ota/cancel",             0,     0, WEB_ROUTE_ESSENTIAL },
+    { "/api/ota/confirm",            0,     0, WEB_ROUTE_ESSENTIAL },
+    { "/api/ota/reboot",             0,     0, WEB_ROUTE_ESSENTIAL },
+};
+
 static esp_err_t start_webserver(void)
 {
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
-    config.max_uri_handlers = 55;
-    config.max_open_sockets = 7;      // Must handle concurrent: page stream + /logo + /favicon + API calls
-    config.stack_size = 12288;        // 12KB stack for 5KB chunk buffer + overhead
+    config.max_uri_handlers = WEB_HTTPD_MAX_URI_HANDLERS;
+    config.max_open_sockets = 7;      // Must handle concurrent: page + /styles.css + /app.js + /logo + API calls
+    config.stack_size = 10240;        // Page is static now; largest handler frames (save_config, system_status) are ~4.6KB
     config.task_priority = 6;         // Higher priority for faster response (was 5)
     config.recv_wait_timeout = 10;    // 10 seconds receive timeout
-    config.send_wait_timeout = 30;    // 30 seconds - needed for large page (~125KB header)
+    config.send_wait_timeout = 30;    // 30 seconds - app.js is ~33KB gzipped over a slow SoftAP
     config.lru_purge_enable = false;  // CRITICAL: must be false - LRU purge kills page streaming socket when browser requests /logo or /favicon concurrently
     config.backlog_conn = 5;          // Allow more pending connections
     config.enable_so_linger = false;  // Disable socket lingering to prevent TIME_WAIT issues
@@ -9473,16 +5745,57 @@ static esp_err_t start_webserver(void)
     config.keep_alive_interval = 3;   // Keep-alive probe interval (3 seconds)
     config.keep_alive_count = 3;      // Allow 3 probes before closing
     config.open_fn = web_wake_session_open;  // reset idle timer on every TCP session
+    config.uri_match_fn = httpd_uri_match_wildcard;  // For /section/*
 
     if (httpd_start(&g_server, &config) == ESP_OK) {
-        // Main configuration page
+        web_admission_init(g_route_costs, sizeof(g_route_costs) / sizeof(g_route_costs[0]));
+
+        // Portal page and its static assets
         httpd_uri_t config_uri = {
             .uri = "/",
             .method = HTTP_GET,
-            .handler = config_page_handler,
+            .handler = web_asset_handler,
+            .user_ctx = &g_web_assets[WEB_ASSET_INDEX]
+        };
+        web_admission_register(g_server, &config_uri);
+
+        httpd_uri_t styles_uri = {
+            .uri = "/styles.css",
+            .method = HTTP_GET,
+            .handler = web_asset_handler,
+            .user_ctx = &g_web_assets[WEB_ASSET_STYLES]
+        };
+        web_admission_register(g_server, &styles_uri);
+
+        httpd_uri_t app_js_uri = {
+            .uri = "/app.js",
+            .method = HTTP_GET,
+            .handler = web_asset_handler,
+            .user_ctx = &g_web_assets[WEB_ASSET_APP]
+        };
+        web_admission_register(g_server, &app_js_uri);
+
+        httpd_uri_t section_uri = {
+            .uri = "/section/*",
+            .method = HTTP_GET,
+            .handler = web_section_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &config_uri);
+        web_admission_register(g_server, &section_uri);
+
+        // Current configuration values for the portal
+        httpd_uri_t api_config_uri = {
+            .uri = "/api/config",
+            .method = HTTP_GET,
+            .handler = api_config_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &api_config_uri);
+
+        // Live status push (replaces the page's 5 s polling)
+        if (web_push_register(g_server) != ESP_OK) {
+            ESP_LOGW(TAG, "[WEB] /ws push unavailable - portal falls back to polling");
+        }
 
         // Save configuration
         httpd_uri_t save_uri = {
@@ -9491,7 +5804,7 @@ static esp_err_t start_webserver(void)
             .handler = save_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_uri);
+        web_admission_register(g_server, &save_uri);
 
         // Save Azure configuration
         httpd_uri_t save_azure_uri = {
@@ -9500,7 +5813,7 @@ static esp_err_t start_webserver(void)
             .handler = save_azure_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_azure_uri);
+        web_admission_register(g_server, &save_azure_uri);
 
         // Save modem configuration
         httpd_uri_t save_modem_uri = {
@@ -9509,7 +5822,7 @@ static esp_err_t start_webserver(void)
             .handler = save_modem_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_modem_uri);
+        web_admission_register(g_server, &save_modem_uri);
 
         // Save system configuration
         httpd_uri_t save_system_uri = {
@@ -9518,7 +5831,7 @@ static esp_err_t start_webserver(void)
             .handler = save_system_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_system_uri);
+        web_admission_register(g_server, &save_system_uri);
 
         // Test sensor
         httpd_uri_t test_uri = {
@@ -9527,7 +5840,7 @@ static esp_err_t start_webserver(void)
             .handler = test_sensor_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &test_uri);
+        web_admission_register(g_server, &test_uri);
 
         // Start operation mode
         httpd_uri_t operation_uri = {
@@ -9536,7 +5849,7 @@ static esp_err_t start_webserver(void)
             .handler = start_operation_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &operation_uri);
+        web_admission_register(g_server, &operation_uri);
 
         // WiFi scan endpoint
         httpd_uri_t scan_uri = {
@@ -9545,7 +5858,7 @@ static esp_err_t start_webserver(void)
             .handler = wifi_scan_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &scan_uri);
+        web_admission_register(g_server, &scan_uri);
 
         // Live data endpoint  
         httpd_uri_t live_uri = {
@@ -9554,7 +5867,7 @@ static esp_err_t start_webserver(void)
             .handler = live_data_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &live_uri);
+        web_admission_register(g_server, &live_uri);
 
         // Edit sensor endpoint
         httpd_uri_t edit_uri = {
@@ -9563,7 +5876,7 @@ static esp_err_t start_webserver(void)
             .handler = edit_sensor_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &edit_uri);
+        web_admission_register(g_server, &edit_uri);
 
         // Save single sensor endpoint
         httpd_uri_t save_single_uri = {
@@ -9572,7 +5885,7 @@ static esp_err_t start_webserver(void)
             .handler = save_single_sensor_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_single_uri);
+        web_admission_register(g_server, &save_single_uri);
 
         // Delete sensor endpoint
         httpd_uri_t delete_uri = {
@@ -9581,7 +5894,7 @@ static esp_err_t start_webserver(void)
             .handler = delete_sensor_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &delete_uri);
+        web_admission_register(g_server, &delete_uri);
 
         // RS485 Test endpoint
         httpd_uri_t test_rs485_uri = {
@@ -9590,7 +5903,7 @@ static esp_err_t start_webserver(void)
             .handler = test_rs485_handler,
             .user_ctx = NULL
         };
-        esp_err_t test_rs485_reg = httpd_register_uri_handler(g_server, &test_rs485_uri);
+        esp_err_t test_rs485_reg = web_admission_register(g_server, &test_rs485_uri);
         if (test_rs485_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /test_rs485 endpoint registered successfully");
         } else {
@@ -9604,7 +5917,7 @@ static esp_err_t start_webserver(void)
             .handler = test_quality_sensor_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &test_quality_uri);
+        web_admission_register(g_server, &test_quality_uri);
         ESP_LOGI(TAG, "SUCCESS: /test_quality_sensor endpoint registered");
 
         // Water Quality Sensor Test endpoint
@@ -9614,7 +5927,7 @@ static esp_err_t start_webserver(void)
             .handler = test_water_quality_sensor_handler,
             .user_ctx = NULL
         };
-        esp_err_t test_wq_reg = httpd_register_uri_handler(g_server, &test_water_quality_uri);
+        esp_err_t test_wq_reg = web_admission_register(g_server, &test_water_quality_uri);
         if (test_wq_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /test_water_quality_sensor endpoint registered successfully");
         } else {
@@ -9628,7 +5941,7 @@ static esp_err_t start_webserver(void)
             .handler = save_water_quality_sensor_handler,
             .user_ctx = NULL
         };
-        esp_err_t save_wq_reg = httpd_register_uri_handler(g_server, &save_water_quality_uri);
+        esp_err_t save_wq_reg = web_admission_register(g_server, &save_water_quality_uri);
         if (save_wq_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /save_water_quality_sensor endpoint registered successfully");
         } else {
@@ -9636,6 +5949,20 @@ static esp_err_t start_webserver(void)
         }
 
 
+        // Consolidated status API endpoint (snapshot, fields= selection)
+        httpd_uri_t status_uri = {
+            .uri = "/api/status",
+            .method = HTTP_GET,
+            .handler = api_status_handler,
+            .user_ctx = NULL
+        };
+        esp_err_t status_reg = web_admission_register(g_server, &status_uri);
+        if (status_reg == ESP_OK) {
+            ESP_LOGI(TAG, "SUCCESS: /api/status endpoint registered successfully");
+        } else {
+            ESP_LOGE(TAG, "ERROR: Failed to register /api/status endpoint: %s", esp_err_to_name(status_reg));
+        }
+
         // System status API endpoint
         httpd_uri_t system_status_uri = {
             .uri = "/api/system_status",
@@ -9643,7 +5970,7 @@ static esp_err_t start_webserver(void)
             .handler = system_status_handler,
             .user_ctx = NULL
         };
-        esp_err_t system_status_reg = httpd_register_uri_handler(g_server, &system_status_uri);
+        esp_err_t system_status_reg = web_admission_register(g_server, &system_status_uri);
         if (system_status_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /api/system_status endpoint registered successfully");
         } else {
@@ -9657,7 +5984,7 @@ static esp_err_t start_webserver(void)
             .handler = write_single_register_handler,
             .user_ctx = NULL
         };
-        esp_err_t write_single_reg = httpd_register_uri_handler(g_server, &write_single_uri);
+        esp_err_t write_single_reg = web_admission_register(g_server, &write_single_uri);
         if (write_single_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /write_single_register endpoint registered successfully");
         } else {
@@ -9671,7 +5998,7 @@ static esp_err_t start_webserver(void)
             .handler = write_multiple_registers_handler,
             .user_ctx = NULL
         };
-        esp_err_t write_multiple_reg = httpd_register_uri_handler(g_server, &write_multiple_uri);
+        esp_err_t write_multiple_reg = web_admission_register(g_server, &write_multiple_uri);
         if (write_multiple_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /write_multiple_registers endpoint registered successfully");
         } else {
@@ -9685,7 +6012,7 @@ static esp_err_t start_webserver(void)
             .handler = logo_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &logo_uri);
+        web_admission_register(g_server, &logo_uri);
 
 
         // Favicon handler to prevent 404 errors
@@ -9695,7 +6022,7 @@ static esp_err_t start_webserver(void)
             .handler = favicon_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &favicon_uri);
+        web_admission_register(g_server, &favicon_uri);
 
         // Reset sensor calculations endpoint (POST)
         httpd_uri_t reset_sensors_uri = {
@@ -9704,7 +6031,7 @@ static esp_err_t start_webserver(void)
             .handler = reset_sensors_handler,
             .user_ctx = NULL
         };
-        esp_err_t reset_sensors_reg = httpd_register_uri_handler(g_server, &reset_sensors_uri);
+        esp_err_t reset_sensors_reg = web_admission_register(g_server, &reset_sensors_uri);
         if (reset_sensors_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /reset_sensors endpoint registered successfully");
         } else {
@@ -9718,7 +6045,7 @@ static esp_err_t start_webserver(void)
             .handler = reset_sensors_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &reset_sensors_options_uri);
+        web_admission_register(g_server, &reset_sensors_options_uri);
 
         // Reboot system endpoint (POST)
         httpd_uri_t reboot_uri = {
@@ -9727,7 +6054,7 @@ static esp_err_t start_webserver(void)
             .handler = reboot_handler,
             .user_ctx = NULL
         };
-        esp_err_t reboot_reg = httpd_register_uri_handler(g_server, &reboot_uri);
+        esp_err_t reboot_reg = web_admission_register(g_server, &reboot_uri);
         if (reboot_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /reboot endpoint registered successfully");
         } else {
@@ -9741,7 +6068,7 @@ static esp_err_t start_webserver(void)
             .handler = reboot_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &reboot_options_uri);
+        web_admission_register(g_server, &reboot_options_uri);
 
         // Watchdog control endpoint
         httpd_uri_t watchdog_control_uri = {
@@ -9750,7 +6077,7 @@ static esp_err_t start_webserver(void)
             .handler = watchdog_control_handler,
             .user_ctx = NULL
         };
-        esp_err_t watchdog_reg = httpd_register_uri_handler(g_server, &watchdog_control_uri);
+        esp_err_t watchdog_reg = web_admission_register(g_server, &watchdog_control_uri);
         if (watchdog_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /watchdog_control endpoint registered successfully");
         } else {
@@ -9764,7 +6091,7 @@ static esp_err_t start_webserver(void)
             .handler = gpio_trigger_handler,
             .user_ctx = NULL
         };
-        esp_err_t gpio_reg = httpd_register_uri_handler(g_server, &gpio_trigger_uri);
+        esp_err_t gpio_reg = web_admission_register(g_server, &gpio_trigger_uri);
         if (gpio_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /gpio_trigger endpoint registered successfully");
         } else {
@@ -9778,7 +6105,7 @@ static esp_err_t start_webserver(void)
             .handler = save_network_mode_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_network_mode_uri);
+        web_admission_register(g_server, &save_network_mode_uri);
 
         // WiFi configuration endpoint (AJAX-based, no page redirect)
         httpd_uri_t save_wifi_config_uri = {
@@ -9787,7 +6114,7 @@ static esp_err_t start_webserver(void)
             .handler = save_wifi_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_wifi_config_uri);
+        web_admission_register(g_server, &save_wifi_config_uri);
 
         // SIM configuration endpoint
         httpd_uri_t save_sim_config_uri = {
@@ -9796,7 +6123,7 @@ static esp_err_t start_webserver(void)
             .handler = save_sim_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_sim_config_uri);
+        web_admission_register(g_server, &save_sim_config_uri);
 
         // SD card configuration endpoint
         httpd_uri_t save_sd_config_uri = {
@@ -9805,7 +6132,7 @@ static esp_err_t start_webserver(void)
             .handler = save_sd_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_sd_config_uri);
+        web_admission_register(g_server, &save_sd_config_uri);
 
         // RTC configuration endpoint
         httpd_uri_t save_rtc_config_uri = {
@@ -9814,7 +6141,7 @@ static esp_err_t start_webserver(void)
             .handler = save_rtc_config_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &save_rtc_config_uri);
+        web_admission_register(g_server, &save_rtc_config_uri);
 
         // Live Modbus poll API endpoint
         httpd_uri_t api_modbus_poll_uri = {
@@ -9823,7 +6150,16 @@ static esp_err_t start_webserver(void)
             .handler = api_modbus_poll_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_modbus_poll_uri);
+        web_admission_register(g_server, &api_modbus_poll_uri);
+
+        // Bulk register dump (CSV/JSON, streamed)
+        httpd_uri_t api_modbus_dump_uri = {
+            .uri = "/api/modbus_dump",
+            .method = HTTP_GET,
+            .handler = api_modbus_dump_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &api_modbus_dump_uri);
 
         // SIM test API endpoint
         httpd_uri_t api_sim_test_uri = {
@@ -9832,7 +6168,7 @@ static esp_err_t start_webserver(void)
             .handler = api_sim_test_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_sim_test_uri);
+        web_admission_register(g_server, &api_sim_test_uri);
 
         // SIM test status API endpoint
         httpd_uri_t api_sim_test_status_uri = {
@@ -9841,7 +6177,7 @@ static esp_err_t start_webserver(void)
             .handler = api_sim_test_status_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_sim_test_status_uri);
+        web_admission_register(g_server, &api_sim_test_status_uri);
 
         // SD status API endpoint
         httpd_uri_t api_sd_status_uri = {
@@ -9850,7 +6186,7 @@ static esp_err_t start_webserver(void)
             .handler = api_sd_status_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_sd_status_uri);
+        web_admission_register(g_server, &api_sd_status_uri);
 
         // SD clear API endpoint
         httpd_uri_t api_sd_clear_uri = {
@@ -9859,7 +6195,7 @@ static esp_err_t start_webserver(void)
             .handler = api_sd_clear_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_sd_clear_uri);
+        web_admission_register(g_server, &api_sd_clear_uri);
 
         // SD replay API endpoint
         httpd_uri_t api_sd_replay_uri = {
@@ -9868,7 +6204,7 @@ static esp_err_t start_webserver(void)
             .handler = api_sd_replay_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_sd_replay_uri);
+        web_admission_register(g_server, &api_sd_replay_uri);
 
         // RTC time API endpoint
         httpd_uri_t api_rtc_time_uri = {
@@ -9877,7 +6213,7 @@ static esp_err_t start_webserver(void)
             .handler = api_rtc_time_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_rtc_time_uri);
+        web_admission_register(g_server, &api_rtc_time_uri);
 
         // RTC sync API endpoint
         httpd_uri_t api_rtc_sync_uri = {
@@ -9886,7 +6222,7 @@ static esp_err_t start_webserver(void)
             .handler = api_rtc_sync_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_rtc_sync_uri);
+        web_admission_register(g_server, &api_rtc_sync_uri);
 
         // RTC set API endpoint
         httpd_uri_t api_rtc_set_uri = {
@@ -9895,7 +6231,7 @@ static esp_err_t start_webserver(void)
             .handler = api_rtc_set_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_rtc_set_uri);
+        web_admission_register(g_server, &api_rtc_set_uri);
 
         // Modbus status API endpoint
         httpd_uri_t api_modbus_status_uri = {
@@ -9904,7 +6240,7 @@ static esp_err_t start_webserver(void)
             .handler = api_modbus_status_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_modbus_status_uri);
+        web_admission_register(g_server, &api_modbus_status_uri);
 
         // Azure IoT Hub status API endpoint
         httpd_uri_t api_azure_status_uri = {
@@ -9913,7 +6249,7 @@ static esp_err_t start_webserver(void)
             .handler = api_azure_status_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_azure_status_uri);
+        web_admission_register(g_server, &api_azure_status_uri);
 
         // Modbus Explorer: Device Scanner endpoint
         httpd_uri_t modbus_scan_uri = {
@@ -9922,7 +6258,7 @@ static esp_err_t start_webserver(void)
             .handler = modbus_scan_handler,
             .user_ctx = NULL
         };
-        esp_err_t scan_reg = httpd_register_uri_handler(g_server, &modbus_scan_uri);
+        esp_err_t scan_reg = web_admission_register(g_server, &modbus_scan_uri);
         if (scan_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /modbus_scan endpoint registered successfully");
         } else {
@@ -9936,7 +6272,7 @@ static esp_err_t start_webserver(void)
             .handler = modbus_read_live_handler,
             .user_ctx = NULL
         };
-        esp_err_t live_reg = httpd_register_uri_handler(g_server, &modbus_read_live_uri);
+        esp_err_t live_reg = web_admission_register(g_server, &modbus_read_live_uri);
         if (live_reg == ESP_OK) {
             ESP_LOGI(TAG, "SUCCESS: /modbus_read_live endpoint registered successfully");
         } else {
@@ -9950,7 +6286,7 @@ static esp_err_t start_webserver(void)
             .handler = api_ota_status_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_ota_status_uri);
+        web_admission_register(g_server, &api_ota_status_uri);
 
         httpd_uri_t api_ota_start_uri = {
             .uri = "/api/ota/start",
@@ -9958,7 +6294,7 @@ static esp_err_t start_webserver(void)
             .handler = api_ota_start_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_ota_start_uri);
+        web_admission_register(g_server, &api_ota_start_uri);
 
         httpd_uri_t api_ota_upload_uri = {
             .uri = "/api/ota/upload",
@@ -9966,7 +6302,7 @@ static esp_err_t start_webserver(void)
             .handler = api_ota_upload_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_ota_upload_uri);
+        web_admission_register(g_server, &api_ota_upload_uri);
 
         httpd_uri_t api_ota_cancel_uri = {
             .uri = "/api/ota/cancel",
@@ -9974,7 +6310,7 @@ static esp_err_t start_webserver(void)
             .handler = api_ota_cancel_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_ota_cancel_uri);
+        web_admission_register(g_server, &api_ota_cancel_uri);
 
         httpd_uri_t api_ota_confirm_uri = {
             .uri = "/api/ota/confirm",
@@ -9982,7 +6318,7 @@ static esp_err_t start_webserver(void)
             .handler = api_ota_confirm_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_ota_confirm_uri);
+        web_admission_register(g_server, &api_ota_confirm_uri);
 
         httpd_uri_t api_ota_reboot_uri = {
             .uri = "/api/ota/reboot",
@@ -9990,12 +6326,55 @@ static esp_err_t start_webserver(void)
             .handler = api_ota_reboot_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(g_server, &api_ota_reboot_uri);
+        web_admission_register(g_server, &api_ota_reboot_uri);
         ESP_LOGI(TAG, "SUCCESS: OTA API endpoints registered (/api/ota/status, /api/ota/start, /api/ota/upload, /api/ota/cancel, /api/ota/confirm, /api/ota/reboot)");
 
+        // Firmware staged on SD for other gateways on the site (see ota_peer.h)
+        httpd_uri_t ota_peer_manifest_uri = {
+            .uri = "/ota/peer/manifest",
+            .method = HTTP_GET,
+            .handler = ota_peer_manifest_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &ota_peer_manifest_uri);
+
+        httpd_uri_t ota_peer_image_uri = {
+            .uri = "/ota/peer/image",
+            .method = HTTP_GET,
+            .handler = ota_peer_image_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &ota_peer_image_uri);
+
+        // Deferred log ring (see dlog.h)
+        httpd_uri_t api_log_uri = {
+            .uri = "/api/log",
+            .method = HTTP_GET,
+            .handler = dlog_http_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &api_log_uri);
+
+        // Latency histograms and event trace (see perf_trace.h)
+        httpd_uri_t api_perf_uri = {
+            .uri = "/api/perf",
+            .method = HTTP_GET,
+            .handler = perf_stats_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &api_perf_uri);
+
+        httpd_uri_t api_trace_uri = {
+            .uri = "/api/trace",
+            .method = HTTP_GET,
+            .handler = perf_trace_handler,
+            .user_ctx = NULL
+        };
+        web_admission_register(g_server, &api_trace_uri);
+
         ESP_LOGI(TAG, "Web server started on port 80");
         ESP_LOGI(TAG, "[NET] All URI handlers registered successfully (including Modbus Explorer endpoints)");
-        ESP_LOGI(TAG, "[CONFIG] Available endpoints: /, /save_config, /save_azure_config, /save_network_mode, /save_sim_config, /save_sd_config, /save_rtc_config, /test_sensor, /test_rs485, /start_operation, /scan_wifi, /live_data, /edit_sensor, /save_single_sensor, /delete_sensor, /api/system_status, /api/sim_test, /api/sd_status, /api/sd_clear, /api/sd_replay, /api/rtc_time, /api/rtc_sync, /api/rtc_set, /write_single_register, /write_multiple_registers, /modbus_scan, /modbus_read_live, /reboot, /watchdog_control, /gpio_trigger, /logo, /favicon.ico");
+        ESP_LOGI(TAG, "[CONFIG] Available endpoints: /, /styles.css, /app.js, /section/*, /api/config, /ws, /save_config, /save_azure_config, /save_network_mode, /save_sim_config, /save_sd_config, /save_rtc_config, /test_sensor, /test_rs485, /start_operation, /scan_wifi, /live_data, /edit_sensor, /save_single_sensor, /delete_sensor, /api/status, /api/system_status, /api/sim_test, /api/sd_status, /api/sd_clear, /api/sd_replay, /api/rtc_time, /api/rtc_sync, /api/rtc_set, /write_single_register, /write_multiple_registers, /modbus_scan, /modbus_read_live, /reboot, /watchdog_control, /gpio_trigger, /logo, /favicon.ico, /api/log, /api/perf, /api/trace");
         return ESP_OK;
     }
 
@@ -10284,6 +6663,15 @@ static esp_err_t save_sim_config_handler(httpd_req_t *req) {
     if ((param = strstr(buf, "sim_baud=")) != NULL) {
         sscanf(param, "sim_baud=%d", &g_system_config.sim_config.uart_baud_rate);
     }
+    if ((param = strstr(buf, "sim_rts_pin=")) != NULL) {
+        sscanf(param, "sim_rts_pin=%d", &g_system_config.modem_rts_pin);
+    }
+    if ((param = strstr(buf, "sim_cts_pin=")) != NULL) {
+        sscanf(param, "sim_cts_pin=%d", &g_system_config.modem_cts_pin);
+    }
+    if ((param = strstr(buf, "sim_ppp_baud=")) != NULL) {
+        sscanf(param, "sim_ppp_baud=%d", &g_system_config.modem_ppp_baud);
+    }
 
     g_system_config.sim_config.enabled = true;
     config_save_to_nvs(&g_system_config);
@@ -10442,6 +6830,192 @@ static esp_err_t api_modbus_poll_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// /api/modbus_dump output, flushed as a chunk whenever the buffer fills
+typedef struct {
+    httpd_req_t *req;
+    int slave;
+    int fc;                       // MODBUS_READ_HOLDING_REGISTERS or MODBUS_READ_INPUT_REGISTERS
+    bool csv;
+    bool first_block;
+    int len;
+    bool failed;                  // Client went away
+    char buf[1024];
+} modbus_dump_out_t;
+
+static void dump_flush(modbus_dump_out_t *out)
+{
+    if (out->len > 0 && !out->failed) {
+        out->failed = httpd_resp_send_chunk(out->req, out->buf, out->len) != ESP_OK;
+    }
+    out->len = 0;
+}
+
+static void dump_printf(modbus_dump_out_t *out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void dump_printf(modbus_dump_out_t *out, const char *fmt, ...)
+{
+    if (out->len > (int)sizeof(out->buf) - 96) {
+        dump_flush(out);
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out->buf + out->len, sizeof(out->buf) - out->len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        out->len += n < (int)sizeof(out->buf) - out->len ? n : (int)sizeof(out->buf) - out->len - 1;
+    }
+}
+
+static const char *dump_status(int result, char *buf, size_t size)
+{
+    switch (result) {
+        case MODBUS_SUCCESS: return "ok";
+        case MODBUS_TIMEOUT: return "timeout";
+        case MODBUS_INVALID_CRC: return "crc";
+        case MODBUS_INVALID_RESPONSE: return "invalid_response";
+        default:
+            snprintf(buf, size, "exception_%02X", result);
+            return buf;
+    }
+}
+
+// One block under the bus lock, so telemetry polling can run between blocks.
+// Quiet: per-frame logs would be hundreds of lines per dump.
+static int dump_read(void *ctx, uint16_t start, uint16_t count, uint16_t *values)
+{
+    const modbus_dump_out_t *out = ctx;
+    return modbus_read_registers(out->slave, out->fc, start, count, values, true);
+}
+
+static uint32_t dump_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static modbus_dump_out_t s_dump_out;   // httpd serves one request at a time
+
+static bool dump_emit(void *ctx, const modbus_dump_block_t *block, const uint16_t *values)
+{
+    modbus_dump_out_t *out = ctx;
+    char code[16];
+    const char *status = dump_status(block->result, code, sizeof(code));
+
+    if (out->csv) {
+        for (int i = 0; i < block->count; i++) {
+            if (values) {
+                dump_printf(out, "%u,%u,0x%04X,%s,%lu\n", block->start + i, values[i], values[i],
+                            status, (unsigned long)block->ms);
+            } else {
+                dump_printf(out, "%u,,,%s,%lu\n", block->start + i, status, (unsigned long)block->ms);
+            }
+        }
+    } else {
+        dump_printf(out, "%s{\"start\":%u,\"count\":%u,\"ms\":%lu,\"depth\":%u,\"status\":\"%s\"",
+                    out->first_block ? "" : ",", block->start, block->count,
+                    (unsigned long)block->ms, block->depth, status);
+        if (values) {
+            dump_printf(out, ",\"values\":[");
+            for (int i = 0; i < block->count; i++) {
+                dump_printf(out, "%s%u", i > 0 ? "," : "", values[i]);
+            }
+            dump_printf(out, "]");
+        }
+        dump_printf(out, "}");
+    }
+    out->first_block = false;
+    // One chunk per block so the browser sees progress on slow buses
+    dump_flush(out);
+    return !out->failed;
+}
+
+// Handler: /api/modbus_dump - Read a large register range in max-size blocks
+// GET ?slave=1&fc=3&start=0&count=1000[&format=csv][&block=125][&resolution=1]
+static esp_err_t api_modbus_dump_handler(httpd_req_t *req)
+{
+    char query[128];
+    char value[16];
+    int slave = 0, fc = MODBUS_READ_HOLDING_REGISTERS, start = 0, count = 0, block = MODBUS_DUMP_MAX_BLOCK;
+    int resolution = 1;           // Smallest hole span resolved exactly
+    bool csv = false;
+
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        if (httpd_query_key_value(query, "slave", value, sizeof(value)) == ESP_OK) slave = atoi(value);
+        if (httpd_query_key_value(query, "fc", value, sizeof(value)) == ESP_OK) fc = atoi(value);
+        if (httpd_query_key_value(query, "start", value, sizeof(value)) == ESP_OK) start = atoi(value);
+        if (httpd_query_key_value(query, "count", value, sizeof(value)) == ESP_OK) count = atoi(value);
+        if (httpd_query_key_value(query, "block", value, sizeof(value)) == ESP_OK) block = atoi(value);
+        if (httpd_query_key_value(query, "resolution", value, sizeof(value)) == ESP_OK) resolution = atoi(value);
+        if (httpd_query_key_value(query, "format", value, sizeof(value)) == ESP_OK) csv = strcmp(value, "csv") == 0;
+    }
+
+    if (slave < 1 || slave > 247 ||
+        (fc != MODBUS_READ_HOLDING_REGISTERS && fc != MODBUS_READ_INPUT_REGISTERS) ||
+        start < 0 || start > 65535 || count < 1 || count > MODBUS_DUMP_MAX_COUNT ||
+        block < 1 || block > MODBUS_DUMP_MAX_BLOCK || resolution < 1 || resolution > block) {
+        char resp[160];
+        snprintf(resp, sizeof(resp),
+                 "{\"status\":\"error\",\"message\":\"Need slave 1-247, fc 3 or 4, start 0-65535, count 1-%d, block 1-%d, resolution 1-block\"}",
+                 MODBUS_DUMP_MAX_COUNT, MODBUS_DUMP_MAX_BLOCK);
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_sendstr(req, resp);
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "[DUMP] Slave %d FC %02X: %d registers from %d in blocks of %d", slave, fc, count, start, block);
+
+    modbus_dump_out_t *out = &s_dump_out;
+    memset(out, 0, sizeof(*out));
+    out->req = req;
+    out->slave = slave;
+    out->fc = fc;
+    out->csv = csv;
+    out->first_block = true;
+
+    if (csv) {
+        char disposition[80];
+        snprintf(disposition, sizeof(disposition), "attachment; filename=\"modbus_s%d_fc%d_%d.csv\"", slave, fc, start);
+        httpd_resp_set_type(req, "text/csv");
+        httpd_resp_set_hdr(req, "Content-Disposition", disposition);
+        dump_printf(out, "address,value,hex,status,block_ms\n");
+    } else {
+        httpd_resp_set_type(req, "application/json");
+        dump_printf(out, "{\"slave\":%d,\"fc\":%d,\"start\":%d,\"count\":%d,\"blocks\":[", slave, fc, start, count);
+    }
+
+    modbus_dump_t dump = {
+        .read = dump_read,
+        .emit = dump_emit,
+        .now_ms = dump_now_ms,
+        .ctx = out,
+        .block = (uint16_t)block,
+        .min_split = (uint16_t)resolution
+    };
+    modbus_dump_stats_t stats;
+
+    modbus_dump_run(&dump, (uint16_t)start, (uint32_t)count, &stats);
+
+    ESP_LOGI(TAG, "[DUMP] %lu reads (%lu split), %lu ok, %lu failed, %lu ms%s",
+             (unsigned long)stats.reads, (unsigned long)stats.splits, (unsigned long)stats.registers_ok,
+             (unsigned long)stats.registers_failed, (unsigned long)stats.ms, stats.aborted ? " - aborted" : "");
+
+    if (out->failed) {
+        return ESP_FAIL;          // Client disconnected mid-dump
+    }
+    if (csv) {
+        dump_printf(out, "# reads=%lu splits=%lu ok=%lu failed=%lu ms=%lu aborted=%d\n",
+                    (unsigned long)stats.reads, (unsigned long)stats.splits, (unsigned long)stats.registers_ok,
+                    (unsigned long)stats.registers_failed, (unsigned long)stats.ms, stats.aborted);
+    } else {
+        dump_printf(out, "],\"summary\":{\"reads\":%lu,\"splits\":%lu,\"registers_ok\":%lu,"
+                    "\"registers_failed\":%lu,\"errors\":%lu,\"ms\":%lu,\"aborted\":%s}}",
+                    (unsigned long)stats.reads, (unsigned long)stats.splits, (unsigned long)stats.registers_ok,
+                    (unsigned long)stats.registers_failed, (unsigned long)stats.errors, (unsigned long)stats.ms,
+                    stats.aborted ? "true" : "false");
+    }
+    dump_flush(out);
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
 // Background task for SIM testing
 static void sim_test_task(void *pvParameters) {
     ESP_LOGI(TAG, "SIM test task started");
@@ -10456,7 +7030,10 @@ static void sim_test_task(void *pvParameters) {
         .rx_pin = g_system_config.sim_config.uart_rx_pin,
         .pwr_pin = g_system_config.sim_config.pwr_pin,
         .reset_pin = g_system_config.sim_config.reset_pin,
-        .baud_rate = g_system_config.sim_config.uart_baud_rate
+        .baud_rate = g_system_config.sim_config.uart_baud_rate,
+        .rts_pin = g_system_config.modem_rts_pin,
+        .cts_pin = g_system_config.modem_cts_pin,
+        .ppp_baud_rate = g_system_config.modem_ppp_baud
     };
 
     // Initialize modem
@@ -10536,6 +7113,9 @@ static void sim_test_task(void *pvParameters) {
             }
         }
         xSemaphoreGive(g_sim_test_mutex);
+        if (signal_ret == ESP_OK) {
+            gateway_status_set_sim_signal(signal.rssi_dbm, signal.quality, signal.operator_name);
+        }
     } else {
         // PPP connection failed - try to get signal anyway
         signal_strength_t signal;
@@ -10902,35 +7482,35 @@ static esp_err_t api_azure_status_handler(httpd_req_t *req) {
 }
 
 
+// /modbus_scan form fields
+typedef struct {
+    int start_id;
+    int end_id;
+    int test_register;
+    char reg_type[16];
+} modbus_scan_form_t;
+
+static const body_field_t modbus_scan_fields[] = {
+    BODY_FIELD("start_id", BODY_INT, modbus_scan_form_t, start_id, NULL),
+    BODY_FIELD("end_id", BODY_INT, modbus_scan_form_t, end_id, NULL),
+    BODY_FIELD("test_register", BODY_INT, modbus_scan_form_t, test_register, NULL),
+    BODY_FIELD("reg_type", BODY_STR, modbus_scan_form_t, reg_type, NULL),
+};
+static const body_table_t modbus_scan_table = {
+    modbus_scan_fields, sizeof(modbus_scan_fields) / sizeof(modbus_scan_fields[0]), NULL
+};
+
 // Modbus Explorer: Device Scanner Handler
 static esp_err_t modbus_scan_handler(httpd_req_t *req) {
     httpd_resp_set_type(req, "application/json");
 
-    char content[512];
-    int ret = httpd_req_recv(req, content, sizeof(content) - 1);
-    if (ret <= 0) {
+    modbus_scan_form_t scan = { .start_id = 1, .end_id = 10, .test_register = 0, .reg_type = "holding" };
+    if (parse_request_body(req, &modbus_scan_table, &scan, NULL) != ESP_OK) {
         httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Failed to receive request\"}");
         return ESP_FAIL;
     }
-    content[ret] = '\0';
-
-    // Parse parameters
-    int start_id = 1, end_id = 10, test_register = 0;
-    char reg_type[16] = "holding";
-
-    char *param = strstr(content, "start_id=");
-    if (param) start_id = atoi(param + 9);
-
-    param = strstr(content, "end_id=");
-    if (param) end_id = atoi(param + 7);
-
-    param = strstr(content, "test_register=");
-    if (param) test_register = atoi(param + 14);
-
-    param = strstr(content, "reg_type=");
-    if (param) {
-        sscanf(param + 9, "%15[^&]", reg_type);
-    }
+    int start_id = scan.start_id, end_id = scan.end_id, test_register = scan.test_register;
+    const char *reg_type = scan.reg_type;
 
     // Validate range
     if (start_id < 1 || start_id > 247 || end_id < 1 || end_id > 247 || start_id > end_id) {
@@ -11230,6 +7810,12 @@ typedef struct {
     int modbus_retry_count;    // Number of retries on failure (0-3)
     int modbus_retry_delay;    // Delay between retries in ms
     int device_twin_version;   // Track applied desired properties version
+    telemetry_encoding_t telemetry_encoding;  // Appended - older blobs load as JSON (0)
+    uint8_t telemetry_max_batch;              // Appended - older blobs load 0 -> default
+    int modem_rts_pin;                        // Appended - older blobs load 0 -> not wired
+    int modem_cts_pin;                        // Appended - older blobs load 0 -> not wired
+    int modem_ppp_baud;                       // Appended - older blobs load 0 -> keep UART baud
+    bool telemetry_route_by_type;             // Appended - older blobs load false -> mixed batches
 } core_config_t;
 
 esp_err_t config_load_from_nvs(system_config_t *config)
@@ -11279,6 +7865,14 @@ esp_err_t config_load_from_nvs(system_config_t *config)
         // Sanity check: device_twin_version should be reasonable (0 to 1 million)
         config->device_twin_version = (core.device_twin_version >= 0 && core.device_twin_version < 1000000)
                                       ? core.device_twin_version : 0;
+        config->telemetry_encoding = (core.telemetry_encoding == TELEMETRY_ENCODING_CBOR)
+                                     ? TELEMETRY_ENCODING_CBOR : TELEMETRY_ENCODING_JSON;
+        config->telemetry_max_batch = (core.telemetry_max_batch >= 1 && core.telemetry_max_batch <= 10)
+                                      ? core.telemetry_max_batch : TELEMETRY_DEFAULT_MAX_BATCH;
+        config->modem_rts_pin = core.modem_rts_pin > 0 ? core.modem_rts_pin : -1;
+        config->modem_cts_pin = core.modem_cts_pin > 0 ? core.modem_cts_pin : -1;
+        config->modem_ppp_baud = core.modem_ppp_baud > 0 ? core.modem_ppp_baud : 0;
+        config->telemetry_route_by_type = core.telemetry_route_by_type;
 
         // Load individual sensors
         for (int i = 0; i < config->sensor_count && i < 10; i++) {
@@ -11362,6 +7956,12 @@ esp_err_t config_save_to_nvs(const system_config_t *config)
     core.modbus_retry_count = config->modbus_retry_count;
     core.modbus_retry_delay = config->modbus_retry_delay;
     core.device_twin_version = config->device_twin_version;
+    core.telemetry_encoding = config->telemetry_encoding;
+    core.telemetry_max_batch = config->telemetry_max_batch;
+    core.modem_rts_pin = config->modem_rts_pin;
+    core.modem_cts_pin = config->modem_cts_pin;
+    core.modem_ppp_baud = config->modem_ppp_baud;
+    core.telemetry_route_by_type = config->telemetry_route_by_type;
 
     // Save core config (~700 bytes, well under NVS limit)
     err = nvs_set_blob(nvs_handle, "sys_core", &core, sizeof(core_config_t));
@@ -11499,6 +8099,9 @@ esp_err_t config_reset_to_defaults(void)
     g_system_config.sim_config.reset_pin = -1;  // Disabled by default - GPIO 15 used by SD card CS
     g_system_config.sim_config.uart_num = UART_NUM_1;
     g_system_config.sim_config.uart_baud_rate = 115200;
+    g_system_config.modem_rts_pin = -1;    // RTS/CTS not wired on the reference board
+    g_system_config.modem_cts_pin = -1;
+    g_system_config.modem_ppp_baud = 0;    // Stay at uart_baud_rate
 
     // SD Card defaults (VSPI configuration - avoids boot pin conflicts)
     g_system_config.sd_config.enabled = false;  // DISABLED by default - enable via web interface
@@ -11527,6 +8130,9 @@ esp_err_t config_reset_to_defaults(void)
 
     // Telemetry options
     g_system_config.batch_telemetry = true;  // Default: send all sensors in single JSON message
+    g_system_config.telemetry_encoding = TELEMETRY_ENCODING_JSON;  // Default: JSON (CBOR for SIM sites)
+    g_system_config.telemetry_max_batch = TELEMETRY_DEFAULT_MAX_BATCH;
+    g_system_config.telemetry_route_by_type = false;  // Default: mixed batches, as before routing properties
 
     // Modbus retry settings
     g_system_config.modbus_retry_count = 1;   // Default: 1 retry on failure
@@ -11715,7 +8321,9 @@ esp_err_t connect_to_wifi_network(void)
 esp_err_t web_config_stop(void)
 {
     if (g_server) {
+        web_push_stop();
         httpd_stop(g_server);
+        web_admission_reset();
         g_server = NULL;
         ESP_LOGI(TAG, "HTTP server stopped");
     }
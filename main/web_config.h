@@ -21,6 +21,12 @@ typedef enum {
     NETWORK_MODE_SIM         // Use SIM module (A7670C) connectivity
 } network_mode_t;
 
+// Telemetry payload encoding (see telemetry_codec.h)
+typedef enum {
+    TELEMETRY_ENCODING_JSON = 0,  // Verbose JSON (default, human readable)
+    TELEMETRY_ENCODING_CBOR       // Compact CBOR with integer keys (cellular links)
+} telemetry_encoding_t;
+
 // ============================================================================
 // CALCULATION ENGINE - User-friendly calculated fields for complex sensors
 // ============================================================================
@@ -183,7 +189,7 @@ typedef struct {
     char chat_id[32];         // Your Telegram chat ID (user or group)
     bool alerts_enabled;      // Enable/disable automatic alerts
     bool startup_notification; // Send notification on system startup
-    int poll_interval;        // Polling interval in seconds (default: 10)
+    int poll_interval;        // Retry delay after a failed poll in seconds (default: 10); polling is long polling
 } telegram_config_t;
 
 // System configuration
@@ -214,10 +220,16 @@ typedef struct {
     bool modem_reset_enabled;  // Enable/disable modem reset on MQTT disconnect
     int modem_boot_delay;      // Delay in seconds to wait for modem boot after reset
     int modem_reset_gpio_pin;  // GPIO pin for modem reset control
+    int modem_rts_pin;         // ESP32 RTS -> modem CTS for PPP flow control, <= 0 = not wired
+    int modem_cts_pin;         // ESP32 CTS <- modem RTS, <= 0 = not wired
+    int modem_ppp_baud;        // Baud switched to with AT+IPR before PPP, 0 = keep sim_config.uart_baud_rate
     int trigger_gpio_pin;      // GPIO pin for configuration mode trigger (default: 34)
 
     // Telemetry options
     bool batch_telemetry;      // Send all sensors in single JSON message (default: true)
+    telemetry_encoding_t telemetry_encoding;  // JSON or CBOR payloads (default: JSON)
+    uint8_t telemetry_max_batch;  // Max sensors per batch message (1-10, default: 10)
+    bool telemetry_route_by_type; // One sensor type per batch message (default: false = mixed)
 
     // Modbus retry settings
     int modbus_retry_count;    // Number of retries on failure (0-3, default: 1)
@@ -0,0 +1,351 @@
+/**
+ * web_push.c - Delta-encoded live status over /ws.
+ *
+ * See web_push.h for the wire format. Implementation notes:
+ *
+ * - All sends happen in the httpd task via httpd_queue_work(), as
+ *   httpd_ws_send_frame_async() requires. A FreeRTOS timer only queues the
+ *   work, and only while at least one client is connected.
+ * - Clients are tracked by socket fd. httpd closes WebSocket sockets on its
+ *   own (close frame, keep-alive failure), so stale fds are pruned by asking
+ *   httpd_ws_get_fd_info() before every push instead of hooking close_fn.
+ * - Every key is formatted to display precision into cur[]; a key is sent
+ *   when its text differs from sent[]. Reading a value never blocks: sensor
+ *   values come from the sensor_manager cache, not the RS485 bus.
+ */
+
+#include "web_push.h"
+#include "web_config.h"
+#include "sensor_manager.h"
+#include "modbus.h"
+#include "a7670c_ppp.h"
+#include "iot_configs.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+static const char *TAG = "WEB_PUSH";
+
+// Connection state owned by main.c (same externs as the /api/azure/status handler)
+extern volatile bool mqtt_connected;
+extern uint32_t total_telemetry_sent;
+extern uint32_t mqtt_reconnect_count;
+extern int64_t mqtt_connect_time;
+extern int64_t last_telemetry_time;
+
+typedef enum {
+    F_HEAP, F_HEAP_MIN, F_HEAP_INT, F_HEAP_BIG, F_HEAP_PCT, F_TASKS,
+    F_WIFI, F_RSSI, F_SSID, F_SIM, F_SIM_IP,
+    F_MB_TOTAL, F_MB_OK, F_MB_FAIL, F_MB_RATE, F_MB_CRC, F_MB_TO,
+    F_AZ, F_AZ_SINCE, F_AZ_MSGS, F_AZ_RC, F_AZ_LAST,
+    F_SENSOR0,
+    F_COUNT = F_SENSOR0 + SENSOR_LATEST_SLOTS
+} push_field_t;
+
+static const char *s_keys[F_SENSOR0] = {
+    "heap", "heap_min", "heap_int", "heap_big", "heap_pct", "tasks",
+    "wifi", "rssi", "ssid", "sim", "sim_ip",
+    "mb_total", "mb_ok", "mb_fail", "mb_rate", "mb_crc", "mb_to",
+    "az", "az_since", "az_msgs", "az_rc", "az_last",
+};
+
+#define PUSH_VALUE_LEN 48   // Longest value is a quoted SSID (32 chars + escapes)
+
+// A full message with every value at PUSH_VALUE_LEN: header, then per key a
+// comma, the quoted key (up to 8 chars), a colon and the value
+_Static_assert(WS_PUSH_MSG_SIZE >= 48 + F_COUNT * (PUSH_VALUE_LEN + 12),
+               "WS_PUSH_MSG_SIZE cannot hold a full-state message");
+
+typedef struct {
+    int fd;                 // -1 = free slot
+    bool need_full;
+} push_client_t;
+
+static httpd_handle_t s_server = NULL;
+static TimerHandle_t s_timer = NULL;
+static push_client_t s_clients[WS_PUSH_MAX_CLIENTS];
+static int s_client_count = 0;
+
+// Only touched from the httpd task
+static char s_cur[F_COUNT][PUSH_VALUE_LEN];
+static char s_sent[F_COUNT][PUSH_VALUE_LEN];
+static char s_msg[WS_PUSH_MSG_SIZE];
+
+static void json_string(char *out, size_t size, const char *str)
+{
+    size_t n = 0;
+    out[n++] = '"';
+    for (; *str && n + 3 < size; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            out[n++] = '\\';
+            out[n++] = c;
+        } else if (c >= 0x20) {
+            out[n++] = c;
+        }
+    }
+    out[n++] = '"';
+    out[n] = '\0';
+}
+
+static void collect_values(void)
+{
+    size_t free_heap = esp_get_free_heap_size();
+    size_t total_heap = heap_caps_get_total_size(MALLOC_CAP_DEFAULT);
+    snprintf(s_cur[F_HEAP], PUSH_VALUE_LEN, "%.1f", free_heap / 1024.0);
+    snprintf(s_cur[F_HEAP_MIN], PUSH_VALUE_LEN, "%.1f", esp_get_minimum_free_heap_size() / 1024.0);
+    snprintf(s_cur[F_HEAP_INT], PUSH_VALUE_LEN, "%.1f", heap_caps_get_free_size(MALLOC_CAP_INTERNAL) / 1024.0);
+    snprintf(s_cur[F_HEAP_BIG], PUSH_VALUE_LEN, "%.1f", heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT) / 1024.0);
+    snprintf(s_cur[F_HEAP_PCT], PUSH_VALUE_LEN, "%.1f",
+             total_heap ? (total_heap - free_heap) * 100.0 / total_heap : 0.0);
+    snprintf(s_cur[F_TASKS], PUSH_VALUE_LEN, "%u", (unsigned)uxTaskGetNumberOfTasks());
+
+    wifi_ap_record_t ap_info;
+    bool wifi_up = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+    snprintf(s_cur[F_WIFI], PUSH_VALUE_LEN, "%d", wifi_up);
+    snprintf(s_cur[F_RSSI], PUSH_VALUE_LEN, "%d", wifi_up ? ap_info.rssi : 0);
+    json_string(s_cur[F_SSID], PUSH_VALUE_LEN, wifi_up ? (const char *)ap_info.ssid : "N/A");
+
+    bool sim_up = a7670c_ppp_is_connected();
+    char sim_ip[32] = "N/A";
+    if (sim_up) {
+        a7670c_ppp_get_ip_info(sim_ip, sizeof(sim_ip));
+    }
+    snprintf(s_cur[F_SIM], PUSH_VALUE_LEN, "%d", sim_up);
+    json_string(s_cur[F_SIM_IP], PUSH_VALUE_LEN, sim_ip);
+
+    modbus_stats_t stats;
+    modbus_get_statistics(&stats);
+    snprintf(s_cur[F_MB_TOTAL], PUSH_VALUE_LEN, "%" PRIu32, stats.total_requests);
+    snprintf(s_cur[F_MB_OK], PUSH_VALUE_LEN, "%" PRIu32, stats.successful_requests);
+    snprintf(s_cur[F_MB_FAIL], PUSH_VALUE_LEN, "%" PRIu32, stats.failed_requests);
+    snprintf(s_cur[F_MB_RATE], PUSH_VALUE_LEN, "%.1f",
+             stats.total_requests ? stats.successful_requests * 100.0 / stats.total_requests : 0.0);
+    snprintf(s_cur[F_MB_CRC], PUSH_VALUE_LEN, "%" PRIu32, stats.crc_errors);
+    snprintf(s_cur[F_MB_TO], PUSH_VALUE_LEN, "%" PRIu32, stats.timeout_errors);
+
+    // Times are uptime seconds; the page derives "ago" from "t", so they only change on events
+    snprintf(s_cur[F_AZ], PUSH_VALUE_LEN, "%d", mqtt_connected ? 1 : 0);
+    snprintf(s_cur[F_AZ_SINCE], PUSH_VALUE_LEN, "%lld", mqtt_connected ? (long long)mqtt_connect_time : 0LL);
+    snprintf(s_cur[F_AZ_MSGS], PUSH_VALUE_LEN, "%" PRIu32, total_telemetry_sent);
+    snprintf(s_cur[F_AZ_RC], PUSH_VALUE_LEN, "%" PRIu32, mqtt_reconnect_count);
+    snprintf(s_cur[F_AZ_LAST], PUSH_VALUE_LEN, "%lld", (long long)last_telemetry_time);
+
+    for (int i = 0; i < SENSOR_LATEST_SLOTS; i++) {
+        sensor_latest_t latest;
+        sensor_latest_get(i, &latest);
+        if (latest.has_value && isfinite(latest.value)) {
+            snprintf(s_cur[F_SENSOR0 + i], PUSH_VALUE_LEN, "%.6g", latest.value);
+        } else {
+            strcpy(s_cur[F_SENSOR0 + i], "null");
+        }
+    }
+}
+
+// Builds {"t":..,["full":1,]"d":{..}} into s_msg; returns the length, 0 if
+// nothing changed or the message did not fit (nothing must be sent then)
+static size_t build_message(bool full)
+{
+    int len = snprintf(s_msg, sizeof(s_msg), "{\"t\":%lld,%s\"d\":{",
+                       (long long)(esp_timer_get_time() / 1000000), full ? "\"full\":1," : "");
+    bool any = false;
+
+    for (int f = 0; f < F_COUNT; f++) {
+        if (!full && strcmp(s_cur[f], s_sent[f]) == 0) {
+            continue;
+        }
+        char sensor_key[8];
+        const char *key = s_keys[f];
+        if (f >= F_SENSOR0) {
+            snprintf(sensor_key, sizeof(sensor_key), "s%d", f - F_SENSOR0);
+            key = sensor_key;
+        }
+        len += snprintf(s_msg + len, sizeof(s_msg) - len, "%s\"%s\":%s", any ? "," : "", key, s_cur[f]);
+        any = true;
+        if (len >= (int)sizeof(s_msg) - 2) {
+            ESP_LOGW(TAG, "Push message truncated - raise WS_PUSH_MSG_SIZE");
+            return 0;
+        }
+    }
+    if (!any && !full) {
+        return 0;
+    }
+    len += snprintf(s_msg + len, sizeof(s_msg) - len, "}}");
+    return (size_t)len;
+}
+
+static void remove_client(int slot)
+{
+    ESP_LOGI(TAG, "Client fd=%d left (%d connected)", s_clients[slot].fd, s_client_count - 1);
+    s_clients[slot].fd = -1;
+    s_client_count--;
+}
+
+static void send_to(int slot, size_t len)
+{
+    httpd_ws_frame_t frame = {
+        .type = HTTPD_WS_TYPE_TEXT,
+        .payload = (uint8_t *)s_msg,
+        .len = len,
+    };
+    if (httpd_ws_send_frame_async(s_server, s_clients[slot].fd, &frame) != ESP_OK) {
+        remove_client(slot);
+    }
+}
+
+// Runs in the httpd task
+static void push_work(void *arg)
+{
+    if (s_server == NULL) {
+        return;
+    }
+
+    bool any_full = false;
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+        if (s_clients[i].fd < 0) {
+            continue;
+        }
+        if (httpd_ws_get_fd_info(s_server, s_clients[i].fd) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            remove_client(i);
+            continue;
+        }
+        any_full |= s_clients[i].need_full;
+    }
+    if (s_client_count == 0) {
+        xTimerStop(s_timer, 0);
+        return;
+    }
+
+    collect_values();
+
+    // Delta first for up-to-date clients (against what they were last sent)...
+    size_t len = build_message(false);
+    if (len > 0) {
+        for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd >= 0 && !s_clients[i].need_full) {
+                send_to(i, len);
+            }
+        }
+    }
+    // ...then everything for new or resyncing clients. A message that did not
+    // fit is not sent: need_full stays set and the next push tries again.
+    if (any_full) {
+        len = build_message(true);
+        if (len > 0) {
+            for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+                if (s_clients[i].fd >= 0 && s_clients[i].need_full) {
+                    s_clients[i].need_full = false;
+                    send_to(i, len);
+                }
+            }
+        }
+    }
+    memcpy(s_sent, s_cur, sizeof(s_sent));
+}
+
+static void push_timer_cb(TimerHandle_t timer)
+{
+    httpd_handle_t server = s_server;
+    if (server != NULL) {
+        httpd_queue_work(server, push_work, NULL);
+    }
+}
+
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    int fd = httpd_req_to_sockfd(req);
+
+    if (req->method == HTTP_GET) {
+        // Handshake done - track the socket and send the full state on the next push
+        for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd < 0) {
+                s_clients[i].fd = fd;
+                s_clients[i].need_full = true;
+                s_client_count++;
+                ESP_LOGI(TAG, "Client fd=%d joined (%d connected)", fd, s_client_count);
+                xTimerStart(s_timer, 0);
+                httpd_queue_work(req->handle, push_work, NULL);
+                return ESP_OK;
+            }
+        }
+        ESP_LOGW(TAG, "Rejecting fd=%d - %d clients already connected", fd, WS_PUSH_MAX_CLIENTS);
+        return ESP_FAIL;  // httpd closes the socket
+    }
+
+    // Only short text commands are expected from the page
+    uint8_t buf[16] = {0};
+    httpd_ws_frame_t frame = { .payload = buf };
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (frame.len >= sizeof(buf)) {
+        return ESP_FAIL;
+    }
+    if (frame.len > 0) {
+        ret = httpd_ws_recv_frame(req, &frame, frame.len);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    if (frame.type == HTTPD_WS_TYPE_TEXT && strcmp((char *)buf, "full") == 0) {
+        for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+            if (s_clients[i].fd == fd) {
+                s_clients[i].need_full = true;
+            }
+        }
+        httpd_queue_work(req->handle, push_work, NULL);
+    }
+    return ESP_OK;
+}
+
+esp_err_t web_push_register(httpd_handle_t server)
+{
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+        s_clients[i].fd = -1;
+    }
+    s_client_count = 0;
+    memset(s_sent, 0, sizeof(s_sent));
+
+    if (s_timer == NULL) {
+        s_timer = xTimerCreate("ws_push", pdMS_TO_TICKS(WS_PUSH_INTERVAL_MS), pdTRUE, NULL, push_timer_cb);
+        if (s_timer == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    httpd_uri_t ws_uri = {
+        .uri = "/ws",
+        .method = HTTP_GET,
+        .handler = ws_handler,
+        .user_ctx = NULL,
+        .is_websocket = true
+    };
+    esp_err_t ret = httpd_register_uri_handler(server, &ws_uri);
+    if (ret == ESP_OK) {
+        s_server = server;
+    }
+    return ret;
+}
+
+void web_push_stop(void)
+{
+    s_server = NULL;
+    if (s_timer != NULL) {
+        xTimerStop(s_timer, pdMS_TO_TICKS(100));
+    }
+    for (int i = 0; i < WS_PUSH_MAX_CLIENTS; i++) {
+        s_clients[i].fd = -1;
+    }
+    s_client_count = 0;
+}
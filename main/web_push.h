@@ -0,0 +1,42 @@
+/**
+ * web_push.h - Live status over a WebSocket (/ws) on the portal's httpd.
+ *
+ * Replaces the portal's 5-second polling of /api/system_status,
+ * /api/modbus/status and /api/azure/status. Each browser keeps one socket
+ * open; once per WS_PUSH_INTERVAL_MS the current values (Modbus stats, heap,
+ * link state, last telemetry, latest sensor readings) are compared with what
+ * was last sent and only the changed keys go out:
+ *
+ *   {"t":<uptime s>,"full":1,"d":{...every key...}}   first message / resync
+ *   {"t":<uptime s>,"d":{"heap":61.2,"s0":12.5}}       afterwards
+ *
+ * Values are pre-rounded to what the page displays, so noise below display
+ * precision does not generate traffic. A client can send "full" to resync.
+ */
+
+#ifndef WEB_PUSH_H
+#define WEB_PUSH_H
+
+#include "esp_err.h"
+#include "esp_http_server.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Register the /ws handler on a freshly started server and start the push
+ * timer. Call from start_webserver() after httpd_start().
+ */
+esp_err_t web_push_register(httpd_handle_t server);
+
+/**
+ * Forget all clients. Call before httpd_stop() - the sockets go with it.
+ */
+void web_push_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEB_PUSH_H
@@ -1,15 +1,21 @@
 /**
- * web_wake.c - Wake-on-ICMP + idle-shutdown for the operational-mode web server.
+ * web_wake.c - Wake-on-traffic + idle-shutdown for the operational-mode web server.
  *
  * See web_wake.h for the rationale. Implementation notes:
  *
- * - Raw ICMP socket: SOCK_RAW + IPPROTO_ICMP gets a copy of every inbound
- *   ICMP packet. lwIP's normal ICMP stack still replies to echo requests,
+ * - lwIP input hook: web_wake_ip4_input_hook() sees every inbound IPv4
+ *   packet in the tcpip thread before lwIP processes it, including packets
+ *   decrypted from the WireGuard tunnel. It only reads headers and sets
+ *   event bits; lwIP's normal ICMP stack still replies to echo requests,
  *   so `ping` keeps working unchanged.
- * - Source-IP filter: we only wake on echo requests from the VPN subnet
- *   (default 10.100.0.0/24). Pings from local LAN are ignored.
+ * - Source-IP filter: ICMP and SYN only wake on traffic from the VPN subnet
+ *   (default 10.100.0.0/24). Pings from local LAN are ignored. A WoL magic
+ *   packet names this gateway's MAC, so it is accepted from anywhere.
+ * - A SYN to port 80 while the server is down is dropped, not answered with
+ *   RST, for WAKE_SYN_HOLD_MS. The client retransmits it (browsers after 1s,
+ *   lwIP clients after 3s) and connects to the freshly started server.
  * - Activity is anything: an inbound VPN ping, or any TCP session opened
- *   on the httpd. Both reset last_activity_us; the idle watchdog stops the
+ *   on the httpd. Both reset last_activity_us; the idle check stops the
  *   server only after WAKE_IDLE_TIMEOUT_SEC of total silence.
  * - A mutex serializes start/stop so we don't fight the GPIO34 button or
  *   Device Twin web_server_enabled toggles (CLAUDE.md known race).
@@ -17,15 +23,20 @@
 
 #include "web_wake.h"
 #include "web_config.h"
+#include "lwip_hooks.h"
 
 #include "esp_log.h"
+#include "esp_mac.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/timers.h"
 #include "freertos/semphr.h"
 
-#include "lwip/sockets.h"
+#include "lwip/pbuf.h"
+#include "lwip/prot/ip.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/icmp.h"
+#include "lwip/prot/tcp.h"
 #include "lwip/inet.h"
 
 #include <string.h>
@@ -39,15 +50,19 @@ extern void start_web_server(void);
 extern void stop_web_server(void);
 
 static volatile int64_t s_last_activity_us = 0;
+static volatile int64_t s_wake_requested_us = 0;   // Last wake event, for the SYN hold
+static volatile uint32_t s_wake_src_be = 0;        // Its source address
+static int64_t s_last_idle_check_us = 0;
 static SemaphoreHandle_t s_lock = NULL;
-static TimerHandle_t s_idle_timer = NULL;
-static TaskHandle_t s_listener_task = NULL;
-static bool s_initialized = false;
+static EventGroupHandle_t s_events = NULL;
+static volatile bool s_initialized = false;
 
 // VPN subnet match: incoming src AND mask == network
 static uint32_t s_vpn_network_be = 0;   // network-byte-order
 static uint32_t s_vpn_mask_be = 0;
 
+static uint8_t s_mac[6];                // WoL target (WiFi STA MAC)
+
 static inline void mark_activity(void)
 {
     s_last_activity_us = esp_timer_get_time();
@@ -69,9 +84,8 @@ static void wake_server_if_down(const char *reason)
     mark_activity();
 }
 
-static void idle_watchdog_cb(TimerHandle_t xTimer)
+static void idle_check(void)
 {
-    (void)xTimer;
     if (!server_is_up()) return;
 
     int64_t idle_us = esp_timer_get_time() - s_last_activity_us;
@@ -95,63 +109,118 @@ esp_err_t web_wake_session_open(httpd_handle_t hd, int sockfd)
     return ESP_OK;
 }
 
-static void icmp_listener_task(void *pv)
+// 6 x 0xFF followed by the target MAC 16 times
+static bool is_wol_magic(const uint8_t *data, size_t len)
 {
-    (void)pv;
+    if (len < 102) return false;
+    for (int i = 0; i < 6; i++) {
+        if (data[i] != 0xFF) return false;
+    }
+    for (int i = 0; i < 16; i++) {
+        if (memcmp(data + 6 + i * 6, s_mac, 6) != 0) return false;
+    }
+    return true;
+}
 
-    int sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
-    if (sock < 0) {
-        ESP_LOGE(TAG, "raw ICMP socket failed: errno=%d (LWIP_RAW must be enabled)", errno);
-        s_listener_task = NULL;
-        vTaskDelete(NULL);
-        return;
+// Runs in the tcpip thread — no blocking, no logging
+static void signal_wake(EventBits_t bit, uint32_t src_be)
+{
+    int64_t now = esp_timer_get_time();
+    if (now - s_wake_requested_us >= (int64_t)WAKE_SYN_HOLD_MS * 1000) {
+        s_wake_requested_us = now;
+        s_wake_src_be = src_be;
     }
-    ESP_LOGI(TAG, "ICMP listener up — waking on echo from %s/%d",
-             WAKE_VPN_SUBNET, WAKE_VPN_PREFIX_LEN);
-
-    uint8_t buf[128];
-    while (true) {
-        struct sockaddr_in src;
-        socklen_t slen = sizeof(src);
-        int n = recvfrom(sock, buf, sizeof(buf), 0, (struct sockaddr *)&src, &slen);
-        if (n < 1) {
-            vTaskDelay(pdMS_TO_TICKS(50));
-            continue;
+    xEventGroupSetBits(s_events, bit);
+}
+
+int web_wake_ip4_input_hook(struct pbuf *p, struct netif *inp)
+{
+    (void)inp;
+    if (!s_initialized || p->len < IP_HLEN) return 0;
+
+    const struct ip_hdr *iph = (const struct ip_hdr *)p->payload;
+    uint16_t ihl = IPH_HL_BYTES(iph);
+    if (IPH_V(iph) != 4 || ihl < IP_HLEN || p->len < ihl) return 0;
+    if ((IPH_OFFSET(iph) & PP_HTONS(IP_OFFMASK | IP_MF)) != 0) return 0;   // Fragments
+
+    const uint8_t *l4 = (const uint8_t *)p->payload + ihl;
+    size_t avail = p->len - ihl;
+    uint32_t src_be = iph->src.addr;
+    bool from_vpn = (src_be & s_vpn_mask_be) == s_vpn_network_be;
+
+    switch (IPH_PROTO(iph)) {
+    case IP_PROTO_ICMP:
+        if (from_vpn && avail >= 1 && l4[0] == ICMP_ECHO) {
+            if (server_is_up()) {
+                // Server already up — count the ping as activity so the user
+                // can keep it alive with periodic pings if the UI is idle.
+                mark_activity();
+            } else {
+                signal_wake(WAKE_EVT_ICMP, src_be);
+            }
         }
+        return 0;
 
-        // First byte of the ICMP payload (lwIP raw ICMP socket strips IP header).
-        // Some lwIP builds deliver the IP header too — accept either layout.
-        uint8_t icmp_type;
-        if (n >= 20 && (buf[0] >> 4) == 4) {
-            // IPv4 header included: ICMP type at offset = ip_ihl * 4
-            int ihl = (buf[0] & 0x0F) * 4;
-            if (n < ihl + 1) continue;
-            icmp_type = buf[ihl];
-        } else {
-            icmp_type = buf[0];
+    case IP_PROTO_TCP:
+        if (from_vpn && avail >= TCP_HLEN && !server_is_up()) {
+            uint16_t dport = (uint16_t)((l4[2] << 8) | l4[3]);
+            uint8_t flags = l4[13];
+            if (dport == WAKE_HTTP_PORT && (flags & (TCP_SYN | TCP_ACK)) == TCP_SYN) {
+                signal_wake(WAKE_EVT_SYN, src_be);
+                if (esp_timer_get_time() - s_wake_requested_us < (int64_t)WAKE_SYN_HOLD_MS * 1000) {
+                    pbuf_free(p);
+                    return 1;
+                }
+            }
         }
-        if (icmp_type != 8) continue;   // 8 = echo request
+        return 0;
 
-        // Source-IP filter (network-byte-order compare)
-        if ((src.sin_addr.s_addr & s_vpn_mask_be) != s_vpn_network_be) {
-            continue;
+    case IP_PROTO_UDP:
+        if (WAKE_UDP_PORT != 0 && avail >= 8 + 102 && !server_is_up()) {
+            uint16_t dport = (uint16_t)((l4[2] << 8) | l4[3]);
+            if (dport == WAKE_UDP_PORT && is_wol_magic(l4 + 8, avail - 8)) {
+                signal_wake(WAKE_EVT_UDP, src_be);
+            }
         }
+        return 0;
 
+    default:
+        return 0;
+    }
+}
+
+void web_wake_wait(TickType_t timeout)
+{
+    if (!s_initialized) {
+        vTaskDelay(timeout);
+        return;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(s_events, WAKE_EVT_ALL, pdTRUE, pdFALSE, timeout);
+    if (bits & WAKE_EVT_ALL) {
+        struct in_addr src = { .s_addr = s_wake_src_be };
         char ipstr[INET_ADDRSTRLEN];
-        inet_ntoa_r(src.sin_addr, ipstr, sizeof(ipstr));
-
-        if (!server_is_up()) {
-            char reason[48];
-            snprintf(reason, sizeof(reason), "ICMP from %s", ipstr);
-            wake_server_if_down(reason);
-        } else {
-            // Server already up — count the ping as activity so the user
-            // can keep it alive with periodic pings if the UI is idle.
-            mark_activity();
-        }
+        inet_ntoa_r(src, ipstr, sizeof(ipstr));
+
+        char reason[48];
+        snprintf(reason, sizeof(reason), "%s from %s",
+                 (bits & WAKE_EVT_SYN) ? "HTTP SYN" : (bits & WAKE_EVT_ICMP) ? "ICMP" : "WoL packet",
+                 ipstr);
+        wake_server_if_down(reason);
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (now - s_last_idle_check_us >= (int64_t)WAKE_CHECK_PERIOD_SEC * 1000000LL) {
+        s_last_idle_check_us = now;
+        idle_check();
     }
 }
 
+EventGroupHandle_t web_wake_events(void)
+{
+    return s_events;
+}
+
 esp_err_t web_wake_init(void)
 {
     if (s_initialized) {
@@ -160,7 +229,8 @@ esp_err_t web_wake_init(void)
     }
 
     s_lock = xSemaphoreCreateMutex();
-    if (!s_lock) return ESP_ERR_NO_MEM;
+    s_events = xEventGroupCreate();
+    if (!s_lock || !s_events) return ESP_ERR_NO_MEM;
 
     // Pre-compute VPN subnet match in network byte order
     struct in_addr net;
@@ -174,29 +244,13 @@ esp_err_t web_wake_init(void)
     s_vpn_mask_be = htonl(mask_host);
     s_vpn_network_be = net.s_addr & s_vpn_mask_be;
 
-    mark_activity();   // grace period: don't auto-stop in the first 30 min after boot
+    esp_read_mac(s_mac, ESP_MAC_WIFI_STA);
 
-    s_idle_timer = xTimerCreate(
-        "web_wake_idle",
-        pdMS_TO_TICKS(WAKE_CHECK_PERIOD_SEC * 1000),
-        pdTRUE,    // auto-reload
-        NULL,
-        idle_watchdog_cb);
-    if (!s_idle_timer || xTimerStart(s_idle_timer, 0) != pdPASS) {
-        ESP_LOGE(TAG, "idle timer create/start failed");
-        return ESP_FAIL;
-    }
-
-    BaseType_t ok = xTaskCreate(
-        icmp_listener_task, "web_wake_icmp",
-        WAKE_TASK_STACK, NULL, WAKE_TASK_PRIORITY, &s_listener_task);
-    if (ok != pdPASS) {
-        ESP_LOGE(TAG, "ICMP listener task create failed");
-        return ESP_ERR_NO_MEM;
-    }
+    mark_activity();   // grace period: don't auto-stop in the first 30 min after boot
+    s_last_idle_check_us = esp_timer_get_time();
 
-    s_initialized = true;
-    ESP_LOGI(TAG, "wake-on-ICMP + %d-min idle shutdown active",
-             WAKE_IDLE_TIMEOUT_SEC / 60);
+    s_initialized = true;   // Arms the input hook
+    ESP_LOGI(TAG, "wake on ICMP / HTTP SYN from %s/%d, WoL on UDP %d + %d-min idle shutdown active",
+             WAKE_VPN_SUBNET, WAKE_VPN_PREFIX_LEN, WAKE_UDP_PORT, WAKE_IDLE_TIMEOUT_SEC / 60);
     return ESP_OK;
 }
@@ -3,11 +3,20 @@
  *
  * In operational mode the web server is OFF by default to save heap and
  * shrink attack surface. This module:
- *   1) Listens for ICMP echo requests from VPN peers (10.100.0.0/24) and
- *      starts the web server when one arrives.
+ *   1) Watches inbound IPv4 traffic from an lwIP input hook and starts the
+ *      web server on:
+ *        - ICMP echo requests from VPN peers (10.100.0.0/24)
+ *        - TCP SYNs to port 80 from VPN peers; the SYN is held back so the
+ *          client's retransmit reaches the server once it listens
+ *        - Wake-on-LAN magic packets for this gateway's MAC on
+ *          WAKE_UDP_PORT, from any source
  *   2) Tracks HTTP activity via httpd's open_fn callback.
  *   3) Stops the server after WAKE_IDLE_TIMEOUT_SEC seconds of inactivity.
  *
+ * The hook only sets bits in an event group; the main loop waits on it in
+ * web_wake_wait() and runs the start/stop there, so there is no listener
+ * task or socket.
+ *
  * Setup mode (CONFIG_STATE_SETUP) bypasses this — server is auto-started
  * unconditionally there. Caller must skip web_wake_init() in setup mode.
  */
@@ -17,6 +26,8 @@
 
 #include "esp_err.h"
 #include "esp_http_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,16 +37,35 @@ extern "C" {
 #define WAKE_CHECK_PERIOD_SEC   60          // idle watchdog tick
 #define WAKE_VPN_SUBNET         "10.100.0.0"
 #define WAKE_VPN_PREFIX_LEN     24          // /24 -> match 10.100.0.x
-#define WAKE_TASK_STACK         8192
-#define WAKE_TASK_PRIORITY      4
+#define WAKE_HTTP_PORT          80          // SYNs to this port wake the server
+#define WAKE_SYN_HOLD_MS        10000       // SYNs dropped this long after a wake while the server starts
+#define WAKE_UDP_PORT           9           // Wake-on-LAN (discard port); 0 disables
+
+// Event group bits (web_wake_events())
+#define WAKE_EVT_ICMP           BIT0
+#define WAKE_EVT_SYN            BIT1
+#define WAKE_EVT_UDP            BIT2
+#define WAKE_EVT_ALL            (WAKE_EVT_ICMP | WAKE_EVT_SYN | WAKE_EVT_UDP)
 
 /**
- * Start raw ICMP listener task + idle watchdog timer.
+ * Arm the lwIP input hook and create the event group.
  * Idempotent — second call is a no-op.
  * Skip in CONFIG_STATE_SETUP (server is already auto-started there).
  */
 esp_err_t web_wake_init(void);
 
+/**
+ * Block for up to timeout waiting for a wake event; start the web server if
+ * one arrived, and stop it when idle. Called by the main loop in place of its
+ * delay. Before web_wake_init() it is a plain delay.
+ */
+void web_wake_wait(TickType_t timeout);
+
+/**
+ * Wake event group, NULL before web_wake_init()
+ */
+EventGroupHandle_t web_wake_events(void);
+
 /**
  * httpd open_fn callback. Wire into web_config.c's start_webserver()
  * via `config.open_fn = web_wake_session_open;` before httpd_start().
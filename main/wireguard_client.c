@@ -2,6 +2,8 @@
 // Adapted from /Users/admin/Downloads/esp32-wireguard reference (advanced firmware).
 
 #include <string.h>
+#include <strings.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
@@ -32,6 +34,8 @@
 
 #include "wireguard_client.h"
 #include "web_config.h"  // for web_config_get_server() lazy handler registration
+#include "body_parser.h"
+#include "net_cache.h"
 
 static const char *TAG = "WG_CLIENT";
 
@@ -53,6 +57,15 @@ static const char *TAG = "WG_CLIENT";
 #define COORD_PEERS_URL         "http://10.100.0.1:3200/wg/api/coord/peers"
 #define COORD_ENDPOINTS_URL     "http://10.100.0.1:3200/wg/api/coord/endpoints"
 #define P2P_POLL_MS             30000
+#define P2P_LONG_POLL_S         25        // "wait" sent with the peer poll; servers that support it hold the request
+#define P2P_REPORT_REFRESH_MS   (10 * 60 * 1000)  // Unchanged LAN/IPv6 endpoint re-reported this often
+
+// Full registration (HTTPS, new TLS session) is only repeated while the tunnel
+// is healthy as a slow check. A deleted peer stops handshaking, so the tunnel
+// going down is what triggers a prompt re-check.
+#define WG_VERIFY_HEALTHY_MS    (30 * 60 * 1000)
+#define WG_VERIFY_DOWN_TICKS    3         // First verify after 3 down ticks (30s), then backing off
+#define WG_VERIFY_DOWN_MAX_TICKS 30       // ...to at most every 5 min while it stays down
 
 // ── Identity (loaded from NVS or assigned by server) ─────────────────
 static char s_device_name[32]   = {0};
@@ -68,12 +81,9 @@ static bool s_restart_pending   = false;  // deferred esp_restart() until web se
 // P2P direct peer tracking
 static uint8_t s_direct_peer_idx[P2P_MAX_DIRECT_PEERS];
 static char    s_direct_peer_ip[P2P_MAX_DIRECT_PEERS][20];
+static char    s_direct_peer_lan[P2P_MAX_DIRECT_PEERS][20];   // LAN address if the peer reported one
 static int     s_direct_peer_count = 0;
 
-// Separate HTTP response buffer for p2p_discovery_task — avoids races with keepalive's s_http_buf
-static char s_p2p_buf[2048];
-static int  s_p2p_buf_len = 0;
-
 static wireguard_config_t s_wg_config = ESP_WIREGUARD_CONFIG_DEFAULT();
 static wireguard_ctx_t    s_wg_ctx    = {0};
 
@@ -102,19 +112,6 @@ static esp_err_t http_event_handler(esp_http_client_event_t *evt)
     return ESP_OK;
 }
 
-static esp_err_t p2p_http_event_handler(esp_http_client_event_t *evt)
-{
-    if (evt->event_id == HTTP_EVENT_ON_DATA && evt->data_len > 0) {
-        int space = (int)sizeof(s_p2p_buf) - s_p2p_buf_len - 1;
-        if (space <= 0) return ESP_OK;
-        int copy = evt->data_len < space ? evt->data_len : space;
-        memcpy(s_p2p_buf + s_p2p_buf_len, evt->data, copy);
-        s_p2p_buf_len += copy;
-        s_p2p_buf[s_p2p_buf_len] = '\0';
-    }
-    return ESP_OK;
-}
-
 // ── Curve25519 key generation ────────────────────────────────────────
 static void generate_wg_keys(void)
 {
@@ -212,7 +209,10 @@ static reg_result_t try_register_url(const char *url, const char *body, bool use
     s_http_buf_len = 0;
     s_http_buf[0]  = '\0';
 
-    esp_http_client_handle_t client = esp_http_client_init(&cfg);
+    // HTTPS goes through the pool so re-verification resumes the TLS session;
+    // the plain-HTTP fallback is a one-off client
+    esp_http_client_handle_t client = use_tls ? net_pool_acquire(NET_POOL_COORD, &cfg)
+                                              : esp_http_client_init(&cfg);
     if (!client) {
         ESP_LOGE(TAG, "http_client_init failed for %s", url);
         return REG_NET_ERR;
@@ -222,7 +222,11 @@ static reg_result_t try_register_url(const char *url, const char *body, bool use
 
     esp_err_t err = esp_http_client_perform(client);
     int status    = esp_http_client_get_status_code(client);
-    esp_http_client_cleanup(client);
+    if (use_tls) {
+        net_pool_release(NET_POOL_COORD, client, err == ESP_OK);
+    } else {
+        esp_http_client_cleanup(client);
+    }
 
     if (err != ESP_OK) {
         // Socket/TLS failure — NOT a server rejection, keep existing NVS identity
@@ -473,208 +477,295 @@ static bool get_lan_ip(char *out, size_t out_size)
     return false;
 }
 
-static void p2p_discovery_task(void *arg)
+// ── Peer list parsing ────────────────────────────────────────────────
+// coord/peers answers with a JSON array of peers, bare or as {"peers":[...]}.
+// The body is streamed through body_parser (wrapped in {"r": ... } so both
+// shapes have an object root) one HTTP chunk at a time; each peer is applied
+// as soon as the next one starts, so no response buffer is needed.
+typedef struct {
+    char public_key[48];
+    char allowed_ip[20];      // VPN IP of the peer, e.g. 10.100.0.X
+    char lan_ip[20];
+    char endpoint[64];
+    char preshared_key[48];
+    bool online;
+} p2p_peer_t;
+
+static const body_field_t s_p2p_fields[] = {
+    BODY_FIELD("r_#_public_key",          BODY_STR,  p2p_peer_t, public_key,    NULL),
+    BODY_FIELD("r_#_allowed_ip",          BODY_STR,  p2p_peer_t, allowed_ip,    NULL),
+    BODY_FIELD("r_#_lan_ip",              BODY_STR,  p2p_peer_t, lan_ip,        NULL),
+    BODY_FIELD("r_#_endpoint",            BODY_STR,  p2p_peer_t, endpoint,      NULL),
+    BODY_FIELD("r_#_preshared_key",       BODY_STR,  p2p_peer_t, preshared_key, NULL),
+    BODY_FIELD("r_#_online",              BODY_BOOL, p2p_peer_t, online,        NULL),
+    BODY_FIELD("r_peers_#_public_key",    BODY_STR,  p2p_peer_t, public_key,    NULL),
+    BODY_FIELD("r_peers_#_allowed_ip",    BODY_STR,  p2p_peer_t, allowed_ip,    NULL),
+    BODY_FIELD("r_peers_#_lan_ip",        BODY_STR,  p2p_peer_t, lan_ip,        NULL),
+    BODY_FIELD("r_peers_#_endpoint",      BODY_STR,  p2p_peer_t, endpoint,      NULL),
+    BODY_FIELD("r_peers_#_preshared_key", BODY_STR,  p2p_peer_t, preshared_key, NULL),
+    BODY_FIELD("r_peers_#_online",        BODY_BOOL, p2p_peer_t, online,        NULL),
+};
+
+static void *p2p_resolve(void *ctx, const int *idx, int n_idx);
+
+static const body_table_t s_p2p_table = {
+    .fields = s_p2p_fields,
+    .count = sizeof(s_p2p_fields) / sizeof(s_p2p_fields[0]),
+    .resolve = p2p_resolve,
+};
+
+static body_parser_t s_p2p_parser;
+static p2p_peer_t    s_p2p_peer;              // Peer being parsed
+static int           s_p2p_peer_idx = -1;     // Its array index, -1 = none yet
+static bool          s_p2p_parsing = false;   // A coord/peers response is being received
+static char          s_peers_etag[64];        // ETag of the last peer list applied
+static char          s_peers_etag_new[64];
+
+// Persistent keep-alive connection to the coord server, shared by the peer
+// poll and the endpoint report. Dropped on any error and reopened next poll.
+static esp_http_client_handle_t s_coord_client = NULL;
+
+static esp_err_t p2p_http_event_handler(esp_http_client_event_t *evt)
 {
-    for (int i = 0; i < P2P_MAX_DIRECT_PEERS; i++) {
-        s_direct_peer_idx[i] = WIREGUARDIF_INVALID_INDEX;
-        s_direct_peer_ip[i][0] = '\0';
+    if (!s_p2p_parsing) return ESP_OK;
+    if (evt->event_id == HTTP_EVENT_ON_HEADER && strcasecmp(evt->header_key, "ETag") == 0) {
+        strncpy(s_peers_etag_new, evt->header_value, sizeof(s_peers_etag_new) - 1);
+        s_peers_etag_new[sizeof(s_peers_etag_new) - 1] = '\0';
+    } else if (evt->event_id == HTTP_EVENT_ON_DATA && evt->data_len > 0) {
+        int status = esp_http_client_get_status_code(evt->client);
+        if (status == 200 || status == 201) {
+            body_parser_feed(&s_p2p_parser, evt->data, evt->data_len);
+        }
     }
+    return ESP_OK;
+}
 
-    // Let the tunnel stabilise before starting peer discovery
-    vTaskDelay(pdMS_TO_TICKS(30000));
+// Add a direct peer to the WireGuard interface, or update its endpoint
+static void p2p_apply_peer(const p2p_peer_t *e)
+{
+    // Skip self and relay server
+    if (strcmp(e->public_key, s_wg_pubkey) == 0 ||
+        strcmp(e->public_key, s_wg_server_pub) == 0) {
+        return;
+    }
 
-    while (1) {
-        if (!s_registered || !wireguard_tunnel_is_up()) {
-            vTaskDelay(pdMS_TO_TICKS(P2P_POLL_MS));
-            continue;
+    // Endpoint — prefer LAN IP (zero-latency same-subnet path)
+    const char *peer_endpoint = e->lan_ip[0] ? e->lan_ip : e->endpoint;
+    bool endpoint_is_lan = e->lan_ip[0] != '\0';
+
+    // Split endpoint into IP and port
+    char ep_ip[20] = {0};
+    uint16_t ep_port = WG_SERVER_PORT;
+    if (peer_endpoint[0]) {
+        const char *colon = strrchr(peer_endpoint, ':');
+        if (colon && colon > peer_endpoint) {
+            int ip_len = (int)(colon - peer_endpoint);
+            if (ip_len > 0 && ip_len < (int)sizeof(ep_ip))
+                strncpy(ep_ip, peer_endpoint, ip_len);
+            ep_port = (uint16_t)atoi(colon + 1);
+        } else {
+            strncpy(ep_ip, peer_endpoint, sizeof(ep_ip) - 1);
         }
+    }
 
-        // ── Step 1: fetch peer list from coord server ─────────────────
-        char body[192];
-        snprintf(body, sizeof(body),
-            "{\"public_key\":\"%s\",\"preshared_key\":\"%s\"}",
-            s_wg_pubkey, s_wg_psk);
+    if (!e->online || e->allowed_ip[0] == '\0' || ep_ip[0] == '\0' || e->public_key[0] == '\0') {
+        return;
+    }
 
-        s_p2p_buf_len = 0;
-        s_p2p_buf[0] = '\0';
+    // Check if already tracked
+    int slot = -1;
+    for (int i = 0; i < s_direct_peer_count; i++) {
+        if (strcmp(s_direct_peer_ip[i], e->allowed_ip) == 0) { slot = i; break; }
+    }
 
-        {
-            esp_http_client_config_t cfg = {
-                .url           = COORD_PEERS_URL,
-                .method        = HTTP_METHOD_POST,
-                .timeout_ms    = 8000,
-                .event_handler = p2p_http_event_handler,
-                .buffer_size      = 512,
-                .buffer_size_tx   = 512,
-            };
-            esp_http_client_handle_t c = esp_http_client_init(&cfg);
-            if (c) {
-                esp_http_client_set_header(c, "Content-Type", "application/json");
-                esp_http_client_set_post_field(c, body, strlen(body));
-                esp_err_t err = esp_http_client_perform(c);
-                int status   = esp_http_client_get_status_code(c);
-                esp_http_client_cleanup(c);
-
-                if (err == ESP_OK && (status == 200 || status == 201) && s_p2p_buf_len > 10) {
-                    ESP_LOGD(TAG, "[P2P] peers resp: %.120s", s_p2p_buf);
-
-                    // ── Parse peer array ──────────────────────────────
-                    char *pos = s_p2p_buf;
-                    while (pos && *pos) {
-                        char *pk_start = strstr(pos, "\"public_key\":\"");
-                        if (!pk_start) break;
-                        pk_start += 14;
-                        char *pk_end = strchr(pk_start, '"');
-                        if (!pk_end) break;
-
-                        char peer_pk[48] = {0};
-                        int pk_len = (int)(pk_end - pk_start);
-                        if (pk_len > 0 && pk_len < (int)sizeof(peer_pk))
-                            strncpy(peer_pk, pk_start, pk_len);
-
-                        // Skip self and relay server
-                        if (strcmp(peer_pk, s_wg_pubkey) == 0 ||
-                            strcmp(peer_pk, s_wg_server_pub) == 0) {
-                            pos = pk_end + 1;
-                            continue;
-                        }
+    if (slot < 0 && s_direct_peer_count < P2P_MAX_DIRECT_PEERS) {
+        // New peer — add to WireGuard interface
+        slot = s_direct_peer_count;
+
+        // Decode PSK (binary needed by wireguardif_add_peer)
+        uint8_t psk_bytes[32] = {0};
+        const uint8_t *psk_ptr = NULL;
+        if (e->preshared_key[0]) {
+            size_t psk_len = 32;
+            if (wireguard_base64_decode(e->preshared_key, psk_bytes, &psk_len) && psk_len == 32)
+                psk_ptr = psk_bytes;
+        }
 
-                        // Extract allowed_ip (VPN IP of this peer, e.g. 10.100.0.X)
-                        char peer_ip[20] = {0};
-                        {
-                            char *p = strstr(pk_start, "\"allowed_ip\":\"");
-                            if (p && p < pk_start + 500) {
-                                p += 14;
-                                char *e = strchr(p, '"');
-                                if (e && (e - p) > 0 && (e - p) < (int)sizeof(peer_ip))
-                                    strncpy(peer_ip, p, e - p);
-                            }
-                        }
+        struct wireguardif_peer peer_cfg;
+        wireguardif_peer_init(&peer_cfg);
+        peer_cfg.public_key    = e->public_key;   // base64; wireguardif decodes internally
+        peer_cfg.preshared_key = psk_ptr;         // decoded binary bytes, or NULL
+        peer_cfg.keep_alive    = 25;
+
+        ip_addr_t allowed_ip, allowed_mask, ep_addr;
+        memset(&allowed_ip,   0, sizeof(allowed_ip));
+        memset(&allowed_mask, 0, sizeof(allowed_mask));
+        memset(&ep_addr,      0, sizeof(ep_addr));
+        ipaddr_aton(e->allowed_ip,        &allowed_ip);
+        ipaddr_aton("255.255.255.255",    &allowed_mask);
+        ipaddr_aton(ep_ip,                &ep_addr);
+
+        peer_cfg.allowed_ip   = allowed_ip;
+        peer_cfg.allowed_mask = allowed_mask;
+        peer_cfg.endpoint_ip  = ep_addr;
+        peer_cfg.endport_port = ep_port;
+
+        uint8_t idx = WIREGUARDIF_INVALID_INDEX;
+        err_t add_err = wireguardif_add_peer(s_wg_ctx.netif, &peer_cfg, &idx);
+        if (add_err == ERR_OK && idx != WIREGUARDIF_INVALID_INDEX) {
+            s_direct_peer_idx[slot] = idx;
+            strncpy(s_direct_peer_ip[slot], e->allowed_ip, sizeof(s_direct_peer_ip[slot]) - 1);
+            strcpy(s_direct_peer_lan[slot], endpoint_is_lan ? ep_ip : "");
+            s_direct_peer_count++;
+            wireguardif_connect(s_wg_ctx.netif, idx);
+            ESP_LOGI(TAG, "[P2P] Added peer %s → %s:%u", e->allowed_ip, ep_ip, ep_port);
+        } else {
+            ESP_LOGW(TAG, "[P2P] wireguardif_add_peer(%s) err=%d", e->allowed_ip, (int)add_err);
+        }
 
-                        // Check online flag
-                        char *online_ptr = strstr(pk_start, "\"online\":true");
-                        bool is_online = (online_ptr && online_ptr < pk_start + 500);
-
-                        // Build endpoint string — prefer LAN IP (zero-latency same-subnet path)
-                        char peer_endpoint[64] = {0};
-                        {
-                            char *p = strstr(pk_start, "\"lan_ip\":\"");
-                            if (p && p < pk_start + 500) {
-                                p += 10;
-                                char *e = strchr(p, '"');
-                                if (e && (e - p) > 0 && (e - p) < (int)sizeof(peer_endpoint))
-                                    strncpy(peer_endpoint, p, e - p);
-                            }
-                        }
-                        if (peer_endpoint[0] == '\0') {
-                            char *p = strstr(pk_start, "\"endpoint\":\"");
-                            if (p && p < pk_start + 500) {
-                                p += 12;
-                                char *e = strchr(p, '"');
-                                if (e && (e - p) > 0 && (e - p) < (int)sizeof(peer_endpoint))
-                                    strncpy(peer_endpoint, p, e - p);
-                            }
-                        }
+    } else if (slot >= 0 && s_direct_peer_idx[slot] != WIREGUARDIF_INVALID_INDEX) {
+        // Existing peer — update endpoint in case it roamed
+        ip_addr_t new_ep;
+        memset(&new_ep, 0, sizeof(new_ep));
+        ipaddr_aton(ep_ip, &new_ep);
+        wireguardif_update_endpoint(s_wg_ctx.netif, s_direct_peer_idx[slot], &new_ep, ep_port);
+        strcpy(s_direct_peer_lan[slot], endpoint_is_lan ? ep_ip : "");
+    }
+}
 
-                        // Extract preshared_key (base64) for this peer
-                        char peer_psk_b64[48] = {0};
-                        {
-                            char *p = strstr(pk_start, "\"preshared_key\":\"");
-                            if (p && p < pk_start + 500) {
-                                p += 17;
-                                char *e = strchr(p, '"');
-                                if (e && (e - p) > 0 && (e - p) < (int)sizeof(peer_psk_b64))
-                                    strncpy(peer_psk_b64, p, e - p);
-                            }
-                        }
+static void p2p_flush_peer(void)
+{
+    if (s_p2p_peer_idx >= 0) {
+        p2p_apply_peer(&s_p2p_peer);
+    }
+    memset(&s_p2p_peer, 0, sizeof(s_p2p_peer));
+    s_p2p_peer_idx = -1;
+}
 
-                        // Split endpoint into IP and port
-                        char ep_ip[20] = {0};
-                        uint16_t ep_port = WG_SERVER_PORT;
-                        if (peer_endpoint[0]) {
-                            char *colon = strrchr(peer_endpoint, ':');
-                            if (colon && colon > peer_endpoint) {
-                                int ip_len = (int)(colon - peer_endpoint);
-                                if (ip_len > 0 && ip_len < (int)sizeof(ep_ip))
-                                    strncpy(ep_ip, peer_endpoint, ip_len);
-                                ep_port = (uint16_t)atoi(colon + 1);
-                            } else {
-                                strncpy(ep_ip, peer_endpoint, sizeof(ep_ip) - 1);
-                            }
-                        }
+// The first field of the next array element completes the current peer
+static void *p2p_resolve(void *ctx, const int *idx, int n_idx)
+{
+    (void)ctx;
+    if (n_idx != 1) return NULL;
+    if (idx[0] != s_p2p_peer_idx) {
+        p2p_flush_peer();
+        s_p2p_peer_idx = idx[0];
+    }
+    return &s_p2p_peer;
+}
 
-                        if (!is_online || peer_ip[0] == '\0' || ep_ip[0] == '\0' || peer_pk[0] == '\0') {
-                            pos = pk_end + 1;
-                            continue;
-                        }
+static esp_http_client_handle_t coord_client(const char *url, int timeout_ms)
+{
+    if (s_coord_client) {
+        esp_http_client_set_url(s_coord_client, url);   // Same host: the connection is kept
+        esp_http_client_set_timeout_ms(s_coord_client, timeout_ms);
+        return s_coord_client;
+    }
+    esp_http_client_config_t cfg = {
+        .url               = url,
+        .method            = HTTP_METHOD_POST,
+        .timeout_ms        = timeout_ms,
+        .event_handler     = p2p_http_event_handler,
+        .keep_alive_enable = true,
+        .buffer_size       = 512,
+        .buffer_size_tx    = 512,
+    };
+    s_coord_client = esp_http_client_init(&cfg);
+    if (s_coord_client) {
+        esp_http_client_set_header(s_coord_client, "Content-Type", "application/json");
+    }
+    return s_coord_client;
+}
 
-                        // Check if already tracked
-                        int slot = -1;
-                        for (int i = 0; i < s_direct_peer_count; i++) {
-                            if (strcmp(s_direct_peer_ip[i], peer_ip) == 0) { slot = i; break; }
-                        }
+static void coord_client_drop(void)
+{
+    if (s_coord_client) {
+        esp_http_client_cleanup(s_coord_client);
+        s_coord_client = NULL;
+    }
+}
 
-                        if (slot < 0 && s_direct_peer_count < P2P_MAX_DIRECT_PEERS) {
-                            // New peer — add to WireGuard interface
-                            slot = s_direct_peer_count;
-
-                            // Decode PSK (binary needed by wireguardif_add_peer)
-                            uint8_t psk_bytes[32] = {0};
-                            const uint8_t *psk_ptr = NULL;
-                            if (peer_psk_b64[0]) {
-                                size_t psk_len = 32;
-                                if (wireguard_base64_decode(peer_psk_b64, psk_bytes, &psk_len) && psk_len == 32)
-                                    psk_ptr = psk_bytes;
-                            }
-
-                            struct wireguardif_peer peer_cfg;
-                            wireguardif_peer_init(&peer_cfg);
-                            peer_cfg.public_key    = peer_pk;   // base64; wireguardif decodes internally
-                            peer_cfg.preshared_key = psk_ptr;   // decoded binary bytes, or NULL
-                            peer_cfg.keep_alive    = 25;
-
-                            ip_addr_t allowed_ip, allowed_mask, ep_addr;
-                            memset(&allowed_ip,   0, sizeof(allowed_ip));
-                            memset(&allowed_mask, 0, sizeof(allowed_mask));
-                            memset(&ep_addr,      0, sizeof(ep_addr));
-                            ipaddr_aton(peer_ip,          &allowed_ip);
-                            ipaddr_aton("255.255.255.255", &allowed_mask);
-                            ipaddr_aton(ep_ip,             &ep_addr);
-
-                            peer_cfg.allowed_ip   = allowed_ip;
-                            peer_cfg.allowed_mask = allowed_mask;
-                            peer_cfg.endpoint_ip  = ep_addr;
-                            peer_cfg.endport_port = ep_port;
-
-                            uint8_t idx = WIREGUARDIF_INVALID_INDEX;
-                            err_t add_err = wireguardif_add_peer(s_wg_ctx.netif, &peer_cfg, &idx);
-                            if (add_err == ERR_OK && idx != WIREGUARDIF_INVALID_INDEX) {
-                                s_direct_peer_idx[slot] = idx;
-                                strncpy(s_direct_peer_ip[slot], peer_ip, sizeof(s_direct_peer_ip[slot]) - 1);
-                                s_direct_peer_count++;
-                                wireguardif_connect(s_wg_ctx.netif, idx);
-                                ESP_LOGI(TAG, "[P2P] Added peer %s → %s:%u", peer_ip, ep_ip, ep_port);
-                            } else {
-                                ESP_LOGW(TAG, "[P2P] wireguardif_add_peer(%s) err=%d", peer_ip, (int)add_err);
-                            }
-
-                        } else if (slot >= 0 && s_direct_peer_idx[slot] != WIREGUARDIF_INVALID_INDEX) {
-                            // Existing peer — update endpoint in case it roamed
-                            ip_addr_t new_ep;
-                            memset(&new_ep, 0, sizeof(new_ep));
-                            ipaddr_aton(ep_ip, &new_ep);
-                            wireguardif_update_endpoint(s_wg_ctx.netif, s_direct_peer_idx[slot], &new_ep, ep_port);
-                        }
+// POST coord/peers. The server may hold the request for up to "wait" seconds
+// until the list changes, and answers 304 when it still matches the ETag.
+// Returns the HTTP status, or -1 on a network error.
+static int p2p_fetch_peers(void)
+{
+    char body[224];
+    snprintf(body, sizeof(body),
+        "{\"public_key\":\"%s\",\"preshared_key\":\"%s\",\"wait\":%d}",
+        s_wg_pubkey, s_wg_psk, P2P_LONG_POLL_S);
 
-                        pos = pk_end + 1;
-                    }
-                } else {
-                    ESP_LOGD(TAG, "[P2P] coord/peers: %s status=%d", esp_err_to_name(err), status);
-                }
-            }
+    esp_http_client_handle_t c = coord_client(COORD_PEERS_URL, (P2P_LONG_POLL_S + 10) * 1000);
+    if (!c) return -1;
+    if (s_peers_etag[0]) {
+        esp_http_client_set_header(c, "If-None-Match", s_peers_etag);
+    } else {
+        esp_http_client_delete_header(c, "If-None-Match");
+    }
+    esp_http_client_set_post_field(c, body, strlen(body));
+
+    body_parser_init(&s_p2p_parser, BODY_FORMAT_JSON, &s_p2p_table, NULL);
+    body_parser_feed(&s_p2p_parser, "{\"r\":", 5);
+    memset(&s_p2p_peer, 0, sizeof(s_p2p_peer));
+    s_p2p_peer_idx = -1;
+    s_peers_etag_new[0] = '\0';
+
+    s_p2p_parsing = true;
+    esp_err_t err = esp_http_client_perform(c);
+    s_p2p_parsing = false;
+    esp_http_client_delete_header(c, "If-None-Match");
+    if (err != ESP_OK) {
+        ESP_LOGD(TAG, "[P2P] coord/peers: %s", esp_err_to_name(err));
+        coord_client_drop();
+        return -1;
+    }
+
+    int status = esp_http_client_get_status_code(c);
+    if (status == 200 || status == 201) {
+        body_parser_feed(&s_p2p_parser, "}", 1);
+        if (body_parser_finish(&s_p2p_parser)) {
+            p2p_flush_peer();
+            strcpy(s_peers_etag, s_peers_etag_new);
+        } else {
+            ESP_LOGW(TAG, "[P2P] Malformed peer list");
+            s_peers_etag[0] = '\0';
         }
+    } else if (status != 304) {
+        ESP_LOGD(TAG, "[P2P] coord/peers status=%d", status);
+    }
+    return status;
+}
+
+static void p2p_discovery_task(void *arg)
+{
+    char last_report[384] = {0};
+    int64_t last_report_us = 0;
+
+    for (int i = 0; i < P2P_MAX_DIRECT_PEERS; i++) {
+        s_direct_peer_idx[i] = WIREGUARDIF_INVALID_INDEX;
+        s_direct_peer_ip[i][0] = '\0';
+        s_direct_peer_lan[i][0] = '\0';
+    }
+
+    // Let the tunnel stabilise before starting peer discovery
+    vTaskDelay(pdMS_TO_TICKS(30000));
+
+    while (1) {
+        if (!s_registered || !wireguard_tunnel_is_up()) {
+            coord_client_drop();
+            vTaskDelay(pdMS_TO_TICKS(P2P_POLL_MS));
+            continue;
+        }
+
+        // ── Step 1: fetch peer list from coord server ─────────────────
+        int64_t poll_start = esp_timer_get_time();
+        int status = p2p_fetch_peers();
+        bool long_polled = status > 0 &&
+                           esp_timer_get_time() - poll_start >= (int64_t)P2P_LONG_POLL_S * 500000;
 
         // ── Step 2: report own LAN IP + IPv6 to coord/endpoints ──────
+        // Only when it changed, or every P2P_REPORT_REFRESH_MS so the server
+        // does not expire it
         {
             char lan_ip[20]   = {0};
             char ipv6_str[48] = {0};
@@ -707,20 +798,20 @@ static void p2p_discovery_task(void *arg)
                     "\"lan_ip\":\"%s\",\"ipv6\":\"%s\",\"wg_port\":0}",
                     s_wg_pubkey, s_wg_psk, lan_ip, ipv6_str);
 
-                esp_http_client_config_t rcfg = {
-                    .url        = COORD_ENDPOINTS_URL,
-                    .method     = HTTP_METHOD_POST,
-                    .timeout_ms = 5000,
-                    .buffer_size      = 256,
-                    .buffer_size_tx   = 256,
-                };
-                esp_http_client_handle_t rc = esp_http_client_init(&rcfg);
-                if (rc) {
-                    esp_http_client_set_header(rc, "Content-Type", "application/json");
-                    esp_http_client_set_post_field(rc, report, strlen(report));
-                    esp_http_client_perform(rc);
-                    esp_http_client_cleanup(rc);
-                    ESP_LOGD(TAG, "[P2P] Reported lan=%s ipv6=%s", lan_ip, ipv6_str);
+                int64_t now = esp_timer_get_time();
+                if (strcmp(report, last_report) != 0 || last_report_us == 0 ||
+                    now - last_report_us >= (int64_t)P2P_REPORT_REFRESH_MS * 1000) {
+                    esp_http_client_handle_t rc = coord_client(COORD_ENDPOINTS_URL, 5000);
+                    if (rc) {
+                        esp_http_client_set_post_field(rc, report, strlen(report));
+                        if (esp_http_client_perform(rc) == ESP_OK) {
+                            strcpy(last_report, report);
+                            last_report_us = now;
+                            ESP_LOGD(TAG, "[P2P] Reported lan=%s ipv6=%s", lan_ip, ipv6_str);
+                        } else {
+                            coord_client_drop();
+                        }
+                    }
                 }
             }
         }
@@ -731,106 +822,15 @@ static void p2p_discovery_task(void *arg)
                 ip_addr_t cur_ip;
                 uint16_t  cur_port;
                 err_t up = wireguardif_peer_is_up(s_wg_ctx.netif, s_direct_peer_idx[i], &cur_ip, &cur_port);
-                ESP_LOGI(TAG, "[P2P] Peer %s: %s", s_direct_peer_ip[i], up == ERR_OK ? "UP" : "DOWN");
+                ESP_LOGD(TAG, "[P2P] Peer %s: %s", s_direct_peer_ip[i], up == ERR_OK ? "UP" : "DOWN");
             }
         }
 
-        vTaskDelay(pdMS_TO_TICKS(P2P_POLL_MS));
-    }
-}
-
-// ── Browser-to-wake task ─────────────────────────────────────────────
-// When the web server is down, holds port 80 with a minimal TCP socket.
-// First browser request gets a "starting..." page with a 2-second
-// auto-refresh; the full web server is started behind the scenes and
-// is ready by the time the browser follows the refresh.
-// Auto-stops the web server after 5 minutes to reclaim ~64 KB heap.
-#define WAKE_WEB_SERVER_TIMEOUT_MS (30 * 60 * 1000)
-
-static const char WAKE_HTML[] =
-    "HTTP/1.1 200 OK\r\n"
-    "Content-Type: text/html\r\n"
-    "Connection: close\r\n\r\n"
-    "<!DOCTYPE html><html><head>"
-    "<meta http-equiv='refresh' content='2;url=/'>"
-    "<title>FluxGen Gateway</title></head><body>"
-    "<p><b>FluxGen Gateway</b> &mdash; web interface is starting, "
-    "please wait...</p>"
-    "</body></html>";
-
-static void tcp_wake_task(void *arg)
-{
-    // Wait for registration + tunnel before touching port 80
-    while (!s_registered || s_wg_ctx.netif == NULL) {
-        vTaskDelay(pdMS_TO_TICKS(5000));
-    }
-    vTaskDelay(pdMS_TO_TICKS(10000)); // let tunnel stabilise
-
-    for (;;) {
-        // Only hold port 80 when the full web server is not running
-        while (!wireguard_tunnel_is_up() || web_config_get_server() != NULL) {
-            vTaskDelay(pdMS_TO_TICKS(5000));
-        }
-
-        int srv = socket(AF_INET, SOCK_STREAM, 0);
-        if (srv < 0) {
-            vTaskDelay(pdMS_TO_TICKS(10000));
-            continue;
-        }
-
-        int opt = 1;
-        setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-        struct sockaddr_in addr = {
-            .sin_family      = AF_INET,
-            .sin_addr.s_addr = htonl(INADDR_ANY),
-            .sin_port        = htons(80),
-        };
-
-        if (bind(srv, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
-            listen(srv, 1) != 0) {
-            ESP_LOGW(TAG, "[WAKE] bind/listen port 80 failed (%d) — retry 15s", errno);
-            close(srv);
-            vTaskDelay(pdMS_TO_TICKS(15000));
-            continue;
-        }
-
-        ESP_LOGI(TAG, "[WAKE] Ready — open http://%s/ in browser to start web UI",
-                 s_wg_local_ip);
-
-        // Accept loop — exit when web server comes up or tunnel drops
-        while (wireguard_tunnel_is_up() && web_config_get_server() == NULL) {
-            struct timeval tv = {.tv_sec = 5, .tv_usec = 0};
-            setsockopt(srv, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-
-            int cli = accept(srv, NULL, NULL);
-            if (cli < 0) continue; // 5s timeout — loop and re-check conditions
-
-            // Drain the browser's HTTP request (we don't need its content)
-            char buf[256];
-            recv(cli, buf, sizeof(buf) - 1, 0);
-
-            // Reply with auto-refresh page; browser waits 2s then reloads /
-            send(cli, WAKE_HTML, sizeof(WAKE_HTML) - 1, 0);
-            close(cli);
-
-            // Release port 80 before httpd grabs it
-            close(srv);
-            srv = -1;
-
-            ESP_LOGI(TAG, "[WAKE] Browser hit — starting web server");
-            web_config_start_server_only();
-
-            // Auto-stop after 5 min to reclaim heap
-            vTaskDelay(pdMS_TO_TICKS(WAKE_WEB_SERVER_TIMEOUT_MS));
-            if (web_config_get_server() != NULL) {
-                ESP_LOGI(TAG, "[WAKE] 5-min timeout — stopping web server");
-                web_config_stop();
-            }
-            break; // back to outer loop — reopen wake listener
+        // A server that long-polls already waited; an older one is polled
+        // every P2P_POLL_MS as before
+        if (!long_polled) {
+            vTaskDelay(pdMS_TO_TICKS(P2P_POLL_MS));
         }
-
-        if (srv >= 0) close(srv);
     }
 }
 
@@ -838,6 +838,9 @@ static void tcp_wake_task(void *arg)
 static void wireguard_keepalive_task(void *arg)
 {
     int tick = 0;
+    int down_ticks = 0;                        // Consecutive ticks with the tunnel down
+    int next_down_verify = WG_VERIFY_DOWN_TICKS;
+    int64_t last_verify_us = esp_timer_get_time();
 
     // If setup never registered us, keep polling every 5s until admin unblocks
     while (!s_registered) {
@@ -866,6 +869,10 @@ static void wireguard_keepalive_task(void *arg)
         if (!up) {
             ESP_LOGW(TAG, "[KEEPALIVE] Tunnel down — reconnecting");
             esp_wireguard_connect(&s_wg_ctx);
+            down_ticks++;
+        } else {
+            down_ticks = 0;
+            next_down_verify = WG_VERIFY_DOWN_TICKS;
         }
 
         // Apply deferred restart once web server has gone idle
@@ -875,13 +882,26 @@ static void wireguard_keepalive_task(void *arg)
             esp_restart();
         }
 
-        // 20s server-verify.
+        // Server-verify: every WG_VERIFY_HEALTHY_MS while handshakes succeed,
+        // and after 30s down then at doubling intervals (up to 5 min) while the tunnel
+        // stays down, which is when a deleted peer would show up.
         // Skip when web server is running — the extra HTTP connection would consume
         // the last ~15KB of heap (web server uses ~64KB leaving very little margin).
         // Also skip when heap is already below threshold regardless of web server state.
-        if (tick % 2 == 0) {
+        bool verify_due;
+        if (up) {
+            verify_due = esp_timer_get_time() - last_verify_us >= (int64_t)WG_VERIFY_HEALTHY_MS * 1000;
+        } else {
+            verify_due = down_ticks >= next_down_verify;
+            if (verify_due) {
+                int step = next_down_verify < WG_VERIFY_DOWN_MAX_TICKS ? next_down_verify : WG_VERIFY_DOWN_MAX_TICKS;
+                next_down_verify += step;
+            }
+        }
+        if (verify_due) {
             bool web_up   = (web_config_get_server() != NULL);
             uint32_t heap = (uint32_t)esp_get_free_heap_size();
+            last_verify_us = esp_timer_get_time();
 
             if (web_up) {
                 ESP_LOGD(TAG, "[KEEPALIVE] Skip server-verify — web server active");
@@ -939,8 +959,7 @@ void wireguard_start_keepalive_task(void)
     spawned = true;
     xTaskCreate(wireguard_keepalive_task, "wg_keepalive", 5120, NULL, 4, NULL);
     xTaskCreate(p2p_discovery_task,       "wg_p2p",       6144, NULL, 3, NULL);
-    xTaskCreate(tcp_wake_task,            "wg_wake",      3072, NULL, 3, NULL);
-    ESP_LOGI(TAG, "WG keepalive + P2P discovery + browser-wake tasks spawned");
+    ESP_LOGI(TAG, "WG keepalive + P2P discovery tasks spawned");
 }
 
 // ── /vpn-status HTTP handler ─────────────────────────────────────────
@@ -998,3 +1017,19 @@ const char* wireguard_get_local_ip(void)    { return s_wg_local_ip; }
 const char* wireguard_get_pubkey(void)      { return s_wg_pubkey; }
 const char* wireguard_get_device_name(void) { return s_device_name; }
 bool        wireguard_is_registered(void)   { return s_registered; }
+
+int wireguard_get_direct_peers(wireguard_peer_addr_t *peers, int max)
+{
+    int n = 0;
+    for (int i = 0; i < s_direct_peer_count && n < max; i++) {
+        if (s_direct_peer_idx[i] == WIREGUARDIF_INVALID_INDEX) {
+            continue;
+        }
+        strncpy(peers[n].vpn_ip, s_direct_peer_ip[i], sizeof(peers[n].vpn_ip) - 1);
+        peers[n].vpn_ip[sizeof(peers[n].vpn_ip) - 1] = '\0';
+        strncpy(peers[n].lan_ip, s_direct_peer_lan[i], sizeof(peers[n].lan_ip) - 1);
+        peers[n].lan_ip[sizeof(peers[n].lan_ip) - 1] = '\0';
+        n++;
+    }
+    return n;
+}
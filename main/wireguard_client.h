@@ -8,7 +8,7 @@
 //   2. If not registered: generate Curve25519 keypair + POST to register API
 //   3. If registered: verify with server (server may say "deleted" -> wipe + re-register)
 //   4. Start WireGuard tunnel with assigned IP
-//   5. Spawn keepalive task (10s tunnel check / 20s server verify)
+//   5. Spawn keepalive task (10s tunnel check / adaptive server verify)
 //
 // MUST be called BEFORE Azure MQTT connects (Issue #6 - one TLS session at a time).
 
@@ -30,7 +30,8 @@ extern "C" {
 esp_err_t wireguard_setup(void);
 
 // Spawn the background keepalive task. Call AFTER wireguard_setup() succeeds.
-// Task: every 10s reconnect tunnel if down, every 20s verify with server.
+// Task: every 10s reconnect tunnel if down; verify with server every 30 min
+// while healthy, backing off from 30s to 5 min while the tunnel is down.
 // On peer-deletion: wipes NVS, regenerates keys, polls every 5s until unblocked,
 // then esp_restart() to bring tunnel up cleanly.
 void wireguard_start_keepalive_task(void);
@@ -46,6 +47,15 @@ const char* wireguard_get_pubkey(void);       // base64 public key
 const char* wireguard_get_device_name(void);  // "ESP32-XXXXXXXXXXXX"
 bool        wireguard_is_registered(void);
 
+// Direct (device-to-device) peers found by P2P discovery
+typedef struct {
+    char vpn_ip[20];    // tunnel address, e.g. "10.100.0.17"
+    char lan_ip[20];    // same-site LAN address, "" if the peer did not report one
+} wireguard_peer_addr_t;
+
+// Copy up to max direct peers; returns how many
+int wireguard_get_direct_peers(wireguard_peer_addr_t *peers, int max);
+
 #ifdef __cplusplus
 }
 #endif
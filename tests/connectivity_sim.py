@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+"""
+Connectivity Simulator - Runs the firmware's connectivity state machine
+(main/conn_sm.c) on the host against scripted network faults and checks the
+recovery ladder: MQTT reconnect -> WiFi/PPP reconnect -> modem reset -> reboot.
+
+The state machine is built with hostbuild.py and stepped once per simulated
+second, like connectivity_task. The world model is a SIM-mode gateway: the
+PPP link only comes back through a reconnect or a modem reset, and every
+action takes a realistic amount of time.
+
+Usage:
+    python connectivity_sim.py                      # All scenarios
+    python connectivity_sim.py --scenario flapping  # One scenario
+    python connectivity_sim.py --seed 7 --verbose   # Print every action
+"""
+
+import argparse
+import ctypes
+import sys
+import tempfile
+
+import hostbuild
+
+# Flat wrappers so ctypes does not need to mirror conn_sm_t
+SHIM_SOURCE = r"""
+#include <stdlib.h>
+#include "conn_sm.h"
+
+void* sim_new(uint32_t seed) {
+    conn_sm_t* sm = calloc(1, sizeof(conn_sm_t));
+    conn_sm_policy_t policy;
+    conn_sm_default_policy(&policy);
+    conn_sm_init(sm, &policy, seed, 0);
+    return sm;
+}
+void sim_free(void* sm) { free(sm); }
+int sim_step(void* sm, int link_up, int mqtt_up, int modem_ok, int reboot_ok, uint32_t now) {
+    conn_inputs_t in = { link_up, mqtt_up, modem_ok, reboot_ok };
+    return conn_sm_step(sm, &in, now);
+}
+void sim_done(void* sm, int action, uint32_t now) { conn_sm_action_done(sm, action, now); }
+int sim_state(void* sm) { return ((conn_sm_t*)sm)->state; }
+void sim_stats(void* sm, uint32_t* out) {
+    conn_sm_stats_t* s = &((conn_sm_t*)sm)->stats;
+    out[0] = s->outages; out[1] = s->recoveries; out[2] = s->last_recovery_ms;
+    out[3] = s->max_recovery_ms; out[4] = s->mqtt_reconnects; out[5] = s->link_reconnects;
+    out[6] = s->modem_resets; out[7] = s->reboots;
+}
+"""
+
+ACTIONS = ["NONE", "MQTT_RECONNECT", "LINK_RECONNECT", "MODEM_RESET", "REBOOT"]
+STATES = ["ONLINE", "MQTT_RECOVERY", "LINK_RECOVERY", "MODEM_RESET", "REBOOT"]
+STAT_NAMES = ["outages", "recoveries", "last_recovery_ms", "max_recovery_ms",
+              "mqtt_reconnects", "link_reconnects", "modem_resets", "reboots"]
+
+# Action latencies (seconds)
+MQTT_CONNECT_S = 2
+LINK_CONNECT_S = 5
+MODEM_RESET_S = 30
+
+
+def build_library(workdir):
+    so = hostbuild.build_library(workdir, "conn_sm.c", SHIM_SOURCE)
+    so.sim_new.restype = ctypes.c_void_p
+    so.sim_new.argtypes = [ctypes.c_uint32]
+    so.sim_free.argtypes = [ctypes.c_void_p]
+    so.sim_step.argtypes = [ctypes.c_void_p] + [ctypes.c_int] * 4 + [ctypes.c_uint32]
+    so.sim_done.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_uint32]
+    so.sim_state.argtypes = [ctypes.c_void_p]
+    so.sim_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32)]
+    return so
+
+
+class World:
+    """Network as seen by the gateway. Scenario callbacks flip the flags."""
+
+    def __init__(self):
+        self.network_ok = True      # Tower/AP and internet reachable
+        self.broker_ok = True       # IoT Hub accepts connections
+        self.modem_wedged = False   # Only a modem reset clears this
+        self.blackhole = False      # Link up but no traffic; a link reconnect clears it
+        self.link_up = False
+        self.mqtt_up = False
+
+
+def run_scenario(so, scenario, seed, verbose):
+    world = World()
+    sm = so.sim_new(seed)
+    pending = []  # (done_at, action)
+    reboot_at = None
+    offline_s = 0
+
+    for t in range(scenario["duration"]):
+        scenario["events"](world, t)
+
+        # Faults take the connection down immediately
+        if world.link_up and (not world.network_ok or world.modem_wedged):
+            world.link_up = False
+        if world.mqtt_up and (not world.link_up or not world.broker_ok or world.blackhole):
+            world.mqtt_up = False
+
+        # Complete actions whose latency has elapsed
+        for item in [p for p in pending if p[0] <= t]:
+            pending.remove(item)
+            action = item[1]
+            if action == "LINK_RECONNECT":
+                world.blackhole = False
+                world.link_up = world.network_ok and not world.modem_wedged
+            elif action == "MQTT_RECONNECT":
+                world.mqtt_up = world.link_up and world.broker_ok and not world.blackhole
+            elif action == "MODEM_RESET":
+                world.modem_wedged = False
+                world.blackhole = False
+                world.link_up = world.network_ok
+                so.sim_done(sm, ACTIONS.index("MODEM_RESET"), t * 1000)
+
+        # Startup: the firmware dials and connects MQTT on its own once
+        if t == 0:
+            pending.append((LINK_CONNECT_S, "LINK_RECONNECT"))
+            pending.append((LINK_CONNECT_S + MQTT_CONNECT_S, "MQTT_RECONNECT"))
+
+        if not (world.link_up and world.mqtt_up):
+            offline_s += 1
+
+        action = ACTIONS[so.sim_step(sm, world.link_up, world.mqtt_up,
+                                     True, scenario.get("reboot_allowed", False), t * 1000)]
+        if action == "NONE":
+            continue
+        if verbose:
+            print(f"    t={t:5d}s  {STATES[so.sim_state(sm)]:<14} -> {action}")
+        if action == "MQTT_RECONNECT":
+            pending.append((t + MQTT_CONNECT_S, action))
+        elif action == "LINK_RECONNECT":
+            world.link_up = False
+            world.mqtt_up = False
+            pending.append((t + LINK_CONNECT_S, action))
+        elif action == "MODEM_RESET":
+            world.link_up = False
+            world.mqtt_up = False
+            pending.append((t + MODEM_RESET_S, action))
+        elif action == "REBOOT":
+            reboot_at = t
+            break
+
+    raw = (ctypes.c_uint32 * len(STAT_NAMES))()
+    so.sim_stats(sm, raw)
+    stats = dict(zip(STAT_NAMES, raw))
+    stats["reboot_at"] = reboot_at
+    stats["online_at_end"] = world.link_up and world.mqtt_up
+    stats["offline_s"] = offline_s
+    so.sim_free(sm)
+    return stats
+
+
+def window(start, end, attr, value_inside, value_outside):
+    """Event helper: attr = value_inside for start <= t < end."""
+    def apply(world, t):
+        if t == start:
+            setattr(world, attr, value_inside)
+        elif t == end:
+            setattr(world, attr, value_outside)
+    return apply
+
+
+def flapping(world, t):
+    # 20 s up / 40 s down for 30 minutes starting at t=600
+    if 600 <= t < 2400:
+        world.network_ok = ((t - 600) % 60) < 20
+    elif t == 2400:
+        world.network_ok = True
+
+
+SCENARIOS = {
+    "mqtt_blip": {
+        "duration": 1800,
+        "events": window(600, 620, "broker_ok", False, True),
+        "check": lambda s: (s["link_reconnects"] == 0 and s["modem_resets"] == 0
+                            and s["mqtt_reconnects"] >= 1 and s["online_at_end"]),
+        "expect": "MQTT reconnects only",
+    },
+    "outage_5min": {
+        "duration": 3600,
+        "events": window(600, 900, "network_ok", False, True),
+        "check": lambda s: (s["modem_resets"] <= 1 and s["reboots"] == 0
+                            and s["max_recovery_ms"] <= 300000 + 180000 and s["online_at_end"]),
+        "expect": "<=1 modem reset (cooldown), no reboot",
+    },
+    "modem_wedged": {
+        "duration": 3600,
+        "events": window(600, 601, "modem_wedged", True, True),
+        "check": lambda s: s["modem_resets"] == 1 and s["reboots"] == 0 and s["online_at_end"],
+        "expect": "exactly one modem reset",
+    },
+    "blackhole": {
+        "duration": 3600,
+        "events": window(600, 601, "blackhole", True, True),
+        "check": lambda s: (s["link_reconnects"] >= 1 and s["modem_resets"] == 0
+                            and s["online_at_end"]),
+        "expect": "escalates to link reconnect, no modem reset",
+    },
+    "flapping": {
+        "duration": 3600,
+        "events": flapping,
+        "check": lambda s: (s["modem_resets"] <= 3 and s["reboots"] == 0
+                            and s["mqtt_reconnects"] + s["link_reconnects"] <= 60
+                            and s["online_at_end"]),
+        "expect": "bounded retries, resets capped per outage",
+    },
+    "broker_down": {
+        # Link stays up; neither a link reconnect nor a modem reset brings the broker back
+        "duration": 10800,
+        "reboot_allowed": True,
+        "events": window(600, 10800, "broker_ok", False, True),
+        "check": lambda s: (s["modem_resets"] >= 1 and s["reboots"] == 1
+                            and s["reboot_at"] is not None and s["reboot_at"] >= 600 + 1800),
+        "expect": "link cycles escalate to modem reset, then reboot",
+    },
+    "broker_down_sd": {
+        "duration": 10800,
+        "events": window(600, 10800, "broker_ok", False, True),
+        "check": lambda s: s["reboots"] == 0 and 3 <= s["modem_resets"] <= 3 + 10200 // 1200,
+        "expect": "modem resets, slowing down after 3, no reboot",
+    },
+    "long_outage_no_sd": {
+        "duration": 7200,
+        "reboot_allowed": True,
+        "events": window(600, 7200, "network_ok", False, True),
+        "check": lambda s: (s["modem_resets"] == 3 and s["reboots"] == 1
+                            and s["reboot_at"] is not None and s["reboot_at"] >= 600 + 1800),
+        "expect": "3 modem resets, then reboot after 30 min",
+    },
+    "long_outage_sd": {
+        "duration": 7200,
+        "events": window(600, 7200, "network_ok", False, True),
+        "check": lambda s: s["reboots"] == 0 and 3 <= s["modem_resets"] <= 3 + 6600 // 1200,
+        "expect": "no reboot, resets slow down after 3",
+    },
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Host simulation of conn_sm.c")
+    parser.add_argument("--scenario", choices=sorted(SCENARIOS), help="Run one scenario")
+    parser.add_argument("--seed", type=int, default=1, help="Jitter RNG seed")
+    parser.add_argument("--verbose", action="store_true", help="Print every action")
+    args = parser.parse_args()
+
+    names = [args.scenario] if args.scenario else list(SCENARIOS)
+    failures = 0
+    with tempfile.TemporaryDirectory() as workdir:
+        so = build_library(workdir)
+        print(f"{'Scenario':<20} {'MQTT':>5} {'Link':>5} {'Reset':>5} {'Boot':>5} "
+              f"{'MaxTTR':>8} {'Offline':>8}  Result")
+        for name in names:
+            scenario = SCENARIOS[name]
+            if args.verbose:
+                print(f"  [{name}]")
+            s = run_scenario(so, scenario, args.seed, args.verbose)
+            ok = scenario["check"](s)
+            failures += 0 if ok else 1
+            print(f"{name:<20} {s['mqtt_reconnects']:>5} {s['link_reconnects']:>5} "
+                  f"{s['modem_resets']:>5} {s['reboots']:>5} {s['max_recovery_ms'] / 1000:>7.0f}s "
+                  f"{s['offline_s']:>7d}s  {'PASS' if ok else 'FAIL'} ({scenario['expect']})")
+
+    print(f"\n{len(names) - failures}/{len(names)} scenarios passed")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
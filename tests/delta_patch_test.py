@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+Delta Patch Test - Runs the firmware's patch applier (main/delta_patch.c) on
+the host against patches made by tools/ota_delta.py, so a patch built on a PC
+rebuilds the same image on the gateway however the download is chunked, and
+broken or mismatched patches are refused instead of being flashed.
+
+The shim (built with hostbuild.py) holds the source image and collects the
+output. It gets the inflated command stream; inflating is left to Python's
+zlib here and to the ROM inflater on the device.
+
+Usage:
+    python delta_patch_test.py            # All cases
+    python delta_patch_test.py --verbose  # Stop with a traceback on the first failure
+"""
+
+import ctypes
+import os
+import random
+import struct
+import sys
+import zlib
+
+import hostbuild
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "tools"))
+
+import ota_delta  # noqa: E402
+
+DELTA_OK, DELTA_DONE = 0, 1
+DELTA_ERR_FORMAT, DELTA_ERR_SOURCE, DELTA_ERR_SIZE = -1, -2, -3
+
+SHIM_SOURCE = r"""
+#include <string.h>
+#include "delta_patch.h"
+
+static delta_patch_t patch;
+static unsigned char source[1 << 21];
+static unsigned int source_len;
+static unsigned char out[1 << 21];
+static unsigned int out_len;
+static int reads;
+
+static int read_src(void *ctx, uint32_t offset, uint8_t *buf, size_t len) {
+    (void)ctx;
+    if (offset + len > source_len) return -1;
+    memcpy(buf, source + offset, len);
+    reads++;
+    return 0;
+}
+
+static int write_out(void *ctx, const uint8_t *data, size_t len) {
+    (void)ctx;
+    if (out_len + len > sizeof(out)) return -1;
+    memcpy(out + out_len, data, len);
+    out_len += len;
+    return 0;
+}
+
+void set_source(const unsigned char *data, unsigned int len) { memcpy(source, data, len); source_len = len; }
+
+int start(const unsigned char *header, int len) {
+    delta_header_t hdr;
+    int err = delta_parse_header(header, len, &hdr);
+    if (err != DELTA_OK) return err;
+    delta_patch_init(&patch, &hdr, read_src, write_out, NULL);
+    out_len = 0;
+    reads = 0;
+    return DELTA_OK;
+}
+
+int feed(const unsigned char *data, int len) { return delta_patch_feed(&patch, data, len); }
+int output(unsigned char *buf) { memcpy(buf, out, out_len); return out_len; }
+int source_reads(void) { return reads; }
+int is_patch(const unsigned char *data, int len) { return delta_is_patch(data, len); }
+"""
+
+
+def apply(lib, old, patch, chunk=None):
+    """Run a patch through delta_patch.c; returns (last result, output)."""
+    lib.set_source(old, len(old))
+    err = lib.start(patch, len(patch))
+    if err != DELTA_OK:
+        return err, b""
+    commands = zlib.decompress(patch[ota_delta.HEADER_SIZE:], -15)
+    return apply_commands(lib, commands, chunk)
+
+
+def apply_commands(lib, commands, chunk=None):
+    result = DELTA_OK
+    i = 0
+    while i < len(commands) and result == DELTA_OK:
+        n = len(commands) if chunk is None else (chunk() if callable(chunk) else chunk)
+        result = lib.feed(commands[i:i + n], len(commands[i:i + n]))
+        i += n
+    buf = ctypes.create_string_buffer(1 << 21)
+    n = lib.output(buf)
+    return result, buf.raw[:n]
+
+
+def header(old, new):
+    return ota_delta.make_patch(old, new)[0][:ota_delta.HEADER_SIZE]
+
+
+def fake_image(rng, size):
+    """Code-like image: 4-byte words drawn from a small vocabulary, with some
+    words that look like absolute addresses."""
+    vocab = [rng.randrange(1 << 32) for _ in range(512)]
+    words = []
+    for _ in range(size // 4):
+        if rng.random() < 0.1:
+            words.append(0x400D0000 + rng.randrange(0x10000) * 4)
+        else:
+            words.append(rng.choice(vocab))
+    return struct.pack(f"<{len(words)}I", *words)
+
+
+def rebuild(old, rng, shift_at, shift_by):
+    """The next build: code inserted at shift_at moves everything after it, and
+    addresses pointing past it change by the same amount."""
+    words = list(struct.unpack(f"<{len(old) // 4}I", old))
+    limit = 0x400D0000 + shift_at
+    for k, w in enumerate(words):
+        if 0x400D0000 <= w < 0x40110000 and w >= limit:
+            words[k] = w + shift_by
+    inserted = [rng.randrange(1 << 32) for _ in range(shift_by // 4)]
+    words[shift_at // 4:shift_at // 4] = inserted
+    return struct.pack(f"<{len(words)}I", *words)
+
+
+CASES = case = hostbuild.Cases()
+
+
+@case
+def header_and_detection(lib):
+    old, new = b"a" * 1000, b"b" * 900
+    patch, _ = ota_delta.make_patch(old, new)
+    assert lib.is_patch(patch, len(patch)) and not lib.is_patch(b"\xe9" + patch[1:], len(patch))
+    assert lib.start(patch, ota_delta.HEADER_SIZE - 1) == DELTA_ERR_FORMAT
+    assert lib.start(patch[:4] + b"\x02" + patch[5:], len(patch)) == DELTA_ERR_FORMAT
+    assert lib.start(patch, len(patch)) == DELTA_OK
+
+
+@case
+def round_trip_any_chunking(lib):
+    rng = random.Random(1)
+    old = fake_image(rng, 64 * 1024)
+    new = rebuild(old, rng, 20000, 96)
+    patch, _ = ota_delta.make_patch(old, new)
+    for chunk in (None, 1, 3, 255, 1024, lambda: rng.randrange(1, 700)):
+        result, out = apply(lib, old, patch, chunk)
+        assert result == DELTA_DONE and out == new, (chunk, result, len(out))
+
+
+@case
+def matches_reference_applier(lib):
+    rng = random.Random(2)
+    old = bytes(rng.randrange(256) for _ in range(20000))
+    # Reordered blocks, a changed middle and new data at the end
+    new = (old[10000:15000] + old[:5000] + bytes(b ^ (i % 4 == 0) for i, b in enumerate(old[5000:6000]))
+           + old[6000:10000] + bytes(rng.randrange(256) for _ in range(3000)))
+    patch, stats = ota_delta.make_patch(old, new)
+    assert stats["copy"] >= 14000 and stats["diff"] >= 990 and stats["insert"] >= 2990, stats
+    result, out = apply(lib, old, patch, 100)
+    assert result == DELTA_DONE and out == new == ota_delta.apply_patch(old, patch)
+
+
+@case
+def relocated_code_compresses(lib):
+    rng = random.Random(3)
+    old = fake_image(rng, 512 * 1024)
+    new = rebuild(old, rng, 100000, 256)
+    patch, _ = ota_delta.make_patch(old, new)
+    assert len(patch) * 10 < len(new), len(patch)
+    result, out = apply(lib, old, patch, 4096)
+    assert result == DELTA_DONE and out == new
+
+
+@case
+def empty_and_identical_images(lib):
+    old = bytes(range(256)) * 40
+    for new in (b"", old, old[:-1]):
+        result, out = apply(lib, old, ota_delta.make_patch(old, new)[0])
+        assert result == DELTA_DONE and out == new, (len(new), result)
+
+
+@case
+def bad_opcode_is_format_error(lib):
+    old, new = b"x" * 100, b"y" * 100
+    lib.set_source(old, len(old))
+    lib.start(header(old, new), ota_delta.HEADER_SIZE)
+    result, _ = apply_commands(lib, bytes([7]))
+    assert result == DELTA_ERR_FORMAT, result
+    # Sticky: nothing after an error is applied
+    assert lib.feed(bytes([ota_delta.OP_END]), 1) == DELTA_ERR_FORMAT
+
+
+@case
+def overlong_varint_is_format_error(lib):
+    old = b"x" * 100
+    lib.set_source(old, len(old))
+    lib.start(header(old, old), ota_delta.HEADER_SIZE)
+    result, _ = apply_commands(lib, bytes([ota_delta.OP_INSERT]) + b"\xff" * 6 + b"\x01")
+    assert result == DELTA_ERR_FORMAT, result
+
+
+@case
+def source_out_of_range(lib):
+    old = b"x" * 100
+    lib.set_source(old, len(old))
+    cases = [
+        bytes([ota_delta.OP_COPY]) + ota_delta.leb128(101) + ota_delta.leb128(0),
+        bytes([ota_delta.OP_COPY]) + ota_delta.leb128(10) + ota_delta.leb128(ota_delta.zigzag(-1)),
+        bytes([ota_delta.OP_COPY]) + ota_delta.leb128(10) + ota_delta.leb128(ota_delta.zigzag(91)),
+        bytes([ota_delta.OP_DIFF]) + ota_delta.leb128(2) + ota_delta.leb128(ota_delta.zigzag(99)) + b"\0\0",
+    ]
+    for commands in cases:
+        lib.start(header(old, b"y" * 200), ota_delta.HEADER_SIZE)
+        result, _ = apply_commands(lib, commands)
+        assert result == DELTA_ERR_SOURCE, (commands.hex(), result)
+
+
+@case
+def output_size_enforced(lib):
+    old, new = b"x" * 100, b"y" * 50
+    lib.set_source(old, len(old))
+    # Longer than the header's target size
+    lib.start(header(old, new), ota_delta.HEADER_SIZE)
+    result, _ = apply_commands(lib, bytes([ota_delta.OP_INSERT]) + ota_delta.leb128(51) + b"y" * 51)
+    assert result == DELTA_ERR_SIZE, result
+    # END before the target size is reached
+    lib.start(header(old, new), ota_delta.HEADER_SIZE)
+    result, _ = apply_commands(lib, bytes([ota_delta.OP_INSERT]) + ota_delta.leb128(49) + b"y" * 49
+                               + bytes([ota_delta.OP_END]))
+    assert result == DELTA_ERR_SIZE, result
+
+
+@case
+def source_read_in_blocks(lib):
+    rng = random.Random(4)
+    old = bytes(rng.randrange(256) for _ in range(100000))
+    patch, _ = ota_delta.make_patch(old, old[::-1][:1000] + old)
+    result, out = apply(lib, old, patch, 1)
+    assert result == DELTA_DONE
+    # A 100 KB COPY takes ~400 reads of DELTA_SRC_BLOCK, not one per byte
+    assert lib.source_reads() < 1000, lib.source_reads()
+
+
+def main():
+    return hostbuild.run_cases(__doc__, "delta_patch.c", SHIM_SOURCE, CASES)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
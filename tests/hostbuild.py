@@ -0,0 +1,65 @@
+"""
+Host Build - Shared scaffolding for the host tests that run firmware C files
+(main/*.c) on a PC.
+
+The C file under test is compiled unchanged with gcc into a shared library,
+together with a small per-test shim that flattens the firmware structs and
+callbacks into plain functions, and is then driven from Python through ctypes.
+Only modules free of ESP-IDF dependencies can be built this way.
+
+Requires: gcc
+"""
+
+import argparse
+import ctypes
+import os
+import subprocess
+import tempfile
+
+REPO_MAIN = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "main")
+
+CFLAGS = ["-std=c11", "-O1", "-Wall", "-Wextra", "-Werror"]
+
+
+def build_library(workdir, source, shim_source):
+    """Compile main/<source> + the shim into workdir and load it."""
+    name = os.path.splitext(source)[0]
+    shim = os.path.join(workdir, f"{name}_shim.c")
+    lib = os.path.join(workdir, f"lib{name}.so")
+    with open(shim, "w") as f:
+        f.write(shim_source)
+    subprocess.check_call(["gcc", "-shared", "-fPIC"] + CFLAGS + ["-I", REPO_MAIN,
+                          os.path.join(REPO_MAIN, source), shim, "-o", lib])
+    return ctypes.CDLL(lib)
+
+
+class Cases(list):
+    """Ordered test cases; the instance doubles as the @case decorator."""
+
+    def __call__(self, fn):
+        self.append(fn)
+        return fn
+
+
+def run_cases(description, source, shim_source, cases, setup=None):
+    """Build the library, run every case against it and return the exit code."""
+    parser = argparse.ArgumentParser(description=description, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--verbose", action="store_true", help="Stop with a traceback on the first failure")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_library(workdir, source, shim_source)
+        if setup:
+            setup(lib)
+        failed = 0
+        for fn in cases:
+            try:
+                fn(lib)
+                print(f"  PASS  {fn.__name__}")
+            except AssertionError as e:
+                failed += 1
+                print(f"  FAIL  {fn.__name__}: {e}")
+                if args.verbose:
+                    raise
+        print(f"\n{len(cases) - failed}/{len(cases)} passed")
+        return 1 if failed else 0
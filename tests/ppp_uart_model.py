@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+PPP UART Model - Compares the old polled 115200-baud modem RX path with the
+event-driven high-baud path (with and without RTS/CTS) in a Python model.
+
+This is a model, not a benchmark of the firmware: it never runs a7670c_ppp.c
+or the ESP-IDF UART driver. Its numbers compare the two RX designs under the
+model's assumptions (Python threads on a pseudo-terminal, a host scheduler);
+they are not device throughput. Use it to see how ring size, wake thresholds
+and consumer stalls interact, and confirm on hardware.
+
+There is no PPP loopback throughput benchmark for the high-baud path. The
+firmware's PPP stack (esp_netif + lwIP) only runs on the device, so a host
+pppd peer on a pty would measure Linux pppd rather than a7670c_ppp.c. Measure
+throughput on hardware instead, e.g. with an OTA download over SIM.
+
+A peer thread plays the modem: it sends HDLC-framed PPP packets (RFC 1662
+byte stuffing and FCS-16, 1500-byte IP payloads) into the pty master, paced at
+the line rate. The gateway side is modelled after a7670c_ppp.c:
+
+  ISR      drains the pty slave into an RX ring of the driver's size; when the
+           ring is full bytes are lost, or with RTS/CTS the peer is held off
+  RX task  old: uart_read_bytes(2048, 100 ms) on a 2048-byte ring
+           new: woken at MODEM_UART_RX_FULL_THRESH bytes or after
+           MODEM_UART_RX_TOUT_SYMBOLS idle byte times, reads
+           MODEM_UART_RX_CHUNK at a time from a MODEM_UART_RX_BUF ring
+
+and the consumer stalls periodically the way the PPP task does while an OTA
+image is written to flash. Frames are unstuffed and FCS-checked, so overruns
+show up as lost PPP frames.
+
+Ring sizes and thresholds are read from main/iot_configs.h. Linux/macOS only.
+
+Usage:
+    python ppp_uart_model.py                   # All configurations, 3 s each
+    python ppp_uart_model.py --seconds 10      # Longer runs
+    python ppp_uart_model.py --stall-ms 0      # No consumer stalls
+"""
+
+import argparse
+import os
+import pty
+import random
+import re
+import select
+import sys
+import threading
+import time
+import tty
+
+CONFIG_H = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "main", "iot_configs.h")
+
+FLAG, ESC = 0x7E, 0x7D
+
+
+def read_config():
+    values = {}
+    with open(CONFIG_H) as f:
+        for m in re.finditer(r"#define\s+(MODEM_UART_\w+)\s+(\d+)", f.read()):
+            values[m.group(1)] = int(m.group(2))
+    return values
+
+
+def fcs16(data):
+    fcs = 0xFFFF
+    for b in data:
+        fcs ^= b
+        for _ in range(8):
+            fcs = (fcs >> 1) ^ 0x8408 if fcs & 1 else fcs >> 1
+    return fcs ^ 0xFFFF
+
+
+def hdlc_frame(payload):
+    body = bytes([0xFF, 0x03, 0x00, 0x21]) + payload
+    fcs = fcs16(body)
+    body += bytes([fcs & 0xFF, fcs >> 8])
+    out = bytearray([FLAG])
+    for b in body:
+        if b in (FLAG, ESC) or b < 0x20:
+            out += bytes([ESC, b ^ 0x20])
+        else:
+            out.append(b)
+    out.append(FLAG)
+    return bytes(out), len(payload)
+
+
+class HdlcReceiver:
+    def __init__(self):
+        self.buf = bytearray()
+        self.escaped = False
+        self.ok = self.bad = self.payload_bytes = 0
+
+    def feed(self, data):
+        for b in data:
+            if b == FLAG:
+                if len(self.buf) >= 6:
+                    body = bytes(self.buf)
+                    if fcs16(body[:-2]) == body[-2] | body[-1] << 8:
+                        self.ok += 1
+                        self.payload_bytes += len(body) - 6
+                    else:
+                        self.bad += 1
+                self.buf.clear()
+                self.escaped = False
+            elif b == ESC:
+                self.escaped = True
+            else:
+                self.buf.append(b ^ 0x20 if self.escaped else b)
+                self.escaped = False
+
+
+class Link:
+    """One model run: peer -> pty -> ISR ring -> RX task -> HDLC decoder."""
+
+    def __init__(self, baud, flow_ctrl, event_rx, cfg, stall_ms, stall_every_ms):
+        self.baud = baud
+        self.flow_ctrl = flow_ctrl
+        self.event_rx = event_rx
+        self.ring_size = cfg["MODEM_UART_RX_BUF"] if event_rx else 2048
+        self.full_thresh = cfg["MODEM_UART_RX_FULL_THRESH"]
+        self.idle_s = cfg["MODEM_UART_RX_TOUT_SYMBOLS"] * 10.0 / baud
+        self.chunk = cfg["MODEM_UART_RX_CHUNK"] if event_rx else 2048
+        self.stall_s = stall_ms / 1000.0
+        self.stall_every_s = stall_every_ms / 1000.0
+
+        self.master, self.slave = pty.openpty()
+        tty.setraw(self.master)
+        tty.setraw(self.slave)
+        self.ring = bytearray()
+        self.ring_lock = threading.Condition()
+        self.last_rx = time.monotonic()
+        self.cts = threading.Event()
+        self.cts.set()
+        self.overflow_bytes = 0
+        self.sent_frames = 0
+        self.stop = threading.Event()
+        self.rx = HdlcReceiver()
+
+    def peer(self):
+        rng = random.Random(self.baud)
+        frames = [hdlc_frame(bytes(rng.randrange(256) for _ in range(1500)))[0] for _ in range(8)]
+        bytes_per_s = self.baud / 10.0
+        start = time.monotonic()
+        sent = 0
+        i = 0
+        while not self.stop.is_set():
+            frame = frames[i % len(frames)]
+            i += 1
+            pos = 0
+            while pos < len(frame) and not self.stop.is_set():
+                if self.flow_ctrl and not self.cts.wait(0.01):
+                    # Held off by RTS: the line is idle, not building up credit
+                    start += 0.01
+                    continue
+                due = start + (sent + 64) / bytes_per_s
+                delay = due - time.monotonic()
+                if delay > 0:
+                    time.sleep(delay)
+                piece = frame[pos:pos + 64]
+                os.write(self.master, piece)
+                pos += len(piece)
+                sent += len(piece)
+            self.sent_frames += 1
+
+    def isr(self):
+        while not self.stop.is_set():
+            r, _, _ = select.select([self.slave], [], [], 0.01)
+            if not r:
+                continue
+            data = os.read(self.slave, 4096)
+            with self.ring_lock:
+                room = self.ring_size - len(self.ring)
+                self.ring += data[:room]
+                self.overflow_bytes += max(0, len(data) - room)
+                self.last_rx = time.monotonic()
+                if self.flow_ctrl and len(self.ring) >= self.ring_size - 128:
+                    self.cts.clear()
+                self.ring_lock.notify()
+
+    def take(self, n):
+        data = bytes(self.ring[:n])
+        del self.ring[:n]
+        if self.flow_ctrl and len(self.ring) < self.ring_size // 2:
+            self.cts.set()
+        return data
+
+    def rx_task(self):
+        next_stall = time.monotonic() + self.stall_every_s
+        while not self.stop.is_set():
+            with self.ring_lock:
+                if self.event_rx:
+                    # Woken by RX-full or RX-timeout, then drains everything buffered
+                    while not self.stop.is_set():
+                        idle = time.monotonic() - self.last_rx
+                        if len(self.ring) >= self.full_thresh or (self.ring and idle >= self.idle_s):
+                            break
+                        self.ring_lock.wait(0.001)
+                    batches = [self.take(self.chunk) for _ in range((len(self.ring) + self.chunk - 1) // self.chunk)]
+                else:
+                    # uart_read_bytes(2048, 100 ms): returns when 2048 bytes arrived or on timeout
+                    deadline = time.monotonic() + 0.1
+                    while len(self.ring) < self.chunk and time.monotonic() < deadline and not self.stop.is_set():
+                        self.ring_lock.wait(0.001)
+                    batches = [self.take(self.chunk)]
+            for batch in batches:
+                self.rx.feed(batch)
+            if self.stall_s > 0 and time.monotonic() >= next_stall:
+                time.sleep(self.stall_s)
+                next_stall = time.monotonic() + self.stall_every_s
+
+    def run(self, seconds):
+        threads = [threading.Thread(target=t, daemon=True) for t in (self.peer, self.isr, self.rx_task)]
+        for t in threads:
+            t.start()
+        time.sleep(seconds)
+        self.stop.set()
+        self.cts.set()
+        for t in threads:
+            t.join(1)
+        os.close(self.master)
+        os.close(self.slave)
+        return {
+            "kbps": self.rx.payload_bytes / seconds / 1024,
+            "ok": self.rx.ok,
+            "bad": self.rx.bad,
+            "overflow": self.overflow_bytes,
+        }
+
+
+CONFIGS = [
+    # baud, RTS/CTS, event-driven RX
+    (115200, False, False),
+    (115200, False, True),
+    (460800, False, True),
+    (460800, True, True),
+    (921600, False, False),
+    (921600, False, True),
+    (921600, True, True),
+]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--seconds", type=float, default=3.0)
+    parser.add_argument("--stall-ms", type=int, default=120, help="Consumer stall length (flash write)")
+    parser.add_argument("--stall-every-ms", type=int, default=1000)
+    args = parser.parse_args()
+
+    cfg = read_config()
+    print(f"Model only (not device measurements): RX ring {cfg['MODEM_UART_RX_BUF']} B, "
+          f"chunk {cfg['MODEM_UART_RX_CHUNK']} B, stall {args.stall_ms} ms every {args.stall_every_ms} ms\n")
+    print(f"{'baud':>7}  {'RTS/CTS':>7}  {'RX path':>8}  {'KB/s':>6}  {'frames':>6}  {'bad':>4}  {'lost B':>7}")
+
+    failed = False
+    for baud, flow, event_rx in CONFIGS:
+        r = Link(baud, flow, event_rx, cfg, args.stall_ms, args.stall_every_ms).run(args.seconds)
+        print(f"{baud:>7}  {'on' if flow else 'off':>7}  {'event' if event_rx else 'poll':>8}  "
+              f"{r['kbps']:>6.1f}  {r['ok']:>6}  {r['bad']:>4}  {r['overflow']:>7}")
+        if flow and (r["overflow"] or r["bad"]):
+            failed = True
+    if failed:
+        print("\nFAIL: model lost bytes with RTS/CTS")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+"""
+OTA Delta Builder - Makes a delta patch that turns one firmware build into
+another, for devices already running the old build. The gateway applies it
+while downloading (main/delta_patch.c), reading the old image from its running
+partition, and checks the result against the new image's SHA-256 before
+switching partitions. Serve or upload the .delta file wherever the .bin would
+go; full images keep working as before.
+
+Matching is bsdiff-like: exact matches of at least MIN_MATCH bytes become
+COPY, and the gaps between them become DIFF against the old image at the same
+displacement (code that moved, with changed addresses) or INSERT when nothing
+lines up. The command stream is raw-deflated with an 8 KB window. See
+main/delta_patch.h for the format.
+
+Also run by `idf.py -DOTA_DELTA_BASE=<old .bin> ota_delta`, which writes
+build/<project>.delta next to the new .bin.
+
+Usage:
+    python ota_delta.py old.bin new.bin out.delta
+    python ota_delta.py old.bin new.bin out.delta --verify   # Apply it again and compare
+"""
+
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b"GWDP"
+VERSION = 1
+HEADER_SIZE = 80
+WINDOW_BITS = 13   # Deflate window; the gateway inflates into a buffer this size
+
+OP_END, OP_COPY, OP_DIFF, OP_INSERT = 0, 1, 2, 3
+
+SEED = 16          # Bytes hashed to find match candidates
+INDEX_STEP = 4     # Old image indexed every INDEX_STEP bytes (code is word aligned)
+MIN_MATCH = 24     # Shorter exact matches are left to DIFF/INSERT
+MIN_SIMILAR = 0.5  # Share of equal bytes for a gap to be sent as DIFF
+
+
+def leb128(value):
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value) << 1) - 1
+
+
+def common_length(a, ai, b, bi, limit):
+    """Length of the common prefix of a[ai:] and b[bi:], at most limit."""
+    n = 0
+    step = 4096
+    while step:
+        while n + step <= limit and a[ai + n:ai + n + step] == b[bi + n:bi + n + step]:
+            n += step
+        step //= 4
+    return n
+
+
+def find_matches(old, new):
+    """Greedy list of exact matches (new_pos, old_pos, length), in new order."""
+    index = {}
+    for p in range(0, len(old) - SEED + 1, INDEX_STEP):
+        index.setdefault(old[p:p + SEED], p)
+
+    matches = []
+    j = 0
+    last_end = 0
+    disp = 0                      # old_pos - new_pos of the last match
+    while j + SEED <= len(new):
+        key = new[j:j + SEED]
+        p = None
+        # The current displacement first: after an edit most code just moved
+        q = j + disp
+        if 0 <= q and q + SEED <= len(old) and old[q:q + SEED] == key:
+            p = q
+        else:
+            p = index.get(key)
+        if p is None:
+            j += 1
+            continue
+        back = 0
+        while p - back > 0 and j - back > last_end and old[p - back - 1] == new[j - back - 1]:
+            back += 1
+        start_new, start_old = j - back, p - back
+        length = back + common_length(old, p, new, j, min(len(old) - p, len(new) - j))
+        if length < MIN_MATCH:
+            j += 1
+            continue
+        matches.append((start_new, start_old, length))
+        last_end = start_new + length
+        disp = start_old - start_new
+        j = last_end
+    return matches
+
+
+def similarity(old, old_pos, new, new_pos, length):
+    if old_pos < 0 or old_pos + length > len(old):
+        return 0.0
+    same = sum(1 for i in range(length) if old[old_pos + i] == new[new_pos + i])
+    return same / length
+
+
+def build_commands(old, new):
+    matches = find_matches(old, new)
+    out = bytearray()
+    cursor = 0                    # Source cursor, as delta_patch.c tracks it
+    stats = {"copy": 0, "diff": 0, "insert": 0}
+
+    def emit_source(op, new_pos, old_pos, length):
+        nonlocal cursor, out
+        out.append(op)
+        out += leb128(length)
+        out += leb128(zigzag(old_pos - cursor))
+        if op == OP_DIFF:
+            out += bytes((new[new_pos + i] - old[old_pos + i]) & 0xFF for i in range(length))
+        cursor = old_pos + length
+
+    def emit_gap(start, end, disps):
+        nonlocal out
+        length = end - start
+        if length <= 0:
+            return
+        best = max(disps, key=lambda d: similarity(old, start + d, new, start, length), default=None)
+        if best is not None and similarity(old, start + best, new, start, length) >= MIN_SIMILAR:
+            emit_source(OP_DIFF, start, start + best, length)
+            stats["diff"] += length
+        else:
+            out.append(OP_INSERT)
+            out += leb128(length)
+            out += new[start:end]
+            stats["insert"] += length
+
+    pos = 0
+    prev_disp = None
+    for new_pos, old_pos, length in matches:
+        disps = [d for d in (prev_disp, old_pos - new_pos) if d is not None]
+        emit_gap(pos, new_pos, disps)
+        emit_source(OP_COPY, new_pos, old_pos, length)
+        stats["copy"] += length
+        prev_disp = old_pos - new_pos
+        pos = new_pos + length
+    emit_gap(pos, len(new), [prev_disp] if prev_disp is not None else [])
+    out.append(OP_END)
+    return bytes(out), stats
+
+
+def make_patch(old, new):
+    commands, stats = build_commands(old, new)
+    header = MAGIC + struct.pack("<B3xII", VERSION, len(old), len(new))
+    header += hashlib.sha256(old).digest() + hashlib.sha256(new).digest()
+    assert len(header) == HEADER_SIZE
+    deflate = zlib.compressobj(9, zlib.DEFLATED, -WINDOW_BITS, 9)
+    return header + deflate.compress(commands) + deflate.flush(), stats
+
+
+def apply_patch(old, patch):
+    """Reference implementation of delta_patch.c, used by --verify and the tests."""
+    if patch[:4] != MAGIC or patch[4] != VERSION:
+        raise ValueError("not a delta patch")
+    source_size, target_size = struct.unpack_from("<II", patch, 8)
+    if len(old) < source_size or hashlib.sha256(old[:source_size]).digest() != patch[16:48]:
+        raise ValueError("patch was made for a different source image")
+    cmds = zlib.decompress(patch[HEADER_SIZE:], -15)
+    out = bytearray()
+    i = 0
+    cursor = 0
+
+    def field():
+        nonlocal i
+        value = shift = 0
+        while True:
+            b = cmds[i]
+            i += 1
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    while True:
+        op = cmds[i]
+        i += 1
+        if op == OP_END:
+            break
+        length = field()
+        if op == OP_INSERT:
+            out += cmds[i:i + length]
+            i += length
+            continue
+        z = field()
+        cursor += (z >> 1) ^ -(z & 1)
+        src = old[cursor:cursor + length]
+        if op == OP_COPY:
+            out += src
+        else:
+            out += bytes((src[k] + cmds[i + k]) & 0xFF for k in range(length))
+            i += length
+        cursor += length
+    if len(out) != target_size or hashlib.sha256(out).digest() != patch[48:80]:
+        raise ValueError("result does not match the target image")
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("old", help="Firmware .bin the devices are running")
+    parser.add_argument("new", help="Firmware .bin to update them to")
+    parser.add_argument("out", help="Patch file to write")
+    parser.add_argument("--verify", action="store_true", help="Apply the patch and compare with new")
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as f:
+        old = f.read()
+    with open(args.new, "rb") as f:
+        new = f.read()
+
+    patch, stats = make_patch(old, new)
+    if args.verify and apply_patch(old, patch) != new:
+        print("FAIL: patch does not reproduce the new image")
+        return 1
+    with open(args.out, "wb") as f:
+        f.write(patch)
+
+    print(f"{args.out}: {len(patch)} bytes for a {len(new)}-byte image ({len(new) / len(patch):.1f}x smaller)")
+    print(f"  copy {stats['copy']}  diff {stats['diff']}  insert {stats['insert']} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())